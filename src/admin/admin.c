@@ -1450,6 +1450,174 @@ static void _build_new_extent(const struct pho_id *target,
     iod_target->iod_loc->extent = new_extent;
 }
 
+static void _free_new_extents(struct extent *extents, int count)
+{
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        free(extents[i].uuid);
+        free(extents[i].address.buff);
+        pho_attrs_free(&extents[i].info);
+    }
+
+    free(extents);
+}
+
+static int _pack_offset_cmp(const void *_lhs, const void *_rhs)
+{
+    ssize_t lhs = extent_pack_offset((struct extent *)_lhs);
+    ssize_t rhs = extent_pack_offset((struct extent *)_rhs);
+
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/**
+ * Move the extents packed in the same container as \p extents[first] right
+ * after it, by increasing offset in the container.
+ *
+ * \return the number of extents of the container
+ */
+static int _gather_pack_container(struct extent *extents, int count, int first)
+{
+    int n = 1;
+    int i;
+
+    for (i = first + 1; i < count; ++i) {
+        struct extent packed;
+
+        if (extent_pack_offset(&extents[i]) < 0 ||
+            strcmp(extents[i].address.buff, extents[first].address.buff))
+            continue;
+
+        /* keep the order of the other extents */
+        packed = extents[i];
+        memmove(&extents[first + n + 1], &extents[first + n],
+                (i - first - n) * sizeof(*extents));
+        extents[first + n] = packed;
+        n++;
+    }
+
+    qsort(&extents[first], n, sizeof(*extents), _pack_offset_cmp);
+
+    return n;
+}
+
+/**
+ * Copy the live extents of a container into a new container holding only
+ * them, followed by its index.
+ *
+ * \param[out] size_written  Size of the new container
+ */
+static int _copy_pack_container(const struct pho_id *target,
+                                struct extent *old_extents,
+                                struct extent *new_extents, int count,
+                                struct io_adapter_module *ioa,
+                                struct pho_io_descr *iod_source,
+                                struct pho_io_descr *iod_target,
+                                ssize_t *size_written)
+{
+    size_t position = 0;
+    json_t *index = NULL;
+    ssize_t index_size;
+    size_t offset = 0;
+    size_t buf_size;
+    char *buffer;
+    int rc2;
+    int rc;
+    int i;
+
+    for (i = 0; i < count; ++i)
+        _build_new_extent(target, &old_extents[i], &new_extents[i],
+                          iod_source, iod_target);
+
+    iod_source->iod_loc->extent = &old_extents[0];
+    iod_target->iod_loc->extent = &new_extents[0];
+
+    /* a container has no extended attributes, the target shares the source
+     * ones after a copy_extent
+     */
+    pho_attrs_free(&iod_source->iod_attrs);
+    iod_target->iod_attrs = iod_source->iod_attrs;
+
+    rc = ioa_open(ioa, NULL, iod_source, false);
+    if (rc) {
+        iod_source->iod_rc = rc;
+        LOG_RETURN(rc, "Unable to open source container");
+    }
+
+    rc = ioa_open(ioa, NULL, iod_target, true);
+    if (rc) {
+        iod_target->iod_rc = rc;
+        LOG_GOTO(close_source, rc, "Unable to open target container");
+    }
+
+    get_preferred_io_block_size(&buf_size, PHO_RSC_TAPE, ioa, iod_target);
+    buffer = xmalloc(buf_size);
+
+    for (i = 0; i < count; ++i) {
+        size_t pack_offset = extent_pack_offset(&old_extents[i]);
+        size_t left_to_read = old_extents[i].size;
+
+        rc = iod_skip(ioa, iod_source, pack_offset - position);
+        if (rc) {
+            iod_source->iod_rc = rc;
+            LOG_GOTO(free_buffer, rc, "Unable to reach extent '%s'",
+                     old_extents[i].uuid);
+        }
+
+        while (left_to_read) {
+            ssize_t nb_read_bytes;
+
+            nb_read_bytes = ioa_read(ioa, iod_source, buffer,
+                                     min(buf_size, left_to_read));
+            if (nb_read_bytes <= 0) {
+                rc = nb_read_bytes ? : -EIO;
+                iod_source->iod_rc = rc;
+                LOG_GOTO(free_buffer, rc, "Unable to read extent '%s'",
+                         old_extents[i].uuid);
+            }
+
+            rc = ioa_write(ioa, iod_target, buffer, nb_read_bytes);
+            if (rc) {
+                iod_target->iod_rc = rc;
+                LOG_GOTO(free_buffer, rc, "Unable to write extent '%s'",
+                         old_extents[i].uuid);
+            }
+
+            left_to_read -= nb_read_bytes;
+        }
+
+        position = pack_offset + old_extents[i].size;
+        extent_set_pack_offset(&new_extents[i], offset);
+        offset += new_extents[i].size;
+        pack_index_add(&index, &new_extents[i]);
+    }
+
+    index_size = pack_index_write(ioa, iod_target, index);
+    if (index_size < 0) {
+        rc = index_size;
+        iod_target->iod_rc = rc;
+        goto free_buffer;
+    }
+
+    *size_written = offset + index_size;
+
+free_buffer:
+    free(buffer);
+    json_decref(index);
+
+    rc2 = ioa_close(ioa, iod_target);
+    if (rc)
+        ioa_del(ioa, iod_target);
+    rc = rc ? : rc2;
+
+close_source:
+    rc2 = ioa_close(ioa, iod_source);
+    rc = rc ? : rc2;
+
+    return rc;
+}
+
 static int _clean_database_following_format(struct admin_handle *adm,
                                             const struct pho_id *source)
 {
@@ -1542,12 +1710,14 @@ int phobos_admin_repack(struct admin_handle *adm, const struct pho_id *source,
     struct extent *ext_res = NULL;
     struct string_array src_tags;
     GArray *new_ext_uuids = NULL;
+    ssize_t size_written = 0;
     int ext_cnt_done = 0;
     struct pho_id target;
     ssize_t total_size;
     int ext_cnt;
     int rc;
-    int i;
+    int i, j;
+    int n;
 
     if (source->family != PHO_RSC_TAPE)
         LOG_RETURN(-ENOTSUP, "Repack operation is only available for tapes");
@@ -1602,29 +1772,48 @@ int phobos_admin_repack(struct admin_handle *adm, const struct pho_id *source,
 
     new_ext_uuids = g_array_new(FALSE, TRUE, sizeof(ext_res[0].uuid));
 
-    /* Copy loop */
-    for (i = 0; i < ext_cnt; ++i, ++ext_cnt_done) {
-        struct extent ext_new = {0};
+    /* Copy loop, the live extents of a container are compacted together */
+    for (i = 0; i < ext_cnt; i += n, ext_cnt_done += n) {
+        bool packed = extent_pack_offset(&ext_res[i]) >= 0;
+        struct extent *ext_new;
+        ssize_t copy_size;
 
-        _build_new_extent(&target, &ext_res[i], &ext_new, &iod_source,
-                          &iod_target);
+        n = packed ? _gather_pack_container(ext_res, ext_cnt, i) : 1;
+        ext_new = xcalloc(n, sizeof(*ext_new));
+
+        if (packed) {
+            rc = _copy_pack_container(&target, &ext_res[i], ext_new, n, ioa,
+                                      &iod_source, &iod_target, &copy_size);
+        } else {
+            _build_new_extent(&target, &ext_res[i], ext_new, &iod_source,
+                              &iod_target);
+            rc = copy_extent(ioa, &iod_source, ioa, &iod_target,
+                             PHO_RSC_TAPE);
+            copy_size = ext_new->size;
+        }
 
-        rc = copy_extent(ioa, &iod_source, ioa, &iod_target, PHO_RSC_TAPE);
         if (rc) {
             pho_error(rc, "Failed to copy extent '%s'", ext_res[i].uuid);
+            _free_new_extents(ext_new, n);
             break;
         }
 
-        rc = dss_extent_insert(&adm->dss, &ext_new, 1, DSS_SET_INSERT);
+        rc = dss_extent_insert(&adm->dss, ext_new, n, DSS_SET_INSERT);
         if (rc) {
             pho_error(rc, "Failed to add extent '%s' information in DSS",
                       ext_res[i].uuid);
+            _free_new_extents(ext_new, n);
             break;
         }
 
-        g_array_append_val(new_ext_uuids, ext_new.uuid);
+        /* the uuids are kept in new_ext_uuids */
+        for (j = 0; j < n; ++j) {
+            g_array_append_val(new_ext_uuids, ext_new[j].uuid);
+            ext_new[j].uuid = NULL;
+        }
 
-        free(ext_new.address.buff);
+        _free_new_extents(ext_new, n);
+        size_written += copy_size;
     }
     free(loc_target.root_path);
     free(loc_source.root_path);
@@ -1635,10 +1824,7 @@ int phobos_admin_repack(struct admin_handle *adm, const struct pho_id *source,
     }
 
     rc = _send_and_recv_release(adm, source, &iod_source, 3,
-                                &target, &iod_target,
-                                ext_cnt_done == ext_cnt ?
-                                    total_size :
-                                    _sum_extent_size(ext_res, ext_cnt_done),
+                                &target, &iod_target, size_written,
                                 ext_cnt_done);
     if (rc)
         LOG_GOTO(free_ext, rc, "Failed to send/receive release");
@@ -1877,6 +2063,51 @@ release_extent:
     return rc;
 }
 
+int phobos_admin_extent_iter_open(struct admin_handle *adm,
+                                  const char *medium, const char *library,
+                                  enum extent_state state,
+                                  struct dss_sort *sort,
+                                  struct dss_iter **iter)
+{
+    struct dss_filter extent_filter;
+    GString *extent_str;
+    int rc = 0;
+
+    extent_str = g_string_new(NULL);
+
+    phobos_construct_extent(extent_str, medium, library, state);
+
+    rc = dss_filter_build(&extent_filter, "%s", extent_str->str);
+    g_string_free(extent_str, TRUE);
+    if (rc)
+        return rc;
+
+    rc = dss_extent_iter_open(&adm->dss, &extent_filter, sort, 0, iter);
+    if (rc)
+        pho_error(rc, "Cannot fetch extents");
+
+    dss_filter_free(&extent_filter);
+
+    return rc;
+}
+
+int phobos_admin_extent_iter_next(struct dss_iter *iter,
+                                  struct extent **extents, int *n_extents)
+{
+    int rc;
+
+    rc = dss_extent_iter_next(iter, extents, n_extents);
+    if (rc)
+        pho_error(rc, "Cannot fetch extents");
+
+    return rc;
+}
+
+void phobos_admin_extent_iter_close(struct dss_iter *iter)
+{
+    dss_iter_close(iter);
+}
+
 int phobos_admin_layout_list(struct admin_handle *adm, const char **res,
                              int n_res, bool is_pattern, const char *medium,
                              const char *library, const char *copy_name,
@@ -44,4 +44,10 @@ class GetOptHandler(ActionOptHandler):
                                  "hostname to get this object")
         parser.add_argument('-c', '--copy-name',
                             help='Copy of the object to get')
+        parser.add_argument('--offset', type=int, default=0,
+                            help='Offset in the object of the first byte to '
+                                 'get')
+        parser.add_argument('--length', type=int, default=0,
+                            help='Number of bytes to get from the offset, up '
+                                 'to the end of the object if 0')
         parser.set_defaults(verb=cls.label)
@@ -52,6 +52,9 @@ class PutOptHandler(ActionOptHandler):
         parser.add_argument('--no-split', action='store_true',
                             help='Prevent splitting object over multiple '
                             'media.')
+        parser.add_argument('--pack', action='store_true',
+                            help='Pack the objects in one extent per medium, '
+                            'implies --no-split.')
         parser.add_argument('src_file', help='File to insert', nargs='?')
         parser.add_argument('object_id', help='Desired object ID', nargs='?')
         parser.set_defaults(verb=cls.label)
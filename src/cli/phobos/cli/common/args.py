@@ -37,7 +37,7 @@ def add_put_arguments(parser):
                         help='desired library (if not set, any available '
                              'library will be used)')
     parser.add_argument('-l', '--layout', '--lyt',
-                        choices=['raid1', 'raid4'],
+                        choices=['raid1', 'raid4', 'raid_ec'],
                         help='desired storage layout')
     parser.add_argument('-p', '--profile',
                         help='desired profile for family, tags and layout. '
@@ -114,6 +114,7 @@ def create_put_params(obj, copy):
                            layout=obj.params.get('layout'),
                            lyt_params=lyt_attrs,
                            no_split=obj.params.get('no_split'),
+                           pack=obj.params.get('pack'),
                            overwrite=obj.params.get('overwrite'),
                            tags=obj.params.get('tags', []))
 
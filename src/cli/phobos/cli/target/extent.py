@@ -33,7 +33,7 @@ from phobos.core.const import (extent_state2str, PHO_EXT_ST_ORPHAN,  # pylint: d
                                PHO_EXT_ST_PENDING, PHO_EXT_ST_SYNC,
                                str2extent_state)
 from phobos.core.ffi import LayoutInfo, ExtentInfo
-from phobos.output import dump_object_list
+from phobos.output import dump_object_batches, dump_object_list
 
 class ExtentListOptHandler(ListOptHandler):
     """
@@ -106,9 +106,10 @@ class ExtentOptHandler(BaseResourceOptHandler):
         try:
             with AdminClient(lrs_required=False) as adm:
                 if kwargs['state'] == PHO_EXT_ST_ORPHAN:
-                    obj_list, p_objs, n_objs = adm.extent_list(
-                                                    self.params.get('name'),
-                                                    **kwargs)
+                    dump_object_batches(
+                        adm.extent_iter(self.params.get('name'), **kwargs),
+                        attr=self.params.get('output'),
+                        fmt=self.params.get('format'))
                 else:
                     obj_list, p_objs, n_objs = adm.layout_list(
                         self.params.get('res'),
@@ -117,11 +118,12 @@ class ExtentOptHandler(BaseResourceOptHandler):
                         self.params.get('degroup'),
                         **kwargs)
 
-                if len(obj_list) > 0:
-                    dump_object_list(obj_list, attr=self.params.get('output'),
-                                     fmt=self.params.get('format'))
+                    if len(obj_list) > 0:
+                        dump_object_list(obj_list,
+                                         attr=self.params.get('output'),
+                                         fmt=self.params.get('format'))
 
-                adm.dss_res_free(p_objs, n_objs)
+                    adm.dss_res_free(p_objs, n_objs)
 
         except EnvironmentError as err:
             self.logger.error(env_error_format(err))
@@ -33,7 +33,7 @@ from phobos.cli.common.utils import (check_max_width_is_valid,
 from phobos.core.const import DSS_OBJ_ALIVE # pylint: disable=no-name-in-module
 from phobos.core.ffi import DeprecatedObjectInfo, ObjectInfo
 from phobos.core.store import UtilClient
-from phobos.output import dump_object_list
+from phobos.output import dump_object_batches
 
 
 class ObjectListOptHandler(ListOptHandler):
@@ -122,20 +122,17 @@ class ObjectOptHandler(BaseResourceOptHandler):
         client = UtilClient()
 
         try:
-            objs = client.object_list(self.params.get('res'),
-                                      self.params.get('pattern'),
-                                      metadata, uuid, version, scope,
-                                      **kwargs)
+            batches = client.object_iter(self.params.get('res'),
+                                         self.params.get('pattern'),
+                                         metadata, uuid, version, scope,
+                                         **kwargs)
 
-            if objs:
-                max_width = (None if self.params.get('no_trunc')
-                             else self.params.get('max_width'))
+            max_width = (None if self.params.get('no_trunc')
+                         else self.params.get('max_width'))
 
-                dump_object_list(objs, attr=self.params.get('output'),
-                                 max_width=max_width,
-                                 fmt=self.params.get('format'))
-
-            client.list_obj_free(objs, len(objs))
+            dump_object_batches(batches, attr=self.params.get('output'),
+                                max_width=max_width,
+                                fmt=self.params.get('format'))
         except EnvironmentError as err:
             self.logger.error(env_error_format(err))
             sys.exit(abs(err.errno))
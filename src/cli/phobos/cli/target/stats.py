@@ -28,6 +28,9 @@ from phobos.cli.common import (BaseOptHandler, env_error_format)
 from phobos.core.admin import Client as AdminClient
 from phobos.core.ffi import ResourceFamily
 
+# Fields displayed for histograms, in "lines" format
+HISTOGRAM_FIELDS = ('count', 'sum', 'min', 'max', 'p50', 'p90', 'p99', 'p999')
+
 class StatsOptHandler(BaseOptHandler):
     """Stats handler."""
 
@@ -85,5 +88,10 @@ class StatsOptHandler(BaseOptHandler):
             for entry in json:
                 tags = entry.get('tags', '')
                 name = entry['name']
-                value = entry['value']
-                print(f"{tags} {name}={value}")
+                if entry.get('type') == 'histogram':
+                    fields = ' '.join(f"{field}={entry[field]}"
+                                      for field in HISTOGRAM_FIELDS)
+                    print(f"{tags} {name} {fields}")
+                else:
+                    value = entry['value']
+                    print(f"{tags} {name}={value}")
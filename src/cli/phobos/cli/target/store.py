@@ -165,8 +165,15 @@ class StoreGetOptHandler(XferOptHandler):
         uuid = self.params.get('uuid')
         best_host = self.params.get('best_host')
         copy_name = self.params.get('copy_name')
+        offset = self.params.get('offset')
+        length = self.params.get('length')
+        if offset < 0 or length < 0:
+            self.logger.error("--offset and --length cannot be negative")
+            sys.exit(os.EX_USAGE)
+
         self.logger.debug("Retrieving object 'objid:%s' to '%s'", oid, dst)
-        self.client.get_register(oid, dst, (uuid, version, copy_name),
+        self.client.get_register(oid, dst,
+                                 (uuid, version, copy_name, offset, length),
                                  best_host)
         try:
             self.client.run()
@@ -365,6 +365,46 @@ class Client: # pylint: disable=too-many-public-methods
 
         return list_exts, extents, n_extents
 
+    def extent_iter(self, medium, **kwargs):
+        """List only extents, yielding them by batches.
+
+        The extents of a batch are only valid until the next one is requested.
+        """
+        n_extents = c_int(0)
+        extents = pointer(ExtentInfo())
+        iterator = c_void_p()
+        library_name = kwargs.get('library')
+        state = kwargs.get('state')
+
+        enc_medium = medium.encode('utf-8') if medium else None
+        enc_library = library_name.encode('utf-8') if library_name else None
+
+        sort, kwargs = dss_sort('extent', **kwargs)
+        sref = byref(sort) if sort else None
+
+        rc = LIBPHOBOS_ADMIN.phobos_admin_extent_iter_open(byref(self.handle),
+                                                           enc_medium,
+                                                           enc_library,
+                                                           state,
+                                                           sref,
+                                                           byref(iterator))
+        if rc:
+            raise EnvironmentError(rc, "Failed to list the extent(s)")
+
+        try:
+            while True:
+                rc = LIBPHOBOS_ADMIN.phobos_admin_extent_iter_next(
+                    iterator, byref(extents), byref(n_extents))
+                if rc:
+                    raise EnvironmentError(rc, "Failed to list the extent(s)")
+
+                if n_extents.value == 0:
+                    break
+
+                yield [extents[i] for i in range(n_extents.value)]
+        finally:
+            LIBPHOBOS_ADMIN.phobos_admin_extent_iter_close(iterator)
+
     def medium_locate(self, rsc_family, medium_id, library):
         """Locate a medium by calling phobos_admin_medium_locate API"""
         hostname = c_char_p(None)
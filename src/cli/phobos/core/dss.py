@@ -28,7 +28,8 @@ clean API to access it.
 import json
 import logging
 import os
-from ctypes import byref, c_int, c_void_p, c_char_p, c_bool, POINTER, Structure
+from ctypes import (byref, c_int, c_void_p, c_char_p, c_bool, c_uint64,
+                    POINTER, Structure)
 from abc import ABCMeta, abstractmethod
 
 from phobos.core.const import DSS_MEDIA # pylint: disable=no-name-in-module
@@ -387,7 +388,8 @@ class DSSHandle(Structure): # pylint: disable=too-few-public-methods
     Wrap connection to the backend. Absolutely opaque and propagated everywhere.
     """
     _fields_ = [
-        ('dh_conn', c_void_p)
+        ('dh_conn', c_void_p),
+        ('dh_prepared', c_uint64)
     ]
 
 class Client:
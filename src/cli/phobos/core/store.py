@@ -28,8 +28,9 @@ import logging
 import os
 
 from collections import namedtuple
-from ctypes import (byref, c_bool, c_char_p, c_int, c_ssize_t, c_void_p, cast,
-                    CFUNCTYPE, pointer, POINTER, py_object, Structure, Union)
+from ctypes import (byref, c_bool, c_char_p, c_int, c_size_t, c_ssize_t,
+                    c_void_p, cast, CFUNCTYPE, pointer, POINTER, py_object,
+                    Structure, Union)
 from typing import Optional
 
 from phobos.core.ffi import (LIBPHOBOS, DeprecatedObjectInfo, ObjectInfo,
@@ -155,6 +156,7 @@ class XferPutParams(Structure): # pylint: disable=too-few-public-methods, too-ma
         ("_copy_name", c_char_p),
         ("overwrite", c_bool),
         ("no_split", c_bool),
+        ("pack", c_bool),
     ]
 
     def set_lyt_params(self, val):
@@ -176,6 +178,7 @@ class XferPutParams(Structure): # pylint: disable=too-few-public-methods, too-ma
         self.copy_name = put_params.copy_name
         self.overwrite = put_params.overwrite
         self.no_split = put_params.no_split
+        self.pack = bool(put_params.pack)
 
         if put_params.family is None:
             self.family = PHO_RSC_INVAL
@@ -239,7 +242,7 @@ class XferPutParams(Structure): # pylint: disable=too-few-public-methods, too-ma
 
 class PutParams(namedtuple('PutParams',
                            'profile copy_name family grouping library layout '
-                           'lyt_params no_split overwrite tags')):
+                           'lyt_params no_split pack overwrite tags')):
     """
     Transition data structure for put parameters between
     the CLI and the XFer data structure.
@@ -253,12 +256,16 @@ class XferGetParams(Structure): # pylint: disable=too-few-public-methods, too-ma
         ("_copy_name", c_char_p),
         ("scope", c_int),
         ("_node_name", c_char_p),
+        ("offset", c_size_t),
+        ("length", c_size_t),
     ]
 
     def __init__(self, get_params):
         super().__init__()
         self.copy_name = get_params.copy_name
         self.node_name = get_params.node_name
+        self.offset = get_params.offset or 0
+        self.length = get_params.length or 0
         if get_params.scope is None:
             self.scope = DSS_OBJ_ALIVE
         else:
@@ -287,7 +294,8 @@ class XferGetParams(Structure): # pylint: disable=too-few-public-methods, too-ma
         self._node_name = val.encode('utf-8') if val else None
 
 
-class GetParams(namedtuple('GetParams', 'copy_name node_name scope')):
+class GetParams(namedtuple('GetParams',
+                           'copy_name node_name scope offset length')):
     """
     Transition data structure for get parameters between
     the CLI and the XFer data structure.
@@ -498,7 +506,9 @@ class XferDescriptor(Structure): # pylint: disable=too-many-instance-attributes
             # The CLI can only create a xfer with 1 target with a GET
             self.xd_targets[0].xt_objuuid = desc[2][0]
             self.xd_targets[0].xt_version = desc[2][1]
-            self.xd_params.get = XferGetParams(GetParams(copy_name=desc[2][2]))
+            self.xd_params.get = XferGetParams(
+                GetParams(copy_name=desc[2][2], offset=desc[2][3],
+                          length=desc[2][4]))
         elif self.xd_op == PHO_XFER_OP_GETMD:
             self.xd_targets[0].xt_objuuid = desc[2][0]
             self.xd_targets[0].xt_version = desc[2][1]
@@ -769,6 +779,49 @@ class UtilClient:
 
         return objs
 
+    @staticmethod
+    def object_iter(res, is_pattern, metadata, uuid, version, scope, **kwargs): # pylint: disable=too-many-arguments,too-many-locals
+        """List objects, yielding them by batches.
+
+        The objects of a batch are only valid until the next one is requested.
+        """
+        n_objs = c_int(0)
+        obj_type = ObjectInfo if scope == DSS_OBJ_ALIVE else \
+                        DeprecatedObjectInfo
+        objs = POINTER(obj_type)()
+        iterator = c_void_p()
+
+        sort, kwargs = dss_sort('object', **kwargs)
+        sref = byref(sort) if sort else None
+
+        list_filters = ListFilters(res=res, n_res=len(res), uuid=uuid,
+                                   version=version, is_pattern=is_pattern,
+                                   metadata=metadata, n_metadata=len(metadata),
+                                   status_filter=0, copy_name=None)
+
+        filters_ref = byref(PhoListFilters(list_filters))
+        items = f"object(s) '{res}'" if res else "all objects"
+        rc = LIBPHOBOS.phobos_store_object_iter_open(filters_ref, scope, sref,
+                                                     byref(iterator))
+        if rc:
+            raise EnvironmentError(rc, f"Failed to list {items}")
+
+        try:
+            while True:
+                rc = LIBPHOBOS.phobos_store_object_iter_next(iterator,
+                                                             byref(objs),
+                                                             byref(n_objs))
+                if rc:
+                    raise EnvironmentError(rc, f"Failed to list {items}")
+
+                if n_objs.value == 0:
+                    break
+
+                yield (obj_type * n_objs.value).from_address(
+                    cast(objs, c_void_p).value)
+        finally:
+            LIBPHOBOS.phobos_store_object_iter_close(iterator)
+
     @staticmethod
     def list_obj_free(objs, n_objs):
         """Free a previously obtained object list."""
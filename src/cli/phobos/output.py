@@ -27,6 +27,7 @@ from collections import OrderedDict
 import csv
 from io import StringIO
 import json
+import sys
 import xml.dom.minidom
 import xml.etree.ElementTree
 from tabulate import tabulate
@@ -34,17 +35,17 @@ import yaml
 
 from phobos.core.utils import bytes2human
 
-def csv_dump(data):
+def csv_dump(data, header=True):
     """Convert a list of dictionaries to a csv string"""
     outbuf = StringIO()
     dialect = csv.excel
     dialect.doublequote = False
     dialect.escapechar = '\\'
     writer = csv.DictWriter(outbuf, data[0].keys(), dialect=dialect)
-    if hasattr(writer, 'writeheader'):
+    if header and hasattr(writer, 'writeheader'):
         #pylint: disable=no-member
         writer.writeheader()
-    else:
+    elif header:
         writer.writerow(dict((item, item) for item in data[0]))
     writer.writerows(data)
     out = outbuf.getvalue()
@@ -103,11 +104,8 @@ def filter_display_dict(objs, attrs, max_width, fmt):
     return obj_list
 
 
-def dump_object_list(objs, attr=None, max_width=None, fmt="human"):
-    """Helper for user friendly object display."""
-    if not objs:
-        return
-
+def dump_formats(attr):
+    """Formatters of a list of display dictionaries, by output format."""
     formats = {
         'json' : json.dumps,
         'yaml' : yaml.dump,
@@ -119,6 +117,15 @@ def dump_object_list(objs, attr=None, max_width=None, fmt="human"):
     if attr is not None and (len(attr) > 1 or attr == ['*'] or attr == ['all']):
         formats['human'] = human_pretty_dump
 
+    return formats
+
+def dump_object_list(objs, attr=None, max_width=None, fmt="human"):
+    """Helper for user friendly object display."""
+    if not objs:
+        return
+
+    formats = dump_formats(attr)
+
     # Do not convert JSON values to string as they are processed by
     # get_display_dict
     objlist = filter_display_dict(objs, attr, max_width,
@@ -126,3 +133,45 @@ def dump_object_list(objs, attr=None, max_width=None, fmt="human"):
 
     # Remove the endstring newline generated by csv, yaml and xml formatters
     print(formats[fmt](objlist).rstrip())
+
+def dump_object_batches(batches, attr=None, max_width=None, fmt="human"):
+    """Helper for user friendly display of objects retrieved by batches.
+
+    The json, yaml, csv and identifier list outputs are printed batch by batch,
+    with the same result as dump_object_list() on all the objects. The xml and
+    table outputs need every object, so only their display dictionaries are
+    kept until the last batch.
+    """
+    formats = dump_formats(attr)
+    streamed = {
+        'json' : lambda data, first: ('[' if first else ', ') +
+                                     ', '.join(json.dumps(item)
+                                               for item in data),
+        'yaml' : lambda data, first: yaml.dump(data),
+        'csv'  : csv_dump,
+        'human': lambda data, first: human_dump(data) + '\n',
+    }
+    if formats['human'] is not human_dump:
+        del streamed['human']
+
+    pending = None
+    objlist = []
+    for objs in batches:
+        batch = filter_display_dict(objs, attr, max_width,
+                                    (lambda x: x) if fmt == "json" else None)
+        if not batch:
+            continue
+
+        if fmt not in streamed:
+            objlist.extend(batch)
+            continue
+
+        # The last output is held back to remove its endstring newline
+        if pending is not None:
+            sys.stdout.write(pending)
+        pending = streamed[fmt](batch, pending is None)
+
+    if pending is not None:
+        print((pending + (']' if fmt == 'json' else '')).rstrip())
+    elif objlist:
+        print(formats[fmt](objlist).rstrip())
@@ -0,0 +1,61 @@
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos cfg of the local device manager.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "pho_cfg.h"
+#include "pho_common.h"
+
+enum pho_cfg_params_ldm {
+    /* Actual parameters */
+    PHO_CFG_LDM_tape_backend,
+
+    /* Delimiters, update when modifying options */
+    PHO_CFG_LDM_FIRST = PHO_CFG_LDM_tape_backend,
+    PHO_CFG_LDM_LAST  = PHO_CFG_LDM_tape_backend,
+};
+
+const struct pho_config_item cfg_ldm[] = {
+    [PHO_CFG_LDM_tape_backend] = {
+        .section = "ldm",
+        .name    = "tape_backend",
+        .value   = "scsi"
+    },
+};
+
+bool cfg_tape_backend_is_sim(void)
+{
+    const char *backend;
+
+    backend = PHO_CFG_GET(cfg_ldm, PHO_CFG_LDM, tape_backend);
+    if (!backend || !strcmp(backend, "scsi"))
+        return false;
+
+    if (!strcmp(backend, "sim"))
+        return true;
+
+    pho_warn("Invalid tape backend '%s' (expected 'scsi' or 'sim'), using "
+             "'scsi'", backend);
+    return false;
+}
@@ -0,0 +1,249 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Multi-producer single-consumer FIFO queue
+ *
+ * The ring follows the bounded queue of D. Vyukov: each slot holds a sequence
+ * number telling the position it may be pushed to next, so that producers
+ * only contend on the tail with a compare-and-swap, and the consumer never
+ * writes to the tail.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "pho_common.h"
+#include "pho_mpsc_queue.h"
+
+int mpsc_queue_init(struct mpsc_queue *queue, size_t capacity)
+{
+    size_t size = 2;
+    size_t i;
+    int rc;
+
+    while (size < capacity)
+        size <<= 1;
+
+    queue->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (queue->efd < 0)
+        LOG_RETURN(-errno, "Unable to create the eventfd of a queue");
+
+    rc = pthread_mutex_init(&queue->overflow_mutex, NULL);
+    if (rc) {
+        close(queue->efd);
+        LOG_RETURN(-rc, "Unable to init queue overflow mutex");
+    }
+
+    queue->cells = xmalloc(size * sizeof(*queue->cells));
+    for (i = 0; i < size; i++)
+        atomic_init(&queue->cells[i].seq, i);
+
+    queue->mask = size - 1;
+    queue->head = 0;
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->length, 0);
+    atomic_init(&queue->n_overflow, 0);
+    atomic_init(&queue->waiting, false);
+    queue->overflow = g_queue_new();
+
+    return 0;
+}
+
+void mpsc_queue_destroy(struct mpsc_queue *queue, GDestroyNotify free_func)
+{
+    void *data;
+    int rc;
+
+    while ((data = mpsc_queue_pop(queue)) != NULL)
+        if (free_func)
+            free_func(data);
+
+    g_queue_free(queue->overflow);
+    free(queue->cells);
+    close(queue->efd);
+
+    rc = pthread_mutex_destroy(&queue->overflow_mutex);
+    if (rc)
+        pho_error(-rc, "Unable to destroy queue overflow mutex");
+}
+
+/** Push to the ring, return false if it is full */
+static bool ring_push(struct mpsc_queue *queue, void *data)
+{
+    size_t pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    struct mpsc_cell *cell;
+
+    while (true) {
+        intptr_t diff;
+        size_t seq;
+
+        cell = &queue->cells[pos & queue->mask];
+        seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos,
+                                                      pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            /* the slot still holds the element pushed one lap ago */
+            return false;
+        } else {
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+
+    cell->data = data;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    return true;
+}
+
+/** Pop from the ring, return NULL if no element is ready */
+static void *ring_pop(struct mpsc_queue *queue)
+{
+    struct mpsc_cell *cell = &queue->cells[queue->head & queue->mask];
+    size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+    void *data;
+
+    if (seq != queue->head + 1)
+        return NULL;
+
+    data = cell->data;
+    /* the slot can be pushed to on the next lap */
+    atomic_store_explicit(&cell->seq, queue->head + queue->mask + 1,
+                          memory_order_release);
+    queue->head++;
+
+    return data;
+}
+
+static void wakeup_consumer(struct mpsc_queue *queue)
+{
+    /* the element must be visible before the consumer state is checked, so
+     * that a consumer announcing its wait after this check sees it
+     */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (!atomic_load_explicit(&queue->waiting, memory_order_relaxed))
+        return;
+
+    if (atomic_exchange(&queue->waiting, false))
+        /* cannot fail but on counter overflow, which still wakes it up */
+        (void)eventfd_write(queue->efd, 1);
+}
+
+void mpsc_queue_push(struct mpsc_queue *queue, void *data)
+{
+    assert(data != NULL);
+
+    atomic_fetch_add_explicit(&queue->length, 1, memory_order_relaxed);
+
+    /* Once an element overflowed, the next ones follow it until the consumer
+     * empties the overflow, to keep the order of each producer.
+     */
+    if (atomic_load_explicit(&queue->n_overflow, memory_order_acquire) > 0 ||
+        !ring_push(queue, data)) {
+        MUTEX_LOCK(&queue->overflow_mutex);
+        g_queue_push_head(queue->overflow, data);
+        atomic_fetch_add_explicit(&queue->n_overflow, 1, memory_order_release);
+        MUTEX_UNLOCK(&queue->overflow_mutex);
+    }
+
+    wakeup_consumer(queue);
+}
+
+void *mpsc_queue_pop(struct mpsc_queue *queue)
+{
+    void *data;
+
+    data = ring_pop(queue);
+    if (!data &&
+        atomic_load_explicit(&queue->n_overflow, memory_order_acquire) > 0) {
+        MUTEX_LOCK(&queue->overflow_mutex);
+        data = g_queue_pop_tail(queue->overflow);
+        if (data)
+            atomic_fetch_sub_explicit(&queue->n_overflow, 1,
+                                      memory_order_release);
+        MUTEX_UNLOCK(&queue->overflow_mutex);
+    }
+
+    if (data)
+        atomic_fetch_sub_explicit(&queue->length, 1, memory_order_relaxed);
+
+    return data;
+}
+
+static bool queue_is_ready(struct mpsc_queue *queue)
+{
+    struct mpsc_cell *cell = &queue->cells[queue->head & queue->mask];
+
+    return atomic_load_explicit(&cell->seq, memory_order_acquire) ==
+               queue->head + 1 ||
+           atomic_load_explicit(&queue->n_overflow, memory_order_acquire) > 0;
+}
+
+int mpsc_queue_arm_wakeup(struct mpsc_queue *queue)
+{
+    atomic_store(&queue->waiting, true);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (queue_is_ready(queue) && atomic_exchange(&queue->waiting, false))
+        (void)eventfd_write(queue->efd, 1);
+
+    return queue->efd;
+}
+
+int mpsc_queue_wait(struct mpsc_queue *queue, int timeout_ms)
+{
+    struct pollfd pfd = {
+        .fd = mpsc_queue_arm_wakeup(queue),
+        .events = POLLIN,
+    };
+    eventfd_t value;
+    int rc;
+
+    rc = poll(&pfd, 1, timeout_ms);
+    if (rc < 0) {
+        rc = -errno;
+        atomic_store(&queue->waiting, false);
+        return rc;
+    }
+
+    if (rc == 0) {
+        atomic_store(&queue->waiting, false);
+        /* a producer may have woken us up meanwhile */
+        return queue_is_ready(queue) ? 0 : -ETIMEDOUT;
+    }
+
+    (void)eventfd_read(queue->efd, &value);
+
+    return 0;
+}
@@ -478,6 +478,26 @@ void layout_info_free_extents(struct layout_info *layout)
     layout->extents = NULL;
 }
 
+ssize_t extent_pack_offset(struct extent *extent)
+{
+    const char *offset = pho_attr_get(&extent->info, PHO_EXT_PACK_OFFSET_NAME);
+    int64_t value;
+
+    if (!offset)
+        return -1;
+
+    value = str2int64(offset);
+    return value < 0 ? -1 : value;
+}
+
+void extent_set_pack_offset(struct extent *extent, size_t offset)
+{
+    char buff[32];
+
+    snprintf(buff, sizeof(buff), "%zu", offset);
+    pho_attr_set(&extent->info, PHO_EXT_PACK_OFFSET_NAME, buff);
+}
+
 int tsqueue_init(struct tsqueue *tsqueue)
 {
     int rc;
@@ -32,15 +32,19 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <netdb.h>
 #include <net/if.h>
+#include <poll.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
@@ -50,21 +54,34 @@
 /** Used to limit the received buffer size and avoid large allocations. */
 #define MAX_RECV_BUF_SIZE (2*1024*1024LL)
 
+/** Initial size of the reception buffer of a client connection. */
+#define RECV_BUF_INIT_SIZE (64*1024)
+
+/** Messages of a batch whose framing is built on the stack. */
+#define SEND_STACK_FRAMES 16
+
+/** Time to wait, in ms, for a socket to become writable before retrying. */
+#define SEND_POLL_TIMEOUT_MS 10000
+
 enum _pho_comm_cri_msg_kind {
-    PHO_CRI_MSG_SIZE,
-    PHO_CRI_MSG_BUFF
+    PHO_CRI_MSG,        /*!< Listening socket or client connection */
+    PHO_CRI_WAKEUP      /*!< Eventfd ending the wait of the server */
 };
 
-/** Used to track the context of each incoming message in epoll. */
+/**
+ * Used to track the context of each connection in epoll.
+ *
+ * The data of a client connection are received in a buffer reused for its
+ * successive messages, each recv() bringing as many messages as available.
+ */
 struct _pho_comm_recv_info {
     int fd;         /*!< Socket descriptor. */
     enum _pho_comm_cri_msg_kind mkind;
-                    /*!< Message kind, used to determine what we are
-                     *   currently reading.
-                     */
-    size_t len;     /*!< Requested buffer size. */
-    size_t cur;     /*!< Current size of received data. */
-    char *buf;      /*!< Buffer. */
+                    /*!< Kind of descriptor. */
+    size_t size;    /*!< Allocated size of the buffer. */
+    size_t start;   /*!< Start of the data not delivered yet. */
+    size_t end;     /*!< End of the received data. */
+    char *buf;      /*!< Reception buffer, NULL until data are received. */
 };
 
 int tlc_hostname_from_cfg(const char *library, const char **tlc_hostname)
@@ -240,15 +257,14 @@ int tlc_lib_device_from_cfg(const char *library, char ***tlc_lib_devices,
 
 static inline void _init_comm_recv_info(struct _pho_comm_recv_info *cri,
                                         const int fd,
-                                        const enum _pho_comm_cri_msg_kind mkind,
-                                        const size_t len,
-                                        const size_t cur, char *buf)
+                                        const enum _pho_comm_cri_msg_kind mkind)
 {
     cri->fd = fd;
     cri->mkind = mkind;
-    cri->len = len;
-    cri->cur = cur;
-    cri->buf = buf;
+    cri->size = 0;
+    cri->start = 0;
+    cri->end = 0;
+    cri->buf = NULL;
 }
 
 /**
@@ -453,10 +469,8 @@ int pho_comm_open(struct pho_comm_info *ci, const union pho_comm_addr *addr,
     /* server: bind / listen / epoll */
     cri = xmalloc(sizeof(*cri));
 
-    /* only initialize the fd field here: the other ones are not used for
-     * accepting new clients.
-     */
-    _init_comm_recv_info(cri, ci->socket_fd, PHO_CRI_MSG_SIZE, 0, 0, NULL);
+    /* the buffer is not used for accepting new clients */
+    _init_comm_recv_info(cri, ci->socket_fd, PHO_CRI_MSG);
 
     ev.events = EPOLLIN;
     ev.data.ptr = cri;
@@ -558,79 +572,172 @@ int pho_comm_close(struct pho_comm_info *ci)
     return rc;
 }
 
-static int _send_until_complete(int fd, const void *buf, size_t size)
+/**
+ * Send the buffers of \p iov until they are all sent or on failure.
+ *
+ * \p iov is modified to track the data left to send.
+ *
+ * \param[in]       fd          Socket descriptor.
+ * \param[in,out]   iov         Buffers to send.
+ * \param[in]       iovcnt      Number of buffers.
+ * \param[out]      iov_sent    Number of buffers fully sent.
+ *
+ * \return                      0 on success, -errno on failure.
+ */
+static int _send_until_complete(int fd, struct iovec *iov, size_t iovcnt,
+                                size_t *iov_sent)
 {
-    struct timeval tv = {
-        .tv_sec = 10,
-        .tv_usec = 0
+    struct pollfd pfd = {
+        .fd = fd,
+        .events = POLLOUT,
     };
+    struct msghdr msg = {0};
+    size_t done = 0;
     ssize_t count;
-    fd_set wfds;
     int rc = 0;
 
-    while (size) {
-        count = send(fd, buf, size, MSG_NOSIGNAL);
-        if (count > 0) {
-            buf += count;
-            size -= count;
-            continue;
-        }
+    while (done < iovcnt) {
+        msg.msg_iov = iov + done;
+        msg.msg_iovlen = min(iovcnt - done, (size_t)IOV_MAX);
 
+        count = sendmsg(fd, &msg, MSG_NOSIGNAL);
         if (count == -1) {
-            if (errno != EAGAIN)
-                return -errno;
+            if (errno == EINTR)
+                continue;
+
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                GOTO(out, rc = -errno);
 
             /* Wait until the socket is writable */
-            FD_ZERO(&wfds);
-            FD_SET(fd, &wfds);
+            if (poll(&pfd, 1, SEND_POLL_TIMEOUT_MS) < 0 && errno != EINTR)
+                GOTO(out, rc = -errno);
+
+            continue;
+        }
+
+        /* skip the buffers fully sent and the sent part of the next one */
+        while (done < iovcnt && (size_t)count >= iov[done].iov_len) {
+            count -= iov[done].iov_len;
+            done++;
+        }
 
-            rc = select(fd + 1, NULL, &wfds, NULL, &tv);
-            if (rc < 0)
-                return -errno;
+        if (count > 0) {
+            iov[done].iov_base = (char *)iov[done].iov_base + count;
+            iov[done].iov_len -= count;
         }
     }
 
-    return 0;
+out:
+    *iov_sent = done;
+    return rc;
 }
 
 /**
- * The message is split in two parts:
+ * Each message is split in two parts, sent with a single system call:
  * - the buffer size (a 32-bit integer)
  * - the buffer contents (a byte array)
  */
+static int _send_frames(const struct pho_comm_data *data, size_t n_data,
+                        uint32_t *tlen, struct iovec *iov, size_t *n_sent)
+{
+    size_t iov_sent;
+    size_t i;
+    int rc;
+
+    for (i = 0; i < n_data; i++) {
+        assert(data[i].fd == data[0].fd); /* if assert, programming error */
+
+        tlen[i] = htonl(data[i].buf.size);
+        iov[2 * i].iov_base = &tlen[i];
+        iov[2 * i].iov_len = sizeof(tlen[i]);
+        iov[2 * i + 1].iov_base = data[i].buf.buff;
+        iov[2 * i + 1].iov_len = data[i].buf.size;
+    }
+
+    rc = _send_until_complete(data[0].fd, iov, 2 * n_data, &iov_sent);
+    if (n_sent)
+        *n_sent = iov_sent / 2;
+
+    return rc;
+}
+
 int pho_comm_send(const struct pho_comm_data *data)
 {
+    struct iovec iov[2];
     uint32_t tlen;
     int rc;
 
     assert(data->fd >= 0); /* if assert, programming error */
 
-    tlen = htonl(data->buf.size);
-
-    rc = _send_until_complete(data->fd, &tlen, sizeof(tlen));
-    if (rc)
-        LOG_RETURN(rc, "Socket send failed (size part)");
-
-    rc = _send_until_complete(data->fd, data->buf.buff, data->buf.size);
+    rc = _send_frames(data, 1, &tlen, iov, NULL);
     if (rc)
-        LOG_RETURN(rc, "Socket send failed (contents part)");
+        LOG_RETURN(rc, "Socket send failed");
 
     pho_debug("Sending %zu bytes", data->buf.size);
 
     return 0;
 }
 
+int pho_comm_send_batch(const struct pho_comm_data *data, size_t n_data,
+                        size_t *n_sent)
+{
+    struct iovec stack_iov[2 * SEND_STACK_FRAMES];
+    uint32_t stack_tlen[SEND_STACK_FRAMES];
+    struct iovec *iov = stack_iov;
+    uint32_t *tlen = stack_tlen;
+    size_t sent = 0;
+    size_t size = 0;
+    size_t i;
+    int rc;
+
+    if (n_data == 0)
+        GOTO(out, rc = 0);
+
+    assert(data->fd >= 0); /* if assert, programming error */
+
+    if (n_data > SEND_STACK_FRAMES) {
+        iov = xmalloc(2 * n_data * sizeof(*iov));
+        tlen = xmalloc(n_data * sizeof(*tlen));
+    }
+
+    rc = _send_frames(data, n_data, tlen, iov, &sent);
+
+    if (iov != stack_iov) {
+        free(iov);
+        free(tlen);
+    }
+
+    if (rc)
+        LOG_GOTO(out, rc, "Socket send failed after %zu of %zu messages",
+                 sent, n_data);
+
+    for (i = 0; i < n_data; i++)
+        size += data[i].buf.size;
+
+    pho_debug("Sending %zu messages of %zu bytes", n_data, size);
+
+out:
+    if (n_sent)
+        *n_sent = sent;
+
+    return rc;
+}
+
 /**
  * Read data until the message is fully received or failure (timeout or error).
  *
  * \return      0     if the message is complete,
  *             -errno else
  */
-static int _recv_full(struct _pho_comm_recv_info *cri)
+static int _recv_full(int fd, void *buf, size_t len)
 {
     ssize_t sz;
 
-    sz = recv(cri->fd, cri->buf, cri->len, MSG_WAITALL);
+    /* an empty message has no contents to wait for */
+    if (len == 0)
+        return 0;
+
+    sz = recv(fd, buf, len, MSG_WAITALL);
 
     if (sz == -1)
         return -errno;
@@ -641,27 +748,113 @@ static int _recv_full(struct _pho_comm_recv_info *cri)
 }
 
 /**
- * Read the available data.
+ * Get the size of the first message not delivered yet of a client connection.
+ *
+ * \return      0        if the size of the message is received,
+ *             -EAGAIN   if the size is not fully received,
+ *             -EBADMSG  if the message is too large
+ */
+static int _pending_msg_size(struct _pho_comm_recv_info *cri, size_t *len)
+{
+    uint32_t tlen;
+
+    if (cri->end - cri->start < sizeof(tlen))
+        return -EAGAIN;
+
+    memcpy(&tlen, cri->buf + cri->start, sizeof(tlen));
+    *len = ntohl(tlen);
+    if (*len > MAX_RECV_BUF_SIZE)
+        LOG_RETURN(-EBADMSG, "Requested buffer size is too large");
+
+    return 0;
+}
+
+/**
+ * Read the available data of a client connection after the ones already
+ * received, making room for the whole pending message.
  *
- * \return      0      if all data were read,
- *             -EAGAIN if not all data were read,
+ * \return      0      if data were read,
+ *             -EAGAIN if no data are available,
  *             -errno  else
  */
-static int _recv_partial(struct _pho_comm_recv_info *cri)
+static int _recv_available(struct _pho_comm_recv_info *cri)
 {
+    size_t needed = RECV_BUF_INIT_SIZE;
     ssize_t sz;
+    size_t len;
+    int rc;
 
-    sz = recv(cri->fd, cri->buf + cri->cur, cri->len - cri->cur, MSG_DONTWAIT);
+    /* move the pending message at the start of the buffer */
+    if (cri->start > 0) {
+        memmove(cri->buf, cri->buf + cri->start, cri->end - cri->start);
+        cri->end -= cri->start;
+        cri->start = 0;
+    }
+
+    rc = _pending_msg_size(cri, &len);
+    if (rc == -EBADMSG)
+        return rc;
+    else if (rc == 0)
+        needed = max(needed, sizeof(uint32_t) + len);
+
+    if (cri->size < needed) {
+        cri->buf = xrealloc(cri->buf, needed);
+        cri->size = needed;
+    }
+
+    sz = recv(cri->fd, cri->buf + cri->end, cri->size - cri->end,
+              MSG_DONTWAIT);
 
     if (sz == -1)
         return -errno;
     else if (sz == 0)
         return -ENOTCONN;
 
-    cri->cur += sz;
-    if (cri->cur != cri->len) {
-        pho_debug("Message is incomplete, must be retrieved later");
+    cri->end += sz;
+
+    return 0;
+}
+
+/**
+ * Deliver the first message received by a client connection.
+ *
+ * The contents are copied to a buffer owned by the caller, so that the
+ * reception buffer can be reused.
+ *
+ * \return      0        if a message is delivered in \p data,
+ *             -EAGAIN   if no message is fully received,
+ *             -EBADMSG  if the message is too large
+ */
+static int _deliver_msg(struct _pho_comm_recv_info *cri,
+                        struct pho_comm_data *data)
+{
+    size_t len;
+    int rc;
+
+    rc = _pending_msg_size(cri, &len);
+    if (rc)
+        return rc;
+
+    if (cri->end - cri->start < sizeof(uint32_t) + len)
         return -EAGAIN;
+
+    data->fd = cri->fd;
+    data->buf.size = len;
+    data->buf.buff = xmalloc(len);
+    memcpy(data->buf.buff, cri->buf + cri->start + sizeof(uint32_t), len);
+    cri->start += sizeof(uint32_t) + len;
+
+    pho_debug("Received a message of %zu bytes", len);
+
+    if (cri->start == cri->end) {
+        cri->start = 0;
+        cri->end = 0;
+        /* do not keep the room of a large message */
+        if (cri->size > RECV_BUF_INIT_SIZE) {
+            free(cri->buf);
+            cri->buf = NULL;
+            cri->size = 0;
+        }
     }
 
     return 0;
@@ -673,7 +866,6 @@ static int _recv_partial(struct _pho_comm_recv_info *cri)
 static int _recv_client(struct pho_comm_info *ci, struct pho_comm_data **data,
                         int *nb_data)
 {
-    struct _pho_comm_recv_info cri;
     uint32_t tlen;
     int rc = 0;
 
@@ -682,10 +874,7 @@ static int _recv_client(struct pho_comm_info *ci, struct pho_comm_data **data,
     *data = xmalloc(sizeof(**data));
 
     /* receiving buffer size */
-    _init_comm_recv_info(&cri, ci->socket_fd, PHO_CRI_MSG_SIZE, sizeof(tlen),
-                         0, (char *)&tlen);
-
-    rc = _recv_full(&cri);
+    rc = _recv_full(ci->socket_fd, &tlen, sizeof(tlen));
     /* considering no response (which is a success) */
     if (rc == -EAGAIN || rc == -EWOULDBLOCK) {
         rc = 0;
@@ -702,10 +891,7 @@ static int _recv_client(struct pho_comm_info *ci, struct pho_comm_data **data,
                                 sizeof(*(*data)->buf.buff));
 
     /* receiving buffer contents */
-    _init_comm_recv_info(&cri, ci->socket_fd, PHO_CRI_MSG_BUFF,
-                         (*data)->buf.size, 0, (*data)->buf.buff);
-
-    rc = _recv_full(&cri);
+    rc = _recv_full(ci->socket_fd, (*data)->buf.buff, (*data)->buf.size);
     if (rc)
         LOG_GOTO(err_buf, rc, "Client socket recv failed");
 
@@ -757,7 +943,7 @@ static int _process_accept(struct pho_comm_info *ci,
     }
 
     n_cri = xmalloc(sizeof(*n_cri));
-    _init_comm_recv_info(n_cri, sfd, PHO_CRI_MSG_SIZE, 0, 0, NULL);
+    _init_comm_recv_info(n_cri, sfd, PHO_CRI_MSG);
 
     ev.data.ptr = n_cri;
     ev.events = EPOLLIN;
@@ -801,46 +987,18 @@ static int _process_close(struct pho_comm_info *ci,
     return rc;
 }
 
-static int _process_recv_size(struct pho_comm_info *ci,
-                              struct _pho_comm_recv_info *cri,
-                              struct pho_comm_data *data)
-{
-    int tlen;
-    int rc;
-
-    if (!cri->buf) { /* not resuming, allocate the size buffer */
-        char *buf = xmalloc(sizeof(tlen));
-
-        _init_comm_recv_info(cri, cri->fd, PHO_CRI_MSG_SIZE, sizeof(tlen), 0,
-                             buf);
-    }
-
-    rc = _recv_partial(cri);
-    if (rc)
-        return rc;
-
-    /* initializing recv_info for the message contents */
-    memcpy(&tlen, cri->buf, sizeof(tlen));
-    free(cri->buf);
-
-    _init_comm_recv_info(cri, cri->fd, PHO_CRI_MSG_BUFF, ntohl(tlen), 0, NULL);
-    if (cri->len > MAX_RECV_BUF_SIZE)
-        LOG_RETURN(rc = -EBADMSG, "Requested buffer size is too large");
-
-    return rc;
-}
-
-static int _process_recv_contents(struct pho_comm_info *ci,
-                                  struct _pho_comm_recv_info *cri,
-                                  struct pho_comm_data *data)
+/**
+ * Get the next entry of the received data array, growing it if full.
+ */
+static struct pho_comm_data *_next_data(struct pho_comm_data **data,
+                                        size_t *n_alloc, size_t idx_data)
 {
-    if (!cri->buf) { /* not resuming, allocate the msg buffer */
-        char *buf = xmalloc(cri->len);
-
-        _init_comm_recv_info(cri, cri->fd, PHO_CRI_MSG_BUFF, cri->len, 0, buf);
+    if (idx_data == *n_alloc) {
+        *n_alloc *= 2;
+        *data = xrealloc(*data, *n_alloc * sizeof(**data));
     }
 
-    return _recv_partial(cri);
+    return *data + idx_data;
 }
 
 /**
@@ -851,16 +1009,19 @@ static int _recv_server(struct pho_comm_info *ci, struct pho_comm_data **data,
 {
     struct epoll_event ev[g_hash_table_size(ci->ev_tab)];
     int idx_event, idx_data = 0;
+    size_t n_alloc;
+    int n_events;
     int rca = 0;
 
+    *nb_data = 0;
+
     /* probing the socket poll */
-    *nb_data = epoll_wait(ci->epoll_fd, ev, g_hash_table_size(ci->ev_tab), 100);
+    n_events = epoll_wait(ci->epoll_fd, ev, g_hash_table_size(ci->ev_tab), 100);
     rca = -errno;
-    if (*nb_data == 0)
+    if (n_events == 0)
         return 0;
 
-    if (*nb_data == -1) {
-        *nb_data = 0;
+    if (n_events == -1) {
         if (rca == -EINTR)
             return 0;
 
@@ -868,14 +1029,22 @@ static int _recv_server(struct pho_comm_info *ci, struct pho_comm_data **data,
     }
 
     rca = 0;
-    *data = xmalloc(*nb_data * sizeof(**data));
+    n_alloc = n_events;
+    *data = xmalloc(n_alloc * sizeof(**data));
 
     /* processing the socket poll events */
-    for (idx_event = 0; idx_event < *nb_data; ++idx_event) {
+    for (idx_event = 0; idx_event < n_events; ++idx_event) {
         int rc;
         struct _pho_comm_recv_info *cri
             = (struct _pho_comm_recv_info *) ev[idx_event].data.ptr;
 
+        if (cri->mkind == PHO_CRI_WAKEUP) {
+            eventfd_t value;
+
+            (void)eventfd_read(cri->fd, &value);
+            continue;
+        }
+
         if (cri->fd == ci->socket_fd) { /* accept socket */
             rc = _process_accept(ci, cri);
             if (rc) {
@@ -885,69 +1054,39 @@ static int _recv_server(struct pho_comm_info *ci, struct pho_comm_data **data,
             continue;
         }
 
-        /* receiving a client message */
-        if (cri->mkind == PHO_CRI_MSG_SIZE) {
-            rc = _process_recv_size(ci, cri, (*data) + idx_data);
+        /* receiving the client messages, as many as available */
+        rc = _recv_available(cri);
+        if (rc == -EAGAIN || rc == -EWOULDBLOCK || rc == -EINTR)
+            continue;
 
-            if (rc) {
-                if (rc == -EAGAIN || rc == -EWOULDBLOCK)
-                    continue;
-                if (rc == -ENOMEM)
-                    LOG_GOTO(err, rc = -ENOMEM, "Error on allocation during "
-                             "receiving");
-                else if (rc != -ENOTCONN && rc != -ECONNRESET)
-                    pho_error(rc, "Error with client connection, "
-                              "will close it");
-                else /* ENOTCONN & ECONNRESET are not considered as an error */
-                    rc = 0;
-
-                _process_close(ci, cri, (*data) + idx_data);
+        while (!rc) {
+            rc = _deliver_msg(cri, _next_data(data, &n_alloc, idx_data));
+            if (!rc)
                 ++idx_data;
-                rca = rca ? : rc;
-                continue;
-            }
         }
 
-        /* receiving the message contents */
-        rc = _process_recv_contents(ci, cri, (*data) + idx_data);
-        if (rc) {
-            /* EAGAIN means we will try again later, not an error */
-            if (rc != -EAGAIN) {
-                pho_error(rc, "Error with client connection, "
-                        "will close it");
-                _process_close(ci, cri, (*data) + idx_data);
-                ++idx_data;
-                rca = rca ? : rc;
-            }
+        /* EAGAIN means the next message will be completed later */
+        if (rc == -EAGAIN)
             continue;
-        }
 
-        pho_debug("Received a message of %zu bytes", cri->len);
+        /* ENOTCONN & ECONNRESET are not considered as an error */
+        if (rc == -ENOTCONN || rc == -ECONNRESET)
+            rc = 0;
+        else
+            pho_error(rc, "Error with client connection, will close it");
 
-        (*data)[idx_data].fd = cri->fd;
-        (*data)[idx_data].buf.size = cri->len;
-        (*data)[idx_data].buf.buff = cri->buf;
+        _process_close(ci, cri, _next_data(data, &n_alloc, idx_data));
         ++idx_data;
-
-        /* init for next message */
-        _init_comm_recv_info(cri, cri->fd, PHO_CRI_MSG_SIZE, 0, 0, NULL);
+        rca = rca ? : rc;
     }
 
-err:
-    if (idx_data != *nb_data) {
-        struct pho_comm_data *ndata;
-
-        if (idx_data == 0) {
-            free(*data);
-            ndata = NULL;
-        } else {
-            ndata = xrealloc(*data, idx_data * sizeof(**data));
-        }
-
-        *data = ndata;
-        *nb_data = idx_data;
+    if (idx_data == 0) {
+        free(*data);
+        *data = NULL;
     }
 
+    *nb_data = idx_data;
+
     return rca;
 }
 
@@ -963,3 +1102,56 @@ int pho_comm_recv(struct pho_comm_info *ci, struct pho_comm_data **data,
 
     return _recv_client(ci, data, nb_data);
 }
+
+int pho_comm_add_wakeup_fd(struct pho_comm_info *ci, int fd)
+{
+    struct _pho_comm_recv_info *cri;
+    struct epoll_event ev = {0};
+    int dup_fd;
+
+    assert(ci->type == PHO_COMM_UNIX_SERVER ||
+           ci->type == PHO_COMM_TCP_SERVER);
+
+    dup_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (dup_fd == -1)
+        LOG_RETURN(-errno, "Failed to duplicate wakeup descriptor");
+
+    cri = xmalloc(sizeof(*cri));
+    _init_comm_recv_info(cri, dup_fd, PHO_CRI_WAKEUP);
+
+    ev.data.ptr = cri;
+    ev.events = EPOLLIN;
+    if (epoll_ctl(ci->epoll_fd, EPOLL_CTL_ADD, dup_fd, &ev)) {
+        _release_comm_recv_info(cri);
+        LOG_RETURN(-errno, "Socket poll control failed in adding wakeup");
+    }
+
+    g_hash_table_insert(ci->ev_tab, &cri->fd, cri);
+
+    return 0;
+}
+
+int pho_comm_wait(struct pho_comm_info *ci, int timeout_ms)
+{
+    struct pollfd pfd = {
+        .fd = ci->socket_fd,
+        .events = POLLIN,
+    };
+    int rc;
+
+    assert(ci->socket_fd >= 0); /* if assert, programming error */
+
+    /* servers already wait for their events in pho_comm_recv() */
+    if (ci->type == PHO_COMM_UNIX_SERVER || ci->type == PHO_COMM_TCP_SERVER)
+        return 1;
+
+    rc = poll(&pfd, 1, timeout_ms);
+    if (rc < 0) {
+        if (errno == EINTR)
+            return 0;
+
+        LOG_RETURN(-errno, "Client socket poll failed");
+    }
+
+    return rc;
+}
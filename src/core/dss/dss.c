@@ -42,6 +42,7 @@
 
 #include "deprecated.h"
 #include "device.h"
+#include "extent.h"
 #include "dss_config.h"
 #include "dss_utils.h"
 #include "filters.h"
@@ -126,6 +127,7 @@ int dss_init(struct dss_handle *handle)
         LOG_RETURN(-EINVAL, "No connection string from config");
 
     handle->dh_conn = PQconnectdb(conn_str);
+    handle->dh_prepared = 0;
 
     if (PQstatus(handle->dh_conn) != CONNECTION_OK) {
         rc = -ENOTCONN;
@@ -161,23 +163,19 @@ static void _dss_result_free(struct dss_result *dss_res, int item_cnt)
 
 }
 
-int dss_execute_generic_get(struct dss_handle *handle, enum dss_type type,
-                            GString *clause, void **item_list, int *item_cnt)
+/**
+ * Convert the rows of \p res into a list of items of type \p type, owning
+ * \p res on success.
+ */
+static int dss_result_from_pg(struct dss_handle *handle, enum dss_type type,
+                              PGresult *res, void **item_list, int *item_cnt)
 {
-    PGconn *conn = handle->dh_conn;
     struct dss_result *dss_res;
     size_t dss_res_size;
     size_t item_size;
-    PGresult *res;
     int rc = 0;
     int i;
 
-    pho_debug("Executing request: '%s'", clause->str);
-
-    rc = execute(conn, clause->str, &res, PGRES_TUPLES_OK);
-    if (rc)
-        return rc;
-
     item_size = get_resource_size(type);
 
     dss_res_size = sizeof(struct dss_result) + PQntuples(res) * item_size;
@@ -201,6 +199,44 @@ int dss_execute_generic_get(struct dss_handle *handle, enum dss_type type,
     return rc;
 }
 
+int dss_execute_generic_get(struct dss_handle *handle, enum dss_type type,
+                            GString *clause, void **item_list, int *item_cnt)
+{
+    PGconn *conn = handle->dh_conn;
+    PGresult *res;
+    int rc = 0;
+
+    pho_debug("Executing request: '%s'", clause->str);
+
+    rc = execute(conn, clause->str, &res, PGRES_TUPLES_OK);
+    if (rc) {
+        PQclear(res);
+        return rc;
+    }
+
+    return dss_result_from_pg(handle, type, res, item_list, item_cnt);
+}
+
+int dss_execute_prepared_get(struct dss_handle *handle, enum dss_type type,
+                             enum dss_statement stmt,
+                             const struct dss_param *params, void **item_list,
+                             int *item_cnt)
+{
+    PGresult *res;
+    int rc;
+
+    *item_list = NULL;
+    *item_cnt = 0;
+
+    rc = execute_prepared(handle, stmt, params, &res, PGRES_TUPLES_OK);
+    if (rc) {
+        PQclear(res);
+        return rc;
+    }
+
+    return dss_result_from_pg(handle, type, res, item_list, item_cnt);
+}
+
 static int dss_generic_get(struct dss_handle *handle, enum dss_type type,
                            const struct dss_filter **filters, int filters_count,
                            void **item_list, int *item_cnt,
@@ -356,6 +392,173 @@ void dss_res_free(void *item_list, int item_cnt)
     _dss_result_free(dss_res, item_cnt);
 }
 
+/*
+ * ITERATOR FUNCTIONS
+ */
+
+struct dss_iter {
+    struct dss_handle *handle;
+    enum dss_type item_type;
+    char cursor[32];          /**< Name of the server-side cursor */
+    size_t batch_size;        /**< Number of rows fetched at once */
+    bool own_transaction;     /**< Whether the iterator opened the transaction
+                                *  the cursor lives in
+                                */
+    bool done;                /**< Whether every row has been fetched */
+    void *batch;              /**< Items of the last batch */
+    int batch_cnt;            /**< Number of items of the last batch */
+};
+
+int dss_iter_open(struct dss_handle *handle, enum dss_type type,
+                  GString *query, size_t batch_size, struct dss_iter **iter)
+{
+    static unsigned int cursor_count;
+    PGconn *conn = handle->dh_conn;
+    struct dss_iter *it;
+    GString *request;
+    PGresult *res;
+    int rc;
+
+    ENTRY;
+
+    if (conn == NULL || iter == NULL)
+        LOG_RETURN(-EINVAL, "dss - conn: %p, iter: %p", conn, iter);
+
+    it = xcalloc(1, sizeof(*it));
+    it->handle = handle;
+    it->item_type = type;
+    it->batch_size = batch_size ? : DSS_ITER_BATCH_SIZE;
+    snprintf(it->cursor, sizeof(it->cursor), "dss_iter_%u",
+             __atomic_fetch_add(&cursor_count, 1, __ATOMIC_RELAXED));
+
+    /* A cursor only lives in a transaction, open one unless already in one */
+    it->own_transaction = (PQtransactionStatus(conn) == PQTRANS_IDLE);
+
+    /* The select queries are terminated by a semicolon */
+    while (query->len > 0 && (query->str[query->len - 1] == ';' ||
+                              g_ascii_isspace(query->str[query->len - 1])))
+        g_string_truncate(query, query->len - 1);
+
+    request = g_string_new(it->own_transaction ? "BEGIN;" : NULL);
+    g_string_append_printf(request, "DECLARE %s NO SCROLL CURSOR FOR %s;",
+                           it->cursor, query->str);
+
+    rc = execute(conn, request->str, &res, PGRES_COMMAND_OK);
+    PQclear(res);
+    g_string_free(request, true);
+    if (rc) {
+        if (it->own_transaction) {
+            execute(conn, "ROLLBACK;", &res, PGRES_COMMAND_OK);
+            PQclear(res);
+        }
+        free(it);
+        return rc;
+    }
+
+    *iter = it;
+    return 0;
+}
+
+int dss_iter_next(struct dss_iter *iter, void **item_list, int *item_cnt)
+{
+    char request[64];
+    PGresult *res;
+    int rc;
+
+    dss_res_free(iter->batch, iter->batch_cnt);
+    iter->batch = NULL;
+    iter->batch_cnt = 0;
+
+    *item_list = NULL;
+    *item_cnt = 0;
+
+    if (iter->done)
+        return 0;
+
+    snprintf(request, sizeof(request), "FETCH FORWARD %zu FROM %s;",
+             iter->batch_size, iter->cursor);
+
+    rc = execute(iter->handle->dh_conn, request, &res, PGRES_TUPLES_OK);
+    if (rc) {
+        PQclear(res);
+        return rc;
+    }
+
+    rc = dss_result_from_pg(iter->handle, iter->item_type, res, &iter->batch,
+                            &iter->batch_cnt);
+    if (rc) {
+        iter->batch = NULL;
+        iter->batch_cnt = 0;
+        return rc;
+    }
+
+    if ((size_t)iter->batch_cnt < iter->batch_size)
+        iter->done = true;
+
+    *item_list = iter->batch;
+    *item_cnt = iter->batch_cnt;
+    return 0;
+}
+
+void dss_iter_close(struct dss_iter *iter)
+{
+    PGconn *conn;
+    PGresult *res;
+
+    if (iter == NULL)
+        return;
+
+    conn = iter->handle->dh_conn;
+    dss_res_free(iter->batch, iter->batch_cnt);
+
+    if (iter->own_transaction) {
+        /* The cursor is closed with its transaction */
+        execute(conn, PQtransactionStatus(conn) == PQTRANS_INERROR ?
+                      "ROLLBACK;" : "COMMIT;",
+                &res, PGRES_COMMAND_OK);
+        PQclear(res);
+    } else if (PQtransactionStatus(conn) != PQTRANS_INERROR) {
+        char request[64];
+
+        snprintf(request, sizeof(request), "CLOSE %s;", iter->cursor);
+        execute(conn, request, &res, PGRES_COMMAND_OK);
+        PQclear(res);
+    }
+
+    free(iter);
+}
+
+int dss_select_iter_open(struct dss_handle *handle, enum dss_type type,
+                         const struct dss_filter *filter,
+                         struct dss_sort *sort, size_t batch_size,
+                         struct dss_iter **iter)
+{
+    GString *condition;
+    GString *query;
+    int rc;
+
+    /* The sorts done after the query cannot apply to a part of the rows */
+    if (sort && !sort->psql_sort)
+        LOG_RETURN(-ENOTSUP, "Cannot iterate over rows sorted by '%s'",
+                   sort->attr);
+
+    condition = g_string_new(NULL);
+    rc = clause_filter_convert(handle, condition, filter);
+    if (rc) {
+        g_string_free(condition, true);
+        return rc;
+    }
+
+    query = g_string_new(NULL);
+    rc = get_select_query(type, &condition, 1, query, sort);
+    g_string_free(condition, true);
+    if (!rc)
+        rc = dss_iter_open(handle, type, query, batch_size, iter);
+
+    g_string_free(query, true);
+    return rc;
+}
+
 /*
  * DEVICE FUNCTIONS
  */
@@ -602,6 +805,21 @@ int dss_extent_get(struct dss_handle *handle, const struct dss_filter *filter,
                            (void **)extents, extent_count, sort);
 }
 
+int dss_extent_iter_open(struct dss_handle *handle,
+                         const struct dss_filter *filter,
+                         struct dss_sort *sort, size_t batch_size,
+                         struct dss_iter **iter)
+{
+    return dss_select_iter_open(handle, DSS_EXTENT, filter, sort, batch_size,
+                                iter);
+}
+
+int dss_extent_iter_next(struct dss_iter *iter, struct extent **extents,
+                         int *extent_count)
+{
+    return dss_iter_next(iter, (void **)extents, extent_count);
+}
+
 int dss_extent_insert(struct dss_handle *handle, struct extent *extents,
                    int extent_count, enum dss_set_action action)
 {
@@ -610,6 +828,10 @@ int dss_extent_insert(struct dss_handle *handle, struct extent *extents,
                    "Only actions available for extent insert are normal insert "
                    "and full insert");
 
+    /* A single extent is inserted with the prepared statement */
+    if (action == DSS_SET_INSERT && extent_count == 1 && handle->dh_conn)
+        return dss_extent_insert_one(handle, extents);
+
     return dss_generic_set(handle, DSS_EXTENT, (void *)extents, extent_count,
                            action);
 }
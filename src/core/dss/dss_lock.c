@@ -69,8 +69,6 @@ enum lock_query_idx {
 #define LOCATE_LOCK  (1 << 2) /* caller wants to set/update a locate lock */
 #define FORCE_LOCK   (1 << 3) /* caller wants to force a lock unset */
 
-#define WHERE_ID " WHERE type = '\%s'::lock_type AND id = '\%s' "
-
 static int get_nb_affected_rows(PGresult *res)
 {
     char *nb_rows_affected_str = PQcmdTuples(res);
@@ -161,22 +159,8 @@ static const char *dss_translate_suffix(enum dss_type type,
     return NULL;
 }
 
-static void append_escaped_to_id(PGconn *conn, const char *string, GString *id)
-{
-    unsigned int escape_len;
-    char *escape_string;
-
-    escape_len = strlen(string) * 2 + 1;
-    escape_string = xmalloc(escape_len);
-
-    PQescapeStringConn(conn, escape_string, string, escape_len, NULL);
-    g_string_append(id, escape_string);
-    free(escape_string);
-}
-
-static int dss_build_lock_id_list(PGconn *conn, const void *item_list,
-                                  int item_cnt, enum dss_type type,
-                                  GString **ids)
+static int dss_build_lock_id_list(const void *item_list, int item_cnt,
+                                  enum dss_type type, GString **ids)
 {
     const char   *name;
     int           i;
@@ -186,12 +170,12 @@ static int dss_build_lock_id_list(PGconn *conn, const void *item_list,
         if (!name)
             LOG_RETURN(-EINVAL, "no lock id prefix found");
 
-        append_escaped_to_id(conn, name, ids[i]);
+        g_string_append(ids[i], name);
 
         name = dss_translate_suffix(type, item_list, i);
         if (name) {
             g_string_append(ids[i], "_");
-            append_escaped_to_id(conn, name, ids[i]);
+            g_string_append(ids[i], name);
         }
 
         if (ids[i]->len > PHO_DSS_MAX_LOCK_ID_LEN)
@@ -205,27 +189,26 @@ static int basic_lock(struct dss_handle *handle, enum dss_type lock_type,
                       const char *lock_id, int owner,
                       const char *hostname, int lock_flags)
 {
-    GString *request = g_string_new("");
-    PGconn *conn = handle->dh_conn;
+    struct dss_param params[6];
+    uint32_t owner_buf;
+    char locate_buf;
+    char weak_buf;
     PGresult *res;
     int rc;
 
     lock_type = lock_type != DSS_DEPREC ? lock_type : DSS_OBJECT;
 
-    g_string_printf(request,
-                    "INSERT INTO lock "
-                    "  (type, id, is_weak, owner, hostname, last_locate) "
-                    "  VALUES ('%s'::lock_type, '%s', %s, %d, '%s', %s)"
-                    ";",
-                    dss_type_names[lock_type], lock_id,
-                    lock_flags & WEAK_LOCK ? "TRUE" : "FALSE",
-                    owner, hostname,
-                    lock_flags & LOCATE_LOCK ? "now()" : "NULL");
+    params[0] = dss_param_str(dss_type_names[lock_type]);
+    params[1] = dss_param_str(lock_id);
+    params[2] = dss_param_bool(&weak_buf, lock_flags & WEAK_LOCK);
+    params[3] = dss_param_int4(&owner_buf, owner);
+    params[4] = dss_param_str(hostname);
+    params[5] = dss_param_bool(&locate_buf, lock_flags & LOCATE_LOCK);
 
-    rc = execute(conn, request->str, &res, PGRES_COMMAND_OK);
+    rc = execute_prepared(handle, DSS_LOCK_STMT, params, &res,
+                          PGRES_COMMAND_OK);
 
     PQclear(res);
-    g_string_free(request, true);
 
     return rc;
 }
@@ -234,50 +217,27 @@ static int basic_refresh(struct dss_handle *handle, enum dss_type lock_type,
                          const char *lock_id, int owner,
                          const char *hostname, int lock_flags)
 {
-    GString *request = g_string_new("");
-    PGconn *conn = handle->dh_conn;
+    struct dss_param params[4];
+    enum dss_statement stmt;
+    uint32_t owner_buf;
     PGresult *res;
     int rc;
 
+    params[0] = dss_param_str(dss_type_names[lock_type]);
+    params[1] = dss_param_str(lock_id);
+    params[2] = dss_param_int4(&owner_buf, owner);
+    params[3] = dss_param_str(hostname);
+
     if (lock_flags & POSSESS_LOCK)
-        g_string_printf(request,
-                        "INSERT INTO lock AS l "
-                        "  (type, id, is_weak, owner, hostname) "
-                        "  VALUES('%s'::lock_type, '%s', FALSE, %d, '%s') "
-                        "  ON CONFLICT (type, id) "
-                        "    DO UPDATE "
-                        "      SET timestamp = now(), "
-                        "        owner = EXCLUDED.owner, "
-                        "        is_weak = FALSE "
-                        "      WHERE l.is_weak = TRUE AND "
-                        "        l.hostname = EXCLUDED.hostname "
-                        ";",
-                        dss_type_names[lock_type], lock_id, owner, hostname);
+        stmt = DSS_LOCK_POSSESS_STMT;
     else if (lock_flags & LOCATE_LOCK)
-        g_string_printf(request,
-                        "UPDATE lock "
-                        "  SET last_locate = now() "
-                           WHERE_ID
-                        ";",
-                        dss_type_names[lock_type], lock_id);
+        stmt = DSS_LOCK_LOCATE_STMT;
     else if (lock_flags & WEAK_LOCK)
-        g_string_printf(request,
-                        "UPDATE lock "
-                        "  SET is_weak = TRUE "
-                           WHERE_ID
-                        "        AND owner = %d AND hostname = '%s'"
-                        ";",
-                        dss_type_names[lock_type], lock_id, owner, hostname);
+        stmt = DSS_LOCK_SET_WEAK_STMT;
     else
-        g_string_printf(request,
-                        "UPDATE lock "
-                        "  SET timestamp = now() "
-                           WHERE_ID
-                        "        AND owner = %d AND hostname = '%s'"
-                        ";",
-                        dss_type_names[lock_type], lock_id, owner, hostname);
+        stmt = DSS_LOCK_REFRESH_STMT;
 
-    rc = execute(conn, request->str, &res, PGRES_COMMAND_OK);
+    rc = execute_prepared(handle, stmt, params, &res, PGRES_COMMAND_OK);
     if (rc)
         goto out;
 
@@ -286,7 +246,6 @@ static int basic_refresh(struct dss_handle *handle, enum dss_type lock_type,
 
 out:
     PQclear(res);
-    g_string_free(request, true);
 
     return rc;
 
@@ -296,28 +255,19 @@ static int basic_unlock(struct dss_handle *handle, enum dss_type lock_type,
                         const char *lock_id, int owner,
                         const char *hostname, int lock_flags)
 {
-    GString *request = g_string_new("");
-    PGconn *conn = handle->dh_conn;
+    struct dss_param params[4];
+    uint32_t owner_buf;
     PGresult *res;
     int rc;
 
-    if (lock_flags & FORCE_LOCK)
-        g_string_printf(request,
-                        "DELETE FROM lock "
-                           WHERE_ID
-                        ";",
-                        dss_type_names[lock_type], lock_id);
-    else
-        g_string_printf(request,
-                        "DELETE FROM lock "
-                           WHERE_ID
-                        "  AND ((owner = %d AND hostname = '%s') "
-                        "       OR is_weak = TRUE)"
-                        ";",
-                        dss_type_names[lock_type], lock_id,
-                        owner, hostname);
+    params[0] = dss_param_str(dss_type_names[lock_type]);
+    params[1] = dss_param_str(lock_id);
+    params[2] = dss_param_int4(&owner_buf, owner);
+    params[3] = dss_param_str(hostname);
 
-    rc = execute(conn, request->str, &res, PGRES_COMMAND_OK);
+    rc = execute_prepared(handle, lock_flags & FORCE_LOCK ?
+                                      DSS_UNLOCK_FORCE_STMT : DSS_UNLOCK_STMT,
+                          params, &res, PGRES_COMMAND_OK);
     if (rc)
         goto out;
 
@@ -326,7 +276,6 @@ static int basic_unlock(struct dss_handle *handle, enum dss_type lock_type,
 
 out:
     PQclear(res);
-    g_string_free(request, true);
 
     return rc;
 }
@@ -334,27 +283,23 @@ out:
 static int basic_status(struct dss_handle *handle, enum dss_type lock_type,
                         const char *lock_id, struct pho_lock *lock)
 {
-    GString *request = g_string_new("");
-    PGconn *conn = handle->dh_conn;
     struct timeval last_locate_ts;
+    struct dss_param params[2];
     struct timeval lock_ts;
     PGresult *res;
     int rc;
 
-    g_string_printf(request,
-                    "SELECT hostname, owner, timestamp, last_locate, is_weak "
-                    "  FROM lock "
-                       WHERE_ID
-                    ";",
-                    dss_type_names[lock_type], lock_id);
+    params[0] = dss_param_str(dss_type_names[lock_type]);
+    params[1] = dss_param_str(lock_id);
 
-    rc = execute(conn, request->str, &res, PGRES_TUPLES_OK);
+    rc = execute_prepared(handle, DSS_LOCK_STATUS_STMT, params, &res,
+                          PGRES_TUPLES_OK);
     if (rc)
         goto out_cleanup;
 
     if (PQntuples(res) == 0) {
-        pho_debug("Requested lock '%s' was not found, request: '%s'",
-                  lock_id, request->str);
+        pho_debug("Requested lock '%s' of type '%s' was not found", lock_id,
+                  dss_type_names[lock_type]);
         rc = -ENOLCK;
         if (lock) {
             lock->hostname = NULL;
@@ -376,7 +321,6 @@ static int basic_status(struct dss_handle *handle, enum dss_type lock_type,
 
 out_cleanup:
     PQclear(res);
-    g_string_free(request, true);
 
     return rc;
 }
@@ -405,7 +349,6 @@ int _dss_lock(struct dss_handle *handle, enum dss_type type,
               const void *item_list, int item_cnt, const char *lock_hostname,
               int lock_pid, bool is_weak, bool is_locate)
 {
-    PGconn *conn = handle->dh_conn;
     int lock_flags = 0;
     GString **ids;
     int rc = 0;
@@ -415,7 +358,7 @@ int _dss_lock(struct dss_handle *handle, enum dss_type type,
 
     LOCK_ID_LIST_ALLOCATE(ids, item_cnt);
 
-    rc = dss_build_lock_id_list(conn, item_list, item_cnt, type, ids);
+    rc = dss_build_lock_id_list(item_list, item_cnt, type, ids);
     if (rc)
         LOG_GOTO(cleanup, rc, "Ids list build failed");
 
@@ -478,7 +421,6 @@ int _dss_lock_refresh(struct dss_handle *handle, enum dss_type type,
                       const char *lock_hostname, int lock_owner,
                       bool locate, bool take_possession, bool set_weak)
 {
-    PGconn *conn = handle->dh_conn;
     int lock_flags = 0;
     GString **ids;
     int rc = 0;
@@ -488,7 +430,7 @@ int _dss_lock_refresh(struct dss_handle *handle, enum dss_type type,
 
     LOCK_ID_LIST_ALLOCATE(ids, item_cnt);
 
-    rc = dss_build_lock_id_list(conn, item_list, item_cnt, type, ids);
+    rc = dss_build_lock_id_list(item_list, item_cnt, type, ids);
     if (rc)
         LOG_GOTO(cleanup, rc, "Ids list build failed");
 
@@ -560,7 +502,6 @@ int _dss_unlock(struct dss_handle *handle, enum dss_type type,
                 const void *item_list, int item_cnt, const char *lock_hostname,
                 int lock_owner)
 {
-    PGconn *conn = handle->dh_conn;
     GString **ids;
     int rc = 0;
     int i;
@@ -569,7 +510,7 @@ int _dss_unlock(struct dss_handle *handle, enum dss_type type,
 
     LOCK_ID_LIST_ALLOCATE(ids, item_cnt);
 
-    rc = dss_build_lock_id_list(conn, item_list, item_cnt, type, ids);
+    rc = dss_build_lock_id_list(item_list, item_cnt, type, ids);
     if (rc)
         LOG_GOTO(cleanup, rc, "Ids list build failed");
 
@@ -608,7 +549,6 @@ int dss_lock_status(struct dss_handle *handle, enum dss_type type,
                     const void *item_list, int item_cnt,
                     struct pho_lock *locks)
 {
-    PGconn *conn = handle->dh_conn;
     GString **ids;
     int rc = 0;
     int i;
@@ -617,7 +557,7 @@ int dss_lock_status(struct dss_handle *handle, enum dss_type type,
 
     LOCK_ID_LIST_ALLOCATE(ids, item_cnt);
 
-    rc = dss_build_lock_id_list(conn, item_list, item_cnt, type, ids);
+    rc = dss_build_lock_id_list(item_list, item_cnt, type, ids);
     if (rc)
         LOG_GOTO(cleanup, rc, "Ids list build failed");
 
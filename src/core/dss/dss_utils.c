@@ -28,9 +28,13 @@
 
 #include "dss_utils.h"
 #include "pho_common.h"
+#include "pho_stats.h"
 
+#include <assert.h>
 #include <errno.h>
 #include <libpq-fe.h>
+#include <pthread.h>
+#include <time.h>
 
 struct sqlerr_map_item {
     const char *smi_prefix;  /**< SQL error code or class (prefix) */
@@ -64,12 +68,34 @@ static const struct sqlerr_map_item sqlerr_map[] = {
     {"", -ECOMM}
 };
 
+/** Histogram of the duration of the DSS queries of the process, in us */
+static struct pho_stat *query_time;
+static pthread_once_t query_time_once = PTHREAD_ONCE_INIT;
+
+static void query_time_create(void)
+{
+    query_time = pho_stat_create(PHO_STAT_HISTOGRAM, "dss", "query_time_us",
+                                 NULL);
+}
+
+/** Record the duration of a query started at \p start */
+static void query_time_observe(const struct timespec *start)
+{
+    pthread_once(&query_time_once, query_time_create);
+    if (query_time)
+        pho_stat_observe_since(query_time, start);
+}
+
 int execute(PGconn *conn, const char *request, PGresult **res,
             ExecStatusType tested)
 {
+    struct timespec start;
+
     pho_debug("Executing request: '%s'", request);
 
+    clock_gettime(CLOCK_REALTIME, &start);
     *res = PQexec(conn, request);
+    query_time_observe(&start);
     if (PQresultStatus(*res) != tested)
         LOG_RETURN(psql_state2errno(*res), "Request failed: %s",
                    PQresultErrorField(*res, PG_DIAG_MESSAGE_PRIMARY));
@@ -127,6 +153,177 @@ cleanup:
     return rc;
 }
 
+struct prepared_statement {
+    const char *name;   /**< Name of the statement on the connection */
+    const char *query;  /**< Parametrized request */
+    int n_params;       /**< Number of parameters of the request */
+};
+
+#define LOCK_WHERE_ID " WHERE type = $1::lock_type AND id = $2"
+
+static const struct prepared_statement prepared_statements[] = {
+    [DSS_LOCK_STMT] = {
+        "dss_lock",
+        "INSERT INTO lock "
+        "  (type, id, is_weak, owner, hostname, last_locate) "
+        "  VALUES ($1::lock_type, $2, $3::boolean, $4::integer, $5, "
+        "          CASE WHEN $6::boolean THEN now() END);",
+        6
+    },
+    [DSS_LOCK_REFRESH_STMT] = {
+        "dss_lock_refresh",
+        "UPDATE lock SET timestamp = now()" LOCK_WHERE_ID
+        "  AND owner = $3::integer AND hostname = $4;",
+        4
+    },
+    [DSS_LOCK_LOCATE_STMT] = {
+        "dss_lock_locate",
+        "UPDATE lock SET last_locate = now()" LOCK_WHERE_ID ";",
+        2
+    },
+    [DSS_LOCK_SET_WEAK_STMT] = {
+        "dss_lock_set_weak",
+        "UPDATE lock SET is_weak = TRUE" LOCK_WHERE_ID
+        "  AND owner = $3::integer AND hostname = $4;",
+        4
+    },
+    [DSS_LOCK_POSSESS_STMT] = {
+        "dss_lock_possess",
+        "INSERT INTO lock AS l (type, id, is_weak, owner, hostname) "
+        "  VALUES ($1::lock_type, $2, FALSE, $3::integer, $4) "
+        "  ON CONFLICT (type, id) "
+        "    DO UPDATE "
+        "      SET timestamp = now(), "
+        "        owner = EXCLUDED.owner, "
+        "        is_weak = FALSE "
+        "      WHERE l.is_weak = TRUE AND "
+        "        l.hostname = EXCLUDED.hostname;",
+        4
+    },
+    [DSS_UNLOCK_STMT] = {
+        "dss_unlock",
+        "DELETE FROM lock" LOCK_WHERE_ID
+        "  AND ((owner = $3::integer AND hostname = $4) OR is_weak = TRUE);",
+        4
+    },
+    [DSS_UNLOCK_FORCE_STMT] = {
+        "dss_unlock_force",
+        "DELETE FROM lock" LOCK_WHERE_ID ";",
+        2
+    },
+    [DSS_LOCK_STATUS_STMT] = {
+        "dss_lock_status",
+        "SELECT hostname, owner, timestamp, last_locate, is_weak "
+        "  FROM lock" LOCK_WHERE_ID ";",
+        2
+    },
+    [DSS_OBJECT_GET_BY_OID_STMT] = {
+        "dss_object_get_by_oid",
+        "SELECT oid, object_uuid, version, user_md, creation_time, _grouping,"
+        "  size FROM object WHERE oid = $1;",
+        1
+    },
+    [DSS_MEDIUM_GET_BY_ID_STMT] = {
+        "dss_medium_get_by_id",
+        "SELECT family, model, media.id, media.library, adm_status,"
+        "  address_type, fs_type, fs_status, fs_label, stats, tags, put, get,"
+        "  delete, groupings FROM media"
+        "  WHERE family = $1::dev_family AND id = $2 AND library = $3;",
+        3
+    },
+    [DSS_EXTENT_INSERT_STMT] = {
+        "dss_extent_insert",
+        "INSERT INTO extent (extent_uuid, state, size, offsetof, "
+        "  medium_family, medium_id, medium_library, address, hash, info) "
+        "  VALUES ($1, $2::extent_state, $3::bigint, $4::bigint,"
+        "          $5::dev_family, $6, $7, $8, $9::jsonb, $10::jsonb);",
+        10
+    },
+};
+
+static bool has_sqlstate(const PGresult *res, const char *state)
+{
+    const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+
+    return sqlstate && !strcmp(sqlstate, state);
+}
+
+static int prepare_statement(struct dss_handle *handle,
+                             enum dss_statement stmt)
+{
+    const struct prepared_statement *ps = &prepared_statements[stmt];
+    PGresult *res;
+    int rc = 0;
+
+    pho_debug("Preparing statement '%s': '%s'", ps->name, ps->query);
+
+    res = PQprepare(handle->dh_conn, ps->name, ps->query, ps->n_params, NULL);
+    /* Another copy of the handle may have prepared it on the same connection */
+    if (PQresultStatus(res) != PGRES_COMMAND_OK &&
+        !has_sqlstate(res, "42P05")) {
+        /* A failure without SQL state means the connection is broken */
+        rc = psql_state2errno(res) ? : -ECOMM;
+        pho_error(rc, "Cannot prepare statement '%s': %s", ps->name,
+                  PQerrorMessage(handle->dh_conn));
+    } else {
+        handle->dh_prepared |= 1ULL << stmt;
+    }
+
+    PQclear(res);
+
+    return rc;
+}
+
+int execute_prepared(struct dss_handle *handle, enum dss_statement stmt,
+                     const struct dss_param *params, PGresult **res,
+                     ExecStatusType tested)
+{
+    const struct prepared_statement *ps = &prepared_statements[stmt];
+    const char *values[DSS_STMT_MAX_PARAMS];
+    int lengths[DSS_STMT_MAX_PARAMS];
+    int formats[DSS_STMT_MAX_PARAMS];
+    bool prepared_again = false;
+    struct timespec start;
+    int rc;
+    int i;
+
+    assert(ps->n_params <= DSS_STMT_MAX_PARAMS);
+
+    for (i = 0; i < ps->n_params; i++) {
+        values[i] = params[i].value;
+        lengths[i] = params[i].length;
+        formats[i] = params[i].format;
+    }
+
+prepare:
+    *res = NULL;
+    if (!(handle->dh_prepared & (1ULL << stmt))) {
+        rc = prepare_statement(handle, stmt);
+        if (rc)
+            return rc;
+    }
+
+    pho_debug("Executing prepared statement '%s'", ps->name);
+
+    clock_gettime(CLOCK_REALTIME, &start);
+    *res = PQexecPrepared(handle->dh_conn, ps->name, ps->n_params, values,
+                          lengths, formats, 0);
+    query_time_observe(&start);
+    if (PQresultStatus(*res) == tested)
+        return 0;
+
+    /* The statements of a connection are lost when it is reset */
+    if (!prepared_again && has_sqlstate(*res, "26000")) {
+        handle->dh_prepared &= ~(1ULL << stmt);
+        prepared_again = true;
+        PQclear(*res);
+        goto prepare;
+    }
+
+    LOG_RETURN(psql_state2errno(*res) ? : -ECOMM, "Statement '%s' failed: %s",
+               ps->name, PQerrorMessage(handle->dh_conn));
+}
+
 void update_fields(void *resource, int64_t fields_to_update,
                    struct dss_field *fields, int fields_count, GString *request)
 {
@@ -29,7 +29,10 @@
 #include "config.h"
 #endif
 
+#include <endian.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 #include <glib.h>
 #include <jansson.h>
 #include <libpq-fe.h>
@@ -111,6 +114,128 @@ int psql_state2errno(const PGresult *res);
 int execute_and_commit_or_rollback(PGconn *conn, GString *request,
                                    PGresult **res, ExecStatusType tested);
 
+/**
+ * Statements prepared on demand on each DSS connection, for the hot queries.
+ *
+ * Their parameters are sent in binary format when possible, and their results
+ * are received in text format to share the row parsers of the text queries.
+ */
+enum dss_statement {
+    DSS_LOCK_STMT,
+    DSS_LOCK_REFRESH_STMT,
+    DSS_LOCK_LOCATE_STMT,
+    DSS_LOCK_SET_WEAK_STMT,
+    DSS_LOCK_POSSESS_STMT,
+    DSS_UNLOCK_STMT,
+    DSS_UNLOCK_FORCE_STMT,
+    DSS_LOCK_STATUS_STMT,
+    DSS_OBJECT_GET_BY_OID_STMT,
+    DSS_MEDIUM_GET_BY_ID_STMT,
+    DSS_EXTENT_INSERT_STMT,
+    DSS_STMT_COUNT,
+};
+
+#define DSS_STMT_MAX_PARAMS 10
+
+/**
+ * Parameter of a prepared statement
+ */
+struct dss_param {
+    const char *value;  /**< Value, or NULL for the SQL NULL */
+    int length;         /**< Length of a binary value */
+    int format;         /**< 0 for a text value, 1 for a binary value */
+};
+
+/**
+ * String parameter, sent as is in binary format
+ */
+static inline struct dss_param dss_param_str(const char *value)
+{
+    return (struct dss_param) {
+        .value = value,
+        .length = value ? strlen(value) : 0,
+        .format = 1,
+    };
+}
+
+/**
+ * String parameter sent in text format, for the types like jsonb whose
+ * binary format is not the text itself
+ */
+static inline struct dss_param dss_param_text(const char *value)
+{
+    return (struct dss_param) { .value = value, .format = 0 };
+}
+
+/**
+ * Integer parameters, encoded in \p buf which must live until the statement
+ * is executed
+ */
+static inline struct dss_param dss_param_int4(uint32_t *buf, int32_t value)
+{
+    *buf = htobe32(value);
+
+    return (struct dss_param) {
+        .value = (const char *)buf,
+        .length = sizeof(*buf),
+        .format = 1,
+    };
+}
+
+static inline struct dss_param dss_param_int8(uint64_t *buf, int64_t value)
+{
+    *buf = htobe64(value);
+
+    return (struct dss_param) {
+        .value = (const char *)buf,
+        .length = sizeof(*buf),
+        .format = 1,
+    };
+}
+
+static inline struct dss_param dss_param_bool(char *buf, bool value)
+{
+    *buf = value;
+
+    return (struct dss_param) { .value = buf, .length = 1, .format = 1 };
+}
+
+/**
+ * Execute the prepared statement \p stmt with \p params, preparing it first
+ * if it is not yet prepared on the connection of \p handle, verify the result
+ * is as expected with \p tested and put the result in \p res.
+ *
+ * \param handle[in,out] DSS handle
+ * \param stmt[in]       Statement to execute
+ * \param params[in]     Parameters of the statement, as many as it expects
+ * \param res[out]       Result holder of the request, to clear by the caller
+ *                       even on error
+ * \param tested[in]     The expected result of the request
+ *
+ * \return               0 on success, or the error as returned by PSQL
+ */
+int execute_prepared(struct dss_handle *handle, enum dss_statement stmt,
+                     const struct dss_param *params, PGresult **res,
+                     ExecStatusType tested);
+
+/**
+ * Execute the prepared select statement \p stmt and store its rows in
+ * \p item_list, to free with dss_res_free().
+ *
+ * \param handle[in,out]    DSS handle
+ * \param type[in]          Type of the selected resource
+ * \param stmt[in]          Statement to execute
+ * \param params[in]        Parameters of the statement
+ * \param item_list[out]    List of items retrieved
+ * \param item_cnt[out]     Number of items retrieved
+ *
+ * \return                  0 on success, or the error as returned by PSQL
+ */
+int dss_execute_prepared_get(struct dss_handle *handle, enum dss_type type,
+                             enum dss_statement stmt,
+                             const struct dss_param *params, void **item_list,
+                             int *item_cnt);
+
 /**
  * Unlike PQgetvalue that returns '' for NULL fields,
  * this function returns NULL for NULL fields.
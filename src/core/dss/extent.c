@@ -109,6 +109,46 @@ out_free:
     return result;
 }
 
+int dss_extent_insert_one(struct dss_handle *handle, struct extent *extent)
+{
+    struct dss_param params[10];
+    uint64_t offset_buf;
+    uint64_t size_buf;
+    PGresult *res;
+    GString *info;
+    char *hash;
+    int rc;
+
+    info = g_string_new("");
+    pho_attrs_to_json(&extent->info, info, JSON_COMPACT);
+
+    hash = dss_extent_hash_encode(extent);
+    if (hash == NULL) {
+        g_string_free(info, TRUE);
+        return -EINVAL;
+    }
+
+    params[0] = dss_param_str(extent->uuid);
+    params[1] = dss_param_str(extent_state2str(extent->state));
+    params[2] = dss_param_int8(&size_buf, extent->size);
+    params[3] = dss_param_int8(&offset_buf, extent->offset);
+    params[4] = dss_param_str(rsc_family2str(extent->media.family));
+    params[5] = dss_param_str(extent->media.name);
+    params[6] = dss_param_str(extent->media.library);
+    params[7] = dss_param_str(extent->address.buff);
+    params[8] = dss_param_text(hash);
+    params[9] = dss_param_text(info->str);
+
+    rc = execute_prepared(handle, DSS_EXTENT_INSERT_STMT, params, &res,
+                          PGRES_COMMAND_OK);
+    PQclear(res);
+
+    g_string_free(info, TRUE);
+    free(hash);
+
+    return rc;
+}
+
 static int extent_insert_query(PGconn *conn, void *void_extent, int item_cnt,
                                int64_t fields, GString *request)
 {
@@ -46,4 +46,15 @@ extern const struct dss_resource_ops extent_ops;
  */
 int dss_extent_hash_decode(struct extent *extent, json_t *hash_field);
 
+/**
+ * Insert one extent with the prepared insert statement, in its own
+ * transaction.
+ *
+ * \param[in,out] handle  DSS handle
+ * \param[in]     extent  The extent to insert
+ *
+ * \return 0 on success, negative error code on failure
+ */
+int dss_extent_insert_one(struct dss_handle *handle, struct extent *extent);
+
 #endif
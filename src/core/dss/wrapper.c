@@ -82,26 +82,17 @@ int dss_one_medium_get_from_id(struct dss_handle *dss,
                                const struct pho_id *medium_id,
                                struct media_info **medium_info)
 {
-    struct dss_filter filter;
+    struct dss_param params[3];
     int cnt;
     int rc;
 
     /* get medium info from medium id */
-    rc = dss_filter_build(&filter,
-                          "{\"$AND\": ["
-                              "{\"DSS::MDA::family\": \"%s\"}, "
-                              "{\"DSS::MDA::id\": \"%s\"}, "
-                              "{\"DSS::MDA::library\": \"%s\"}"
-                          "]}",
-                          rsc_family2str(medium_id->family),
-                          medium_id->name, medium_id->library);
-    if (rc)
-        LOG_RETURN(rc,
-                   "Unable to build filter for media "FMT_PHO_ID,
-                   PHO_ID(*medium_id));
+    params[0] = dss_param_str(rsc_family2str(medium_id->family));
+    params[1] = dss_param_str(medium_id->name);
+    params[2] = dss_param_str(medium_id->library);
 
-    rc = dss_media_get(dss, &filter, medium_info, &cnt, NULL);
-    dss_filter_free(&filter);
+    rc = dss_execute_prepared_get(dss, DSS_MEDIA, DSS_MEDIUM_GET_BY_ID_STMT,
+                                  params, (void **)medium_info, &cnt);
     if (rc)
         LOG_RETURN(rc,
                    "Error while getting medium info "FMT_PHO_ID,
@@ -300,15 +291,23 @@ int dss_lazy_find_object(struct dss_handle *hdl, const char *oid,
 
     ENTRY;
 
-    build_object_json_filter(&json_filter, oid, uuid, version);
+    if (oid && !uuid) {
+        struct dss_param param = dss_param_str(oid);
 
-    rc = dss_filter_build(&filter, "%s", json_filter);
-    free(json_filter);
-    if (rc)
-        LOG_RETURN(rc, "Cannot build filter");
+        rc = dss_execute_prepared_get(hdl, DSS_OBJECT,
+                                      DSS_OBJECT_GET_BY_OID_STMT, &param,
+                                      (void **)&obj_list, &obj_cnt);
+    } else {
+        build_object_json_filter(&json_filter, oid, uuid, version);
 
-    rc = dss_object_get(hdl, &filter, &obj_list, &obj_cnt, NULL);
-    dss_filter_free(&filter);
+        rc = dss_filter_build(&filter, "%s", json_filter);
+        free(json_filter);
+        if (rc)
+            LOG_RETURN(rc, "Cannot build filter");
+
+        rc = dss_object_get(hdl, &filter, &obj_list, &obj_cnt, NULL);
+        dss_filter_free(&filter);
+    }
     if (rc)
         LOG_RETURN(rc, "Cannot fetch objid: '%s'", oid);
 
@@ -614,6 +613,158 @@ free_oid_list:
     return rc;
 }
 
+/**
+ * Append \p value to \p request as an escaped SQL literal, or NULL if \p value
+ * is NULL.
+ */
+static int append_literal(PGconn *conn, GString *request, const char *value)
+{
+    char *escaped;
+
+    if (!value) {
+        g_string_append(request, "NULL");
+        return 0;
+    }
+
+    escaped = PQescapeLiteral(conn, value, strlen(value));
+    if (!escaped)
+        LOG_RETURN(-EINVAL, "Cannot escape litteral %s: %s", value,
+                   PQerrorMessage(conn));
+
+    g_string_append(request, escaped);
+    PQfreemem(escaped);
+
+    return 0;
+}
+
+static int object_reserve_query(PGconn *conn, GString *request,
+                                struct object_info *obj_list, int obj_cnt,
+                                const char *copy_name)
+{
+    int rc;
+    int i;
+
+    g_string_append(request,
+                    "WITH new_object AS ("
+                    " INSERT INTO object (oid, user_md, _grouping, size)"
+                    " VALUES ");
+
+    for (i = 0; i < obj_cnt; ++i) {
+        g_string_append(request, i ? ", (" : "(");
+        rc = append_literal(conn, request, obj_list[i].oid);
+        if (rc)
+            return rc;
+
+        g_string_append(request, ", ");
+        rc = append_literal(conn, request, obj_list[i].user_md);
+        if (rc)
+            return rc;
+
+        g_string_append(request, ", ");
+        rc = append_literal(conn, request, obj_list[i].grouping);
+        if (rc)
+            return rc;
+
+        g_string_append_printf(request, ", '%ld')", obj_list[i].size);
+    }
+
+    g_string_append(request,
+                    " ON CONFLICT (oid) DO NOTHING"
+                    " RETURNING oid, object_uuid, version"
+                    "), new_copy AS ("
+                    " INSERT INTO copy (object_uuid, version, copy_name,"
+                    "  copy_status)"
+                    " SELECT object_uuid, version, ");
+    rc = append_literal(conn, request, copy_name);
+    if (rc)
+        return rc;
+
+    g_string_append_printf(request,
+                           ", '%s' FROM new_object"
+                           ") SELECT oid, object_uuid, version FROM new_object;",
+                           copy_status2str(PHO_COPY_STATUS_INCOMPLETE));
+
+    return 0;
+}
+
+int dss_object_reserve(struct dss_handle *handle, struct object_info *obj_list,
+                       int obj_cnt, const char *copy_name, int *obj_rcs)
+{
+    GString *request = g_string_new("BEGIN;");
+    PGconn *conn = handle->dh_conn;
+    PGresult *tmp_res = NULL;
+    PGresult *res = NULL;
+    int n_reserved;
+    int rc = 0;
+    int i;
+
+    ENTRY;
+
+    for (i = 0; i < obj_cnt; ++i) {
+        obj_list[i].uuid = NULL;
+        obj_rcs[i] = -EEXIST;
+    }
+
+    rc = object_reserve_query(conn, request, obj_list, obj_cnt, copy_name);
+    if (rc)
+        LOG_GOTO(free_request, rc, "Reservation request could not be built");
+
+    rc = execute(conn, request->str, &res, PGRES_TUPLES_OK);
+    if (rc) {
+        for (i = 0; i < obj_cnt; ++i)
+            obj_rcs[i] = rc;
+
+        pho_info("Attempting to rollback after transaction failure");
+        execute(conn, "ROLLBACK;", &tmp_res, PGRES_COMMAND_OK);
+        goto free_res;
+    }
+
+    /* The oids of a request may be repeated: only the first one is reserved */
+    n_reserved = PQntuples(res);
+    for (int row = 0; row < n_reserved; ++row) {
+        const char *oid = PQgetvalue(res, row, 0);
+
+        for (i = 0; i < obj_cnt; ++i) {
+            if (obj_rcs[i] == 0 || strcmp(obj_list[i].oid, oid))
+                continue;
+
+            obj_list[i].uuid = xstrdup(PQgetvalue(res, row, 1));
+            obj_list[i].version = atoi(PQgetvalue(res, row, 2));
+            obj_rcs[i] = 0;
+            break;
+        }
+    }
+
+    if (n_reserved == obj_cnt) {
+        rc = execute(conn, "COMMIT;", &tmp_res, PGRES_COMMAND_OK);
+        if (!rc)
+            goto free_res;
+
+        for (i = 0; i < obj_cnt; ++i)
+            obj_rcs[i] = rc;
+    } else {
+        /* Reserve all the objects or none of them */
+        rc = -EEXIST;
+        pho_debug("%d out of %d objects already exist, rolling back",
+                  obj_cnt - n_reserved, obj_cnt);
+        execute(conn, "ROLLBACK;", &tmp_res, PGRES_COMMAND_OK);
+    }
+
+    for (i = 0; i < obj_cnt; ++i) {
+        free(obj_list[i].uuid);
+        obj_list[i].uuid = NULL;
+    }
+
+free_res:
+    PQclear(tmp_res);
+    PQclear(res);
+
+free_request:
+    g_string_free(request, true);
+
+    return rc;
+}
+
 int dss_update_extent_migrate(struct dss_handle *handle, const char *old_uuid,
                               const char *new_uuid)
 {
@@ -939,13 +1090,14 @@ out:
     return rc;
 }
 
-int dss_get_living_and_deprecated_objects(struct dss_handle *handle,
-                                          const struct dss_filter *filter,
-                                          struct dss_sort *sort,
-                                          struct object_info **objs,
-                                          int *n_objs)
+/**
+ * Build the select query of the living and deprecated objects matching
+ * \p filter into \p request.
+ */
+static int living_and_deprecated_query(struct dss_handle *handle,
+                                       const struct dss_filter *filter,
+                                       struct dss_sort *sort, GString *request)
 {
-    GString *request = g_string_new("BEGIN;");
     GString *clause = g_string_new(NULL);
     int rc = 0;
 
@@ -966,12 +1118,62 @@ int dss_get_living_and_deprecated_objects(struct dss_handle *handle,
     dss_sort2sql(request, sort);
     g_string_append(request, ";");
 
-    rc = dss_execute_generic_get(handle, DSS_DEPREC, request, (void **) objs,
-                                 n_objs);
-
 out:
-    g_string_free(request, true);
     g_string_free(clause, true);
 
     return rc;
 }
+
+int dss_get_living_and_deprecated_objects(struct dss_handle *handle,
+                                          const struct dss_filter *filter,
+                                          struct dss_sort *sort,
+                                          struct object_info **objs,
+                                          int *n_objs)
+{
+    GString *request = g_string_new("BEGIN;");
+    int rc;
+
+    rc = living_and_deprecated_query(handle, filter, sort, request);
+    if (!rc)
+        rc = dss_execute_generic_get(handle, DSS_DEPREC, request,
+                                     (void **) objs, n_objs);
+
+    g_string_free(request, true);
+
+    return rc;
+}
+
+int dss_object_iter_open(struct dss_handle *handle,
+                         const struct dss_filter *filter,
+                         enum dss_obj_scope scope, struct dss_sort *sort,
+                         size_t batch_size, struct dss_iter **iter)
+{
+    GString *request;
+    int rc;
+
+    switch (scope) {
+    case DSS_OBJ_ALIVE:
+        return dss_select_iter_open(handle, DSS_OBJECT, filter, sort,
+                                    batch_size, iter);
+    case DSS_OBJ_DEPRECATED:
+        return dss_select_iter_open(handle, DSS_DEPREC, filter, sort,
+                                    batch_size, iter);
+    case DSS_OBJ_ALL:
+        break;
+    }
+
+    request = g_string_new(NULL);
+    rc = living_and_deprecated_query(handle, filter, sort, request);
+    if (!rc)
+        rc = dss_iter_open(handle, DSS_DEPREC, request, batch_size, iter);
+
+    g_string_free(request, true);
+
+    return rc;
+}
+
+int dss_object_iter_next(struct dss_iter *iter, struct object_info **objs,
+                         int *n_objs)
+{
+    return dss_iter_next(iter, (void **)objs, n_objs);
+}
@@ -319,6 +319,10 @@ void pho_srl_request_free(pho_req_t *req, bool unpack)
             free(req->ralloc->med_ids[i]);
         }
         free(req->ralloc->med_ids);
+        free(req->ralloc->positions);
+        for (i = 0; i < req->ralloc->n_addresses; ++i)
+            free(req->ralloc->addresses[i]);
+        free(req->ralloc->addresses);
         free(req->ralloc);
         req->ralloc = NULL;
     }
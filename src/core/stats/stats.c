@@ -26,12 +26,14 @@
 #include "config.h"
 #endif
 
+#include <inttypes.h>
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <stdio.h>
 #include "pho_stats.h"
 #include "pho_common.h"
 
@@ -47,6 +49,14 @@ struct tag_list {
     size_t count;
 };
 
+/** observations of a histogram, updated without lock */
+struct stat_hist {
+    _Atomic uint_least64_t sum;
+    _Atomic uint_least64_t min;
+    _Atomic uint_least64_t max;
+    _Atomic uint_least64_t buckets[PHO_STAT_HIST_BUCKETS];
+};
+
 struct pho_stat {
     enum pho_stat_type type;
     char *namespace;
@@ -55,7 +65,8 @@ struct pho_stat {
     char *tags; /**< copy of the tags ready for building dump */
     struct tag_list tag_list; /* parsed tags for matching */
 
-    _Atomic uint_least64_t value;
+    _Atomic uint_least64_t value; /**< number of observations of a histogram */
+    struct stat_hist *hist; /**< observations of a histogram, NULL otherwise */
 };
 
 struct pho_stat_iter {
@@ -173,6 +184,17 @@ struct pho_stat *pho_stat_create(enum pho_stat_type type,
     stat->tags = xstrdup_safe(tags);
 
     atomic_init(&stat->value, 0);
+    stat->hist = NULL;
+    if (type == PHO_STAT_HISTOGRAM) {
+        size_t i;
+
+        stat->hist = xmalloc(sizeof(*stat->hist));
+        atomic_init(&stat->hist->sum, 0);
+        atomic_init(&stat->hist->min, UINT64_MAX);
+        atomic_init(&stat->hist->max, 0);
+        for (i = 0; i < PHO_STAT_HIST_BUCKETS; i++)
+            atomic_init(&stat->hist->buckets[i], 0);
+    }
 
     pho_stat_register(stat);
 
@@ -195,6 +217,7 @@ void pho_stat_destroy(struct pho_stat **pstat)
     free(stat->full_name);
     free(stat->tags);
     free_taglist(&stat->tag_list);
+    free(stat->hist);
     free(stat);
     *pstat = NULL;
 }
@@ -202,18 +225,169 @@ void pho_stat_destroy(struct pho_stat **pstat)
 /** Increments an integer type metric. */
 void pho_stat_incr(struct pho_stat *stat, uint64_t val)
 {
+    /* the value of a histogram is its number of observations */
+    assert(stat->type != PHO_STAT_HISTOGRAM);
+
     atomic_fetch_add(&stat->value, val);
 }
 
 /** Sets the value of an integer type metric. */
 void pho_stat_set(struct pho_stat *stat, uint64_t val)
 {
-    /* can't set a counter */
-    assert(stat->type != PHO_STAT_COUNTER);
+    /* can't set a counter nor a histogram */
+    assert(stat->type == PHO_STAT_GAUGE);
 
     atomic_store(&stat->value, val);
 }
 
+/** Index of the histogram bucket of a value */
+static size_t hist_index(uint64_t val)
+{
+    int shift;
+
+    if (val < PHO_STAT_HIST_SUB_COUNT)
+        return val;
+
+    /* the PHO_STAT_HIST_SUB_BITS bits after the most significant bit give the
+     * bucket in the power of two
+     */
+    shift = 63 - __builtin_clzll(val) - PHO_STAT_HIST_SUB_BITS;
+
+    return ((size_t)(shift + 1) << PHO_STAT_HIST_SUB_BITS) +
+           ((val >> shift) & (PHO_STAT_HIST_SUB_COUNT - 1));
+}
+
+uint64_t pho_stat_hist_bucket_max(size_t index)
+{
+    size_t sub = index & (PHO_STAT_HIST_SUB_COUNT - 1);
+    int shift = (index >> PHO_STAT_HIST_SUB_BITS) - 1;
+    uint64_t min;
+
+    if (index < PHO_STAT_HIST_SUB_COUNT)
+        return index;
+
+    min = (uint64_t)(PHO_STAT_HIST_SUB_COUNT + sub) << shift;
+
+    return min + ((UINT64_C(1) << shift) - 1);
+}
+
+/** Records a value in a histogram, the extrema are updated by CAS loops. */
+void pho_stat_observe(struct pho_stat *stat, uint64_t val)
+{
+    struct stat_hist *hist = stat->hist;
+    uint_least64_t cur;
+
+    assert(stat->type == PHO_STAT_HISTOGRAM);
+
+    atomic_fetch_add_explicit(&hist->buckets[hist_index(val)], 1,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->sum, val, memory_order_relaxed);
+
+    cur = atomic_load_explicit(&hist->min, memory_order_relaxed);
+    while (val < cur &&
+           !atomic_compare_exchange_weak_explicit(&hist->min, &cur, val,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+        ;
+
+    cur = atomic_load_explicit(&hist->max, memory_order_relaxed);
+    while (val > cur &&
+           !atomic_compare_exchange_weak_explicit(&hist->max, &cur, val,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed))
+        ;
+
+    atomic_fetch_add(&stat->value, 1);
+}
+
+void pho_stat_observe_since(struct pho_stat *stat,
+                            const struct timespec *start)
+{
+    struct timespec elapsed;
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    if (cmp_timespec(&now, start) < 0) {
+        /* the clock went backward */
+        pho_stat_observe(stat, 0);
+        return;
+    }
+
+    elapsed = diff_timespec(&now, start);
+    pho_stat_observe(stat, elapsed.tv_sec * 1000000ULL +
+                           elapsed.tv_nsec / 1000);
+}
+
+/**
+ * The buckets are read one by one while observations go on, the count of the
+ * snapshot is the sum of its buckets so that its percentiles are consistent.
+ */
+int pho_stat_hist_get(struct pho_stat *stat, struct pho_stat_hist *hist)
+{
+    size_t i;
+
+    if (stat->type != PHO_STAT_HISTOGRAM)
+        return -EINVAL;
+
+    hist->count = 0;
+    for (i = 0; i < PHO_STAT_HIST_BUCKETS; i++) {
+        hist->buckets[i] = atomic_load_explicit(&stat->hist->buckets[i],
+                                                memory_order_relaxed);
+        hist->count += hist->buckets[i];
+    }
+
+    hist->sum = atomic_load_explicit(&stat->hist->sum, memory_order_relaxed);
+    hist->max = atomic_load_explicit(&stat->hist->max, memory_order_relaxed);
+    hist->min = atomic_load_explicit(&stat->hist->min, memory_order_relaxed);
+    if (hist->count == 0)
+        hist->min = 0;
+
+    return 0;
+}
+
+uint64_t pho_stat_hist_percentile(const struct pho_stat_hist *hist,
+                                  double quantile)
+{
+    uint64_t cumulated = 0;
+    uint64_t rank;
+    size_t i;
+
+    if (hist->count == 0)
+        return 0;
+
+    /* rank of the percentile among the observations, from 1 to count */
+    rank = quantile * hist->count;
+    if (rank < quantile * hist->count)
+        rank++;
+    rank = rank < 1 ? 1 : (rank > hist->count ? hist->count : rank);
+
+    for (i = 0; i < PHO_STAT_HIST_BUCKETS; i++) {
+        cumulated += hist->buckets[i];
+        if (cumulated >= rank)
+            break;
+    }
+
+    if (i == PHO_STAT_HIST_BUCKETS || pho_stat_hist_bucket_max(i) > hist->max)
+        return hist->max;
+
+    return pho_stat_hist_bucket_max(i) < hist->min ?
+        hist->min : pho_stat_hist_bucket_max(i);
+}
+
+const char *pho_stat_type2str(enum pho_stat_type type)
+{
+    switch (type) {
+    case PHO_STAT_COUNTER:
+        return "counter";
+    case PHO_STAT_GAUGE:
+        return "gauge";
+    case PHO_STAT_HISTOGRAM:
+        return "histogram";
+    }
+
+    return NULL;
+}
+
 /**
  *  Get the value from a stat
  */
@@ -338,6 +512,38 @@ void pho_stat_iter_close(struct pho_stat_iter *iter)
     free(iter);
 }
 
+/** Percentiles of the histograms dumped as JSON */
+static const struct {
+    const char *key;
+    double      quantile;
+} DUMP_PERCENTILES[] = {
+    {"p50", 0.5},
+    {"p90", 0.9},
+    {"p99", 0.99},
+    {"p999", 0.999},
+};
+
+/** Add the count, sum, extrema and percentiles of a histogram to \p metric */
+static void dump_hist_json(struct pho_stat *stat, json_t *metric)
+{
+    struct pho_stat_hist *hist = xmalloc(sizeof(*hist));
+    size_t i;
+
+    pho_stat_hist_get(stat, hist);
+
+    json_object_set_new(metric, "value", json_integer(hist->count));
+    json_object_set_new(metric, "count", json_integer(hist->count));
+    json_object_set_new(metric, "sum", json_integer(hist->sum));
+    json_object_set_new(metric, "min", json_integer(hist->min));
+    json_object_set_new(metric, "max", json_integer(hist->max));
+    for (i = 0; i < ARRAY_SIZE(DUMP_PERCENTILES); i++)
+        json_object_set_new(metric, DUMP_PERCENTILES[i].key,
+                            json_integer(pho_stat_hist_percentile(hist,
+                                             DUMP_PERCENTILES[i].quantile)));
+
+    free(hist);
+}
+
 /**
  * Dump stats as json
  */
@@ -367,7 +573,12 @@ json_t *pho_stats_dump_json(const char *ns_filter, const char *name_filter,
 
         json_object_set_new(metric, "name", json_string(stat->full_name));
         json_object_set_new(metric, "tags", json_string(stat->tags));
-        json_object_set_new(metric, "value", json_integer(stat->value));
+        json_object_set_new(metric, "type",
+                            json_string(pho_stat_type2str(stat->type)));
+        if (stat->type == PHO_STAT_HISTOGRAM)
+            dump_hist_json(stat, metric);
+        else
+            json_object_set_new(metric, "value", json_integer(stat->value));
 
         rc = json_array_append_new(dump, metric);
         if (rc == -1) {
@@ -387,3 +598,176 @@ free_json:
     }
     return dump;
 }
+
+/** Prefix of the metric names in the OpenMetrics exposition */
+#define OPENMETRICS_PREFIX "phobos_"
+
+/** Append \p name to \p out, with the characters invalid in a metric or label
+ *  name replaced by '_'
+ */
+static void openmetrics_append_name(GString *out, const char *name)
+{
+    const char *c;
+
+    for (c = name; *c; c++)
+        g_string_append_c(out, g_ascii_isalnum(*c) ? *c : '_');
+}
+
+/** Append the labels of \p stat, and \p le if not NULL, to \p out */
+static void openmetrics_append_labels(GString *out, struct pho_stat *stat,
+                                      const char *le)
+{
+    bool first = true;
+    size_t i;
+
+    if (stat->tag_list.count == 0 && !le)
+        return;
+
+    g_string_append_c(out, '{');
+    for (i = 0; i < stat->tag_list.count; i++) {
+        const char *c;
+
+        if (!first)
+            g_string_append_c(out, ',');
+        first = false;
+
+        openmetrics_append_name(out, stat->tag_list.pairs[i].key);
+        g_string_append(out, "=\"");
+        for (c = stat->tag_list.pairs[i].value; *c; c++) {
+            if (*c == '\\' || *c == '"')
+                g_string_append_c(out, '\\');
+            if (*c == '\n')
+                g_string_append(out, "\\n");
+            else
+                g_string_append_c(out, *c);
+        }
+        g_string_append_c(out, '"');
+    }
+
+    if (le)
+        g_string_append_printf(out, "%sle=\"%s\"", first ? "" : ",", le);
+
+    g_string_append_c(out, '}');
+}
+
+/** Append the samples of a histogram: its cumulative buckets, its count and
+ *  its sum. To keep the number of series low, the fine buckets are merged into
+ *  one bucket per power of two, whose upper bounds are 2^k - 1. They are all
+ *  written, even the empty ones, so that the series of a bucket does not
+ *  disappear between two scrapes. The last one is the "+Inf" bucket.
+ */
+static void openmetrics_append_hist(GString *out, struct pho_stat *stat,
+                                    const char *family)
+{
+    struct pho_stat_hist *hist = xmalloc(sizeof(*hist));
+    uint64_t cumulated = 0;
+    char le[32];
+    size_t i;
+
+    pho_stat_hist_get(stat, hist);
+
+    for (i = 0; i < PHO_STAT_HIST_BUCKETS - 1; i++) {
+        uint64_t max = pho_stat_hist_bucket_max(i);
+
+        cumulated += hist->buckets[i];
+
+        /* only the buckets ending below a power of two are written */
+        if (max & (max + 1))
+            continue;
+
+        snprintf(le, sizeof(le), "%"PRIu64, max);
+        g_string_append_printf(out, "%s_bucket", family);
+        openmetrics_append_labels(out, stat, le);
+        g_string_append_printf(out, " %"PRIu64"\n", cumulated);
+    }
+
+    g_string_append_printf(out, "%s_bucket", family);
+    openmetrics_append_labels(out, stat, "+Inf");
+    g_string_append_printf(out, " %"PRIu64"\n", hist->count);
+
+    g_string_append_printf(out, "%s_count", family);
+    openmetrics_append_labels(out, stat, NULL);
+    g_string_append_printf(out, " %"PRIu64"\n", hist->count);
+
+    g_string_append_printf(out, "%s_sum", family);
+    openmetrics_append_labels(out, stat, NULL);
+    g_string_append_printf(out, " %"PRIu64"\n", hist->sum);
+
+    free(hist);
+}
+
+static gint stat_cmp_full_name(gconstpointer a, gconstpointer b)
+{
+    const struct pho_stat *stat_a = *(struct pho_stat * const *)a;
+    const struct pho_stat *stat_b = *(struct pho_stat * const *)b;
+
+    return strcmp(stat_a->full_name, stat_b->full_name);
+}
+
+/**
+ * Dump stats in the OpenMetrics text format. The samples of a metric family
+ * must be contiguous, so the stats are sorted by name first.
+ */
+char *pho_stats_dump_openmetrics(const char *ns_filter, const char *name_filter,
+                                 const char *tag_set)
+{
+    GString *family = g_string_new(NULL);
+    GString *out = g_string_new(NULL);
+    struct pho_stat_iter *iter;
+    const char *previous = NULL;
+    struct pho_stat *stat;
+    GPtrArray *stats;
+    guint i;
+
+    iter = pho_stat_iter_init(ns_filter, name_filter, tag_set);
+    if (!iter) {
+        g_string_free(family, true);
+        g_string_free(out, true);
+        return NULL;
+    }
+
+    stats = g_ptr_array_new();
+    while ((stat = pho_stat_iter_next(iter)) != NULL)
+        g_ptr_array_add(stats, stat);
+
+    /* stable sort: the stats of a family keep their creation order */
+    g_ptr_array_sort(stats, stat_cmp_full_name);
+
+    for (i = 0; i < stats->len; i++) {
+        stat = g_ptr_array_index(stats, i);
+
+        g_string_assign(family, OPENMETRICS_PREFIX);
+        openmetrics_append_name(family, stat->full_name);
+
+        if (!previous || strcmp(previous, stat->full_name))
+            g_string_append_printf(out, "# TYPE %s %s\n", family->str,
+                                   pho_stat_type2str(stat->type));
+        previous = stat->full_name;
+
+        switch (stat->type) {
+        case PHO_STAT_COUNTER:
+            g_string_append_printf(out, "%s_total", family->str);
+            openmetrics_append_labels(out, stat, NULL);
+            g_string_append_printf(out, " %"PRIu64"\n",
+                                   (uint64_t)atomic_load(&stat->value));
+            break;
+        case PHO_STAT_GAUGE:
+            g_string_append(out, family->str);
+            openmetrics_append_labels(out, stat, NULL);
+            g_string_append_printf(out, " %"PRIu64"\n",
+                                   (uint64_t)atomic_load(&stat->value));
+            break;
+        case PHO_STAT_HISTOGRAM:
+            openmetrics_append_hist(out, stat, family->str);
+            break;
+        }
+    }
+
+    pho_stat_iter_close(iter);
+
+    g_string_append(out, "# EOF\n");
+    g_ptr_array_free(stats, true);
+    g_string_free(family, true);
+
+    return g_string_free(out, false);
+}
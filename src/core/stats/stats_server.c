@@ -0,0 +1,333 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  HTTP server exposing the Phobos metrics in the OpenMetrics format
+ *
+ * The server only understands "GET /metrics" and closes the connection after
+ * each response, which is enough for the scrapers of Prometheus-compatible
+ * monitoring systems.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "pho_common.h"
+#include "pho_stats.h"
+
+/** Maximum size of a request header */
+#define REQUEST_MAX_SIZE    4096
+/** Timeout of the reads and writes on a client socket */
+#define CLIENT_TIMEOUT_SEC  5
+
+#define OPENMETRICS_CONTENT_TYPE \
+    "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+struct pho_stats_server {
+    int       listen_fd;    /**< socket accepting the scrapers */
+    int       stop_fd;      /**< eventfd written to stop the thread */
+    pthread_t thread;       /**< thread serving the clients */
+};
+
+/** Split "host:port", "[host]:port" or ":port", \p host is NULL for ":port" */
+static int parse_listen(const char *listen, char **host, char **port)
+{
+    const char *sep;
+
+    if (listen[0] == '[') {
+        const char *end = strchr(listen, ']');
+
+        if (!end || end[1] != ':')
+            return -EINVAL;
+
+        *host = xstrndup(listen + 1, end - listen - 1);
+        sep = end + 1;
+    } else {
+        sep = strrchr(listen, ':');
+        if (!sep)
+            return -EINVAL;
+
+        *host = sep == listen ? NULL : xstrndup(listen, sep - listen);
+    }
+
+    if (sep[1] == '\0') {
+        free(*host);
+        return -EINVAL;
+    }
+
+    *port = xstrdup(sep + 1);
+    return 0;
+}
+
+static int listen_socket(const char *listen_addr)
+{
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+        .ai_flags = AI_PASSIVE,
+    };
+    struct addrinfo *addrs;
+    struct addrinfo *addr;
+    char *host;
+    char *port;
+    int fd = -1;
+    int rc;
+
+    rc = parse_listen(listen_addr, &host, &port);
+    if (rc)
+        LOG_RETURN(rc, "Invalid metrics listen address '%s', expected "
+                   "'host:port'", listen_addr);
+
+    rc = getaddrinfo(host, port, &hints, &addrs);
+    free(host);
+    free(port);
+    if (rc)
+        LOG_RETURN(-EADDRNOTAVAIL, "Cannot resolve metrics listen address "
+                   "'%s': %s", listen_addr, gai_strerror(rc));
+
+    rc = -EADDRNOTAVAIL;
+    for (addr = addrs; addr; addr = addr->ai_next) {
+        int one = 1;
+
+        fd = socket(addr->ai_family, addr->ai_socktype | SOCK_CLOEXEC,
+                    addr->ai_protocol);
+        if (fd < 0) {
+            rc = -errno;
+            continue;
+        }
+
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (!bind(fd, addr->ai_addr, addr->ai_addrlen) && !listen(fd, 16))
+            break;
+
+        rc = -errno;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addrs);
+
+    if (fd < 0)
+        LOG_RETURN(rc, "Cannot listen to metrics address '%s'", listen_addr);
+
+    return fd;
+}
+
+static int send_all(int fd, const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t sent = send(fd, buf, len, MSG_NOSIGNAL);
+
+        if (sent < 0) {
+            if (errno == EINTR)
+                continue;
+            return -errno;
+        }
+
+        buf += sent;
+        len -= sent;
+    }
+
+    return 0;
+}
+
+static void send_response(int fd, const char *status, const char *content_type,
+                          const char *body)
+{
+    char *header;
+    int len;
+
+    len = asprintf(&header,
+                   "HTTP/1.1 %s\r\n"
+                   "Content-Type: %s\r\n"
+                   "Content-Length: %zu\r\n"
+                   "Connection: close\r\n"
+                   "\r\n", status, content_type, strlen(body));
+    if (len < 0)
+        return;
+
+    if (!send_all(fd, header, len))
+        send_all(fd, body, strlen(body));
+
+    free(header);
+}
+
+/** Read the request header of a client, NULL on error or timeout */
+static char *recv_request(int fd)
+{
+    char *buf = xmalloc(REQUEST_MAX_SIZE + 1);
+    size_t len = 0;
+
+    while (len < REQUEST_MAX_SIZE) {
+        ssize_t received = recv(fd, buf + len, REQUEST_MAX_SIZE - len, 0);
+
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received <= 0)
+            break;
+
+        len += received;
+        buf[len] = '\0';
+        if (strstr(buf, "\r\n\r\n") || strstr(buf, "\n\n"))
+            return buf;
+    }
+
+    free(buf);
+    return NULL;
+}
+
+static void serve_client(int fd)
+{
+    struct timeval timeout = { .tv_sec = CLIENT_TIMEOUT_SEC };
+    size_t path_len;
+    char *request;
+    char *body;
+
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    request = recv_request(fd);
+    if (!request)
+        return;
+
+    if (strncmp(request, "GET ", 4)) {
+        send_response(fd, "405 Method Not Allowed", "text/plain",
+                      "Only GET is supported\n");
+        goto out;
+    }
+
+    /* the query string, if any, is ignored */
+    path_len = strcspn(request + 4, " ?\r\n");
+    if (path_len != strlen("/metrics") ||
+        strncmp(request + 4, "/metrics", path_len)) {
+        send_response(fd, "404 Not Found", "text/plain",
+                      "Metrics are served at /metrics\n");
+        goto out;
+    }
+
+    body = pho_stats_dump_openmetrics(NULL, NULL, NULL);
+    if (!body) {
+        send_response(fd, "500 Internal Server Error", "text/plain",
+                      "Failed to dump the metrics\n");
+        goto out;
+    }
+
+    send_response(fd, "200 OK", OPENMETRICS_CONTENT_TYPE, body);
+    free(body);
+
+out:
+    free(request);
+}
+
+static void *stats_server_thread(void *arg)
+{
+    struct pho_stats_server *server = arg;
+
+    while (true) {
+        struct pollfd fds[2] = {
+            { .fd = server->listen_fd, .events = POLLIN },
+            { .fd = server->stop_fd, .events = POLLIN },
+        };
+        int fd;
+
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            pho_error(-errno, "Metrics server failed to poll");
+            break;
+        }
+
+        if (fds[1].revents)
+            break;
+
+        if (!(fds[0].revents & POLLIN))
+            continue;
+
+        fd = accept4(server->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0)
+            continue;
+
+        serve_client(fd);
+        close(fd);
+    }
+
+    return NULL;
+}
+
+int pho_stats_server_start(const char *listen, struct pho_stats_server **server)
+{
+    struct pho_stats_server *srv;
+    int rc;
+
+    srv = xmalloc(sizeof(*srv));
+
+    srv->listen_fd = listen_socket(listen);
+    if (srv->listen_fd < 0)
+        GOTO(free_srv, rc = srv->listen_fd);
+
+    srv->stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (srv->stop_fd < 0)
+        LOG_GOTO(close_listen, rc = -errno, "Cannot create eventfd");
+
+    rc = -pthread_create(&srv->thread, NULL, stats_server_thread, srv);
+    if (rc)
+        LOG_GOTO(close_stop, rc, "Cannot start the metrics server thread");
+
+    pho_info("Metrics are served at http://%s/metrics", listen);
+    *server = srv;
+
+    return 0;
+
+close_stop:
+    close(srv->stop_fd);
+close_listen:
+    close(srv->listen_fd);
+free_srv:
+    free(srv);
+    return rc;
+}
+
+void pho_stats_server_stop(struct pho_stats_server *server)
+{
+    uint64_t one = 1;
+
+    if (!server)
+        return;
+
+    if (write(server->stop_fd, &one, sizeof(one)) != sizeof(one))
+        pho_error(-errno, "Cannot stop the metrics server thread");
+    else
+        pthread_join(server->thread, NULL);
+
+    close(server->stop_fd);
+    close(server->listen_fd);
+    free(server);
+}
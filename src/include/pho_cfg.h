@@ -241,4 +241,12 @@ int get_cfg_default_copy_name(const char **copy_name);
  */
 int get_cfg_preferred_order(char ***values, size_t *count);
 
+/**
+ * Tell whether the tapes are handled by the simulated library and drives
+ * ("[ldm] tape_backend = sim") instead of the SCSI ones.
+ *
+ * @return true if the tape backend is the simulator
+ */
+bool cfg_tape_backend_is_sim(void);
+
 #endif
@@ -53,6 +53,7 @@
 #define TLC_LISTEN_PORT_CFG_PARAM "listen_port"
 #define TLC_LISTEN_INTERFACE_CFG_PARAM "listen_interface"
 #define TLC_LIB_DEVICE_CFG_PARAM "lib_device"
+#define TLC_METRICS_LISTEN_CFG_PARAM "metrics_listen"
 #define DEFAULT_TLC_LIB_DEVICE "/dev/changer"
 
 /**
@@ -241,6 +242,23 @@ int pho_comm_close(struct pho_comm_info *ci);
  */
 int pho_comm_send(const struct pho_comm_data *data);
 
+/**
+ * Send several messages through the same socket, gathered in as few system
+ * calls as the socket buffer allows.
+ *
+ * The messages are sent in order, and all of them must have the same socket
+ * descriptor.
+ *
+ * \param[in]       data        Messages to send.
+ * \param[in]       n_data      Number of messages to send.
+ * \param[out]      n_sent      Number of messages fully sent, even on failure
+ *                              (may be NULL).
+ *
+ * \return                      0 on success, -errno on failure.
+ */
+int pho_comm_send_batch(const struct pho_comm_data *data, size_t n_data,
+                        size_t *n_sent);
+
 /**
  * Receive a message from the unix socket.
  *
@@ -260,4 +278,35 @@ int pho_comm_send(const struct pho_comm_data *data);
 int pho_comm_recv(struct pho_comm_info *ci, struct pho_comm_data **data,
                   int *nb_data);
 
+/**
+ * Wait for a message to be received on a client socket.
+ *
+ * A connection closed by the server also ends the wait, the next call to
+ * pho_comm_recv() then reports it.
+ * Server sockets wait for their clients inside pho_comm_recv(), so this call
+ * returns immediately for them.
+ *
+ * \param[in]       ci          Communication info.
+ * \param[in]       timeout_ms  Maximum time to wait in milliseconds, -1 to wait
+ *                              without limit.
+ *
+ * \return                      1 if a message can be received, 0 on timeout
+ *                              or interruption, -errno on failure.
+ */
+int pho_comm_wait(struct pho_comm_info *ci, int timeout_ms);
+
+/**
+ * Make an eventfd end the wait of pho_comm_recv() on a server socket.
+ *
+ * When the eventfd is written to, pho_comm_recv() returns without waiting for
+ * its clients and resets the eventfd. The descriptor is duplicated: the caller
+ * keeps ownership of \p fd.
+ *
+ * \param[in]       ci          Communication info of a server socket.
+ * \param[in]       fd          Eventfd to watch.
+ *
+ * \return                      0 on success, -errno on failure.
+ */
+int pho_comm_add_wakeup_fd(struct pho_comm_info *ci, int fd);
+
 #endif
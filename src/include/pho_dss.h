@@ -324,7 +324,10 @@ void dss_filter_free(struct dss_filter *filter);
 
 /* Exposed externally for python bindings generation */
 struct dss_handle {
-    void  *dh_conn;
+    void     *dh_conn;
+    uint64_t  dh_prepared; /**< Bitmask of the statements prepared on dh_conn,
+                             *  see enum dss_statement
+                             */
 };
 
 /**
@@ -360,6 +363,73 @@ void dss_res_free(void *item_list, int item_cnt);
 int dss_execute_generic_get(struct dss_handle *handle, enum dss_type type,
                             GString *clause, void **item_list, int *item_cnt);
 
+/** Default number of rows fetched at once by the DSS iterators */
+#define DSS_ITER_BATCH_SIZE 1024
+
+/**
+ * Iterator over the rows of a select query, fetched by batches from a
+ * server-side cursor instead of being loaded at once.
+ *
+ * The cursor lives in a transaction of the handle, opened by the iterator if
+ * none is in progress and ended by dss_iter_close(). Other requests may be
+ * executed on the handle while iterating, but a failed one aborts the
+ * transaction and thus the iteration.
+ */
+struct dss_iter;
+
+/**
+ * Open an iterator over the rows of a select query
+ *
+ * @param[in]  handle      Connection handle
+ * @param[in]  type        Type of the resource to get
+ * @param[in]  query       Select query to iterate over
+ * @param[in]  batch_size  Number of rows per batch, 0 for DSS_ITER_BATCH_SIZE
+ * @param[out] iter        Iterator to close with dss_iter_close()
+ *
+ * @return 0 on success, negated errno on failure
+ */
+int dss_iter_open(struct dss_handle *handle, enum dss_type type,
+                  GString *query, size_t batch_size, struct dss_iter **iter);
+
+/**
+ * Open an iterator over the resources of type \p type matching \p filter
+ *
+ * @param[in]  handle      Connection handle
+ * @param[in]  type        Type of the resource to get
+ * @param[in]  filter      Assembled DSS filtering criteria
+ * @param[in]  sort        Sort filter, only sorts done by PSQL are supported
+ * @param[in]  batch_size  Number of rows per batch, 0 for DSS_ITER_BATCH_SIZE
+ * @param[out] iter        Iterator to close with dss_iter_close()
+ *
+ * @return 0 on success, negated errno on failure
+ */
+int dss_select_iter_open(struct dss_handle *handle, enum dss_type type,
+                         const struct dss_filter *filter,
+                         struct dss_sort *sort, size_t batch_size,
+                         struct dss_iter **iter);
+
+/**
+ * Retrieve the next batch of items of an iterator
+ *
+ * The items are owned by the iterator and valid until the next call to
+ * dss_iter_next() or dss_iter_close().
+ *
+ * @param[in,out] iter       Iterator
+ * @param[out]    item_list  Items of the batch
+ * @param[out]    item_cnt   Number of items of the batch, 0 once every item
+ *                           has been retrieved
+ *
+ * @return 0 on success, negated errno on failure
+ */
+int dss_iter_next(struct dss_iter *iter, void **item_list, int *item_cnt);
+
+/**
+ * Close an iterator and free its last batch
+ *
+ * @param[in]  iter  Iterator to close, may be NULL
+ */
+void dss_iter_close(struct dss_iter *iter);
+
 /**
  * Insert information of one or many devices in DSS.
  *
@@ -509,6 +579,34 @@ int dss_extent_get(struct dss_handle *handle, const struct dss_filter *filter,
                    struct extent **extents, int *extent_count,
                    struct dss_sort *sort);
 
+/**
+ * Open an iterator over the extents matching \p filter, see struct dss_iter.
+ *
+ * @param[in]  handle      valid connection handle
+ * @param[in]  filter      assembled DSS filtering criteria
+ * @param[in]  sort        sort filter
+ * @param[in]  batch_size  number of extents per batch, 0 for the default
+ * @param[out] iter        iterator to close with dss_iter_close()
+ *
+ * @return 0 on success, negated errno on failure
+ */
+int dss_extent_iter_open(struct dss_handle *handle,
+                         const struct dss_filter *filter,
+                         struct dss_sort *sort, size_t batch_size,
+                         struct dss_iter **iter);
+
+/**
+ * Retrieve the next batch of extents of an iterator, see dss_iter_next().
+ *
+ * @param[in,out] iter          iterator opened by dss_extent_iter_open()
+ * @param[out]    extents       extents of the batch, owned by the iterator
+ * @param[out]    extent_count  number of extents, 0 at the end of the iteration
+ *
+ * @return 0 on success, negated errno on failure
+ */
+int dss_extent_iter_next(struct dss_iter *iter, struct extent **extents,
+                         int *extent_count);
+
 /**
  * Delete information for one or many extent in DSS.
  *
@@ -221,6 +221,28 @@ int dss_move_deprecated_to_object(struct dss_handle *handle,
                                   struct object_info *obj_list,
                                   int obj_cnt);
 
+/**
+ * Reserve the oids of new objects by inserting them along with their
+ * incomplete copy \p copy_name, all in a single transaction.
+ *
+ * Either all the objects are inserted or none of them: if one oid already
+ * exists, the transaction is rolled back and -EEXIST is returned.
+ *
+ * @param[in,out] handle    DSS handle
+ * @param[in,out] obj_list  Objects to insert, oid, user_md, grouping and size
+ *                          must be filled. On success, their uuid and version
+ *                          are set and the uuids must be freed by the caller.
+ * @param[in]     obj_cnt   Number of objects
+ * @param[in]     copy_name Name of the copy to insert for each object
+ * @param[out]    obj_rcs   Outcome of each object, -EEXIST for the objects
+ *                          whose oid already exists
+ *
+ * @return 0 on success, -EEXIST if an oid already exists, another negated
+ *         errno code on failure
+ */
+int dss_object_reserve(struct dss_handle *handle, struct object_info *obj_list,
+                       int obj_cnt, const char *copy_name, int *obj_rcs);
+
 /**
  * Update the layout and extent databases following an extent migrate action:
  * - all \p old_uuid occurences will be replaced by \p new_uuid in layout;
@@ -318,4 +340,33 @@ int dss_get_living_and_deprecated_objects(struct dss_handle *handle,
                                           struct object_info **objs,
                                           int *n_objs);
 
+/**
+ * Open an iterator over the objects of \p scope, see struct dss_iter.
+ *
+ * @param[in]   handle      DSS handle
+ * @param[in]   filter      Assembled DSS filtering criteria
+ * @param[in]   scope       Iterate only/also over the deprecated objects
+ * @param[in]   sort        Sort the output
+ * @param[in]   batch_size  Number of objects per batch, 0 for the default
+ * @param[out]  iter        Iterator to close with dss_iter_close()
+ *
+ * @return 0 or negative error code
+ */
+int dss_object_iter_open(struct dss_handle *handle,
+                         const struct dss_filter *filter,
+                         enum dss_obj_scope scope, struct dss_sort *sort,
+                         size_t batch_size, struct dss_iter **iter);
+
+/**
+ * Retrieve the next batch of objects of an iterator, see dss_iter_next().
+ *
+ * @param[in,out]   iter    Iterator opened by dss_object_iter_open()
+ * @param[out]      objs    Objects of the batch, owned by the iterator
+ * @param[out]      n_objs  Number of objects, 0 at the end of the iteration
+ *
+ * @return 0 or negative error code
+ */
+int dss_object_iter_next(struct dss_iter *iter, struct object_info **objs,
+                         int *n_objs);
+
 #endif
@@ -108,6 +108,9 @@ struct pho_io_adapter_module_ops {
                                              struct extent *extent_to_insert,
                                              struct object_info *obj_info);
     ssize_t (*ioa_size)(struct pho_io_descr *iod);
+    int (*ioa_seek)(struct pho_io_descr *iod, off_t offset, int whence);
+    int (*ioa_pwrite)(struct pho_io_descr *iod, const void *buf, size_t count,
+                      off_t offset);
 };
 
 struct io_adapter_module {
@@ -396,6 +399,54 @@ static inline ssize_t ioa_size(const struct io_adapter_module *ioa,
     return ioa->ops->ioa_size(iod);
 }
 
+/**
+ * Move the position of the next read or write of an opened extent.
+ *
+ * \param[in]       ioa         Suitable I/O adapter for the media
+ * \param[in,out]   iod         I/O descriptor of the opened extent
+ * \param[in]       offset      Offset to move to, relative to \p whence
+ * \param[in]       whence      SEEK_SET or SEEK_CUR, as for lseek(2)
+ *
+ * \return 0 on success, negative error code on failure
+ * \retval -ENOTSUP the I/O adapter does not provide this function
+ */
+static inline int ioa_seek(const struct io_adapter_module *ioa,
+                           struct pho_io_descr *iod, off_t offset, int whence)
+{
+    assert(ioa != NULL);
+    assert(ioa->ops != NULL);
+    if (ioa->ops->ioa_seek == NULL)
+        return -ENOTSUP;
+
+    return ioa->ops->ioa_seek(iod, offset, whence);
+}
+
+/**
+ * Write data at a given position of an opened extent, without moving the
+ * position of the next read or write.
+ *
+ * \param[in]       ioa         Suitable I/O adapter for the media
+ * \param[in,out]   iod         I/O descriptor of the opened extent
+ * \param[in]       buf         Data to write
+ * \param[in]       count       Number of bytes to write
+ * \param[in]       offset      Position to write at, from the start of the
+ *                              extent
+ *
+ * \return 0 on success, negative error code on failure
+ * \retval -ENOTSUP the I/O adapter does not provide this function
+ */
+static inline int ioa_pwrite(const struct io_adapter_module *ioa,
+                             struct pho_io_descr *iod, const void *buf,
+                             size_t count, off_t offset)
+{
+    assert(ioa != NULL);
+    assert(ioa->ops != NULL);
+    if (ioa->ops->ioa_pwrite == NULL)
+        return -ENOTSUP;
+
+    return ioa->ops->ioa_pwrite(iod, buf, count, offset);
+}
+
 /**
  * Retrieve io_block_size value from config file
  *
@@ -422,6 +473,19 @@ int get_cfg_io_block_size(size_t *size, enum rsc_family family);
  */
 int get_cfg_fs_block_size(enum rsc_family family, size_t *size);
 
+/**
+ * Retrieve the number of rotating buffers of the pipelined data path from the
+ * config file.
+ *
+ * 0 or 1 means that the data processors use a single buffer, and read, hash
+ * and write sequentially.
+ *
+ * \param[out]      n_buffers   pipeline_buffers value.
+ *
+ * \return 0 on success, -EINVAL if the value is invalid.
+ */
+int get_cfg_io_pipeline_buffers(size_t *n_buffers);
+
 /**
  * Retrieve the preferred IO size from the backend storage
  * if it was not set in the global "io" configuration.
@@ -482,4 +546,62 @@ int copy_extent(struct io_adapter_module *ioa_source,
 int set_object_md(const struct io_adapter_module *ioa, struct pho_io_descr *iod,
                   struct object_metadata *object_md);
 
+/**
+ * Skip the next \p count bytes of an extent opened for reading.
+ *
+ * The data is read and dropped if the I/O adapter cannot seek.
+ *
+ * \param[in]       ioa     I/O adapter of the medium.
+ * \param[in,out]   iod     I/O descriptor of the opened extent.
+ * \param[in]       count   Number of bytes to skip.
+ *
+ * \return 0 on success, negative error code on failure.
+ */
+int iod_skip(const struct io_adapter_module *ioa, struct pho_io_descr *iod,
+             size_t count);
+
+/**
+ * Packed objects: the objects of a put are written one after the other in a
+ * single container extent per medium, followed by an index of the container.
+ *
+ * The index is the JSON object {"objects": [{"extent": <uuid>, "offset": <n>,
+ * "size": <n>}, ...]}, written right after the data and followed by a footer
+ * made of PHO_PACK_MAGIC and of the size of the index as 16 hexadecimal
+ * digits, so that the index can be found from the end of the container.
+ */
+#define PHO_PACK_MAGIC          "PHOPACK1"
+#define PHO_PACK_FOOTER_SIZE    (sizeof(PHO_PACK_MAGIC) - 1 + 16)
+
+/**
+ * Upper bound of the size of the index and of the footer of a container.
+ *
+ * \param[in]       n_objects   Number of objects in the container.
+ *
+ * \return the size to reserve after the data of the container.
+ */
+size_t pack_index_max_size(size_t n_objects);
+
+/**
+ * Add an extent written in a container to the index of this container.
+ *
+ * \param[in,out]   index   Index of the container, allocated if NULL.
+ * \param[in]       extent  Extent written in the container, with its pack
+ *                          offset set.
+ */
+void pack_index_add(json_t **index, struct extent *extent);
+
+/**
+ * Write the index of a container and its footer at the current position of
+ * the container.
+ *
+ * \param[in]       ioa     I/O adapter of the medium.
+ * \param[in,out]   iod     I/O descriptor of the container, opened for writing.
+ * \param[in]       index   Index of the container.
+ *
+ * \return the number of bytes written on success, negative error code on
+ *         failure.
+ */
+ssize_t pack_index_write(const struct io_adapter_module *ioa,
+                         struct pho_io_descr *iod, json_t *index);
+
 #endif
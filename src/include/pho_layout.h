@@ -122,6 +122,8 @@ enum processor_type {
 };
 
 
+struct data_pipeline;
+
 /** A data processor capable of encoding, decoding or erasing  one object on
  * a set of media
  */
@@ -148,6 +150,16 @@ struct pho_data_processor {
                                       */
     int current_target;
     size_t object_size;
+    size_t range_offset;  /* offset in the object of the first byte to get */
+    size_t range_end;     /* offset in the object after the last byte to get,
+                           * object_size unless the GET is ranged
+                           */
+    size_t split_n_media; /* media a decoder reads each split from */
+    bool pwrite_output;   /* the decoder writes the byte at writer_offset at
+                           * (writer_offset + output_shift) in its output, for
+                           * the split readers of a GET sharing the output
+                           */
+    off_t output_shift;
     size_t reader_offset; /* offset in the object of the next byte to read */
     size_t reader_stripe_size;
     size_t writer_offset; /* offset in the object of the next byte to write */
@@ -163,6 +175,12 @@ struct pho_data_processor {
      */
     struct pho_buff buff; /* buffer to transfer between reader and writer */
     size_t buffer_offset; /* offset in the object of the first byte in buff */
+    size_t pipeline_buffers; /* rotating buffers of the pipelined data path,
+                              * disabled if lower than 2
+                              */
+    struct data_pipeline *pipeline; /* reader, writer and hasher threads of
+                                     * the pipelined data path
+                                     */
     void *private_reader; /* one reader per target (posix ones for encoder) */
     bool need_alloc_response_to_read; /* reader is waiting an alloc to read */
     const struct pho_proc_ops *reader_ops;
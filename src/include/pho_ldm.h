@@ -49,6 +49,14 @@ enum ldm_fs_spc_flag {
     PHO_FS_READONLY = (1 << 0),
 };
 
+/** segment of a mounted medium to read, to be ordered by ldm_rao_order() */
+struct ldm_rao_segment {
+    uint8_t  partition; /**< partition of the medium holding the segment */
+    uint64_t begin;     /**< first block of the segment */
+    uint64_t end;       /**< last block of the segment */
+    size_t   index;     /**< identifier of the segment for the caller */
+};
+
 /** information about used and available space on a media */
 struct ldm_fs_space {
     ssize_t                 spc_used;
@@ -62,6 +70,7 @@ struct ldm_fs_space {
  * them for more precise explanation about each call.
  *
  * dev_query and dev_lookup are mandatory.
+ * dev_rao returns -ENOTSUP if it is NULL.
  * Other calls can be NULL if no operation is required, and do noop.
  */
 struct pho_dev_adapter_module_ops {
@@ -69,6 +78,8 @@ struct pho_dev_adapter_module_ops {
     int (*dev_query)(const char *dev_path, struct ldm_dev_state *lds);
     int (*dev_load)(const char *dev_path);
     int (*dev_eject)(const char *dev_path);
+    int (*dev_rao)(const char *dev_path, struct ldm_rao_segment *segments,
+                   size_t count);
 };
 
 struct dev_adapter_module {
@@ -161,6 +172,47 @@ static inline int ldm_dev_eject(const struct dev_adapter_module *dev,
     return dev->ops->dev_eject(dev_path);
 }
 
+/**
+ * Ask a device for the Recommended Access Order of segments of its medium.
+ * @param[in]     dev         Device adapter module.
+ * @param[in]     dev_path    Device path.
+ * @param[in,out] segments    Segments to read, sorted in the order
+ *                            recommended by the device on success.
+ * @param[in]     count       Number of segments.
+ *
+ * @return 0 on success, -ENOTSUP if the device cannot order segments,
+ *         negative error code on failure.
+ */
+static inline int ldm_dev_rao(const struct dev_adapter_module *dev,
+                              const char *dev_path,
+                              struct ldm_rao_segment *segments, size_t count)
+{
+    assert(dev != NULL);
+    assert(dev->ops != NULL);
+    if (dev->ops->dev_rao == NULL)
+        return -ENOTSUP;
+    return dev->ops->dev_rao(dev_path, segments, count);
+}
+
+/**
+ * Sort segments of the medium of a device in the order they should be read.
+ *
+ * The order recommended by the device is used if it provides one, see
+ * ldm_dev_rao(). Otherwise, the segments are sorted by partition and first
+ * block.
+ *
+ * @param[in]     dev         Device adapter module.
+ * @param[in]     dev_path    Device path.
+ * @param[in,out] segments    Segments to read.
+ * @param[in]     count       Number of segments.
+ *
+ * @return 0 if the segments are in the order recommended by the device, the
+ *         negative error code of ldm_dev_rao() if they were sorted by
+ *         position instead.
+ */
+int ldm_rao_order(const struct dev_adapter_module *dev, const char *dev_path,
+                  struct ldm_rao_segment *segments, size_t count);
+
 /**
  * Free all resources associated with this lds.
  *
@@ -496,6 +548,7 @@ static inline int ldm_lib_stats(struct lib_handle *lib_hdl,
  *
  * fs_mounted, fs_df and fs_get_label are mandatory.
  * fs_mount, fs_umount and fs_format do noop if they are NULL.
+ * fs_file_position returns -ENOTSUP if it is NULL.
  */
 struct pho_fs_adapter_module_ops {
     int (*fs_mount)(const char *dev_path, const char *mnt_path,
@@ -511,6 +564,9 @@ struct pho_fs_adapter_module_ops {
     int (*fs_get_label)(const char *mnt_path, char *fs_label, size_t llen,
                         json_t **message);
     int (*fs_release)(const char *dev_path, json_t **message);
+    int (*fs_file_position)(const char *mnt_path, const char *address,
+                            uint8_t *partition, uint64_t *begin,
+                            uint64_t *end);
 };
 
 struct fs_adapter_module {
@@ -678,5 +734,31 @@ static inline int ldm_fs_get_label(const struct fs_adapter_module *fsa,
     return fsa->ops->fs_get_label(mnt_path, fs_label, llen, message);
 }
 
+/**
+ * Get the blocks of a file on the medium of a mounted filesystem.
+ * @param[in]  fsa        File system adapter module.
+ * @param[in]  mnt_path   Mount point of the filesystem.
+ * @param[in]  address    Path of the file relative to \p mnt_path.
+ * @param[out] partition  Partition of the medium holding the file.
+ * @param[out] begin      First block of the file on the partition.
+ * @param[out] end        Last block of the file on the partition.
+ *
+ * @return 0 on success, -ENOTSUP if the filesystem does not expose the
+ *         position of its files, negative error code on failure.
+ */
+static inline int ldm_fs_file_position(const struct fs_adapter_module *fsa,
+                                       const char *mnt_path,
+                                       const char *address,
+                                       uint8_t *partition, uint64_t *begin,
+                                       uint64_t *end)
+{
+    assert(fsa != NULL);
+    assert(fsa->ops != NULL);
+    if (fsa->ops->fs_file_position == NULL)
+        return -ENOTSUP;
+    return fsa->ops->fs_file_position(mnt_path, address, partition, begin,
+                                      end);
+}
+
 /** @}*/
 #endif
@@ -0,0 +1,153 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Multi-producer single-consumer FIFO queue
+ *
+ * Any thread may push to the queue, but only one thread at a time, the
+ * consumer, may pop from it.
+ *
+ * The elements are pushed to a bounded ring without taking any lock. When the
+ * ring is full, they are pushed to an overflow list protected by a mutex
+ * instead, so that pushing never fails nor blocks on the consumer. The
+ * elements pushed by one thread are popped in the order they were pushed.
+ *
+ * The consumer can wait for elements on an eventfd, which producers only write
+ * to when the consumer announced it is waiting.
+ */
+#ifndef _PHO_MPSC_QUEUE_H
+#define _PHO_MPSC_QUEUE_H
+
+#include <glib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Slot of the ring of a queue */
+struct mpsc_cell {
+    _Atomic size_t  seq;    /**< position this slot can be pushed to, or
+                              *  this position + 1 once its data is set
+                              */
+    void           *data;   /**< pushed element */
+};
+
+struct mpsc_queue {
+    struct mpsc_cell *cells;        /**< ring of \p mask + 1 slots */
+    size_t            mask;         /**< capacity of the ring - 1 */
+    size_t            head;         /**< next position to pop, only accessed
+                                      *  by the consumer
+                                      */
+    _Atomic size_t    tail __attribute__((aligned(64)));
+                                    /**< next position to push */
+    _Atomic unsigned int length __attribute__((aligned(64)));
+                                    /**< number of queued elements */
+    _Atomic unsigned int n_overflow;/**< number of elements in overflow */
+    pthread_mutex_t   overflow_mutex;
+                                    /**< protects overflow */
+    GQueue           *overflow;     /**< elements pushed when the ring was
+                                      *  full
+                                      */
+    atomic_bool       waiting;      /**< the consumer waits on efd */
+    int               efd;          /**< eventfd signaled when an element is
+                                      *  pushed while the consumer waits
+                                      */
+};
+
+/** Default capacity of the ring of a queue */
+#define MPSC_QUEUE_DEFAULT_CAPACITY 4096
+
+/**
+ * Initialize a queue.
+ *
+ * \param[out]  queue     Queue to initialize
+ * \param[in]   capacity  Number of elements the ring can hold, rounded up to a
+ *                        power of 2
+ *
+ * \return                0 on success, negative error code on failure
+ */
+int mpsc_queue_init(struct mpsc_queue *queue, size_t capacity);
+
+/**
+ * Release the resources of a queue.
+ *
+ * \param[in]   queue      Queue to destroy
+ * \param[in]   free_func  Called on each element still queued, may be NULL
+ */
+void mpsc_queue_destroy(struct mpsc_queue *queue, GDestroyNotify free_func);
+
+/**
+ * Push an element to a queue. Can be called by any thread.
+ *
+ * \param[in]   queue  Queue to push to
+ * \param[in]   data   Element to push, must not be NULL
+ */
+void mpsc_queue_push(struct mpsc_queue *queue, void *data);
+
+/**
+ * Pop the oldest element of a queue. Must only be called by the consumer.
+ *
+ * \param[in]   queue  Queue to pop from
+ *
+ * \return             The element, NULL if the queue is empty
+ */
+void *mpsc_queue_pop(struct mpsc_queue *queue);
+
+/**
+ * Number of elements of a queue.
+ *
+ * \param[in]   queue  Queue
+ *
+ * \return             Number of elements pushed and not popped yet
+ */
+static inline unsigned int mpsc_queue_get_length(struct mpsc_queue *queue)
+{
+    return atomic_load_explicit(&queue->length, memory_order_relaxed);
+}
+
+/**
+ * Announce that the consumer is about to wait on the eventfd of a queue.
+ *
+ * Once this is called, the next push writes to the eventfd. If the queue is not
+ * empty, it is written to right away, so that the wait does not block.
+ * Must only be called by the consumer.
+ *
+ * \param[in]   queue  Queue
+ *
+ * \return             The eventfd of the queue
+ */
+int mpsc_queue_arm_wakeup(struct mpsc_queue *queue);
+
+/**
+ * Wait for an element to be pushed to a queue. Must only be called by the
+ * consumer.
+ *
+ * \param[in]   queue       Queue
+ * \param[in]   timeout_ms  Maximum time to wait in milliseconds, -1 to wait
+ *                          without limit
+ *
+ * \return                  0 if the queue is not empty or was pushed to,
+ *                          -ETIMEDOUT if the wait timed out,
+ *                          negative error code on failure
+ */
+int mpsc_queue_wait(struct mpsc_queue *queue, int timeout_ms);
+
+#endif
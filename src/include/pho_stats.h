@@ -25,14 +25,37 @@
 #ifndef _PHO_STATS_H
 #define _PHO_STATS_H
 
+#include <stddef.h>
 #include <stdint.h>
+#include <time.h>
 #include <jansson.h>
 
 struct pho_stat;
 
 enum pho_stat_type {
-    PHO_STAT_COUNTER, /**< Stat is a Counter (cumulative). */
-    PHO_STAT_GAUGE    /**< Stat is a Gauge (variable). */
+    PHO_STAT_COUNTER,  /**< Stat is a Counter (cumulative). */
+    PHO_STAT_GAUGE,    /**< Stat is a Gauge (variable). */
+    PHO_STAT_HISTOGRAM /**< Stat is a Histogram of observed values. */
+};
+
+/**
+ * Histograms count the observed values in log-linear buckets: each power of two
+ * is split in PHO_STAT_HIST_SUB_COUNT buckets of equal width, so that the
+ * relative error of a percentile is at most 1 / PHO_STAT_HIST_SUB_COUNT.
+ * Values lower than PHO_STAT_HIST_SUB_COUNT have a bucket of their own.
+ */
+#define PHO_STAT_HIST_SUB_BITS  3
+#define PHO_STAT_HIST_SUB_COUNT (1 << PHO_STAT_HIST_SUB_BITS)
+#define PHO_STAT_HIST_BUCKETS   ((64 - PHO_STAT_HIST_SUB_BITS + 1) * \
+                                 PHO_STAT_HIST_SUB_COUNT)
+
+/** Snapshot of a histogram */
+struct pho_stat_hist {
+    uint64_t count;                          /**< number of observations */
+    uint64_t sum;                            /**< sum of the observed values */
+    uint64_t min;                            /**< lowest observed value */
+    uint64_t max;                            /**< highest observed value */
+    uint64_t buckets[PHO_STAT_HIST_BUCKETS]; /**< observations per bucket */
 };
 
 /**
@@ -74,11 +97,62 @@ void pho_stat_incr(struct pho_stat *stat, uint64_t val);
 void pho_stat_set(struct pho_stat *stat, uint64_t val);
 
 /**
- *  Get the value from a stat.
+ * Record a value in a histogram.
+ *
+ * \param[in] stat  Histogram created by pho_stat_create()
+ * \param[in] val   Observed value
+ */
+void pho_stat_observe(struct pho_stat *stat, uint64_t val);
+
+/**
+ * Record in a histogram the microseconds elapsed since \p start.
+ *
+ * \param[in] stat   Histogram created by pho_stat_create()
+ * \param[in] start  Start of the measured operation, from CLOCK_REALTIME
+ */
+void pho_stat_observe_since(struct pho_stat *stat,
+                            const struct timespec *start);
+
+/**
+ *  Get the value from a stat. The value of a histogram is its number of
+ *  observations.
  *  \retval UINT64_MAX on error.
  */
 uint64_t pho_stat_get(struct pho_stat *stat);
 
+/**
+ * Take a snapshot of a histogram, without blocking the observers.
+ *
+ * \param[in]  stat  Histogram created by pho_stat_create()
+ * \param[out] hist  Snapshot of the histogram
+ *
+ * \return 0 on success, -EINVAL if \p stat is not a histogram.
+ */
+int pho_stat_hist_get(struct pho_stat *stat, struct pho_stat_hist *hist);
+
+/**
+ * Get the highest value counted in a histogram bucket.
+ *
+ * \param[in] index  Index of the bucket, lower than PHO_STAT_HIST_BUCKETS
+ */
+uint64_t pho_stat_hist_bucket_max(size_t index);
+
+/**
+ * Estimate a percentile of a histogram snapshot.
+ *
+ * \param[in] hist      Snapshot taken by pho_stat_hist_get()
+ * \param[in] quantile  Quantile between 0 and 1 (e.g. 0.99 for the 99th
+ *                      percentile)
+ *
+ * \return the highest value of the bucket of the percentile, bounded by the
+ *         lowest and highest observed values, 0 if there is no observation.
+ */
+uint64_t pho_stat_hist_percentile(const struct pho_stat_hist *hist,
+                                  double quantile);
+
+/** Get the name of a stat type ("counter", "gauge" or "histogram") */
+const char *pho_stat_type2str(enum pho_stat_type type);
+
 /**
  * Initialize a stats iterator with optional namespace, name and tags.
  * \param[in] namespace Filter on the namespace name. Optional, can be NULL.
@@ -103,6 +177,10 @@ void pho_stat_iter_close(struct pho_stat_iter *iter);
 /**
  * Dumps stats as JSON. Apply the same filters as pho_stat_iter_init().
  *
+ * Each stat is dumped with its name, tags, type and value. Histograms are also
+ * dumped with their count, sum, min, max and percentiles p50, p90, p99 and
+ * p999, their value being their count.
+ *
  * \param[in] namespace Filter on the namespace name. Optional, can be NULL.
  * \param[in] name      Filter on the metric name. Optional, can be NULL.
  * \param[in] tag_set   A list of tag of coma-separated filters in the format
@@ -112,4 +190,43 @@ void pho_stat_iter_close(struct pho_stat_iter *iter);
 json_t *pho_stats_dump_json(const char *ns_filter, const char *name_filter,
                             const char *tag_set);
 
+/**
+ * Dumps stats in the OpenMetrics text format. Apply the same filters as
+ * pho_stat_iter_init().
+ *
+ * The metric names are prefixed by "phobos_" and their '.' replaced by '_',
+ * the tags are given as labels. The values are read without taking any other
+ * lock than the one of the stat registry.
+ *
+ * \param[in] namespace Filter on the namespace name. Optional, can be NULL.
+ * \param[in] name      Filter on the metric name. Optional, can be NULL.
+ * \param[in] tag_set   A list of tag of coma-separated filters in the format
+ *                      "tag=value,tag=value,...".
+ * \return  A newly allocated string on success, NULL on error.
+ */
+char *pho_stats_dump_openmetrics(const char *ns_filter, const char *name_filter,
+                                 const char *tag_set);
+
+struct pho_stats_server;
+
+/**
+ * Start an HTTP server answering "GET /metrics" with the dump of all the stats
+ * of the process in the OpenMetrics text format. The server runs in a thread
+ * of its own and serves one client at a time.
+ *
+ * \param[in]  listen  Address to listen to, as "host:port", "[ipv6]:port" or
+ *                     ":port" for all the interfaces
+ * \param[out] server  Started server, to stop with pho_stats_server_stop()
+ *
+ * \return 0 on success, negative error code on failure.
+ */
+int pho_stats_server_start(const char *listen, struct pho_stats_server **server);
+
+/**
+ * Stop a server started by pho_stats_server_start() and free it.
+ *
+ * \param[in] server  Server to stop, may be NULL
+ */
+void pho_stats_server_stop(struct pho_stats_server *server);
+
 #endif
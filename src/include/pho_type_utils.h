@@ -202,6 +202,21 @@ struct saj_parser;
  */
 void layout_info_free_extents(struct layout_info *layout);
 
+/** Extent info attribute holding the offset of a packed extent */
+#define PHO_EXT_PACK_OFFSET_NAME "pack.offset"
+
+/**
+ * Offset of an extent in the container it is packed in.
+ *
+ * \return the offset, or -1 if the extent is not packed.
+ */
+ssize_t extent_pack_offset(struct extent *extent);
+
+/**
+ * Record that an extent is packed at \p offset of its container.
+ */
+void extent_set_pack_offset(struct extent *extent, size_t offset);
+
 /** @} end of pho_layout_mod group */
 
 
@@ -394,6 +394,56 @@ int phobos_admin_extent_list(struct admin_handle *adm, const char *medium,
                              struct extent **extents, int *n_extents,
                              struct dss_sort *sort);
 
+/**
+ * Open an iterator over the extents matching the given filters, as
+ * phobos_admin_extent_list(), but retrieved by batches of a bounded number of
+ * extents so that huge listings do not have to fit in memory.
+ *
+ * The caller must release the iterator calling
+ * phobos_admin_extent_iter_close() before phobos_admin_fini.
+ *
+ * \param[in]    adm              Admin module handler.
+ * \param[in]    medium           Single medium filter.
+ * \param[in]    library          Single library filter.
+ * \param[in]    state            Extent's state filter.
+ * \param[in]    sort             Sort filter.
+ * \param[out]   iter             Iterator.
+ *
+ * \return                        0     on success,
+ *                               -errno on failure.
+ *
+ * This must be called with an admin_handle initialized with phobos_admin_init.
+ */
+int phobos_admin_extent_iter_open(struct admin_handle *adm,
+                                  const char *medium, const char *library,
+                                  enum extent_state state,
+                                  struct dss_sort *sort,
+                                  struct dss_iter **iter);
+
+/**
+ * Retrieve the next batch of extents of an iterator.
+ *
+ * The extents are owned by the iterator and valid until the next call to
+ * phobos_admin_extent_iter_next() or phobos_admin_extent_iter_close().
+ *
+ * \param[in,out] iter             Iterator.
+ * \param[out]    extents          Retrieved extents.
+ * \param[out]    n_extents        Number of retrieved extents, 0 once every
+ *                                extent has been retrieved.
+ *
+ * \return                        0     on success,
+ *                               -errno on failure.
+ */
+int phobos_admin_extent_iter_next(struct dss_iter *iter,
+                                  struct extent **extents, int *n_extents);
+
+/**
+ * Release an iterator opened using phobos_admin_extent_iter_open().
+ *
+ * \param[in]    iter             Iterator to release, may be NULL.
+ */
+void phobos_admin_extent_iter_close(struct dss_iter *iter);
+
 /**
  * Release dss resources.
  *
@@ -121,8 +121,8 @@ static inline const char *xfer_op2str(enum pho_xfer_op op)
  * Copy_name can be set directly, otherwise the default copy_name is used.
  * The copy_name can also be associated with a profile.
  *
- * The grouping and overwrite/no_split options must be set directly in order to
- * use them. They cannot be set by a profile.
+ * The grouping and overwrite/no_split/pack options must be set directly in
+ * order to use them. They cannot be set by a profile.
  */
 struct pho_xfer_put_params {
     enum rsc_family  family;      /**< [in] Targeted resource family. */
@@ -152,6 +152,11 @@ struct pho_xfer_put_params {
                                     *  the put command should be written without
                                     *  split (.eg on the same media).
                                     */
+    bool             pack;        /**< [in] true if all targets inside a xfer
+                                    *  of the put command should be packed in
+                                    *  one container extent per medium, which
+                                    *  implies no_split.
+                                    */
 };
 
 /**
@@ -177,6 +182,13 @@ struct pho_xfer_get_params {
                                       *  the local node, otherwise set with the
                                       *  hostname where the object can be get.
                                       */
+    size_t offset;                  /**< [in] Offset in the object of the first
+                                      *  byte to get.
+                                      */
+    size_t length;                  /**< [in] Number of bytes to get from
+                                      *  offset, 0 to get up to the end of the
+                                      *  object.
+                                      */
 };
 
 /*
@@ -312,6 +324,92 @@ void phobos_fini(void);
 int phobos_put(struct pho_xfer_desc *xfers, size_t n,
                pho_completion_cb_t cb, void *udata);
 
+/**
+ * Asynchronous store handle.
+ *
+ * It keeps many transfers in flight from a single thread, over one DSS
+ * connection and one LRS socket, without blocking until they end: transfers
+ * are submitted by phobos_put_async() and reported by phobos_async_poll() once
+ * ended.
+ *
+ * An asynchronous handle is not thread-safe, it must be used by one thread at
+ * a time.
+ */
+struct phobos_async;
+
+/**
+ * Create an asynchronous store handle, connected to the DSS and the LRS.
+ *
+ * \param[out]     async  Created handle, to release with phobos_async_fini()
+ *
+ * @return                0 on success or -errno on failure.
+ *
+ * This must be called after phobos_init.
+ */
+int phobos_async_init(struct phobos_async **async);
+
+/**
+ * Release an asynchronous store handle.
+ *
+ * The transfers still in flight are ended with -ECANCELED, and not reported.
+ *
+ * \param[in]      async  Handle to release, may be NULL
+ */
+void phobos_async_fini(struct phobos_async *async);
+
+/**
+ * File descriptor to watch for readability (with poll, select or epoll) in an
+ * event loop: it is readable whenever phobos_async_poll() has LRS responses to
+ * process or ended transfers to report.
+ *
+ * \param[in]      async  Asynchronous handle
+ *
+ * @return                The file descriptor, owned by \p async.
+ */
+int phobos_async_fd(const struct phobos_async *async);
+
+/**
+ * Number of transfers submitted to \p async and not ended yet.
+ */
+size_t phobos_async_inflight(const struct phobos_async *async);
+
+/**
+ * Submit PUT transfers without waiting for them.
+ *
+ * The Xfer descriptors are the same as phobos_put() ones. They, and their
+ * targets, are used by \p async until reported by phobos_async_poll(), each
+ * with its outcome in xd_rc.
+ *
+ * \param[in]      async  Asynchronous handle
+ * \param[in,out]  xfers  List of Xfer descriptors
+ * \param[in]      n      Number of Xfer descriptors
+ *
+ * @return                0 on success or -errno if the transfers could not be
+ *                        submitted, none of them being reported then.
+ */
+int phobos_put_async(struct phobos_async *async, struct pho_xfer_desc *xfers,
+                     size_t n);
+
+/**
+ * Make the submitted transfers progress and report the ended ones.
+ *
+ * Process every LRS response already received, after waiting up to
+ * \p timeout_ms for one if no ended transfer is waiting to be reported, then
+ * report up to \p max ended transfers.
+ *
+ * \param[in]      async       Asynchronous handle
+ * \param[in]      timeout_ms  Maximum time to wait in milliseconds, 0 to
+ *                             return immediately, -1 to wait without limit
+ * \param[out]     completed   Array of at least \p max Xfer descriptors,
+ *                             filled with the ended transfers
+ * \param[in]      max         Maximum number of transfers to report
+ *
+ * @return                     The number of reported transfers, or -errno on
+ *                             failure to communicate with the LRS.
+ */
+int phobos_async_poll(struct phobos_async *async, int timeout_ms,
+                      struct pho_xfer_desc **completed, size_t max);
+
 /**
  * Retrieve N files from the object store
  *
@@ -698,6 +796,56 @@ int phobos_store_object_list(struct pho_list_filters *filters,
  */
 void phobos_store_object_list_free(struct object_info *objs, int n_objs);
 
+/** Iterator over the objects retrieved by batches */
+struct phobos_object_iter;
+
+/**
+ * Open an iterator over the objects that match the given filters, as
+ * phobos_store_object_list(), but retrieved by batches of a bounded number of
+ * objects so that huge listings do not have to fit in memory.
+ *
+ * The caller must release the iterator calling
+ * phobos_store_object_iter_close().
+ *
+ * \param[in]       filters         The filters to use.
+ * \param[in]       scope           List only/also the deprecated objects.
+ * \param[in]       sort            The sort filters to use.
+ * \param[out]      iter            The iterator.
+ *
+ * \return                          0     on success,
+ *                                 -errno on failure.
+ *
+ * This must be called after phobos_init.
+ */
+int phobos_store_object_iter_open(struct pho_list_filters *filters,
+                                  enum dss_obj_scope scope,
+                                  struct dss_sort *sort,
+                                  struct phobos_object_iter **iter);
+
+/**
+ * Retrieve the next batch of objects of an iterator.
+ *
+ * The objects are owned by the iterator and valid until the next call to
+ * phobos_store_object_iter_next() or phobos_store_object_iter_close().
+ *
+ * \param[in,out]   iter            The iterator.
+ * \param[out]      objs            Retrieved objects.
+ * \param[out]      n_objs          Number of retrieved items, 0 once every
+ *                                  object has been retrieved.
+ *
+ * \return                          0     on success,
+ *                                 -errno on failure.
+ */
+int phobos_store_object_iter_next(struct phobos_object_iter *iter,
+                                  struct object_info **objs, int *n_objs);
+
+/**
+ * Release an iterator opened using phobos_store_object_iter_open().
+ *
+ * \param[in]       iter            The iterator to release, may be NULL.
+ */
+void phobos_store_object_iter_close(struct phobos_object_iter *iter);
+
 /**
  * Retrieve the copies that match the given oids.
  *
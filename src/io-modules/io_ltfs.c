@@ -82,6 +82,8 @@ static const struct pho_io_adapter_module_ops IO_ADAPTER_LTFS_OPS = {
     .ioa_set_md            = pho_posix_set_md,
     .ioa_get_common_xattrs_from_extent  = pho_get_common_xattrs_from_extent,
     .ioa_size              = pho_posix_size,
+    .ioa_seek              = pho_posix_seek,
+    .ioa_pwrite            = pho_posix_pwrite,
 };
 
 /** IO adapter module registration entry point */
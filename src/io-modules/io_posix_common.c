@@ -1020,3 +1020,48 @@ ssize_t pho_posix_size(struct pho_io_descr *iod)
 
     return statbuf.st_size;
 }
+
+int pho_posix_seek(struct pho_io_descr *iod, off_t offset, int whence)
+{
+    struct posix_io_ctx *io_ctx;
+
+    io_ctx = iod->iod_ctx;
+    if (!io_ctx || io_ctx->fd < 0)
+        return -EINVAL;
+
+    if (lseek(io_ctx->fd, offset, whence) < 0)
+        LOG_RETURN(-errno, "Failed to seek in '%s'", io_ctx->fpath);
+
+    return 0;
+}
+
+int pho_posix_pwrite(struct pho_io_descr *iod, const void *buf, size_t count,
+                     off_t offset)
+{
+    struct posix_io_ctx *io_ctx;
+    size_t written_size = 0;
+    int nb_null_try = 0;
+
+    io_ctx = iod->iod_ctx;
+    if (!io_ctx || io_ctx->fd < 0)
+        return -EINVAL;
+
+    /* write count bytes by taking care of partial write */
+    while (written_size < count) {
+        ssize_t nb_written_bytes;
+
+        nb_written_bytes = pwrite(io_ctx->fd, buf + written_size,
+                                  count - written_size,
+                                  offset + written_size);
+        if (nb_written_bytes < 0)
+            LOG_RETURN(-errno, "Failed to write into %s at offset %zu",
+                       io_ctx->fpath, (size_t)offset + written_size);
+
+        if (nb_written_bytes == 0 && ++nb_null_try > MAX_NULL_WRITE_TRY)
+            LOG_RETURN(-EIO, "Too many writes of zero byte");
+
+        written_size += nb_written_bytes;
+    }
+
+    return 0;
+}
@@ -66,4 +66,9 @@ int pho_get_common_xattrs_from_extent(struct pho_io_descr *iod,
 
 ssize_t pho_posix_size(struct pho_io_descr *iod);
 
+int pho_posix_seek(struct pho_io_descr *iod, off_t offset, int whence);
+
+int pho_posix_pwrite(struct pho_io_descr *iod, const void *buf, size_t count,
+                     off_t offset);
+
 #endif
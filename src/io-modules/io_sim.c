@@ -0,0 +1,228 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos I/O adapter of the simulated tapes.
+ *
+ * The extents are the POSIX files of the cartridge directories. Each extent is
+ * written at the end of data of its cartridge and keeps this position, so that
+ * the reads pay the locate from the current head position, and every byte
+ * read or written pays the streaming time of the model.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "io_posix_common.h"
+#include "ldm_sim.h"
+#include "pho_common.h"
+#include "pho_module_loader.h"
+
+#include <attr/xattr.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define PLUGIN_NAME     "sim"
+#define PLUGIN_MAJOR    0
+#define PLUGIN_MINOR    1
+
+static struct module_desc IO_ADAPTER_SIM_MODULE_DESC = {
+    .mod_name  = PLUGIN_NAME,
+    .mod_major = PLUGIN_MAJOR,
+    .mod_minor = PLUGIN_MINOR,
+};
+
+/** Locate the head on the position of an extent, at the end of data for a
+ * new one
+ */
+static int sim_locate_extent(struct pho_io_descr *iod, bool is_put)
+{
+    struct posix_io_ctx *io_ctx = iod->iod_ctx;
+    const char *root = iod->iod_loc->root_path;
+    uint64_t position;
+    char value[32];
+    ssize_t len;
+    int rc;
+
+    if (is_put) {
+        rc = ldm_sim_tape_locate(root, -1, &position);
+        if (rc)
+            return rc;
+
+        len = snprintf(value, sizeof(value), "%" PRIu64, position);
+        if (fsetxattr(io_ctx->fd, SIM_POSITION_XATTR, value, len, 0))
+            LOG_RETURN(-errno, "Cannot set the position of '%s'",
+                       io_ctx->fpath);
+
+        return 0;
+    }
+
+    len = fgetxattr(io_ctx->fd, SIM_POSITION_XATTR, value, sizeof(value) - 1);
+    if (len < 0) {
+        pho_debug("No position for '%s', reading it without locate",
+                  io_ctx->fpath);
+        return 0;
+    }
+    value[len] = '\0';
+
+    return ldm_sim_tape_locate(root, strtoll(value, NULL, 10), NULL);
+}
+
+static int sim_open(const char *extent_desc, struct pho_io_descr *iod,
+                    bool is_put)
+{
+    int rc;
+
+    ENTRY;
+
+    rc = pho_posix_open(extent_desc, iod, is_put);
+    /* no context is kept for the metadata only operations */
+    if (rc || !iod->iod_ctx)
+        return rc;
+
+    rc = sim_locate_extent(iod, is_put);
+    if (rc)
+        pho_posix_close(iod);
+
+    return rc;
+}
+
+static int sim_get(const char *extent_desc, struct pho_io_descr *iod)
+{
+    bool already_opened = (iod->iod_ctx != NULL);
+    int rc2;
+    int rc;
+
+    ENTRY;
+
+    if (!already_opened) {
+        rc = sim_open(extent_desc, iod, false);
+        if (rc || !iod->iod_ctx)
+            return rc;
+    }
+
+    rc = pho_posix_get(extent_desc, iod);
+    if (!rc)
+        rc = ldm_sim_tape_stream(iod->iod_loc->root_path, iod->iod_size,
+                                 false);
+
+    if (!already_opened) {
+        rc2 = pho_posix_close(iod);
+        if (rc2 && !rc)
+            rc = rc2;
+    }
+
+    return rc;
+}
+
+static int sim_write(struct pho_io_descr *iod, const void *buf, size_t count)
+{
+    int rc;
+
+    rc = pho_posix_write(iod, buf, count);
+    if (rc)
+        return rc;
+
+    return ldm_sim_tape_stream(iod->iod_loc->root_path, count, true);
+}
+
+static ssize_t sim_read(struct pho_io_descr *iod, void *buf, size_t count)
+{
+    ssize_t rc;
+    int rc2;
+
+    rc = pho_posix_read(iod, buf, count);
+    if (rc <= 0)
+        return rc;
+
+    rc2 = ldm_sim_tape_stream(iod->iod_loc->root_path, rc, false);
+
+    return rc2 ? : rc;
+}
+
+static int sim_pwrite(struct pho_io_descr *iod, const void *buf, size_t count,
+                      off_t offset)
+{
+    int rc;
+
+    rc = pho_posix_pwrite(iod, buf, count, offset);
+    if (rc)
+        return rc;
+
+    return ldm_sim_tape_stream(iod->iod_loc->root_path, count, true);
+}
+
+static int sim_medium_sync(const char *root_path, json_t **message)
+{
+    int rc = 0;
+    int fd;
+
+    ENTRY;
+
+    if (message)
+        *message = NULL;
+
+    fd = open(root_path, O_RDONLY);
+    if (fd == -1)
+        return -errno;
+
+    if (syncfs(fd))
+        rc = -errno;
+
+    if (close(fd) && !rc)
+        return -errno;
+
+    return rc;
+}
+
+/** Simulated tape adapter */
+static const struct pho_io_adapter_module_ops IO_ADAPTER_SIM_OPS = {
+    .ioa_get               = sim_get,
+    .ioa_del               = pho_posix_del,
+    .ioa_open              = sim_open,
+    .ioa_write             = sim_write,
+    .ioa_read              = sim_read,
+    .ioa_close             = pho_posix_close,
+    .ioa_medium_sync       = sim_medium_sync,
+    .ioa_preferred_io_size = pho_posix_preferred_io_size,
+    .ioa_set_md            = pho_posix_set_md,
+    .ioa_get_common_xattrs_from_extent  = pho_get_common_xattrs_from_extent,
+    .ioa_size              = pho_posix_size,
+    .ioa_seek              = pho_posix_seek,
+    .ioa_pwrite            = sim_pwrite,
+};
+
+/** IO adapter module registration entry point */
+int pho_module_register(void *module, void *context)
+{
+    struct io_adapter_module *self = (struct io_adapter_module *) module;
+
+    phobos_module_context_set(context);
+
+    self->desc = IO_ADAPTER_SIM_MODULE_DESC;
+    self->ops = &IO_ADAPTER_SIM_OPS;
+
+    return 0;
+}
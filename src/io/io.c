@@ -24,15 +24,19 @@
 #include "config.h"
 #endif
 
+#include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "pho_cfg.h"
 #include "pho_common.h"
 #include "pho_io.h"
 #include "pho_module_loader.h"
+#include "pho_type_utils.h"
 
 #define IO_BLOCK_SIZE_ATTR_KEY "io_block_size"
 #define FS_BLOCK_SIZE_ATTR_KEY "fs_block_size"
+#define PIPELINE_BUFFERS_ATTR_KEY "pipeline_buffers"
 
 /**
  * List of configuration parameters for this module
@@ -41,10 +45,11 @@ enum pho_cfg_params_io {
     /* Actual parameters */
     PHO_CFG_IO_io_block_size,
     PHO_CFG_IO_fs_block_size,
+    PHO_CFG_IO_pipeline_buffers,
 
     /* Delimiters, update when modifying options */
     PHO_CFG_IO_FIRST = PHO_CFG_IO_io_block_size,
-    PHO_CFG_IO_LAST  = PHO_CFG_IO_fs_block_size,
+    PHO_CFG_IO_LAST  = PHO_CFG_IO_pipeline_buffers,
 };
 
 const struct pho_config_item cfg_io[] = {
@@ -58,6 +63,11 @@ const struct pho_config_item cfg_io[] = {
         .name    = FS_BLOCK_SIZE_ATTR_KEY,
         .value   = "dir=1024,tape=524288,rados_pool=1024"
     },
+    [PHO_CFG_IO_pipeline_buffers] = {
+        .section = "io",
+        .name    = PIPELINE_BUFFERS_ATTR_KEY,
+        .value   = "0" /** default value = no pipeline */
+    },
 };
 
 int get_cfg_io_block_size(size_t *size, enum rsc_family family)
@@ -113,6 +123,22 @@ int get_cfg_fs_block_size(enum rsc_family family, size_t *size)
     return rc;
 }
 
+int get_cfg_io_pipeline_buffers(size_t *n_buffers)
+{
+    int value;
+
+    value = PHO_CFG_GET_INT(cfg_io, PHO_CFG_IO, pipeline_buffers, -1);
+    if (value < 0) {
+        *n_buffers = 0;
+        LOG_RETURN(-EINVAL, "Invalid value for parameter '%s'",
+                   PIPELINE_BUFFERS_ATTR_KEY);
+    }
+
+    *n_buffers = value;
+
+    return 0;
+}
+
 void update_io_size(struct pho_io_descr *iod, size_t *io_size)
 {
     if (*io_size != 0)
@@ -156,8 +182,9 @@ int get_io_adapter(enum fs_type fstype, struct io_adapter_module **ioa)
                          (void **)ioa);
         break;
     case PHO_FS_LTFS:
-        rc = load_module("io_adapter_ltfs", sizeof(**ioa), phobos_context(),
-                         (void **)ioa);
+        rc = load_module(cfg_tape_backend_is_sim() ? "io_adapter_sim" :
+                                                     "io_adapter_ltfs",
+                         sizeof(**ioa), phobos_context(), (void **)ioa);
         break;
     case PHO_FS_RADOS:
         rc = load_module("io_adapter_rados", sizeof(**ioa), phobos_context(),
@@ -339,3 +366,87 @@ int set_object_md(const struct io_adapter_module *ioa, struct pho_io_descr *iod,
 
     return rc;
 }
+
+int iod_skip(const struct io_adapter_module *ioa, struct pho_io_descr *iod,
+             size_t count)
+{
+    char buffer[4096];
+    int rc;
+
+    if (count == 0)
+        return 0;
+
+    rc = ioa_seek(ioa, iod, count, SEEK_CUR);
+    if (rc != -ENOTSUP)
+        return rc;
+
+    while (count > 0) {
+        size_t to_read = min(count, sizeof(buffer));
+        ssize_t nb_read_bytes;
+
+        nb_read_bytes = ioa_read(ioa, iod, buffer, to_read);
+        if (nb_read_bytes < 0)
+            LOG_RETURN(nb_read_bytes, "Unable to skip %zu bytes", count);
+        if (nb_read_bytes == 0)
+            LOG_RETURN(-EIO, "Unexpected end of extent, %zu bytes to skip",
+                       count);
+
+        count -= nb_read_bytes;
+    }
+
+    return 0;
+}
+
+/* {"extent":"<uuid>","offset":<n>,"size":<n>}, with 64-bit integers */
+#define PACK_INDEX_ENTRY_MAX_SIZE \
+    (sizeof("{\"extent\":\"\",\"offset\":,\"size\":},") - 1 + \
+     UUID_LEN - 1 + 2 * 20)
+
+size_t pack_index_max_size(size_t n_objects)
+{
+    return sizeof("{\"objects\":[]}") - 1 +
+        n_objects * PACK_INDEX_ENTRY_MAX_SIZE + PHO_PACK_FOOTER_SIZE;
+}
+
+void pack_index_add(json_t **index, struct extent *extent)
+{
+    json_t *objects;
+
+    if (!*index)
+        *index = json_pack("{s:[]}", "objects");
+
+    objects = json_object_get(*index, "objects");
+    json_array_append_new(objects,
+                          json_pack("{s:s, s:I, s:I}",
+                                    "extent", extent->uuid,
+                                    "offset",
+                                    (json_int_t)extent_pack_offset(extent),
+                                    "size", (json_int_t)extent->size));
+}
+
+ssize_t pack_index_write(const struct io_adapter_module *ioa,
+                         struct pho_io_descr *iod, json_t *index)
+{
+    char footer[PHO_PACK_FOOTER_SIZE + 1];
+    size_t index_size;
+    char *dump;
+    int rc;
+
+    dump = json_dumps(index, JSON_COMPACT);
+    if (!dump)
+        LOG_RETURN(-ENOMEM, "Unable to dump the index of a container");
+
+    index_size = strlen(dump);
+    snprintf(footer, sizeof(footer), "%s%016zx", PHO_PACK_MAGIC, index_size);
+
+    rc = ioa_write(ioa, iod, dump, index_size);
+    free(dump);
+    if (rc)
+        LOG_RETURN(rc, "Unable to write the index of a container");
+
+    rc = ioa_write(ioa, iod, footer, PHO_PACK_FOOTER_SIZE);
+    if (rc)
+        LOG_RETURN(rc, "Unable to write the footer of a container");
+
+    return index_size + PHO_PACK_FOOTER_SIZE;
+}
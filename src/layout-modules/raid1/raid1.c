@@ -190,18 +190,24 @@ static int common_write_from_buff(struct pho_data_processor *proc,
 
     ENTRY;
 
+    /* the replicas hold the same data: write them concurrently, one thread
+     * each, and hash the buffer once for all of them
+     */
     for (i = 0; i < n_extents; ++i) {
-        rc = data_processor_write_from_buff(proc, &iods[i], to_write, 0);
+        struct extent_hash *hash = i == 0 ? &io_context->hashes[0] : NULL;
+
+        if (n_extents > 1)
+            rc = raid_queue_chunk(proc, i, &iods[i], buff_start, to_write,
+                                  hash);
+        else
+            rc = raid_write_chunk(proc, i, &iods[i], buff_start, to_write,
+                                  hash);
         if (rc)
             LOG_RETURN(rc,
                        "RAID1 write: unable to write %zu bytes in replica %d "
                        "at offset %zu", to_write, i, proc->writer_offset);
 
         iods[i].iod_size += to_write;
-
-        rc = extent_hash_update(&io_context->hashes[i], buff_start, to_write);
-        if (rc)
-            return rc;
     }
 
     proc->writer_offset += to_write;
@@ -393,7 +399,8 @@ static int layout_raid1_encode(struct pho_data_processor *encoder)
         if (encoder->xfer->xd_targets[i].xt_size == 0)
             io_context->write.all_is_written = true;
 
-        io_context->nb_hashes = repl_count;
+        io_context->nb_hashes = 1;
+        io_context->shared_hash = true;
         io_context->hashes = xcalloc(io_context->nb_hashes,
                                      sizeof(*io_context->hashes));
 
@@ -549,11 +556,11 @@ static int layout_raid1_rebuild(struct pho_data_processor *rebuilder)
     io_context->rebuild.missing_extents_remaining =
         raid_get_nb_extent_to_rebuild(rebuilder);
 
-    /* Here, we allocate the maximum possible number of hashes to avoid having
-     * to reallocate between each split with a different number of extents to
-     * reconstruct.
+    /* All the rebuilt replicas of a split hold the same data and share one
+     * hash.
      */
-    io_context->nb_hashes = repl_count;
+    io_context->nb_hashes = 1;
+    io_context->shared_hash = true;
     io_context->hashes = xcalloc(io_context->nb_hashes,
                                  sizeof(*io_context->hashes));
     for (int i = 0; i < io_context->nb_hashes; i++) {
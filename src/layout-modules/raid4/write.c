@@ -27,6 +27,8 @@
 #endif
 
 #include "raid4.h"
+#include "data_pipeline.h"
+#include "raid_xor.h"
 
 #include <unistd.h>
 
@@ -102,8 +104,8 @@ int raid4_write_from_buff(struct pho_data_processor *proc)
                                 io_context->current_split_chunk_size);
 
         /* write the data extent 0 */
-        rc = data_processor_write_from_buff(proc, &iods[0], to_write_extent_0,
-                                            0);
+        rc = raid_write_chunk(proc, 0, &iods[0], buff_start, to_write_extent_0,
+                              &io_context->hashes[0]);
         if (rc)
             LOG_RETURN(rc,
                        "raid4 unable to write %zu bytes in data extent 0 at "
@@ -111,10 +113,6 @@ int raid4_write_from_buff(struct pho_data_processor *proc)
 
         iods[0].iod_size += to_write_extent_0;
         proc->writer_offset += to_write_extent_0;
-        rc = extent_hash_update(&io_context->hashes[0], buff_start,
-                                to_write_extent_0);
-        if (rc)
-            return rc;
 
         to_write -= to_write_extent_0;
 
@@ -126,8 +124,8 @@ int raid4_write_from_buff(struct pho_data_processor *proc)
                                 io_context->current_split_chunk_size);
 
         /* write the data extent 1 */
-        rc = data_processor_write_from_buff(proc, &iods[1], to_write_extent_1,
-                                            0);
+        rc = raid_write_chunk(proc, 1, &iods[1], buff_start + to_write_extent_0,
+                              to_write_extent_1, &io_context->hashes[1]);
         if (rc)
             LOG_RETURN(rc,
                        "raid4 unable to write %zu bytes in data extent 0 at "
@@ -138,14 +136,14 @@ int raid4_write_from_buff(struct pho_data_processor *proc)
         if (proc->writer_offset >= proc->object_size)
             io_context->write.all_is_written = true;
 
-        rc = extent_hash_update(&io_context->hashes[1],
-                                buff_start + to_write_extent_0,
-                                to_write_extent_1);
-        if (rc)
-            return rc;
-
         to_write -= to_write_extent_1;
 
+        /* the parity is computed in place of the data extent 1 */
+        rc = data_pipeline_wait(proc);
+        if (rc)
+            LOG_RETURN(rc, "raid4 unable to write data extents at offset %zu",
+                       proc->writer_offset);
+
         /*
          * fill parity bytes in buffer
          *
@@ -159,30 +157,23 @@ int raid4_write_from_buff(struct pho_data_processor *proc)
             memset(buff_start + to_write_extent_0 + to_write_extent_1, 0,
                    to_write_extent_0 - to_write_extent_1);
 
-        /* compute in place the parity extent */
-        xor_in_place(buff_start, buff_start + to_write_extent_0,
-                     to_write_extent_0);
-
-        /* write the parity extent */
-        rc = data_processor_write_from_buff(
-            proc, &iods[2], to_write_extent_0,
-            /* The XOR is computed inplace at buff_start + to_write_extent_0.
-             * Since we wrote to_write_extent_0 + to_write_extent_1 bytes,
-             * we need to move back to_write_extent_1 bytes to find the XOR.
-             */
-            -to_write_extent_1
-        );
+        /* compute in place the parity extent and its hash in one pass */
+        rc = raid_xor_in_place_hash(buff_start, buff_start + to_write_extent_0,
+                                    to_write_extent_0, &io_context->hashes[2]);
+        if (rc)
+            return rc;
+
+        /* write the parity extent, computed in place at
+         * buff_start + to_write_extent_0
+         */
+        rc = raid_write_chunk(proc, 2, &iods[2], buff_start + to_write_extent_0,
+                              to_write_extent_0, NULL);
         if (rc)
             LOG_RETURN(rc,
                        "raid4 unable to write %zu bytes in parity extent at "
                        "offset %zu", to_write_extent_0, proc->writer_offset);
 
         iods[2].iod_size += to_write_extent_0;
-        rc = extent_hash_update(&io_context->hashes[2],
-                                buff_start + to_write_extent_0,
-                                to_write_extent_0);
-        if (rc)
-            return rc;
     }
 
     if (proc->writer_offset == proc->reader_offset)
@@ -27,20 +27,15 @@
 #endif
 
 #include "raid4.h"
+#include "raid_xor.h"
 
 void buffer_xor(struct pho_buff *buff1, struct pho_buff *buff2,
                 struct pho_buff *xor, size_t count)
 {
-    size_t i;
-
-    for (i = 0; i < count; i++)
-        xor->buff[i] = buff1->buff[i] ^ buff2->buff[i];
+    raid_xor(buff1->buff, buff2->buff, xor->buff, count);
 }
 
 void xor_in_place(const char *data_buff, char *parity_buff, size_t count)
 {
-    size_t i;
-
-    for (i = 0; i < count; i++)
-        parity_buff[i] = parity_buff[i] ^ data_buff[i];
+    raid_xor_in_place(data_buff, parity_buff, count);
 }
@@ -0,0 +1,749 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos k+m erasure coding (Reed-Solomon) Layout plugin
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "raid_ec.h"
+
+#include "pho_attrs.h"
+#include "pho_cfg.h"
+#include "pho_io.h"
+#include "pho_module_loader.h"
+
+#include <errno.h>
+#include <glib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PLUGIN_NAME     "raid_ec"
+#define PLUGIN_MAJOR    0
+#define PLUGIN_MINOR    1
+
+static struct module_desc RAID_EC_MODULE_DESC = {
+    .mod_name  = PLUGIN_NAME,
+    .mod_major = PLUGIN_MAJOR,
+    .mod_minor = PLUGIN_MINOR,
+};
+
+/**
+ * List of configuration parameters for this module
+ */
+enum pho_cfg_params_raid_ec {
+    /* Actual parameters */
+    PHO_CFG_LYT_RAID_EC_k,
+    PHO_CFG_LYT_RAID_EC_m,
+    PHO_CFG_LYT_RAID_EC_extent_xxh128,
+    PHO_CFG_LYT_RAID_EC_extent_md5,
+    PHO_CFG_LYT_RAID_EC_check_hash,
+
+    /* Delimiters, update when modifying options */
+    PHO_CFG_LYT_RAID_EC_FIRST = PHO_CFG_LYT_RAID_EC_k,
+    PHO_CFG_LYT_RAID_EC_LAST  = PHO_CFG_LYT_RAID_EC_check_hash,
+};
+
+const struct pho_config_item raid_ec_cfg_items[] = {
+    [PHO_CFG_LYT_RAID_EC_k] = {
+        .section = "layout_raid_ec",
+        .name    = RAID_EC_K_ATTR_KEY,
+        .value   = "8",  /* Number of data extents per split (default) */
+    },
+    [PHO_CFG_LYT_RAID_EC_m] = {
+        .section = "layout_raid_ec",
+        .name    = RAID_EC_M_ATTR_KEY,
+        .value   = "2",  /* Number of parity extents per split (default) */
+    },
+    [PHO_CFG_LYT_RAID_EC_extent_xxh128] = {
+        .section = "layout_raid_ec",
+        .name    = "extent_xxh128",
+        .value   = DEFAULT_XXH128,
+    },
+    [PHO_CFG_LYT_RAID_EC_extent_md5] = {
+        .section = "layout_raid_ec",
+        .name    = "extent_md5",
+        .value   = DEFAULT_MD5,
+    },
+    [PHO_CFG_LYT_RAID_EC_check_hash] = {
+        .section = "layout_raid_ec",
+        .name    = "check_hash",
+        .value   = DEFAULT_CHECK_HASH,
+    },
+};
+
+void raid_ec_stripe_init(struct raid_io_context *io_context, size_t split_size,
+                         size_t split_offset, struct raid_ec_stripe *stripe)
+{
+    size_t stripe_size = io_context->current_split_chunk_size *
+                         io_context->n_data_extents;
+    size_t full_stripes_size = split_size - split_size % stripe_size;
+
+    if (split_offset < full_stripes_size) {
+        stripe->size = stripe_size;
+        stripe->base = io_context->current_split_chunk_size;
+        stripe->remainder = 0;
+        return;
+    }
+
+    /* last and shorter stripe of the split */
+    stripe->size = split_size - full_stripes_size;
+    stripe->base = stripe->size / io_context->n_data_extents;
+    stripe->remainder = stripe->size % io_context->n_data_extents;
+}
+
+void raid_ec_buffers_init(struct raid_io_context *io_context, size_t tbl_size)
+{
+    io_context->nb_buffers = io_context->n_parity_extents + 1;
+    io_context->buffers = xcalloc(io_context->nb_buffers,
+                                  sizeof(*io_context->buffers));
+    pho_buff_alloc(&io_context->buffers[io_context->n_parity_extents],
+                   tbl_size);
+}
+
+void raid_ec_parity_buffers_reserve(struct raid_io_context *io_context,
+                                    size_t chunk_size)
+{
+    size_t i;
+
+    for (i = 0; i < io_context->n_parity_extents; i++)
+        if (io_context->buffers[i].size < chunk_size)
+            pho_buff_realloc(&io_context->buffers[i], chunk_size);
+}
+
+static void raid_ec_set_xfer_rc(struct pho_data_processor *proc, int rc)
+{
+    if (proc->xfer->xd_rc == 0)
+        proc->xfer->xd_rc = rc;
+
+    proc->xfer->xd_targets[proc->current_target].xt_rc = rc;
+}
+
+int raid_ec_read_chunk(struct pho_data_processor *proc,
+                       struct pho_io_descr *iod, char *buff, size_t size)
+{
+    ssize_t read_size;
+    int rc;
+
+    read_size = ioa_read(iod->iod_ioa, iod, buff, size);
+    if (read_size < 0)
+        LOG_GOTO(out_err, rc = read_size,
+                 "raid_ec: reading %zu bytes fails at offset %zu", size,
+                 proc->reader_offset);
+
+    iod->iod_size += read_size;
+
+    if (read_size < size)
+        LOG_GOTO(out_err, rc = -EIO,
+                 "raid_ec: expected %zu bytes to read and get only %zd bytes, "
+                 "at offset %zu", size, read_size, proc->reader_offset);
+
+    return 0;
+
+out_err:
+    raid_ec_set_xfer_rc(proc, rc);
+
+    return rc;
+}
+
+static int parse_geometry_value(const char *str, const char *name,
+                                size_t *value)
+{
+    int64_t tmp;
+
+    if (!str)
+        LOG_RETURN(-EINVAL, "raid_ec: '%s' is not set", name);
+
+    tmp = str2int64(str);
+    if (tmp <= 0 || tmp >= RAID_GF_MAX_EXTENTS)
+        LOG_RETURN(-EINVAL,
+                   "raid_ec: invalid value '%s' for '%s', expected a positive "
+                   "integer lower than %d", str, name, RAID_GF_MAX_EXTENTS);
+
+    *value = tmp;
+
+    return 0;
+}
+
+static int check_geometry(size_t k, size_t m)
+{
+    if (k + m > RAID_GF_MAX_EXTENTS)
+        LOG_RETURN(-EINVAL,
+                   "raid_ec: k + m = %zu exceeds the maximum of %d extents",
+                   k + m, RAID_GF_MAX_EXTENTS);
+
+    return 0;
+}
+
+/** Get k and m from the attributes of an existing layout */
+static int raid_ec_layout_geometry(struct pho_attrs *attrs, size_t *k,
+                                   size_t *m)
+{
+    int rc;
+
+    rc = parse_geometry_value(pho_attr_get(attrs, PHO_EA_RAID_EC_K_NAME),
+                              PHO_EA_RAID_EC_K_NAME, k);
+    if (rc)
+        return rc;
+
+    rc = parse_geometry_value(pho_attr_get(attrs, PHO_EA_RAID_EC_M_NAME),
+                              PHO_EA_RAID_EC_M_NAME, m);
+    if (rc)
+        return rc;
+
+    return check_geometry(*k, *m);
+}
+
+/**
+ * Get k and m from the layout parameters of the put, or from the
+ * configuration, and save them in the destination layouts.
+ */
+static int raid_ec_encoder_geometry(struct pho_data_processor *enc, size_t *k,
+                                    size_t *m)
+{
+    struct pho_xfer_put_params *put_params;
+    const char *string_k;
+    const char *string_m;
+    int rc;
+    int i;
+
+    if (enc->xfer->xd_op == PHO_XFER_OP_COPY)
+        put_params = &enc->xfer->xd_params.copy.put;
+    else
+        put_params = &enc->xfer->xd_params.put;
+
+    string_k = pho_attr_get(&put_params->lyt_params, RAID_EC_K_ATTR_KEY);
+    if (!string_k)
+        string_k = PHO_CFG_GET(raid_ec_cfg_items, PHO_CFG_LYT_RAID_EC, k);
+
+    string_m = pho_attr_get(&put_params->lyt_params, RAID_EC_M_ATTR_KEY);
+    if (!string_m)
+        string_m = PHO_CFG_GET(raid_ec_cfg_items, PHO_CFG_LYT_RAID_EC, m);
+
+    rc = parse_geometry_value(string_k, RAID_EC_K_ATTR_KEY, k);
+    if (rc)
+        return rc;
+
+    rc = parse_geometry_value(string_m, RAID_EC_M_ATTR_KEY, m);
+    if (rc)
+        return rc;
+
+    rc = check_geometry(*k, *m);
+    if (rc)
+        return rc;
+
+    for (i = 0; i < enc->xfer->xd_ntargets; i++) {
+        pho_attr_set(&enc->dest_layout[i].layout_desc.mod_attrs,
+                     PHO_EA_RAID_EC_K_NAME, string_k);
+        pho_attr_set(&enc->dest_layout[i].layout_desc.mod_attrs,
+                     PHO_EA_RAID_EC_M_NAME, string_m);
+    }
+
+    return 0;
+}
+
+static int raid_ec_extent_chunk_size(struct extent *extent, size_t *chunk_size)
+{
+    const char *attr;
+    int64_t value;
+
+    attr = pho_attr_get(&extent->info, PHO_EA_RAID_EC_CHUNK_SIZE_NAME);
+    if (!attr)
+        LOG_RETURN(-EINVAL, "'%s' attribute not found on extent '%s'",
+                   PHO_EA_RAID_EC_CHUNK_SIZE_NAME, extent->uuid);
+
+    value = str2int64(attr);
+    if (value <= 0)
+        LOG_RETURN(-EINVAL,
+                   "Invalid chunk size '%s' found in '%s' on extent '%s'. "
+                   "Expected a positive integer",
+                   attr, PHO_EA_RAID_EC_CHUNK_SIZE_NAME, extent->uuid);
+
+    *chunk_size = value;
+
+    return 0;
+}
+
+static int raid_ec_get_reader_chunk_size(struct pho_data_processor *proc,
+                                         size_t *chunk_size)
+{
+    return raid_ec_extent_chunk_size(&proc->src_layout->extents[0],
+                                     chunk_size);
+}
+
+/** Load the tables of the whole coding matrix in the layout buffers */
+static int raid_ec_load_coding_tables(struct raid_io_context *io_context)
+{
+    size_t n_coefs = io_context->n_data_extents *
+                     io_context->n_parity_extents;
+    uint8_t *matrix;
+    int rc;
+
+    raid_ec_buffers_init(io_context, n_coefs * RAID_GF_TBL_SIZE);
+
+    matrix = xmalloc(n_coefs);
+    rc = raid_gf_gen_cauchy(io_context->n_data_extents,
+                            io_context->n_parity_extents, matrix);
+    if (!rc)
+        raid_gf_build_tables(n_coefs, matrix, raid_ec_tables(io_context));
+
+    free(matrix);
+
+    return rc;
+}
+
+static struct raid_ops RAID_EC_OPS = {
+    .get_reader_chunk_size = raid_ec_get_reader_chunk_size,
+    .read_into_buff = raid_ec_read_into_buff,
+    .write_from_buff = raid_ec_write_from_buff,
+    .rebuild_from_buff = raid_ec_rebuild_from_buff,
+    .set_extra_attrs = raid_ec_extra_attrs,
+};
+
+static const struct pho_proc_ops RAID_EC_WRITER_PROCESSOR_OPS = {
+    .step       = raid_writer_processor_step,
+    .destroy    = raid_writer_rebuilder_processor_destroy,
+};
+
+static const struct pho_proc_ops RAID_EC_READER_PROCESSOR_OPS = {
+    .step       = raid_reader_processor_step,
+    .destroy    = raid_reader_processor_destroy,
+};
+
+static const struct pho_proc_ops RAID_EC_ERASER_PROCESSOR_OPS = {
+    .step       = raid_eraser_processor_step,
+    .destroy    = raid_eraser_processor_destroy,
+};
+
+static const struct pho_proc_ops RAID_EC_REBUILDER_PROCESSOR_OPS = {
+    .step       = raid_rebuilder_processor_step,
+    .destroy    = raid_writer_rebuilder_processor_destroy,
+};
+
+static int raid_ec_init_write_hashes(struct raid_io_context *io_context)
+{
+    size_t i;
+    int rc;
+
+    io_context->nb_hashes = n_total_extents(io_context);
+    io_context->hashes = xcalloc(io_context->nb_hashes,
+                                 sizeof(*io_context->hashes));
+
+    for (i = 0; i < io_context->nb_hashes; i++) {
+        rc = extent_hash_init(&io_context->hashes[i],
+                              PHO_CFG_GET_BOOL(raid_ec_cfg_items,
+                                               PHO_CFG_LYT_RAID_EC,
+                                               extent_md5, false),
+                              PHO_CFG_GET_BOOL(raid_ec_cfg_items,
+                                               PHO_CFG_LYT_RAID_EC,
+                                               extent_xxh128, false));
+        if (rc)
+            return rc;
+    }
+
+    return 0;
+}
+
+static int layout_raid_ec_encode(struct pho_data_processor *encoder)
+{
+    struct raid_io_context *io_contexts;
+    struct raid_io_context *io_context;
+    size_t k, m;
+    int rc;
+    int i;
+
+    ENTRY;
+
+    rc = raid_ec_encoder_geometry(encoder, &k, &m);
+    if (rc)
+        return rc;
+
+    io_contexts = xcalloc(encoder->xfer->xd_ntargets, sizeof(*io_contexts));
+    encoder->private_writer = io_contexts;
+
+    for (i = 0; i < encoder->xfer->xd_ntargets; i++) {
+        io_context = &io_contexts[i];
+        io_context->name = PLUGIN_NAME;
+        io_context->n_data_extents = k;
+        io_context->n_parity_extents = m;
+        io_context->write.to_write = encoder->xfer->xd_targets[i].xt_size;
+        if (encoder->xfer->xd_targets[i].xt_size == 0)
+            io_context->write.all_is_written = true;
+
+        rc = raid_ec_load_coding_tables(io_context);
+        if (rc)
+            goto out;
+
+        rc = raid_ec_init_write_hashes(io_context);
+        if (rc)
+            goto out;
+    }
+
+    return raid_encoder_init(encoder, &RAID_EC_MODULE_DESC,
+                             &RAID_EC_WRITER_PROCESSOR_OPS, &RAID_EC_OPS);
+
+out:
+    /* The rest will be free'd by layout_destroy */
+    return rc;
+}
+
+static int layout_raid_ec_decode(struct pho_data_processor *decoder)
+{
+    struct raid_io_context *io_context;
+    size_t k, m;
+    int rc;
+
+    ENTRY;
+
+    rc = raid_ec_layout_geometry(&decoder->src_layout->layout_desc.mod_attrs,
+                                 &k, &m);
+    if (rc)
+        LOG_RETURN(rc, "Invalid geometry from layout to build raid_ec decoder");
+
+    io_context = xcalloc(1, sizeof(*io_context));
+    decoder->private_reader = io_context;
+    io_context->name = PLUGIN_NAME;
+    io_context->n_data_extents = k;
+    io_context->n_parity_extents = m;
+
+    io_context->read.check_hash = PHO_CFG_GET_BOOL(raid_ec_cfg_items,
+                                                   PHO_CFG_LYT_RAID_EC,
+                                                   check_hash, true);
+
+    if (io_context->read.check_hash) {
+        io_context->nb_hashes = io_context->n_data_extents;
+        io_context->hashes = xcalloc(io_context->nb_hashes,
+                                     sizeof(*io_context->hashes));
+    }
+
+    /* the decoding tables depend on the extents available for each split */
+    raid_ec_buffers_init(io_context, k * k * RAID_GF_TBL_SIZE);
+
+    rc = raid_decoder_init(decoder, &RAID_EC_MODULE_DESC,
+                           &RAID_EC_READER_PROCESSOR_OPS, &RAID_EC_OPS);
+    if (rc)
+        return rc;
+
+    io_context->read.to_read = decoder->object_size;
+
+    /* Empty GET does not need any IO */
+    if (decoder->object_size == 0)
+        decoder->done = true;
+
+    return 0;
+}
+
+static int layout_raid_ec_erase(struct pho_data_processor *eraser)
+{
+    struct raid_io_context *io_context;
+    size_t k, m;
+    int rc;
+
+    rc = raid_ec_layout_geometry(&eraser->src_layout->layout_desc.mod_attrs,
+                                 &k, &m);
+    if (rc)
+        LOG_RETURN(rc, "Invalid geometry from layout to build raid_ec eraser");
+
+    io_context = xcalloc(1, sizeof(*io_context));
+    eraser->private_eraser = io_context;
+    io_context->name = PLUGIN_NAME;
+    io_context->n_data_extents = k;
+    io_context->n_parity_extents = m;
+
+    rc = raid_eraser_init(eraser, &RAID_EC_MODULE_DESC,
+                          &RAID_EC_ERASER_PROCESSOR_OPS, &RAID_EC_OPS);
+    if (rc) {
+        eraser->private_eraser = NULL;
+        free(io_context);
+        return rc;
+    }
+
+    io_context->delete.to_delete = 0;
+    /* No hard removal on tapes */
+    if (eraser->src_layout->ext_count != 0 &&
+        eraser->src_layout->extents[0].media.family != PHO_RSC_TAPE)
+        io_context->delete.to_delete = eraser->src_layout->ext_count;
+
+    if (io_context->delete.to_delete == 0)
+        eraser->done = true;
+
+    return 0;
+}
+
+static size_t raid_ec_nb_extent_to_rebuild(struct layout_info *layout,
+                                           size_t n_extents_per_split)
+{
+    size_t last_layout_idx = layout->extents[layout->ext_count - 1].layout_idx;
+    size_t nb_split = last_layout_idx / n_extents_per_split + 1;
+
+    return nb_split * n_extents_per_split - layout->ext_count;
+}
+
+static int layout_raid_ec_rebuild(struct pho_data_processor *rebuilder)
+{
+    struct raid_io_context *io_context;
+    size_t k, m;
+    int rc;
+
+    rc = raid_ec_layout_geometry(&rebuilder->src_layout->layout_desc.mod_attrs,
+                                 &k, &m);
+    if (rc)
+        return rc;
+
+    io_context = xcalloc(1, sizeof(*io_context));
+    rebuilder->private_writer = io_context;
+    io_context->name = PLUGIN_NAME;
+    io_context->n_data_extents = k;
+    io_context->n_parity_extents = m;
+    io_context->rebuild.missing_extents_remaining =
+        raid_ec_nb_extent_to_rebuild(rebuilder->src_layout, k + m);
+
+    /* The rebuilt extents must keep the stripe geometry of the existing
+     * ones, instead of the one preferred by the new media.
+     */
+    rc = raid_ec_extent_chunk_size(&rebuilder->src_layout->extents[0],
+                                   &io_context->current_split_chunk_size);
+    if (rc)
+        goto out;
+
+    rc = raid_ec_load_coding_tables(io_context);
+    if (rc)
+        goto out;
+
+    /* Here, we allocate the maximum possible number of hashes to avoid having
+     * to reallocate between each split with a different number of extents to
+     * reconstruct.
+     */
+    rc = raid_ec_init_write_hashes(io_context);
+    if (rc)
+        goto out;
+
+    return raid_rebuilder_init(rebuilder, &RAID_EC_MODULE_DESC,
+                               &RAID_EC_REBUILDER_PROCESSOR_OPS,
+                               &RAID_EC_OPS);
+
+out:
+    /* The rest will be free'd by layout_destroy */
+    return rc;
+}
+
+static int layout_raid_ec_locate(struct dss_handle *dss,
+                                 struct layout_info *layout,
+                                 const char *focus_host,
+                                 char **hostname,
+                                 int *nb_new_lock)
+{
+    size_t k, m;
+    int rc;
+
+    rc = raid_ec_layout_geometry(&layout->layout_desc.mod_attrs, &k, &m);
+    if (rc)
+        LOG_RETURN(rc, "Invalid geometry from layout to locate");
+
+    return raid_locate(dss, layout, k, m, focus_host, hostname, nb_new_lock);
+}
+
+/** Expected size of the extent \p split_idx of a split of \p split_size bytes */
+static size_t raid_ec_extent_size(size_t k, size_t split_size,
+                                  size_t split_idx)
+{
+    size_t remainder = split_size % k;
+    size_t size = split_size / k;
+
+    if (split_idx < k)
+        return size + (split_idx < remainder ? 1 : 0);
+
+    return size + (remainder > 0 ? 1 : 0);
+}
+
+static int layout_raid_ec_get_availability(struct layout_info layout,
+                                           struct copy_info *copy)
+{
+    bool complete = true;
+    bool readable = true;
+    size_t split_offset = 0;
+    size_t n_extents_per_split;
+    size_t last_split;
+    int object_size;
+    size_t split;
+    size_t k, m;
+    int first;
+    int rc;
+    int i;
+
+    rc = raid_ec_layout_geometry(&layout.layout_desc.mod_attrs, &k, &m);
+    if (rc)
+        LOG_RETURN(rc, "Failed to get geometry of object '%s'", layout.oid);
+
+    object_size = get_object_size_from_layout(&layout);
+    if (object_size < 0)
+        LOG_RETURN(-EINVAL,
+                   "Invalid object size for reconstruction of object '%s': '%d'",
+                   layout.oid, object_size);
+
+    if (layout.ext_count == 0) {
+        copy->copy_status = object_size == 0 ? PHO_COPY_STATUS_COMPLETE :
+                                               PHO_COPY_STATUS_INCOMPLETE;
+        return 0;
+    }
+
+    n_extents_per_split = k + m;
+    last_split = layout.extents[layout.ext_count - 1].layout_idx /
+                 n_extents_per_split;
+
+    /*
+     * The extents are sorted by layout index. A split is complete when all its
+     * k + m extents are there and readable with at least k of them. The size
+     * of each split is deduced from the offset of the next one and checked
+     * against the size of its extents.
+     */
+    for (split = 0, first = 0; split <= last_split; split++) {
+        size_t split_size;
+        size_t count = 0;
+        int next;
+
+        for (next = first;
+             next < layout.ext_count &&
+                 layout.extents[next].layout_idx / n_extents_per_split == split;
+             next++)
+            count++;
+
+        if (count == 0 || layout.extents[first].offset != split_offset) {
+            readable = false;
+            break;
+        }
+
+        if (next < layout.ext_count)
+            split_size = layout.extents[next].offset - split_offset;
+        else
+            split_size = object_size - split_offset;
+
+        for (i = first; i < next; i++)
+            if (layout.extents[i].size !=
+                raid_ec_extent_size(k, split_size,
+                                    layout.extents[i].layout_idx %
+                                        n_extents_per_split))
+                readable = false;
+
+        if (count < n_extents_per_split)
+            complete = false;
+
+        if (count < k)
+            readable = false;
+
+        split_offset += split_size;
+        first = next;
+    }
+
+    if (readable && complete)
+        copy->copy_status = PHO_COPY_STATUS_COMPLETE;
+    else if (readable)
+        copy->copy_status = PHO_COPY_STATUS_READABLE;
+    else
+        copy->copy_status = PHO_COPY_STATUS_INCOMPLETE;
+
+    return 0;
+}
+
+static int layout_raid_ec_get_specific_attrs(struct pho_io_descr *iod,
+                                             struct io_adapter_module *ioa,
+                                             struct extent *extent,
+                                             struct pho_attrs *layout_md)
+{
+    const char *tmp_extent_index;
+    const char *tmp_chunk_size;
+    struct pho_attrs md;
+    size_t k, m;
+    int rc;
+
+    md.attr_set = NULL;
+    pho_attr_set(&md, PHO_EA_RAID_EC_EXTENT_INDEX_NAME, NULL);
+    pho_attr_set(&md, PHO_EA_RAID_EC_CHUNK_SIZE_NAME, NULL);
+    pho_attr_set(&md, PHO_EA_RAID_EC_K_NAME, NULL);
+    pho_attr_set(&md, PHO_EA_RAID_EC_M_NAME, NULL);
+
+    iod->iod_attrs = md;
+    iod->iod_flags = PHO_IO_MD_ONLY;
+
+    rc = ioa_open(ioa, NULL, iod, false);
+    if (rc)
+        goto end;
+
+    rc = raid_ec_layout_geometry(&md, &k, &m);
+    if (rc)
+        LOG_GOTO(end, rc, "Failed to retrieve geometry of file '%s'",
+                 iod->iod_loc->extent->address.buff);
+
+    tmp_chunk_size = pho_attr_get(&md, PHO_EA_RAID_EC_CHUNK_SIZE_NAME);
+    if (tmp_chunk_size == NULL)
+        LOG_GOTO(end, rc = -EINVAL,
+                 "Failed to retrieve chunk size of file '%s'",
+                 iod->iod_loc->extent->address.buff);
+
+    tmp_extent_index = pho_attr_get(&md, PHO_EA_RAID_EC_EXTENT_INDEX_NAME);
+    if (tmp_extent_index == NULL)
+        LOG_GOTO(end, rc = -EINVAL,
+                 "Failed to retrieve extent index of file '%s'",
+                 iod->iod_loc->extent->address.buff);
+
+    extent->layout_idx = str2int64(tmp_extent_index);
+    if (extent->layout_idx < 0)
+        LOG_GOTO(end, rc = -EINVAL,
+                 "Invalid extent index found on '%s': '%d'",
+                 iod->iod_loc->extent->address.buff, extent->layout_idx);
+
+    pho_attr_set(&extent->info, PHO_EA_RAID_EC_CHUNK_SIZE_NAME,
+                 tmp_chunk_size);
+    pho_attr_set(layout_md, PHO_EA_RAID_EC_K_NAME,
+                 pho_attr_get(&md, PHO_EA_RAID_EC_K_NAME));
+    pho_attr_set(layout_md, PHO_EA_RAID_EC_M_NAME,
+                 pho_attr_get(&md, PHO_EA_RAID_EC_M_NAME));
+
+end:
+    pho_attrs_free(&md);
+
+    return rc;
+}
+
+static const struct pho_layout_module_ops LAYOUT_RAID_EC_OPS = {
+    .encode = layout_raid_ec_encode,
+    .decode = layout_raid_ec_decode,
+    .erase = layout_raid_ec_erase,
+    .rebuild = layout_raid_ec_rebuild,
+    .locate = layout_raid_ec_locate,
+    .get_specific_attrs = layout_raid_ec_get_specific_attrs,
+    .get_availability = layout_raid_ec_get_availability,
+};
+
+/** Layout module registration entry point */
+int pho_module_register(void *module, void *context)
+{
+    struct layout_module *self = (struct layout_module *) module;
+
+    phobos_module_context_set(context);
+
+    self->desc = RAID_EC_MODULE_DESC;
+    self->ops = &LAYOUT_RAID_EC_OPS;
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos k+m erasure coding (Reed-Solomon) Layout plugin
+ *
+ * Each split of an object is cut in k data extents and m parity extents. The
+ * data is spread over the data extents chunk by chunk: a stripe is made of one
+ * chunk of each data extent and one chunk of each parity extent. The last
+ * stripe of a split spreads its remaining bytes evenly on the data extents, so
+ * that their sizes follow raid_io_context_set_extent_size().
+ *
+ * Any k extents of a split are enough to read it back.
+ */
+#ifndef _PHO_RAID_EC_H
+#define _PHO_RAID_EC_H
+
+#include <stdint.h>
+
+#include "pho_common.h"
+#include "pho_types.h" /* struct layout_info */
+#include "raid_common.h"
+#include "raid_gf.h"
+
+/**
+ * Extended attributes' names for the raid_ec layout
+ */
+#define PHO_EA_RAID_EC_K_NAME             "raid_ec.k"
+#define PHO_EA_RAID_EC_M_NAME             "raid_ec.m"
+#define PHO_EA_RAID_EC_CHUNK_SIZE_NAME    "raid_ec.chunk_size"
+#define PHO_EA_RAID_EC_EXTENT_INDEX_NAME  "raid_ec.extent_index"
+
+/** Layout parameters given by the profile or the command line */
+#define RAID_EC_K_ATTR_KEY "k"
+#define RAID_EC_M_ATTR_KEY "m"
+
+/**
+ * Geometry of one stripe of a split.
+ *
+ * The data chunk j of the stripe is (base + (j < remainder ? 1 : 0)) bytes
+ * long. Every parity chunk is as long as the first data chunk.
+ */
+struct raid_ec_stripe {
+    size_t size;        /**< Object bytes held by the stripe */
+    size_t base;        /**< Length of the shortest data chunk */
+    size_t remainder;   /**< Number of data chunks one byte longer */
+};
+
+static inline size_t raid_ec_chunk_len(const struct raid_ec_stripe *stripe,
+                                       size_t idx)
+{
+    return stripe->base + (idx < stripe->remainder ? 1 : 0);
+}
+
+static inline size_t raid_ec_chunk_offset(const struct raid_ec_stripe *stripe,
+                                          size_t idx)
+{
+    return idx * stripe->base + min(idx, stripe->remainder);
+}
+
+/**
+ * Compute the geometry of the stripe starting at \p split_offset bytes of a
+ * split holding \p split_size bytes.
+ */
+void raid_ec_stripe_init(struct raid_io_context *io_context, size_t split_size,
+                         size_t split_offset, struct raid_ec_stripe *stripe);
+
+/**
+ * Allocate the layout buffers: one scratch chunk per parity extent, followed
+ * by \p tbl_size bytes of multiplication tables.
+ */
+void raid_ec_buffers_init(struct raid_io_context *io_context, size_t tbl_size);
+
+/** Make sure each parity scratch buffer can hold \p chunk_size bytes */
+void raid_ec_parity_buffers_reserve(struct raid_io_context *io_context,
+                                    size_t chunk_size);
+
+/** Multiplication tables kept after the parity scratch buffers */
+static inline uint8_t *raid_ec_tables(struct raid_io_context *io_context)
+{
+    return (uint8_t *)io_context->buffers[io_context->n_parity_extents].buff;
+}
+
+/**
+ * Read \p size bytes of \p iod into \p buff, which may be outside of the
+ * data processor buffer. A short read is an error.
+ */
+int raid_ec_read_chunk(struct pho_data_processor *proc,
+                       struct pho_io_descr *iod, char *buff, size_t size);
+
+int raid_ec_read_into_buff(struct pho_data_processor *proc);
+int raid_ec_write_from_buff(struct pho_data_processor *proc);
+int raid_ec_rebuild_from_buff(struct pho_data_processor *proc);
+int raid_ec_extra_attrs(struct pho_data_processor *proc);
+
+#endif
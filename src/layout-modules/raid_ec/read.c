@@ -0,0 +1,171 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos k+m erasure coding (Reed-Solomon) Layout plugin
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "raid_ec.h"
+
+#include <errno.h>
+#include <string.h>
+
+/**
+ * Build the tables reconstructing the data chunks from the k extents read for
+ * the current split.
+ */
+static int load_decoding_tables(struct raid_io_context *io_context,
+                                const size_t *rows)
+{
+    size_t k = io_context->n_data_extents;
+    uint8_t *decode;
+    int rc;
+
+    decode = xmalloc(k * k);
+
+    rc = raid_gf_decode_matrix(k, io_context->n_parity_extents, rows, decode);
+    if (rc)
+        LOG_GOTO(out, rc, "Unable to invert raid_ec decoding matrix");
+
+    raid_gf_build_tables(k * k, decode, raid_ec_tables(io_context));
+
+out:
+    free(decode);
+
+    return rc;
+}
+
+int raid_ec_read_into_buff(struct pho_data_processor *proc)
+{
+    struct raid_io_context *io_context =
+        (struct raid_io_context *)proc->private_reader;
+    size_t n_extents_per_split = n_total_extents(io_context);
+    size_t buffer_offset = proc->reader_offset - proc->buffer_offset;
+    size_t inside_split_offset = proc->reader_offset -
+                                 io_context->current_split_offset;
+    size_t n_data = io_context->n_data_extents;
+    struct pho_io_descr *iods = io_context->iods;
+    char *buff_start = proc->buff.buff + buffer_offset;
+    size_t avail_len[RAID_GF_MAX_EXTENTS];
+    const char *avail[RAID_GF_MAX_EXTENTS];
+    size_t rows[RAID_GF_MAX_EXTENTS];
+    bool degraded;
+    size_t to_read;
+    size_t i;
+    int rc;
+
+    /*
+     * The extents are sorted by layout index: the data extents come first and
+     * one of them is missing if the last extent read is a parity one.
+     */
+    for (i = 0; i < n_data; i++)
+        rows[i] = io_context->read.extents[i]->layout_idx % n_extents_per_split;
+
+    degraded = rows[n_data - 1] >= n_data;
+    if (degraded && inside_split_offset == io_context->read.split_start) {
+        rc = load_decoding_tables(io_context, rows);
+        if (rc)
+            return rc;
+    }
+
+    raid_ec_parity_buffers_reserve(io_context,
+                                   io_context->current_split_chunk_size);
+
+    /* limit : object -> split -> buffer */
+    to_read = min(proc->object_size - proc->reader_offset,
+                  io_context->current_split_size - inside_split_offset);
+    to_read = min(to_read, proc->buff.size - buffer_offset);
+
+    while (to_read) {
+        struct raid_ec_stripe stripe;
+        size_t n_parity_read = 0;
+
+        raid_ec_stripe_init(io_context, io_context->current_split_size,
+                            inside_split_offset, &stripe);
+        if (stripe.size > to_read)
+            LOG_RETURN(-EINVAL,
+                       "raid_ec buffer of %zu bytes too small to hold a "
+                       "stripe of %zu bytes", to_read, stripe.size);
+
+        /* read the available chunks of the stripe */
+        for (i = 0; i < n_data; i++) {
+            char *chunk;
+            size_t len;
+
+            if (rows[i] < n_data) {
+                chunk = buff_start + raid_ec_chunk_offset(&stripe, rows[i]);
+                len = raid_ec_chunk_len(&stripe, rows[i]);
+            } else {
+                chunk = io_context->buffers[n_parity_read++].buff;
+                len = raid_ec_chunk_len(&stripe, 0);
+            }
+
+            avail[i] = chunk;
+            avail_len[i] = len;
+            if (len == 0)
+                continue;
+
+            rc = raid_ec_read_chunk(proc, &iods[i], chunk, len);
+            if (rc)
+                return rc;
+
+            if (io_context->read.check_hash) {
+                rc = extent_hash_update(&io_context->hashes[i], chunk, len);
+                if (rc)
+                    return rc;
+            }
+        }
+
+        /* rebuild the missing data chunks in place */
+        if (degraded) {
+            size_t j;
+
+            for (j = 0; j < n_data; j++) {
+                char *dst = buff_start + raid_ec_chunk_offset(&stripe, j);
+                size_t len = raid_ec_chunk_len(&stripe, j);
+                const uint8_t *row;
+                size_t a;
+
+                /* the available data chunks are already in place */
+                for (a = 0; a < n_data && rows[a] != j; a++)
+                    ;
+                if (a < n_data || len == 0)
+                    continue;
+
+                row = raid_ec_tables(io_context) + j * n_data * RAID_GF_TBL_SIZE;
+                memset(dst, 0, len);
+                for (a = 0; a < n_data; a++)
+                    raid_gf_mul_add(row + a * RAID_GF_TBL_SIZE, avail[a], dst,
+                                    min(len, avail_len[a]));
+            }
+        }
+
+        buff_start += stripe.size;
+        inside_split_offset += stripe.size;
+        proc->reader_offset += stripe.size;
+        to_read -= stripe.size;
+    }
+
+    return 0;
+}
@@ -0,0 +1,284 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos k+m erasure coding (Reed-Solomon) Layout plugin
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "raid_ec.h"
+
+#include "data_pipeline.h"
+#include "pho_attrs.h"
+
+#include <errno.h>
+#include <stdio.h>
+
+static int set_extent_extra_attrs(struct raid_io_context *io_context,
+                                  struct extent *extent,
+                                  struct pho_io_descr *iod)
+{
+    char buff[64];
+    int rc;
+
+    rc = sprintf(buff, "%zu", io_context->current_split_chunk_size);
+    if (rc < 0)
+        LOG_RETURN(rc = -errno, "Unable to convert chunk size to string");
+
+    pho_attr_set(&extent->info, PHO_EA_RAID_EC_CHUNK_SIZE_NAME, buff);
+    pho_attr_set(&iod->iod_attrs, PHO_EA_RAID_EC_CHUNK_SIZE_NAME, buff);
+
+    rc = sprintf(buff, "%d", extent->layout_idx);
+    if (rc < 0)
+        LOG_RETURN(rc = -errno, "Unable to convert extent index to string");
+
+    pho_attr_set(&iod->iod_attrs, PHO_EA_RAID_EC_EXTENT_INDEX_NAME, buff);
+
+    rc = sprintf(buff, "%zu", io_context->n_data_extents);
+    if (rc < 0)
+        LOG_RETURN(rc = -errno, "Unable to convert k to string");
+
+    pho_attr_set(&iod->iod_attrs, PHO_EA_RAID_EC_K_NAME, buff);
+
+    rc = sprintf(buff, "%zu", io_context->n_parity_extents);
+    if (rc < 0)
+        LOG_RETURN(rc = -errno, "Unable to convert m to string");
+
+    pho_attr_set(&iod->iod_attrs, PHO_EA_RAID_EC_M_NAME, buff);
+
+    return 0;
+}
+
+int raid_ec_extra_attrs(struct pho_data_processor *proc)
+{
+    struct raid_io_context *io_context =
+        &((struct raid_io_context *)proc->private_writer)[proc->current_target];
+    struct output_io_context *output;
+    size_t n_extents;
+    int rc = 0;
+    size_t i;
+    int rc2;
+
+    output = raid_output_io_context(io_context, proc->type);
+    n_extents = get_n_extents(io_context, proc->type);
+
+    for (i = 0; i < n_extents; i++) {
+        rc2 = set_extent_extra_attrs(io_context, &output->extents[i],
+                                     &io_context->iods[i]);
+        rc = rc ? : rc2;
+    }
+
+    return rc;
+}
+
+/**
+ * Return the next stripe to process from the data processor buffer, or false
+ * if the current split is done.
+ */
+static bool next_stripe(struct pho_data_processor *proc,
+                        struct raid_io_context *io_context,
+                        struct raid_ec_stripe *stripe)
+{
+    size_t inside_split_offset = proc->writer_offset -
+                                 io_context->current_split_offset;
+
+    if (inside_split_offset >= io_context->current_split_size)
+        return false;
+
+    raid_ec_stripe_init(io_context, io_context->current_split_size,
+                        inside_split_offset, stripe);
+
+    /*
+     * The buffer size is a multiple of the stripe size and the reader fills it
+     * entirely, so a stripe is either fully available or not at all.
+     */
+    return proc->reader_offset - proc->writer_offset >= stripe->size;
+}
+
+static void set_stripe_data(struct raid_io_context *io_context,
+                            const struct raid_ec_stripe *stripe,
+                            char *buff_start, const char **data,
+                            size_t *data_len)
+{
+    size_t j;
+
+    for (j = 0; j < io_context->n_data_extents; j++) {
+        data[j] = buff_start + raid_ec_chunk_offset(stripe, j);
+        data_len[j] = raid_ec_chunk_len(stripe, j);
+    }
+}
+
+int raid_ec_write_from_buff(struct pho_data_processor *proc)
+{
+    struct raid_io_context *io_context =
+        &((struct raid_io_context *)proc->private_writer)[proc->current_target];
+    size_t n_parity = io_context->n_parity_extents;
+    size_t n_data = io_context->n_data_extents;
+    struct pho_io_descr *iods = io_context->iods;
+    size_t data_len[RAID_GF_MAX_EXTENTS];
+    const char *data[RAID_GF_MAX_EXTENTS];
+    char *parity[RAID_GF_MAX_EXTENTS];
+    struct raid_ec_stripe stripe;
+    size_t i;
+    int rc;
+
+    raid_ec_parity_buffers_reserve(io_context,
+                                   io_context->current_split_chunk_size);
+    for (i = 0; i < n_parity; i++)
+        parity[i] = io_context->buffers[i].buff;
+
+    /* write stripe by stripe */
+    while (next_stripe(proc, io_context, &stripe)) {
+        char *buff_start = proc->buff.buff +
+                           (proc->writer_offset - proc->buffer_offset);
+        size_t parity_len = raid_ec_chunk_len(&stripe, 0);
+
+        /* the parity of the previous stripe may still be being written */
+        rc = data_pipeline_wait(proc);
+        if (rc)
+            LOG_RETURN(rc, "raid_ec unable to write stripe at offset %zu",
+                       proc->writer_offset);
+
+        set_stripe_data(io_context, &stripe, buff_start, data, data_len);
+
+        /* write the data extents */
+        for (i = 0; i < n_data; i++) {
+            if (data_len[i] == 0)
+                continue;
+
+            rc = raid_write_chunk(proc, i, &iods[i], data[i], data_len[i],
+                                  &io_context->hashes[i]);
+            if (rc)
+                LOG_RETURN(rc,
+                           "raid_ec unable to write %zu bytes in data extent "
+                           "%zu at offset %zu", data_len[i], i,
+                           proc->writer_offset);
+
+            iods[i].iod_size += data_len[i];
+        }
+
+        /* compute and write the parity extents */
+        raid_gf_encode(n_data, n_parity, raid_ec_tables(io_context), data,
+                       data_len, parity, parity_len);
+
+        for (i = 0; i < n_parity; i++) {
+            rc = raid_write_chunk(proc, n_data + i, &iods[n_data + i],
+                                  parity[i], parity_len,
+                                  &io_context->hashes[n_data + i]);
+            if (rc)
+                LOG_RETURN(rc,
+                           "raid_ec unable to write %zu bytes in parity "
+                           "extent %zu at offset %zu", parity_len, i,
+                           proc->writer_offset);
+
+            iods[n_data + i].iod_size += parity_len;
+        }
+
+        proc->writer_offset += stripe.size;
+    }
+
+    if (proc->writer_offset >= proc->object_size)
+        io_context->write.all_is_written = true;
+
+    if (proc->writer_offset == proc->reader_offset)
+        proc->buffer_offset = proc->writer_offset;
+
+    return 0;
+}
+
+int raid_ec_rebuild_from_buff(struct pho_data_processor *proc)
+{
+    struct raid_io_context *io_context = proc->private_writer;
+    size_t n_extents_per_split = n_total_extents(io_context);
+    struct extent *extents = io_context->rebuild.output.extents;
+    size_t n_data = io_context->n_data_extents;
+    struct pho_io_descr *iods = io_context->iods;
+    size_t data_len[RAID_GF_MAX_EXTENTS];
+    const char *data[RAID_GF_MAX_EXTENTS];
+    struct raid_ec_stripe stripe;
+    size_t n_parity;
+    size_t i;
+    int rc;
+
+    raid_ec_parity_buffers_reserve(io_context,
+                                   io_context->current_split_chunk_size);
+
+    /* The buffer holds the object data decoded by the reader: write the
+     * missing data chunks as is and compute the missing parity ones.
+     */
+    while (next_stripe(proc, io_context, &stripe)) {
+        char *buff_start = proc->buff.buff +
+                           (proc->writer_offset - proc->buffer_offset);
+        size_t parity_len = raid_ec_chunk_len(&stripe, 0);
+
+        set_stripe_data(io_context, &stripe, buff_start, data, data_len);
+
+        /* the parity of the previous stripe may still be being written */
+        rc = data_pipeline_wait(proc);
+        if (rc)
+            LOG_RETURN(rc, "raid_ec unable to rebuild stripe at offset %zu",
+                       proc->writer_offset);
+
+        for (i = 0, n_parity = 0;
+             i < io_context->rebuild.current_split_missing_count;
+             i++) {
+            size_t idx = extents[i].layout_idx % n_extents_per_split;
+            const char *chunk;
+            size_t len;
+
+            if (idx < n_data) {
+                chunk = data[idx];
+                len = data_len[idx];
+                if (len == 0)
+                    continue;
+            } else {
+                const uint8_t *row = raid_ec_tables(io_context) +
+                                     (idx - n_data) * n_data * RAID_GF_TBL_SIZE;
+                /* one scratch buffer per missing parity extent */
+                char *parity = io_context->buffers[n_parity++].buff;
+
+                raid_gf_encode(n_data, 1, row, data, data_len, &parity,
+                               parity_len);
+                chunk = parity;
+                len = parity_len;
+            }
+
+            rc = raid_write_chunk(proc, i, &iods[i], chunk, len,
+                                  &io_context->hashes[i]);
+            if (rc)
+                LOG_RETURN(rc,
+                           "raid_ec unable to write %zu bytes in rebuilt "
+                           "extent %d at offset %zu", len,
+                           extents[i].layout_idx, proc->writer_offset);
+
+            iods[i].iod_size += len;
+        }
+
+        proc->writer_offset += stripe.size;
+    }
+
+    if (proc->writer_offset == proc->reader_offset)
+        proc->buffer_offset = proc->writer_offset;
+
+    return 0;
+}
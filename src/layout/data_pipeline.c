@@ -0,0 +1,530 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Pipelined data path of the data processors
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "data_pipeline.h"
+
+#include "pho_common.h"
+
+#include <errno.h>
+#include <glib.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** A write or hash update queued on a worker */
+struct pipeline_job {
+    struct pho_io_descr *iod;       /**< NULL for a hash update */
+    const char *buff;
+    size_t size;
+    struct extent_hash *hash;
+    data_pipeline_hash_fn hash_fn;
+};
+
+/** A thread processing its queued jobs in order */
+struct pipeline_worker {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    /** Signaled when a job is queued or done, and on stop */
+    pthread_cond_t cond;
+    GQueue *jobs;
+    /** Number of queued or running jobs */
+    size_t pending;
+    /** First error since the last wait, the next jobs are dropped */
+    int rc;
+    bool stop;
+};
+
+/** Read-ahead of the source of one target in rotating buffers */
+struct pipeline_ring {
+    pthread_t thread;
+    bool started;
+    pthread_mutex_t mutex;
+    /** Signaled when a buffer is filled or released, and on stop */
+    pthread_cond_t cond;
+    struct pho_io_descr *iod;
+    int target;
+    struct pho_buff *slots;
+    /** Number of bytes read in each buffer */
+    size_t *filled;
+    size_t n_slots;
+    /** First filled buffer */
+    size_t head;
+    /** Number of filled buffers */
+    size_t count;
+    /** Number of bytes of the head buffer already given to the processor */
+    size_t consumed;
+    /** Number of source bytes not read yet by the thread */
+    size_t to_read;
+    int rc;
+    bool stop;
+};
+
+struct data_pipeline {
+    struct pipeline_ring ring;
+    struct pipeline_worker *hasher;
+    /** One writer per lane, started on the first write of the lane */
+    struct pipeline_worker **writers;
+    size_t n_writers;
+};
+
+static void *pipeline_worker_thread(void *arg)
+{
+    struct pipeline_worker *worker = arg;
+
+    pthread_mutex_lock(&worker->mutex);
+    while (true) {
+        struct pipeline_job *job;
+        int rc = 0;
+
+        while (g_queue_is_empty(worker->jobs) && !worker->stop)
+            pthread_cond_wait(&worker->cond, &worker->mutex);
+
+        job = g_queue_pop_head(worker->jobs);
+        if (!job)
+            break;
+
+        if (!worker->rc) {
+            pthread_mutex_unlock(&worker->mutex);
+
+            if (job->iod)
+                rc = ioa_write(job->iod->iod_ioa, job->iod, job->buff,
+                               job->size);
+            else
+                rc = job->hash_fn(job->hash, (char *)job->buff, job->size);
+
+            pthread_mutex_lock(&worker->mutex);
+            if (rc) {
+                pho_error(rc, "pipelined %s of %zu bytes failed",
+                          job->iod ? "write" : "hash update", job->size);
+                worker->rc = rc;
+            }
+        }
+
+        free(job);
+        worker->pending--;
+        pthread_cond_broadcast(&worker->cond);
+    }
+    pthread_mutex_unlock(&worker->mutex);
+
+    return NULL;
+}
+
+static struct pipeline_worker *pipeline_worker_start(void)
+{
+    struct pipeline_worker *worker = xcalloc(1, sizeof(*worker));
+    int rc;
+
+    pthread_mutex_init(&worker->mutex, NULL);
+    pthread_cond_init(&worker->cond, NULL);
+    worker->jobs = g_queue_new();
+
+    rc = pthread_create(&worker->thread, NULL, pipeline_worker_thread, worker);
+    if (rc) {
+        pho_error(-rc, "Unable to start a data pipeline thread");
+        g_queue_free(worker->jobs);
+        pthread_cond_destroy(&worker->cond);
+        pthread_mutex_destroy(&worker->mutex);
+        free(worker);
+        return NULL;
+    }
+
+    return worker;
+}
+
+static void pipeline_worker_push(struct pipeline_worker *worker,
+                                 struct pipeline_job *job)
+{
+    pthread_mutex_lock(&worker->mutex);
+    g_queue_push_tail(worker->jobs, job);
+    worker->pending++;
+    pthread_cond_broadcast(&worker->cond);
+    pthread_mutex_unlock(&worker->mutex);
+}
+
+static int pipeline_worker_rc(struct pipeline_worker *worker)
+{
+    int rc;
+
+    pthread_mutex_lock(&worker->mutex);
+    rc = worker->rc;
+    pthread_mutex_unlock(&worker->mutex);
+
+    return rc;
+}
+
+static int pipeline_worker_wait(struct pipeline_worker *worker)
+{
+    int rc;
+
+    pthread_mutex_lock(&worker->mutex);
+    while (worker->pending)
+        pthread_cond_wait(&worker->cond, &worker->mutex);
+
+    rc = worker->rc;
+    worker->rc = 0;
+    pthread_mutex_unlock(&worker->mutex);
+
+    return rc;
+}
+
+static void pipeline_worker_stop(struct pipeline_worker *worker)
+{
+    if (!worker)
+        return;
+
+    pthread_mutex_lock(&worker->mutex);
+    worker->stop = true;
+    pthread_cond_broadcast(&worker->cond);
+    pthread_mutex_unlock(&worker->mutex);
+
+    pthread_join(worker->thread, NULL);
+
+    g_queue_free(worker->jobs);
+    pthread_cond_destroy(&worker->cond);
+    pthread_mutex_destroy(&worker->mutex);
+    free(worker);
+}
+
+static void *pipeline_ring_thread(void *arg)
+{
+    struct pipeline_ring *ring = arg;
+
+    pthread_mutex_lock(&ring->mutex);
+    while (true) {
+        ssize_t read_size;
+        size_t slot;
+        size_t size;
+        char *buff;
+
+        while (ring->count == ring->n_slots && !ring->stop)
+            pthread_cond_wait(&ring->cond, &ring->mutex);
+
+        if (ring->stop || ring->to_read == 0)
+            break;
+
+        slot = (ring->head + ring->count) % ring->n_slots;
+        buff = ring->slots[slot].buff;
+        size = min(ring->to_read, ring->slots[slot].size);
+        pthread_mutex_unlock(&ring->mutex);
+
+        read_size = ioa_read(ring->iod->iod_ioa, ring->iod, buff, size);
+
+        pthread_mutex_lock(&ring->mutex);
+        if (read_size < 0 || read_size < size) {
+            ring->rc = read_size < 0 ? read_size : -EIO;
+            pho_error(ring->rc,
+                      "data pipeline reader expected %zu bytes to read and "
+                      "get %zd", size, read_size);
+            pthread_cond_broadcast(&ring->cond);
+            break;
+        }
+
+        ring->filled[slot] = size;
+        ring->to_read -= size;
+        ring->count++;
+        pthread_cond_broadcast(&ring->cond);
+    }
+    pthread_mutex_unlock(&ring->mutex);
+
+    return NULL;
+}
+
+static void pipeline_ring_stop(struct pipeline_ring *ring)
+{
+    if (!ring->started)
+        return;
+
+    pthread_mutex_lock(&ring->mutex);
+    ring->stop = true;
+    pthread_cond_broadcast(&ring->cond);
+    pthread_mutex_unlock(&ring->mutex);
+
+    pthread_join(ring->thread, NULL);
+    pthread_cond_destroy(&ring->cond);
+    pthread_mutex_destroy(&ring->mutex);
+    ring->started = false;
+}
+
+static void pipeline_ring_free(struct pipeline_ring *ring)
+{
+    size_t i;
+
+    pipeline_ring_stop(ring);
+
+    for (i = 0; i < ring->n_slots; i++)
+        pho_buff_free(&ring->slots[i]);
+
+    free(ring->slots);
+    free(ring->filled);
+    ring->slots = NULL;
+    ring->filled = NULL;
+    ring->n_slots = 0;
+}
+
+/**
+ * Start reading the source of the current target of \p proc from \p iod,
+ * in buffers as large as the data processor one.
+ */
+static int pipeline_ring_start(struct pho_data_processor *proc,
+                               struct pipeline_ring *ring,
+                               struct pho_io_descr *iod)
+{
+    size_t i;
+    int rc;
+
+    pipeline_ring_stop(ring);
+
+    if (ring->n_slots && ring->slots[0].size != proc->buff.size)
+        pipeline_ring_free(ring);
+
+    if (!ring->n_slots) {
+        ring->n_slots = proc->pipeline_buffers;
+        ring->slots = xcalloc(ring->n_slots, sizeof(*ring->slots));
+        ring->filled = xcalloc(ring->n_slots, sizeof(*ring->filled));
+        for (i = 0; i < ring->n_slots; i++)
+            pho_buff_alloc(&ring->slots[i], proc->buff.size);
+    }
+
+    ring->iod = iod;
+    ring->target = proc->current_target;
+    ring->head = 0;
+    ring->count = 0;
+    ring->consumed = 0;
+    ring->to_read = proc->object_size - proc->reader_offset;
+    ring->rc = 0;
+    ring->stop = false;
+
+    pthread_mutex_init(&ring->mutex, NULL);
+    pthread_cond_init(&ring->cond, NULL);
+
+    rc = pthread_create(&ring->thread, NULL, pipeline_ring_thread, ring);
+    if (rc) {
+        pthread_cond_destroy(&ring->cond);
+        pthread_mutex_destroy(&ring->mutex);
+        LOG_RETURN(-rc, "Unable to start the data pipeline reader");
+    }
+
+    ring->started = true;
+
+    return 0;
+}
+
+static struct data_pipeline *data_pipeline_get(struct pho_data_processor *proc)
+{
+    if (!proc->pipeline)
+        proc->pipeline = xcalloc(1, sizeof(*proc->pipeline));
+
+    return proc->pipeline;
+}
+
+static void set_xfer_rc(struct pho_data_processor *proc, int rc)
+{
+    if (proc->xfer->xd_rc == 0)
+        proc->xfer->xd_rc = rc;
+
+    proc->xfer->xd_targets[proc->current_target].xt_rc = rc;
+}
+
+int data_pipeline_read(struct pho_data_processor *proc,
+                       struct pho_io_descr *iod, size_t size)
+{
+    struct data_pipeline *pipeline = data_pipeline_get(proc);
+    struct pipeline_ring *ring = &pipeline->ring;
+    int rc = 0;
+
+    if (!ring->started || ring->target != proc->current_target) {
+        rc = pipeline_ring_start(proc, ring, iod);
+        if (rc)
+            goto out_err;
+    }
+
+    pthread_mutex_lock(&ring->mutex);
+    while (size) {
+        char *dst = proc->buff.buff +
+                    (proc->reader_offset - proc->buffer_offset);
+        struct pho_buff *slot;
+        size_t available;
+        size_t count;
+
+        while (ring->count == 0 && !ring->rc && ring->to_read)
+            pthread_cond_wait(&ring->cond, &ring->mutex);
+
+        if (ring->count == 0) {
+            /* nothing left to read ahead means the source is too short */
+            rc = ring->rc ? : -EIO;
+            break;
+        }
+
+        /* the head buffer is not touched by the reader thread until released
+         */
+        slot = &ring->slots[ring->head];
+        available = ring->filled[ring->head] - ring->consumed;
+        count = min(size, available);
+        pthread_mutex_unlock(&ring->mutex);
+
+        if (ring->consumed == 0 && count == available &&
+            dst == proc->buff.buff && slot->size == proc->buff.size) {
+            /* a whole buffer is requested: swap it instead of copying it */
+            struct pho_buff tmp = proc->buff;
+
+            proc->buff = *slot;
+            *slot = tmp;
+        } else {
+            memcpy(dst, slot->buff + ring->consumed, count);
+        }
+
+        proc->reader_offset += count;
+        iod->iod_size += count;
+        size -= count;
+
+        pthread_mutex_lock(&ring->mutex);
+        ring->consumed += count;
+        if (ring->consumed == ring->filled[ring->head]) {
+            ring->head = (ring->head + 1) % ring->n_slots;
+            ring->count--;
+            ring->consumed = 0;
+            pthread_cond_broadcast(&ring->cond);
+        }
+    }
+    pthread_mutex_unlock(&ring->mutex);
+
+    if (rc)
+        LOG_GOTO(out_err, rc,
+                 "data pipeline reader failed at offset %zu",
+                 proc->reader_offset);
+
+    return 0;
+
+out_err:
+    set_xfer_rc(proc, rc);
+
+    return rc;
+}
+
+int data_pipeline_write(struct pho_data_processor *proc, size_t lane,
+                        struct pho_io_descr *iod, const char *buff,
+                        size_t size, struct extent_hash *hash,
+                        data_pipeline_hash_fn hash_fn)
+{
+    struct data_pipeline *pipeline = data_pipeline_get(proc);
+    struct pipeline_job *job;
+    int rc;
+
+    if (lane >= pipeline->n_writers) {
+        pipeline->writers = xrealloc(pipeline->writers,
+                                     (lane + 1) * sizeof(*pipeline->writers));
+        memset(pipeline->writers + pipeline->n_writers, 0,
+               (lane + 1 - pipeline->n_writers) * sizeof(*pipeline->writers));
+        pipeline->n_writers = lane + 1;
+    }
+
+    if (!pipeline->writers[lane]) {
+        pipeline->writers[lane] = pipeline_worker_start();
+        if (!pipeline->writers[lane])
+            return -EAGAIN;
+    }
+
+    if (hash && !pipeline->hasher) {
+        pipeline->hasher = pipeline_worker_start();
+        if (!pipeline->hasher)
+            return -EAGAIN;
+    }
+
+    /* stop feeding a lane which already failed */
+    rc = pipeline_worker_rc(pipeline->writers[lane]);
+    if (rc)
+        return rc;
+
+    job = xcalloc(1, sizeof(*job));
+    job->iod = iod;
+    job->buff = buff;
+    job->size = size;
+    pipeline_worker_push(pipeline->writers[lane], job);
+
+    if (hash) {
+        job = xcalloc(1, sizeof(*job));
+        job->buff = buff;
+        job->size = size;
+        job->hash = hash;
+        job->hash_fn = hash_fn;
+        pipeline_worker_push(pipeline->hasher, job);
+    }
+
+    return 0;
+}
+
+int data_pipeline_wait(struct pho_data_processor *proc)
+{
+    struct data_pipeline *pipeline = proc->pipeline;
+    int rc = 0;
+    size_t i;
+
+    if (!pipeline)
+        return 0;
+
+    for (i = 0; i < pipeline->n_writers; i++) {
+        int rc2;
+
+        if (!pipeline->writers[i])
+            continue;
+
+        rc2 = pipeline_worker_wait(pipeline->writers[i]);
+        if (rc2)
+            pho_error(rc2, "pipelined writes of extent %zu failed", i);
+
+        rc = rc ? : rc2;
+    }
+
+    if (pipeline->hasher) {
+        int rc2 = pipeline_worker_wait(pipeline->hasher);
+
+        rc = rc ? : rc2;
+    }
+
+    return rc;
+}
+
+void data_pipeline_destroy(struct pho_data_processor *proc)
+{
+    struct data_pipeline *pipeline = proc->pipeline;
+    size_t i;
+
+    if (!pipeline)
+        return;
+
+    pipeline_ring_free(&pipeline->ring);
+
+    for (i = 0; i < pipeline->n_writers; i++)
+        pipeline_worker_stop(pipeline->writers[i]);
+
+    pipeline_worker_stop(pipeline->hasher);
+
+    free(pipeline->writers);
+    free(pipeline);
+    proc->pipeline = NULL;
+}
@@ -0,0 +1,118 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Pipelined data path of the data processors
+ *
+ * When the "pipeline_buffers" parameter of the [io] section is greater than 1,
+ * a data processor runs three kinds of threads concurrently:
+ * - a reader thread filling a ring of "pipeline_buffers" rotating buffers from
+ *   the source of an encoder, ahead of the writers;
+ * - one writer thread per extent, or "lane", writing the chunks queued by the
+ *   layout in submission order;
+ * - one hasher thread updating the extent hashes of the queued chunks.
+ *
+ * The writer and hasher threads are also used without read-ahead by the layouts
+ * writing several extents concurrently, like the raid1 replicas.
+ *
+ * The data processor buffer stays owned by the layout during one writer step:
+ * every queued chunk must be written and hashed before the step returns, which
+ * is ensured by data_pipeline_wait().
+ */
+#ifndef _PHO_DATA_PIPELINE_H
+#define _PHO_DATA_PIPELINE_H
+
+#include "pho_io.h"
+#include "pho_layout.h"
+
+struct extent_hash;
+
+/**
+ * Hash update function run by the hasher thread, extent_hash_update() for the
+ * raid layouts.
+ */
+typedef int (*data_pipeline_hash_fn)(struct extent_hash *hash, char *buffer,
+                                     size_t size);
+
+/**
+ * Whether \p proc uses the pipelined data path
+ */
+static inline bool data_pipeline_enabled(struct pho_data_processor *proc)
+{
+    return proc->pipeline_buffers > 1;
+}
+
+/**
+ * Read \p size bytes of the current target source into the data processor
+ * buffer, from the buffers filled ahead by the reader thread.
+ *
+ * The reader thread of a target is started on its first read, and reads the
+ * whole target source from \p iod, which must not be used by anyone else
+ * until the target is fully read.
+ *
+ * @param[in,out] proc  Data processor, with the pipeline enabled
+ * @param[in,out] iod   Source I/O descriptor of the current target
+ * @param[in]     size  Number of bytes to read
+ *
+ * @return 0 on success, -errno on error.
+ */
+int data_pipeline_read(struct pho_data_processor *proc,
+                       struct pho_io_descr *iod, size_t size);
+
+/**
+ * Queue the write of \p size bytes of \p buff into \p iod on the writer thread
+ * of \p lane, and the update of \p hash with the same bytes on the hasher
+ * thread.
+ *
+ * \p buff must stay untouched until the next call to data_pipeline_wait().
+ * The chunks of one lane, like the updates of one hash, are processed in
+ * submission order.
+ *
+ * @param[in,out] proc      Data processor
+ * @param[in]     lane      Writer thread index, usually the extent index
+ * @param[in,out] iod       I/O descriptor to write into
+ * @param[in]     buff      Bytes to write
+ * @param[in]     size      Number of bytes to write
+ * @param[in,out] hash      Hash to update, or NULL
+ * @param[in]     hash_fn   Hash update function, unused if \p hash is NULL
+ *
+ * @return 0 on success, -errno if a previous chunk failed.
+ */
+int data_pipeline_write(struct pho_data_processor *proc, size_t lane,
+                        struct pho_io_descr *iod, const char *buff,
+                        size_t size, struct extent_hash *hash,
+                        data_pipeline_hash_fn hash_fn);
+
+/**
+ * Wait for every queued write and hash update.
+ *
+ * @param[in,out] proc  Data processor
+ *
+ * @return 0 on success, the first error of the queued operations otherwise.
+ */
+int data_pipeline_wait(struct pho_data_processor *proc);
+
+/**
+ * Stop the pipeline threads and free the pipeline of \p proc, if any.
+ */
+void data_pipeline_destroy(struct pho_data_processor *proc);
+
+#endif
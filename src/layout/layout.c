@@ -34,6 +34,7 @@
 #include "pho_type_utils.h"
 #include "pho_io.h"
 #include "pho_module_loader.h"
+#include "data_pipeline.h"
 #include "posix_layout.h"
 
 #include <assert.h>
@@ -90,7 +91,12 @@ int data_processor_write_from_buff(struct pho_data_processor *proc,
     start = proc->buff.buff +
         (proc->writer_offset - proc->buffer_offset) +
         offset;
-    written_size = ioa_write(writer_iod->iod_ioa, writer_iod, start, size);
+    if (proc->pwrite_output)
+        written_size = ioa_pwrite(writer_iod->iod_ioa, writer_iod, start, size,
+                                  proc->output_shift + proc->writer_offset +
+                                      offset);
+    else
+        written_size = ioa_write(writer_iod->iod_ioa, writer_iod, start, size);
 
     if (written_size < 0)
         LOG_GOTO(out_err, rc = written_size,
@@ -202,12 +208,20 @@ int layout_encoder(struct pho_data_processor *encoder,
     }
 
     rc = set_posix_reader(encoder);
-    if (rc)
+    if (rc) {
         layout_destroy(encoder);
+        return rc;
+    }
 
     /* get io_block_size from conf */
     rc = get_cfg_io_block_size(&encoder->io_block_size,
                                xfer->xd_params.put.family);
+    if (rc) {
+        layout_destroy(encoder);
+        return rc;
+    }
+
+    rc = get_cfg_io_pipeline_buffers(&encoder->pipeline_buffers);
     if (rc)
         layout_destroy(encoder);
 
@@ -320,6 +334,10 @@ int layout_copier(struct pho_data_processor *copier, struct pho_xfer_desc *xfer,
         LOG_RETURN(rc, "unable to create reader part of a copier");
     }
 
+    rc = get_cfg_io_pipeline_buffers(&copier->pipeline_buffers);
+    if (rc)
+        layout_destroy(copier);
+
     return rc;
 }
 
@@ -379,6 +397,12 @@ int layout_rebuilder(struct pho_data_processor *rebuilder,
     /* get io_block_size from conf */
     rc = get_cfg_io_block_size(&rebuilder->io_block_size,
                                xfer->xd_params.copy.put.family);
+    if (rc) {
+        layout_destroy(rebuilder);
+        return rc;
+    }
+
+    rc = get_cfg_io_pipeline_buffers(&rebuilder->pipeline_buffers);
     if (rc)
         layout_destroy(rebuilder);
 
@@ -454,6 +478,9 @@ void layout_destroy(struct pho_data_processor *proc)
 {
     int i;
 
+    /* stop the threads before closing the I/O descriptors they use */
+    data_pipeline_destroy(proc);
+
     if (proc->reader_ops)
         proc->reader_ops->destroy(proc);
 
@@ -28,6 +28,7 @@
 
 #include "posix_layout.h"
 
+#include "data_pipeline.h"
 #include "pho_common.h"
 #include "pho_io.h"
 #include "pho_layout.h"
@@ -60,6 +61,9 @@ static int posix_reader_step(struct pho_data_processor *proc, pho_resp_t *resp,
     to_read = min(proc->object_size - proc->reader_offset,
                   proc->buff.size -
                       (proc->reader_offset - proc->buffer_offset));
+    if (data_pipeline_enabled(proc))
+        return data_pipeline_read(proc, posix_reader, to_read);
+
     return data_processor_read_into_buff(proc, posix_reader, to_read);
 }
 
@@ -167,6 +171,10 @@ static int posix_writer_step(struct pho_data_processor *proc, pho_resp_t *resp,
     if (proc->xfer->xd_targets[proc->current_target].xt_rc != 0)
         return proc->xfer->xd_targets[proc->current_target].xt_rc;
 
+    /* the reader of a ranged GET did not reach the first byte to get yet */
+    if (proc->reader_offset < proc->writer_offset)
+        return 0;
+
     rc = data_processor_write_from_buff(proc, posix_writer, to_write, 0);
     if (rc)
         LOG_RETURN(rc,
@@ -178,7 +186,7 @@ static int posix_writer_step(struct pho_data_processor *proc, pho_resp_t *resp,
         proc->buffer_offset = proc->writer_offset;
 
     /* Switch to next target */
-    if (proc->writer_offset == proc->object_size) {
+    if (proc->writer_offset == proc->range_end) {
         proc->current_target++;
         proc->buffer_offset = 0;
         proc->reader_offset = 0;
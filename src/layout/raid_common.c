@@ -45,6 +45,7 @@
 #include "pho_srl_common.h"
 #include "pho_type_utils.h"
 #include "pho_types.h"
+#include "data_pipeline.h"
 #include "raid_common.h"
 
 #define EXTENT_TAG_SIZE 128
@@ -113,12 +114,49 @@ static int common_rebuilder_writer_init(struct raid_io_context *io_context,
     return rc;
 }
 
+static struct raid_pack *raid_pack_alloc(size_t n_extents)
+{
+    struct raid_pack *pack = xcalloc(1, sizeof(*pack));
+
+    pack->n_extents = n_extents;
+    pack->addresses = xcalloc(n_extents, sizeof(*pack->addresses));
+    pack->offsets = xcalloc(n_extents, sizeof(*pack->offsets));
+    pack->indexes = xcalloc(n_extents, sizeof(*pack->indexes));
+
+    return pack;
+}
+
+/** Number of objects already in the open containers of \p pack */
+static size_t raid_pack_n_objects(struct raid_pack *pack)
+{
+    if (!pack->open || !pack->indexes[0])
+        return 0;
+
+    return json_array_size(json_object_get(pack->indexes[0], "objects"));
+}
+
+static void raid_pack_free(struct raid_pack *pack)
+{
+    size_t i;
+
+    for (i = 0; i < pack->n_extents; i++) {
+        free(pack->addresses[i].buff);
+        json_decref(pack->indexes[i]);
+    }
+
+    free(pack->addresses);
+    free(pack->offsets);
+    free(pack->indexes);
+    free(pack);
+}
+
 int raid_encoder_init(struct pho_data_processor *encoder,
                       const struct module_desc *module,
                       const struct pho_proc_ops *enc_ops,
                       const struct raid_ops *raid_ops)
 {
     struct raid_io_context *io_context;
+    struct raid_pack *pack = NULL;
     int rc;
     int i;
 
@@ -148,11 +186,34 @@ int raid_encoder_init(struct pho_data_processor *encoder,
                                         &encoder->xfer->xd_targets[i].xt_attrs);
         if (rc)
             return rc;
+
+        if (is_encoder(encoder) && get_put_params(encoder)->pack) {
+            if (!pack)
+                pack = raid_pack_alloc(n_total_extents(io_context));
+
+            io_context->write.pack = pack;
+        }
     }
 
     return 0;
 }
 
+/** Whether the range of a decoder starts and ends on split boundaries */
+static bool range_on_split_boundaries(struct pho_data_processor *decoder)
+{
+    struct layout_info *layout = decoder->src_layout;
+    bool start = decoder->range_offset == 0;
+    bool end = decoder->range_end == decoder->object_size;
+    int i;
+
+    for (i = 0; i < layout->ext_count; i++) {
+        start |= layout->extents[i].offset == decoder->range_offset;
+        end |= layout->extents[i].offset == decoder->range_end;
+    }
+
+    return start && end;
+}
+
 int raid_decoder_init(struct pho_data_processor *decoder,
                       const struct module_desc *module,
                       const struct pho_proc_ops *enc_ops,
@@ -174,6 +235,14 @@ int raid_decoder_init(struct pho_data_processor *decoder,
     io_context->read.extents = xcalloc(io_context->n_data_extents,
                                        sizeof(*io_context->read.extents));
 
+    decoder->split_n_media = io_context->n_data_extents;
+
+    /* the hashes cover whole extents, they cannot be checked unless the range
+     * starts and ends on split boundaries
+     */
+    if (!range_on_split_boundaries(decoder))
+        io_context->read.check_hash = false;
+
     return 0;
 }
 
@@ -244,6 +313,18 @@ static void writer_release_alloc_destroy(struct pho_data_processor *proc)
     }
 }
 
+static void raid_io_context_free_buffers(struct raid_io_context *io_context)
+{
+    size_t i;
+
+    for (i = 0; i < io_context->nb_buffers; i++)
+        pho_buff_free(&io_context->buffers[i]);
+
+    free(io_context->buffers);
+    io_context->buffers = NULL;
+    io_context->nb_buffers = 0;
+}
+
 void raid_reader_processor_destroy(struct pho_data_processor *proc)
 {
     struct raid_io_context *io_context;
@@ -263,6 +344,7 @@ void raid_reader_processor_destroy(struct pho_data_processor *proc)
             extent_hash_fini(&io_context->hashes[j]);
 
         free(io_context->hashes);
+        raid_io_context_free_buffers(io_context);
     }
 
     free(proc->private_reader);
@@ -293,6 +375,10 @@ void raid_writer_rebuilder_processor_destroy(struct pho_data_processor *proc)
     struct output_io_context *output;
     int i, j;
 
+    io_context = proc->private_writer;
+    if (io_context && is_encoder(proc) && io_context->write.pack)
+        raid_pack_free(io_context->write.pack);
+
     for (i = 0; i < proc->xfer->xd_ntargets; i++) {
         io_context = &((struct raid_io_context *) proc->private_writer)[i];
 
@@ -321,6 +407,7 @@ void raid_writer_rebuilder_processor_destroy(struct pho_data_processor *proc)
             extent_hash_fini(&io_context->hashes[j]);
 
         free(io_context->hashes);
+        raid_io_context_free_buffers(io_context);
     }
 
     write_resp_destroy(proc);
@@ -469,6 +556,14 @@ static int xfer_remain_to_write_per_medium(
         }
     }
 
+    /* the index of a container and its footer are written after its last
+     * object
+     */
+    if (is_encoder(proc) && io_context->write.pack)
+        *size += pack_index_max_size(
+                     raid_pack_n_objects(io_context->write.pack) +
+                     proc->xfer->xd_ntargets - proc->current_target);
+
     return 0;
 }
 
@@ -505,7 +600,7 @@ static void raid_writer_rebuilder_build_allocation_req(
                 xstrdup(put_params->tags.strings[j]);
     }
 
-    req->walloc->no_split = put_params->no_split;
+    req->walloc->no_split = put_params->no_split || put_params->pack;
 }
 
 /* The older a ctime is, the higher its priority. */
@@ -515,6 +610,19 @@ static inline int64_t priority_from_ctime(struct timeval copy_ctime)
             (int64_t)copy_ctime.tv_usec);
 }
 
+/**
+ * Position of an extent on its medium, for the I/O schedulers ordering reads
+ * along a medium.
+ *
+ * Media are written sequentially, so the extents are laid out in the order of
+ * their creation.
+ */
+static inline uint64_t position_from_extent(const struct extent *extent)
+{
+    return (uint64_t)extent->creation_time.tv_sec * 1000000 +
+           (uint64_t)extent->creation_time.tv_usec;
+}
+
 /** Return the extent with the corresponding layout_idx or NULL */
 static struct extent *extent_from_layout_idx(struct extent *extents,
                                              int ext_count, int layout_idx)
@@ -548,6 +656,28 @@ static size_t current_split_src_layout_n_extent(struct pho_data_processor *proc,
     return n_extent;
 }
 
+/**
+ * Move the reader of a ranged GET to the split holding the first byte to get,
+ * so that the media of the previous splits are not requested.
+ */
+static void raid_reader_seek_split(struct pho_data_processor *proc)
+{
+    struct raid_io_context *io_context = proc->private_reader;
+    size_t n_extents_per_split = n_total_extents(io_context);
+    int i;
+
+    for (i = 0; i < proc->src_layout->ext_count; i++) {
+        struct extent *extent = &proc->src_layout->extents[i];
+        int split = extent->layout_idx / n_extents_per_split;
+
+        if (extent->offset <= proc->range_offset &&
+            split > io_context->current_split) {
+            io_context->current_split = split;
+            io_context->current_split_offset = extent->offset;
+        }
+    }
+}
+
 /** Generate the next read or delete allocation request for this eraser */
 static void raid_reader_eraser_build_allocation_req(
     struct pho_data_processor *proc, pho_req_t *req, enum processor_type type)
@@ -575,6 +705,12 @@ static void raid_reader_eraser_build_allocation_req(
     req->ralloc->operation =
         is_eraser(proc) ? PHO_READ_TARGET_ALLOC_OP_DELETE :
                           PHO_READ_TARGET_ALLOC_OP_READ;
+    req->ralloc->n_positions = current_split_n_extents;
+    req->ralloc->positions = xcalloc(current_split_n_extents,
+                                     sizeof(*req->ralloc->positions));
+    req->ralloc->n_addresses = current_split_n_extents;
+    req->ralloc->addresses = xcalloc(current_split_n_extents,
+                                     sizeof(*req->ralloc->addresses));
 
     for (layout_idx = io_context->current_split * n_extents_per_split;
          layout_idx < (io_context->current_split + 1) * n_extents_per_split;
@@ -591,6 +727,10 @@ static void raid_reader_eraser_build_allocation_req(
             xstrdup(extent->media.name);
         req->ralloc->med_ids[read_alloc_med_idx]->library =
             xstrdup(extent->media.library);
+        req->ralloc->positions[read_alloc_med_idx] =
+            position_from_extent(extent);
+        req->ralloc->addresses[read_alloc_med_idx] =
+            xstrdup(extent->address.buff ? : "");
         read_alloc_med_idx++;
     }
 }
@@ -1002,8 +1142,10 @@ static int raid_reader_split_setup(struct pho_data_processor *proc,
     if (rc)
         return rc;
 
-    /* check extent size */
+    /* check extent size, a container is larger than its packed extents */
     for (i = 0; i < n_media; i++) {
+        ssize_t pack_offset = extent_pack_offset(io_context->read.extents[i]);
+        ssize_t expected = io_context->read.extents[i]->size;
         ssize_t size;
 
         size = ioa_size(io_context->iods[i].iod_ioa, &io_context->iods[i]);
@@ -1015,10 +1157,13 @@ static int raid_reader_split_setup(struct pho_data_processor *proc,
             goto close_iod;
         }
 
-        if (size != io_context->read.extents[i]->size)
+        if (pack_offset >= 0)
+            expected += pack_offset;
+
+        if (pack_offset >= 0 ? size < expected : size != expected)
             LOG_GOTO(close_iod, rc = -EINVAL,
                      "Extent size mismatch: %zd whereas we expect %zd",
-                     size, io_context->read.extents[i]->size);
+                     size, expected);
     }
 
     rc = io_context->ops->get_reader_chunk_size(
@@ -1037,6 +1182,39 @@ static int raid_reader_split_setup(struct pho_data_processor *proc,
         proc->reader_stripe_size = io_context->current_split_chunk_size *
                                    io_context->n_data_extents;
 
+    /*
+     * A ranged GET starts reading its first split at the stripe holding its
+     * first byte, the bytes before are read but not written.
+     */
+    io_context->read.split_start = 0;
+    if (proc->range_offset > io_context->current_split_offset) {
+        size_t stripe_size = io_context->current_split_chunk_size *
+                             io_context->n_data_extents;
+        size_t skip = proc->range_offset - io_context->current_split_offset;
+
+        if (io_context->n_data_extents > 1)
+            skip -= skip % stripe_size;
+
+        io_context->read.split_start = skip;
+        proc->reader_offset = io_context->current_split_offset + skip;
+        proc->buffer_offset = proc->reader_offset;
+    }
+
+    /* move to the packed extents and to the start of the range */
+    for (i = 0; i < n_media; i++) {
+        ssize_t pack_offset = extent_pack_offset(io_context->read.extents[i]);
+        size_t extent_skip = io_context->read.split_start /
+                             io_context->n_data_extents;
+        size_t skip = extent_skip + (pack_offset > 0 ? pack_offset : 0);
+
+        rc = iod_skip(io_context->iods[i].iod_ioa, &io_context->iods[i], skip);
+        if (rc)
+            LOG_GOTO(close_iod, rc, "Unable to reach offset %zu of extent '%s'",
+                     skip, io_context->read.extents[i]->uuid);
+
+        io_context->iods[i].iod_size = extent_skip;
+    }
+
     if (io_context->read.check_hash) {
         for (i = 0; i < io_context->nb_hashes; i++) {
             rc = extent_hash_init(&io_context->hashes[i],
@@ -1063,7 +1241,7 @@ static int raid_reader_split_setup(struct pho_data_processor *proc,
      */
     io_context->current_split_size = min(io_context->current_split_size,
                                          proc->object_size -
-                                             proc->reader_offset);
+                                             io_context->current_split_offset);
 
     return 0;
 
@@ -1133,6 +1311,9 @@ int raid_reader_processor_step(struct pho_data_processor *proc,
     if (!resp && !proc->buff.size) {
         *reqs = xcalloc(1, sizeof(**reqs));
         *n_reqs = 1;
+        if (proc->range_offset)
+            raid_reader_seek_split(proc);
+
         raid_reader_eraser_build_allocation_req(proc, *reqs, PHO_PROC_DECODER);
         proc->need_alloc_response_to_read = true;
         return 0;
@@ -1160,8 +1341,13 @@ int raid_reader_processor_step(struct pho_data_processor *proc,
     if (rc)
         goto release;
 
+    /* the bytes read after the end of a ranged GET are dropped */
+    if (proc->reader_offset > proc->range_end)
+        proc->reader_offset = proc->range_end;
+
     split_ended = (proc->reader_offset - io_context->current_split_offset) >=
-                  io_context->current_split_size;
+                  io_context->current_split_size ||
+                  proc->reader_offset == proc->range_end;
     if (split_ended)
         rc = raid_reader_split_fini(proc);
 
@@ -1171,7 +1357,7 @@ int raid_reader_processor_step(struct pho_data_processor *proc,
 release:
     need_release = rc || split_ended;
     need_new_alloc = !rc && split_ended &&
-                     proc->reader_offset < proc->object_size;
+                     proc->reader_offset < proc->range_end;
     if (need_release) {
         if (need_new_alloc)
             *reqs = xcalloc(2, sizeof(**reqs));
@@ -1233,6 +1419,75 @@ static int prepare_writer_rebuilder_release_request(
     return 0;
 }
 
+/**
+ * Record the containers opened in the iods of the current target, the
+ * following targets of the put are packed in them.
+ */
+static void raid_pack_open(struct raid_pack *pack, struct extent *extents)
+{
+    size_t i;
+
+    for (i = 0; i < pack->n_extents; i++) {
+        free(pack->addresses[i].buff);
+        pack->addresses[i].buff = xstrdup(extents[i].address.buff);
+        pack->addresses[i].size = extents[i].address.size;
+        pack->offsets[i] = 0;
+        json_decref(pack->indexes[i]);
+        pack->indexes[i] = NULL;
+    }
+
+    pack->open = true;
+}
+
+/**
+ * Hand the containers opened by the previous target over to the current one.
+ */
+static void raid_pack_resume(struct pho_data_processor *proc,
+                             struct raid_pack *pack, struct extent *extents)
+{
+    struct raid_io_context *io_contexts = proc->private_writer;
+    struct raid_io_context *previous = &io_contexts[proc->current_target - 1];
+    struct raid_io_context *current = &io_contexts[proc->current_target];
+    size_t i;
+
+    for (i = 0; i < pack->n_extents; i++) {
+        current->iods[i].iod_ctx = previous->iods[i].iod_ctx;
+        previous->iods[i].iod_ctx = NULL;
+
+        extents[i].address.buff = xstrdup(pack->addresses[i].buff);
+        extents[i].address.size = pack->addresses[i].size;
+    }
+}
+
+/**
+ * Add an extent written in a container to the index of the container, and
+ * write the index if the container is not kept open for the next target.
+ *
+ * \param[out] index_size  Size of the written index, 0 if the container is
+ *                         kept open
+ */
+static int raid_pack_add_extent(struct raid_pack *pack, size_t idx,
+                                struct pho_io_descr *iod, struct extent *extent,
+                                size_t *index_size)
+{
+    ssize_t written;
+
+    *index_size = 0;
+    pack_index_add(&pack->indexes[idx], extent);
+    pack->offsets[idx] += iod->iod_size;
+    if (pack->keep_open)
+        return 0;
+
+    written = pack_index_write(iod->iod_ioa, iod, pack->indexes[idx]);
+    json_decref(pack->indexes[idx]);
+    pack->indexes[idx] = NULL;
+    if (written < 0)
+        return written;
+
+    *index_size = written;
+    return 0;
+}
+
 static int common_split_setup(struct pho_data_processor *proc)
 {
     struct raid_io_context *io_context =
@@ -1240,6 +1495,7 @@ static int common_split_setup(struct pho_data_processor *proc)
           proc->private_writer)[proc->current_target];
     struct output_io_context *output;
     struct pho_io_descr *iods;
+    struct raid_pack *pack;
     pho_resp_write_t *wresp;
     size_t n_extents;
     int rc = 0;
@@ -1249,6 +1505,7 @@ static int common_split_setup(struct pho_data_processor *proc)
     n_extents = get_n_extents(io_context, proc->type);
     wresp = proc->write_resp->walloc;
     iods = io_context->iods;
+    pack = is_encoder(proc) ? io_context->write.pack : NULL;
 
     if (wresp->n_media != n_extents)
         LOG_RETURN(-EINVAL, "Invalid number of media return by phobosd. "
@@ -1266,7 +1523,9 @@ static int common_split_setup(struct pho_data_processor *proc)
         iods[i].iod_flags = PHO_IO_REPLACE | PHO_IO_NO_REUSE;
     }
 
-    raid_io_context_setmd(io_context, proc->type, output->user_md);
+    /* the index of a container describes its packed extents */
+    if (!pack)
+        raid_io_context_setmd(io_context, proc->type, output->user_md);
 
     if (proc->type == PHO_PROC_REBUILDER)
         raid_rebuilder_set_extent_info(io_context, wresp->media,
@@ -1276,10 +1535,21 @@ static int common_split_setup(struct pho_data_processor *proc)
                                     io_context->current_split * n_extents,
                                     proc->writer_offset);
 
-    rc = raid_io_context_open(io_context, proc, n_extents,
-                              proc->current_target, PHO_PROC_ENCODER);
-    if (rc)
-        return rc;
+    if (pack && pack->open) {
+        raid_pack_resume(proc, pack, output->extents);
+    } else {
+        rc = raid_io_context_open(io_context, proc, n_extents,
+                                  proc->current_target, PHO_PROC_ENCODER);
+        if (rc)
+            return rc;
+
+        if (pack)
+            raid_pack_open(pack, output->extents);
+    }
+
+    if (pack)
+        for (i = 0; i < n_extents; ++i)
+            extent_set_pack_offset(&output->extents[i], pack->offsets[i]);
 
     if (!io_context->current_split_chunk_size) {
         if (proc->io_block_size)
@@ -1368,6 +1638,8 @@ static void common_writer_rebuilder_split_close(struct pho_data_processor *proc,
     struct raid_io_context *io_context;
     int target = proc->current_target;
     struct output_io_context *output;
+    struct extent_hash *hash;
+    struct raid_pack *pack;
     size_t n_extents;
     int i = 0;
     int rc2;
@@ -1377,24 +1649,30 @@ static void common_writer_rebuilder_split_close(struct pho_data_processor *proc,
     io_context = &((struct raid_io_context *) proc->private_writer)[target];
     output = raid_output_io_context(io_context, proc->type);
     n_extents = get_n_extents(io_context, proc->type);
+    pack = is_encoder(proc) ? io_context->write.pack : NULL;
 
     /* set extent md */
     if (!*rc) {
         for (i = 0; i < n_extents; i++) {
             struct pho_io_descr *iod = &io_context->iods[i];
             struct pho_ext_loc ext_location;
+            size_t index_size = 0;
 
             /* decrease avail size */
             proc->write_resp->walloc->media[i]->avail_size -= iod->iod_size;
 
             /* set extent hashes */
-            rc2 = extent_hash_digest(&io_context->hashes[i]);
-            if (rc2) {
-                *rc = rc2;
-                break;
+            hash = io_context->shared_hash ? &io_context->hashes[0] :
+                                             &io_context->hashes[i];
+            if (i == 0 || !io_context->shared_hash) {
+                rc2 = extent_hash_digest(hash);
+                if (rc2) {
+                    *rc = rc2;
+                    break;
+                }
             }
 
-            extent_hash_copy(&io_context->hashes[i], &output->extents[i]);
+            extent_hash_copy(hash, &output->extents[i]);
 
             /* set extent location */
             ext_location.root_path =
@@ -1403,18 +1681,26 @@ static void common_writer_rebuilder_split_close(struct pho_data_processor *proc,
                 proc->write_resp->walloc->media[i]->addr_type;
             ext_location.extent = &output->extents[i];
             iod->iod_loc = &ext_location;
-            rc2 = set_object_md(iod->iod_ioa, iod, md);
+            if (pack)
+                rc2 = raid_pack_add_extent(pack, i, iod, &output->extents[i],
+                                           &index_size);
+            else
+                rc2 = set_object_md(iod->iod_ioa, iod, md);
             pho_attrs_free(&iod->iod_attrs);
             if (rc2) {
                 *rc = rc2;
                 break;
             }
 
-            rc2 = ioa_close(iod->iod_ioa, iod);
-            if (rc2) {
-                i++;
-                *rc = rc2;
-                break;
+            proc->write_resp->walloc->media[i]->avail_size -= index_size;
+
+            if (!pack || !pack->keep_open) {
+                rc2 = ioa_close(iod->iod_ioa, iod);
+                if (rc2) {
+                    i++;
+                    *rc = rc2;
+                    break;
+                }
             }
 
             rc2 = gettimeofday(&output->extents[i].creation_time, NULL);
@@ -1432,12 +1718,19 @@ static void common_writer_rebuilder_split_close(struct pho_data_processor *proc,
 
             /* update release */
             release_req->media[i]->nb_extents_written += 1;
-            release_req->media[i]->size_written += iod->iod_size;
+            release_req->media[i]->size_written += iod->iod_size + index_size;
         }
     }
 
+    /* the containers kept open before the failure are closed too */
+    if (*rc && pack && pack->keep_open)
+        i = 0;
+
     for (; i < n_extents; i++)
         ioa_close(io_context->iods[i].iod_ioa, &io_context->iods[i]);
+
+    if (pack)
+        pack->open = !*rc && pack->keep_open;
 }
 
 static void raid_writer_split_close(struct pho_data_processor *proc, int *rc)
@@ -1632,6 +1925,7 @@ int raid_writer_processor_step(struct pho_data_processor *proc,
     bool split_ended = false;
     bool stop_io = false;
     int rc = 0;
+    int rc2;
     int i;
 
     ENTRY;
@@ -1707,6 +2001,9 @@ int raid_writer_processor_step(struct pho_data_processor *proc,
     }
 
     rc = io_context->ops->write_from_buff(proc);
+    /* the buffer and the extents must not be released with pending I/Os */
+    rc2 = data_pipeline_wait(proc);
+    rc = rc ? : rc2;
 
     split_ended = (proc->writer_offset - io_context->current_split_offset) >=
                    io_context->current_split_size;
@@ -1720,8 +2017,15 @@ int raid_writer_processor_step(struct pho_data_processor *proc,
 
     if (!rc && target_ended && !last_target_ended) {
         for (i = 0; i < io_context->n_data_extents; i++) {
-            if (proc->write_resp->walloc->media[i]->avail_size <
-                all_target_remain_to_write_per_medium) {
+            size_t avail_size = proc->write_resp->walloc->media[i]->avail_size;
+
+            /* the extent of the current target is not accounted yet, but it
+             * stays in the container with the next targets
+             */
+            if (io_context->write.pack)
+                avail_size -= min(avail_size, io_context->iods[i].iod_size);
+
+            if (avail_size < all_target_remain_to_write_per_medium) {
                 need_alloc_for_next_target = true;
                 break;
             }
@@ -1735,11 +2039,20 @@ check_for_release:
     need_new_alloc = !rc && ((split_ended && !target_ended) ||
                              need_alloc_for_next_target);
 
+    /* the next target is packed in the same containers if they are large
+     * enough
+     */
+    if (io_context->write.pack)
+        io_context->write.pack->keep_open = !rc && target_ended &&
+                                            !last_target_ended &&
+                                            !need_new_alloc;
+
     if (split_ended || rc)
         raid_writer_split_close(proc, &rc);
 
-    /* check if partial release is needed */
-    if (!rc && split_ended && !need_full_release)
+    /* check if partial release is needed, not while a container is open */
+    if (!rc && split_ended && !need_full_release &&
+        !(io_context->write.pack && io_context->write.pack->open))
         need_partial_release = need_to_sync(proc->writer_release_alloc->release,
                                             proc->writer_start_req,
                                             proc->write_resp);
@@ -1923,6 +2236,12 @@ int raid_eraser_processor_step(struct pho_data_processor *proc,
             break;
         }
 
+        /* the space of a packed extent is reclaimed by repacking its
+         * container, which other extents may still use
+         */
+        if (extent_pack_offset(&proc->src_layout->extents[ext_index]) >= 0)
+            continue;
+
         loc = make_ext_location(proc, i, ext_index, proc->current_target,
                                 PHO_PROC_ERASER);
         iod.iod_loc = &loc;
@@ -1950,6 +2269,37 @@ int raid_eraser_processor_step(struct pho_data_processor *proc,
     return rc;
 }
 
+/**
+ * Size of an extent of a split holding \p split_size bytes of the object
+ *
+ * The data extents share the split size, the first ones getting one more byte
+ * when it is not a multiple of the number of data extents. Parity extents are
+ * as long as the longest data extent.
+ */
+static size_t raid_split_extent_size(struct raid_io_context *io_context,
+                                     size_t split_size, size_t split_idx)
+{
+    size_t remainder = split_size % io_context->n_data_extents;
+    size_t size = split_size / io_context->n_data_extents;
+
+    if (split_idx < io_context->n_data_extents)
+        return size + (split_idx < remainder ? 1 : 0);
+
+    return size + (remainder > 0 ? 1 : 0);
+}
+
+static void raid_rebuilder_set_extent_size(struct raid_io_context *io_context)
+{
+    size_t n_extents_per_split = n_total_extents(io_context);
+    struct extent *extents = io_context->rebuild.output.extents;
+    size_t i;
+
+    for (i = 0; i < io_context->rebuild.current_split_missing_count; i++)
+        extents[i].size = raid_split_extent_size(
+                              io_context, io_context->current_split_size,
+                              extents[i].layout_idx % n_extents_per_split);
+}
+
 static int raid_rebuilder_split_setup(struct pho_data_processor *proc)
 {
     struct raid_io_context *io_context = proc->private_writer;
@@ -1961,11 +2311,10 @@ static int raid_rebuilder_split_setup(struct pho_data_processor *proc)
     if (rc)
         return rc;
 
-    raid_io_context_set_extent_size(
-                            io_context, proc->type,
-                            io_context->rebuild.current_split_extent_size, 0);
+    raid_rebuilder_set_extent_size(io_context);
 
-    proc->writer_stripe_size = io_context->current_split_chunk_size;
+    proc->writer_stripe_size = io_context->current_split_chunk_size *
+                               io_context->n_data_extents;
 
     if (proc->buff.size && proc->buff.size % proc->writer_stripe_size != 0)
         pho_buff_realloc(&proc->buff, lcm(proc->buff.size,
@@ -1977,9 +2326,6 @@ static int raid_rebuilder_split_setup(struct pho_data_processor *proc)
             return rc;
     }
 
-    io_context->current_split_size =
-        io_context->rebuild.current_split_extent_size;
-
     return io_context->ops->set_extra_attrs(proc);
 }
 
@@ -2051,7 +2397,7 @@ static size_t raid_rebuilder_seek_next_missing_split(
         io_context->rebuild.current_split_missing_count =
             n_extents_per_split - n_extents;
 
-        /* Get offset and size of the first extent of this split */
+        /* Get offset of the first extent of this split */
         for (i = 0; i < layout->ext_count; i++) {
             struct extent *extent = &layout->extents[i];
 
@@ -2060,10 +2406,28 @@ static size_t raid_rebuilder_seek_next_missing_split(
 
             io_context->current_split_offset = extent->offset;
             proc->writer_offset = extent->offset;
-            io_context->rebuild.current_split_extent_size = extent->size;
+            break;
+        }
 
-            return true;
+        /* The split ends where the next one starts, or at the object end */
+        io_context->current_split_size = proc->object_size -
+                                         io_context->current_split_offset;
+        for (; i < layout->ext_count; i++) {
+            struct extent *extent = &layout->extents[i];
+
+            if (extent->layout_idx < first_layout_idx + n_extents_per_split)
+                continue;
+
+            io_context->current_split_size =
+                extent->offset - io_context->current_split_offset;
+            break;
         }
+
+        io_context->rebuild.current_split_extent_size =
+            raid_split_extent_size(io_context, io_context->current_split_size,
+                                   n_extents_per_split - 1);
+
+        return true;
     }
 
     return false;
@@ -2079,6 +2443,7 @@ int raid_rebuilder_processor_step(struct pho_data_processor *proc,
     bool split_ended = false;
     bool stop_io = false;
     int rc = 0;
+    int rc2;
 
     ENTRY;
 
@@ -2136,9 +2501,12 @@ int raid_rebuilder_processor_step(struct pho_data_processor *proc,
     }
 
     rc = io_context->ops->rebuild_from_buff(proc);
+    /* the buffer and the extents must not be released with pending I/Os */
+    rc2 = data_pipeline_wait(proc);
+    rc = rc ? : rc2;
 
     split_ended = (proc->writer_offset - io_context->current_split_offset) ==
-                    io_context->rebuild.current_split_extent_size;
+                    io_context->current_split_size;
     if (split_ended)
         io_context->rebuild.missing_extents_remaining -=
             io_context->rebuild.current_split_missing_count;
@@ -2234,6 +2602,57 @@ int extent_hash_update(struct extent_hash *hash, char *buffer, size_t size)
     return 0;
 }
 
+static void raid_set_xfer_rc(struct pho_data_processor *proc, int rc)
+{
+    if (proc->xfer->xd_rc == 0)
+        proc->xfer->xd_rc = rc;
+
+    proc->xfer->xd_targets[proc->current_target].xt_rc = rc;
+}
+
+int raid_queue_chunk(struct pho_data_processor *proc, size_t lane,
+                     struct pho_io_descr *iod, const char *buff, size_t size,
+                     struct extent_hash *hash)
+{
+    int rc;
+
+    rc = data_pipeline_write(proc, lane, iod, buff, size, hash,
+                             extent_hash_update);
+    if (rc) {
+        raid_set_xfer_rc(proc, rc);
+        LOG_RETURN(rc,
+                   "unable to queue the write of %zu bytes at offset %zu",
+                   size, proc->writer_offset);
+    }
+
+    return 0;
+}
+
+int raid_write_chunk(struct pho_data_processor *proc, size_t lane,
+                     struct pho_io_descr *iod, const char *buff, size_t size,
+                     struct extent_hash *hash)
+{
+    int rc;
+
+    if (data_pipeline_enabled(proc))
+        return raid_queue_chunk(proc, lane, iod, buff, size, hash);
+
+    rc = ioa_write(iod->iod_ioa, iod, buff, size);
+    if (rc)
+        LOG_GOTO(out_err, rc, "write of %zu bytes fails at offset %zu", size,
+                 proc->writer_offset);
+
+    if (hash)
+        return extent_hash_update(hash, (char *)buff, size);
+
+    return 0;
+
+out_err:
+    raid_set_xfer_rc(proc, rc);
+
+    return rc;
+}
+
 int extent_hash_digest(struct extent_hash *hash)
 {
     if (hash->md5context) {
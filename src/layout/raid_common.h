@@ -68,6 +68,10 @@ struct read_io_context {
      */
     struct extent **extents;
     bool check_hash;
+    size_t split_start;         /*< Offset in the current split of the first
+                                 *  byte read, not 0 for the first split of a
+                                 *  ranged GET
+                                 */
 };
 
 struct delete_io_context {
@@ -105,17 +109,40 @@ struct output_io_context {
     size_t n_released_media;
 };
 
+/**
+ * Container shared by the targets of a packed put, see PHO_PACK_MAGIC.
+ *
+ * The I/O descriptors of an open container are handed over from one target to
+ * the next one, and the container is closed after the last target written on
+ * its media.
+ */
+struct raid_pack {
+    bool open;                  /*< the container is open in the iods of the
+                                 *  current target
+                                 */
+    bool keep_open;             /*< the next target goes in the same container
+                                 */
+    size_t n_extents;           /*< number of containers, one per medium */
+    struct pho_buff *addresses; /*< addresses of the containers */
+    size_t *offsets;            /*< next offset in each container */
+    json_t **indexes;           /*< indexes of the containers */
+};
+
 struct write_io_context {
     struct output_io_context output;
     bool all_is_written;
     bool released;              /*< true when we receive all release ack */
     size_t to_write;            /*< Whole object remaining size to write */
+    struct raid_pack *pack;     /*< shared by all the targets of a packed put,
+                                 *  NULL otherwise
+                                 */
 };
 
 struct rebuild_io_context {
     struct output_io_context output;
     size_t missing_extents_remaining;
     size_t current_split_missing_count;
+    /** Size of the largest extent of the current split */
     size_t current_split_extent_size;
 };
 
@@ -132,6 +159,8 @@ struct raid_io_context {
      * allocates
      */
     struct pho_buff *buffers;
+    /** Number of elements of \p buffers, freed by the destroy functions */
+    size_t nb_buffers;
     size_t current_split;
     size_t current_split_size;
     size_t current_split_offset;
@@ -164,6 +193,11 @@ struct raid_io_context {
     struct extent_hash *hashes;
     /** Size of \p hashes, initialized by the layout */
     size_t nb_hashes;
+    /**
+     * Every written extent holds the same data, as raid1 replicas do: only
+     * the first hash of \p hashes is computed and it is copied to each extent.
+     */
+    bool shared_hash;
 };
 
 static inline struct output_io_context *raid_output_io_context(
@@ -246,6 +280,44 @@ int extent_hash_update(struct extent_hash *hash, char *buffer, size_t size);
 
 int extent_hash_digest(struct extent_hash *hash);
 
+/**
+ * Write \p size bytes of \p buff into \p iod and update \p hash with them.
+ *
+ * With the pipelined data path, the write is queued on the writer thread of
+ * \p lane and the hash update on the hasher thread: \p buff must then stay
+ * untouched until the end of the writer step, which waits for them.
+ *
+ * The size of \p iod is not updated.
+ *
+ * @param[in,out] proc  Data processor
+ * @param[in]     lane  Writer thread to use, usually the extent index
+ * @param[in,out] iod   I/O descriptor to write into
+ * @param[in]     buff  Bytes to write
+ * @param[in]     size  Number of bytes to write
+ * @param[in,out] hash  Hash to update, or NULL
+ *
+ * @return 0 on success, -errno on error.
+ */
+int raid_write_chunk(struct pho_data_processor *proc, size_t lane,
+                     struct pho_io_descr *iod, const char *buff, size_t size,
+                     struct extent_hash *hash);
+
+/**
+ * Queue the write of \p size bytes of \p buff into \p iod on the writer thread
+ * of \p lane, and the update of \p hash with them on the hasher thread,
+ * whether the pipelined data path is enabled or not.
+ *
+ * Used to write several extents concurrently: \p buff must stay untouched
+ * until the end of the writer step, which waits for the queued writes.
+ *
+ * Same parameters as raid_write_chunk().
+ *
+ * @return 0 on success, -errno on error.
+ */
+int raid_queue_chunk(struct pho_data_processor *proc, size_t lane,
+                     struct pho_io_descr *iod, const char *buff, size_t size,
+                     struct extent_hash *hash);
+
 void extent_hash_copy(struct extent_hash *hash, struct extent *extent);
 
 int extent_hash_compare(struct extent_hash *hash, struct extent *extent);
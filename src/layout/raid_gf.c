@@ -0,0 +1,346 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  GF(2^8) arithmetic and Reed-Solomon kernels for erasure coding
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RAID_GF_X86 1
+#endif
+
+#include "pho_common.h"
+#include "raid_gf.h"
+
+#define GF_POLYNOMIAL 0x11d
+
+static uint8_t gf_exp[512];
+static uint8_t gf_log[256];
+
+uint8_t raid_gf_mul(uint8_t a, uint8_t b)
+{
+    if (a == 0 || b == 0)
+        return 0;
+
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+uint8_t raid_gf_inv(uint8_t a)
+{
+    assert(a != 0);
+
+    return gf_exp[255 - gf_log[a]];
+}
+
+void raid_gf_build_tbl(uint8_t c, uint8_t *tbl)
+{
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        tbl[i] = raid_gf_mul(c, i);
+        tbl[16 + i] = raid_gf_mul(c, i << 4);
+    }
+}
+
+static bool scalar_supported(void)
+{
+    return true;
+}
+
+static void scalar_mul_add(const uint8_t *tbl, const char *src, char *dst,
+                           size_t count)
+{
+    const uint8_t *s = (const uint8_t *)src;
+    uint8_t *d = (uint8_t *)dst;
+    size_t i;
+
+    for (i = 0; i < count; i++)
+        d[i] ^= tbl[s[i] & 0x0f] ^ tbl[16 + (s[i] >> 4)];
+}
+
+/* The byte shuffle intrinsics are only usable through function target
+ * attributes since the same compiler versions as AVX2 ones.
+ */
+#if defined(RAID_GF_X86) && defined(HAVE_AVX2_TARGET)
+
+static bool ssse3_supported(void)
+{
+    return __builtin_cpu_supports("ssse3");
+}
+
+__attribute__((target("ssse3")))
+static void ssse3_mul_add(const uint8_t *tbl, const char *src, char *dst,
+                          size_t count)
+{
+    const __m128i tlo = _mm_loadu_si128((const __m128i *)tbl);
+    const __m128i thi = _mm_loadu_si128((const __m128i *)(tbl + 16));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+
+    for (; i + sizeof(__m128i) <= count; i += sizeof(__m128i)) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        __m128i lo = _mm_and_si128(s, mask);
+        __m128i hi = _mm_and_si128(_mm_srli_epi64(s, 4), mask);
+
+        lo = _mm_shuffle_epi8(tlo, lo);
+        hi = _mm_shuffle_epi8(thi, hi);
+        d = _mm_xor_si128(d, _mm_xor_si128(lo, hi));
+        _mm_storeu_si128((__m128i *)(dst + i), d);
+    }
+
+    scalar_mul_add(tbl, src + i, dst + i, count - i);
+}
+
+static bool avx2_supported(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+__attribute__((target("avx2")))
+static void avx2_mul_add(const uint8_t *tbl, const char *src, char *dst,
+                         size_t count)
+{
+    const __m256i tlo = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)tbl));
+    const __m256i thi = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)(tbl + 16)));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+
+    for (; i + sizeof(__m256i) <= count; i += sizeof(__m256i)) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i lo = _mm256_and_si256(s, mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi64(s, 4), mask);
+
+        lo = _mm256_shuffle_epi8(tlo, lo);
+        hi = _mm256_shuffle_epi8(thi, hi);
+        d = _mm256_xor_si256(d, _mm256_xor_si256(lo, hi));
+        _mm256_storeu_si256((__m256i *)(dst + i), d);
+    }
+
+    ssse3_mul_add(tbl, src + i, dst + i, count - i);
+}
+
+#endif /* RAID_GF_X86 && HAVE_AVX2_TARGET */
+
+/* Ordered from the slowest to the fastest implementation */
+static const struct raid_gf_kernel RAID_GF_KERNELS[] = {
+    {
+        .name = "scalar",
+        .supported = scalar_supported,
+        .mul_add = scalar_mul_add,
+    },
+#if defined(RAID_GF_X86) && defined(HAVE_AVX2_TARGET)
+    {
+        .name = "ssse3",
+        .supported = ssse3_supported,
+        .mul_add = ssse3_mul_add,
+    },
+    {
+        .name = "avx2",
+        .supported = avx2_supported,
+        .mul_add = avx2_mul_add,
+    },
+#endif
+};
+
+static const struct raid_gf_kernel *selected_kernel = &RAID_GF_KERNELS[0];
+
+__attribute__((constructor)) static void raid_gf_init(void)
+{
+    unsigned int x = 1;
+    int i;
+
+    for (i = 0; i < 255; i++) {
+        gf_exp[i] = x;
+        gf_log[x] = i;
+        x <<= 1;
+        if (x & 0x100)
+            x ^= GF_POLYNOMIAL;
+    }
+    /* avoid a modulo in raid_gf_mul */
+    for (i = 255; i < ARRAY_SIZE(gf_exp); i++)
+        gf_exp[i] = gf_exp[i - 255];
+
+#ifdef RAID_GF_X86
+    __builtin_cpu_init();
+#endif
+
+    for (i = ARRAY_SIZE(RAID_GF_KERNELS) - 1; i >= 0; i--) {
+        if (RAID_GF_KERNELS[i].supported()) {
+            selected_kernel = &RAID_GF_KERNELS[i];
+            break;
+        }
+    }
+}
+
+const struct raid_gf_kernel *raid_gf_kernels(size_t *count)
+{
+    *count = ARRAY_SIZE(RAID_GF_KERNELS);
+
+    return RAID_GF_KERNELS;
+}
+
+const struct raid_gf_kernel *raid_gf_kernel(void)
+{
+    return selected_kernel;
+}
+
+void raid_gf_mul_add(const uint8_t *tbl, const char *src, char *dst,
+                     size_t count)
+{
+    selected_kernel->mul_add(tbl, src, dst, count);
+}
+
+int raid_gf_gen_cauchy(size_t k, size_t m, uint8_t *matrix)
+{
+    size_t i, j;
+
+    if (k == 0 || k + m > RAID_GF_MAX_EXTENTS)
+        return -EINVAL;
+
+    /* x_i = k + i and y_j = j are all distinct, so x_i ^ y_j is never null */
+    for (i = 0; i < m; i++)
+        for (j = 0; j < k; j++)
+            matrix[i * k + j] = raid_gf_inv((k + i) ^ j);
+
+    return 0;
+}
+
+int raid_gf_decode_matrix(size_t k, size_t m, const size_t *rows,
+                          uint8_t *decode)
+{
+    uint8_t *coding;
+    uint8_t *work;
+    size_t i, j, r;
+    int rc = 0;
+
+    coding = xmalloc(m * k + 1);
+    work = xcalloc(k * k, sizeof(*work));
+
+    rc = raid_gf_gen_cauchy(k, m, coding);
+    if (rc)
+        goto out;
+
+    /* work = rows of [I; C] matching the available extents */
+    for (i = 0; i < k; i++) {
+        if (rows[i] >= k + m)
+            LOG_GOTO(out, rc = -EINVAL, "Invalid extent index %zu for %zu+%zu",
+                     rows[i], k, m);
+
+        if (rows[i] < k)
+            work[i * k + rows[i]] = 1;
+        else
+            memcpy(&work[i * k], &coding[(rows[i] - k) * k], k);
+    }
+
+    /* decode = identity */
+    memset(decode, 0, k * k);
+    for (i = 0; i < k; i++)
+        decode[i * k + i] = 1;
+
+    /* Gauss-Jordan elimination, applying the same operations to decode */
+    for (i = 0; i < k; i++) {
+        uint8_t inv;
+
+        for (r = i; r < k && work[r * k + i] == 0; r++)
+            ;
+
+        if (r == k)
+            LOG_GOTO(out, rc = -EINVAL, "Singular erasure decoding matrix");
+
+        if (r != i) {
+            for (j = 0; j < k; j++) {
+                uint8_t tmp;
+
+                tmp = work[i * k + j];
+                work[i * k + j] = work[r * k + j];
+                work[r * k + j] = tmp;
+                tmp = decode[i * k + j];
+                decode[i * k + j] = decode[r * k + j];
+                decode[r * k + j] = tmp;
+            }
+        }
+
+        inv = raid_gf_inv(work[i * k + i]);
+        for (j = 0; j < k; j++) {
+            work[i * k + j] = raid_gf_mul(work[i * k + j], inv);
+            decode[i * k + j] = raid_gf_mul(decode[i * k + j], inv);
+        }
+
+        for (r = 0; r < k; r++) {
+            uint8_t factor = work[r * k + i];
+
+            if (r == i || factor == 0)
+                continue;
+
+            for (j = 0; j < k; j++) {
+                work[r * k + j] ^= raid_gf_mul(factor, work[i * k + j]);
+                decode[r * k + j] ^= raid_gf_mul(factor, decode[i * k + j]);
+            }
+        }
+    }
+
+out:
+    free(coding);
+    free(work);
+
+    return rc;
+}
+
+void raid_gf_build_tables(size_t n, const uint8_t *coefs, uint8_t *tables)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        raid_gf_build_tbl(coefs[i], tables + i * RAID_GF_TBL_SIZE);
+}
+
+void raid_gf_encode(size_t k, size_t m, const uint8_t *tables,
+                    const char * const *data, const size_t *data_len,
+                    char **parity, size_t parity_len)
+{
+    size_t i, j;
+
+    for (i = 0; i < m; i++) {
+        memset(parity[i], 0, parity_len);
+
+        for (j = 0; j < k; j++) {
+            size_t len = min(data_len[j], parity_len);
+
+            if (len == 0)
+                continue;
+
+            selected_kernel->mul_add(tables + (i * k + j) * RAID_GF_TBL_SIZE,
+                                     data[j], parity[i], len);
+        }
+    }
+}
@@ -0,0 +1,143 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  GF(2^8) arithmetic and Reed-Solomon kernels for erasure coding
+ *
+ * The field is built on the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d).
+ * A systematic Cauchy matrix is used as generator: any k rows of the
+ * (k + m) x k matrix [I; C] form an invertible matrix, so any k extents out
+ * of k + m are enough to rebuild the data.
+ *
+ * Multiplications of a buffer by a constant are done with two 16-entry
+ * tables (low and high nibble of each byte), which maps directly to the
+ * byte shuffle instructions of SSSE3 and AVX2. The fastest implementation
+ * supported by the running CPU is selected when the library is loaded.
+ */
+
+#ifndef RAID_GF_H
+#define RAID_GF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Maximum number of extents (k + m) of one stripe */
+#define RAID_GF_MAX_EXTENTS 256
+
+/** Size of the multiplication table of one coefficient */
+#define RAID_GF_TBL_SIZE 32
+
+/**
+ * One implementation of the region multiply-accumulate kernel.
+ */
+struct raid_gf_kernel {
+    /** Name of the implementation ("scalar", "ssse3", "avx2") */
+    const char *name;
+    /** Whether the running CPU is able to execute this implementation */
+    bool (*supported)(void);
+    /**
+     * dst[i] ^= c * src[i] for i in [0, count[, where \p tbl is the
+     * multiplication table of c built by raid_gf_build_tbl().
+     */
+    void (*mul_add)(const uint8_t *tbl, const char *src, char *dst,
+                    size_t count);
+};
+
+/** Multiply two elements of GF(2^8) */
+uint8_t raid_gf_mul(uint8_t a, uint8_t b);
+
+/** Inverse of a non-null element of GF(2^8) */
+uint8_t raid_gf_inv(uint8_t a);
+
+/**
+ * Build the RAID_GF_TBL_SIZE bytes multiplication table of \p c used by the
+ * region kernels.
+ */
+void raid_gf_build_tbl(uint8_t c, uint8_t *tbl);
+
+/**
+ * Return the list of the compiled kernels, whether the running CPU supports
+ * them or not. The scalar one is always the first.
+ */
+const struct raid_gf_kernel *raid_gf_kernels(size_t *count);
+
+/** Return the kernel selected for the running CPU */
+const struct raid_gf_kernel *raid_gf_kernel(void);
+
+/**
+ * dst[i] ^= c * src[i] with the selected kernel.
+ */
+void raid_gf_mul_add(const uint8_t *tbl, const char *src, char *dst,
+                     size_t count);
+
+/**
+ * Fill \p matrix with the m x k coding part of the generator matrix.
+ *
+ * @param[in]  k       Number of data extents
+ * @param[in]  m       Number of parity extents
+ * @param[out] matrix  m * k coefficients, row major
+ *
+ * @return 0 on success, -EINVAL if k + m exceeds RAID_GF_MAX_EXTENTS.
+ */
+int raid_gf_gen_cauchy(size_t k, size_t m, uint8_t *matrix);
+
+/**
+ * Build the k x k decoding matrix giving the data extents from the k
+ * available extents \p rows.
+ *
+ * @param[in]  k       Number of data extents
+ * @param[in]  m       Number of parity extents
+ * @param[in]  rows    k distinct and sorted indexes in [0, k + m[ of the
+ *                     available extents (index >= k is a parity extent)
+ * @param[out] decode  k * k coefficients, row major: data extent j is
+ *                     sum(decode[j * k + a] * available extent a)
+ *
+ * @return 0 on success, -EINVAL if the matrix cannot be inverted.
+ */
+int raid_gf_decode_matrix(size_t k, size_t m, const size_t *rows,
+                          uint8_t *decode);
+
+/**
+ * Build the multiplication tables of \p n coefficients, RAID_GF_TBL_SIZE bytes
+ * each, in the same order.
+ */
+void raid_gf_build_tables(size_t n, const uint8_t *coefs, uint8_t *tables);
+
+/**
+ * Compute the parity chunks of one stripe.
+ *
+ * Data chunks shorter than \p parity_len are considered padded with zeros.
+ *
+ * @param[in]  k           Number of data chunks
+ * @param[in]  m           Number of parity chunks
+ * @param[in]  tables      Tables of the m x k coding matrix, from
+ *                         raid_gf_build_tables()
+ * @param[in]  data        k data chunks
+ * @param[in]  data_len    Length of each data chunk
+ * @param[out] parity      m parity chunks of \p parity_len bytes
+ * @param[in]  parity_len  Length of each parity chunk
+ */
+void raid_gf_encode(size_t k, size_t m, const uint8_t *tables,
+                    const char * const *data, const size_t *data_len,
+                    char **parity, size_t parity_len);
+
+#endif /* RAID_GF_H */
@@ -0,0 +1,288 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Parity (XOR) kernels shared by the RAID layouts
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RAID_XOR_X86 1
+#endif
+
+#include "pho_common.h"
+#include "raid_common.h"
+#include "raid_xor.h"
+
+/*
+ * Scalar kernels: process one machine word per iteration. The memcpy calls are
+ * optimized out by the compiler and avoid any alignment or aliasing issue on
+ * the char buffers given by the layouts.
+ */
+static bool scalar_supported(void)
+{
+    return true;
+}
+
+static void scalar_xor(const char *src1, const char *src2, char *dst,
+                       size_t count)
+{
+    size_t i = 0;
+
+    for (; i + sizeof(uint64_t) <= count; i += sizeof(uint64_t)) {
+        uint64_t a, b;
+
+        memcpy(&a, src1 + i, sizeof(a));
+        memcpy(&b, src2 + i, sizeof(b));
+        a ^= b;
+        memcpy(dst + i, &a, sizeof(a));
+    }
+
+    for (; i < count; i++)
+        dst[i] = src1[i] ^ src2[i];
+}
+
+static void scalar_xor_in_place(const char *data, char *parity, size_t count)
+{
+    scalar_xor(parity, data, parity, count);
+}
+
+#ifdef RAID_XOR_X86
+
+static bool sse2_supported(void)
+{
+    return __builtin_cpu_supports("sse2");
+}
+
+__attribute__((target("sse2")))
+static void sse2_xor(const char *src1, const char *src2, char *dst,
+                     size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 * sizeof(__m128i) <= count; i += 4 * sizeof(__m128i)) {
+        const __m128i *s1 = (const __m128i *)(src1 + i);
+        const __m128i *s2 = (const __m128i *)(src2 + i);
+        __m128i *d = (__m128i *)(dst + i);
+        __m128i a0 = _mm_loadu_si128(s1);
+        __m128i a1 = _mm_loadu_si128(s1 + 1);
+        __m128i a2 = _mm_loadu_si128(s1 + 2);
+        __m128i a3 = _mm_loadu_si128(s1 + 3);
+
+        a0 = _mm_xor_si128(a0, _mm_loadu_si128(s2));
+        a1 = _mm_xor_si128(a1, _mm_loadu_si128(s2 + 1));
+        a2 = _mm_xor_si128(a2, _mm_loadu_si128(s2 + 2));
+        a3 = _mm_xor_si128(a3, _mm_loadu_si128(s2 + 3));
+
+        _mm_storeu_si128(d, a0);
+        _mm_storeu_si128(d + 1, a1);
+        _mm_storeu_si128(d + 2, a2);
+        _mm_storeu_si128(d + 3, a3);
+    }
+
+    scalar_xor(src1 + i, src2 + i, dst + i, count - i);
+}
+
+static void sse2_xor_in_place(const char *data, char *parity, size_t count)
+{
+    sse2_xor(parity, data, parity, count);
+}
+
+#ifdef HAVE_AVX2_TARGET
+static bool avx2_supported(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+__attribute__((target("avx2")))
+static void avx2_xor(const char *src1, const char *src2, char *dst,
+                     size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 * sizeof(__m256i) <= count; i += 4 * sizeof(__m256i)) {
+        const __m256i *s1 = (const __m256i *)(src1 + i);
+        const __m256i *s2 = (const __m256i *)(src2 + i);
+        __m256i *d = (__m256i *)(dst + i);
+        __m256i a0 = _mm256_loadu_si256(s1);
+        __m256i a1 = _mm256_loadu_si256(s1 + 1);
+        __m256i a2 = _mm256_loadu_si256(s1 + 2);
+        __m256i a3 = _mm256_loadu_si256(s1 + 3);
+
+        a0 = _mm256_xor_si256(a0, _mm256_loadu_si256(s2));
+        a1 = _mm256_xor_si256(a1, _mm256_loadu_si256(s2 + 1));
+        a2 = _mm256_xor_si256(a2, _mm256_loadu_si256(s2 + 2));
+        a3 = _mm256_xor_si256(a3, _mm256_loadu_si256(s2 + 3));
+
+        _mm256_storeu_si256(d, a0);
+        _mm256_storeu_si256(d + 1, a1);
+        _mm256_storeu_si256(d + 2, a2);
+        _mm256_storeu_si256(d + 3, a3);
+    }
+
+    sse2_xor(src1 + i, src2 + i, dst + i, count - i);
+}
+
+static void avx2_xor_in_place(const char *data, char *parity, size_t count)
+{
+    avx2_xor(parity, data, parity, count);
+}
+#endif /* HAVE_AVX2_TARGET */
+
+#ifdef HAVE_AVX512F_TARGET
+static bool avx512_supported(void)
+{
+    return __builtin_cpu_supports("avx512f");
+}
+
+__attribute__((target("avx512f")))
+static void avx512_xor(const char *src1, const char *src2, char *dst,
+                       size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 * sizeof(__m512i) <= count; i += 4 * sizeof(__m512i)) {
+        __m512i a0 = _mm512_loadu_si512(src1 + i);
+        __m512i a1 = _mm512_loadu_si512(src1 + i + 64);
+        __m512i a2 = _mm512_loadu_si512(src1 + i + 128);
+        __m512i a3 = _mm512_loadu_si512(src1 + i + 192);
+
+        a0 = _mm512_xor_si512(a0, _mm512_loadu_si512(src2 + i));
+        a1 = _mm512_xor_si512(a1, _mm512_loadu_si512(src2 + i + 64));
+        a2 = _mm512_xor_si512(a2, _mm512_loadu_si512(src2 + i + 128));
+        a3 = _mm512_xor_si512(a3, _mm512_loadu_si512(src2 + i + 192));
+
+        _mm512_storeu_si512(dst + i, a0);
+        _mm512_storeu_si512(dst + i + 64, a1);
+        _mm512_storeu_si512(dst + i + 128, a2);
+        _mm512_storeu_si512(dst + i + 192, a3);
+    }
+
+    sse2_xor(src1 + i, src2 + i, dst + i, count - i);
+}
+
+static void avx512_xor_in_place(const char *data, char *parity, size_t count)
+{
+    avx512_xor(parity, data, parity, count);
+}
+#endif /* HAVE_AVX512F_TARGET */
+
+#endif /* RAID_XOR_X86 */
+
+/* Ordered from the slowest to the fastest implementation */
+static const struct raid_xor_kernel RAID_XOR_KERNELS[] = {
+    {
+        .name = "scalar",
+        .supported = scalar_supported,
+        .xor_buffers = scalar_xor,
+        .xor_in_place = scalar_xor_in_place,
+    },
+#ifdef RAID_XOR_X86
+    {
+        .name = "sse2",
+        .supported = sse2_supported,
+        .xor_buffers = sse2_xor,
+        .xor_in_place = sse2_xor_in_place,
+    },
+#ifdef HAVE_AVX2_TARGET
+    {
+        .name = "avx2",
+        .supported = avx2_supported,
+        .xor_buffers = avx2_xor,
+        .xor_in_place = avx2_xor_in_place,
+    },
+#endif
+#ifdef HAVE_AVX512F_TARGET
+    {
+        .name = "avx512",
+        .supported = avx512_supported,
+        .xor_buffers = avx512_xor,
+        .xor_in_place = avx512_xor_in_place,
+    },
+#endif
+#endif /* RAID_XOR_X86 */
+};
+
+static const struct raid_xor_kernel *selected_kernel = &RAID_XOR_KERNELS[0];
+
+__attribute__((constructor)) static void raid_xor_select_kernel(void)
+{
+    int i;
+
+#ifdef RAID_XOR_X86
+    __builtin_cpu_init();
+#endif
+
+    for (i = ARRAY_SIZE(RAID_XOR_KERNELS) - 1; i >= 0; i--) {
+        if (RAID_XOR_KERNELS[i].supported()) {
+            selected_kernel = &RAID_XOR_KERNELS[i];
+            break;
+        }
+    }
+}
+
+const struct raid_xor_kernel *raid_xor_kernels(size_t *count)
+{
+    *count = ARRAY_SIZE(RAID_XOR_KERNELS);
+
+    return RAID_XOR_KERNELS;
+}
+
+const struct raid_xor_kernel *raid_xor_kernel(void)
+{
+    return selected_kernel;
+}
+
+void raid_xor(const char *src1, const char *src2, char *dst, size_t count)
+{
+    selected_kernel->xor_buffers(src1, src2, dst, count);
+}
+
+void raid_xor_in_place(const char *data, char *parity, size_t count)
+{
+    selected_kernel->xor_in_place(data, parity, count);
+}
+
+int raid_xor_in_place_hash(const char *data, char *parity, size_t count,
+                           struct extent_hash *hash)
+{
+    size_t done = 0;
+    int rc;
+
+    while (done < count) {
+        size_t block = min(count - done, (size_t)RAID_XOR_FUSED_BLOCK_SIZE);
+
+        selected_kernel->xor_in_place(data + done, parity + done, block);
+        rc = extent_hash_update(hash, parity + done, block);
+        if (rc)
+            return rc;
+
+        done += block;
+    }
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Parity (XOR) kernels shared by the RAID layouts
+ *
+ * Several implementations of the same kernels are compiled (scalar, SSE2,
+ * AVX2, AVX-512) and the fastest one supported by the running CPU is selected
+ * once, when the library is loaded.
+ */
+
+#ifndef RAID_XOR_H
+#define RAID_XOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct extent_hash;
+
+/**
+ * One implementation of the parity kernels.
+ */
+struct raid_xor_kernel {
+    /** Name of the implementation ("scalar", "sse2", "avx2", "avx512") */
+    const char *name;
+    /** Whether the running CPU is able to execute this implementation */
+    bool (*supported)(void);
+    /** dst[i] = src1[i] ^ src2[i] for i in [0, count[ */
+    void (*xor_buffers)(const char *src1, const char *src2, char *dst,
+                        size_t count);
+    /** parity[i] ^= data[i] for i in [0, count[ */
+    void (*xor_in_place)(const char *data, char *parity, size_t count);
+};
+
+/**
+ * Size of the blocks processed by the fused "XOR + hash" kernel. A block is
+ * XOR'ed then hashed while it is still hot in the CPU cache.
+ */
+#define RAID_XOR_FUSED_BLOCK_SIZE (32 * 1024)
+
+/**
+ * Return the list of the kernels compiled in this library, whether the running
+ * CPU supports them or not. Mainly useful for tests and benchmarks.
+ *
+ * @param[out] count    Number of kernels in the returned array
+ *
+ * @return the array of compiled kernels, the scalar one is always the first.
+ */
+const struct raid_xor_kernel *raid_xor_kernels(size_t *count);
+
+/**
+ * Return the kernel selected for the running CPU.
+ */
+const struct raid_xor_kernel *raid_xor_kernel(void);
+
+/**
+ * Compute dst = src1 ^ src2 with the selected kernel.
+ */
+void raid_xor(const char *src1, const char *src2, char *dst, size_t count);
+
+/**
+ * Compute parity ^= data with the selected kernel.
+ */
+void raid_xor_in_place(const char *data, char *parity, size_t count);
+
+/**
+ * Compute parity ^= data and update \p hash with the resulting parity bytes
+ * in a single pass over the buffer.
+ *
+ * The result is identical to raid_xor_in_place() followed by
+ * extent_hash_update() on \p parity, but each block is hashed right after it
+ * is XOR'ed, so the parity buffer is only loaded once from memory.
+ *
+ * @param[in]      data    Data buffer
+ * @param[in,out]  parity  Parity buffer, updated in place
+ * @param[in]      count   Number of bytes to process
+ * @param[in,out]  hash    Hash to update with the resulting parity bytes
+ *
+ * @return 0 on success, -errno on error.
+ */
+int raid_xor_in_place_hash(const char *data, char *parity, size_t count,
+                           struct extent_hash *hash);
+
+#endif /* RAID_XOR_H */
@@ -32,6 +32,7 @@
 #include "pho_ldm.h"
 #include "pho_module_loader.h"
 #include "pho_type_utils.h"
+#include "scsi_api.h"
 #include "slist.h"
 
 #include <assert.h>
@@ -572,12 +573,62 @@ static int scsi_tape_dev_query(const char *dev_path, struct ldm_dev_state *lds)
     return 0;
 }
 
+/**
+ * Ask the drive at dev_path for the Recommended Access Order of segments of
+ * its mounted tape.
+ */
+static int scsi_tape_dev_rao(const char *dev_path,
+                             struct ldm_rao_segment *segments, size_t count)
+{
+    struct ldm_rao_segment *ordered;
+    struct scsi_uds *uds;
+    size_t *order;
+    size_t i;
+    int rc;
+    int fd;
+
+    ENTRY;
+
+    if (count > SCSI_RAO_MAX_UDS)
+        return -ENOTSUP;
+
+    fd = open(dev_path, O_RDWR | O_NONBLOCK);
+    if (fd < 0)
+        LOG_RETURN(-errno, "Cannot open '%s'", dev_path);
+
+    uds = xmalloc(count * sizeof(*uds));
+    order = xmalloc(count * sizeof(*order));
+    for (i = 0; i < count; i++) {
+        uds[i].partition = segments[i].partition;
+        uds[i].begin = segments[i].begin;
+        uds[i].end = segments[i].end;
+    }
+
+    rc = scsi_rao(fd, uds, count, order, NULL);
+    close(fd);
+    if (rc)
+        goto free_uds;
+
+    ordered = xmalloc(count * sizeof(*ordered));
+    for (i = 0; i < count; i++)
+        ordered[i] = segments[order[i]];
+
+    memcpy(segments, ordered, count * sizeof(*segments));
+    free(ordered);
+
+free_uds:
+    free(order);
+    free(uds);
+    return rc;
+}
+
 /** Exported dev adapter */
 struct pho_dev_adapter_module_ops DEV_ADAPTER_SCSI_TAPE_OPS = {
     .dev_lookup = scsi_tape_dev_lookup,
     .dev_query  = scsi_tape_dev_query,
     .dev_load   = NULL, /** @TODO to be implemented */
     .dev_eject  = NULL, /** @TODO to be implemented */
+    .dev_rao    = scsi_tape_dev_rao,
 };
 
 /** Dev adapter module registration entry point */
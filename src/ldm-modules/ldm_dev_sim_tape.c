@@ -0,0 +1,141 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos Local Device Manager: device calls for simulated drives.
+ *
+ * A simulated drive is a directory of the simulated library, named after its
+ * serial.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ldm_sim.h"
+#include "pho_common.h"
+#include "pho_ldm.h"
+#include "pho_module_loader.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PLUGIN_NAME     "sim_tape"
+#define PLUGIN_MAJOR    0
+#define PLUGIN_MINOR    1
+
+static struct module_desc DEV_ADAPTER_SIM_TAPE_MODULE_DESC = {
+    .mod_name  = PLUGIN_NAME,
+    .mod_major = PLUGIN_MAJOR,
+    .mod_minor = PLUGIN_MINOR,
+};
+
+static int sim_tape_lookup(const char *dev_id, char *dev_path,
+                           size_t path_size)
+{
+    struct stat st;
+    char *path;
+    int rc = 0;
+
+    ENTRY;
+
+    path = ldm_sim_path("drives", dev_id);
+    if (!path)
+        return -ENOMEM;
+
+    if (stat(path, &st) || !S_ISDIR(st.st_mode))
+        LOG_GOTO(out_free, rc = -ENXIO, "Drive '%s' not found in the "
+                 "simulated library", dev_id);
+
+    if (strlen(path) >= path_size)
+        LOG_GOTO(out_free, rc = -ENAMETOOLONG,
+                 "Path of the simulated drive '%s' is too long", dev_id);
+
+    strcpy(dev_path, path);
+
+out_free:
+    free(path);
+    return rc;
+}
+
+/** Read the model file of a drive, NULL if it has none */
+static char *sim_tape_model(const char *dev_path)
+{
+    char model[PHO_URI_MAX];
+    char *model_path;
+    int rc;
+
+    if (asprintf(&model_path, "%s/" SIM_DRIVE_MODEL, dev_path) < 0)
+        return NULL;
+
+    rc = ldm_sim_read_file(model_path, model, sizeof(model));
+    free(model_path);
+    if (rc || !model[0])
+        return NULL;
+
+    return xstrdup(model);
+}
+
+static int sim_tape_query(const char *dev_path, struct ldm_dev_state *lds)
+{
+    const char *serial;
+    struct stat st;
+
+    ENTRY;
+
+    if (stat(dev_path, &st))
+        LOG_RETURN(-errno, "Cannot stat simulated drive '%s'", dev_path);
+
+    if (!S_ISDIR(st.st_mode))
+        LOG_RETURN(-ENOTDIR, "'%s' is not a simulated drive", dev_path);
+
+    serial = strrchr(dev_path, '/');
+    serial = serial ? serial + 1 : dev_path;
+
+    lds->lds_family = PHO_RSC_TAPE;
+    lds->lds_serial = xstrdup(serial);
+    lds->lds_model = sim_tape_model(dev_path);
+    if (!lds->lds_model)
+        lds->lds_model = xstrdup_safe(ldm_sim_drive_model());
+
+    return 0;
+}
+
+/** Exported dev adapter */
+struct pho_dev_adapter_module_ops DEV_ADAPTER_SIM_TAPE_OPS = {
+    .dev_lookup = sim_tape_lookup,
+    .dev_query  = sim_tape_query,
+    .dev_load   = NULL,
+    .dev_eject  = NULL,
+};
+
+/** Dev adapter module registration entry point */
+int pho_module_register(void *module, void *context)
+{
+    struct dev_adapter_module *self = (struct dev_adapter_module *) module;
+
+    phobos_module_context_set(context);
+
+    self->desc = DEV_ADAPTER_SIM_TAPE_MODULE_DESC;
+    self->ops = &DEV_ADAPTER_SIM_TAPE_OPS;
+
+    return 0;
+}
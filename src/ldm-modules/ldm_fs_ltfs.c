@@ -214,6 +214,116 @@ static int ltfs_get_label(const char *mnt_path, char *fs_label, size_t llen,
     return 0;
 }
 
+#define LTFS_STARTBLOCK_XATTR   "user.ltfs.startblock"
+#define LTFS_PARTITION_XATTR    "user.ltfs.partition"
+#define LTFS_BLOCKSIZE_XATTR    "user.ltfs.volumeBlocksize"
+
+/** Block size of the LTFS volumes which do not expose it */
+#define LTFS_DEFAULT_BLOCKSIZE  (512 * 1024)
+
+/* Read the LTFS virtual extended attribute \p name of \p path as a string */
+static int ltfs_get_xattr_str(const char *path, const char *name, char *value,
+                              size_t size)
+{
+    struct phobos_global_context *context = phobos_context();
+    ssize_t len;
+
+    if (context->mocks.mock_ltfs.mock_getxattr == NULL)
+        context->mocks.mock_ltfs.mock_getxattr = getxattr;
+
+    memset(value, 0, size);
+    len = context->mocks.mock_ltfs.mock_getxattr(path, name, value, size - 1);
+    if (len < 0)
+        LOG_RETURN(-errno, "Failed to get '%s' of '%s'", name, path);
+
+    return 0;
+}
+
+/* Read the LTFS virtual extended attribute \p name of \p path as an integer */
+static int ltfs_get_xattr_u64(const char *path, const char *name,
+                              uint64_t *value)
+{
+    char str[32];
+    char *end;
+    int rc;
+
+    rc = ltfs_get_xattr_str(path, name, str, sizeof(str));
+    if (rc)
+        return rc;
+
+    errno = 0;
+    *value = strtoull(str, &end, 10);
+    if (errno || end == str)
+        LOG_RETURN(-EINVAL, "Invalid '%s' '%s' for '%s'", name, str, path);
+
+    return 0;
+}
+
+/* Block size of the volume mounted on \p mnt_path, an attribute of its root */
+static uint64_t ltfs_block_size(const char *mnt_path)
+{
+    struct phobos_global_context *context = phobos_context();
+    uint64_t block_size;
+    char value[32];
+    ssize_t len;
+
+    if (context->mocks.mock_ltfs.mock_getxattr == NULL)
+        context->mocks.mock_ltfs.mock_getxattr = getxattr;
+
+    len = context->mocks.mock_ltfs.mock_getxattr(mnt_path, LTFS_BLOCKSIZE_XATTR,
+                                                 value, sizeof(value) - 1);
+    if (len <= 0)
+        return LTFS_DEFAULT_BLOCKSIZE;
+
+    value[len] = '\0';
+    block_size = strtoull(value, NULL, 10);
+
+    return block_size ? : LTFS_DEFAULT_BLOCKSIZE;
+}
+
+static int ltfs_file_position(const char *mnt_path, const char *address,
+                              uint8_t *partition, uint64_t *begin,
+                              uint64_t *end)
+{
+    uint64_t block_size;
+    char value[32];
+    struct stat st;
+    char *path;
+    int rc;
+
+    if (asprintf(&path, "%s/%s", mnt_path, address) < 0)
+        return -ENOMEM;
+
+    rc = ltfs_get_xattr_u64(path, LTFS_STARTBLOCK_XATTR, begin);
+    if (rc)
+        goto out_free;
+
+    rc = ltfs_get_xattr_str(path, LTFS_PARTITION_XATTR, value, sizeof(value));
+    if (rc)
+        goto out_free;
+
+    /* LTFS names its partitions "a" (index) and "b" (data) */
+    if (value[0] < 'a' || value[0] > 'z')
+        LOG_GOTO(out_free, rc = -EINVAL, "Invalid partition '%s' for '%s'",
+                 value, path);
+
+    *partition = value[0] - 'a';
+
+    if (stat(path, &st))
+        LOG_GOTO(out_free, rc = -errno, "Failed to stat '%s'", path);
+
+    block_size = ltfs_block_size(mnt_path);
+
+    /* the file is considered contiguous from its first block */
+    *end = *begin;
+    if (st.st_size > 0)
+        *end += (st.st_size - 1) / block_size;
+
+out_free:
+    free(path);
+    return rc;
+}
+
 static int ltfs_mount(const char *dev_path, const char *mnt_path,
                       const char *fs_label, json_t **message)
 {
@@ -504,6 +614,7 @@ struct pho_fs_adapter_module_ops FS_ADAPTER_LTFS_OPS = {
     .fs_df        = ltfs_df,
     .fs_get_label = ltfs_get_label,
     .fs_release   = ltfs_release,
+    .fs_file_position = ltfs_file_position,
 };
 
 /** FS adapter module registration entry point */
@@ -0,0 +1,373 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos Local Device Manager: FS calls for simulated tapes.
+ *
+ * Replaces LTFS on the cartridges of the simulated library: the filesystem of
+ * a cartridge is its directory, which is mounted by linking the mount point to
+ * it, and its space is given by the positions of the model instead of statfs.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ldm_common.h"
+#include "ldm_sim.h"
+#include "pho_cfg.h"
+#include "pho_common.h"
+#include "pho_ldm.h"
+#include "pho_module_loader.h"
+
+#include <attr/xattr.h>
+#include <jansson.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PLUGIN_NAME     "sim"
+#define PLUGIN_MAJOR    0
+#define PLUGIN_MINOR    1
+
+static struct module_desc FS_ADAPTER_SIM_MODULE_DESC = {
+    .mod_name  = PLUGIN_NAME,
+    .mod_major = PLUGIN_MAJOR,
+    .mod_minor = PLUGIN_MINOR,
+};
+
+/** List of simulated FS configuration parameters */
+enum pho_cfg_params_fs_sim {
+    PHO_CFG_FS_SIM_tape_full_threshold,
+
+    /* Delimiters, update when modifying options */
+    PHO_CFG_FS_SIM_FIRST = PHO_CFG_FS_SIM_tape_full_threshold,
+    PHO_CFG_FS_SIM_LAST  = PHO_CFG_FS_SIM_tape_full_threshold,
+};
+
+/** Definition and default values of simulated FS configuration parameters */
+const struct pho_config_item cfg_fs_sim[] = {
+    [PHO_CFG_FS_SIM_tape_full_threshold] = {
+        .section = "tape",
+        .name = "tape_full_threshold",
+        .value = "5",
+    },
+};
+
+static char *drive_file(const char *dev_path, const char *name)
+{
+    char *path;
+
+    if (asprintf(&path, "%s/%s", dev_path, name) < 0)
+        return NULL;
+
+    return path;
+}
+
+static int sim_get_label(const char *mnt_path, char *fs_label, size_t llen,
+                         json_t **message)
+{
+    char *label_path;
+    int rc;
+
+    if (message)
+        *message = NULL;
+
+    label_path = drive_file(mnt_path, SIM_TAPE_LABEL);
+    if (!label_path)
+        return -ENOMEM;
+
+    rc = ldm_sim_read_file(label_path, fs_label, llen);
+    if (rc)
+        pho_verb("Cannot read label: '%s'", label_path);
+
+    free(label_path);
+    return rc;
+}
+
+static void sim_space(uint64_t used, struct ldm_fs_space *fs_spc)
+{
+    uint64_t capacity = ldm_sim_capacity();
+    int tape_full_threshold;
+
+    memset(fs_spc, 0, sizeof(*fs_spc));
+    fs_spc->spc_used = used;
+    fs_spc->spc_avail = used < capacity ? capacity - used : 0;
+
+    tape_full_threshold = PHO_CFG_GET_INT(cfg_fs_sim, PHO_CFG_FS_SIM,
+                                          tape_full_threshold, 5);
+    apply_full_threshold(tape_full_threshold, fs_spc);
+}
+
+static int sim_df(const char *mnt_path, struct ldm_fs_space *fs_spc,
+                  json_t **message)
+{
+    struct ldm_sim_tape_state state;
+    int rc;
+
+    if (message)
+        *message = NULL;
+
+    rc = ldm_sim_tape_state(mnt_path, &state);
+    if (rc)
+        LOG_RETURN(rc, "Cannot get the space of '%s'", mnt_path);
+
+    sim_space(state.eod, fs_spc);
+
+    return 0;
+}
+
+static int sim_format(const char *dev_path, const char *label,
+                      struct ldm_fs_space *fs_spc, json_t **message)
+{
+    struct ldm_sim_tape_state state = {0};
+    char *label_path = NULL;
+    char *tape_path;
+    int rc;
+
+    ENTRY;
+
+    if (message)
+        *message = NULL;
+
+    rc = ldm_sim_drive_tape_path(dev_path, &tape_path);
+    if (rc)
+        LOG_RETURN(rc, "No cartridge to format in '%s'", dev_path);
+
+    label_path = drive_file(tape_path, SIM_TAPE_LABEL);
+    if (!label_path)
+        GOTO(out_free, rc = -ENOMEM);
+
+    rc = ldm_sim_write_file(label_path, label);
+    if (rc)
+        goto out_free;
+
+    rc = ldm_sim_tape_reset(tape_path, &state);
+    if (rc)
+        goto out_free;
+
+    if (fs_spc)
+        sim_space(0, fs_spc);
+
+out_free:
+    free(label_path);
+    free(tape_path);
+    return rc;
+}
+
+static int sim_mounted(const char *dev_path, char *mnt_path,
+                       size_t mnt_path_size)
+{
+    char target[PATH_MAX];
+    char mount[PATH_MAX];
+    char *mount_file;
+    char *tape_path;
+    ssize_t len;
+    int rc;
+
+    ENTRY;
+
+    rc = ldm_sim_drive_tape_path(dev_path, &tape_path);
+    if (rc)
+        return rc == -ENODATA ? -ENOENT : rc;
+
+    mount_file = drive_file(dev_path, SIM_DRIVE_MOUNT);
+    if (!mount_file)
+        GOTO(out_free, rc = -ENOMEM);
+
+    rc = ldm_sim_read_file(mount_file, mount, sizeof(mount));
+    free(mount_file);
+    if (rc)
+        GOTO(out_free, rc = -ENOENT);
+
+    len = readlink(mount, target, sizeof(target) - 1);
+    if (len < 0)
+        GOTO(out_free, rc = -ENOENT);
+    target[len] = '\0';
+
+    /* the mount point must lead to the cartridge currently loaded */
+    if (strcmp(target, tape_path))
+        GOTO(out_free, rc = -ENOENT);
+
+    if (strlen(mount) >= mnt_path_size)
+        GOTO(out_free, rc = -ENAMETOOLONG);
+
+    strcpy(mnt_path, mount);
+
+out_free:
+    free(tape_path);
+    return rc;
+}
+
+/** Remove what a previous mount left on a mount point */
+static int clean_mount_point(const char *mnt_path)
+{
+    struct stat st;
+
+    if (lstat(mnt_path, &st))
+        return errno == ENOENT ? 0 : -errno;
+
+    if (S_ISLNK(st.st_mode) ? unlink(mnt_path) : rmdir(mnt_path))
+        LOG_RETURN(-errno, "Cannot clean mount point '%s'", mnt_path);
+
+    return 0;
+}
+
+static int sim_mount(const char *dev_path, const char *mnt_path,
+                     const char *fs_label, json_t **message)
+{
+    char label[PHO_LABEL_MAX_LEN + 1];
+    char *mount_file = NULL;
+    char *tape_path;
+    int rc;
+
+    ENTRY;
+
+    if (message)
+        *message = NULL;
+
+    rc = ldm_sim_drive_tape_path(dev_path, &tape_path);
+    if (rc)
+        LOG_RETURN(rc, "No cartridge to mount in '%s'", dev_path);
+
+    rc = sim_get_label(tape_path, label, sizeof(label), NULL);
+    if (rc)
+        LOG_GOTO(out_free, rc, "Cannot retrieve label of '%s'", tape_path);
+
+    if (strcmp(label, fs_label))
+        LOG_GOTO(out_free, rc = -EINVAL,
+                 "Label mismatch on '%s': expected:'%s' found:'%s'",
+                 tape_path, fs_label, label);
+
+    rc = clean_mount_point(mnt_path);
+    if (rc)
+        goto out_free;
+
+    if (symlink(tape_path, mnt_path))
+        LOG_GOTO(out_free, rc = -errno, "Cannot mount '%s' as '%s'",
+                 tape_path, mnt_path);
+
+    mount_file = drive_file(dev_path, SIM_DRIVE_MOUNT);
+    if (!mount_file)
+        GOTO(out_free, rc = -ENOMEM);
+
+    rc = ldm_sim_write_file(mount_file, mnt_path);
+    if (rc)
+        unlink(mnt_path);
+
+out_free:
+    free(mount_file);
+    free(tape_path);
+    return rc;
+}
+
+static int sim_umount(const char *dev_path, const char *mnt_path,
+                      json_t **message)
+{
+    char *mount_file;
+    int rc;
+
+    ENTRY;
+
+    if (message)
+        *message = NULL;
+
+    rc = clean_mount_point(mnt_path);
+    if (rc)
+        return rc;
+
+    mount_file = drive_file(dev_path, SIM_DRIVE_MOUNT);
+    if (!mount_file)
+        return -ENOMEM;
+
+    if (unlink(mount_file) && errno != ENOENT)
+        rc = -errno;
+
+    free(mount_file);
+    return rc;
+}
+
+static int sim_file_position(const char *mnt_path, const char *address,
+                             uint8_t *partition, uint64_t *begin,
+                             uint64_t *end)
+{
+    char value[32];
+    struct stat st;
+    uint64_t pos;
+    char *stop;
+    ssize_t len;
+    char *path;
+    int rc = 0;
+
+    path = drive_file(mnt_path, address);
+    if (!path)
+        return -ENOMEM;
+
+    len = getxattr(path, SIM_POSITION_XATTR, value, sizeof(value) - 1);
+    if (len < 0)
+        LOG_GOTO(out_free, rc = -errno, "Failed to get the position of '%s'",
+                 path);
+    value[len] = '\0';
+
+    errno = 0;
+    pos = strtoull(value, &stop, 10);
+    if (errno || stop == value)
+        LOG_GOTO(out_free, rc = -EINVAL, "Invalid position '%s' for '%s'",
+                 value, path);
+
+    if (stat(path, &st))
+        LOG_GOTO(out_free, rc = -errno, "Failed to stat '%s'", path);
+
+    *begin = pos / SIM_BLOCK_SIZE;
+    *end = st.st_size ? (pos + st.st_size - 1) / SIM_BLOCK_SIZE : *begin;
+
+    /* the data partition, as with LTFS */
+    *partition = 1;
+
+out_free:
+    free(path);
+    return rc;
+}
+
+/** Exported fs adapter */
+struct pho_fs_adapter_module_ops FS_ADAPTER_SIM_OPS = {
+    .fs_mount         = sim_mount,
+    .fs_umount        = sim_umount,
+    .fs_format        = sim_format,
+    .fs_mounted       = sim_mounted,
+    .fs_df            = sim_df,
+    .fs_get_label     = sim_get_label,
+    .fs_release       = NULL,
+    .fs_file_position = sim_file_position,
+};
+
+/** FS adapter module registration entry point */
+int pho_module_register(void *module, void *context)
+{
+    struct fs_adapter_module *self = (struct fs_adapter_module *) module;
+
+    phobos_module_context_set(context);
+
+    self->desc = FS_ADAPTER_SIM_MODULE_DESC;
+    self->ops = &FS_ADAPTER_SIM_OPS;
+
+    return 0;
+}
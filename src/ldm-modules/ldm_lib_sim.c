@@ -0,0 +1,460 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Phobos Local Device Manager: simulated tape library.
+ *
+ * Moves the cartridges of the simulated library between its slots and drives,
+ * with the timings of the model, so that the scheduling can be tested without
+ * any tape hardware.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ldm_sim.h"
+#include "pho_common.h"
+#include "pho_ldm.h"
+#include "pho_module_loader.h"
+
+#include <dirent.h>
+#include <jansson.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PLUGIN_NAME     "sim"
+#define PLUGIN_MAJOR    0
+#define PLUGIN_MINOR    1
+
+static struct module_desc LIB_ADAPTER_SIM_MODULE_DESC = {
+    .mod_name  = PLUGIN_NAME,
+    .mod_major = PLUGIN_MAJOR,
+    .mod_minor = PLUGIN_MINOR,
+};
+
+/** Address of the first drive, the drives are numbered by serial */
+#define SIM_FIRST_DRIVE_ADDR    0x100
+/** Address of the first slot, each cartridge has its own slot by label */
+#define SIM_FIRST_SLOT_ADDR     0x1000
+
+static int skip_hidden(const struct dirent *entry)
+{
+    return entry->d_name[0] != '.';
+}
+
+/** List the drives or the cartridges of the library, sorted by name */
+static int sim_list(const char *kind, struct dirent ***entries)
+{
+    char *path = ldm_sim_path(kind, "");
+    int count;
+
+    if (!path)
+        return -ENOMEM;
+
+    count = scandir(path, entries, skip_hidden, alphasort);
+    if (count < 0)
+        pho_error(count = -errno, "Cannot list '%s'", path);
+
+    free(path);
+    return count;
+}
+
+static void sim_list_free(struct dirent **entries, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        free(entries[i]);
+    free(entries);
+}
+
+/** Address of a drive or a slot, -ENOENT if it does not exist */
+static int sim_address(const char *kind, const char *name, uint64_t first_addr,
+                       uint64_t *address)
+{
+    struct dirent **entries;
+    int count;
+    int rc;
+    int i;
+
+    count = sim_list(kind, &entries);
+    if (count < 0)
+        return count;
+
+    rc = -ENOENT;
+    for (i = 0; i < count; i++) {
+        if (!strcmp(entries[i]->d_name, name)) {
+            *address = first_addr + i;
+            rc = 0;
+            break;
+        }
+    }
+
+    sim_list_free(entries, count);
+    return rc;
+}
+
+/** Tell whether a cartridge is loaded in any drive */
+static int sim_tape_is_loaded(const char *label, bool *loaded)
+{
+    char loaded_label[PHO_LABEL_MAX_LEN + 1];
+    struct dirent **entries;
+    int count;
+    int rc = 0;
+    int i;
+
+    count = sim_list("drives", &entries);
+    if (count < 0)
+        return count;
+
+    *loaded = false;
+    for (i = 0; i < count && !*loaded; i++) {
+        char *drive_path = ldm_sim_path("drives", entries[i]->d_name);
+
+        if (!drive_path)
+            GOTO(out_free, rc = -ENOMEM);
+
+        rc = ldm_sim_drive_tape(drive_path, loaded_label,
+                                sizeof(loaded_label));
+        free(drive_path);
+        if (rc == -ENODATA)
+            continue;
+        if (rc)
+            goto out_free;
+
+        *loaded = !strcmp(loaded_label, label);
+    }
+    rc = 0;
+
+out_free:
+    sim_list_free(entries, count);
+    return rc;
+}
+
+static int sim_lib_open(struct lib_handle *hdl)
+{
+    struct stat st;
+    char *path;
+    int rc = 0;
+
+    ENTRY;
+
+    path = ldm_sim_path("drives", "");
+    if (!path)
+        return -ENOMEM;
+
+    if (stat(path, &st) || !S_ISDIR(st.st_mode))
+        LOG_GOTO(out_free, rc = -ENXIO,
+                 "Simulated library '%s' has no drive directory '%s'",
+                 hdl->library, path);
+
+out_free:
+    free(path);
+    return rc;
+}
+
+static int sim_drive_lookup(struct lib_handle *hdl, const char *drive_serial,
+                            struct lib_drv_info *ldi)
+{
+    char label[PHO_LABEL_MAX_LEN + 1];
+    char *drive_path;
+    int rc;
+
+    ENTRY;
+
+    memset(ldi, 0, sizeof(*ldi));
+    ldi->ldi_addr.lia_type = MED_LOC_DRIVE;
+    ldi->ldi_first_addr = SIM_FIRST_DRIVE_ADDR;
+    rc = sim_address("drives", drive_serial, SIM_FIRST_DRIVE_ADDR,
+                     &ldi->ldi_addr.lia_addr);
+    if (rc)
+        LOG_RETURN(rc, "Drive '%s' not found in the simulated library",
+                   drive_serial);
+
+    drive_path = ldm_sim_path("drives", drive_serial);
+    if (!drive_path)
+        return -ENOMEM;
+
+    rc = ldm_sim_drive_tape(drive_path, label, sizeof(label));
+    free(drive_path);
+    if (rc == -ENODATA)
+        return 0;
+    if (rc)
+        return rc;
+
+    ldi->ldi_full = true;
+    ldi->ldi_medium_id.family = PHO_RSC_TAPE;
+    pho_id_name_set(&ldi->ldi_medium_id, label, hdl->library);
+
+    return 0;
+}
+
+static json_t *sim_element(const char *type, uint64_t address, bool full,
+                           const char *volume)
+{
+    json_t *element;
+
+    element = json_pack("{s:s, s:I, s:b}", "type", type, "address",
+                        (json_int_t)address, "full", full);
+    if (element && volume)
+        json_object_set_new(element, "volume", json_string(volume));
+
+    return element;
+}
+
+static int sim_lib_scan(struct lib_handle *hdl, bool refresh,
+                        json_t **lib_data, json_t *message)
+{
+    char label[PHO_LABEL_MAX_LEN + 1];
+    struct dirent **entries;
+    int count;
+    int rc = 0;
+    int i;
+
+    (void) hdl;
+    (void) refresh;
+    (void) message;
+
+    *lib_data = json_array();
+    if (!*lib_data)
+        return -ENOMEM;
+
+    count = sim_list("drives", &entries);
+    if (count < 0)
+        GOTO(out_err, rc = count);
+
+    for (i = 0; i < count; i++) {
+        char *drive_path = ldm_sim_path("drives", entries[i]->d_name);
+        json_t *element;
+
+        if (!drive_path)
+            GOTO(out_free, rc = -ENOMEM);
+
+        rc = ldm_sim_drive_tape(drive_path, label, sizeof(label));
+        free(drive_path);
+        if (rc && rc != -ENODATA)
+            goto out_free;
+
+        element = sim_element("drive", SIM_FIRST_DRIVE_ADDR + i, !rc,
+                              rc ? NULL : label);
+        if (!element)
+            GOTO(out_free, rc = -ENOMEM);
+
+        json_object_set_new(element, "device_id",
+                            json_string(entries[i]->d_name));
+        json_array_append_new(*lib_data, element);
+    }
+    sim_list_free(entries, count);
+
+    count = sim_list("tapes", &entries);
+    if (count < 0)
+        GOTO(out_err, rc = count);
+
+    for (i = 0; i < count; i++) {
+        json_t *element;
+        bool loaded;
+
+        rc = sim_tape_is_loaded(entries[i]->d_name, &loaded);
+        if (rc)
+            goto out_free;
+
+        element = sim_element("slot", SIM_FIRST_SLOT_ADDR + i, !loaded,
+                              loaded ? NULL : entries[i]->d_name);
+        if (!element)
+            GOTO(out_free, rc = -ENOMEM);
+
+        json_array_append_new(*lib_data, element);
+    }
+    rc = 0;
+
+out_free:
+    sim_list_free(entries, count);
+out_err:
+    if (rc) {
+        json_decref(*lib_data);
+        *lib_data = NULL;
+    }
+    return rc;
+}
+
+static int sim_lib_load(struct lib_handle *hdl, const char *drive_serial,
+                        const char *tape_label)
+{
+    char label[PHO_LABEL_MAX_LEN + 1];
+    char *drive_path = NULL;
+    char *tape_path = NULL;
+    char *link_path = NULL;
+    struct stat st;
+    bool loaded;
+    int arm_fd;
+    int rc;
+
+    ENTRY;
+
+    drive_path = ldm_sim_path("drives", drive_serial);
+    tape_path = ldm_sim_path("tapes", tape_label);
+    if (!drive_path || !tape_path ||
+        asprintf(&link_path, "%s/" SIM_DRIVE_TAPE, drive_path) < 0)
+        GOTO(out_free, rc = -ENOMEM);
+
+    if (stat(tape_path, &st) || !S_ISDIR(st.st_mode))
+        LOG_GOTO(out_free, rc = -ENOENT,
+                 "Cartridge '%s' not found in the simulated library",
+                 tape_label);
+
+    arm_fd = ldm_sim_arm_lock();
+    if (arm_fd < 0)
+        GOTO(out_free, rc = arm_fd);
+
+    rc = ldm_sim_drive_tape(drive_path, label, sizeof(label));
+    if (!rc) {
+        if (strcmp(label, tape_label))
+            LOG_GOTO(out_unlock, rc = -EBUSY,
+                     "Cannot load '%s', drive '%s' already holds '%s'",
+                     tape_label, drive_serial, label);
+        /* already loaded */
+        GOTO(out_unlock, rc = 0);
+    }
+    if (rc != -ENODATA)
+        goto out_unlock;
+
+    rc = sim_tape_is_loaded(tape_label, &loaded);
+    if (rc)
+        goto out_unlock;
+    if (loaded)
+        LOG_GOTO(out_unlock, rc = -EBUSY,
+                 "Cannot load '%s' into '%s', it is in another drive",
+                 tape_label, drive_serial);
+
+    ldm_sim_move_delay();
+    if (symlink(tape_path, link_path))
+        LOG_GOTO(out_unlock, rc = -errno, "Cannot load '%s' into '%s'",
+                 tape_label, drive_serial);
+
+    ldm_sim_arm_unlock(arm_fd);
+    arm_fd = -1;
+
+    /* no locate on load, the cartridges are rewound before being unloaded */
+    ldm_sim_load_delay();
+    pho_debug("Successful load of '%s' into '%s'", tape_label, drive_serial);
+
+out_unlock:
+    if (arm_fd >= 0)
+        ldm_sim_arm_unlock(arm_fd);
+out_free:
+    free(link_path);
+    free(tape_path);
+    free(drive_path);
+    return rc;
+}
+
+static int sim_lib_unload(struct lib_handle *hdl, const char *drive_serial,
+                          const char *tape_label)
+{
+    char label[PHO_LABEL_MAX_LEN + 1];
+    char *drive_path = NULL;
+    char *tape_path = NULL;
+    char *link_path = NULL;
+    int arm_fd;
+    int rc;
+
+    ENTRY;
+
+    drive_path = ldm_sim_path("drives", drive_serial);
+    if (!drive_path ||
+        asprintf(&link_path, "%s/" SIM_DRIVE_TAPE, drive_path) < 0)
+        GOTO(out_free, rc = -ENOMEM);
+
+    rc = ldm_sim_drive_tape(drive_path, label, sizeof(label));
+    if (rc == -ENODATA)
+        LOG_GOTO(out_free, rc = -EINVAL, "Cannot unload empty drive '%s'",
+                 drive_serial);
+    if (rc)
+        goto out_free;
+
+    if (tape_label && strcmp(label, tape_label))
+        LOG_GOTO(out_free, rc = -EINVAL,
+                 "Cannot unload '%s', drive '%s' holds '%s'",
+                 tape_label, drive_serial, label);
+
+    tape_path = ldm_sim_path("tapes", label);
+    if (!tape_path)
+        GOTO(out_free, rc = -ENOMEM);
+
+    rc = ldm_sim_tape_locate(tape_path, 0, NULL);
+    if (rc)
+        goto out_free;
+
+    ldm_sim_unload_delay();
+
+    arm_fd = ldm_sim_arm_lock();
+    if (arm_fd < 0)
+        GOTO(out_free, rc = arm_fd);
+
+    ldm_sim_move_delay();
+    if (unlink(link_path))
+        rc = -errno;
+    ldm_sim_arm_unlock(arm_fd);
+    if (rc)
+        LOG_GOTO(out_free, rc, "Cannot unload '%s' from '%s'", label,
+                 drive_serial);
+
+    pho_debug("Successful unload of '%s' from '%s'", label, drive_serial);
+
+out_free:
+    free(tape_path);
+    free(link_path);
+    free(drive_path);
+    return rc;
+}
+
+static int sim_lib_ping(struct lib_handle *hdl, bool *library_is_up)
+{
+    *library_is_up = sim_lib_open(hdl) == 0;
+    return 0;
+}
+
+/** Exported library adapter */
+static struct pho_lib_adapter_module_ops LIB_ADAPTER_SIM_OPS = {
+    .lib_open         = sim_lib_open,
+    .lib_close        = NULL,
+    .lib_drive_lookup = sim_drive_lookup,
+    .lib_scan         = sim_lib_scan,
+    .lib_load         = sim_lib_load,
+    .lib_unload       = sim_lib_unload,
+    .lib_refresh      = NULL,
+    .lib_ping         = sim_lib_ping,
+    .lib_stats        = NULL,
+};
+
+/** Lib adapter module registration entry point */
+int pho_module_register(void *module, void *context)
+{
+    struct lib_adapter_module *self = (struct lib_adapter_module *) module;
+
+    phobos_module_context_set(context);
+
+    self->desc = LIB_ADAPTER_SIM_MODULE_DESC;
+    self->ops = &LIB_ADAPTER_SIM_OPS;
+
+    return 0;
+}
@@ -0,0 +1,473 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Model of the simulated tape library.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ldm_sim.h"
+#include "pho_cfg.h"
+#include "pho_common.h"
+#include "pho_types.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <time.h>
+#include <unistd.h>
+
+/** List of the simulated library configuration parameters */
+enum pho_cfg_params_tape_sim {
+    PHO_CFG_TAPE_SIM_root,
+    PHO_CFG_TAPE_SIM_drive_model,
+    PHO_CFG_TAPE_SIM_capacity_mb,
+    PHO_CFG_TAPE_SIM_bandwidth_mb,
+    PHO_CFG_TAPE_SIM_move_ms,
+    PHO_CFG_TAPE_SIM_load_ms,
+    PHO_CFG_TAPE_SIM_unload_ms,
+    PHO_CFG_TAPE_SIM_locate_min_ms,
+    PHO_CFG_TAPE_SIM_locate_full_ms,
+    PHO_CFG_TAPE_SIM_speedup,
+
+    /* Delimiters, update when modifying options */
+    PHO_CFG_TAPE_SIM_FIRST = PHO_CFG_TAPE_SIM_root,
+    PHO_CFG_TAPE_SIM_LAST  = PHO_CFG_TAPE_SIM_speedup,
+};
+
+/**
+ * Definition and default values of the simulated library configuration
+ * parameters, the default timings are the ones of a LTO6 library.
+ */
+const struct pho_config_item cfg_tape_sim[] = {
+    [PHO_CFG_TAPE_SIM_root] = {
+        .section = "tape_sim",
+        .name    = "root",
+        .value   = "/var/lib/phobos/tape_sim",
+    },
+    [PHO_CFG_TAPE_SIM_drive_model] = {
+        .section = "tape_sim",
+        .name    = "drive_model",
+        .value   = "ULTRIUM-TD6",
+    },
+    [PHO_CFG_TAPE_SIM_capacity_mb] = {
+        .section = "tape_sim",
+        .name    = "capacity_mb",
+        .value   = "2500000",
+    },
+    [PHO_CFG_TAPE_SIM_bandwidth_mb] = {
+        .section = "tape_sim",
+        .name    = "bandwidth_mb",
+        .value   = "160",
+    },
+    [PHO_CFG_TAPE_SIM_move_ms] = {
+        .section = "tape_sim",
+        .name    = "move_ms",
+        .value   = "8000",
+    },
+    [PHO_CFG_TAPE_SIM_load_ms] = {
+        .section = "tape_sim",
+        .name    = "load_ms",
+        .value   = "15000",
+    },
+    [PHO_CFG_TAPE_SIM_unload_ms] = {
+        .section = "tape_sim",
+        .name    = "unload_ms",
+        .value   = "20000",
+    },
+    [PHO_CFG_TAPE_SIM_locate_min_ms] = {
+        .section = "tape_sim",
+        .name    = "locate_min_ms",
+        .value   = "1000",
+    },
+    [PHO_CFG_TAPE_SIM_locate_full_ms] = {
+        .section = "tape_sim",
+        .name    = "locate_full_ms",
+        .value   = "90000",
+    },
+    [PHO_CFG_TAPE_SIM_speedup] = {
+        .section = "tape_sim",
+        .name    = "speedup",
+        .value   = "1",
+    },
+};
+
+#define SIM_GET_INT(_name, _default)                                     \
+    PHO_CFG_GET_INT(cfg_tape_sim, PHO_CFG_TAPE_SIM, _name, _default)
+
+/** Sleep for \p ms milliseconds of simulated time */
+static void sim_delay(double ms)
+{
+    int speedup = SIM_GET_INT(speedup, 1);
+    struct timespec delay;
+
+    if (speedup < 1)
+        speedup = 1;
+
+    ms /= speedup;
+    if (ms <= 0.)
+        return;
+
+    delay.tv_sec = ms / 1000;
+    delay.tv_nsec = (ms - delay.tv_sec * 1000.) * 1000000.;
+    while (nanosleep(&delay, &delay) && errno == EINTR)
+        ;
+}
+
+char *ldm_sim_path(const char *kind, const char *name)
+{
+    const char *root = PHO_CFG_GET(cfg_tape_sim, PHO_CFG_TAPE_SIM, root);
+    char *path;
+
+    if (!root)
+        return NULL;
+
+    if (asprintf(&path, "%s/%s/%s", root, kind, name) < 0)
+        return NULL;
+
+    return path;
+}
+
+int ldm_sim_read_file(const char *path, char *buf, size_t size)
+{
+    ssize_t len;
+    int fd;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -errno;
+
+    len = read(fd, buf, size - 1);
+    if (len < 0) {
+        int rc = -errno;
+
+        close(fd);
+        LOG_RETURN(rc, "Cannot read '%s'", path);
+    }
+    close(fd);
+
+    buf[len] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+
+    return 0;
+}
+
+int ldm_sim_write_file(const char *path, const char *content)
+{
+    size_t len = strlen(content);
+    int rc = 0;
+    int fd;
+
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0660);
+    if (fd < 0)
+        LOG_RETURN(-errno, "Cannot open '%s'", path);
+
+    errno = 0;
+    if (write(fd, content, len) != len)
+        rc = errno ? -errno : -EIO;
+    if (close(fd) && !rc)
+        rc = -errno;
+    if (rc)
+        LOG_RETURN(rc, "Cannot write '%s'", path);
+
+    return 0;
+}
+
+int ldm_sim_drive_tape(const char *drive_path, char *label, size_t size)
+{
+    char target[PATH_MAX];
+    char *link_path;
+    char *base;
+    ssize_t len;
+    int rc = 0;
+
+    if (asprintf(&link_path, "%s/" SIM_DRIVE_TAPE, drive_path) < 0)
+        return -ENOMEM;
+
+    len = readlink(link_path, target, sizeof(target) - 1);
+    if (len < 0) {
+        rc = errno == ENOENT ? -ENODATA : -errno;
+        if (rc != -ENODATA)
+            pho_error(rc, "Cannot read the cartridge of '%s'", drive_path);
+        goto out_free;
+    }
+    target[len] = '\0';
+
+    base = strrchr(target, '/');
+    base = base ? base + 1 : target;
+    if (strlen(base) >= size)
+        LOG_GOTO(out_free, rc = -ENAMETOOLONG,
+                 "Label of the cartridge in '%s' is too long", drive_path);
+
+    strcpy(label, base);
+
+out_free:
+    free(link_path);
+    return rc;
+}
+
+int ldm_sim_drive_tape_path(const char *drive_path, char **tape_path)
+{
+    char label[PHO_LABEL_MAX_LEN + 1];
+    int rc;
+
+    rc = ldm_sim_drive_tape(drive_path, label, sizeof(label));
+    if (rc)
+        return rc;
+
+    *tape_path = ldm_sim_path("tapes", label);
+    if (!*tape_path)
+        return -ENOMEM;
+
+    return 0;
+}
+
+uint64_t ldm_sim_capacity(void)
+{
+    return (uint64_t)SIM_GET_INT(capacity_mb, 2500000) * 1000000;
+}
+
+const char *ldm_sim_drive_model(void)
+{
+    return PHO_CFG_GET(cfg_tape_sim, PHO_CFG_TAPE_SIM, drive_model);
+}
+
+/** Open and lock a file of the simulated library */
+static int sim_lock(const char *path)
+{
+    int fd;
+
+    fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0660);
+    if (fd < 0)
+        LOG_RETURN(-errno, "Cannot open '%s'", path);
+
+    while (flock(fd, LOCK_EX)) {
+        int rc = -errno;
+
+        if (rc == -EINTR)
+            continue;
+
+        close(fd);
+        LOG_RETURN(rc, "Cannot lock '%s'", path);
+    }
+
+    return fd;
+}
+
+/** Unlock and close a file locked by sim_lock */
+static void sim_unlock(int fd)
+{
+    flock(fd, LOCK_UN);
+    close(fd);
+}
+
+int ldm_sim_arm_lock(void)
+{
+    const char *root = PHO_CFG_GET(cfg_tape_sim, PHO_CFG_TAPE_SIM, root);
+    char *arm_path;
+    int fd;
+
+    if (!root || asprintf(&arm_path, "%s/.arm", root) < 0)
+        return -ENOMEM;
+
+    fd = sim_lock(arm_path);
+    free(arm_path);
+
+    return fd;
+}
+
+void ldm_sim_arm_unlock(int fd)
+{
+    sim_unlock(fd);
+}
+
+void ldm_sim_move_delay(void)
+{
+    sim_delay(SIM_GET_INT(move_ms, 8000));
+}
+
+void ldm_sim_load_delay(void)
+{
+    sim_delay(SIM_GET_INT(load_ms, 15000));
+}
+
+void ldm_sim_unload_delay(void)
+{
+    sim_delay(SIM_GET_INT(unload_ms, 20000));
+}
+
+static int state_read(int fd, struct ldm_sim_tape_state *state)
+{
+    char buf[64];
+    ssize_t len;
+
+    len = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (len < 0)
+        LOG_RETURN(-errno, "Cannot read the state of a cartridge");
+
+    buf[len] = '\0';
+    memset(state, 0, sizeof(*state));
+    /* a new cartridge has an empty state */
+    if (len > 0 &&
+        sscanf(buf, "%" SCNu64 " %" SCNu64, &state->head, &state->eod) != 2)
+        LOG_RETURN(-EINVAL, "Invalid cartridge state '%s'", buf);
+
+    return 0;
+}
+
+static int state_write(int fd, const struct ldm_sim_tape_state *state)
+{
+    char buf[64];
+    int len;
+
+    len = snprintf(buf, sizeof(buf), "%" PRIu64 " %" PRIu64 "\n",
+                   state->head, state->eod);
+    if (pwrite(fd, buf, len, 0) != len || ftruncate(fd, len))
+        LOG_RETURN(-errno, "Cannot write the state of a cartridge");
+
+    return 0;
+}
+
+/** Open and lock the state of a cartridge */
+static int state_lock(const char *tape_path)
+{
+    char *state_path;
+    int fd;
+
+    if (asprintf(&state_path, "%s/" SIM_TAPE_STATE, tape_path) < 0)
+        return -ENOMEM;
+
+    fd = sim_lock(state_path);
+    free(state_path);
+
+    return fd;
+}
+
+int ldm_sim_tape_state(const char *tape_path, struct ldm_sim_tape_state *state)
+{
+    int fd;
+    int rc;
+
+    fd = state_lock(tape_path);
+    if (fd < 0)
+        return fd;
+
+    rc = state_read(fd, state);
+    sim_unlock(fd);
+
+    return rc;
+}
+
+int ldm_sim_tape_reset(const char *tape_path,
+                       const struct ldm_sim_tape_state *state)
+{
+    int fd;
+    int rc;
+
+    fd = state_lock(tape_path);
+    if (fd < 0)
+        return fd;
+
+    rc = state_write(fd, state);
+    sim_unlock(fd);
+
+    return rc;
+}
+
+/* The cartridge stays locked while the drive is busy, which serializes the
+ * I/Os of the processes sharing it.
+ */
+int ldm_sim_tape_locate(const char *tape_path, int64_t position,
+                        uint64_t *located)
+{
+    struct ldm_sim_tape_state state;
+    uint64_t distance;
+    int fd;
+    int rc;
+
+    fd = state_lock(tape_path);
+    if (fd < 0)
+        return fd;
+
+    rc = state_read(fd, &state);
+    if (rc)
+        goto unlock;
+
+    if (position < 0)
+        position = state.eod;
+
+    distance = state.head > (uint64_t)position ? state.head - position :
+                                                 position - state.head;
+    if (distance)
+        sim_delay(SIM_GET_INT(locate_min_ms, 1000) +
+                  (double)SIM_GET_INT(locate_full_ms, 90000) * distance /
+                  ldm_sim_capacity());
+
+    state.head = position;
+    rc = state_write(fd, &state);
+    if (!rc && located)
+        *located = position;
+
+unlock:
+    sim_unlock(fd);
+    return rc;
+}
+
+int ldm_sim_tape_stream(const char *tape_path, size_t size, bool write)
+{
+    struct ldm_sim_tape_state state;
+    int bandwidth_mb;
+    int fd;
+    int rc;
+
+    fd = state_lock(tape_path);
+    if (fd < 0)
+        return fd;
+
+    rc = state_read(fd, &state);
+    if (rc)
+        goto unlock;
+
+    if (write && state.head + size > ldm_sim_capacity())
+        LOG_GOTO(unlock, rc = -ENOSPC, "Simulated cartridge '%s' is full",
+                 tape_path);
+
+    bandwidth_mb = SIM_GET_INT(bandwidth_mb, 160);
+    if (bandwidth_mb > 0)
+        sim_delay(size / (bandwidth_mb * 1000.));
+
+    state.head += size;
+    if (write)
+        state.eod = state.head;
+
+    rc = state_write(fd, &state);
+
+unlock:
+    sim_unlock(fd);
+    return rc;
+}
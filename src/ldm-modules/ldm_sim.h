@@ -0,0 +1,196 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Model of the simulated tape library, shared by the "sim" adapters.
+ *
+ * The simulated library lives in the directory "[tape_sim] root":
+ *   - drives/<serial>/ is a drive, "tape" in it is a symbolic link to the
+ *     cartridge it holds;
+ *   - tapes/<label>/ is a cartridge, its files are the files of the mounted
+ *     filesystem and ".sim_state" holds its head and end of data positions.
+ *
+ * All the processes handling the library share these directories. The arm of
+ * the library and each cartridge are locked while they are busy, and every
+ * operation sleeps for the time the timing model gives it.
+ */
+#ifndef _LDM_SIM_H
+#define _LDM_SIM_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Name of the link to the cartridge loaded in a drive */
+#define SIM_DRIVE_TAPE      "tape"
+/** Name of the file holding the mount point of a drive */
+#define SIM_DRIVE_MOUNT     "mount"
+/** Name of the file holding the drive model, "[tape_sim] drive_model" if it
+ * does not exist
+ */
+#define SIM_DRIVE_MODEL     "model"
+/** Name of the filesystem label of a cartridge */
+#define SIM_TAPE_LABEL      ".phobos_tape_label"
+/** Name of the head and end of data positions of a cartridge */
+#define SIM_TAPE_STATE      ".sim_state"
+/** Extended attribute holding the position of a file on its cartridge */
+#define SIM_POSITION_XATTR  "user.sim_position"
+/** Size of the blocks used to report the file positions */
+#define SIM_BLOCK_SIZE      (512 * 1024)
+
+/** Positions of a cartridge, in bytes from its beginning */
+struct ldm_sim_tape_state {
+    uint64_t head;  /**< position of the head */
+    uint64_t eod;   /**< end of the written data */
+};
+
+/**
+ * Build the path of a drive or a cartridge of the simulated library.
+ *
+ * @param[in]  kind  "drives" or "tapes"
+ * @param[in]  name  Serial of the drive or label of the cartridge
+ *
+ * @return the path to free, NULL on allocation failure
+ */
+char *ldm_sim_path(const char *kind, const char *name);
+
+/**
+ * Read a one line file of the simulated library, without its trailing newline.
+ *
+ * @param[in]  path  Path of the file
+ * @param[out] buf   Content of the file
+ * @param[in]  size  Size of \p buf
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int ldm_sim_read_file(const char *path, char *buf, size_t size);
+
+/**
+ * Replace the content of a file of the simulated library.
+ *
+ * @param[in]  path     Path of the file
+ * @param[in]  content  Content of the file
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int ldm_sim_write_file(const char *path, const char *content);
+
+/**
+ * Get the label of the cartridge loaded in a drive.
+ *
+ * @param[in]  drive_path  Path of the drive
+ * @param[out] label       Label of the cartridge
+ * @param[in]  size        Size of \p label
+ *
+ * @return 0 on success, -ENODATA if the drive is empty, negative error code on
+ *         failure
+ */
+int ldm_sim_drive_tape(const char *drive_path, char *label, size_t size);
+
+/**
+ * Get the path of the cartridge loaded in a drive.
+ *
+ * @param[in]  drive_path  Path of the drive
+ * @param[out] tape_path   Path of the cartridge, to free
+ *
+ * @return 0 on success, -ENODATA if the drive is empty, negative error code on
+ *         failure
+ */
+int ldm_sim_drive_tape_path(const char *drive_path, char **tape_path);
+
+/** Capacity of the cartridges, in bytes */
+uint64_t ldm_sim_capacity(void);
+
+/** Model of the drives without a model file */
+const char *ldm_sim_drive_model(void);
+
+/**
+ * Lock the arm of the library, which serializes the moves of all the
+ * processes.
+ *
+ * @return the descriptor to give to ldm_sim_arm_unlock, negative error code on
+ *         failure
+ */
+int ldm_sim_arm_lock(void);
+
+/** Unlock the arm of the library */
+void ldm_sim_arm_unlock(int fd);
+
+/** Wait for the arm to move a cartridge between a slot and a drive */
+void ldm_sim_move_delay(void);
+
+/** Wait for a drive to thread a cartridge */
+void ldm_sim_load_delay(void);
+
+/** Wait for a drive to eject a cartridge */
+void ldm_sim_unload_delay(void);
+
+/**
+ * Get the positions of a cartridge.
+ *
+ * @param[in]  tape_path  Path of the cartridge
+ * @param[out] state      Positions
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int ldm_sim_tape_state(const char *tape_path, struct ldm_sim_tape_state *state);
+
+/**
+ * Set the positions of a cartridge, without waiting.
+ *
+ * @param[in]  tape_path  Path of the cartridge
+ * @param[in]  state      Positions
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int ldm_sim_tape_reset(const char *tape_path,
+                       const struct ldm_sim_tape_state *state);
+
+/**
+ * Move the head of a cartridge, waiting for the locate time which grows with
+ * the distance to cover.
+ *
+ * @param[in]  tape_path  Path of the cartridge
+ * @param[in]  position   Target position, its end of data if negative
+ * @param[out] located    Target position, may be NULL
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int ldm_sim_tape_locate(const char *tape_path, int64_t position,
+                        uint64_t *located);
+
+/**
+ * Read or write at the head of a cartridge, waiting for the streaming time.
+ *
+ * @param[in]  tape_path  Path of the cartridge
+ * @param[in]  size       Number of bytes
+ * @param[in]  write      True for a write, which moves the end of data
+ *
+ * @return 0 on success, -ENOSPC if a write goes beyond the capacity, negative
+ *         error code on failure
+ */
+int ldm_sim_tape_stream(const char *tape_path, size_t size, bool write);
+
+#endif
@@ -49,8 +49,9 @@ int get_lib_adapter(enum lib_type lib_type, struct lib_adapter_module **lib)
                          (void **)lib);
         break;
     case PHO_LIB_SCSI:
-        rc = load_module("lib_adapter_scsi", sizeof(**lib), phobos_context(),
-                         (void **)lib);
+        rc = load_module(cfg_tape_backend_is_sim() ? "lib_adapter_sim" :
+                                                     "lib_adapter_scsi",
+                         sizeof(**lib), phobos_context(), (void **)lib);
         break;
     case PHO_LIB_RADOS:
         rc = load_module("lib_adapter_rados", sizeof(**lib), phobos_context(),
@@ -73,8 +74,9 @@ int get_dev_adapter(enum rsc_family dev_family, struct dev_adapter_module **dev)
                          (void **)dev);
         break;
     case PHO_RSC_TAPE:
-        rc = load_module("dev_adapter_scsi_tape", sizeof(**dev),
-                         phobos_context(), (void **)dev);
+        rc = load_module(cfg_tape_backend_is_sim() ? "dev_adapter_sim_tape" :
+                                                     "dev_adapter_scsi_tape",
+                         sizeof(**dev), phobos_context(), (void **)dev);
         break;
     case PHO_RSC_RADOS_POOL:
         rc = load_module("dev_adapter_rados_pool", sizeof(**dev),
@@ -87,6 +89,43 @@ int get_dev_adapter(enum rsc_family dev_family, struct dev_adapter_module **dev)
     return rc;
 }
 
+static int rao_segment_cmp(const void *_a, const void *_b)
+{
+    const struct ldm_rao_segment *a = _a;
+    const struct ldm_rao_segment *b = _b;
+
+    if (a->partition != b->partition)
+        return a->partition < b->partition ? -1 : 1;
+    if (a->begin != b->begin)
+        return a->begin < b->begin ? -1 : 1;
+
+    return 0;
+}
+
+int ldm_rao_order(const struct dev_adapter_module *dev, const char *dev_path,
+                  struct ldm_rao_segment *segments, size_t count)
+{
+    int rc;
+
+    if (count < 2)
+        return 0;
+
+    rc = ldm_dev_rao(dev, dev_path, segments, count);
+    if (!rc)
+        return 0;
+
+    if (rc == -ENOTSUP)
+        pho_debug("'%s' does not support RAO, sorting %zu segments by "
+                  "position", dev_path, count);
+    else
+        pho_warn("Failed to get the RAO of %zu segments from '%s' (rc=%d), "
+                 "sorting them by position", count, dev_path, rc);
+
+    qsort(segments, count, sizeof(*segments), rao_segment_cmp);
+
+    return rc;
+}
+
 void ldm_dev_state_fini(struct ldm_dev_state *lds)
 {
     free(lds->lds_model);
@@ -105,8 +144,9 @@ int get_fs_adapter(enum fs_type fs_type, struct fs_adapter_module **fsa)
                          (void **)fsa);
         break;
     case PHO_FS_LTFS:
-        rc = load_module("fs_adapter_ltfs", sizeof(**fsa), phobos_context(),
-                         (void **)fsa);
+        rc = load_module(cfg_tape_backend_is_sim() ? "fs_adapter_sim" :
+                                                     "fs_adapter_ltfs",
+                         sizeof(**fsa), phobos_context(), (void **)fsa);
         break;
     case PHO_FS_RADOS:
         rc = load_module("fs_adapter_rados", sizeof(**fsa), phobos_context(),
@@ -61,6 +61,16 @@ struct pho_config_item cfg_io_sched[] = {
         .name    = "ordered_grouped_read",
         .value   = "true",
     },
+    [PHO_IO_SCHED_grouped_read_elevator] = {
+        .section = "io_sched",
+        .name    = "grouped_read_elevator",
+        .value   = "false",
+    },
+    [PHO_IO_SCHED_grouped_read_rao] = {
+        .section = "io_sched",
+        .name    = "grouped_read_rao",
+        .value   = "false",
+    },
 };
 
 static int io_sched_init(struct io_sched_handle *io_sched_hdl)
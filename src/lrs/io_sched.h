@@ -39,6 +39,8 @@
 #include "pho_srl_lrs.h"
 #include "lrs_device.h"
 
+struct lrs_media_catalog;
+
 extern struct pho_config_item cfg_io_sched[];
 
 /** List of I/O scheduler configuration parameters */
@@ -51,6 +53,8 @@ enum pho_cfg_params_io_sched {
     PHO_IO_SCHED_format_algo,
     PHO_IO_SCHED_dispatch_algo,
     PHO_IO_SCHED_ordered_grouped_read,
+    PHO_IO_SCHED_grouped_read_elevator,
+    PHO_IO_SCHED_grouped_read_rao,
 
     PHO_IO_SCHED_LAST
 };
@@ -251,7 +255,8 @@ struct io_sched_handle {
     struct io_scheduler write;
     struct io_scheduler format;
     struct lock_handle *lock_handle;
-    struct tsqueue     *response_queue; /* reference to the response queue */
+    struct lrs_media_catalog *catalog;  /* reference to lrs_sched::catalog */
+    struct mpsc_queue  *response_queue; /* reference to the response queue */
     struct io_stats     io_stats;
     GPtrArray          *global_device_list; /* reference to
                                              * lrs_sched::devices::ldh_devices
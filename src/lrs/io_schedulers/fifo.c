@@ -381,6 +381,17 @@ static int find_write_device(struct io_scheduler *io_sched,
     tags.strings = wreq->media[index]->tags;
     size = wreq->media[index]->size;
 
+    /* 0) is the medium of this write stream free and with enough room? */
+    if (!wreq->media[index]->empty_medium &&
+        targeted_grouping == wreq->grouping) {
+        rc = write_stream_dev_picker(io_sched->devices,
+                                     io_sched->io_sched_hdl->lock_handle->dss,
+                                     wreq->library, targeted_grouping, size,
+                                     &tags, dev);
+        if (rc || *dev)
+            return rc;
+    }
+
 search_again:
     need_new_grouping = false;
     /* 1a) is there a mounted filesystem with enough room? */
@@ -426,7 +437,8 @@ search_again:
                                (*medium)->rsc.id.name,
                                (*medium)->rsc.id.library, &sched_ready);
     if (*dev && sched_ready) {
-        /* Update the device's medium with *medium which is fresh from the DSS.
+        /* Update the device's medium with *medium which is fresh from the
+         * media catalog.
          */
         atomic_dev_medium_swap(*dev, *medium);
         if (!((*dev)->ld_io_request_type & IO_REQ_WRITE)) {
@@ -27,6 +27,7 @@
 #include "lrs_utils.h"
 #include "pho_cfg.h"
 #include "pho_common.h"
+#include "pho_ldm.h"
 #include "pho_types.h"
 #include "schedulers.h"
 
@@ -65,6 +66,24 @@
  * On remove_request, the request is removed from all the queues it belongs to.
  * If any of these queues are empty, it is removed from its associated device
  * and freed.
+ *
+ * With the "grouped_read_elevator" option, each queue is ordered by the
+ * position on the medium of the extent to read, as given by the client,
+ * starting from the position of the last request served on the medium. The
+ * requests ahead of it are served in increasing position, then the sweep wraps
+ * back to the requests behind it. The queues to allocate to a device are then
+ * chosen by decreasing number of requests served per unit of their estimated
+ * total service time, which accounts for the medium load and the wrap of the
+ * sweep.
+ *
+ * With the "grouped_read_rao" option on top of it, once the medium of a queue
+ * is mounted, the pending requests of the queue are ordered as a batch by the
+ * Recommended Access Order of the drive, or by the block position of their
+ * extent when the drive does not support it. The requests pushed while a batch
+ * is served make the next batch. The batch is ordered by the device thread,
+ * which owns the mounted filesystem and the drive: the scheduler submits it
+ * and applies the order on a later call, serving the queue by the elevator
+ * order in the meantime.
  */
 
 struct request_queue;
@@ -77,6 +96,19 @@ struct list_pair {
 struct queue_element {
     struct req_container *reqc;  /* reference to the corresponding req_container
                                   */
+    uint64_t              position;
+                                 /* position of the extent to read on the medium
+                                  * of the queue, 0 if unknown
+                                  */
+    const char           *address;
+                                 /* address of the extent to read on the medium
+                                  * of the queue, NULL if unknown
+                                  */
+    bool                  ranked;
+                                 /* whether rank is set */
+    size_t                rank;  /* index of the request in the RAO batch of
+                                  * the queue
+                                  */
     struct request_queue *queue; /* queue this element belongs to */
     struct list_pair     *pair;  /* pointer to a pair of lists shared between
                                   * each queue_element of the same request.
@@ -100,6 +132,25 @@ struct request_queue {
                             * It is copied into rwalloc_params::media in
                             * grouped_get_device_medium_pair.
                             */
+    uint64_t           head_position;
+                           /* position of the last request served on the
+                            * medium, where the elevator sweep resumes
+                            */
+    size_t             n_ranked;
+                           /* number of requests of the current RAO batch
+                            * left in the queue
+                            */
+    bool               rao_pending;
+                           /* requests were pushed since the last RAO batch
+                            */
+    struct lrs_dev    *rao_dev;
+                           /* device ordering the RAO batch of this queue,
+                            * NULL if none is submitted
+                            */
+    GPtrArray         *rao_elems;
+                           /* elements of the submitted RAO batch, by index
+                            * in the batch, NULL once removed from the queue
+                            */
 };
 
 struct device {
@@ -135,6 +186,112 @@ struct grouped_data {
 #define glist_foreach(var, list) \
     for (GList *var = list; var; var = var->next)
 
+/* Read the boolean option \p param of the I/O scheduler section of \p family,
+ * caching its value in \p already_set and \p res which are indexed by family.
+ */
+static bool cfg_grouped_read_bool(enum pho_cfg_params_io_sched param,
+                                  enum rsc_family family, bool *already_set,
+                                  bool *res)
+{
+    struct pho_config_item cfg_item = cfg_io_sched[param];
+    bool default_value = !strcmp(cfg_item.value, "true");
+    const char *value;
+    char *section;
+    int rc;
+
+    if (already_set[family])
+        return res[family];
+
+    res[family] = default_value;
+
+    rc = io_sched_cfg_section_name(family, &section);
+    if (rc)
+        return res[family];
+
+    rc = pho_cfg_get_val(section, cfg_item.name, &value);
+    if (rc)
+        goto free_section;
+
+    if (!strcmp(value, "true"))
+        res[family] = true;
+    else if (!strcmp(value, "false"))
+        res[family] = false;
+    else
+        pho_warn("%s value must be \"true\" or \"false\", and not \"%s\", "
+                 "the default value \"%s\" is taken instead",
+                 cfg_item.name, value, cfg_item.value);
+
+    already_set[family] = true;
+
+free_section:
+    free(section);
+    return res[family];
+}
+
+static inline bool cfg_ordered_grouped_read(enum rsc_family family)
+{
+    static bool already_set[PHO_RSC_LAST] = {false};
+    static bool res[PHO_RSC_LAST];
+
+    return cfg_grouped_read_bool(PHO_IO_SCHED_ordered_grouped_read, family,
+                                 already_set, res);
+}
+
+static inline bool cfg_grouped_read_elevator(enum rsc_family family)
+{
+    static bool already_set[PHO_RSC_LAST] = {false};
+    static bool res[PHO_RSC_LAST];
+
+    return cfg_grouped_read_bool(PHO_IO_SCHED_grouped_read_elevator, family,
+                                 already_set, res);
+}
+
+/* The RAO batches are only used with the elevator ordering */
+static inline bool cfg_grouped_read_rao(enum rsc_family family)
+{
+    static bool already_set[PHO_RSC_LAST] = {false};
+    static bool res[PHO_RSC_LAST];
+
+    return cfg_grouped_read_elevator(family) &&
+        cfg_grouped_read_bool(PHO_IO_SCHED_grouped_read_rao, family,
+                              already_set, res);
+}
+
+/* Estimated costs of the operations of a queue, relative to the service of one
+ * request: loading a medium in a drive and going back to the beginning of the
+ * medium to wrap the elevator sweep.
+ */
+#define LOAD_COST   8.
+#define WRAP_COST   2.
+
+/* Number of requests of \p queue served per unit of its estimated total service
+ * time. Serving every request of a queue at once is the most efficient
+ * when the medium does not have to be loaded first, and when the elevator
+ * sweep does not have to wrap.
+ */
+static double queue_service_rate(struct io_scheduler *io_sched,
+                                 struct request_queue *queue)
+{
+    double n_requests = g_queue_get_length(queue->queue);
+    double time = n_requests;
+
+    if (!search_in_use_medium(io_sched->io_sched_hdl->global_device_list,
+                              queue->medium_id.name, queue->medium_id.library,
+                              NULL))
+        time += LOAD_COST;
+
+    for (GList *iter = queue->queue->head; iter; iter = iter->next) {
+        struct queue_element *elem = iter->data;
+
+        if (elem->position < queue->head_position) {
+            time += WRAP_COST;
+            break;
+        }
+    }
+
+    return n_requests / time;
+}
+
 static ssize_t reqc_get_medium_index_from_medium_id(struct req_container *reqc,
                                                     struct pho_id *medium_id)
 {
@@ -333,6 +490,11 @@ request_queue_alloc(struct io_scheduler *io_sched,
 
     (*queue)->device = NULL;
     (*queue)->queue = g_queue_new();
+    (*queue)->head_position = 0;
+    (*queue)->n_ranked = 0;
+    (*queue)->rao_pending = false;
+    (*queue)->rao_dev = NULL;
+    (*queue)->rao_elems = NULL;
 
     g_hash_table_insert(data->request_queues, &(*queue)->medium_id, *queue);
 
@@ -353,6 +515,8 @@ static void delete_queue(struct grouped_data *data,
         remove_queue_from_device(queue->device, queue);
 
     lrs_medium_release(queue->medium_info);
+    if (queue->rao_elems)
+        g_ptr_array_free(queue->rao_elems, TRUE);
     g_queue_free(queue->queue);
     free(queue);
 }
@@ -371,6 +535,19 @@ static void queue_element_free(struct queue_element *elem, bool last)
 static void remove_element_from_queue(struct grouped_data *data,
                                       struct queue_element *elem)
 {
+    struct request_queue *queue = elem->queue;
+
+    if (elem->ranked)
+        queue->n_ranked--;
+
+    if (queue->rao_elems) {
+        guint i;
+
+        for (i = 0; i < queue->rao_elems->len; i++)
+            if (g_ptr_array_index(queue->rao_elems, i) == elem)
+                g_ptr_array_index(queue->rao_elems, i) = NULL;
+    }
+
     g_queue_remove(elem->queue->queue, elem);
     if (g_queue_get_length(elem->queue->queue) == 0)
         delete_queue(data, elem->queue);
@@ -457,6 +634,84 @@ static void empty_incompatible_queue(struct io_scheduler *io_sched,
     delete_queue(io_sched->private_data, queue);
 }
 
+/* Whether the queues of \p data use the elevator ordering */
+static bool grouped_elevator_enabled(struct grouped_data *data)
+{
+    GHashTableIter iter;
+    gpointer queue;
+
+    g_hash_table_iter_init(&iter, data->request_queues);
+    if (!g_hash_table_iter_next(&iter, NULL, &queue))
+        return false;
+
+    /* The queues of one scheduler all target media of the same family */
+    return cfg_grouped_read_elevator(
+        ((struct request_queue *)queue)->medium_id.family);
+}
+
+struct rated_queue {
+    struct request_queue *queue;
+    double                rate;  /* result of queue_service_rate() */
+};
+
+static gint glib_decreasing_rate(gconstpointer _a, gconstpointer _b)
+{
+    const struct rated_queue *a = _a;
+    const struct rated_queue *b = _b;
+
+    if (a->rate > b->rate)
+        return -1;
+    else if (a->rate < b->rate)
+        return 1;
+
+    return 0;
+}
+
+/* Same as searching grouped_data::request_queues with
+ * glib_stop_at_first_compatible, but trying the queues by decreasing service
+ * rate instead of the hash table order.
+ */
+static struct request_queue *
+find_queue_by_service_rate(struct io_scheduler *io_sched,
+                           struct find_compatible_context *ctxt)
+{
+    struct grouped_data *data = io_sched->private_data;
+    struct request_queue *queue = NULL;
+    GHashTableIter iter;
+    GArray *queues;
+    gpointer value;
+    guint i;
+
+    queues = g_array_sized_new(FALSE, FALSE, sizeof(struct rated_queue),
+                               g_hash_table_size(data->request_queues));
+
+    g_hash_table_iter_init(&iter, data->request_queues);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        struct rated_queue rated = {
+            .queue = value,
+            .rate  = queue_service_rate(io_sched, value),
+        };
+
+        g_array_append_val(queues, rated);
+    }
+
+    g_array_sort(queues, glib_decreasing_rate);
+
+    for (i = 0; i < queues->len; i++) {
+        struct rated_queue *rated;
+
+        rated = &g_array_index(queues, struct rated_queue, i);
+        if (glib_stop_at_first_compatible(NULL, rated->queue, ctxt)) {
+            queue = rated->queue;
+            break;
+        }
+    }
+
+    g_array_free(queues, TRUE);
+
+    return queue;
+}
+
 static struct request_queue *
 find_and_allocate_queue(struct io_scheduler *io_sched,
                         size_t available_devices)
@@ -472,9 +727,12 @@ find_and_allocate_queue(struct io_scheduler *io_sched,
     struct request_queue *queue = NULL;
     int i;
 
-    queue = g_hash_table_find(data->request_queues,
-                              glib_stop_at_first_compatible,
-                              &ctxt);
+    if (grouped_elevator_enabled(data))
+        queue = find_queue_by_service_rate(io_sched, &ctxt);
+    else
+        queue = g_hash_table_find(data->request_queues,
+                                  glib_stop_at_first_compatible,
+                                  &ctxt);
     if (queue) {
         assert(ctxt.device);
 
@@ -680,6 +938,128 @@ free_list:
     return res;
 }
 
+static gint elevator_request_compare(gconstpointer _queue_elem_a,
+                                     gconstpointer _queue_elem_b,
+                                     gpointer _queue);
+
+static void queue_rao_reset(struct request_queue *queue)
+{
+    if (queue->rao_elems)
+        g_ptr_array_free(queue->rao_elems, TRUE);
+
+    queue->rao_elems = NULL;
+    queue->rao_dev = NULL;
+}
+
+/**
+ * Submit the requests of \p queue, whose medium is mounted in \p dev, to the
+ * device thread to be ordered as a new RAO batch.
+ *
+ * The batch is made of the requests whose extent address on the medium is
+ * known. It is only built once the previous batch is served and if new
+ * requests were pushed since.
+ */
+static void queue_rao_submit(struct lrs_dev *dev, struct request_queue *queue)
+{
+    size_t length = g_queue_get_length(queue->queue);
+    struct dev_rao_batch *batch;
+
+    if (queue->rao_dev || queue->n_ranked > 0 || !queue->rao_pending ||
+        length < 2 || !dev_is_mounted(dev))
+        return;
+
+    batch = xcalloc(1, sizeof(*batch));
+    pho_id_copy(&batch->medium, &queue->medium_id);
+    batch->addresses = xcalloc(length, sizeof(*batch->addresses));
+    batch->order = xcalloc(length, sizeof(*batch->order));
+    queue->rao_elems = g_ptr_array_sized_new(length);
+
+    glist_foreach(iter, queue->queue->head) {
+        struct queue_element *elem = iter->data;
+
+        if (!elem->address || elem->address[0] == '\0')
+            continue;
+
+        batch->addresses[batch->count++] = xstrdup(elem->address);
+        g_ptr_array_add(queue->rao_elems, elem);
+    }
+
+    if (batch->count < 2 || !dev_rao_submit(dev, batch)) {
+        dev_rao_batch_free(batch);
+        queue_rao_reset(queue);
+        return;
+    }
+
+    queue->rao_dev = dev;
+    queue->rao_pending = false;
+}
+
+/**
+ * Rank the requests of \p queue by the order of \p batch, as returned by the
+ * device thread of \p dev.
+ *
+ * The requests served or removed since the submission of the batch are left
+ * out.
+ */
+static void queue_rao_apply(struct lrs_dev *dev, struct request_queue *queue,
+                            struct dev_rao_batch *batch)
+{
+    size_t count = 0;
+    size_t i;
+
+    if (queue->rao_dev != dev || !pho_id_equal(&batch->medium,
+                                               &queue->medium_id))
+        return;
+
+    for (i = 0; i < batch->n_ordered; i++) {
+        struct queue_element *elem;
+
+        elem = g_ptr_array_index(queue->rao_elems, batch->order[i]);
+        if (!elem)
+            continue;
+
+        elem->ranked = true;
+        elem->rank = count++;
+    }
+    queue->n_ranked = count;
+
+    if (count > 0)
+        g_queue_sort(queue->queue, elevator_request_compare, queue);
+
+    pho_debug("Ordered a RAO batch of %zu requests out of %zu for medium "
+              "'%s'", count, batch->count, queue->medium_id.name);
+}
+
+/**
+ * Apply the RAO batch ordered by the device thread of \p device, if any, and
+ * submit a new one if needed.
+ */
+static void device_rao_update(struct device *device)
+{
+    struct request_queue *queue = device->queue;
+    struct dev_rao_batch *batch;
+
+    batch = dev_rao_fetch(device->device);
+    if (batch) {
+        if (queue)
+            queue_rao_apply(device->device, queue, batch);
+        dev_rao_batch_free(batch);
+        if (queue && queue->rao_dev == device->device)
+            queue_rao_reset(queue);
+    }
+
+    if (!queue || !cfg_grouped_read_rao(queue->medium_id.family))
+        return;
+
+    if (queue->rao_dev && queue->rao_dev != device->device) {
+        /* the queue moved to another device before its batch was ordered */
+        queue_rao_reset(queue);
+        queue->rao_pending = true;
+    }
+
+    queue_rao_submit(device->device, queue);
+}
+
 static int grouped_peek_request(struct io_scheduler *io_sched,
                                 struct req_container **reqc)
 {
@@ -716,6 +1096,8 @@ static int grouped_peek_request(struct io_scheduler *io_sched,
         }
         lrs_medium_release(medium);
 
+        device_rao_update(device);
+
         if (!dev_is_sched_ready(device->device) || !device->queue)
             continue;
 
@@ -833,49 +1215,70 @@ static gint qos_priority_request_compare(gconstpointer _queue_elem_a,
     return 0;
 }
 
-static inline bool cfg_ordered_grouped_read(enum rsc_family family)
+/**
+ * Compare two queue elems for an elevator sweep along the medium of their
+ * queue \p _queue.
+ *
+ * The requests are first ordered by QOS, as in qos_priority_request_compare.
+ * Then, since the queue is served from its tail, the request served next is the
+ * greater one: the requests of the RAO batch of the queue are served first in
+ * their recommended order. Then the requests at or after the head position of
+ * the queue are served by increasing position, then the ones behind it.
+ *
+ * Since the order depends on the head position, the queue must be sorted again
+ * when it changes.
+ */
+static gint elevator_request_compare(gconstpointer _queue_elem_a,
+                                     gconstpointer _queue_elem_b,
+                                     gpointer _queue)
 {
-    struct pho_config_item cfg_ordered_item =
-        cfg_io_sched[PHO_IO_SCHED_ordered_grouped_read];
-    static bool already_set[PHO_RSC_LAST] = {false};
-    static bool res[PHO_RSC_LAST];
-    const char *value;
-    char *section;
-    int rc;
+    struct queue_element *queue_elem_a = (struct queue_element *)_queue_elem_a;
+    struct queue_element *queue_elem_b = (struct queue_element *)_queue_elem_b;
+    const struct request_queue *queue = _queue;
+    pho_req_t *req_a = queue_elem_a->reqc->req;
+    pho_req_t *req_b = queue_elem_b->reqc->req;
+    bool a_behind;
+    bool b_behind;
 
-    if (already_set[family])
-        return res[family];
+    if (req_a->qos < req_b->qos)
+        return -1;
+    else if (req_a->qos > req_b->qos)
+        return 1;
 
-    res[family] = cfg_ordered_item.value;
+    if (queue_elem_a->ranked != queue_elem_b->ranked)
+        return queue_elem_a->ranked ? 1 : -1;
 
-    rc = io_sched_cfg_section_name(family, &section);
-    if (rc)
-        return res[family];
+    if (queue_elem_a->ranked) {
+        if (queue_elem_a->rank < queue_elem_b->rank)
+            return 1;
+        else if (queue_elem_a->rank > queue_elem_b->rank)
+            return -1;
 
-    rc = pho_cfg_get_val(section, cfg_ordered_item.name, &value);
-    if (rc)
-        goto free_section;
+        return 0;
+    }
 
-    if (!strcmp(value, "true"))
-        res[family] = true;
-    else if (!strcmp(value, "false"))
-        res[family] = false;
-    else
-        pho_warn("ordered_grouped_read value must be \"true\" or \"false\", "
-                 "and not \"%s\", the default value \"%s\" is taken instead",
-                 value, cfg_ordered_item.value ? "true" : "false");
+    a_behind = queue_elem_a->position < queue->head_position;
+    b_behind = queue_elem_b->position < queue->head_position;
+    if (a_behind != b_behind)
+        return a_behind ? -1 : 1;
 
-    already_set[family] = true;
+    if (queue_elem_a->position > queue_elem_b->position)
+        return -1;
+    else if (queue_elem_a->position < queue_elem_b->position)
+        return 1;
 
-free_section:
-    free(section);
-    return res[family];
+    return 0;
 }
 
 static inline void queue_insert(struct request_queue *queue,
                                 struct queue_element *elem)
 {
-    if (cfg_ordered_grouped_read(queue->medium_id.family))
+    queue->rao_pending = true;
+
+    if (cfg_grouped_read_elevator(queue->medium_id.family))
+        g_queue_insert_sorted(queue->queue, elem, elevator_request_compare,
+                              queue);
+    else if (cfg_ordered_grouped_read(queue->medium_id.family))
         g_queue_insert_sorted(queue->queue, elem, qos_priority_request_compare,
                               NULL);
     else
@@ -927,6 +1330,13 @@ static int grouped_push_request(struct io_scheduler *io_sched,
 
         elem->reqc = reqc;
         elem->pair = pair;
+        elem->position = 0;
+        if (reqc->req->ralloc->n_positions == reqc->req->ralloc->n_med_ids)
+            elem->position = reqc->req->ralloc->positions[i];
+        elem->address = NULL;
+        if (reqc->req->ralloc->n_addresses == reqc->req->ralloc->n_med_ids)
+            elem->address = reqc->req->ralloc->addresses[i];
+        elem->ranked = false;
 
         rc = insert_request_in_medium_queue(io_sched, elem, i);
         if (rc) {
@@ -966,9 +1376,27 @@ free_elems:
     return rc;
 }
 
+/* Remove \p elem whose request has been served on the medium of its queue.
+ * With the elevator ordering, the sweep of the queue resumes from the position
+ * of \p elem.
+ */
+static void remove_served_element_from_queue(struct grouped_data *data,
+                                             struct queue_element *elem)
+{
+    struct request_queue *queue = elem->queue;
+    bool last = g_queue_get_length(queue->queue) == 1;
+
+    remove_element_from_queue(data, elem);
+    if (last || !cfg_grouped_read_elevator(queue->medium_id.family))
+        return;
+
+    queue->head_position = elem->position;
+    g_queue_sort(queue->queue, elevator_request_compare, queue);
+}
+
 static void remove_elements_from_list(struct grouped_data *data,
                                       struct queue_element *to_ignore,
-                                      GList *list)
+                                      GList *list, bool served)
 {
     glist_foreach(iter, list) {
         struct queue_element *elem = iter->data;
@@ -977,7 +1405,10 @@ static void remove_elements_from_list(struct grouped_data *data,
             /* do not free to_ignore yet */
             continue;
 
-        remove_element_from_queue(data, elem);
+        if (served)
+            remove_served_element_from_queue(data, elem);
+        else
+            remove_element_from_queue(data, elem);
         queue_element_free(elem, false);
     }
 }
@@ -1020,10 +1451,14 @@ static int grouped_remove_request(struct io_scheduler *io_sched,
     assert(link);
 
     elem = link->data;
-    remove_elements_from_list(data, elem, elem->pair->used);
-    remove_elements_from_list(data, elem, elem->pair->free);
+    /* The allocated media are in pair->used */
+    remove_elements_from_list(data, elem, elem->pair->used, true);
+    remove_elements_from_list(data, elem, elem->pair->free, false);
 
-    remove_element_from_queue(data, elem);
+    if (g_list_find(elem->pair->used, elem))
+        remove_served_element_from_queue(data, elem);
+    else
+        remove_element_from_queue(data, elem);
     queue_element_free(elem, true);
 
     data->current_elem = NULL;
@@ -1140,7 +1575,7 @@ static gint glib_is_reqc_first_in_queue(gconstpointer _elem,
  * This function will return a queue whose first element contains reqc and is
  * the best choice according to some heuristic which is for now the first queue
  * associated to a device found. If no queue is associated to a device, get the
- * first one.
+ * first one, or the one with the best service rate with the elevator ordering.
  *
  * Simple heuristics can sort queues by:
  * - decreasing number of requests (Nr)
@@ -1150,18 +1585,43 @@ static gint glib_is_reqc_first_in_queue(gconstpointer _elem,
  *      It could be done with the RAO for example.
  */
 static struct request_queue *
-find_next_queue_for_request(struct grouped_data *data,
+find_next_queue_for_request(struct io_scheduler *io_sched,
                             struct queue_element *elem)
 {
     struct request_queue *queue = NULL;
+    double best_rate = -1.;
 
     if (g_list_length(elem->pair->free) == 0)
         return NULL;
 
-    /* XXX we could use g_list_sort to use some heuristic to chose the best
-     * medium, for now choose the first one.
-     */
-    g_list_find_custom(elem->pair->free, &queue, glib_is_reqc_first_in_queue);
+    if (!cfg_grouped_read_elevator(elem->queue->medium_id.family)) {
+        /* XXX we could use g_list_sort to use some heuristic to chose the
+         * best medium, for now choose the first one.
+         */
+        g_list_find_custom(elem->pair->free, &queue,
+                           glib_is_reqc_first_in_queue);
+
+        return queue;
+    }
+
+    glist_foreach(iter, elem->pair->free) {
+        struct queue_element *candidate = iter->data;
+        struct queue_element *first_elem;
+        double rate;
+
+        first_elem = g_queue_peek_tail(candidate->queue->queue);
+        if (first_elem->reqc != candidate->reqc)
+            continue;
+
+        if (candidate->queue->device)
+            return candidate->queue;
+
+        rate = queue_service_rate(io_sched, candidate->queue);
+        if (rate > best_rate) {
+            queue = candidate->queue;
+            best_rate = rate;
+        }
+    }
 
     return queue;
 }
@@ -1253,7 +1713,7 @@ static int grouped_get_device_medium_pair(struct io_scheduler *io_sched,
     }
 
     /* no device with a queue whose next request is reqc */
-    queue = find_next_queue_for_request(data, data->current_elem);
+    queue = find_next_queue_for_request(io_sched, data->current_elem);
     if (!queue)
         return 0;
 
@@ -87,6 +87,12 @@ struct lrs_stats {
     struct pho_stat *stat_write_n_media; /*!< requested media in write requests
                                           */
     struct pho_stat *response_qsize;
+    struct pho_stat *stat_read_alloc_wait; /*!< histogram of the time to
+                                            *   answer read allocations (us)
+                                            */
+    struct pho_stat *stat_write_alloc_wait; /*!< histogram of the time to
+                                             *   answer write allocations (us)
+                                             */
 };
 
 /**
@@ -98,17 +104,17 @@ struct lrs_stats {
 struct lrs {
     struct lrs_sched     *sched[PHO_RSC_LAST]; /*!< Scheduler handles */
     struct pho_comm_info  comm;                /*!< Communication handle */
-    struct tsqueue        response_queue;      /*!< Response queue */
+    struct mpsc_queue     response_queue;      /*!< Response queue */
     bool                  stopped;             /*!< true when every I/O has been
                                                 * completed after the LRS
                                                 * stopped.
                                                 */
-    struct dss_handle     dss;                 /*!< DSS handle of the
-                                                * communication thread
-                                                */
     const char *lock_file;                     /*!< Daemon lock file path */
 
     struct lrs_stats stats;
+    struct pho_stats_server *metrics;          /*!< OpenMetrics server, NULL
+                                                * if not configured
+                                                */
 };
 
 
@@ -328,24 +334,21 @@ static inline bool client_disconnected_error(int rc)
     return rc == -EPIPE || rc == -ECONNRESET || rc == -EBADF;
 }
 
-static int _send_message(struct pho_comm_info *comm,
-                         struct resp_container *respc)
+static void _pack_message(struct pho_comm_info *comm,
+                          struct resp_container *respc,
+                          struct pho_comm_data *msg)
 {
-    struct pho_comm_data msg;
-    int rc = 0;
-
-    msg = pho_comm_data_init(comm);
-    msg.fd = respc->socket_id;
+    *msg = pho_comm_data_init(comm);
+    msg->fd = respc->socket_id;
     if (!running)
         cancel_response(respc);
 
-    pho_srl_response_pack(respc->resp, &msg.buf);
+    pho_srl_response_pack(respc->resp, &msg->buf);
+}
 
-    /* XXX: \p running could change just before the call to send.
-     * Which means that new I/O responses would be sent with running = false
-     */
-    rc = pho_comm_send(&msg);
-    free(msg.buf.buff);
+/** Handle the failure \p rc of sending \p respc */
+static int _check_sent_message(int rc, struct resp_container *respc)
+{
     if (client_disconnected_error(rc)) {
         pho_error(rc,
                   "Failed to send %s response to disconnected client %d, not "
@@ -369,22 +372,114 @@ cancel:
     return rc;
 }
 
+static int _send_message(struct pho_comm_info *comm,
+                         struct resp_container *respc)
+{
+    struct pho_comm_data msg;
+    int rc = 0;
+
+    _pack_message(comm, respc, &msg);
+
+    /* XXX: \p running could change just before the call to send.
+     * Which means that new I/O responses would be sent with running = false
+     */
+    rc = pho_comm_send(&msg);
+    free(msg.buf.buff);
+
+    return _check_sent_message(rc, respc);
+}
+
+/**
+ * Send the packed responses of one client at once, the responses following a
+ * failure are not received by the client.
+ */
+static int _send_messages(struct resp_container **respcs,
+                          struct pho_comm_data *msgs, size_t n_msgs)
+{
+    size_t n_sent;
+    size_t i;
+    int rc;
+
+    rc = pho_comm_send_batch(msgs, n_msgs, &n_sent);
+    if (!rc)
+        return 0;
+
+    rc = _check_sent_message(rc, respcs[n_sent]);
+    for (i = n_sent + 1; i < n_msgs; i++)
+        cancel_read_write(respcs[i]);
+
+    return rc;
+}
+
+static int cmp_socket_id(const void *a, const void *b)
+{
+    const struct resp_container *respc_a = *(struct resp_container **)a;
+    const struct resp_container *respc_b = *(struct resp_container **)b;
+
+    return (respc_a->socket_id > respc_b->socket_id) -
+           (respc_a->socket_id < respc_b->socket_id);
+}
+
 static int send_responses_from_queue(struct lrs *lrs)
 {
     struct resp_container *respc;
+    struct pho_comm_data *msgs;
+    GPtrArray *respcs;
+    size_t first;
     int rc = 0;
+    size_t i;
     int rc2;
 
     /* update stats about response queue before it is emptied */
     pho_stat_set(lrs->stats.response_qsize,
-                 tsqueue_get_length(&lrs->response_queue));
+                 mpsc_queue_get_length(&lrs->response_queue));
+
+    respcs = g_ptr_array_new();
+    while ((respc = mpsc_queue_pop(&lrs->response_queue)) != NULL) {
+        if (pho_response_is_write(respc->resp))
+            pho_stat_observe_since(lrs->stats.stat_write_alloc_wait,
+                                   &respc->received_at);
+        else if (pho_response_is_read(respc->resp))
+            pho_stat_observe_since(lrs->stats.stat_read_alloc_wait,
+                                   &respc->received_at);
+
+        g_ptr_array_add(respcs, respc);
+    }
+
+    if (respcs->len == 0)
+        goto out;
+
+    /* gather the responses of each client, the sort is stable so they are
+     * sent in their queuing order
+     */
+    g_ptr_array_sort(respcs, cmp_socket_id);
+
+    msgs = xmalloc(respcs->len * sizeof(*msgs));
+    for (i = 0; i < respcs->len; i++)
+        _pack_message(&lrs->comm, respcs->pdata[i], &msgs[i]);
 
-    while ((respc = tsqueue_pop(&lrs->response_queue)) != NULL) {
-        rc2 = _send_message(&lrs->comm, respc);
+    /* XXX: \p running could change just before the call to send.
+     * Which means that new I/O responses would be sent with running = false
+     */
+    for (first = 0; first < respcs->len; first = i) {
+        for (i = first + 1; i < respcs->len; i++)
+            if (msgs[i].fd != msgs[first].fd)
+                break;
+
+        rc2 = _send_messages((struct resp_container **)respcs->pdata + first,
+                             msgs + first, i - first);
         rc = rc ? : rc2;
-        sched_resp_free_with_cont(respc);
     }
 
+    for (i = 0; i < respcs->len; i++) {
+        free(msgs[i].buf.buff);
+        sched_resp_free_with_cont(respcs->pdata[i]);
+    }
+
+    free(msgs);
+
+out:
+    g_ptr_array_free(respcs, TRUE);
     return rc;
 }
 
@@ -544,6 +639,7 @@ static void init_rwalloc_container(struct lrs_stats *stats,
     rwalloc_params->respc = xcalloc(1, sizeof(*rwalloc_params->respc));
 
     rwalloc_params->respc->socket_id = reqc->socket_id;
+    rwalloc_params->respc->received_at = reqc->received_at;
     rwalloc_params->respc->resp = xcalloc(1,
                                           sizeof(*rwalloc_params->respc->resp));
 
@@ -575,9 +671,9 @@ static void init_request_container_param(struct lrs_stats *stats,
         reqc->params.notify.notified_device = NULL;
 }
 
-static int update_phys_spc_free(struct dss_handle *dss,
-                                struct media_info *dss_media_info,
-                                size_t written_size)
+static void update_phys_spc_free(struct lrs_sched *sched,
+                                 struct media_info *dss_media_info,
+                                 size_t written_size)
 {
     if (written_size > 0) {
         dss_media_info->stats.phys_spc_free -= written_size;
@@ -598,22 +694,21 @@ static int update_phys_spc_free(struct dss_handle *dss,
             dss_media_info->stats.phys_spc_free = 0;
         }
 
-        return dss_media_update(dss, dss_media_info, dss_media_info, 1,
-                                PHYS_SPC_FREE);
+        /* written by the DSS writer of the scheduler, not to delay the
+         * communication thread
+         */
+        lrs_dss_writer_phys_spc_free(&sched->dss_writer, dss_media_info);
+        lrs_media_catalog_update(&sched->catalog, dss_media_info);
     }
-
-    return 0;
 }
 
 static int release_medium(struct lrs_sched *sched,
-                          struct dss_handle *comm_dss,
                           struct req_container *reqc,
                           pho_req_release_elt_t *release,
                           size_t medium_index,
                           int *req_rc)
 {
     struct lrs_dev *dev = NULL;
-    int rc = 0;
 
     *req_rc = 0;
 
@@ -643,8 +738,8 @@ static int release_medium(struct lrs_sched *sched,
     /* update media phys_spc_free stats in advance, before next sync */
     MUTEX_LOCK(&dev->ld_mutex);
     if (release->rc == 0)
-        rc = update_phys_spc_free(comm_dss, dev->ld_dss_media_info,
-                                  release->size_written);
+        update_phys_spc_free(sched, dev->ld_dss_media_info,
+                             release->size_written);
     if (release->to_sync)
         /* ownership of reqc is passed to the device thread */
         push_new_sync_to_device(dev, reqc, medium_index);
@@ -653,7 +748,7 @@ static int release_medium(struct lrs_sched *sched,
     dev_clean_io(dev, reqc->req->release->partial);
     MUTEX_UNLOCK(&dev->ld_mutex);
 
-    return rc;
+    return 0;
 }
 
 /**
@@ -669,7 +764,6 @@ static int release_medium(struct lrs_sched *sched,
  * an error message.
  */
 static int process_release_request(struct lrs_sched *sched,
-                                   struct dss_handle *comm_dss,
                                    struct req_container *reqc)
 {
     int release_index = -1;
@@ -682,7 +776,7 @@ static int process_release_request(struct lrs_sched *sched,
         pho_req_release_elt_t *release_elt = reqc->req->release->media[i];
         int req_rc = 0;
 
-        rc = release_medium(sched, comm_dss, reqc, release_elt,
+        rc = release_medium(sched, reqc, release_elt,
                             release_index + 1, &req_rc);
         if (rc)
             /* system error, stop */
@@ -1004,7 +1098,7 @@ static int _prepare_requests(struct lrs *lrs, bool *schedulers_to_signal,
         init_request_container_param(&lrs->stats, req_cont);
         if (pho_request_is_release(req_cont->req)) {
             pho_stat_incr(lrs->stats.req_stats[PHO_REQ_RELEASE], 1);
-            rc2 = process_release_request(lrs->sched[fam], &lrs->dss, req_cont);
+            rc2 = process_release_request(lrs->sched[fam], req_cont);
             rc = rc ? : rc2;
             if (!rc2)
                 schedulers_to_signal[fam] = true;
@@ -1020,7 +1114,7 @@ static int _prepare_requests(struct lrs *lrs, bool *schedulers_to_signal,
                 pho_stat_incr(lrs->stats.req_stats[PHO_REQ_NOTIFY], 1);
 
             if (running) {
-                tsqueue_push(&lrs->sched[fam]->incoming, req_cont);
+                mpsc_queue_push(&lrs->sched[fam]->incoming, req_cont);
                 schedulers_to_signal[fam] = true;
             } else {
                 LOG_GOTO(send_err, rc2 = -ESHUTDOWN,
@@ -1126,6 +1220,10 @@ static int lrs_stats_init(struct lrs_stats *lrs_stats)
                             LRS_STAT_NS, "media_requested", "request=WRITE");
     lrs_stats->response_qsize = pho_stat_create(PHO_STAT_GAUGE, LRS_STAT_NS,
                                                 "response_qsize", NULL);
+    lrs_stats->stat_read_alloc_wait = pho_stat_create(PHO_STAT_HISTOGRAM,
+                            LRS_STAT_NS, "alloc_wait_us", "request=READ");
+    lrs_stats->stat_write_alloc_wait = pho_stat_create(PHO_STAT_HISTOGRAM,
+                            LRS_STAT_NS, "alloc_wait_us", "request=WRITE");
     return 0;
 }
 
@@ -1146,6 +1244,8 @@ static void lrs_stats_destroy(struct lrs_stats *lrs_stats)
     pho_stat_destroy(&lrs_stats->stat_read_n_media);
     pho_stat_destroy(&lrs_stats->stat_write_n_media);
     pho_stat_destroy(&lrs_stats->response_qsize);
+    pho_stat_destroy(&lrs_stats->stat_read_alloc_wait);
+    pho_stat_destroy(&lrs_stats->stat_write_alloc_wait);
 }
 
 /* ****************************************************************************/
@@ -1171,6 +1271,9 @@ static void lrs_fini(struct lrs *lrs)
     if (lrs == NULL)
         return;
 
+    pho_stats_server_stop(lrs->metrics);
+    lrs->metrics = NULL;
+
     for (i = 0; i < PHO_RSC_LAST; ++i) {
         if (lrs->sched[i])
             thread_signal_stop(&lrs->sched[i]->sched_thread);
@@ -1191,8 +1294,7 @@ static void lrs_fini(struct lrs *lrs)
 
     lrs_stats_destroy(&lrs->stats);
 
-    tsqueue_destroy(&lrs->response_queue, sched_resp_free_with_cont);
-    dss_fini(&lrs->dss);
+    mpsc_queue_destroy(&lrs->response_queue, sched_resp_free_with_cont);
 
     _delete_lock_file(lrs->lock_file);
 }
@@ -1211,6 +1313,7 @@ static void lrs_fini(struct lrs *lrs)
 static int lrs_init(struct lrs *lrs)
 {
     union pho_comm_addr sock_addr = {0};
+    const char *metrics_listen;
     int rc;
 
     umask(0000);
@@ -1224,7 +1327,7 @@ static int lrs_init(struct lrs *lrs)
         LOG_RETURN(rc, "Error while creating the daemon lock file %s",
                    lrs->lock_file);
 
-    rc = tsqueue_init(&lrs->response_queue);
+    rc = mpsc_queue_init(&lrs->response_queue, MPSC_QUEUE_DEFAULT_CAPACITY);
     if (rc)
         LOG_GOTO(err, rc, "Unable to init lrs response queue");
 
@@ -1239,14 +1342,22 @@ static int lrs_init(struct lrs *lrs)
     if (rc)
         LOG_GOTO(err, rc, "Failed to open the phobosd socket");
 
-    rc = dss_init(&lrs->dss);
+    /* send the responses as soon as they are queued */
+    rc = pho_comm_add_wakeup_fd(&lrs->comm, lrs->response_queue.efd);
     if (rc)
-        LOG_GOTO(err, rc, "Failed to init comm dss handle");
+        LOG_GOTO(err, rc, "Failed to watch the response queue");
 
     rc = lrs_stats_init(&lrs->stats);
     if (rc)
         LOG_GOTO(err, rc, "Failed to initialize stats");
 
+    metrics_listen = PHO_CFG_GET(cfg_lrs, PHO_CFG_LRS, metrics_listen);
+    if (metrics_listen && *metrics_listen) {
+        rc = pho_stats_server_start(metrics_listen, &lrs->metrics);
+        if (rc)
+            LOG_GOTO(err, rc, "Failed to start the metrics server");
+    }
+
     return rc;
 
 err:
@@ -1296,7 +1407,8 @@ static int lrs_process(struct lrs *lrs)
             stopped = false;
     }
 
-    /* request reception and accept handling */
+    /* request reception and accept handling, until a response is queued */
+    mpsc_queue_arm_wakeup(&lrs->response_queue);
     rc = pho_comm_recv(&lrs->comm, &data, &n_data);
     if (rc) {
         for (i = 0; i < n_data; ++i)
@@ -94,6 +94,36 @@ const struct pho_config_item cfg_lrs[] = {
         .name    = "locate_lock_expirancy",
         .value   = "0",
     },
+    [PHO_CFG_LRS_dss_flush_ms] = {
+        .section = "lrs",
+        .name    = "dss_flush_ms",
+        .value   = "1000",
+    },
+    [PHO_CFG_LRS_media_catalog_sync_ms] = {
+        .section = "lrs",
+        .name    = "media_catalog_sync_ms",
+        .value   = "60000",
+    },
+    [PHO_CFG_LRS_metrics_listen] = {
+        .section = "lrs",
+        .name    = "metrics_listen",
+        .value   = NULL, /* no metrics server */
+    },
+    [PHO_CFG_LRS_write_stream_idle_ms] = {
+        .section = "lrs",
+        .name    = "write_stream_idle_ms",
+        .value   = "tape=0,dir=0,rados_pool=0",
+    },
+    [PHO_CFG_LRS_sync_ack_target_ms] = {
+        .section = "lrs",
+        .name    = "sync_ack_target_ms",
+        .value   = "tape=0,dir=0,rados_pool=0",
+    },
+    [PHO_CFG_LRS_trace_file] = {
+        .section = "lrs",
+        .name    = "trace_file",
+        .value   = NULL, /* no request trace */
+    },
 };
 
 static int _get_unsigned_long_from_string(const char *value,
@@ -184,3 +214,49 @@ int get_cfg_sync_wsize_value(enum rsc_family family, unsigned long *threshold)
 
     return 0;
 }
+
+int get_cfg_write_stream_idle_ms_value(enum rsc_family family,
+                                       struct timespec *idle)
+{
+    unsigned long num_milliseconds;
+    char *value;
+    int rc;
+
+    rc = PHO_CFG_GET_SUBSTRING_VALUE(cfg_lrs, PHO_CFG_LRS,
+                                     write_stream_idle_ms, family, &value);
+    if (rc)
+        return rc;
+
+    rc = _get_unsigned_long_from_string(value, 0, ULONG_MAX, &num_milliseconds);
+    free(value);
+    if (rc)
+        return rc;
+
+    idle->tv_sec = num_milliseconds / 1000;
+    idle->tv_nsec = (num_milliseconds % 1000) * 1000000;
+
+    return 0;
+}
+
+int get_cfg_sync_ack_target_ms_value(enum rsc_family family,
+                                     struct timespec *target)
+{
+    unsigned long num_milliseconds;
+    char *value;
+    int rc;
+
+    rc = PHO_CFG_GET_SUBSTRING_VALUE(cfg_lrs, PHO_CFG_LRS, sync_ack_target_ms,
+                                     family, &value);
+    if (rc)
+        return rc;
+
+    rc = _get_unsigned_long_from_string(value, 0, ULONG_MAX, &num_milliseconds);
+    free(value);
+    if (rc)
+        return rc;
+
+    target->tv_sec = num_milliseconds / 1000;
+    target->tv_nsec = (num_milliseconds % 1000) * 1000000;
+
+    return 0;
+}
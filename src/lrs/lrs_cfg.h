@@ -45,8 +45,14 @@ enum pho_cfg_params_lrs {
     PHO_CFG_LRS_fifo_max_write_per_grouping,
     PHO_CFG_LRS_grouping_on_dir,
     PHO_CFG_LRS_locate_lock_expirancy,
+    PHO_CFG_LRS_dss_flush_ms,
+    PHO_CFG_LRS_media_catalog_sync_ms,
+    PHO_CFG_LRS_metrics_listen,
+    PHO_CFG_LRS_write_stream_idle_ms,
+    PHO_CFG_LRS_sync_ack_target_ms,
+    PHO_CFG_LRS_trace_file,
 
-    PHO_CFG_LRS_LAST = PHO_CFG_LRS_locate_lock_expirancy,
+    PHO_CFG_LRS_LAST = PHO_CFG_LRS_trace_file,
 };
 
 extern const struct pho_config_item cfg_lrs[];
@@ -82,4 +88,28 @@ int get_cfg_sync_nb_req_value(enum rsc_family family, unsigned int *threshold);
  */
 int get_cfg_sync_wsize_value(enum rsc_family family, unsigned long *threshold);
 
+/**
+ * Getter of the idle timeout of the write streams for a given family.
+ *
+ * @param[in]   family      Targeted family.
+ * @param[out]  idle        Returned timeout, 0 if write streaming is disabled.
+ * @return                  0 on success,
+ *                         -errno on failure.
+ */
+int get_cfg_write_stream_idle_ms_value(enum rsc_family family,
+                                       struct timespec *idle);
+
+/**
+ * Getter of the ack latency target of the adaptive synchronization for a given
+ * family.
+ *
+ * @param[in]   family      Targeted family.
+ * @param[out]  target      Returned target, 0 if the synchronization only
+ *                          follows the static thresholds.
+ * @return                  0 on success,
+ *                         -errno on failure.
+ */
+int get_cfg_sync_ack_target_ms_value(enum rsc_family family,
+                                     struct timespec *target);
+
 #endif
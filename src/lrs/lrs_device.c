@@ -57,7 +57,8 @@ static int dev_medium_switch_mount(struct lrs_dev *dev,
                                    struct media_info *medium_to_load,
                                    struct medium_switch_context *context);
 static int dev_thread_init(struct lrs_dev *device);
-static void sync_params_init(struct sync_params *params);
+static void sync_params_init(struct sync_params *params,
+                             const struct lrs_dev_hdl *handle);
 
 static inline long ms2sec(long ms)
 {
@@ -85,6 +86,8 @@ int lrs_dev_hdl_init(struct lrs_dev_hdl *handle, enum rsc_family family)
 
     handle->ldh_devices = g_ptr_array_new();
     pthread_mutex_init(&handle->ldh_devices_remove_mutex, NULL);
+    handle->ldh_dss_writer = NULL;
+    handle->ldh_catalog = NULL;
 
     rc = get_cfg_sync_time_ms_value(family, &handle->sync_time_ms);
     if (rc)
@@ -98,6 +101,15 @@ int lrs_dev_hdl_init(struct lrs_dev_hdl *handle, enum rsc_family family)
     if (rc)
         return rc;
 
+    rc = get_cfg_sync_ack_target_ms_value(family, &handle->sync_ack_target);
+    if (rc)
+        return rc;
+
+    rc = get_cfg_write_stream_idle_ms_value(family,
+                                            &handle->write_stream_idle);
+    if (rc)
+        return rc;
+
     return 0;
 }
 
@@ -156,6 +168,34 @@ int dev_stats_init(struct lrs_dev *dev)
                                                       DEV_STATS_NS,
                                                       "total_tosync_extents",
                                                       tags);
+    dev->stats.sync_interval_ms = pho_stat_create(PHO_STAT_GAUGE,
+                                                  DEV_STATS_NS,
+                                                  "sync_interval_ms", tags);
+    dev->stats.sync_cost_ms = pho_stat_create(PHO_STAT_GAUGE, DEV_STATS_NS,
+                                              "sync_cost_ms", tags);
+    dev->stats.sync_threshold_nb_req = pho_stat_create(PHO_STAT_GAUGE,
+                                                       DEV_STATS_NS,
+                                                       "sync_threshold_nb_req",
+                                                       tags);
+    dev->stats.sync_threshold_ms = pho_stat_create(PHO_STAT_GAUGE,
+                                                   DEV_STATS_NS,
+                                                   "sync_threshold_ms", tags);
+    dev->stats.sync_on_nb_req = pho_stat_create(PHO_STAT_COUNTER, DEV_STATS_NS,
+                                                "sync_on_nb_req", tags);
+    dev->stats.sync_on_time = pho_stat_create(PHO_STAT_COUNTER, DEV_STATS_NS,
+                                              "sync_on_time", tags);
+    dev->stats.sync_on_size = pho_stat_create(PHO_STAT_COUNTER, DEV_STATS_NS,
+                                              "sync_on_size", tags);
+    dev->stats.mount_time = pho_stat_create(PHO_STAT_HISTOGRAM, DEV_STATS_NS,
+                                            "mount_time_us", tags);
+    dev->stats.umount_time = pho_stat_create(PHO_STAT_HISTOGRAM, DEV_STATS_NS,
+                                             "umount_time_us", tags);
+    dev->stats.load_time = pho_stat_create(PHO_STAT_HISTOGRAM, DEV_STATS_NS,
+                                           "load_time_us", tags);
+    dev->stats.unload_time = pho_stat_create(PHO_STAT_HISTOGRAM, DEV_STATS_NS,
+                                             "unload_time_us", tags);
+    dev->stats.sync_time = pho_stat_create(PHO_STAT_HISTOGRAM, DEV_STATS_NS,
+                                           "sync_time_us", tags);
     free(tags);
     return 0;
 }
@@ -180,6 +220,18 @@ void dev_stats_destroy(struct lrs_dev *dev)
     pho_stat_destroy(&dev->stats.tosync_extents);
     pho_stat_destroy(&dev->stats.total_tosync_size);
     pho_stat_destroy(&dev->stats.total_tosync_extents);
+    pho_stat_destroy(&dev->stats.sync_interval_ms);
+    pho_stat_destroy(&dev->stats.sync_cost_ms);
+    pho_stat_destroy(&dev->stats.sync_threshold_nb_req);
+    pho_stat_destroy(&dev->stats.sync_threshold_ms);
+    pho_stat_destroy(&dev->stats.sync_on_nb_req);
+    pho_stat_destroy(&dev->stats.sync_on_time);
+    pho_stat_destroy(&dev->stats.sync_on_size);
+    pho_stat_destroy(&dev->stats.mount_time);
+    pho_stat_destroy(&dev->stats.umount_time);
+    pho_stat_destroy(&dev->stats.load_time);
+    pho_stat_destroy(&dev->stats.unload_time);
+    pho_stat_destroy(&dev->stats.sync_time);
 }
 
 static int lrs_dev_init_from_info(struct lrs_dev_hdl *handle,
@@ -197,7 +249,7 @@ static int lrs_dev_init_from_info(struct lrs_dev_hdl *handle,
     if (!(*dev)->ld_dss_dev_info)
         GOTO(err_dev, rc = -ENOMEM);
 
-    sync_params_init(&(*dev)->ld_sync_params);
+    sync_params_init(&(*dev)->ld_sync_params, handle);
 
     rc = dss_init(&(*dev)->ld_device_thread.dss);
     if (rc)
@@ -293,6 +345,9 @@ static void lrs_dev_info_clean(struct lrs_dev_hdl *handle,
                         sub_request_free_wrapper, NULL);
     g_ptr_array_unref(dev->ld_sync_params.tosync_array);
     sub_request_free(dev->ld_sub_request);
+    dev_rao_batch_free(dev->ld_rao_request);
+    dev_rao_batch_free(dev->ld_rao_result);
+    dev_write_stream_unpin(dev);
     dev_info_free(dev->ld_dss_dev_info, 1);
     dss_fini(&dev->ld_device_thread.dss);
     dev_stats_destroy(dev);
@@ -524,7 +579,8 @@ struct lrs_dev *lrs_dev_hdl_get(struct lrs_dev_hdl *handle, int index)
     return g_ptr_array_index(handle->ldh_devices, index);
 }
 
-static void sync_params_init(struct sync_params *params)
+static void sync_params_init(struct sync_params *params,
+                             const struct lrs_dev_hdl *handle)
 {
     params->tosync_array = g_ptr_array_new();
     params->oldest_tosync.tv_sec = 0;
@@ -532,6 +588,84 @@ static void sync_params_init(struct sync_params *params)
     params->tosync_size = 0;
     params->tosync_nb_extents = 0;
     params->groupings_to_update = false;
+    sync_policy_init(&params->policy, handle);
+}
+
+/** Weight of the last measure in the moving averages of the sync policy */
+#define SYNC_POLICY_WEIGHT 0.25
+
+static double timespec2ms(const struct timespec *t)
+{
+    return t->tv_sec * 1000. + t->tv_nsec / 1000000.;
+}
+
+/** Add a measure to a moving average, 0 meaning that nothing was measured */
+static void moving_average_add(double *average, double measure)
+{
+    if (*average == 0.)
+        *average = measure;
+    else
+        *average += SYNC_POLICY_WEIGHT * (measure - *average);
+}
+
+void sync_policy_init(struct sync_policy *policy,
+                      const struct lrs_dev_hdl *handle)
+{
+    memset(policy, 0, sizeof(*policy));
+    policy->nb_req = handle->sync_nb_req;
+    policy->time = handle->sync_time_ms;
+}
+
+void sync_policy_observe_release(struct sync_policy *policy,
+                                 const struct timespec *date)
+{
+    struct timespec interval;
+
+    /* the releases of concurrent clients may not come in order */
+    if (cmp_timespec(date, &policy->last_release) <= 0)
+        return;
+
+    if (policy->last_release.tv_sec != 0 || policy->last_release.tv_nsec != 0) {
+        interval = diff_timespec(date, &policy->last_release);
+        moving_average_add(&policy->interval_ms, timespec2ms(&interval));
+    }
+
+    policy->last_release = *date;
+}
+
+void sync_policy_observe_sync(struct sync_policy *policy,
+                              const struct timespec *duration)
+{
+    moving_average_add(&policy->sync_cost_ms, timespec2ms(duration));
+}
+
+void sync_policy_update(struct sync_policy *policy,
+                        const struct lrs_dev_hdl *handle)
+{
+    double target_ms = timespec2ms(&handle->sync_ack_target);
+    double budget_ms;
+    double nb_req;
+
+    policy->nb_req = handle->sync_nb_req;
+    policy->time = handle->sync_time_ms;
+
+    if (target_ms == 0.)
+        return;
+
+    /* the time left to batch releases once the sync duration is accounted */
+    budget_ms = max(target_ms - policy->sync_cost_ms, 0.);
+    if (budget_ms < timespec2ms(&handle->sync_time_ms)) {
+        long long budget_ns = budget_ms * 1000000.;
+
+        policy->time.tv_sec = budget_ns / 1000000000;
+        policy->time.tv_nsec = budget_ns % 1000000000;
+    }
+
+    if (policy->interval_ms > 0.) {
+        nb_req = 1. + budget_ms / policy->interval_ms;
+        if (nb_req < handle->sync_nb_req)
+            policy->nb_req = nb_req;
+    }
 }
 
 static const struct timespec MINSLEEP = {
@@ -551,9 +685,9 @@ static int compute_wakeup_date(struct lrs_dev *dev, struct timespec *date)
         LOG_RETURN(-errno, "clock_gettime: unable to get CLOCK_REALTIME");
 
     if (oldest_tosync->tv_sec == 0 && oldest_tosync->tv_nsec == 0) {
-        *date = add_timespec(&now, &dev->ld_handle->sync_time_ms);
+        *date = add_timespec(&now, &dev->ld_sync_params.policy.time);
     } else {
-        *date = add_timespec(oldest_tosync, &dev->ld_handle->sync_time_ms);
+        *date = add_timespec(oldest_tosync, &dev->ld_sync_params.policy.time);
 
         diff = diff_timespec(date, &now);
         if (cmp_timespec(&diff, &MINSLEEP) == -1)
@@ -586,7 +720,7 @@ static int dev_wait_for_signal(struct lrs_dev *dev)
     return thread_signal_timed_wait(&dev->ld_device_thread, &time);
 }
 
-void queue_release_response(struct tsqueue *response_queue,
+void queue_release_response(struct mpsc_queue *response_queue,
                             struct req_container *reqc)
 {
     struct tosync_medium *tosync_media = reqc->params.release.tosync_media;
@@ -615,7 +749,7 @@ void queue_release_response(struct tsqueue *response_queue,
     resp_release->partial = reqc->req->release->partial;
     resp_release->kind = reqc->req->release->kind;
 
-    tsqueue_push(response_queue, respc);
+    mpsc_queue_push(response_queue, respc);
 }
 
 /* This function MUST be called with a lock on \p req */
@@ -747,6 +881,7 @@ void push_new_sync_to_device(struct lrs_dev *dev, struct req_container *reqc,
     sync_params->tosync_nb_extents +=
         reqc->params.release.tosync_media[medium_index].nb_extents_written;
     update_oldest_tosync(&sync_params->oldest_tosync, reqc->received_at);
+    sync_policy_observe_release(&sync_params->policy, &reqc->received_at);
 
     /* Update statistics */
     set_tosync_stats(&dev->stats, sync_params);
@@ -843,17 +978,43 @@ static void remove_canceled_sync(struct lrs_dev *dev)
     MUTEX_UNLOCK(&dev->ld_mutex);
 }
 
+static void set_sync_policy_stats(struct dev_stats *stats,
+                                  const struct sync_policy *policy)
+{
+    pho_stat_set(stats->sync_interval_ms, policy->interval_ms);
+    pho_stat_set(stats->sync_cost_ms, policy->sync_cost_ms);
+    pho_stat_set(stats->sync_threshold_nb_req, policy->nb_req);
+    pho_stat_set(stats->sync_threshold_ms, timespec2ms(&policy->time));
+}
+
 static void check_needs_sync(struct lrs_dev_hdl *handle, struct lrs_dev *dev)
 {
     struct sync_params *sync_params = &dev->ld_sync_params;
+    struct sync_policy *policy = &sync_params->policy;
+    bool on_nb_req = false;
+    bool on_time = false;
+    bool on_size = false;
 
     MUTEX_LOCK(&dev->ld_mutex);
 
-    dev->ld_needs_sync = sync_params->tosync_array->len > 0 &&
-                      (sync_params->tosync_array->len >= handle->sync_nb_req ||
-                       is_past(add_timespec(&sync_params->oldest_tosync,
-                                            &handle->sync_time_ms)) ||
-                       sync_params->tosync_size >= handle->sync_wsize_kb);
+    sync_policy_update(policy, handle);
+    set_sync_policy_stats(&dev->stats, policy);
+
+    if (sync_params->tosync_array->len > 0) {
+        on_nb_req = sync_params->tosync_array->len >= policy->nb_req;
+        on_time = is_past(add_timespec(&sync_params->oldest_tosync,
+                                       &policy->time));
+        on_size = sync_params->tosync_size >= handle->sync_wsize_kb;
+    }
+
+    if (on_nb_req)
+        pho_stat_incr(dev->stats.sync_on_nb_req, 1);
+    else if (on_time)
+        pho_stat_incr(dev->stats.sync_on_time, 1);
+    else if (on_size)
+        pho_stat_incr(dev->stats.sync_on_size, 1);
+
+    dev->ld_needs_sync = on_nb_req || on_time || on_size;
     dev->ld_needs_sync |= (!running && sync_params->tosync_array->len > 0);
     dev->ld_needs_sync |= (thread_is_stopping(&dev->ld_device_thread) &&
                            sync_params->tosync_array->len > 0);
@@ -870,7 +1031,9 @@ int medium_sync(struct lrs_dev *dev)
     struct media_info *media_info = dev->ld_dss_media_info;
     const char *fsroot = dev->ld_mnt_path;
     struct io_adapter_module *ioa;
+    struct timespec start;
     struct dss_handle *dss;
+    struct timespec end;
     struct pho_log log;
     int rc;
 
@@ -887,6 +1050,7 @@ int medium_sync(struct lrs_dev *dev)
     init_pho_log(&log, &dev->ld_dss_dev_info->rsc.id,
                  &dev->ld_dss_media_info->rsc.id, PHO_LTFS_SYNC);
 
+    clock_gettime(CLOCK_REALTIME, &start);
     rc = ioa_medium_sync(ioa, fsroot, &log.message);
     emit_log_after_action(dss, &log, PHO_LTFS_SYNC, rc);
 
@@ -896,9 +1060,26 @@ int medium_sync(struct lrs_dev *dev)
         LOG_RETURN(rc, "Cannot flush media at: %s", fsroot);
     }
 
+    pho_stat_observe_since(dev->stats.sync_time, &start);
+
+    clock_gettime(CLOCK_REALTIME, &end);
+    if (cmp_timespec(&end, &start) > 0) {
+        struct timespec duration = diff_timespec(&end, &start);
+
+        sync_policy_observe_sync(&dev->ld_sync_params.policy, &duration);
+    }
+
     return 0;
 }
 
+/** Report to the media catalog a medium updated in the DSS by \p dev */
+static void dev_catalog_update(struct lrs_dev *dev,
+                               const struct media_info *medium)
+{
+    if (dev->ld_handle->ldh_catalog)
+        lrs_media_catalog_update(dev->ld_handle->ldh_catalog, medium);
+}
+
 /** Update media_info stats and push its new state to the DSS. Called with a
  * lock on \p dev.
  */
@@ -993,6 +1174,8 @@ static int lrs_dev_media_update(struct lrs_dev *dev, size_t size_written,
     if (rc2)
         rc = rc ? : rc2;
 
+    dev_catalog_update(dev, media_info);
+
     return rc;
 }
 
@@ -1019,6 +1202,18 @@ static int dev_sync(struct lrs_dev *dev)
         rc = dev->ld_last_client_rc;
     }
 
+    /* The free space queued by the releases of this medium is written before
+     * the sync updates it and acknowledges the releases. The device lock
+     * prevents new releases from queueing a stale value meanwhile.
+     */
+    if (dev->ld_handle->ldh_dss_writer) {
+        rc2 = lrs_dss_writer_flush(dev->ld_handle->ldh_dss_writer);
+        if (rc2)
+            pho_warn("Failed to write the pending media updates before "
+                     "syncing '%s' (rc=%d), the sync will overwrite them",
+                     dev->ld_dev_path, rc2);
+    }
+
     rc2 = lrs_dev_media_update(dev, sync_params->tosync_size, rc,
                                sync_params->tosync_nb_extents,
                                sync_params->groupings_to_update);
@@ -1054,6 +1249,7 @@ static int dev_sync(struct lrs_dev *dev)
 int dev_umount(struct lrs_dev *dev)
 {
     struct fs_adapter_module *fsa;
+    struct timespec start;
     struct dss_handle *dss;
     struct pho_log log;
     int rc;
@@ -1083,6 +1279,7 @@ int dev_umount(struct lrs_dev *dev)
                    dev->ld_dss_media_info->rsc.id.name,
                    dev->ld_dss_media_info->rsc.id.library, dev->ld_dev_path);
 
+    clock_gettime(CLOCK_REALTIME, &start);
     rc = ldm_fs_umount(fsa, dev->ld_dev_path, dev->ld_mnt_path, &log.message);
     emit_log_after_action(dss, &log, PHO_LTFS_UMOUNT, rc);
     clean_tosync_array(dev, rc);
@@ -1097,6 +1294,8 @@ int dev_umount(struct lrs_dev *dev)
                    dev->ld_mnt_path, lrs_dev_name(dev));
     }
 
+    pho_stat_observe_since(dev->stats.umount_time, &start);
+
     /* update device state and unset mount path */
     MUTEX_LOCK(&dev->ld_mutex);
     dev->ld_op_status = PHO_DEV_OP_ST_LOADED;
@@ -1148,6 +1347,7 @@ int dev_unload(struct lrs_dev *dev)
     /* let the library select the target location */
     struct media_info *unloaded_medium = NULL;
     struct lib_handle lib_hdl;
+    struct timespec start;
     int rc2;
     int rc;
 
@@ -1172,6 +1372,7 @@ int dev_unload(struct lrs_dev *dev)
                    lrs_dev_name(dev),
                    dev_request_kind(dev));
 
+    clock_gettime(CLOCK_REALTIME, &start);
     rc = ldm_lib_unload(&lib_hdl, dev->ld_dss_dev_info->rsc.id.name,
                         dev->ld_dss_media_info->rsc.id.name);
     if (rc != 0) {
@@ -1185,6 +1386,8 @@ int dev_unload(struct lrs_dev *dev)
         LOG_GOTO(out_close, rc, "Media unload failed");
     }
 
+    pho_stat_observe_since(dev->stats.unload_time, &start);
+
     MUTEX_LOCK(&dev->ld_mutex);
     dev->ld_op_status = PHO_DEV_OP_ST_EMPTY;
     unloaded_medium = dev->ld_dss_media_info;
@@ -1244,6 +1447,7 @@ void fail_release_medium(struct lrs_dev *dev, struct media_info *medium)
     int rc;
 
     rc = dss_set_medium_to_failed(&dev->ld_device_thread.dss, medium);
+    dev_catalog_update(dev, medium);
     if (rc) {
         pho_error(rc,
                   "Warning we keep medium (family '%s', name '%s', library "
@@ -1266,6 +1470,7 @@ void fail_release_medium(struct lrs_dev *dev, struct media_info *medium)
 int dev_load(struct lrs_dev *dev, struct media_info *medium)
 {
     struct lib_handle lib_hdl;
+    struct timespec start;
     int rc2;
     int rc;
 
@@ -1285,6 +1490,7 @@ int dev_load(struct lrs_dev *dev, struct media_info *medium)
     if (rc)
         return rc;
 
+    clock_gettime(CLOCK_REALTIME, &start);
     rc = ldm_lib_load(&lib_hdl, dev->ld_dss_dev_info->rsc.id.name,
                       medium->rsc.id.name);
     if (rc) {
@@ -1292,6 +1498,8 @@ int dev_load(struct lrs_dev *dev, struct media_info *medium)
         LOG_GOTO(out_close, rc, "Media load failed");
     }
 
+    pho_stat_observe_since(dev->stats.load_time, &start);
+
     medium = lrs_medium_acquire(&medium->rsc.id);
     if (!medium)
         GOTO(out_close, rc = -errno);
@@ -1386,6 +1594,7 @@ int dev_format(struct lrs_dev *dev, struct fs_adapter_module *fsa, bool unlock)
      */
     rc = dss_media_update(&dev->ld_device_thread.dss, medium, medium, 1,
                           fields);
+    dev_catalog_update(dev, medium);
     if (rc)
         LOG_RETURN(rc,
                    "Successful format of medium (family '%s', name '%s', "
@@ -1396,7 +1605,7 @@ int dev_format(struct lrs_dev *dev, struct fs_adapter_module *fsa, bool unlock)
     return 0;
 }
 
-static void queue_format_response(struct tsqueue *response_queue,
+static void queue_format_response(struct mpsc_queue *response_queue,
                                   struct req_container *reqc)
 {
     struct resp_container *respc = NULL;
@@ -1415,7 +1624,7 @@ static void queue_format_response(struct tsqueue *response_queue,
     respc->resp->format->med_id->library =
         xstrdup_safe(reqc->req->format->med_id->library);
 
-    tsqueue_push(response_queue, respc);
+    mpsc_queue_push(response_queue, respc);
 }
 
 /* must be called with a reference on lrs_dev::ld_dss_media_info */
@@ -1498,7 +1707,7 @@ check_health:
     if (rc && !lost_tlc && medium_to_format->health > 0) {
         /* Push format request back if the error is not caused by the medium */
         /* TODO: use sched retry queue */
-        tsqueue_push(dev->sched_req_queue, reqc);
+        mpsc_queue_push(dev->sched_req_queue, reqc);
         req_requeued = true;
         goto out;
     } else if (rc) {
@@ -1727,7 +1936,7 @@ static void handle_rwalloc_sub_request_result(struct lrs_dev *dev,
         pho_debug("Requeuing %p (%s) on error (health %lu)", sub_request->reqc,
                   pho_srl_request_kind_str(sub_request->reqc->req),
                   rwalloc_medium->alloc_medium->health);
-        tsqueue_push(dev->sched_retry_queue, sub_request);
+        mpsc_queue_push(dev->sched_retry_queue, sub_request);
         goto out_free;
     } else {
         /* First fatal error on rwalloc */
@@ -1741,7 +1950,7 @@ static void handle_rwalloc_sub_request_result(struct lrs_dev *dev,
 try_send_response:
     ended = is_rwalloc_ended(reqc);
     if (!sub_request_rc && ended) {
-        tsqueue_push(dev->ld_response_queue, reqc->params.rwalloc.respc);
+        mpsc_queue_push(dev->ld_response_queue, reqc->params.rwalloc.respc);
         /* do not free the response in sched_req_free */
         reqc->params.rwalloc.respc = NULL;
     }
@@ -1780,6 +1989,7 @@ int dev_mount(struct lrs_dev *dev)
 {
     struct dss_handle *dss = &dev->ld_device_thread.dss;
     struct fs_adapter_module *fsa;
+    struct timespec start;
     struct pho_log log;
     char *mnt_root;
     const char *id;
@@ -1828,6 +2038,7 @@ int dev_mount(struct lrs_dev *dev)
              dev->ld_dss_dev_info->rsc.id.library,
              mnt_root);
 
+    clock_gettime(CLOCK_REALTIME, &start);
     rc = ldm_fs_mount(fsa, dev->ld_dev_path, mnt_root,
                       dev->ld_dss_media_info->fs.label,
                       &log.message);
@@ -1835,6 +2046,8 @@ int dev_mount(struct lrs_dev *dev)
     if (rc)
         goto out_free;
 
+    pho_stat_observe_since(dev->stats.mount_time, &start);
+
     /* update device state and set mount point */
     MUTEX_LOCK(&dev->ld_mutex);
     dev->ld_op_status = PHO_DEV_OP_ST_MOUNTED;
@@ -2021,6 +2234,7 @@ static void cancel_pending_format(struct lrs_dev *device)
                 rc = dss_media_update(&device->ld_device_thread.dss,
                                       medium_to_format, medium_to_format, 1,
                                       ADM_STATUS);
+                dev_catalog_update(device, medium_to_format);
                 if (rc)
                     pho_error(rc,
                               "Unable to set medium (family '%s', name '%s', "
@@ -2041,7 +2255,7 @@ static void cancel_pending_format(struct lrs_dev *device)
 
         if (!rc) {
             /* TODO: use sched error queue */
-            tsqueue_push(device->sched_req_queue, format_request);
+            mpsc_queue_push(device->sched_req_queue, format_request);
             free(device->ld_sub_request);
         } else {
             queue_error_response(device->ld_response_queue, rc, format_request);
@@ -2252,6 +2466,89 @@ static int dev_perform_sync(struct lrs_dev *device, struct thread_info *thread)
     return 0;
 }
 
+/**
+ * Order the extents of \p batch, on the medium mounted in \p dev.
+ *
+ * The extents whose position cannot be read from the filesystem are left out
+ * of the order.
+ */
+static void dev_rao_order(struct lrs_dev *dev, struct media_info *medium,
+                          struct dev_rao_batch *batch)
+{
+    struct ldm_rao_segment *segments;
+    struct dev_adapter_module *deva;
+    struct fs_adapter_module *fsa;
+    size_t count = 0;
+    size_t i;
+    int rc;
+
+    rc = get_fs_adapter(medium->fs.type, &fsa);
+    if (rc)
+        return;
+
+    rc = get_dev_adapter(medium->rsc.id.family, &deva);
+    if (rc)
+        return;
+
+    segments = xmalloc(batch->count * sizeof(*segments));
+
+    for (i = 0; i < batch->count; i++) {
+        struct ldm_rao_segment *segment = &segments[count];
+
+        if (!batch->addresses[i])
+            continue;
+
+        rc = ldm_fs_file_position(fsa, dev->ld_mnt_path, batch->addresses[i],
+                                  &segment->partition, &segment->begin,
+                                  &segment->end);
+        if (rc == -ENOTSUP)
+            /* the other files will not have a position either */
+            break;
+        if (rc)
+            continue;
+
+        segment->index = i;
+        count++;
+    }
+
+    if (count >= 2) {
+        ldm_rao_order(deva, dev->ld_dev_path, segments, count);
+
+        for (i = 0; i < count; i++)
+            batch->order[i] = segments[i].index;
+        batch->n_ordered = count;
+    }
+
+    free(segments);
+}
+
+/**
+ * Order the pending RAO batch of \p dev and hand it back to the scheduler.
+ *
+ * Must be called without ongoing I/O, so that the medium stays mounted.
+ */
+static void dev_handle_rao(struct lrs_dev *dev)
+{
+    struct dev_rao_batch *batch;
+    struct media_info *medium;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    batch = dev->ld_rao_request;
+    dev->ld_rao_request = NULL;
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    medium = atomic_dev_medium_get(dev);
+    if (medium && dev_is_mounted(dev) &&
+        pho_id_equal(&medium->rsc.id, &batch->medium))
+        dev_rao_order(dev, medium, batch);
+    lrs_medium_release(medium);
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    dev_rao_batch_free(dev->ld_rao_result);
+    dev->ld_rao_result = batch;
+    MUTEX_UNLOCK(&dev->ld_mutex);
+}
+
 /**
  * Main device thread loop.
  */
@@ -2320,6 +2617,10 @@ static void *lrs_dev_thread(void *tdata)
             }
         }
 
+        if (!device->ld_ongoing_io && !device->ld_sub_request &&
+            device->ld_rao_request)
+            dev_handle_rao(device);
+
         if (!thread_is_stopped(thread)) {
             rc = dev_wait_for_signal(device);
             if (rc < 0) {
@@ -2634,6 +2935,7 @@ static int dev_medium_switch_mount(struct lrs_dev *dev,
         rc2 = dss_media_update(&dev->ld_device_thread.dss,
                                dev->ld_dss_media_info, dev->ld_dss_media_info,
                                1, FS_STATUS);
+        dev_catalog_update(dev, dev->ld_dss_media_info);
         if (rc2) {
             rc = rc2;
             context->failure_on_device = true;
@@ -2679,6 +2981,88 @@ struct media_info *atomic_dev_medium_get(struct lrs_dev *device)
     return medium;
 }
 
+void dev_write_stream_pin(struct lrs_dev *dev, const char *key,
+                          const struct pho_id *medium,
+                          const struct timespec *idle)
+{
+    struct dev_write_stream *stream = &dev->ld_write_stream;
+
+    if (!stream->key || strcmp(stream->key, key)) {
+        free(stream->key);
+        stream->key = xstrdup(key);
+    }
+
+    stream->medium = *medium;
+    stream->idle = *idle;
+    clock_gettime(CLOCK_REALTIME, &stream->last_use);
+}
+
+bool dev_rao_submit(struct lrs_dev *dev, struct dev_rao_batch *batch)
+{
+    bool submitted = false;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    if (thread_is_running(&dev->ld_device_thread) && !dev->ld_rao_request &&
+        !dev->ld_rao_result) {
+        dev->ld_rao_request = batch;
+        submitted = true;
+    }
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    if (submitted)
+        thread_signal(&dev->ld_device_thread);
+
+    return submitted;
+}
+
+struct dev_rao_batch *dev_rao_fetch(struct lrs_dev *dev)
+{
+    struct dev_rao_batch *batch;
+
+    MUTEX_LOCK(&dev->ld_mutex);
+    batch = dev->ld_rao_result;
+    dev->ld_rao_result = NULL;
+    MUTEX_UNLOCK(&dev->ld_mutex);
+
+    return batch;
+}
+
+void dev_rao_batch_free(struct dev_rao_batch *batch)
+{
+    size_t i;
+
+    if (!batch)
+        return;
+
+    for (i = 0; i < batch->count; i++)
+        free(batch->addresses[i]);
+
+    free(batch->addresses);
+    free(batch->order);
+    free(batch);
+}
+
+void dev_write_stream_unpin(struct lrs_dev *dev)
+{
+    free(dev->ld_write_stream.key);
+    dev->ld_write_stream.key = NULL;
+}
+
+bool dev_write_stream_is_active(struct lrs_dev *dev, const char *key)
+{
+    struct dev_write_stream *stream = &dev->ld_write_stream;
+
+    if (!stream->key || (key && strcmp(stream->key, key)))
+        return false;
+
+    /* the stream ends when its medium is unloaded */
+    if (!dev->ld_dss_media_info ||
+        !pho_id_equal(&dev->ld_dss_media_info->rsc.id, &stream->medium))
+        return false;
+
+    return !is_past(add_timespec(&stream->last_use, &stream->idle));
+}
+
 ssize_t atomic_dev_medium_phys_space_free(struct lrs_dev *dev)
 {
     struct media_info *medium;
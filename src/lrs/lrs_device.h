@@ -29,14 +29,18 @@
 #include <pthread.h>
 #include <stdbool.h>
 #include <stdatomic.h>
+#include <time.h>
 
 #include "lrs_thread.h"
 
 #include "pho_dss.h"
 #include "pho_ldm.h"
+#include "pho_mpsc_queue.h"
 #include "pho_types.h"
 #include "pho_stats.h"
 
+struct lrs_dss_writer;
+struct lrs_media_catalog;
 struct lrs_sched;
 struct lrs_dev;
 
@@ -62,6 +66,25 @@ struct lrs_dev_hdl {
     unsigned long   sync_wsize_kb; /**< Written size threshold for
                                      *  medium synchronization
                                      */
+    struct timespec sync_ack_target;
+                                   /**< Latency target between a release and
+                                    *   its sync, 0 to only follow the static
+                                    *   thresholds above
+                                    */
+    struct timespec write_stream_idle;
+                                   /**< Time a medium stays pinned to its write
+                                    *   stream after its last I/O, 0 to disable
+                                    *   write streaming
+                                    */
+    struct lrs_dss_writer *ldh_dss_writer;
+                                   /**< Writer of the media updates queued on
+                                    *   release, flushed before a sync, may be
+                                    *   NULL
+                                    */
+    struct lrs_media_catalog *ldh_catalog;
+                                   /**< Catalog of the media, told about the
+                                    *   media updates, may be NULL
+                                    */
 };
 
 /** Request pushed to a device */
@@ -174,6 +197,26 @@ int dev_umount(struct lrs_dev *dev);
  */
 int dev_unload(struct lrs_dev *dev);
 
+/**
+ * Adaptive synchronization policy of a device.
+ *
+ * The first of N releases batched every I ms waits (N - 1) * I + S ms for its
+ * sync ack, S being the duration of the sync. With an ack latency target T,
+ * the thresholds are lowered to N = 1 + (T - S) / I requests and T - S ms, from
+ * the moving averages of I and S measured on the device.
+ */
+struct sync_policy {
+    struct timespec  last_release;  /**< date of the last release to sync */
+    double           interval_ms;   /**< moving average of the interval
+                                      *  between two releases, 0 if unknown
+                                      */
+    double           sync_cost_ms;  /**< moving average of the sync
+                                      *  durations, 0 if unknown
+                                      */
+    unsigned int     nb_req;        /**< number of requests threshold */
+    struct timespec  time;          /**< time threshold */
+};
+
 /**
  * Parameters to check when a synchronization is required.
  */
@@ -195,6 +238,7 @@ struct sync_params {
                                     /**< A new grouping was added to the medium.
                                      *   The grouping field need to be updated.
                                      */
+    struct sync_policy policy;      /**< thresholds in use */
 };
 
 /** exported stats per device */
@@ -217,6 +261,55 @@ struct dev_stats {
     struct pho_stat *tosync_extents;
     struct pho_stat *total_tosync_size;
     struct pho_stat *total_tosync_extents;
+    /* inputs and decisions of the synchronization policy */
+    struct pho_stat *sync_interval_ms;
+    struct pho_stat *sync_cost_ms;
+    struct pho_stat *sync_threshold_nb_req;
+    struct pho_stat *sync_threshold_ms;
+    struct pho_stat *sync_on_nb_req;
+    struct pho_stat *sync_on_time;
+    struct pho_stat *sync_on_size;
+    /* histograms of the durations of the successful operations, in us */
+    struct pho_stat *mount_time;
+    struct pho_stat *umount_time;
+    struct pho_stat *load_time;
+    struct pho_stat *unload_time;
+    struct pho_stat *sync_time;
+};
+
+/**
+ * Write stream pinned on the medium loaded in a device.
+ *
+ * A stream gathers the writes with the same library, grouping and tags. While
+ * it is active, the next writes of the stream are allocated to the pinned
+ * medium first and the medium is not swapped out for another one.
+ */
+struct dev_write_stream {
+    char           *key;      /**< key of the stream, NULL if none */
+    struct pho_id   medium;   /**< pinned medium */
+    struct timespec idle;     /**< idle timeout of the stream */
+    struct timespec last_use; /**< date of the last allocation or I/O */
+};
+
+/**
+ * Batch of extents of the medium loaded in a device, to order by the
+ * Recommended Access Order of the drive.
+ *
+ * The position lookup and the RAO exchange access the mounted filesystem and
+ * the drive, so they are done by the device thread, which owns them, instead
+ * of the I/O scheduler. The scheduler submits a batch with dev_rao_submit and
+ * gets it back ordered with dev_rao_fetch.
+ */
+struct dev_rao_batch {
+    struct pho_id   medium;     /**< medium holding the extents */
+    size_t          count;      /**< number of extents */
+    char          **addresses;  /**< addresses of the extents on the medium */
+    size_t         *order;      /**< indexes of the extents in access order,
+                                  *  filled by the device thread
+                                  */
+    size_t          n_ordered;  /**< number of indexes in order, the extents
+                                  *  whose position is unknown are left out
+                                  */
 };
 
 /**
@@ -301,17 +394,17 @@ struct lrs_dev {
     struct sync_params   ld_sync_params;        /**< pending synchronization
                                                   * requests
                                                   */
-    struct tsqueue      *ld_response_queue;     /**< reference to the response
+    struct mpsc_queue   *ld_response_queue;     /**< reference to the response
                                                   * queue
                                                   */
     struct format_media *ld_ongoing_format;     /**< reference to the ongoing
                                                   * format array
                                                   */
     /* TODO: move sched_req_queue use to sched_retry_queue */
-    struct tsqueue      *sched_req_queue;       /**< reference to the sched
+    struct mpsc_queue   *sched_req_queue;       /**< reference to the sched
                                                   * request queue
                                                   */
-    struct tsqueue      *sched_retry_queue;     /**< reference to the sched
+    struct mpsc_queue   *sched_retry_queue;     /**< reference to the sched
                                                   * retry queue
                                                   */
     struct lrs_dev_hdl  *ld_handle;
@@ -330,6 +423,17 @@ struct lrs_dev {
                                  * algorithm for now.
                                  */
 
+    struct dev_write_stream ld_write_stream;    /**< write stream pinned on
+                                                  *  the loaded medium,
+                                                  *  protected by ld_mutex
+                                                  */
+    struct dev_rao_batch *ld_rao_request;       /**< RAO batch to order,
+                                                  *  protected by ld_mutex
+                                                  */
+    struct dev_rao_batch *ld_rao_result;        /**< ordered RAO batch,
+                                                  *  protected by ld_mutex
+                                                  */
+
     struct dev_stats    stats; /**< exported device stats */
 };
 
@@ -341,6 +445,9 @@ struct lrs_dev {
 static inline void dev_clean_io(struct lrs_dev *dev, bool let_for_partial)
 {
     dev->ld_ongoing_io = false;
+    /* the idle time of a write stream starts at the end of its last I/O */
+    if (dev->ld_write_stream.key)
+        clock_gettime(CLOCK_REALTIME, &dev->ld_write_stream.last_use);
     if (!let_for_partial) {
         dev->ld_ongoing_socket_id = -1;
         if (dev->ld_ongoing_grouping) {
@@ -377,7 +484,7 @@ static inline bool dev_is_release_ready(struct lrs_dev *dev)
 
 bool is_request_tosync_ended(struct req_container *req);
 
-void queue_release_response(struct tsqueue *response_queue,
+void queue_release_response(struct mpsc_queue *response_queue,
                             struct req_container *reqc);
 
 static inline bool dev_is_sched_ready(struct lrs_dev *dev)
@@ -412,6 +519,44 @@ static inline bool is_device_shared_between_schedulers(struct lrs_dev *dev)
 void push_new_sync_to_device(struct lrs_dev *dev, struct req_container *reqc,
                              size_t medium_index);
 
+/**
+ * Initialize the synchronization policy of a device with the static thresholds
+ *
+ * \param[out]  policy  policy to initialize
+ * \param[in]   handle  device handle holding the thresholds
+ */
+void sync_policy_init(struct sync_policy *policy,
+                      const struct lrs_dev_hdl *handle);
+
+/**
+ * Record a new release to sync in the synchronization policy of a device
+ *
+ * \param[in,out]   policy  policy of the device
+ * \param[in]       date    date of the release
+ */
+void sync_policy_observe_release(struct sync_policy *policy,
+                                 const struct timespec *date);
+
+/**
+ * Record the duration of a sync in the synchronization policy of a device
+ *
+ * \param[in,out]   policy      policy of the device
+ * \param[in]       duration    duration of the sync
+ */
+void sync_policy_observe_sync(struct sync_policy *policy,
+                              const struct timespec *duration);
+
+/**
+ * Compute the thresholds of the synchronization policy of a device, bounded by
+ * the static thresholds of its handle
+ *
+ * \param[in,out]   policy  policy of the device
+ * \param[in]       handle  device handle holding the static thresholds and the
+ *                          ack latency target
+ */
+void sync_policy_update(struct sync_policy *policy,
+                        const struct lrs_dev_hdl *handle);
+
 /**
  * Synchronize the medium of a device
  *
@@ -586,6 +731,70 @@ ssize_t atomic_dev_medium_phys_space_free(struct lrs_dev *dev);
 
 void fail_release_medium(struct lrs_dev *dev, struct media_info *medium);
 
+/**
+ * Pin a write stream on a medium of a device, replacing the previous stream of
+ * the device if any. The stream is active once the medium is loaded.
+ *
+ * Must be called with the device lock.
+ *
+ * \param[in,out]   dev     device
+ * \param[in]       key     key of the stream, see write_stream_key
+ * \param[in]       medium  medium loaded or to load in the device
+ * \param[in]       idle    idle timeout of the stream
+ */
+void dev_write_stream_pin(struct lrs_dev *dev, const char *key,
+                          const struct pho_id *medium,
+                          const struct timespec *idle);
+
+/**
+ * Remove the write stream pinned on a device, if any.
+ *
+ * \param[in,out]   dev     device
+ */
+void dev_write_stream_unpin(struct lrs_dev *dev);
+
+/**
+ * Tell whether a write stream is pinned on the medium currently loaded in a
+ * device and was used less than its idle timeout ago.
+ *
+ * Must be called with the device lock.
+ *
+ * \param[in]   dev     device
+ * \param[in]   key     key the stream must have, NULL for any stream
+ *
+ * \return              true if the stream is active
+ */
+bool dev_write_stream_is_active(struct lrs_dev *dev, const char *key);
+
+/**
+ * Submit a batch of extents to order to the device thread, which orders it
+ * once the device has no ongoing I/O.
+ *
+ * \param[in,out]   dev     device whose medium holds the extents
+ * \param[in]       batch   batch to order, owned by the device on success
+ *
+ * \return                  true if the batch is submitted, false if the
+ *                          device already has a batch or is stopping
+ */
+bool dev_rao_submit(struct lrs_dev *dev, struct dev_rao_batch *batch);
+
+/**
+ * Get the batch ordered by the device thread, if any.
+ *
+ * \param[in,out]   dev     device
+ *
+ * \return                  ordered batch, to free with dev_rao_batch_free,
+ *                          or NULL if none is ready
+ */
+struct dev_rao_batch *dev_rao_fetch(struct lrs_dev *dev);
+
+/**
+ * Free a RAO batch.
+ *
+ * \param[in]       batch   batch to free, may be NULL
+ */
+void dev_rao_batch_free(struct dev_rao_batch *batch);
+
 int dev_stats_init(struct lrs_dev *dev);
 
 void dev_stats_destroy(struct lrs_dev *dev);
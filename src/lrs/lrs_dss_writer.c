@@ -0,0 +1,228 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  LRS asynchronous DSS writer implementation
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+
+#include "lrs_cfg.h"
+#include "lrs_dss_writer.h"
+#include "pho_cfg.h"
+#include "pho_common.h"
+#include "pho_dss.h"
+#include "pho_type_utils.h"
+
+/** Default maximum delay of a queued update, in milliseconds */
+#define DSS_FLUSH_MS_DEFAULT 1000
+
+static GHashTable *pending_updates_new(void)
+{
+    /* the keys are the ids of the media_info values */
+    return g_hash_table_new_full(g_pho_id_hash, g_pho_id_equal, NULL, free);
+}
+
+/** Write a batch of pending updates in one transaction */
+static int write_updates(struct dss_handle *dss, GHashTable *batch)
+{
+    guint count = g_hash_table_size(batch);
+    struct media_info *media;
+    GHashTableIter iter;
+    gpointer value;
+    guint i = 0;
+    int rc;
+
+    media = xcalloc(count, sizeof(*media));
+
+    g_hash_table_iter_init(&iter, batch);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+        media[i++] = *(struct media_info *)value;
+
+    rc = dss_media_update(dss, media, media, count, PHYS_SPC_FREE);
+    if (rc)
+        pho_error(rc, "Failed to write the free space of %u media", count);
+    else
+        pho_debug("Wrote the free space of %u media", count);
+
+    free(media);
+
+    return rc;
+}
+
+static void *lrs_dss_writer_thread(void *data)
+{
+    struct lrs_dss_writer *writer = data;
+    struct thread_info *thread = &writer->thread;
+
+    MUTEX_LOCK(&writer->mutex);
+    while (true) {
+        GHashTable *batch;
+        uint64_t first;
+        uint64_t last;
+        int rc;
+
+        if (g_hash_table_size(writer->pending) == 0) {
+            if (!thread_is_running(thread))
+                break;
+
+            pthread_cond_wait(&writer->cond, &writer->mutex);
+            continue;
+        }
+
+        /* Let more updates be coalesced, unless a flush is waited for */
+        if (thread_is_running(thread) && writer->wanted <= writer->flushed) {
+            rc = pthread_cond_timedwait(&writer->cond, &writer->mutex,
+                                        &writer->deadline);
+            if (rc != ETIMEDOUT)
+                continue;
+        }
+
+        batch = writer->pending;
+        writer->pending = pending_updates_new();
+        first = writer->flushed + 1;
+        last = writer->queued;
+        MUTEX_UNLOCK(&writer->mutex);
+
+        rc = write_updates(&thread->dss, batch);
+        g_hash_table_destroy(batch);
+
+        MUTEX_LOCK(&writer->mutex);
+        writer->flushed = last;
+        if (rc) {
+            writer->failed_first = first;
+            writer->failed_last = last;
+            writer->failed_rc = rc;
+        }
+        pthread_cond_broadcast(&writer->cond);
+    }
+    MUTEX_UNLOCK(&writer->mutex);
+
+    thread->state = THREAD_STOPPED;
+    pthread_exit(&thread->status);
+}
+
+int lrs_dss_writer_init(struct lrs_dss_writer *writer)
+{
+    int flush_ms;
+    int rc;
+
+    flush_ms = PHO_CFG_GET_INT(cfg_lrs, PHO_CFG_LRS, dss_flush_ms,
+                               DSS_FLUSH_MS_DEFAULT);
+    if (flush_ms < 0)
+        LOG_RETURN(-EINVAL, "Invalid value for lrs dss_flush_ms: %d",
+                   flush_ms);
+
+    writer->flush_delay.tv_sec = flush_ms / 1000;
+    writer->flush_delay.tv_nsec = (flush_ms % 1000) * 1000000;
+
+    rc = dss_init(&writer->thread.dss);
+    if (rc)
+        LOG_RETURN(rc, "Failed to init DSS writer handle");
+
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+    writer->pending = pending_updates_new();
+    writer->queued = 0;
+    writer->flushed = 0;
+    writer->wanted = 0;
+    writer->failed_first = 1;
+    writer->failed_last = 0;
+    writer->failed_rc = 0;
+
+    rc = thread_init(&writer->thread, lrs_dss_writer_thread, writer);
+    if (rc) {
+        g_hash_table_destroy(writer->pending);
+        pthread_cond_destroy(&writer->cond);
+        pthread_mutex_destroy(&writer->mutex);
+        dss_fini(&writer->thread.dss);
+        LOG_RETURN(-rc, "Could not create the DSS writer thread");
+    }
+
+    return 0;
+}
+
+void lrs_dss_writer_fini(struct lrs_dss_writer *writer)
+{
+    MUTEX_LOCK(&writer->mutex);
+    writer->thread.state = THREAD_STOPPING;
+    pthread_cond_broadcast(&writer->cond);
+    MUTEX_UNLOCK(&writer->mutex);
+
+    thread_wait_end(&writer->thread);
+
+    g_hash_table_destroy(writer->pending);
+    pthread_cond_destroy(&writer->cond);
+    pthread_mutex_destroy(&writer->mutex);
+    dss_fini(&writer->thread.dss);
+}
+
+void lrs_dss_writer_phys_spc_free(struct lrs_dss_writer *writer,
+                                  const struct media_info *medium)
+{
+    struct media_info *update;
+
+    MUTEX_LOCK(&writer->mutex);
+    update = g_hash_table_lookup(writer->pending, &medium->rsc.id);
+    if (!update) {
+        if (g_hash_table_size(writer->pending) == 0) {
+            struct timespec now;
+
+            clock_gettime(CLOCK_REALTIME, &now);
+            writer->deadline = add_timespec(&now, &writer->flush_delay);
+            pthread_cond_broadcast(&writer->cond);
+        }
+
+        update = xcalloc(1, sizeof(*update));
+        update->rsc.id = medium->rsc.id;
+        g_hash_table_insert(writer->pending, &update->rsc.id, update);
+    }
+
+    update->stats.phys_spc_free = medium->stats.phys_spc_free;
+    writer->queued++;
+    MUTEX_UNLOCK(&writer->mutex);
+}
+
+int lrs_dss_writer_flush(struct lrs_dss_writer *writer)
+{
+    uint64_t target;
+    int rc = 0;
+
+    MUTEX_LOCK(&writer->mutex);
+    target = writer->queued;
+    if (writer->flushed < target) {
+        if (writer->wanted < target)
+            writer->wanted = target;
+
+        pthread_cond_broadcast(&writer->cond);
+        while (writer->flushed < target)
+            pthread_cond_wait(&writer->cond, &writer->mutex);
+    }
+
+    if (target >= writer->failed_first && target <= writer->failed_last)
+        rc = writer->failed_rc;
+    MUTEX_UNLOCK(&writer->mutex);
+
+    return rc;
+}
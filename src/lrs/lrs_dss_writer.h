@@ -0,0 +1,107 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  LRS asynchronous DSS writer
+ *
+ * The media updates of the release path are queued to a writer thread instead
+ * of being written by the communication thread. The updates of a medium are
+ * coalesced in memory until they are flushed, in one transaction for all the
+ * media, at most "dss_flush_ms" milliseconds after being queued.
+ */
+#ifndef _PHO_LRS_DSS_WRITER_H
+#define _PHO_LRS_DSS_WRITER_H
+
+#include <glib.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "lrs_thread.h"
+
+#include "pho_types.h"
+
+struct lrs_dss_writer {
+    struct thread_info thread;      /**< writer thread, with its DSS handle */
+    pthread_mutex_t    mutex;       /**< protects the fields below */
+    pthread_cond_t     cond;        /**< signaled when updates are queued or
+                                      *  flushed, and on flush requests
+                                      */
+    GHashTable        *pending;     /**< pending updates, as struct
+                                      *  media_info indexed by medium id
+                                      */
+    struct timespec    deadline;    /**< date at which the oldest pending
+                                      *  update must be flushed
+                                      */
+    struct timespec    flush_delay; /**< maximum delay of a queued update */
+    uint64_t           queued;      /**< generation of the last queued
+                                      *  update
+                                      */
+    uint64_t           flushed;     /**< generation of the last written
+                                      *  update
+                                      */
+    uint64_t           wanted;      /**< generation some caller waits for */
+    uint64_t           failed_first; /**< generations of the last batch */
+    uint64_t           failed_last;  /**< that failed to be written */
+    int                failed_rc;   /**< error of the last failed batch */
+};
+
+/**
+ * Initialize a DSS writer and start its thread.
+ *
+ * \param[out]  writer  DSS writer to initialize
+ *
+ * \return              0 on success, negative error code on failure
+ */
+int lrs_dss_writer_init(struct lrs_dss_writer *writer);
+
+/**
+ * Flush the pending updates, then stop the writer thread and release its
+ * resources.
+ *
+ * \param[in]   writer  DSS writer to finalize
+ */
+void lrs_dss_writer_fini(struct lrs_dss_writer *writer);
+
+/**
+ * Queue the update of the free physical space of a medium.
+ *
+ * The value is copied: it replaces any value of the same medium that is not
+ * flushed yet.
+ *
+ * \param[in]   writer  DSS writer
+ * \param[in]   medium  medium whose rsc.id and stats.phys_spc_free to write
+ */
+void lrs_dss_writer_phys_spc_free(struct lrs_dss_writer *writer,
+                                  const struct media_info *medium);
+
+/**
+ * Flush the pending updates and wait for the ones queued before this call to be
+ * written in the DSS.
+ *
+ * \param[in]   writer  DSS writer
+ *
+ * \return              0 on success, the error of the failed transaction
+ *                      otherwise
+ */
+int lrs_dss_writer_flush(struct lrs_dss_writer *writer);
+
+#endif
@@ -0,0 +1,449 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  LRS in-memory media catalog implementation
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lrs_cfg.h"
+#include "lrs_dss_writer.h"
+#include "lrs_media_catalog.h"
+#include "pho_cfg.h"
+#include "pho_common.h"
+#include "pho_type_utils.h"
+
+/** Default delay between two reconciliations, in milliseconds */
+#define MEDIA_CATALOG_SYNC_MS_DEFAULT 60000
+
+/** Medium of the catalog */
+struct catalog_medium {
+    struct media_info  medium;     /**< copy of the medium */
+    GSequenceIter     *by_free;    /**< position in the free space order */
+    uint64_t           generation; /**< catalog generation of the last update
+                                     *  of the medium
+                                     */
+    uint64_t           n_syncs;    /**< last reconciliation that found the
+                                     *  medium in the DSS
+                                     */
+};
+
+static void catalog_medium_free(void *data)
+{
+    struct catalog_medium *cm = data;
+
+    media_info_cleanup(&cm->medium);
+    free(cm);
+}
+
+/** Order the media by free space, then by id */
+static gint cmp_free(gconstpointer a, gconstpointer b, gpointer udata)
+{
+    const struct catalog_medium *ma = a;
+    const struct catalog_medium *mb = b;
+    int rc;
+
+    (void)udata;
+
+    if (ma->medium.stats.phys_spc_free != mb->medium.stats.phys_spc_free)
+        return ma->medium.stats.phys_spc_free < mb->medium.stats.phys_spc_free ?
+                   -1 : 1;
+
+    rc = strcmp(ma->medium.rsc.id.library, mb->medium.rsc.id.library);
+    if (rc)
+        return rc;
+
+    return strcmp(ma->medium.rsc.id.name, mb->medium.rsc.id.name);
+}
+
+static int cmp_media_free(const void *a, const void *b)
+{
+    return cmp_free(*(struct catalog_medium * const *)a,
+                    *(struct catalog_medium * const *)b, NULL);
+}
+
+static GHashTable *index_new(void)
+{
+    return g_hash_table_new_full(g_str_hash, g_str_equal, free,
+                                 (GDestroyNotify)g_hash_table_destroy);
+}
+
+static void index_add(GHashTable *index, const char *key,
+                      struct catalog_medium *cm)
+{
+    GHashTable *set = g_hash_table_lookup(index, key);
+
+    if (!set) {
+        set = g_hash_table_new(NULL, NULL);
+        g_hash_table_insert(index, xstrdup(key), set);
+    }
+
+    g_hash_table_add(set, cm);
+}
+
+static void index_remove(GHashTable *index, const char *key,
+                         struct catalog_medium *cm)
+{
+    GHashTable *set = g_hash_table_lookup(index, key);
+
+    if (!set)
+        return;
+
+    g_hash_table_remove(set, cm);
+    if (g_hash_table_size(set) == 0)
+        g_hash_table_remove(index, key);
+}
+
+static void catalog_index(struct lrs_media_catalog *catalog,
+                          struct catalog_medium *cm)
+{
+    struct media_info *medium = &cm->medium;
+    size_t i;
+
+    cm->by_free = g_sequence_insert_sorted(catalog->by_free, cm, cmp_free,
+                                           NULL);
+    index_add(catalog->libraries, medium->rsc.id.library, cm);
+    for (i = 0; i < medium->groupings.count; i++)
+        index_add(catalog->groupings, medium->groupings.strings[i], cm);
+    for (i = 0; i < medium->tags.count; i++)
+        index_add(catalog->tags, medium->tags.strings[i], cm);
+}
+
+static void catalog_unindex(struct lrs_media_catalog *catalog,
+                            struct catalog_medium *cm)
+{
+    struct media_info *medium = &cm->medium;
+    size_t i;
+
+    g_sequence_remove(cm->by_free);
+    cm->by_free = NULL;
+    index_remove(catalog->libraries, medium->rsc.id.library, cm);
+    for (i = 0; i < medium->groupings.count; i++)
+        index_remove(catalog->groupings, medium->groupings.strings[i], cm);
+    for (i = 0; i < medium->tags.count; i++)
+        index_remove(catalog->tags, medium->tags.strings[i], cm);
+}
+
+/** Insert or replace a medium, called with the catalog mutex */
+static struct catalog_medium *catalog_upsert(struct lrs_media_catalog *catalog,
+                                             const struct media_info *medium,
+                                             uint64_t generation)
+{
+    struct catalog_medium *cm;
+
+    cm = g_hash_table_lookup(catalog->media, &medium->rsc.id);
+    if (cm) {
+        catalog_unindex(catalog, cm);
+        media_info_cleanup(&cm->medium);
+        /* the key of the medium keeps the same value */
+        media_info_copy(&cm->medium, medium);
+    } else {
+        cm = xcalloc(1, sizeof(*cm));
+        media_info_copy(&cm->medium, medium);
+        g_hash_table_insert(catalog->media, &cm->medium.rsc.id, cm);
+    }
+
+    cm->generation = generation;
+    catalog_index(catalog, cm);
+
+    return cm;
+}
+
+int lrs_media_catalog_init(struct lrs_media_catalog *catalog,
+                           enum rsc_family family,
+                           struct lrs_dss_writer *writer)
+{
+    int sync_ms;
+    int rc;
+
+    sync_ms = PHO_CFG_GET_INT(cfg_lrs, PHO_CFG_LRS, media_catalog_sync_ms,
+                              MEDIA_CATALOG_SYNC_MS_DEFAULT);
+    if (sync_ms < 0)
+        LOG_RETURN(-EINVAL, "Invalid value for lrs media_catalog_sync_ms: %d",
+                   sync_ms);
+
+    rc = pthread_mutex_init(&catalog->mutex, NULL);
+    if (rc)
+        LOG_RETURN(-rc, "Unable to init media catalog mutex");
+
+    catalog->family = family;
+    catalog->writer = writer;
+    catalog->sync_period.tv_sec = sync_ms / 1000;
+    catalog->sync_period.tv_nsec = (sync_ms % 1000) * 1000000;
+    catalog->media = g_hash_table_new_full(g_pho_id_hash, g_pho_id_equal, NULL,
+                                           catalog_medium_free);
+    catalog->by_free = g_sequence_new(NULL);
+    catalog->libraries = index_new();
+    catalog->groupings = index_new();
+    catalog->tags = index_new();
+    catalog->generation = 0;
+    catalog->n_syncs = 0;
+    catalog->synced.tv_sec = 0;
+    catalog->synced.tv_nsec = 0;
+
+    return 0;
+}
+
+void lrs_media_catalog_fini(struct lrs_media_catalog *catalog)
+{
+    int rc;
+
+    g_hash_table_destroy(catalog->tags);
+    g_hash_table_destroy(catalog->groupings);
+    g_hash_table_destroy(catalog->libraries);
+    g_sequence_free(catalog->by_free);
+    g_hash_table_destroy(catalog->media);
+
+    rc = pthread_mutex_destroy(&catalog->mutex);
+    if (rc)
+        pho_error(-rc, "Unable to destroy media catalog mutex");
+}
+
+int lrs_media_catalog_sync(struct lrs_media_catalog *catalog,
+                           struct dss_handle *dss)
+{
+    struct catalog_medium *cm;
+    struct dss_filter filter;
+    struct media_info *media;
+    GHashTableIter iter;
+    uint64_t start;
+    gpointer value;
+    int count;
+    int rc;
+    int i;
+
+    MUTEX_LOCK(&catalog->mutex);
+    start = catalog->generation;
+    MUTEX_UNLOCK(&catalog->mutex);
+
+    /* the updates reported before this point must be read back from the DSS */
+    if (catalog->writer) {
+        rc = lrs_dss_writer_flush(catalog->writer);
+        if (rc)
+            pho_warn("Failed to write the pending media updates before "
+                     "reconciling the media catalog (rc=%d)", rc);
+    }
+
+    rc = dss_filter_build(&filter, "{\"DSS::MDA::family\": \"%s\"}",
+                          rsc_family2str(catalog->family));
+    if (rc)
+        return rc;
+
+    rc = dss_media_get(dss, &filter, &media, &count, NULL);
+    dss_filter_free(&filter);
+    if (rc)
+        LOG_RETURN(rc, "Failed to load the media of family '%s'",
+                   rsc_family2str(catalog->family));
+
+    MUTEX_LOCK(&catalog->mutex);
+    catalog->n_syncs++;
+    for (i = 0; i < count; i++) {
+        cm = g_hash_table_lookup(catalog->media, &media[i].rsc.id);
+        /* updated meanwhile, the DSS value may be older */
+        if (!cm || cm->generation <= start)
+            cm = catalog_upsert(catalog, &media[i], start);
+
+        cm->n_syncs = catalog->n_syncs;
+    }
+
+    /* media removed from the DSS */
+    g_hash_table_iter_init(&iter, catalog->media);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        cm = value;
+        if (cm->n_syncs == catalog->n_syncs || cm->generation > start)
+            continue;
+
+        catalog_unindex(catalog, cm);
+        g_hash_table_iter_remove(&iter);
+    }
+
+    clock_gettime(CLOCK_REALTIME, &catalog->synced);
+    pho_debug("Media catalog of family '%s' reconciled: %u media",
+              rsc_family2str(catalog->family),
+              g_hash_table_size(catalog->media));
+    MUTEX_UNLOCK(&catalog->mutex);
+
+    dss_res_free(media, count);
+
+    return 0;
+}
+
+bool lrs_media_catalog_is_stale(struct lrs_media_catalog *catalog,
+                                const struct timespec *delay)
+{
+    struct timespec deadline;
+
+    MUTEX_LOCK(&catalog->mutex);
+    deadline = add_timespec(&catalog->synced,
+                            delay ? delay : &catalog->sync_period);
+    MUTEX_UNLOCK(&catalog->mutex);
+
+    return is_past(deadline);
+}
+
+void lrs_media_catalog_update(struct lrs_media_catalog *catalog,
+                              const struct media_info *medium)
+{
+    if (medium->rsc.id.family != catalog->family)
+        return;
+
+    MUTEX_LOCK(&catalog->mutex);
+    catalog_upsert(catalog, medium, ++catalog->generation);
+    MUTEX_UNLOCK(&catalog->mutex);
+}
+
+static bool medium_matches(const struct media_info *medium,
+                           const struct lrs_catalog_filter *filter)
+{
+    if (!medium->flags.put ||
+        medium->rsc.adm_status != PHO_RSC_ADM_ST_UNLOCKED)
+        return false;
+
+    if (medium->fs.status != PHO_FS_STATUS_EMPTY &&
+        (filter->empty_medium || medium->fs.status != PHO_FS_STATUS_USED))
+        return false;
+
+    if (filter->min_free >= 0 &&
+        medium->stats.phys_spc_free <= filter->min_free)
+        return false;
+
+    if (filter->library && strcmp(medium->rsc.id.library, filter->library))
+        return false;
+
+    if (filter->grouping &&
+        !string_exists(&medium->groupings, filter->grouping))
+        return false;
+
+    if (filter->tags && filter->tags->count > 0 &&
+        !string_array_in(&medium->tags, filter->tags))
+        return false;
+
+    return true;
+}
+
+/**
+ * Choose the smallest index set that contains all the matching media.
+ *
+ * \return  false if no medium can match, otherwise true, with \p set NULL if
+ *          no index applies to the filter
+ */
+static bool filter_smallest_set(struct lrs_media_catalog *catalog,
+                                const struct lrs_catalog_filter *filter,
+                                GHashTable **set)
+{
+    GHashTable *candidate;
+    size_t i;
+
+    *set = NULL;
+
+#define CONSIDER(_index, _key)                                          \
+    do {                                                                \
+        candidate = g_hash_table_lookup(_index, _key);                  \
+        if (!candidate)                                                 \
+            return false;                                               \
+        if (!*set ||                                                    \
+            g_hash_table_size(candidate) < g_hash_table_size(*set))     \
+            *set = candidate;                                           \
+    } while (0)
+
+    if (filter->library)
+        CONSIDER(catalog->libraries, filter->library);
+    if (filter->grouping)
+        CONSIDER(catalog->groupings, filter->grouping);
+    for (i = 0; filter->tags && i < filter->tags->count; i++)
+        CONSIDER(catalog->tags, filter->tags->strings[i]);
+
+#undef CONSIDER
+
+    return true;
+}
+
+void lrs_media_catalog_get(struct lrs_media_catalog *catalog,
+                           const struct lrs_catalog_filter *filter,
+                           struct media_info **media, int *count)
+{
+    GPtrArray *found = g_ptr_array_new();
+    GHashTable *set;
+    guint i;
+
+    MUTEX_LOCK(&catalog->mutex);
+    if (!filter_smallest_set(catalog, filter, &set))
+        goto copy;
+
+    if (set) {
+        GHashTableIter iter;
+        gpointer key;
+
+        g_hash_table_iter_init(&iter, set);
+        while (g_hash_table_iter_next(&iter, &key, NULL))
+            if (medium_matches(&((struct catalog_medium *)key)->medium,
+                               filter))
+                g_ptr_array_add(found, key);
+
+        qsort(found->pdata, found->len, sizeof(*found->pdata),
+              cmp_media_free);
+    } else {
+        GSequenceIter *iter = g_sequence_get_begin_iter(catalog->by_free);
+
+        if (filter->min_free >= 0) {
+            /* with an empty id, the key goes before the media with the same
+             * free space
+             */
+            struct catalog_medium key = {
+                .medium.stats.phys_spc_free = filter->min_free + 1,
+            };
+
+            /* skip the media with too little free space */
+            iter = g_sequence_search(catalog->by_free, &key, cmp_free, NULL);
+        }
+
+        for (; !g_sequence_iter_is_end(iter); iter = g_sequence_iter_next(iter))
+            if (medium_matches(&((struct catalog_medium *)
+                                 g_sequence_get(iter))->medium, filter))
+                g_ptr_array_add(found, g_sequence_get(iter));
+    }
+
+copy:
+    *count = found->len;
+    *media = found->len ? xcalloc(found->len, sizeof(**media)) : NULL;
+    for (i = 0; i < found->len; i++)
+        media_info_copy(&(*media)[i],
+                        &((struct catalog_medium *)found->pdata[i])->medium);
+    MUTEX_UNLOCK(&catalog->mutex);
+
+    g_ptr_array_free(found, TRUE);
+}
+
+void lrs_media_catalog_res_free(struct media_info *media, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+        media_info_cleanup(&media[i]);
+
+    free(media);
+}
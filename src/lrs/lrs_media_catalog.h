@@ -0,0 +1,157 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  LRS in-memory media catalog
+ *
+ * The catalog holds a copy of the media of a family, so that the scheduler
+ * looks for media to write on without querying the DSS. The media are indexed
+ * by library, grouping and tag, and ordered by free space.
+ *
+ * The LRS threads report the media updates they write to the DSS, and the
+ * whole catalog is reconciled with the DSS every "media_catalog_sync_ms"
+ * milliseconds to get the changes made by other processes.
+ */
+#ifndef _PHO_LRS_MEDIA_CATALOG_H
+#define _PHO_LRS_MEDIA_CATALOG_H
+
+#include <glib.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "pho_dss.h"
+#include "pho_types.h"
+
+struct lrs_dss_writer;
+
+struct lrs_media_catalog {
+    enum rsc_family        family;      /**< family of the media */
+    struct lrs_dss_writer *writer;      /**< flushed before reconciling, may
+                                          *  be NULL
+                                          */
+    struct timespec        sync_period; /**< delay between reconciliations */
+    pthread_mutex_t        mutex;       /**< protects the fields below, no
+                                          *  other lock is taken while holding
+                                          *  it
+                                          */
+    GHashTable            *media;       /**< struct catalog_medium by id */
+    GSequence             *by_free;     /**< media ordered by free space */
+    GHashTable            *libraries;   /**< sets of media by library */
+    GHashTable            *groupings;   /**< sets of media by grouping */
+    GHashTable            *tags;        /**< sets of media by tag */
+    uint64_t               generation;  /**< incremented on each update */
+    uint64_t               n_syncs;     /**< number of reconciliations */
+    struct timespec        synced;      /**< date of the last reconciliation */
+};
+
+/** Criteria of the media to write on */
+struct lrs_catalog_filter {
+    const char                *library;      /**< NULL for any library */
+    const char                *grouping;     /**< NULL for any grouping */
+    const struct string_array *tags;         /**< required tags, may be NULL */
+    bool                       empty_medium; /**< only empty media */
+    ssize_t                    min_free;     /**< only media with more
+                                               *  free space, -1 for any
+                                               */
+};
+
+/**
+ * Initialize an empty media catalog.
+ *
+ * \param[out]  catalog  Catalog to initialize
+ * \param[in]   family   Family of the media
+ * \param[in]   writer   DSS writer whose pending updates are flushed before
+ *                       reconciling, may be NULL
+ *
+ * \return               0 on success, negative error code on failure
+ */
+int lrs_media_catalog_init(struct lrs_media_catalog *catalog,
+                           enum rsc_family family,
+                           struct lrs_dss_writer *writer);
+
+/**
+ * Release the resources of a media catalog.
+ *
+ * \param[in]   catalog  Catalog to finalize
+ */
+void lrs_media_catalog_fini(struct lrs_media_catalog *catalog);
+
+/**
+ * Reconcile a catalog with the media of the DSS.
+ *
+ * The media updated in the catalog while the DSS is queried keep their
+ * catalog value.
+ *
+ * \param[in]   catalog  Catalog
+ * \param[in]   dss      DSS handle of the calling thread
+ *
+ * \return               0 on success, negative error code on failure
+ */
+int lrs_media_catalog_sync(struct lrs_media_catalog *catalog,
+                           struct dss_handle *dss);
+
+/**
+ * Tell whether a catalog was reconciled more than \p delay ago.
+ *
+ * \param[in]   catalog  Catalog
+ * \param[in]   delay    Delay, NULL for the reconciliation period
+ *
+ * \return               true if the catalog should be reconciled
+ */
+bool lrs_media_catalog_is_stale(struct lrs_media_catalog *catalog,
+                                const struct timespec *delay);
+
+/**
+ * Record the new state of a medium, as written to the DSS.
+ *
+ * \param[in]   catalog  Catalog
+ * \param[in]   medium   Medium to copy in the catalog, ignored if it is not of
+ *                       the family of the catalog
+ */
+void lrs_media_catalog_update(struct lrs_media_catalog *catalog,
+                              const struct media_info *medium);
+
+/**
+ * Get the media of a catalog that match a filter and can be written on: with
+ * the put flag, unlocked, and with an empty or used filesystem.
+ *
+ * \param[in]   catalog  Catalog
+ * \param[in]   filter   Criteria of the media
+ * \param[out]  media    Copies of the matching media, by increasing free
+ *                       space, to free with lrs_media_catalog_res_free
+ * \param[out]  count    Number of matching media
+ */
+void lrs_media_catalog_get(struct lrs_media_catalog *catalog,
+                           const struct lrs_catalog_filter *filter,
+                           struct media_info **media, int *count);
+
+/**
+ * Free the media returned by lrs_media_catalog_get.
+ *
+ * \param[in]   media  Media to free
+ * \param[in]   count  Number of media
+ */
+void lrs_media_catalog_res_free(struct media_info *media, int count);
+
+#endif
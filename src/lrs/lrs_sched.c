@@ -31,6 +31,7 @@
 #include "lrs_cfg.h"
 #include "lrs_device.h"
 #include "lrs_sched.h"
+#include "lrs_trace.h"
 #include "lrs_utils.h"
 #include "pho_common.h"
 #include "pho_daemon.h"
@@ -55,14 +56,25 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
+#include <unistd.h>
 
 #include <jansson.h>
 
 #define SHED_STAT_NS "sched"
 
+/** Minimum delay between two reconciliations of the media catalog triggered
+ * by a selection that waits for a medium
+ */
+static const struct timespec CATALOG_MISS_SYNC_DELAY = { .tv_sec = 1 };
+
+/** Maximum number of media of the catalog found unusable in the DSS during one
+ * selection, before waiting for the next one
+ */
+#define CATALOG_MAX_STALE_MEDIA 4
+
 static void *lrs_sched_thread(void *sdata);
 
-static int format_media_init(struct format_media *format_media)
+int format_media_init(struct format_media *format_media)
 {
     int rc;
 
@@ -75,7 +87,7 @@ static int format_media_init(struct format_media *format_media)
     return 0;
 }
 
-static void format_media_clean(struct format_media *format_media)
+void format_media_clean(struct format_media *format_media)
 {
     int rc;
 
@@ -674,11 +686,13 @@ static void sched_stats_destroy(struct lrs_sched *sched)
 
 
 int sched_init(struct lrs_sched *sched, enum rsc_family family,
-               struct tsqueue *resp_queue)
+               struct mpsc_queue *resp_queue)
 {
+    const char *trace_file;
     int rc;
 
     sched->family = family;
+    sched->trace_fd = -1;
 
     rc = lrs_cache_setup(sched->family);
     if (rc)
@@ -703,21 +717,38 @@ int sched_init(struct lrs_sched *sched, enum rsc_family family,
     if (rc)
         LOG_GOTO(err_dss_fini, rc, "Failed to get hostname and PID");
 
-    rc = tsqueue_init(&sched->incoming);
+    rc = mpsc_queue_init(&sched->incoming, MPSC_QUEUE_DEFAULT_CAPACITY);
     if (rc)
         LOG_GOTO(err_dss_fini, rc, "Failed to init sched incoming");
 
-    rc = tsqueue_init(&sched->retry_queue);
+    rc = mpsc_queue_init(&sched->retry_queue, MPSC_QUEUE_DEFAULT_CAPACITY);
     if (rc)
         LOG_GOTO(err_incoming_fini, rc, "Failed to init sched retry_queue");
 
+    rc = lrs_dss_writer_init(&sched->dss_writer);
+    if (rc)
+        LOG_GOTO(err_retry_queue_fini, rc, "Failed to init sched DSS writer");
+
+    sched->devices.ldh_dss_writer = &sched->dss_writer;
+
+    rc = lrs_media_catalog_init(&sched->catalog, family, &sched->dss_writer);
+    if (rc)
+        LOG_GOTO(err_dss_writer_fini, rc, "Failed to init sched media catalog");
+
+    rc = lrs_media_catalog_sync(&sched->catalog, &sched->sched_thread.dss);
+    if (rc)
+        LOG_GOTO(err_catalog_fini, rc, "Failed to load sched media catalog");
+
+    sched->devices.ldh_catalog = &sched->catalog;
+
     rc = io_sched_handle_load_from_config(&sched->io_sched_hdl, family);
     if (rc)
-        LOG_GOTO(err_retry_queue_fini, rc,
+        LOG_GOTO(err_catalog_fini, rc,
                  "Failed to load I/O schedulers from config");
 
     sched->response_queue = resp_queue;
     sched->io_sched_hdl.lock_handle = &sched->lock_handle;
+    sched->io_sched_hdl.catalog = &sched->catalog;
     sched->io_sched_hdl.response_queue = sched->response_queue;
     sched->io_sched_hdl.global_device_list = sched->devices.ldh_devices;
 
@@ -739,6 +770,13 @@ int sched_init(struct lrs_sched *sched, enum rsc_family family,
     if (rc)
         goto err_sched_fini;
 
+    trace_file = PHO_CFG_GET(cfg_lrs, PHO_CFG_LRS, trace_file);
+    if (trace_file && *trace_file) {
+        rc = lrs_trace_open(trace_file, &sched->trace_fd);
+        if (rc)
+            goto err_sched_fini;
+    }
+
     rc = thread_init(&sched->sched_thread, lrs_sched_thread, sched);
     if (rc)
         LOG_GOTO(err_sched_fini, rc,
@@ -751,10 +789,14 @@ err_sched_fini:
     sched_fini(sched);
     return rc;
 
+err_catalog_fini:
+    lrs_media_catalog_fini(&sched->catalog);
+err_dss_writer_fini:
+    lrs_dss_writer_fini(&sched->dss_writer);
 err_retry_queue_fini:
-    tsqueue_destroy(&sched->retry_queue, sched_req_free);
+    mpsc_queue_destroy(&sched->retry_queue, sched_req_free);
 err_incoming_fini:
-    tsqueue_destroy(&sched->incoming, sched_req_free);
+    mpsc_queue_destroy(&sched->incoming, sched_req_free);
 err_dss_fini:
     dss_fini(&sched->sched_thread.dss);
 err_hdl_fini:
@@ -791,7 +833,7 @@ void prepare_error(struct resp_container *resp_cont, int req_rc,
         resp_cont->resp->error->req_kind = PHO_REQUEST_KIND__RQ_CONFIGURE;
 }
 
-void queue_error_response(struct tsqueue *response_queue, int req_rc,
+void queue_error_response(struct mpsc_queue *response_queue, int req_rc,
                           struct req_container *reqc)
 {
     struct resp_container *resp_cont;
@@ -801,7 +843,7 @@ void queue_error_response(struct tsqueue *response_queue, int req_rc,
 
     prepare_error(resp_cont, req_rc, reqc);
 
-    tsqueue_push(response_queue, resp_cont);
+    mpsc_queue_push(response_queue, resp_cont);
 }
 
 void sched_resp_free(void *_respc)
@@ -841,14 +883,19 @@ void sched_fini(struct lrs_sched *sched)
         return;
 
     lrs_dev_hdl_clear(&sched->devices, sched);
+    /* the devices are stopped, flush their last updates */
+    lrs_dss_writer_fini(&sched->dss_writer);
+    lrs_media_catalog_fini(&sched->catalog);
     io_sched_fini(&sched->io_sched_hdl);
     lrs_dev_hdl_fini(&sched->devices);
     dss_fini(&sched->sched_thread.dss);
-    tsqueue_destroy(&sched->incoming, sched_req_free);
-    tsqueue_destroy(&sched->retry_queue, sub_request_free_cb);
+    mpsc_queue_destroy(&sched->incoming, sched_req_free);
+    mpsc_queue_destroy(&sched->retry_queue, sub_request_free_cb);
     format_media_clean(&sched->ongoing_format);
     lrs_cache_cleanup(sched->family);
     sched_stats_destroy(sched);
+    if (sched->trace_fd >= 0)
+        close(sched->trace_fd);
 }
 
 bool sched_has_running_devices(struct lrs_sched *sched)
@@ -873,77 +920,6 @@ bool sched_has_running_devices(struct lrs_sched *sched)
     return false;
 }
 
-/**
- * Build a filter string fragment to filter on a given tag array. The returned
- * string is allocated with malloc. NULL is returned when ENOMEM is encountered.
- *
- * The returned string looks like the following:
- * {"$AND": [{"$XJSON": {"DSS:MDA::tags": "tag1"}}]}
- */
-static char *build_tag_filter(const struct string_array *tags)
-{
-    json_t *and_filter = NULL;
-    json_t *tag_filters = NULL;
-    char   *tag_filter_json = NULL;
-    size_t  i;
-
-    /* Build a json array to properly format tag related DSS filter */
-    tag_filters = json_array();
-    if (!tag_filters)
-        return NULL;
-
-    /* Build and append one filter per tag */
-    for (i = 0; i < tags->count; i++) {
-        json_t *tag_flt;
-        json_t *xjson;
-
-        tag_flt = json_object();
-        if (!tag_flt)
-            GOTO(out, -ENOMEM);
-
-        xjson = json_object();
-        if (!xjson) {
-            json_decref(tag_flt);
-            GOTO(out, -ENOMEM);
-        }
-
-        if (json_object_set_new(tag_flt, "DSS::MDA::tags",
-                                json_string(tags->strings[i]))) {
-            json_decref(tag_flt);
-            json_decref(xjson);
-            GOTO(out, -ENOMEM);
-        }
-
-        if (json_object_set_new(xjson, "$XJSON", tag_flt)) {
-            json_decref(xjson);
-            GOTO(out, -ENOMEM);
-        }
-
-        if (json_array_append_new(tag_filters, xjson))
-            GOTO(out, -ENOMEM);
-    }
-
-    and_filter = json_object();
-    if (!and_filter)
-        GOTO(out, -ENOMEM);
-
-    /* Do not use the _new function and decref inconditionnaly later */
-    if (json_object_set(and_filter, "$AND", tag_filters))
-        GOTO(out, -ENOMEM);
-
-    /* Convert to string for formatting */
-    tag_filter_json = json_dumps(and_filter, 0);
-
-out:
-    json_decref(tag_filters);
-
-    /* json_decref(NULL) is safe but not documented */
-    if (and_filter)
-        json_decref(and_filter);
-
-    return tag_filter_json;
-}
-
 /**
  * Check if medium is already selected in request
  *
@@ -1006,7 +982,58 @@ static int medium_in_devices(const struct media_info *medium,
 }
 
 /**
- * Get a suitable medium for a write operation.
+ * Check in the DSS that a medium selected from the catalog can still be
+ * written on, as its catalog entry can be up to "media_catalog_sync_ms" old.
+ * Its administrative status, flags and lock are updated in the catalog.
+ *
+ * @param[in]      io_sched  Current I/O scheduler
+ * @param[in,out]  medium    Medium selected from the catalog
+ *
+ * @return 0 if the medium can be used, -ESTALE if another one must be selected,
+ *         or a negative error code
+ */
+static int catalog_medium_check(struct io_scheduler *io_sched,
+                                struct media_info *medium)
+{
+    struct lock_handle *lock_handle = io_sched->io_sched_hdl->lock_handle;
+    struct media_info *dss_medium;
+    int rc;
+
+    rc = dss_one_medium_get_from_id(lock_handle->dss, &medium->rsc.id,
+                                    &dss_medium);
+    if (rc)
+        return rc;
+
+    medium->rsc.adm_status = dss_medium->rsc.adm_status;
+    medium->flags = dss_medium->flags;
+    dss_res_free(dss_medium, 1);
+
+    pho_lock_clean(&medium->lock);
+    rc = dss_lock_status(lock_handle->dss, DSS_MEDIA, medium, 1,
+                         &medium->lock);
+    if (rc && rc != -ENOLCK)
+        LOG_RETURN(rc, "Unable to status lock");
+
+    lrs_media_catalog_update(io_sched->io_sched_hdl->catalog, medium);
+
+    if (medium->rsc.adm_status != PHO_RSC_ADM_ST_UNLOCKED ||
+        !medium->flags.put) {
+        pho_verb("Medium (family '%s', name '%s', library '%s') cannot be "
+                 "written on anymore",
+                 rsc_family2str(medium->rsc.id.family), medium->rsc.id.name,
+                 medium->rsc.id.library);
+        return -ESTALE;
+    }
+
+    if (medium->lock.hostname &&
+        check_renew_lock(lock_handle, DSS_MEDIA, medium, &medium->lock))
+        return -ESTALE;
+
+    return 0;
+}
+
+/**
+ * Get a suitable medium for a write operation from the media catalog.
  *
  * @param[in]  sched         Current scheduler
  * @param[out] p_media       Selected medium
@@ -1027,27 +1054,31 @@ static int medium_in_devices(const struct media_info *medium,
  *                               available medium can be found, else, set to
  *                               false
  */
-mockable
-int sched_select_medium(struct io_scheduler *io_sched,
-                        struct media_info **p_media,
-                        size_t required_size,
-                        enum rsc_family family,
-                        const char *library,
-                        const char *grouping,
-                        const struct string_array *tags,
-                        struct req_container *reqc,
-                        size_t n_med,
-                        size_t not_alloc,
-                        bool *need_new_grouping)
+static int select_catalog_medium(struct io_scheduler *io_sched,
+                                 struct media_info **p_media,
+                                 size_t required_size,
+                                 enum rsc_family family,
+                                 const char *library,
+                                 const char *grouping,
+                                 const struct string_array *tags,
+                                 struct req_container *reqc,
+                                 size_t n_med,
+                                 size_t not_alloc,
+                                 bool *need_new_grouping)
 {
     struct lock_handle *lock_handle = io_sched->io_sched_hdl->lock_handle;
-    bool with_tags = tags != NULL && tags->count > 0;
+    struct lrs_catalog_filter filter = {
+        .library = library,
+        .grouping = grouping,
+        .tags = tags,
+        .empty_medium = reqc->req->walloc->media[0]->empty_medium,
+        /* exclude media too small to do a no-split */
+        .min_free = reqc->req->walloc->no_split ? (ssize_t)required_size : -1,
+    };
     struct media_info *split_media_best = NULL;
     struct media_info *whole_media_best = NULL;
     struct media_info *chosen_media = NULL;
     struct media_info *pmedia_res = NULL;
-    char *tag_filter_json = NULL;
-    struct dss_filter filter;
     size_t avail_size = 0;
     int mcnt = 0;
     int rc;
@@ -1057,96 +1088,26 @@ int sched_select_medium(struct io_scheduler *io_sched,
 
     *need_new_grouping = false;
 
-    if (with_tags) {
-        tag_filter_json = build_tag_filter(tags);
-        if (!tag_filter_json)
-            LOG_GOTO(err_nores, rc = -ENOMEM, "while building tags dss filter");
-    }
-
-    if (reqc->req->walloc->media[0]->empty_medium)
-        rc = dss_filter_build(&filter,
-                              "{\"$AND\": ["
-                              "  {\"DSS::MDA::family\": \"%s\"},"
-                              "  {\"DSS::MDA::put\": \"t\"},"
-                              "  {\"DSS::MDA::adm_status\": \"%s\"},"
-                              "  {\"DSS::MDA::fs_status\": \"%s\"}"
-                              "  %s%s%s"
-                              "  %s%s%s"
-                              "  %s%s"
-                              "]}",
-                              rsc_family2str(family),
-                              rsc_adm_status2str(PHO_RSC_ADM_ST_UNLOCKED),
-                              fs_status2str(PHO_FS_STATUS_EMPTY),
-                              library ? ", {\"DSS::MDA::library\": \"" : "",
-                              library ? library : "",
-                              library ? "\"}" : "",
-                              grouping ? ", {\"$XJSON\": "
-                                         "{\"DSS::MDA::groupings\": \"" : "",
-                              grouping ? grouping : "",
-                              grouping ? "\"}}" : "",
-                              with_tags ? ", " : "",
-                              with_tags ? tag_filter_json : "");
-    else
-        rc = dss_filter_build(&filter,
-                              "{\"$AND\": ["
-                              /* Basic criteria */
-                              "  {\"DSS::MDA::family\": \"%s\"},"
-                              /* Check put media operation flags */
-                              "  {\"DSS::MDA::put\": \"t\"},"
-                              /* Exclude media locked by admin */
-                              "  {\"DSS::MDA::adm_status\": \"%s\"},"
-                              "  {\"$OR\": ["
-                                   /* Include used media */
-                              "    {\"DSS::MDA::fs_status\": \"%s\"},"
-                                   /* Include empty media */
-                              "    {\"DSS::MDA::fs_status\": \"%s\"}"
-                              "  ]}"
-                              "  %s%s%s"
-                              "  %s%s%s"
-                              "  %s%s"
-                              "]}",
-                              rsc_family2str(family),
-                              rsc_adm_status2str(PHO_RSC_ADM_ST_UNLOCKED),
-                              /**
-                               * @TODO add criteria to limit the maximum number
-                               * of data fragments:
-                               * vol_free >= required_size/max_fragments with a
-                               * configurable max_fragments of 4 for example)
-                               */
-                              fs_status2str(PHO_FS_STATUS_USED),
-                              fs_status2str(PHO_FS_STATUS_EMPTY),
-                              library ? ", {\"DSS::MDA::library\": \"" : "",
-                              library ? library : "",
-                              library ? "\"}" : "",
-                              grouping ? ", {\"$XJSON\": "
-                                         "{\"DSS::MDA::groupings\": \"" : "",
-                              grouping ? grouping : "",
-                              grouping ? "\"}}" : "",
-                              with_tags ? ", " : "",
-                              with_tags ? tag_filter_json : "");
-
-    free(tag_filter_json);
-    if (rc)
-        return rc;
+    /**
+     * @TODO add criteria to limit the maximum number of data fragments:
+     * vol_free >= required_size/max_fragments with a configurable
+     * max_fragments of 4 for example)
+     */
+    lrs_media_catalog_get(io_sched->io_sched_hdl->catalog, &filter,
+                          &pmedia_res, &mcnt);
 
-    rc = dss_media_get(lock_handle->dss, &filter, &pmedia_res,
-                       &mcnt, NULL);
     if (mcnt == 0) {
-        char *dump = json_dumps(filter.df_json, JSON_COMPACT);
-
-        pho_warn("No medium found matching query: %s", dump);
-        dss_filter_free(&filter);
-        free(dump);
+        pho_warn("No medium found matching the request (family '%s', "
+                 "library '%s', grouping '%s', %zu tags%s)",
+                 rsc_family2str(family), library ? : "any",
+                 grouping ? : "none", tags ? tags->count : 0,
+                 filter.empty_medium ? ", empty medium" : "");
         if (grouping)
             *need_new_grouping = true;
 
         GOTO(free_res, rc = -ENOSPC);
     }
 
-    dss_filter_free(&filter);
-    if (rc)
-        GOTO(err_nores, rc);
-
     /* get the best fit */
     for (i = 0; i < mcnt; i++) {
         struct media_info *curr = &pmedia_res[i];
@@ -1163,11 +1124,6 @@ int sched_select_medium(struct io_scheduler *io_sched,
         if (already_alloc)
             continue;
 
-        /* exclude medium too small to do a no-split */
-        if (reqc->req->walloc->no_split &&
-            curr->stats.phys_spc_free <= required_size)
-            continue;
-
         avail_size += curr->stats.phys_spc_free;
 
         /* already locked */
@@ -1234,10 +1190,13 @@ int sched_select_medium(struct io_scheduler *io_sched,
              "bytes free", rsc_family2str(family), chosen_media->rsc.id.name,
              chosen_media->rsc.id.library, chosen_media->stats.phys_spc_free);
 
+    rc = catalog_medium_check(io_sched, chosen_media);
+    if (rc)
+        goto free_res;
+
     /* Don't rely on existing lock for future use */
     pho_lock_clean(&chosen_media->lock);
 
-
     rc = dss_medium_health(lock_handle->dss, &chosen_media->rsc.id,
                            max_health(), &chosen_media->health);
     if (rc)
@@ -1250,12 +1209,92 @@ int sched_select_medium(struct io_scheduler *io_sched,
         rc = 0;
 
 free_res:
-    dss_res_free(pmedia_res, mcnt);
+    lrs_media_catalog_res_free(pmedia_res, mcnt);
 
-err_nores:
     return rc;
 }
 
+/**
+ * Select a medium like select_catalog_medium, skipping the media found
+ * unusable in the DSS.
+ */
+static int select_checked_medium(struct io_scheduler *io_sched,
+                                 struct media_info **p_media,
+                                 size_t required_size,
+                                 enum rsc_family family,
+                                 const char *library,
+                                 const char *grouping,
+                                 const struct string_array *tags,
+                                 struct req_container *reqc,
+                                 size_t n_med,
+                                 size_t not_alloc,
+                                 bool *need_new_grouping)
+{
+    int rc;
+    int i;
+
+    /* the stale media are updated in the catalog and not selected again */
+    for (i = 0; i < CATALOG_MAX_STALE_MEDIA; i++) {
+        rc = select_catalog_medium(io_sched, p_media, required_size, family,
+                                   library, grouping, tags, reqc, n_med,
+                                   not_alloc, need_new_grouping);
+        if (rc != -ESTALE)
+            return rc;
+    }
+
+    return -EAGAIN;
+}
+
+/**
+ * Select a medium like select_checked_medium, and select again after
+ * reconciling the catalog if no medium is available.
+ */
+mockable
+int sched_select_medium(struct io_scheduler *io_sched,
+                        struct media_info **p_media,
+                        size_t required_size,
+                        enum rsc_family family,
+                        const char *library,
+                        const char *grouping,
+                        const struct string_array *tags,
+                        struct req_container *reqc,
+                        size_t n_med,
+                        size_t not_alloc,
+                        bool *need_new_grouping)
+{
+    struct io_sched_handle *io_sched_hdl = io_sched->io_sched_hdl;
+    int rc;
+
+    rc = select_checked_medium(io_sched, p_media, required_size, family,
+                               library, grouping, tags, reqc, n_med,
+                               not_alloc, need_new_grouping);
+    if (rc != -ENOSPC && rc != -EAGAIN)
+        return rc;
+
+    /* The caller looks for a medium without the grouping, which reconciles the
+     * catalog if needed.
+     */
+    if (*need_new_grouping)
+        return rc;
+
+    /* A medium may have been added or released by another process since the
+     * last reconciliation of the catalog. The requests that wait for a medium
+     * are retried, and the writes to a full set of media fail the same way, do
+     * not reconcile for each of them.
+     */
+    if (!lrs_media_catalog_is_stale(io_sched_hdl->catalog,
+                                    &CATALOG_MISS_SYNC_DELAY))
+        return rc;
+
+    if (lrs_media_catalog_sync(io_sched_hdl->catalog,
+                               io_sched_hdl->lock_handle->dss))
+        return rc;
+
+    return select_checked_medium(io_sched, p_media, required_size, family,
+                                 library, grouping, tags, reqc, n_med,
+                                 not_alloc, need_new_grouping);
+}
+
 /*
  * The intent is to write: exclude media that are administratively
  * locked, full, do not have the put operation flag, do not have the
@@ -1443,6 +1482,14 @@ struct lrs_dev *dev_picker(GPtrArray *devices,
         if (one_drive_available)
             *one_drive_available = true;
 
+        /* the medium of an active write stream must not be swapped out */
+        if (pmedia && dev_write_stream_is_active(itr, NULL) &&
+            !pho_id_equal(&itr->ld_write_stream.medium, &pmedia->rsc.id)) {
+            pho_debug("Skipping device '%s' pinned by write stream '%s'",
+                      itr->ld_dev_path, itr->ld_write_stream.key);
+            goto unlock_continue;
+        }
+
         if (op_st != PHO_DEV_OP_ST_UNSPEC && itr->ld_op_status != op_st) {
             pho_debug("Skipping device '%s' with incompatible status %s "
                       "instead of %s", itr->ld_dev_path,
@@ -1516,6 +1563,103 @@ unlock_continue:
     return selected;
 }
 
+static int cmp_tags(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+char *write_stream_key(const char *library, const char *grouping,
+                       const struct string_array *tags)
+{
+    GString *key = g_string_new(library ? library : "");
+    char **sorted_tags;
+    size_t i;
+
+    g_string_append_printf(key, "/%s/", grouping ? grouping : "");
+
+    if (tags->count == 0)
+        return g_string_free(key, false);
+
+    /* the order of the tags of a request does not matter */
+    sorted_tags = xmalloc(sizeof(*sorted_tags) * tags->count);
+    memcpy(sorted_tags, tags->strings, sizeof(*sorted_tags) * tags->count);
+    qsort(sorted_tags, tags->count, sizeof(*sorted_tags), cmp_tags);
+
+    for (i = 0; i < tags->count; i++)
+        g_string_append_printf(key, "%s%s", i ? "," : "", sorted_tags[i]);
+
+    free(sorted_tags);
+
+    return g_string_free(key, false);
+}
+
+int write_stream_dev_picker(GPtrArray *devices, struct dss_handle *dss,
+                            const char *library, const char *grouping,
+                            size_t required_size,
+                            const struct string_array *media_tags,
+                            struct lrs_dev **dev)
+{
+    GPtrArray *stream_devs = NULL;
+    bool busy = false;
+    char *key = NULL;
+    int i;
+
+    *dev = NULL;
+
+    for (i = 0; i < devices->len; i++) {
+        struct lrs_dev *itr = g_ptr_array_index(devices, i);
+        bool in_stream;
+        bool full;
+
+        MUTEX_LOCK(&itr->ld_mutex);
+        if (itr->ld_write_stream.key && !key)
+            key = write_stream_key(library, grouping, media_tags);
+
+        in_stream = key && dev_write_stream_is_active(itr, key);
+        full = in_stream &&
+            itr->ld_dss_media_info->stats.phys_spc_free < required_size;
+        /* the stream moves to another medium as soon as this one is full */
+        if (full)
+            dev_write_stream_unpin(itr);
+        MUTEX_UNLOCK(&itr->ld_mutex);
+
+        if (!in_stream || full)
+            continue;
+
+        /* a device already selected for this allocation is not waited for */
+        if (!dev_is_online(itr) || dev_is_failed(itr) ||
+            itr->ld_ongoing_scheduled)
+            continue;
+
+        if (!dev_is_sched_ready(itr)) {
+            busy = true;
+            continue;
+        }
+
+        if (!stream_devs)
+            stream_devs = g_ptr_array_new();
+        g_ptr_array_add(stream_devs, itr);
+    }
+
+    free(key);
+    if (stream_devs) {
+        /* usual checks: the device must be free and its medium must fit */
+        *dev = dev_picker(stream_devs, dss, PHO_DEV_OP_ST_UNSPEC, library,
+                          grouping, select_first_fit, required_size,
+                          media_tags, NULL, true, false, NULL);
+        g_ptr_array_free(stream_devs, true);
+    }
+
+    if (*dev) {
+        pho_debug("Write stream continues on device '%s'",
+                  (*dev)->ld_dev_path);
+        return 0;
+    }
+
+    /* the write waits for the pinned medium until the end of the stream */
+    return busy ? -EAGAIN : 0;
+}
+
 /**
  * Get the first device with enough space.
  * @retval 0 to stop searching for a device
@@ -1826,8 +1970,18 @@ static int sched_device_unlock(struct lrs_sched *sched, const char *name,
     return sched_device_add(sched, sched->family, name, library);
 }
 
+/** Hand the sub-request set on \p dev to it */
+static void sched_dev_push(struct lrs_sched *sched, struct lrs_dev *dev)
+{
+    if (sched->dev_push)
+        sched->dev_push(dev, sched->dev_push_data);
+    else
+        thread_signal(&dev->ld_device_thread);
+}
+
 /** remove written_size from phys_spc_free in media_info and DSS */
-static void push_sub_request_to_device(struct req_container *reqc)
+static void push_sub_request_to_device(struct lrs_sched *sched,
+                                       struct req_container *reqc)
 {
     struct lrs_dev **devices = reqc->params.rwalloc.respc->devices;
     size_t devices_len = reqc->params.rwalloc.respc->devices_len;
@@ -1848,7 +2002,7 @@ static void push_sub_request_to_device(struct req_container *reqc)
         devices[i]->ld_sub_request = sub_requests[i];
         devices[i]->ld_ongoing_scheduled = false;
 
-        thread_signal(&devices[i]->ld_device_thread);
+        sched_dev_push(sched, devices[i]);
     }
 
     free(sub_requests);
@@ -1879,7 +2033,7 @@ static int publish_or_cancel(struct lrs_sched *sched,
     }
 
     if (!reqc_rc && !rc)
-        push_sub_request_to_device(reqc);
+        push_sub_request_to_device(sched, reqc);
 
     if (reqc_rc || rc) {
         for (i = 0; i < n_selected; i++)
@@ -1926,6 +2080,29 @@ static bool medium_is_loaded(struct lrs_dev *dev, struct media_info *medium)
     return loaded;
 }
 
+/** Pin the write stream of the medium \p index of \p wreq on \p dev */
+static void sched_write_stream_pin(struct lrs_sched *sched,
+                                   struct lrs_dev *dev,
+                                   struct media_info *medium,
+                                   pho_req_write_t *wreq, size_t index)
+{
+    struct string_array tags = {
+        .strings = wreq->media[index]->tags,
+        .count = wreq->media[index]->n_tags,
+    };
+    const struct timespec *idle = &sched->devices.write_stream_idle;
+    char *key;
+
+    if (idle->tv_sec == 0 && idle->tv_nsec == 0)
+        return;
+
+    key = write_stream_key(wreq->library, wreq->grouping, &tags);
+    MUTEX_LOCK(&dev->ld_mutex);
+    dev_write_stream_pin(dev, key, &medium->rsc.id, idle);
+    MUTEX_UNLOCK(&dev->ld_mutex);
+    free(key);
+}
+
 static int sched_write_alloc_one_medium(struct lrs_sched *sched,
                                         struct allocation *alloc,
                                         size_t index_to_alloc,
@@ -2005,6 +2182,7 @@ notify_error:
 select_device:
     dev->ld_ongoing_scheduled = true;
     reqc->params.rwalloc.respc->devices[index_to_alloc] = dev;
+    sched_write_stream_pin(sched, dev, *alloc_medium, wreq, index_to_alloc);
 
     return 0;
 }
@@ -2541,7 +2719,7 @@ static int sched_handle_format(struct lrs_sched *sched,
     MUTEX_LOCK(&device->ld_mutex);
     device->ld_sub_request = format_sub_request;
     MUTEX_UNLOCK(&device->ld_mutex);
-    thread_signal(&device->ld_device_thread);
+    sched_dev_push(sched, device);
 
     return 0;
 
@@ -2598,7 +2776,7 @@ static void queue_notify_response(struct lrs_sched *sched,
     resp->notify->rsrc_id->name = xstrdup(nreq->rsrc_id->name);
     resp->notify->rsrc_id->library = xstrdup(nreq->rsrc_id->library);
 
-    tsqueue_push(sched->response_queue, respc);
+    mpsc_queue_push(sched->response_queue, respc);
 }
 
 static int sched_medium_update(struct lrs_sched *sched,
@@ -2617,6 +2795,8 @@ static int sched_medium_update(struct lrs_sched *sched,
     if (!medium)
         return -errno;
 
+    lrs_media_catalog_update(&sched->catalog, medium);
+
     device = search_loaded_medium_keep_lock(sched->devices.ldh_devices, name,
                                             library);
     if (!device)
@@ -2786,7 +2966,7 @@ static void sched_handle_read_or_write_error(struct lrs_sched *sched,
         *sreq_pushed_or_requeued = true;
     } else {
         if (rc == -EAGAIN) {
-            tsqueue_push(&sched->retry_queue, sreq);
+            mpsc_queue_push(&sched->retry_queue, sreq);
             *sreq_pushed_or_requeued = true;
         } else {
             *sreq_pushed_or_requeued = false;
@@ -2852,13 +3032,13 @@ int sched_handle_requests(struct lrs_sched *sched)
     /**
      * First try to re-run sub-request errors
      */
-    while ((sreq = tsqueue_pop(&sched->retry_queue)) != NULL)
+    while ((sreq = mpsc_queue_pop(&sched->retry_queue)) != NULL)
         sched_handle_error(sched, sreq);
 
     /**
      * push new request in the I/O scheduler
      */
-    while ((reqc = tsqueue_pop(&sched->incoming)) != NULL) {
+    while ((reqc = mpsc_queue_pop(&sched->incoming)) != NULL) {
         pho_req_t *req = reqc->req;
 
         if (!running) {
@@ -2867,6 +3047,8 @@ int sched_handle_requests(struct lrs_sched *sched)
         } else if (pho_request_is_format(req) ||
                    pho_request_is_read(req) ||
                    pho_request_is_write(req)) {
+            if (sched->trace_fd >= 0)
+                lrs_trace_request(sched->trace_fd, reqc);
             rc = io_sched_push_request(&sched->io_sched_hdl, reqc);
         } else if (pho_request_is_notify(req)) {
             pho_debug("lrs received notify request (%p)", req);
@@ -2889,7 +3071,7 @@ int sched_handle_requests(struct lrs_sched *sched)
 
         if (running) {
             /* Requeue last notify on -EAGAIN and running */
-            tsqueue_push(&sched->incoming, reqc);
+            mpsc_queue_push(&sched->incoming, reqc);
             rc = 0;
             break;
         }
@@ -3099,9 +3281,9 @@ static void *lrs_sched_thread(void *sdata)
 
         /* update queue stats before the queues are emptied */
         pho_stat_set(sched->stats.incoming_qsize,
-                     tsqueue_get_length(&sched->incoming));
+                     mpsc_queue_get_length(&sched->incoming));
         pho_stat_set(sched->stats.retry_qsize,
-                     tsqueue_get_length(&sched->retry_queue));
+                     mpsc_queue_get_length(&sched->retry_queue));
         pho_stat_set(sched->stats.ongoing_format,
                      format_media_count(&sched->ongoing_format));
 
@@ -3125,6 +3307,10 @@ static void *lrs_sched_thread(void *sdata)
                      "'%s' scheduler: error while scheduling requests",
                      rsc_family2str(sched->family));
 
+        /* not critical, the catalog is kept up to date by this LRS */
+        if (lrs_media_catalog_is_stale(&sched->catalog, NULL))
+            lrs_media_catalog_sync(&sched->catalog, &sched->sched_thread.dss);
+
         rc = compute_wakeup_time(&timeout, &wakeup_date);
         if (rc)
             GOTO(end_thread, thread->status = rc);
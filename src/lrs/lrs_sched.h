@@ -38,6 +38,8 @@
 #include "io_sched.h"
 #include "lrs_cache.h"
 #include "lrs_device.h"
+#include "lrs_dss_writer.h"
+#include "lrs_media_catalog.h"
 #include "lrs_thread.h"
 #include "lrs_utils.h"
 
@@ -67,6 +69,16 @@ struct format_media {
     GHashTable *media;
 };
 
+/**
+ * Initialize an empty format_media
+ */
+int format_media_init(struct format_media *format_media);
+
+/**
+ * Release the resources of a format_media
+ */
+void format_media_clean(struct format_media *format_media);
+
 /**
  * Remove medium from format_media
  */
@@ -88,14 +100,14 @@ struct lrs_sched {
     enum rsc_family        family;         /**< Managed resource family */
     struct lrs_dev_hdl     devices;        /**< Handle to device threads */
     struct lock_handle     lock_handle;    /**< Lock information for this LRS */
-    struct tsqueue         incoming;       /**< Queue of new requests to
+    struct mpsc_queue      incoming;       /**< Queue of new requests to
                                              *  schedule
                                              */
-    struct tsqueue         retry_queue;    /**< Queue of request sent back by
+    struct mpsc_queue      retry_queue;    /**< Queue of request sent back by
                                              *  the device thread on error
                                              */
     struct format_media    ongoing_format; /**< Ongoing format media */
-    struct tsqueue        *response_queue; /**< Queue for responses */
+    struct mpsc_queue     *response_queue; /**< Queue for responses */
     struct timespec        sync_time_ms;   /**< Time threshold for medium
                                              *  synchronization
                                              */
@@ -110,6 +122,20 @@ struct lrs_sched {
                                              */
     struct io_sched_handle io_sched_hdl;   /**< I/O scheduler handle */
     struct sched_stats     stats;          /**< exported scheduler stats */
+    struct lrs_dss_writer  dss_writer;     /**< asynchronous writer of the
+                                             *  media updates of releases
+                                             */
+    struct lrs_media_catalog catalog;      /**< media to select for writes */
+    int                    trace_fd;       /**< trace of the requests, -1 if
+                                             *  they are not recorded
+                                             */
+    void                 (*dev_push)(struct lrs_dev *dev, void *data);
+                                           /**< called with the device a
+                                             *  sub-request was set on, instead
+                                             *  of waking up its thread, NULL
+                                             *  to wake it up
+                                             */
+    void                  *dev_push_data;  /**< argument of dev_push */
 };
 
 /**
@@ -310,6 +336,9 @@ struct resp_container {
                                       * (used only for read or write alloc)
                                       */
     size_t devices_len;             /**< size of \p devices */
+    struct timespec received_at;    /**< Reception of the request (used only
+                                      * for read or write alloc)
+                                      */
 };
 
 /**
@@ -329,7 +358,7 @@ void prepare_error(struct resp_container *resp_cont, int req_rc,
  * @param[in]       req_rc          Error code
  * @param[in]       reqc            Request to response an error
  */
-void queue_error_response(struct tsqueue *response_queue, int req_rc,
+void queue_error_response(struct mpsc_queue *response_queue, int req_rc,
                           struct req_container *reqc);
 
 /**
@@ -358,7 +387,7 @@ int sched_fill_dev_info(struct lrs_sched *sched, struct lib_handle *lib_hdl,
  * \return                      0 on success, -1 * posix error code on failure.
  */
 int sched_init(struct lrs_sched *sched, enum rsc_family family,
-               struct tsqueue *resp_queue);
+               struct mpsc_queue *resp_queue);
 
 /**
  * Free all resources associated with this sched except for the dss, which must
@@ -385,8 +414,8 @@ bool sched_has_running_devices(struct lrs_sched *sched);
 int sched_handle_requests(struct lrs_sched *sched);
 
 /**
- * Take requests from the I/O schedulers and push them to a device thread if
- * some requests are ready to be executed.
+ * Take requests from the I/O schedulers and push them to a device thread, or
+ * to sched->dev_push if it is set, if some requests are ready to be executed.
  *
  * \param[in]  sched   the scheduler which will handle requests
  *
@@ -420,6 +449,44 @@ struct lrs_dev *dev_picker(GPtrArray *devices,
                            bool is_write, bool empty_medium,
                            bool *one_drive_available);
 
+/**
+ * Build the key of the write stream of a medium to write on: the writes with
+ * the same library, grouping and set of tags belong to the same stream.
+ *
+ * \param[in]  library   library of the write, may be NULL
+ * \param[in]  grouping  grouping of the write, may be NULL
+ * \param[in]  tags      tags of the medium to write on
+ *
+ * \return               key to free by the caller
+ */
+char *write_stream_key(const char *library, const char *grouping,
+                       const struct string_array *tags);
+
+/**
+ * Get a free device whose medium is pinned by the active write stream of a
+ * write and has enough space for it.
+ *
+ * The streams whose medium does not have enough space for the write are
+ * unpinned.
+ *
+ * \param[in]  devices        devices to consider
+ * \param[in]  dss            DSS handle
+ * \param[in]  library        library of the write, may be NULL
+ * \param[in]  grouping       grouping of the write, may be NULL
+ * \param[in]  required_size  size of the write
+ * \param[in]  media_tags     tags of the medium to write on
+ * \param[out] dev            the device, or NULL if there is none
+ *
+ * \return                    0 on success,
+ *                            -EAGAIN if the device of the stream is busy, the
+ *                            write must then wait for it
+ */
+int write_stream_dev_picker(GPtrArray *devices, struct dss_handle *dss,
+                            const char *library, const char *grouping,
+                            size_t required_size,
+                            const struct string_array *media_tags,
+                            struct lrs_dev **dev);
+
 device_select_func_t get_dev_policy(void);
 
 int sched_select_medium(struct io_scheduler *io_sched,
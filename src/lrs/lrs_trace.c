@@ -0,0 +1,391 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  LRS request trace implementation
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glib.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lrs_trace.h"
+#include "pho_common.h"
+#include "pho_srl_lrs.h"
+
+#define TRACE_SEPARATORS " \t\n"
+
+/* reserved characters kept as is in the names, '@' separates the positions */
+#define TRACE_NAME_ALLOWED "!$&'()*+,;=:/"
+
+int lrs_trace_open(const char *path, int *fd)
+{
+    *fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0640);
+    if (*fd < 0)
+        LOG_RETURN(-errno, "Cannot open the request trace '%s'", path);
+
+    return 0;
+}
+
+/** Append a name to a trace line, percent-encoded so that it stays one field */
+static void trace_append_name(GString *line, const char *name)
+{
+    g_string_append_c(line, ' ');
+    g_string_append_uri_escaped(line, name, TRACE_NAME_ALLOWED, TRUE);
+}
+
+static void trace_read(GString *line, const pho_req_read_t *ralloc)
+{
+    bool has_positions = ralloc->n_positions == ralloc->n_med_ids;
+    size_t i;
+
+    g_string_append_printf(line, " %" PRIu32, ralloc->n_required);
+
+    for (i = 0; i < ralloc->n_med_ids; i++) {
+        trace_append_name(line, ralloc->med_ids[i]->name);
+        if (has_positions)
+            g_string_append_printf(line, "@%" PRIu64, ralloc->positions[i]);
+    }
+}
+
+static void trace_write(GString *line, const pho_req_write_t *walloc)
+{
+    size_t i;
+
+    if (!walloc->grouping || !*walloc->grouping)
+        g_string_append(line, " -");
+    else if (!strcmp(walloc->grouping, "-"))
+        /* not to be read back as no grouping */
+        g_string_append(line, " %2D");
+    else
+        trace_append_name(line, walloc->grouping);
+
+    g_string_append_printf(line, " %d", walloc->no_split ? 1 : 0);
+
+    for (i = 0; i < walloc->n_media; i++)
+        g_string_append_printf(line, " %" PRIu64 "%s",
+                               walloc->media[i]->size,
+                               walloc->media[i]->empty_medium ? "!" : "");
+}
+
+void lrs_trace_request(int fd, const struct req_container *reqc)
+{
+    const pho_req_t *req = reqc->req;
+    enum rsc_family family;
+    const char *kind;
+    GString *line;
+    ssize_t rc;
+
+    if (pho_request_is_read(req)) {
+        kind = "read";
+        family = req->ralloc->med_ids[0]->family;
+    } else if (pho_request_is_write(req)) {
+        kind = "write";
+        family = req->walloc->family;
+    } else if (pho_request_is_format(req)) {
+        kind = "format";
+        family = req->format->med_id->family;
+    } else {
+        return;
+    }
+
+    line = g_string_new(NULL);
+    g_string_printf(line, "%ld.%09ld %s %s %" PRId64 " %" PRId64,
+                    (long)reqc->received_at.tv_sec,
+                    reqc->received_at.tv_nsec, rsc_family2str(family), kind,
+                    req->has_qos ? req->qos : 0,
+                    req->has_priority ? req->priority : 0);
+
+    if (pho_request_is_read(req))
+        trace_read(line, req->ralloc);
+    else if (pho_request_is_write(req))
+        trace_write(line, req->walloc);
+    else
+        trace_append_name(line, req->format->med_id->name);
+
+    g_string_append_c(line, '\n');
+
+    rc = write(fd, line->str, line->len);
+    if (rc != (ssize_t)line->len)
+        pho_warn("Failed to record request %d to the trace: %s", req->id,
+                 rc < 0 ? strerror(errno) : "short write");
+
+    g_string_free(line, TRUE);
+}
+
+static int parse_uint64(const char *str, uint64_t *value, char **end)
+{
+    char *stop;
+
+    if (!str || *str < '0' || *str > '9')
+        return -EINVAL;
+
+    errno = 0;
+    *value = strtoull(str, &stop, 10);
+    if (errno)
+        return -EINVAL;
+
+    if (end)
+        *end = stop;
+    else if (*stop != '\0')
+        return -EINVAL;
+
+    return 0;
+}
+
+static int parse_int64(const char *str, int64_t *value)
+{
+    char *stop;
+
+    if (!str)
+        return -EINVAL;
+
+    errno = 0;
+    *value = strtoll(str, &stop, 10);
+    if (errno || stop == str || *stop != '\0')
+        return -EINVAL;
+
+    return 0;
+}
+
+static int parse_received_at(const char *str, struct timespec *received_at)
+{
+    uint64_t nsec;
+    uint64_t sec;
+    char *end;
+    int rc;
+
+    rc = parse_uint64(str, &sec, &end);
+    if (rc || *end != '.' || strlen(end + 1) != 9)
+        return -EINVAL;
+
+    rc = parse_uint64(end + 1, &nsec, NULL);
+    if (rc)
+        return rc;
+
+    received_at->tv_sec = sec;
+    received_at->tv_nsec = nsec;
+
+    return 0;
+}
+
+/** Decode a name recorded by trace_append_name, NULL if it is invalid */
+static char *parse_name(const char *str)
+{
+    gchar *unescaped;
+    char *name;
+
+    unescaped = g_uri_unescape_string(str, NULL);
+    if (!unescaped || *unescaped == '\0') {
+        g_free(unescaped);
+        return NULL;
+    }
+
+    name = xstrdup(unescaped);
+    g_free(unescaped);
+
+    return name;
+}
+
+static int parse_read(char **args, size_t n_args,
+                      struct lrs_trace_entry *entry)
+{
+    uint64_t n_required;
+    size_t i;
+    int rc;
+
+    if (n_args < 2)
+        return -EINVAL;
+
+    rc = parse_uint64(args[0], &n_required, NULL);
+    if (rc)
+        return rc;
+
+    entry->n_media = n_args - 1;
+    if (n_required == 0 || n_required > entry->n_media)
+        return -EINVAL;
+
+    entry->n_required = n_required;
+    entry->media = xcalloc(entry->n_media, sizeof(*entry->media));
+
+    for (i = 0; i < entry->n_media; i++) {
+        char *position = strchr(args[i + 1], '@');
+
+        if (position) {
+            /* the positions are given for all the media or for none */
+            if (!entry->positions) {
+                if (i != 0)
+                    return -EINVAL;
+                entry->positions = xcalloc(entry->n_media,
+                                           sizeof(*entry->positions));
+            }
+
+            *position = '\0';
+            rc = parse_uint64(position + 1, &entry->positions[i], NULL);
+            if (rc)
+                return rc;
+        } else if (entry->positions) {
+            return -EINVAL;
+        }
+
+        entry->media[i] = parse_name(args[i + 1]);
+        if (!entry->media[i])
+            return -EINVAL;
+    }
+
+    return 0;
+}
+
+static int parse_write(char **args, size_t n_args,
+                       struct lrs_trace_entry *entry)
+{
+    size_t i;
+    int rc;
+
+    if (n_args < 3 || strlen(args[1]) != 1 ||
+        (args[1][0] != '0' && args[1][0] != '1'))
+        return -EINVAL;
+
+    if (strcmp(args[0], "-")) {
+        entry->grouping = parse_name(args[0]);
+        if (!entry->grouping)
+            return -EINVAL;
+    }
+    entry->no_split = args[1][0] == '1';
+
+    entry->n_media = n_args - 2;
+    entry->sizes = xcalloc(entry->n_media, sizeof(*entry->sizes));
+    entry->empty_medium = xcalloc(entry->n_media,
+                                  sizeof(*entry->empty_medium));
+
+    for (i = 0; i < entry->n_media; i++) {
+        char *end;
+
+        rc = parse_uint64(args[i + 2], &entry->sizes[i], &end);
+        if (rc)
+            return rc;
+
+        entry->empty_medium[i] = *end == '!';
+        if (*end != '\0' && strcmp(end, "!"))
+            return -EINVAL;
+    }
+
+    return 0;
+}
+
+static int parse_format(char **args, size_t n_args,
+                        struct lrs_trace_entry *entry)
+{
+    if (n_args != 1)
+        return -EINVAL;
+
+    entry->n_media = 1;
+    entry->n_required = 1;
+    entry->media = xcalloc(1, sizeof(*entry->media));
+    entry->media[0] = parse_name(args[0]);
+
+    return entry->media[0] ? 0 : -EINVAL;
+}
+
+int lrs_trace_parse(const char *line, struct lrs_trace_entry *entry)
+{
+    gchar **fields;
+    size_t n_fields;
+    int rc;
+
+    memset(entry, 0, sizeof(*entry));
+
+    /* consecutive separators give empty fields, drop them */
+    fields = g_strsplit_set(line, TRACE_SEPARATORS, -1);
+    for (n_fields = 0; fields[n_fields]; ) {
+        if (*fields[n_fields] == '\0') {
+            size_t i;
+
+            g_free(fields[n_fields]);
+            for (i = n_fields; fields[i]; i++)
+                fields[i] = fields[i + 1];
+        } else {
+            n_fields++;
+        }
+    }
+
+    if (n_fields < 6)
+        GOTO(out_free, rc = -EINVAL);
+
+    rc = parse_received_at(fields[0], &entry->received_at);
+    if (rc)
+        goto out_free;
+
+    entry->family = str2rsc_family(fields[1]);
+    if (entry->family == PHO_RSC_INVAL)
+        GOTO(out_free, rc = -EINVAL);
+
+    rc = parse_int64(fields[3], &entry->qos);
+    if (rc)
+        goto out_free;
+
+    rc = parse_int64(fields[4], &entry->priority);
+    if (rc)
+        goto out_free;
+
+    if (!strcmp(fields[2], "read")) {
+        entry->type = IO_REQ_READ;
+        rc = parse_read(fields + 5, n_fields - 5, entry);
+    } else if (!strcmp(fields[2], "write")) {
+        entry->type = IO_REQ_WRITE;
+        rc = parse_write(fields + 5, n_fields - 5, entry);
+    } else if (!strcmp(fields[2], "format")) {
+        entry->type = IO_REQ_FORMAT;
+        rc = parse_format(fields + 5, n_fields - 5, entry);
+    } else {
+        rc = -EINVAL;
+    }
+
+out_free:
+    g_strfreev(fields);
+    if (rc)
+        lrs_trace_entry_clean(entry);
+
+    return rc;
+}
+
+void lrs_trace_entry_clean(struct lrs_trace_entry *entry)
+{
+    size_t i;
+
+    if (entry->media)
+        for (i = 0; i < entry->n_media; i++)
+            free(entry->media[i]);
+
+    free(entry->media);
+    free(entry->positions);
+    free(entry->grouping);
+    free(entry->sizes);
+    free(entry->empty_medium);
+    memset(entry, 0, sizeof(*entry));
+}
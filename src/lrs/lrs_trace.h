@@ -0,0 +1,107 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  LRS request trace
+ *
+ * The read, write and format requests pushed to the I/O schedulers can be
+ * recorded to the "trace_file" of the [lrs] section, one line per request, to
+ * replay them offline against other scheduling policies. A line is made of:
+ *
+ *   <received_at> <family> <kind> <qos> <priority> <arguments>
+ *
+ * with the reception date as "<sec>.<nsec>", and the arguments:
+ *   - read:   <n_required> <medium>[@<position>]...
+ *   - write:  <grouping or "-"> <no_split> <size>[!]...   ('!' if the medium
+ *             must be empty)
+ *   - format: <medium>
+ *
+ * The medium names and the grouping are percent-encoded as in URIs, so that a
+ * blank, a '%' or a '@' in them does not break the line.
+ */
+#ifndef _PHO_LRS_TRACE_H
+#define _PHO_LRS_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "io_sched.h"
+#include "lrs_sched.h"
+
+/** One request of a trace */
+struct lrs_trace_entry {
+    struct timespec      received_at;   /**< reception of the request */
+    enum rsc_family      family;        /**< family of the media */
+    enum io_request_type type;          /**< read, write or format */
+    int64_t              qos;           /**< QoS of the request */
+    int64_t              priority;      /**< priority of the request */
+    size_t               n_media;       /**< number of media of the request */
+    size_t               n_required;    /**< read: media to allocate */
+    char               **media;         /**< read, format: medium names */
+    uint64_t            *positions;     /**< read: positions of the extents,
+                                          *  NULL if unknown
+                                          */
+    char                *grouping;      /**< write: NULL if none */
+    bool                 no_split;      /**< write: on a single medium */
+    uint64_t            *sizes;         /**< write: size per medium */
+    bool                *empty_medium;  /**< write: empty medium required */
+};
+
+/**
+ * Open a trace file to append requests to.
+ *
+ * \param[in]   path  Path of the trace file
+ * \param[out]  fd    File descriptor of the trace
+ *
+ * \return            0 on success, negative error code on failure
+ */
+int lrs_trace_open(const char *path, int *fd);
+
+/**
+ * Append a request to a trace, in a single write so that the schedulers of
+ * several families can share a trace file. Other kinds of requests than
+ * read, write and format are ignored.
+ *
+ * \param[in]   fd    File descriptor of the trace
+ * \param[in]   reqc  Request to record
+ */
+void lrs_trace_request(int fd, const struct req_container *reqc);
+
+/**
+ * Parse a line of a trace.
+ *
+ * \param[in]   line   Line to parse, without its end of line
+ * \param[out]  entry  Request of the line, to clean with
+ *                     lrs_trace_entry_clean
+ *
+ * \return             0 on success, -EINVAL if the line is invalid
+ */
+int lrs_trace_parse(const char *line, struct lrs_trace_entry *entry);
+
+/**
+ * Free the content of a trace entry.
+ *
+ * \param[in]   entry  Entry filled by lrs_trace_parse
+ */
+void lrs_trace_entry_clean(struct lrs_trace_entry *entry);
+
+#endif
@@ -247,11 +247,40 @@ void rml_init(struct read_media_list *list, struct req_container *reqc)
 {
     list->rml_media = reqc->req->ralloc->med_ids;
     list->rml_size = reqc->req->ralloc->n_med_ids;
+    list->rml_positions =
+        reqc->req->ralloc->n_positions == reqc->req->ralloc->n_med_ids ?
+            reqc->req->ralloc->positions : NULL;
+    list->rml_addresses =
+        reqc->req->ralloc->n_addresses == reqc->req->ralloc->n_med_ids ?
+            reqc->req->ralloc->addresses : NULL;
     list->rml_available = list->rml_size;
     list->rml_allocated = 0;
     list->rml_errors = 0;
 }
 
+/* Swap the media IDs at \p first_index and \p second_index, and their
+ * positions and addresses.
+ */
+static void rml_switch(struct read_media_list *list, size_t first_index,
+                       size_t second_index)
+{
+    med_ids_switch(list->rml_media, first_index, second_index);
+
+    if (list->rml_positions) {
+        uint64_t saved_position = list->rml_positions[first_index];
+
+        list->rml_positions[first_index] = list->rml_positions[second_index];
+        list->rml_positions[second_index] = saved_position;
+    }
+
+    if (list->rml_addresses) {
+        char *saved_address = list->rml_addresses[first_index];
+
+        list->rml_addresses[first_index] = list->rml_addresses[second_index];
+        list->rml_addresses[second_index] = saved_address;
+    }
+}
+
 static size_t rml_last_unavailable(struct read_media_list *list)
 {
     return list->rml_size - 1 - list->rml_errors;
@@ -274,7 +303,7 @@ static void rml_move_medium_to_unavailable(struct read_media_list *list,
         /* move index to first unavailable slot, the last available item will
          * take the place of index
          */
-        med_ids_switch(list->rml_media, index, list->rml_available);
+        rml_switch(list, index, list->rml_available);
 }
 
 enum read_medium_allocation_status rml_errno2status(int rc)
@@ -295,7 +324,7 @@ size_t rml_medium_update(struct read_media_list *list, size_t index,
     switch (status) {
     case RMAS_OK:
         /* Move the medium ID at the end of the allocated list */
-        med_ids_switch(list->rml_media, index, list->rml_allocated++);
+        rml_switch(list, index, list->rml_allocated++);
         break;
     case RMAS_ERROR:
         if ((list->rml_size - list->rml_errors) != list->rml_available)
@@ -304,7 +333,7 @@ size_t rml_medium_update(struct read_media_list *list, size_t index,
              * The previous last unavailable is now at index and will be swapped
              * next.
              */
-            med_ids_switch(list->rml_media, index, rml_last_unavailable(list));
+            rml_switch(list, index, rml_last_unavailable(list));
 
         list->rml_errors++;
         if (list->rml_reset_done)
@@ -332,10 +361,10 @@ void rml_medium_realloc_failed(struct read_media_list *list,
            == list->rml_size);
 
     /* Move the newly allocated medium to the last free position */
-    med_ids_switch(list->rml_media, free_index, rml_last_free(list));
+    rml_switch(list, free_index, rml_last_free(list));
 
     /* Swap the allocated medium with the failed one */
-    med_ids_switch(list->rml_media, failed_index, rml_last_free(list));
+    rml_switch(list, failed_index, rml_last_free(list));
 
     /* increase the size of the error section making the last free an error */
     list->rml_errors++;
@@ -347,7 +376,7 @@ void rml_medium_realloc(struct read_media_list *list,
                         size_t free_index,
                         size_t allocated_index)
 {
-    med_ids_switch(list->rml_media, free_index, allocated_index);
+    rml_switch(list, free_index, allocated_index);
 }
 
 size_t rml_nb_usable_media(struct read_media_list *list)
@@ -112,6 +112,14 @@ struct read_media_list {
     pho_rsc_id_t **rml_media;
     /** size of rml_media */
     size_t rml_size;
+    /** position of the extent on each of rml_media, kept in the same order
+     *  (points to ralloc->positions, NULL if unknown)
+     */
+    uint64_t *rml_positions;
+    /** address of the extent on each of rml_media, kept in the same order
+     *  (points to ralloc->addresses, NULL if unknown)
+     */
+    char **rml_addresses;
 
     /** number of media currently available for allocation that the scheduler
      *  can choose from. Temporarily unavailable and failed media are not
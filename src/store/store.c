@@ -36,6 +36,7 @@
 #include "pho_io.h"
 #include "pho_layout.h"
 #include "pho_srl_lrs.h"
+#include "pho_stats.h"
 #include "pho_type_utils.h"
 #include "pho_types.h"
 #include "store_profile.h"
@@ -43,14 +44,17 @@
 
 #include <attr/xattr.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
 
-#define RETRY_SLEEP_MAX_US (1000 * 1000) /* 1 second */
-#define RETRY_SLEEP_MIN_US (10 * 1000)   /* 10 ms */
+/** Maximum time to wait for an LRS response before checking again */
+#define RESPONSE_WAIT_TIMEOUT_MS 1000
 
 /**
  * List of configuration parameters for store
@@ -58,9 +62,10 @@
 enum pho_cfg_params_store {
     PHO_CFG_STORE_lrs_socket,
     PHO_CFG_STORE_delete_incomplete_delay_second,
+    PHO_CFG_STORE_max_drives_per_get,
 
     PHO_CFG_STORE_FIRST = PHO_CFG_STORE_lrs_socket,
-    PHO_CFG_STORE_LAST = PHO_CFG_STORE_delete_incomplete_delay_second,
+    PHO_CFG_STORE_LAST = PHO_CFG_STORE_max_drives_per_get,
 };
 
 const struct pho_config_item cfg_store[] = {
@@ -68,7 +73,11 @@ const struct pho_config_item cfg_store[] = {
     [PHO_CFG_STORE_delete_incomplete_delay_second] = {
         .section = "store",
         .name = "delete_incomplete_delay_second",
-        .value = "86400" /* 24 hours */}
+        .value = "86400" /* 24 hours */},
+    [PHO_CFG_STORE_max_drives_per_get] = {
+        .section = "store",
+        .name = "max_drives_per_get",
+        .value = "1"},
 };
 
 /**
@@ -76,11 +85,24 @@ const struct pho_config_item cfg_store[] = {
  * the fly.
  */
 struct phobos_handle {
-    struct dss_handle dss;          /**< DSS handle, configured from conf */
+    struct dss_handle *dss;         /**< DSS handle, configured from conf */
+    struct pho_comm_info *comm;     /**< Communication socket info. */
+    uint32_t first_req_id;          /**< Request id of the first processor,
+                                      *  the LRS responses are routed to the
+                                      *  processor at index
+                                      *  (req_id - first_req_id)
+                                      */
     struct pho_xfer_desc *xfers;    /**< Transfers being handled */
     struct pho_data_processor *processors;
-                                    /**< Processors corresponding to xfers */
+                                    /**< Processors corresponding to xfers,
+                                      *  followed by the split readers
+                                      */
     size_t n_xfers;                 /**< Number of xfers */
+    size_t n_procs;                 /**< Number of processors, n_xfers plus
+                                      *  the split readers reading the splits
+                                      *  of a GET concurrently with the
+                                      *  processor of its xfer
+                                      */
     size_t n_ended_xfers;           /**< Number of "true" in `ended_xfers`,
                                       *  maintained for performance purposes
                                       */
@@ -96,12 +118,54 @@ struct phobos_handle {
                                      *  failure)
                                      */
 
-    struct pho_comm_info comm;      /**< Communication socket info. */
-
     pho_completion_cb_t cb;         /**< Callback called on xfer completion */
     void *udata;                    /**< User-provided argument to `cb` */
+    struct timespec start_time;     /**< Start of the transfers, which are
+                                      *  all handled concurrently
+                                      */
 };
 
+/** Histograms of the rate of the successful puts and gets, in bytes/s */
+static struct pho_stat *xfer_rate[PHO_XFER_OP_LAST];
+static pthread_once_t xfer_rate_once = PTHREAD_ONCE_INIT;
+
+static void xfer_rate_create(void)
+{
+    xfer_rate[PHO_XFER_OP_PUT] = pho_stat_create(PHO_STAT_HISTOGRAM, "xfer",
+                                                 "bytes_per_sec", "op=PUT");
+    xfer_rate[PHO_XFER_OP_GET] = pho_stat_create(PHO_STAT_HISTOGRAM, "xfer",
+                                                 "bytes_per_sec", "op=GET");
+}
+
+/** Record the rate of a successful put or get */
+static void xfer_rate_observe(struct phobos_handle *pho,
+                              struct pho_xfer_desc *xfer)
+{
+    struct timespec elapsed;
+    struct timespec now;
+    double seconds;
+    double size = 0;
+    int i;
+
+    if (xfer->xd_op != PHO_XFER_OP_PUT && xfer->xd_op != PHO_XFER_OP_GET)
+        return;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    if (cmp_timespec(&now, &pho->start_time) <= 0)
+        return;
+
+    elapsed = diff_timespec(&now, &pho->start_time);
+    seconds = elapsed.tv_sec + elapsed.tv_nsec / 1e9;
+
+    for (i = 0; i < xfer->xd_ntargets; i++)
+        if (xfer->xd_targets[i].xt_size > 0)
+            size += xfer->xd_targets[i].xt_size;
+
+    pthread_once(&xfer_rate_once, xfer_rate_create);
+    if (xfer_rate[xfer->xd_op])
+        pho_stat_observe(xfer_rate[xfer->xd_op], size / seconds);
+}
+
 int phobos_init(void)
 {
     int rc;
@@ -467,11 +531,14 @@ static int processor_communicate(struct pho_data_processor *proc,
 
     /* process buffer data until we face an error */
     /* no more io needed after a completed write step */
+    /* the reader of a ranged GET may start before the writer, to read whole
+     * stripes
+     */
     while (!rc && !writer_done && !proc->need_alloc_response_to_write &&
            !((reader_done || proc->need_alloc_response_to_read) &&
-             proc->reader_offset == proc->writer_offset)) {
+             proc->reader_offset <= proc->writer_offset)) {
         /* try read first */
-        if ((!reader_done && proc->reader_offset == proc->writer_offset &&
+        if ((!reader_done && proc->reader_offset <= proc->writer_offset &&
             proc->object_size != 0) ||
             /* on error we need to call the reader one last time to generate
              * release requests.
@@ -549,6 +616,65 @@ DSS_FREE:
     return rc;
 }
 
+/**
+ * Reserve the oids of all the targets of a put in one DSS transaction, as
+ * object_md_save() without overwrite would do for each of them.
+ *
+ * If one of the oids already exists, no object is saved and the xt_rc of the
+ * conflicting targets is set to -EEXIST.
+ */
+int object_md_reserve(struct dss_handle *dss, struct pho_xfer_target *targets,
+                      int n_targets, const char *grouping,
+                      const char *copy_name)
+{
+    struct object_info *objs = xcalloc(n_targets, sizeof(*objs));
+    GString **md_reprs = xcalloc(n_targets, sizeof(*md_reprs));
+    int *rcs = xcalloc(n_targets, sizeof(*rcs));
+    int rc = 0;
+    int i;
+
+    ENTRY;
+
+    for (i = 0; i < n_targets; i++) {
+        md_reprs[i] = g_string_new(NULL);
+        rc = pho_attrs_to_json(&targets[i].xt_attrs, md_reprs[i], 0);
+        if (rc)
+            LOG_GOTO(out_free, rc, "Cannot convert attributes into JSON");
+
+        objs[i].oid = targets[i].xt_objid;
+        objs[i].user_md = md_reprs[i]->str;
+        objs[i].grouping = grouping;
+        objs[i].size = targets[i].xt_size;
+        pho_debug("Storing object objid:'%s' (transient) with attributes: %s",
+                  targets[i].xt_objid, md_reprs[i]->str);
+    }
+
+    rc = dss_object_reserve(dss, objs, n_targets, copy_name, rcs);
+    for (i = 0; i < n_targets; i++) {
+        if (rcs[i] == -EEXIST) {
+            targets[i].xt_rc = rcs[i];
+            pho_error(rcs[i], "objid:'%s' already exists",
+                      targets[i].xt_objid);
+        } else if (rc == 0) {
+            targets[i].xt_version = objs[i].version;
+            targets[i].xt_objuuid = objs[i].uuid;
+        }
+    }
+
+    if (rc)
+        pho_error(rc, "Cannot reserve the %d objects of the put", n_targets);
+
+out_free:
+    for (i = 0; i < n_targets; i++)
+        if (md_reprs[i])
+            g_string_free(md_reprs[i], true);
+    free(md_reprs);
+    free(objs);
+    free(rcs);
+
+    return rc;
+}
+
 /**
  * Save this xfer oid and metadata (xd_attrs) into the DSS.
  */
@@ -1100,6 +1226,39 @@ static int check_rebuild_copy_status(struct pho_data_processor *proc,
     }
 }
 
+/**
+ * Set the bytes of the object to transfer: the range of a ranged GET, the whole
+ * object otherwise.
+ */
+static int set_processor_range(struct pho_data_processor *proc,
+                               struct pho_xfer_desc *xfer,
+                               struct object_info *obj)
+{
+    struct pho_xfer_get_params *get = &xfer->xd_params.get;
+    size_t size = obj->size;
+
+    proc->range_offset = 0;
+    proc->range_end = obj->size;
+
+    if (xfer->xd_op != PHO_XFER_OP_GET ||
+        (get->offset == 0 && get->length == 0))
+        return 0;
+
+    if (get->offset >= size)
+        LOG_RETURN(-EINVAL, "Offset %zu is beyond the end of object '%s' "
+                   "(%zu bytes)", get->offset, obj->oid, size);
+
+    proc->range_offset = get->offset;
+    if (get->length != 0 && get->length < size - get->offset)
+        proc->range_end = get->offset + get->length;
+
+    proc->reader_offset = proc->range_offset;
+    proc->writer_offset = proc->range_offset;
+    proc->buffer_offset = proc->range_offset;
+
+    return 0;
+}
+
 /**
  * Initialize a data processor to perform \a xfer, according to xfer->xd_op and
  * xfer->xd_flags.
@@ -1169,6 +1328,9 @@ static int init_enc_or_dec(struct pho_data_processor *proc,
      * handled later down the "put" line.
      */
     proc->object_size = obj->size;
+    rc = set_processor_range(proc, xfer, obj);
+    if (rc)
+        goto end;
 
     if (xfer->xd_op == PHO_XFER_OP_COPY || xfer->xd_op == PHO_XFER_OP_REBUILD) {
         /* input user do not preset the target size when creating a copy */
@@ -1221,6 +1383,192 @@ end:
     return rc;
 }
 
+static int cmp_offsets(const void *a, const void *b)
+{
+    size_t offset_a = *(const size_t *)a;
+    size_t offset_b = *(const size_t *)b;
+
+    return (offset_a > offset_b) - (offset_a < offset_b);
+}
+
+/**
+ * Get the sorted offsets of the splits starting strictly inside the range of a
+ * decoder.
+ *
+ * @param[in]   decoder     Decoder of a GET.
+ * @param[out]  offsets     Offsets of the splits, to free by the caller.
+ *
+ * @return the number of offsets
+ */
+static size_t split_offsets_in_range(struct pho_data_processor *decoder,
+                                     size_t **offsets)
+{
+    struct layout_info *layout = decoder->src_layout;
+    size_t n_offsets = 0;
+    int i;
+
+    *offsets = xcalloc(layout->ext_count, sizeof(**offsets));
+
+    for (i = 0; i < layout->ext_count; i++) {
+        size_t offset = layout->extents[i].offset;
+        bool known = false;
+        size_t j;
+
+        if (offset <= decoder->range_offset || offset >= decoder->range_end)
+            continue;
+
+        for (j = 0; j < n_offsets; j++)
+            known |= (*offsets)[j] == offset;
+
+        if (!known)
+            (*offsets)[n_offsets++] = offset;
+    }
+
+    qsort(*offsets, n_offsets, sizeof(**offsets), cmp_offsets);
+
+    return n_offsets;
+}
+
+/** Index of the split reader reading the split of \a extent */
+static size_t extent_split_reader(const struct extent *extent,
+                                  const size_t *ends, size_t n_readers)
+{
+    size_t i = 0;
+
+    while (i < n_readers - 1 && extent->offset >= ends[i])
+        i++;
+
+    return i;
+}
+
+/** Whether two split readers would need the same medium */
+static bool split_readers_share_media(const struct layout_info *layout,
+                                      const size_t *ends, size_t n_readers)
+{
+    int i, j;
+
+    for (i = 0; i < layout->ext_count; i++)
+        for (j = i + 1; j < layout->ext_count; j++)
+            if (pho_id_equal(&layout->extents[i].media,
+                             &layout->extents[j].media) &&
+                extent_split_reader(&layout->extents[i], ends, n_readers) !=
+                    extent_split_reader(&layout->extents[j], ends, n_readers))
+                return true;
+
+    return false;
+}
+
+/**
+ * Read the splits of a GET concurrently.
+ *
+ * The range of the decoder is cut on split boundaries into as many parts as
+ * the "max_drives_per_get" drives allow, the decoder keeping the first one and
+ * a split reader being appended to the processors of \a pho for each other
+ * one. They all write their part of the object in the output with pwrite.
+ *
+ * The splits are read one after another if the output cannot seek or if two
+ * parts share a medium, so that the split readers never wait for each other.
+ *
+ * @param[in/out]   pho         Phobos handle.
+ * @param[in]       xfer_idx    Index of the xfer in \a pho.
+ *
+ * @return 0 on success, -errno on error.
+ */
+static int store_add_split_readers(struct phobos_handle *pho, size_t xfer_idx)
+{
+    struct pho_data_processor *decoder = &pho->processors[xfer_idx];
+    struct pho_xfer_desc *xfer = &pho->xfers[xfer_idx];
+    struct copy_info copy = {0};
+    size_t n_readers = 0;
+    size_t *offsets;
+    size_t n_splits;
+    int max_drives;
+    off_t position;
+    size_t *ends;
+    int rc = 0;
+    int flags;
+    size_t i;
+
+    if (xfer->xd_op != PHO_XFER_OP_GET || !is_decoder(decoder) ||
+        decoder->done || !decoder->src_layout || decoder->split_n_media == 0)
+        return 0;
+
+    max_drives = PHO_CFG_GET_INT(cfg_store, PHO_CFG_STORE, max_drives_per_get,
+                                 1);
+    if (max_drives > 0)
+        n_readers = max_drives / decoder->split_n_media;
+    if (n_readers < 2)
+        return 0;
+
+    /* the parts are written at their offset in the output */
+    flags = fcntl(xfer->xd_targets->xt_fd, F_GETFL);
+    position = lseek(xfer->xd_targets->xt_fd, 0, SEEK_CUR);
+    if (flags < 0 || flags & O_APPEND || position < 0)
+        return 0;
+
+    n_splits = split_offsets_in_range(decoder, &offsets) + 1;
+    n_readers = min(n_readers, n_splits);
+    if (n_readers < 2) {
+        free(offsets);
+        return 0;
+    }
+
+    /* the parts have the same number of splits, give or take one */
+    ends = xcalloc(n_readers, sizeof(*ends));
+    for (i = 0; i < n_readers - 1; i++)
+        ends[i] = offsets[(i + 1) * n_splits / n_readers - 1];
+    ends[n_readers - 1] = decoder->range_end;
+    free(offsets);
+
+    if (split_readers_share_media(decoder->src_layout, ends, n_readers)) {
+        pho_verb("Splits of object '%s' share media, reading them one after "
+                 "another", xfer->xd_targets->xt_objid);
+        goto free_ends;
+    }
+
+    pho->processors = xrealloc(pho->processors,
+                               (pho->n_procs + n_readers - 1) *
+                                   sizeof(*pho->processors));
+    decoder = &pho->processors[xfer_idx];
+    copy.copy_name = decoder->src_layout->copy_name;
+
+    decoder->pwrite_output = true;
+    decoder->output_shift = position - decoder->range_offset;
+    decoder->range_end = ends[0];
+
+    for (i = 1; i < n_readers; i++) {
+        struct pho_data_processor *reader = &pho->processors[pho->n_procs];
+
+        memset(reader, 0, sizeof(*reader));
+        reader->object_size = decoder->object_size;
+        reader->range_offset = ends[i - 1];
+        reader->range_end = ends[i];
+        reader->reader_offset = reader->range_offset;
+        reader->writer_offset = reader->range_offset;
+        reader->buffer_offset = reader->range_offset;
+        reader->src_copy_ctime = decoder->src_copy_ctime;
+        reader->pwrite_output = true;
+        reader->output_shift = decoder->output_shift;
+
+        rc = decoder_build(pho->dss, xfer, &copy, reader);
+        if (rc)
+            LOG_GOTO(free_ends, rc,
+                     "Cannot build the split reader of object '%s' at "
+                     "offset %zu", xfer->xd_targets->xt_objid,
+                     reader->range_offset);
+
+        pho->n_procs++;
+    }
+
+    pho_verb("Object '%s' is read by %zu concurrent split readers",
+             xfer->xd_targets->xt_objid, n_readers);
+
+free_ends:
+    free(ends);
+
+    return rc;
+}
+
 static bool is_uuid_arg(struct pho_xfer_target *xfer, enum pho_xfer_op xd_op)
 {
     return xd_op == PHO_XFER_OP_UNDEL && xfer->xt_objuuid != NULL;
@@ -1236,7 +1584,7 @@ static int store_end_delete_xfer(struct phobos_handle *pho,
                                  struct pho_xfer_desc *xfer,
                                  struct pho_data_processor *proc)
 {
-    struct dss_handle *dss = &pho->dss;
+    struct dss_handle *dss = pho->dss;
     struct copy_info copy = {
         .object_uuid = xfer->xd_targets->xt_objuuid,
         .version = xfer->xd_targets->xt_version,
@@ -1248,7 +1596,7 @@ static int store_end_delete_xfer(struct phobos_handle *pho,
         .version = xfer->xd_targets->xt_version,
     };
     struct extent *extents = NULL;
-    bool medium_is_tape;
+    bool orphan_extents;
     int ext_count = 0;
     int rc;
     int i;
@@ -1261,8 +1609,10 @@ static int store_end_delete_xfer(struct phobos_handle *pho,
         extents = proc->src_layout->extents;
         ext_count = proc->src_layout->ext_count;
         copy.copy_name = proc->src_layout->copy_name;
-        medium_is_tape = ext_count != 0 ?
-            extents[0].media.family == PHO_RSC_TAPE :
+        /* packed extents are kept until their container is repacked */
+        orphan_extents = ext_count != 0 ?
+            extents[0].media.family == PHO_RSC_TAPE ||
+                extent_pack_offset(&extents[0]) >= 0 :
             false;
 
         rc = dss_layout_delete(dss, proc->src_layout, 1);
@@ -1271,7 +1621,7 @@ static int store_end_delete_xfer(struct phobos_handle *pho,
                        obj.uuid, obj.version);
 
         if (ext_count > 0) {
-            if (medium_is_tape) {
+            if (orphan_extents) {
                 for (i = 0; i < ext_count; ++i)
                     extents[i].state = PHO_EXT_ST_ORPHAN;
                 rc = dss_extent_update(dss, extents, extents, ext_count);
@@ -1282,7 +1632,7 @@ static int store_end_delete_xfer(struct phobos_handle *pho,
 
         if (rc)
             LOG_RETURN(rc, "Unable to %s object '%s:%d' extents",
-                       medium_is_tape ? "update" : "delete",
+                       orphan_extents ? "update" : "delete",
                        obj.uuid, obj.version);
     }
 
@@ -1324,14 +1674,14 @@ static int store_end_encoder_xfer(struct phobos_handle *pho,
             continue;
 
         pho_debug("Saving layout for objid:'%s'", xfer->xd_targets[i].xt_objid);
-        rc = dss_extent_insert(&pho->dss, encoder->dest_layout[i].extents,
+        rc = dss_extent_insert(pho->dss, encoder->dest_layout[i].extents,
                                encoder->dest_layout[i].ext_count,
                                DSS_SET_FULL_INSERT);
         if (rc)
             LOG_RETURN(rc, "Error while saving extents for objid: '%s'",
                        xfer->xd_targets[i].xt_objid);
 
-        rc = dss_layout_insert(&pho->dss, &encoder->dest_layout[i], 1);
+        rc = dss_layout_insert(pho->dss, &encoder->dest_layout[i], 1);
         if (rc) {
             pho_error(rc, "Error while saving layout for objid: '%s'",
                       xfer->xd_targets[i].xt_objid);
@@ -1339,7 +1689,7 @@ static int store_end_encoder_xfer(struct phobos_handle *pho,
             for (int j = 0; j < encoder->dest_layout[i].ext_count; ++j)
                 encoder->dest_layout[i].extents[j].state = PHO_EXT_ST_ORPHAN;
 
-            rc2 = dss_extent_update(&pho->dss, encoder->dest_layout[i].extents,
+            rc2 = dss_extent_update(pho->dss, encoder->dest_layout[i].extents,
                                     encoder->dest_layout[i].extents,
                                     encoder->dest_layout[i].ext_count);
             if (rc2)
@@ -1355,7 +1705,7 @@ static int store_end_encoder_xfer(struct phobos_handle *pho,
             .copy_status = PHO_COPY_STATUS_COMPLETE,
         };
 
-        rc2 = dss_copy_update(&pho->dss, &copy, &copy, 1,
+        rc2 = dss_copy_update(pho->dss, &copy, &copy, 1,
                               DSS_COPY_UPDATE_COPY_STATUS);
         if (rc2)
             LOG_RETURN(rc2, "Error while updating copy status to complete");
@@ -1380,7 +1730,7 @@ static int store_end_decoder_xfer(struct phobos_handle *pho,
         LOG_RETURN(rc,
                    "Error while retrieving current time, will skip access time update");
 
-    rc = dss_copy_update(&pho->dss, &copy, &copy, 1,
+    rc = dss_copy_update(pho->dss, &copy, &copy, 1,
                          DSS_COPY_UPDATE_ACCESS_TIME);
     if (rc)
         pho_error(rc, "Error while updating copy access time");
@@ -1465,7 +1815,7 @@ cont:
             xfer->xd_op == PHO_XFER_OP_PUT && xfer->xd_rc) {
         for (i = 0; i < xfer->xd_ntargets; i++)
             if (xfer->xd_targets[i].xt_rc)
-                object_md_del(&pho->dss, &xfer->xd_targets[i],
+                object_md_del(pho->dss, &xfer->xd_targets[i],
                               xfer->xd_params.put.copy_name);
     }
 
@@ -1480,7 +1830,7 @@ cont:
             copy.version = xfer->xd_targets[i].xt_version;
             copy.copy_name = xfer->xd_params.copy.put.copy_name;
 
-            rc2 = dss_copy_delete(&pho->dss, &copy, 1);
+            rc2 = dss_copy_delete(pho->dss, &copy, 1);
             if (rc2) {
                 pho_error(rc2, "dss_copy_delete failed for objuuid:'%s'",
                           xfer->xd_targets[i].xt_objuuid);
@@ -1489,10 +1839,56 @@ cont:
         }
     }
 
+    if (!xfer->xd_rc)
+        xfer_rate_observe(pho, xfer);
+
     if (pho->cb)
         pho->cb(pho->udata, xfer, rc);
 }
 
+/**
+ * Mark the end of a processor (successful or not), and the end of its xfer once
+ * the processor and the split readers of the xfer are all done.
+ *
+ * @param[in]   pho         The phobos handle handling this processor.
+ * @param[in]   proc_idx    The index of the terminating processor in \a pho.
+ * @param[in]   rc          The outcome of the processor.
+ */
+static void store_end_proc(struct phobos_handle *pho, size_t proc_idx, int rc)
+{
+    struct pho_data_processor *proc = &pho->processors[proc_idx];
+    size_t xfer_idx = proc_idx;
+    struct pho_xfer_desc *xfer;
+    bool running;
+    size_t i;
+
+    if (proc_idx >= pho->n_xfers)
+        xfer_idx = proc->xfer - pho->xfers;
+
+    xfer = &pho->xfers[xfer_idx];
+    proc->done = true;
+    running = !pho->processors[xfer_idx].done;
+
+    for (i = pho->n_xfers; i < pho->n_procs; i++) {
+        if (pho->processors[i].xfer != xfer)
+            continue;
+
+        /* the other split readers stop at their next step */
+        if (rc && xfer->xd_targets->xt_rc == 0)
+            xfer->xd_targets->xt_rc = rc;
+
+        running |= !pho->processors[i].done;
+    }
+
+    if (running) {
+        if (xfer->xd_rc == 0 && rc != 0)
+            xfer->xd_rc = rc;
+        return;
+    }
+
+    store_end_xfer(pho, xfer_idx, rc ? : xfer->xd_rc);
+}
+
 /**
  * Destroy a phobos handle and all associated resources. All unfinished
  * transfers will end with return code \a rc.
@@ -1502,12 +1898,12 @@ static void store_fini(struct phobos_handle *pho, int rc)
     size_t i;
 
     /* Cleanup processors */
-    for (i = 0; i < pho->n_xfers; i++) {
+    for (i = 0; i < pho->n_procs; i++) {
         /**
          * Encoders that have not finished at this point are marked as failed
          * with the global rc
          */
-        if (pho->ended_xfers && !pho->ended_xfers[i])
+        if (i < pho->n_xfers && pho->ended_xfers && !pho->ended_xfers[i])
             store_end_xfer(pho, i, rc);
 
         /*
@@ -1533,18 +1929,84 @@ static void store_fini(struct phobos_handle *pho, int rc)
     pho->processors = NULL;
     pho->ended_xfers = NULL;
     pho->md_created = NULL;
+}
 
-    rc = pho_comm_close(&pho->comm);
+/**
+ * Connect to the DSS and to the LRS.
+ *
+ * @param[out]  dss         DSS handle to initialize.
+ * @param[out]  comm        Communication socket to open to the LRS.
+ *
+ * @return 0 on success, -errno on error.
+ */
+static int store_connect(struct dss_handle *dss, struct pho_comm_info *comm)
+{
+    union pho_comm_addr sock_addr = {0};
+    int rc;
+
+    *comm = pho_comm_info_init();
+
+    /* Ensure conf is loaded */
+    rc = pho_cfg_init_local(NULL);
+    if (rc && rc != -EALREADY)
+        return rc;
+
+    sock_addr.af_unix.path = PHO_CFG_GET(cfg_store, PHO_CFG_STORE, lrs_socket);
+
+    /* Connect to the DSS */
+    rc = dss_init(dss);
+    if (rc != 0)
+        return rc;
+
+    /* Connect to the LRS */
+    rc = pho_comm_open(comm, &sock_addr, PHO_COMM_UNIX_CLIENT);
+    if (rc) {
+        dss_fini(dss);
+        LOG_RETURN(rc, "Cannot contact 'phobosd': will abort");
+    }
+
+    return 0;
+}
+
+static void store_disconnect(struct dss_handle *dss, struct pho_comm_info *comm)
+{
+    int rc;
+
+    rc = pho_comm_close(comm);
     if (rc)
         pho_error(rc, "Cannot close the communication socket");
 
-    dss_fini(&pho->dss);
+    dss_fini(dss);
+}
+
+/** Check the consistency of a set of transfers to perform. */
+static int store_check_xfers(struct pho_xfer_desc *xfers, size_t n_xfers)
+{
+    size_t i;
+    int rc;
+
+    for (i = 0; i < n_xfers; i++) {
+        rc = pho_xfer_desc_flag_check(&xfers[i]);
+        if (rc)
+            return rc;
+
+        /* Xfer can only contain more than 1 target if it's a PUT operation */
+        if (xfers->xd_ntargets > 1 && xfers->xd_op != PHO_XFER_OP_PUT)
+            return -ENOTSUP;
+    }
+
+    return 0;
 }
 
 /**
- * Initialize a phobos handle with a set of transfers to perform.
+ * Initialize a phobos handle with a set of checked transfers to perform.
  *
  * @param[out]  pho         Phobos handle to be initialized.
+ * @param[in]   dss         Connected DSS handle.
+ * @param[in]   comm        Communication socket open to the LRS.
+ * @param[in]   first_req_id
+ *                          Request id of the first processor, the next ones
+ *                          using the following ids.
  * @param[in]   xfers       Transfers to be handled.
  * @param[in]   n_xfers     Number of transfers.
  * @param[in]   cb          Completion callback called on each transfer end (may
@@ -1553,52 +2015,29 @@ static void store_fini(struct phobos_handle *pho, int rc)
  *
  * @return 0 on success, -errno on error.
  */
-static int store_init(struct phobos_handle *pho, struct pho_xfer_desc *xfers,
-                      size_t n_xfers, pho_completion_cb_t cb, void *udata)
+static int store_init(struct phobos_handle *pho, struct dss_handle *dss,
+                      struct pho_comm_info *comm, uint32_t first_req_id,
+                      struct pho_xfer_desc *xfers, size_t n_xfers,
+                      pho_completion_cb_t cb, void *udata)
 {
-    union pho_comm_addr sock_addr = {0};
-    int rc, rc2 = 0;
+    int rc = 0, rc2 = 0;
     size_t i;
 
     memset(pho, 0, sizeof(*pho));
-    pho->comm = pho_comm_info_init();
 
+    pho->dss = dss;
+    pho->comm = comm;
+    pho->first_req_id = first_req_id;
     pho->xfers = xfers;
     pho->n_xfers = n_xfers;
+    pho->n_procs = n_xfers;
     pho->cb = cb;
     pho->udata = udata;
     pho->n_ended_xfers = 0;
     pho->ended_xfers = NULL;
     pho->processors = NULL;
     pho->md_created = NULL;
-
-    /* Check xfers consistency */
-    for (i = 0; i < n_xfers; i++) {
-        rc = pho_xfer_desc_flag_check(&xfers[i]);
-        if (rc)
-            return rc;
-
-        /* Xfer can only contain more than 1 target if it's a PUT operation */
-        if (xfers->xd_ntargets > 1 && xfers->xd_op != PHO_XFER_OP_PUT)
-            return -ENOTSUP;
-    }
-
-    /* Ensure conf is loaded */
-    rc = pho_cfg_init_local(NULL);
-    if (rc && rc != -EALREADY)
-        return rc;
-
-    sock_addr.af_unix.path = PHO_CFG_GET(cfg_store, PHO_CFG_STORE, lrs_socket);
-
-    /* Connect to the DSS */
-    rc = dss_init(&pho->dss);
-    if (rc != 0)
-        return rc;
-
-    /* Connect to the LRS */
-    rc = pho_comm_open(&pho->comm, &sock_addr, PHO_COMM_UNIX_CLIENT);
-    if (rc)
-        LOG_GOTO(out, rc, "Cannot contact 'phobosd': will abort");
+    clock_gettime(CLOCK_REALTIME, &pho->start_time);
 
     /* Allocate memory for the processors */
     pho->processors = xcalloc(n_xfers, sizeof(*pho->processors));
@@ -1617,7 +2056,9 @@ static int store_init(struct phobos_handle *pho, struct pho_xfer_desc *xfers,
         pho_debug("Initializing %s %ld for %d objid(s)",
                   processor_type2str(&pho->processors[i]), i,
                   pho->xfers[i].xd_ntargets);
-        rc2 = init_enc_or_dec(&pho->processors[i], &pho->dss, &pho->xfers[i]);
+        rc2 = init_enc_or_dec(&pho->processors[i], pho->dss, &pho->xfers[i]);
+        if (!rc2)
+            rc2 = store_add_split_readers(pho, i);
         if (rc2) {
             pho_error(rc2, "Error while creating processors for %d objid(s)",
                       pho->xfers[i].xd_ntargets);
@@ -1629,7 +2070,6 @@ static int store_init(struct phobos_handle *pho, struct pho_xfer_desc *xfers,
         rc2 = 0;
     }
 
-out:
     if (rc)
         store_fini(pho, rc);
 
@@ -1639,18 +2079,19 @@ out:
 static int store_lrs_response_process(struct phobos_handle *pho,
                                       pho_resp_t *resp)
 {
-    struct pho_data_processor *proc = &pho->processors[resp->req_id];
+    size_t proc_idx = resp->req_id - pho->first_req_id;
+    struct pho_data_processor *proc = &pho->processors[proc_idx];
     int rc;
 
     pho_debug("%s %d for %d objid(s) received a response of type %s",
               processor_type2str(proc), proc->current_target,
               proc->xfer->xd_ntargets, pho_srl_response_kind_str(resp));
 
-    rc = processor_communicate(proc, &pho->comm, resp, resp->req_id);
+    rc = processor_communicate(proc, pho->comm, resp, resp->req_id);
 
     /* Success or failure final callback */
     if (rc || proc->done)
-        store_end_xfer(pho, resp->req_id, rc);
+        store_end_proc(pho, proc_idx, rc);
 
     if (rc)
         pho_error(rc, "Error while sending response to layout for %s %d",
@@ -1659,16 +2100,36 @@ static int store_lrs_response_process(struct phobos_handle *pho,
     return rc;
 }
 
-static int store_dispatch_loop(struct phobos_handle *pho)
+/**
+ * Wait up to \a timeout_ms for the LRS responses, then collect and deserialize
+ * them.
+ *
+ * @param[in]   comm        Communication socket open to the LRS.
+ * @param[in]   timeout_ms  Maximum time to wait, -1 to wait without limit.
+ * @param[out]  resps       Received responses, to free by the caller, some of
+ *                          them being NULL if they could not be deserialized.
+ * @param[out]  n_resps     Number of received responses, 0 on timeout.
+ *
+ * @return 0 on success, -errno on error.
+ */
+static int store_recv_responses(struct pho_comm_info *comm, int timeout_ms,
+                                pho_resp_t ***resps, int *n_resps)
 {
     struct pho_comm_data *responses = NULL;
     int n_responses = 0;
     int rc = 0;
     int i;
-    pho_resp_t **resps = NULL;
+
+    *resps = NULL;
+    *n_resps = 0;
+
+    /* Wake up as soon as a response arrives */
+    rc = pho_comm_wait(comm, timeout_ms);
+    if (rc <= 0)
+        return rc;
 
     /* Collect LRS responses */
-    rc = pho_comm_recv(&pho->comm, &responses, &n_responses);
+    rc = pho_comm_recv(comm, &responses, &n_responses);
     if (rc) {
         for (i = 0; i < n_responses; ++i)
             free(responses[i].buf.buff);
@@ -1678,13 +2139,34 @@ static int store_dispatch_loop(struct phobos_handle *pho)
 
     /* Deserialize LRS responses */
     if (n_responses) {
-        resps = xmalloc(n_responses * sizeof(*resps));
+        *resps = xmalloc(n_responses * sizeof(**resps));
 
         for (i = 0; i < n_responses; ++i)
-            resps[i] = pho_srl_response_unpack(&responses[i].buf);
+            (*resps)[i] = pho_srl_response_unpack(&responses[i].buf);
         free(responses);
     }
 
+    *n_resps = n_responses;
+
+    return 0;
+}
+
+static int store_dispatch_loop(struct phobos_handle *pho)
+{
+    pho_resp_t **resps = NULL;
+    int n_responses = 0;
+    int rc = 0;
+    int i;
+
+    rc = store_recv_responses(pho->comm, RESPONSE_WAIT_TIMEOUT_MS, &resps,
+                              &n_responses);
+    if (rc)
+        return rc;
+
+    if (n_responses == 0)
+        pho_debug("No response from the LRS yet, still waiting for resources "
+                  "to perform IO");
+
     /* Dispatch LRS responses to processors */
     for (i = 0; i < n_responses; i++) {
         /*
@@ -1703,40 +2185,20 @@ static int store_dispatch_loop(struct phobos_handle *pho)
             break;
     }
 
-    /*
-     * If there are no new answer, it means no resource is available yet,
-     * wait a bit before retrying.
-     */
-    if (n_responses == 0) {
-        unsigned int rand_seed = getpid() + time(NULL);
-        useconds_t sleep_time;
-
-        sleep_time =
-            (rand_r(&rand_seed) % (RETRY_SLEEP_MAX_US - RETRY_SLEEP_MIN_US))
-            + RETRY_SLEEP_MIN_US;
-        pho_info("No resource available to perform IO, retrying in %d ms",
-                 sleep_time / 1000);
-        usleep(sleep_time);
-    }
-
     free(resps);
 
     return rc;
 }
 
 /**
- * Perform the main store loop:
- * - collect requests from processors
- * - forward them to the LRS
- * - collect responses from the LRS
- * - dispatch them to the corresponding processors
- * - handle potential xfer termination (successful or not)
+ * Start the transfers of a phobos handle: save or move their metadata when
+ * needed, then send the first requests of their processors to the LRS.
  *
  * @param[in]   pho     Phobos handle describing the transfer.
  *
  * @return 0 on success, -errno on error.
  */
-static int store_perform_xfers(struct phobos_handle *pho)
+static int store_start_xfers(struct phobos_handle *pho)
 {
     size_t i, j;
     int rc = 0;
@@ -1762,7 +2224,7 @@ static int store_perform_xfers(struct phobos_handle *pho)
                                   PHO_XFER_COPY_HARD_DEL))
                 continue;
 
-            rc2 = object_delete(&pho->dss, xfer->xd_targets);
+            rc2 = object_delete(pho->dss, xfer->xd_targets);
             if (rc2)
                 pho_error(rc2, "Error while deleting objid: '%s'",
                           xfer->xd_targets->xt_objid);
@@ -1770,7 +2232,7 @@ static int store_perform_xfers(struct phobos_handle *pho)
             store_end_xfer(pho, i, rc2);
             break;
         case PHO_XFER_OP_UNDEL:
-            rc2 = object_undelete(&pho->dss, xfer->xd_targets);
+            rc2 = object_undelete(pho->dss, xfer->xd_targets);
             if (rc2)
                 pho_error(rc2, "Error while undeleting oid: '%s', uuid: '%s'",
                           xfer->xd_targets->xt_objid ?
@@ -1781,16 +2243,27 @@ static int store_perform_xfers(struct phobos_handle *pho)
             store_end_xfer(pho, i, rc2);
             break;
         case PHO_XFER_OP_PUT:
-            for (j = 0; j < xfer->xd_ntargets; j++) {
-                rc2 = object_md_save(&pho->dss, &xfer->xd_targets[j],
-                                     xfer->xd_params.put.overwrite,
-                                     xfer->xd_params.put.grouping,
-                                     xfer->xd_params.put.copy_name);
-                if (rc2) {
-                    pho_error(rc2, "Error while saving metadata for objid:'%s'",
-                              xfer->xd_targets[i].xt_objid);
+            /* The targets of an mput are all reserved in one transaction */
+            if (!xfer->xd_params.put.overwrite && xfer->xd_ntargets > 1) {
+                rc2 = object_md_reserve(pho->dss, xfer->xd_targets,
+                                        xfer->xd_ntargets,
+                                        xfer->xd_params.put.grouping,
+                                        xfer->xd_params.put.copy_name);
+                if (rc2)
                     rc = rc ? : rc2;
-                    break;
+            } else {
+                for (j = 0; j < xfer->xd_ntargets; j++) {
+                    rc2 = object_md_save(pho->dss, &xfer->xd_targets[j],
+                                         xfer->xd_params.put.overwrite,
+                                         xfer->xd_params.put.grouping,
+                                         xfer->xd_params.put.copy_name);
+                    if (rc2) {
+                        pho_error(rc2,
+                                  "Error while saving metadata for objid:'%s'",
+                                  xfer->xd_targets[j].xt_objid);
+                        rc = rc ? : rc2;
+                        break;
+                    }
                 }
             }
 
@@ -1810,7 +2283,7 @@ static int store_perform_xfers(struct phobos_handle *pho)
                 copy.copy_status = PHO_COPY_STATUS_INCOMPLETE;
                 copy.copy_name = xfer->xd_params.copy.put.copy_name;
 
-                rc2 = dss_copy_insert(&pho->dss, &copy, 1);
+                rc2 = dss_copy_insert(pho->dss, &copy, 1);
                 if (rc2) {
                     pho_error(rc2, "Cannot insert copy");
                     rc = rc ? : rc2;
@@ -1833,15 +2306,37 @@ static int store_perform_xfers(struct phobos_handle *pho)
     }
 
     /* Generate all first requests of processors */
-    for (i = 0; i < pho->n_xfers; i++) {
+    for (i = 0; i < pho->n_procs; i++) {
         if (pho->processors[i].done)
             continue;
 
-        rc = first_data_processor_call(&pho->processors[i], &pho->comm, i);
+        rc = first_data_processor_call(&pho->processors[i], pho->comm,
+                                       pho->first_req_id + i);
         if (rc)
-            store_end_xfer(pho, i, rc);
+            store_end_proc(pho, i, rc);
     }
 
+    return rc;
+}
+
+/**
+ * Perform the main store loop:
+ * - collect requests from processors
+ * - forward them to the LRS
+ * - collect responses from the LRS
+ * - dispatch them to the corresponding processors
+ * - handle potential xfer termination (successful or not)
+ *
+ * @param[in]   pho     Phobos handle describing the transfer.
+ *
+ * @return 0 on success, -errno on error.
+ */
+static int store_perform_xfers(struct phobos_handle *pho)
+{
+    int rc;
+
+    rc = store_start_xfers(pho);
+
     /* Handle all processors and forward messages between them and the LRS */
     while (pho->n_ended_xfers < pho->n_xfers) {
         rc = store_dispatch_loop(pho);
@@ -1868,15 +2363,26 @@ static int store_perform_xfers(struct phobos_handle *pho)
 static int phobos_xfer(struct pho_xfer_desc *xfers, size_t n,
                        pho_completion_cb_t cb, void *udata)
 {
+    struct pho_comm_info comm;
     struct phobos_handle pho;
+    struct dss_handle dss;
     int rc;
 
-    rc = store_init(&pho, xfers, n, cb, udata);
+    rc = store_check_xfers(xfers, n);
+    if (rc)
+        return rc;
+
+    rc = store_connect(&dss, &comm);
     if (rc)
         return rc;
 
-    rc = store_perform_xfers(&pho);
-    store_fini(&pho, rc);
+    rc = store_init(&pho, &dss, &comm, 0, xfers, n, cb, udata);
+    if (!rc) {
+        rc = store_perform_xfers(&pho);
+        store_fini(&pho, rc);
+    }
+
+    store_disconnect(&dss, &comm);
 
     return rc;
 }
@@ -1920,6 +2426,279 @@ int phobos_put(struct pho_xfer_desc *xfers, size_t n,
     return phobos_xfer(xfers, n, cb, udata);
 }
 
+/**
+ * Asynchronous store handle, keeping several sets of transfers in flight over
+ * one DSS connection and one LRS socket.
+ */
+struct phobos_async {
+    struct dss_handle dss;          /**< DSS handle shared by the transfers */
+    struct pho_comm_info comm;      /**< Socket shared by the transfers */
+    int epoll_fd;                   /**< Readable when the LRS socket or
+                                      *  event_fd is readable
+                                      */
+    int event_fd;                   /**< Readable while completed transfers
+                                      *  are waiting to be polled
+                                      */
+    bool event_signaled;            /**< Whether event_fd is readable */
+    uint32_t next_req_id;           /**< Request id of the next transfer */
+    GList *handles;                 /**< Phobos handles of the submitted
+                                      *  transfers not all ended yet
+                                      */
+    GHashTable *req_handles;        /**< Request id to its phobos handle */
+    GQueue *completed;              /**< Ended transfers not polled yet */
+    size_t n_inflight;              /**< Submitted transfers not ended yet */
+};
+
+static void store_async_completion(void *udata,
+                                   const struct pho_xfer_desc *xfer, int rc)
+{
+    struct phobos_async *async = udata;
+
+    (void) rc;
+
+    g_queue_push_tail(async->completed, (struct pho_xfer_desc *) xfer);
+    async->n_inflight--;
+}
+
+/** Make event_fd readable if and only if completed transfers are queued */
+static void store_async_update_event(struct phobos_async *async)
+{
+    bool pending = !g_queue_is_empty(async->completed);
+    eventfd_t value;
+
+    if (pending == async->event_signaled)
+        return;
+
+    if (pending)
+        eventfd_write(async->event_fd, 1);
+    else
+        eventfd_read(async->event_fd, &value);
+
+    async->event_signaled = pending;
+}
+
+/** Release a phobos handle of \a async whose transfers have all ended */
+static void store_async_handle_end(struct phobos_async *async,
+                                   struct phobos_handle *pho)
+{
+    size_t i;
+
+    if (pho->n_ended_xfers < pho->n_xfers)
+        return;
+
+    for (i = 0; i < pho->n_procs; i++)
+        g_hash_table_remove(async->req_handles,
+                            GUINT_TO_POINTER(pho->first_req_id + i));
+
+    async->handles = g_list_remove(async->handles, pho);
+    store_fini(pho, 0);
+    free(pho);
+}
+
+int phobos_async_init(struct phobos_async **async)
+{
+    struct phobos_async *handle;
+    struct epoll_event ev = {
+        .events = EPOLLIN,
+    };
+    int rc;
+
+    handle = xcalloc(1, sizeof(*handle));
+    handle->epoll_fd = -1;
+    handle->event_fd = -1;
+
+    rc = store_connect(&handle->dss, &handle->comm);
+    if (rc) {
+        free(handle);
+        return rc;
+    }
+
+    handle->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (handle->event_fd == -1)
+        LOG_GOTO(out_err, rc = -errno, "Cannot create the completion eventfd");
+
+    handle->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (handle->epoll_fd == -1)
+        LOG_GOTO(out_err, rc = -errno, "Cannot create the store epoll");
+
+    ev.data.fd = handle->comm.socket_fd;
+    if (epoll_ctl(handle->epoll_fd, EPOLL_CTL_ADD, handle->comm.socket_fd,
+                  &ev))
+        LOG_GOTO(out_err, rc = -errno, "Cannot poll the LRS socket");
+
+    ev.data.fd = handle->event_fd;
+    if (epoll_ctl(handle->epoll_fd, EPOLL_CTL_ADD, handle->event_fd, &ev))
+        LOG_GOTO(out_err, rc = -errno, "Cannot poll the completion eventfd");
+
+    handle->req_handles = g_hash_table_new(g_direct_hash, g_direct_equal);
+    handle->completed = g_queue_new();
+    *async = handle;
+
+    return 0;
+
+out_err:
+    if (handle->epoll_fd != -1)
+        close(handle->epoll_fd);
+    if (handle->event_fd != -1)
+        close(handle->event_fd);
+    store_disconnect(&handle->dss, &handle->comm);
+    free(handle);
+
+    return rc;
+}
+
+void phobos_async_fini(struct phobos_async *async)
+{
+    if (!async)
+        return;
+
+    /* Unfinished transfers are marked as canceled */
+    while (async->handles) {
+        struct phobos_handle *pho = async->handles->data;
+
+        async->handles = g_list_delete_link(async->handles, async->handles);
+        store_fini(pho, -ECANCELED);
+        free(pho);
+    }
+
+    g_hash_table_destroy(async->req_handles);
+    g_queue_free(async->completed);
+    close(async->epoll_fd);
+    close(async->event_fd);
+    store_disconnect(&async->dss, &async->comm);
+    free(async);
+}
+
+int phobos_async_fd(const struct phobos_async *async)
+{
+    return async->epoll_fd;
+}
+
+size_t phobos_async_inflight(const struct phobos_async *async)
+{
+    return async->n_inflight;
+}
+
+int phobos_put_async(struct phobos_async *async, struct pho_xfer_desc *xfers,
+                     size_t n)
+{
+    guint n_completed = g_queue_get_length(async->completed);
+    struct phobos_handle *pho;
+    size_t i;
+    int rc;
+
+    if (n == 0)
+        return 0;
+
+    phobos_prepare_xfer(xfers, n, PHO_XFER_OP_PUT, false);
+
+    for (i = 0; i < n; i++) {
+        rc = fill_put_params(&xfers[i]);
+        if (rc)
+            return rc;
+    }
+
+    rc = store_check_xfers(xfers, n);
+    if (rc)
+        return rc;
+
+    async->n_inflight += n;
+
+    pho = xmalloc(sizeof(*pho));
+    rc = store_init(pho, &async->dss, &async->comm, async->next_req_id, xfers,
+                    n, store_async_completion, async);
+    if (rc) {
+        /* every transfer of a failed submission is ended, but not reported by
+         * phobos_async_poll()
+         */
+        while (g_queue_get_length(async->completed) > n_completed)
+            g_queue_pop_tail(async->completed);
+        free(pho);
+        return rc;
+    }
+
+    for (i = 0; i < pho->n_procs; i++)
+        g_hash_table_insert(async->req_handles,
+                            GUINT_TO_POINTER(async->next_req_id + i), pho);
+    async->next_req_id += pho->n_procs;
+    async->handles = g_list_prepend(async->handles, pho);
+
+    /* Failures at this point are reported on each transfer */
+    store_start_xfers(pho);
+
+    store_async_handle_end(async, pho);
+    store_async_update_event(async);
+
+    return 0;
+}
+
+/** Dispatch the LRS responses available after waiting up to \a timeout_ms */
+static int store_async_dispatch(struct phobos_async *async, int timeout_ms)
+{
+    pho_resp_t **resps = NULL;
+    int n_responses = 0;
+    int rc;
+    int i;
+
+    rc = store_recv_responses(&async->comm, timeout_ms, &resps, &n_responses);
+    if (rc)
+        return rc;
+
+    for (i = 0; i < n_responses; i++) {
+        struct phobos_handle *pho;
+
+        if (!resps[i]) {
+            pho_error(-EINVAL,
+                      "an error occured during a response deserialization");
+            continue;
+        }
+
+        pho = g_hash_table_lookup(async->req_handles,
+                                  GUINT_TO_POINTER(resps[i]->req_id));
+        if (!pho) {
+            pho_debug("Dropping a response to the ended request %u",
+                      resps[i]->req_id);
+        } else {
+            /* errors end the transfer, which reports them */
+            store_lrs_response_process(pho, resps[i]);
+            store_async_handle_end(async, pho);
+        }
+
+        pho_srl_response_free(resps[i], true);
+    }
+
+    free(resps);
+
+    return n_responses;
+}
+
+int phobos_async_poll(struct phobos_async *async, int timeout_ms,
+                      struct pho_xfer_desc **completed, size_t max)
+{
+    size_t n_completed = 0;
+    int rc = 0;
+
+    /* only wait if there is nothing to report yet */
+    if (async->n_inflight)
+        rc = store_async_dispatch(async,
+                                  g_queue_is_empty(async->completed) ?
+                                      timeout_ms : 0);
+
+    /* then dispatch whatever else is already received, without waiting */
+    while (rc > 0 && async->n_inflight)
+        rc = store_async_dispatch(async, 0);
+
+    while (n_completed < max && !g_queue_is_empty(async->completed))
+        completed[n_completed++] = g_queue_pop_head(async->completed);
+
+    store_async_update_event(async);
+
+    if (rc < 0 && n_completed == 0)
+        return rc;
+
+    return n_completed;
+}
+
 int phobos_get(struct pho_xfer_desc *xfers, size_t n,
                pho_completion_cb_t cb, void *udata)
 {
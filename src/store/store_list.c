@@ -181,13 +181,46 @@ static int phobos_construct_obj_filter(struct pho_list_filters *filters,
     return rc;
 }
 
+/**
+ * Build the DSS filter of the object list \p filters.
+ *
+ * \param[in]       filters     The filters to use.
+ * \param[out]      filter      The DSS filter to free with dss_filter_free().
+ * \param[out]      filter_ptr  \p filter, or NULL if there is nothing to
+ *                              filter.
+ */
+static int object_list_filter_build(struct pho_list_filters *filters,
+                                    struct dss_filter *filter,
+                                    struct dss_filter **filter_ptr)
+{
+    char *json_filter = NULL;
+    int rc;
+
+    *filter_ptr = NULL;
+
+    rc = phobos_construct_obj_filter(filters, &json_filter);
+    if (rc)
+        LOG_RETURN(rc, "Failed to build the object filter");
+
+    if (json_filter == NULL)
+        return 0;
+
+    rc = dss_filter_build(filter, "%s", json_filter);
+    free(json_filter);
+    if (rc)
+        return rc;
+
+    *filter_ptr = filter;
+
+    return 0;
+}
+
 int phobos_store_object_list(struct pho_list_filters *filters,
                              enum dss_obj_scope scope,
                              struct object_info **objs, int *n_objs,
                              struct dss_sort *sort)
 {
     struct dss_filter *filter_ptr = NULL;
-    char *json_filter = NULL;
     struct dss_filter filter;
     struct dss_handle dss;
     int rc = 0;
@@ -200,17 +233,9 @@ int phobos_store_object_list(struct pho_list_filters *filters,
     if (rc != 0)
         return rc;
 
-    rc = phobos_construct_obj_filter(filters,  &json_filter);
+    rc = object_list_filter_build(filters, &filter, &filter_ptr);
     if (rc)
-        LOG_RETURN(rc, "Failed to build the object filter");
-
-    if (json_filter != NULL) {
-        rc = dss_filter_build(&filter, "%s", json_filter);
-        if (rc)
-            GOTO(err, rc);
-        filter_ptr = &filter;
-        free(json_filter);
-    }
+        GOTO(err, rc);
 
     switch (scope) {
     case DSS_OBJ_ALIVE:
@@ -241,6 +266,76 @@ void phobos_store_object_list_free(struct object_info *objs, int n_objs)
     dss_res_free(objs, n_objs);
 }
 
+struct phobos_object_iter {
+    struct dss_handle dss;      /**< Connection the cursor lives in */
+    struct dss_iter *dss_iter;  /**< Iterator over the DSS objects */
+};
+
+int phobos_store_object_iter_open(struct pho_list_filters *filters,
+                                  enum dss_obj_scope scope,
+                                  struct dss_sort *sort,
+                                  struct phobos_object_iter **iter)
+{
+    struct dss_filter *filter_ptr = NULL;
+    struct phobos_object_iter *it;
+    struct dss_filter filter;
+    int rc = 0;
+
+    rc = pho_cfg_init_local(NULL);
+    if (rc && rc != -EALREADY)
+        return rc;
+
+    it = xcalloc(1, sizeof(*it));
+
+    rc = dss_init(&it->dss);
+    if (rc != 0) {
+        free(it);
+        return rc;
+    }
+
+    rc = object_list_filter_build(filters, &filter, &filter_ptr);
+    if (rc)
+        GOTO(err, rc);
+
+    rc = dss_object_iter_open(&it->dss, filter_ptr, scope, sort, 0,
+                              &it->dss_iter);
+    dss_filter_free(filter_ptr);
+    if (rc)
+        LOG_GOTO(err, rc, "Cannot fetch objects");
+
+    *iter = it;
+
+    return 0;
+
+err:
+    dss_fini(&it->dss);
+    free(it);
+
+    return rc;
+}
+
+int phobos_store_object_iter_next(struct phobos_object_iter *iter,
+                                  struct object_info **objs, int *n_objs)
+{
+    int rc;
+
+    rc = dss_object_iter_next(iter->dss_iter, objs, n_objs);
+    if (rc)
+        pho_error(rc, "Cannot fetch objects");
+
+    return rc;
+}
+
+void phobos_store_object_iter_close(struct phobos_object_iter *iter)
+{
+    if (iter == NULL)
+        return;
+
+    dss_iter_close(iter->dss_iter);
+    dss_fini(&iter->dss);
+    free(iter);
+}
+
 int phobos_store_copy_list(struct pho_list_filters *filters,
                            enum dss_obj_scope scope,
                            struct copy_info **copy, int *n_copy,
@@ -30,6 +30,9 @@
 
 int object_md_save(struct dss_handle *dss, struct pho_xfer_target *xfer,
                    bool overwrite, const char *grouping, const char *copy_name);
+int object_md_reserve(struct dss_handle *dss, struct pho_xfer_target *targets,
+                      int n_targets, const char *grouping,
+                      const char *copy_name);
 int object_md_del(struct dss_handle *dss, struct pho_xfer_target *xfer,
                   const char *copy_name);
 int object_md_get(struct dss_handle *dss, struct pho_xfer_target *xfer);
@@ -33,6 +33,7 @@
 #include <endian.h>
 #include <assert.h>
 #include <scsi/scsi.h>
+#include <scsi/sg_lib.h>
 #include <endian.h>
 #include <unistd.h>
 
@@ -57,6 +58,7 @@ enum pho_cfg_params_scsi {
     PHO_CFG_SCSI_query_timeout_ms, /**< Timeout of a SCSI query request */
     PHO_CFG_SCSI_move_timeout_ms, /**< Timeout of a SCSI move request */
     PHO_CFG_SCSI_inquiry_timeout_ms, /**< Timeout of a SCSI inquiry request */
+    PHO_CFG_SCSI_rao_timeout_ms, /**< Timeout of a SCSI RAO request */
 
     /* Delimiters, update when modifying options */
     PHO_CFG_SCSI_FIRST = PHO_CFG_SCSI_retry_count,
@@ -68,6 +70,7 @@ enum pho_cfg_params_scsi {
 #define DEFAULT_QUERY_TIMEOUT_MS     1000 /* 1 s */
 #define DEFAULT_MOVE_TIMEOUT_MS    300000 /* 5 min */
 #define DEFAULT_INQUIRY_TIMEOUT_MS     10 /* 10 ms */
+#define DEFAULT_RAO_TIMEOUT_MS      60000 /* 1 min */
 
 /** Definition and default values of SCSI configuration parameters */
 const struct pho_config_item cfg_scsi[] = {
@@ -106,6 +109,11 @@ const struct pho_config_item cfg_scsi[] = {
         .name    = "inquiry_timeout_ms",
         .value   = STR(DEFAULT_INQUIRY_TIMEOUT_MS),
     },
+    [PHO_CFG_SCSI_rao_timeout_ms] = {
+        .section = "scsi",
+        .name    = "rao_timeout_ms",
+        .value   = STR(DEFAULT_RAO_TIMEOUT_MS),
+    },
 };
 
 /** Return retry count (get it once) */
@@ -194,6 +202,20 @@ static int scsi_inquiry_timeout_ms(void)
     return inquiry_timeout_ms;
 }
 
+/** Return RAO timeout ms (get it once) */
+static int scsi_rao_timeout_ms(void)
+{
+    static int rao_timeout_ms = -1;
+
+    if (rao_timeout_ms != -1)
+        return rao_timeout_ms;
+
+    rao_timeout_ms = PHO_CFG_GET_INT(cfg_scsi, PHO_CFG_SCSI, rao_timeout_ms,
+                                     DEFAULT_RAO_TIMEOUT_MS);
+
+    return rao_timeout_ms;
+}
+
 int scsi_mode_sense(int fd, struct mode_sense_info *info, json_t *message)
 {
     struct mode_sense_result_EAAP *res_element_addr;
@@ -650,6 +672,158 @@ int scsi_inquiry(int fd)
     return rc;
 }
 
+/* The UDS name is the index of the segment in the list given by the caller */
+static void rao_uds_name_set(struct rao_uds_descriptor *desc, size_t index)
+{
+    char name[sizeof(desc->uds_name) + 1];
+
+    snprintf(name, sizeof(name), "%0*zu", (int)sizeof(desc->uds_name), index);
+    memcpy(desc->uds_name, name, sizeof(desc->uds_name));
+}
+
+static int rao_uds_name_get(const struct rao_uds_descriptor *desc,
+                            size_t count, size_t *index)
+{
+    size_t value = 0;
+    size_t i;
+
+    for (i = 0; i < sizeof(desc->uds_name); i++) {
+        if (desc->uds_name[i] < '0' || desc->uds_name[i] > '9')
+            return -EPROTO;
+        value = value * 10 + desc->uds_name[i] - '0';
+    }
+
+    if (value >= count)
+        return -EPROTO;
+
+    *index = value;
+    return 0;
+}
+
+/** Whether the drive rejected a command because it does not know it */
+static bool scsi_sense_invalid_opcode(const struct scsi_req_sense *sense)
+{
+    return sense->sense_key == SPC_SK_ILLEGAL_REQUEST &&
+        sense->additional_sense_code == ASC_INVALID_OPCODE &&
+        sense->additional_sense_code_qualifier == ASCQ_INVALID_OPCODE;
+}
+
+int scsi_rao(int fd, const struct scsi_uds *uds, size_t count, size_t *order,
+             json_t *message)
+{
+    size_t list_len = sizeof(struct rao_list_header) +
+                      count * sizeof(struct rao_uds_descriptor);
+    struct rao_uds_descriptor *descs;
+    struct generate_rao_cdb gen_req = {0};
+    struct receive_rao_cdb recv_req = {0};
+    struct scsi_req_sense error = {0};
+    struct scsi_error scsi_err = {0};
+    struct rao_list_header *header;
+    json_t *log_object;
+    bool *seen = NULL;
+    char *buffer;
+    size_t i;
+    int rc;
+
+    if (count == 0)
+        return 0;
+
+    if (count > SCSI_RAO_MAX_UDS)
+        LOG_RETURN(-EINVAL, "Cannot order %zu segments, the limit is %d",
+                   count, SCSI_RAO_MAX_UDS);
+
+    log_object = json_object();
+    json_insert_element(log_object, "SCSI action",
+                        json_string("GENERATE_RECOMMENDED_ACCESS_ORDER"));
+    json_insert_element(log_object, "Segments", json_integer(count));
+
+    buffer = xcalloc(1, list_len);
+    header = (struct rao_list_header *)buffer;
+    descs = (struct rao_uds_descriptor *)(buffer + sizeof(*header));
+
+    header->additional_data_length =
+        htobe32(count * sizeof(struct rao_uds_descriptor));
+    for (i = 0; i < count; i++) {
+        descs[i].descriptor_length =
+            htobe16(sizeof(descs[i]) - sizeof(descs[i].descriptor_length));
+        rao_uds_name_set(&descs[i], i);
+        descs[i].partition_number = uds[i].partition;
+        descs[i].beginning_logical_object_id = htobe64(uds[i].begin);
+        descs[i].ending_logical_object_id = htobe64(uds[i].end);
+    }
+
+    pho_debug("scsi_execute: GENERATE_RECOMMENDED_ACCESS_ORDER, count=%zu",
+              count);
+
+    gen_req.opcode = MAINTENANCE_OUT_OPCODE;
+    gen_req.service_action = SERVICE_ACTION_RAO;
+    gen_req.process = RAO_PROCESS_GENERATE;
+    gen_req.uds_type = RAO_UDS_NO_GEOMETRY;
+    gen_req.parameter_list_length = htobe32(list_len);
+
+    PHO_RETRY_LOOP(rc, scsi_retry_func, &scsi_err, scsi_retry_count(),
+                   scsi_execute, &scsi_err, fd, SCSI_PUT,
+                   (unsigned char *)&gen_req, sizeof(gen_req), &error,
+                   sizeof(error), buffer, list_len, scsi_rao_timeout_ms(),
+                   log_object);
+    if (rc == -EINVAL && scsi_sense_invalid_opcode(&error)) {
+        pho_debug("The drive does not support GENERATE RAO");
+        GOTO(out_free, rc = -ENOTSUP);
+    }
+    if (rc)
+        LOG_GOTO(out_free, rc, "GENERATE RAO failed");
+
+    pho_debug("scsi_execute: RECEIVE_RECOMMENDED_ACCESS_ORDER, count=%zu",
+              count);
+
+    memset(buffer, 0, list_len);
+    memset(&error, 0, sizeof(error));
+    recv_req.opcode = MAINTENANCE_IN_OPCODE;
+    recv_req.service_action = SERVICE_ACTION_RAO;
+    recv_req.uds_type = RAO_UDS_NO_GEOMETRY;
+    recv_req.allocation_length = htobe32(list_len);
+
+    PHO_RETRY_LOOP(rc, scsi_retry_func, &scsi_err, scsi_retry_count(),
+                   scsi_execute, &scsi_err, fd, SCSI_GET,
+                   (unsigned char *)&recv_req, sizeof(recv_req), &error,
+                   sizeof(error), buffer, list_len, scsi_rao_timeout_ms(),
+                   log_object);
+    if (rc)
+        goto out_free;
+
+    if (be32toh(header->additional_data_length) !=
+            count * sizeof(struct rao_uds_descriptor))
+        LOG_GOTO(out_free, rc = -EPROTO,
+                 "Drive returned %u bytes of RAO descriptors, expected %zu",
+                 be32toh(header->additional_data_length),
+                 count * sizeof(struct rao_uds_descriptor));
+
+    seen = xcalloc(count, sizeof(*seen));
+
+    for (i = 0; i < count; i++) {
+        size_t index;
+
+        rc = rao_uds_name_get(&descs[i], count, &index);
+        if (rc || seen[index])
+            LOG_GOTO(out_free, rc = -EPROTO,
+                     "Invalid or duplicate UDS name in the RAO list");
+
+        seen[index] = true;
+        order[i] = index;
+    }
+
+out_free:
+    if (rc)
+        json_object_set_new(message, "scsi_execute", log_object);
+    else
+        json_decref(log_object);
+
+    free(seen);
+    free(buffer);
+
+    return rc;
+}
+
 void scsi_retry_func(const char *fnname, int rc, int *retry_cnt,
                      struct scsi_error *err)
 {
@@ -182,6 +182,33 @@ int scsi_move_medium(int fd, uint16_t arm_addr, uint16_t src_addr,
  */
 int scsi_inquiry(int fd);
 
+/* --------------- RECOMMENDED ACCESS ORDER API ------------------ */
+
+/** Maximum number of user data segments ordered by one scsi_rao() call */
+#define SCSI_RAO_MAX_UDS 2048
+
+/** user data segment to read from a tape (host endianess) */
+struct scsi_uds {
+    uint8_t  partition; /**< partition of the segment */
+    uint64_t begin;     /**< first logical object of the segment */
+    uint64_t end;       /**< last logical object of the segment */
+};
+
+/**
+ * Call GENERATE then RECEIVE RECOMMENDED ACCESS ORDER on the given tape drive.
+ *
+ * @param[in]  fd        File descriptor of the tape drive.
+ * @param[in]  uds       User data segments of the mounted tape.
+ * @param[in]  count     Number of segments in uds, at most SCSI_RAO_MAX_UDS.
+ * @param[out] order     Array of count indexes in uds, filled with the access
+ *                       order recommended by the drive.
+ *
+ * @return 0 on success, -ENOTSUP if the drive does not support the
+ *         Recommended Access Order, other error code < 0 on failure.
+ */
+int scsi_rao(int fd, const struct scsi_uds *uds, size_t count, size_t *order,
+             json_t *message);
+
 /** function to handle scsi error codes in a PHO_RETRY_LOOP */
 void scsi_retry_func(const char *fnname, int rc, int *retry_cnt,
                      struct scsi_error *err);
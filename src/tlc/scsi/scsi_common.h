@@ -297,6 +297,86 @@ struct standard_inquiry_data_page {
                        */
 } __attribute__((packed));
 
+/*--------------------------------------
+ *     RECOMMENDED ACCESS ORDER TYPES
+ *--------------------------------------
+ */
+#define MAINTENANCE_IN_OPCODE   0xA3
+#define MAINTENANCE_OUT_OPCODE  0xA4
+#define SERVICE_ACTION_RAO      0x1D
+
+#define RAO_PROCESS_GENERATE    0x2 /* generate the RAO list */
+#define RAO_UDS_NO_GEOMETRY     0x0 /* UDS descriptors without geometry */
+
+/* ILLEGAL REQUEST sense of a drive which does not know the command */
+#define ASC_INVALID_OPCODE      0x20
+#define ASCQ_INVALID_OPCODE     0x00
+
+/** Generate Recommended Access Order CDB (MAINTENANCE OUT) */
+struct generate_rao_cdb {
+    uint8_t opcode;               /* A4h */
+
+    uint8_t service_action:5;     /* 1Dh */
+    uint8_t reserved1:3;
+
+    uint8_t process:2;
+    uint8_t reserved2:6;
+
+    uint8_t uds_type:3;
+    uint8_t reserved3:5;
+
+    uint8_t reserved4[2];
+
+    uint32_t parameter_list_length;
+
+    uint8_t reserved5;
+
+    uint8_t control;
+} __attribute__((packed));
+
+_Static_assert(sizeof(struct generate_rao_cdb) == 12,
+               "GENERATE RAO is a 12-byte CDB");
+
+/** Receive Recommended Access Order CDB (MAINTENANCE IN) */
+struct receive_rao_cdb {
+    uint8_t opcode;               /* A3h */
+
+    uint8_t service_action:5;     /* 1Dh */
+    uint8_t reserved1:3;
+
+    uint8_t reserved2;
+
+    uint8_t uds_type:3;
+    uint8_t reserved3:5;
+
+    uint8_t reserved4[2];
+
+    uint32_t allocation_length;
+
+    uint8_t reserved5;
+
+    uint8_t control;
+} __attribute__((packed));
+
+_Static_assert(sizeof(struct receive_rao_cdb) == 12,
+               "RECEIVE RAO is a 12-byte CDB");
+
+/** Header of the UDS lists sent by GENERATE and returned by RECEIVE RAO */
+struct rao_list_header {
+    uint8_t reserved[4];
+    uint32_t additional_data_length; /* length of the descriptors */
+} __attribute__((packed));
+
+/** User Data Segment descriptor, without geometry */
+struct rao_uds_descriptor {
+    uint16_t descriptor_length;   /* 001Eh: bytes after this field */
+    uint8_t reserved[3];
+    char uds_name[10];            /* not null-terminated */
+    uint8_t partition_number;
+    uint64_t beginning_logical_object_id;
+    uint64_t ending_logical_object_id;
+} __attribute__((packed));
+
 /*--------------------------------------
  *     SCSI command helper
  *--------------------------------------*/
@@ -2,7 +2,7 @@
  * vim:expandtab:shiftwidth=4:tabstop=4:
  */
 /*
- *  All rights reserved (c) 2014-2023 CEA/DAM.
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
  *
  *  This file is part of Phobos.
  *
@@ -27,6 +27,9 @@
 #endif
 
 #include <fcntl.h>
+#include <glib.h>
+#include <limits.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -75,14 +78,195 @@ static bool should_tlc_stop(void)
     return !running;
 }
 
+struct tlc;
+
+/** Thread processing the moves of a transport element */
+struct tlc_worker {
+    struct tlc *tlc;            /*!< TLC of the worker */
+    pthread_t thread;           /*!< Thread of the worker */
+    struct dss_handle dss;      /*!< DSS handle of the thread */
+    uint16_t arm;               /*!< Address of the transport element used */
+    const char *drive_serial;   /*!< Drive of the request being processed, NULL
+                                 *   if none, protected by moves_mutex
+                                 */
+};
+
+/** Load or unload request waiting for a worker */
+struct tlc_move_req {
+    pho_tlc_req_t *req;         /*!< Unpacked request */
+    int client_socket;          /*!< Socket the request was received on, closed
+                                 *   by the communication layer when the client
+                                 *   disconnects
+                                 */
+    int response_fd;            /*!< Duplicate of client_socket to send the
+                                 *   response to, which stays valid until the
+                                 *   move is answered
+                                 */
+};
+
 struct tlc {
     struct pho_comm_info comm;  /*!< Communication handle */
     struct lib_descriptor lib;  /*!< Library descriptor */
-    struct dss_handle dss;      /*!< DSS handle, configured from conf */
+
+    struct tlc_worker *workers; /*!< One worker per transport element */
+    int n_workers;              /*!< Number of workers */
+    pthread_mutex_t moves_mutex; /*!< Protects the moves and the workers */
+    pthread_cond_t moves_cond;  /*!< Signaled when the moves are updated */
+    GQueue *moves;              /*!< struct tlc_move_req, in reception order */
+    bool stopping;              /*!< Tells the workers to stop */
 
     struct pho_stat *req_stats[PHO_TLC_REQ_COUNT]; /*!< Counters per req type */
+    struct pho_stats_server *metrics; /*!< OpenMetrics server, NULL if not
+                                       *   configured
+                                       */
 };
 
+/** Serializes the responses of the workers and of the main thread */
+static pthread_mutex_t tlc_send_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void *tlc_worker_thread(void *arg);
+
+/** Start the metrics server if "metrics_listen" is set for the library */
+static int tlc_metrics_start(struct tlc *tlc)
+{
+    const char *metrics_listen;
+    char *section_name;
+    int rc;
+
+    if (asprintf(&section_name, TLC_SECTION_CFG, tlc->lib.name) < 0)
+        return -ENOMEM;
+
+    rc = pho_cfg_get_val(section_name, TLC_METRICS_LISTEN_CFG_PARAM,
+                         &metrics_listen);
+    free(section_name);
+    if (rc == -ENODATA)
+        return 0;
+    if (rc)
+        return rc;
+
+    if (*metrics_listen == '\0')
+        return 0;
+
+    return pho_stats_server_start(metrics_listen, &tlc->metrics);
+}
+
+static void free_move_req(void *data)
+{
+    struct tlc_move_req *move = data;
+
+    close(move->response_fd);
+    pho_srl_tlc_request_free(move->req, true);
+    free(move);
+}
+
+/** Stop the workers once their current move is over */
+static void tlc_workers_stop(struct tlc *tlc)
+{
+    int i;
+
+    MUTEX_LOCK(&tlc->moves_mutex);
+    tlc->stopping = true;
+    pthread_cond_broadcast(&tlc->moves_cond);
+    MUTEX_UNLOCK(&tlc->moves_mutex);
+
+    for (i = 0; i < tlc->n_workers; i++) {
+        pthread_join(tlc->workers[i].thread, NULL);
+        dss_fini(&tlc->workers[i].dss);
+    }
+
+    free(tlc->workers);
+    tlc->workers = NULL;
+    tlc->n_workers = 0;
+
+    g_queue_free_full(tlc->moves, free_move_req);
+    tlc->moves = NULL;
+    pthread_cond_destroy(&tlc->moves_cond);
+    pthread_mutex_destroy(&tlc->moves_mutex);
+}
+
+/**
+ * Get the "max_moves" of the library, 0 for one move per transport element
+ */
+static int tlc_max_moves(struct tlc *tlc)
+{
+    char *section_name;
+    const char *value;
+    int64_t max_moves;
+    int rc;
+
+    if (asprintf(&section_name, TLC_SECTION_CFG, tlc->lib.name) < 0)
+        return -ENOMEM;
+
+    rc = pho_cfg_get_val(section_name, "max_moves", &value);
+    free(section_name);
+    if (rc == -ENODATA)
+        return 0;
+    if (rc)
+        return rc;
+
+    max_moves = str2int64(value);
+    if (max_moves < 0 || max_moves > INT_MAX)
+        LOG_RETURN(-EINVAL, "Invalid max_moves '%s' for library '%s'", value,
+                   tlc->lib.name);
+
+    return max_moves;
+}
+
+/**
+ * Start one worker per transport element of the library, up to "max_moves",
+ * or a single one using the default transport element if the library reports
+ * none.
+ */
+static int tlc_workers_start(struct tlc *tlc)
+{
+    int n_arms = tlc->lib.arms.count;
+    int max_moves;
+    int rc = 0;
+    int i;
+
+    max_moves = tlc_max_moves(tlc);
+    if (max_moves < 0)
+        return max_moves;
+
+    if (max_moves > 0 && n_arms > max_moves)
+        n_arms = max_moves;
+
+    pthread_mutex_init(&tlc->moves_mutex, NULL);
+    pthread_cond_init(&tlc->moves_cond, NULL);
+    tlc->moves = g_queue_new();
+    tlc->stopping = false;
+
+    tlc->workers = xcalloc(max(n_arms, 1), sizeof(*tlc->workers));
+    for (i = 0; i < max(n_arms, 1); i++) {
+        struct tlc_worker *worker = &tlc->workers[i];
+
+        worker->tlc = tlc;
+        /* arm = 0 for default transport element */
+        worker->arm = n_arms > 0 ? tlc->lib.arms.items[i].address : 0;
+
+        rc = dss_init(&worker->dss);
+        if (rc)
+            LOG_GOTO(stop, rc, "Cannot initialize DSS");
+
+        rc = -pthread_create(&worker->thread, NULL, tlc_worker_thread, worker);
+        if (rc) {
+            dss_fini(&worker->dss);
+            LOG_GOTO(stop, rc, "Cannot start the move worker of arm %#hx",
+                     worker->arm);
+        }
+
+        tlc->n_workers++;
+    }
+
+    pho_verb("TLC of library '%s' started %d move workers", tlc->lib.name,
+             tlc->n_workers);
+    return 0;
+
+stop:
+    tlc_workers_stop(tlc);
+    return rc;
+}
+
 static int tlc_init(struct tlc *tlc, const char *library)
 {
     union pho_comm_addr sock_addr = {0};
@@ -157,11 +341,6 @@ static int tlc_init(struct tlc *tlc, const char *library)
     if (rc)
         LOG_GOTO(close_lib, rc, "Error while opening the TLC socket");
 
-    /* DSS handle init */
-    rc = dss_init(&tlc->dss);
-    if (rc)
-        LOG_GOTO(close_lib, rc, "Cannot initialize DSS");
-
     tlc->lib.max_device_retry = -1;
 
     /* initalize stats */
@@ -176,8 +355,18 @@ static int tlc_init(struct tlc *tlc, const char *library)
         free(tag_string);
     }
 
+    rc = tlc_workers_start(tlc);
+    if (rc)
+        LOG_GOTO(close_lib, rc, "Failed to start the move workers");
+
+    rc = tlc_metrics_start(tlc);
+    if (rc)
+        LOG_GOTO(stop_workers, rc, "Failed to start the metrics server");
+
     return rc;
 
+stop_workers:
+    tlc_workers_stop(tlc);
 close_lib:
     tlc_library_close(&tlc->lib);
     return rc;
@@ -192,14 +381,17 @@ static void tlc_fini(struct tlc *tlc)
     if (tlc == NULL)
         return;
 
+    pho_stats_server_stop(tlc->metrics);
+    tlc->metrics = NULL;
+
+    tlc_workers_stop(tlc);
+
     rc = pho_comm_close(&tlc->comm);
     if (rc)
         pho_error(rc, "Error on closing the TLC socket");
 
     tlc_library_close(&tlc->lib);
 
-    dss_fini(&tlc->dss);
-
     for (i = 0; i < PHO_TLC_REQ_COUNT; i++)
         pho_stat_destroy(&tlc->req_stats[i]);
 }
@@ -221,7 +413,9 @@ static int tlc_response_send(pho_tlc_resp_t *resp, int client_socket)
     pho_srl_tlc_response_pack(resp, &msg.buf);
 
     msg.fd = client_socket;
+    MUTEX_LOCK(&tlc_send_mutex);
     rc = pho_comm_send(&msg);
+    MUTEX_UNLOCK(&tlc_send_mutex);
     if (rc)
         pho_error(rc, "TLC error on sending response");
 
@@ -314,7 +508,7 @@ err:
     return rc;
 }
 
-static int process_load_request(struct tlc *tlc, pho_tlc_req_t *req,
+static int process_load_request(struct tlc_worker *worker, pho_tlc_req_t *req,
                                 int client_socket)
 {
     json_t *json_message = NULL;
@@ -323,8 +517,9 @@ static int process_load_request(struct tlc *tlc, pho_tlc_req_t *req,
     pho_tlc_resp_t load_resp;
     int rc, rc2;
 
-    rc = tlc_library_load(&tlc->dss, &tlc->lib, req->load->drive_serial,
-                          req->load->tape_label, &json_message);
+    rc = tlc_library_load(&worker->dss, &worker->tlc->lib, worker->arm,
+                          req->load->drive_serial, req->load->tape_label,
+                          &json_message);
     if (rc) {
         tlc_build_response_error(&error_resp, req->id, rc, json_message);
         if (json_message)
@@ -351,8 +546,8 @@ static int process_load_request(struct tlc *tlc, pho_tlc_req_t *req,
     return rc;
 }
 
-static int process_unload_request(struct tlc *tlc, pho_tlc_req_t *req,
-                                  int client_socket)
+static int process_unload_request(struct tlc_worker *worker,
+                                  pho_tlc_req_t *req, int client_socket)
 {
     struct lib_item_addr unload_addr;
     json_t *json_message = NULL;
@@ -362,9 +557,9 @@ static int process_unload_request(struct tlc *tlc, pho_tlc_req_t *req,
     char *unloaded_tape_label;
     int rc, rc2;
 
-    rc = tlc_library_unload(&tlc->dss, &tlc->lib, req->unload->drive_serial,
-                            req->unload->tape_label, &unloaded_tape_label,
-                            &unload_addr, &json_message);
+    rc = tlc_library_unload(&worker->dss, &worker->tlc->lib, worker->arm,
+                            req->unload->drive_serial, req->unload->tape_label,
+                            &unloaded_tape_label, &unload_addr, &json_message);
     if (rc) {
         tlc_build_response_error(&error_resp, req->id, rc, json_message);
         if (json_message)
@@ -547,6 +742,147 @@ send_resp:
     return rc;
 }
 
+static const char *move_req_drive(const struct tlc_move_req *move)
+{
+    if (pho_tlc_request_is_load(move->req))
+        return move->req->load->drive_serial;
+
+    return move->req->unload->drive_serial;
+}
+
+/** Tell whether a worker or a move before \p until uses \p drive_serial */
+static bool drive_is_moving(struct tlc *tlc, GList *until,
+                            const char *drive_serial)
+{
+    GList *iter;
+    int i;
+
+    for (i = 0; i < tlc->n_workers; i++)
+        if (tlc->workers[i].drive_serial &&
+            !strcmp(tlc->workers[i].drive_serial, drive_serial))
+            return true;
+
+    for (iter = tlc->moves->head; iter != until; iter = iter->next)
+        if (!strcmp(move_req_drive(iter->data), drive_serial))
+            return true;
+
+    return false;
+}
+
+/**
+ * Get the first move whose drive is not used by another one, so that the
+ * moves of a drive are processed in order. Called with moves_mutex held.
+ */
+static struct tlc_move_req *next_move(struct tlc *tlc)
+{
+    GList *iter;
+
+    for (iter = tlc->moves->head; iter; iter = iter->next) {
+        if (!drive_is_moving(tlc, iter, move_req_drive(iter->data))) {
+            struct tlc_move_req *move = iter->data;
+
+            g_queue_delete_link(tlc->moves, iter);
+            return move;
+        }
+    }
+
+    return NULL;
+}
+
+static void *tlc_worker_thread(void *arg)
+{
+    struct tlc_worker *worker = arg;
+    struct tlc *tlc = worker->tlc;
+
+    MUTEX_LOCK(&tlc->moves_mutex);
+    while (!tlc->stopping) {
+        struct tlc_move_req *move = next_move(tlc);
+
+        if (!move) {
+            pthread_cond_wait(&tlc->moves_cond, &tlc->moves_mutex);
+            continue;
+        }
+
+        worker->drive_serial = move_req_drive(move);
+        MUTEX_UNLOCK(&tlc->moves_mutex);
+
+        if (pho_tlc_request_is_load(move->req))
+            process_load_request(worker, move->req, move->response_fd);
+        else
+            process_unload_request(worker, move->req, move->response_fd);
+
+        MUTEX_LOCK(&tlc->moves_mutex);
+        worker->drive_serial = NULL;
+        free_move_req(move);
+        /* the next move of this drive can be processed */
+        pthread_cond_broadcast(&tlc->moves_cond);
+    }
+    MUTEX_UNLOCK(&tlc->moves_mutex);
+
+    return NULL;
+}
+
+/**
+ * Queue a load or unload request for the workers.
+ *
+ * The client socket is duplicated for the response, so that it is not closed
+ * or reused if the client disconnects before the move is over.
+ */
+static void push_move_request(struct tlc *tlc, pho_tlc_req_t *req,
+                              int client_socket)
+{
+    struct tlc_move_req *move;
+    int response_fd;
+
+    response_fd = dup(client_socket);
+    if (response_fd == -1) {
+        pho_tlc_resp_t error_resp;
+        int rc = -errno;
+
+        pho_error(rc, "Cannot keep the client socket of a move");
+        tlc_build_response_error(&error_resp, req->id, rc, NULL);
+        tlc_response_send(&error_resp, client_socket);
+        pho_srl_tlc_response_free(&error_resp, false);
+        pho_srl_tlc_request_free(req, true);
+        return;
+    }
+
+    move = xmalloc(sizeof(*move));
+    move->req = req;
+    move->client_socket = client_socket;
+    move->response_fd = response_fd;
+
+    MUTEX_LOCK(&tlc->moves_mutex);
+    g_queue_push_tail(tlc->moves, move);
+    pthread_cond_signal(&tlc->moves_cond);
+    MUTEX_UNLOCK(&tlc->moves_mutex);
+}
+
+/**
+ * Drop the queued moves of a client which disconnected, nobody waits for them
+ * anymore. The moves being processed answer on their own duplicate of the
+ * client socket.
+ */
+static void drop_client_moves(struct tlc *tlc, int client_socket)
+{
+    GList *iter;
+    GList *next;
+
+    MUTEX_LOCK(&tlc->moves_mutex);
+    for (iter = tlc->moves->head; iter; iter = next) {
+        struct tlc_move_req *move = iter->data;
+
+        next = iter->next;
+        if (move->client_socket != client_socket)
+            continue;
+
+        pho_verb("Drop the move of drive '%s' of a disconnected client",
+                 move_req_drive(move));
+        g_queue_delete_link(tlc->moves, iter);
+        free_move_req(move);
+    }
+    MUTEX_UNLOCK(&tlc->moves_mutex);
+}
 
 static int recv_work(struct tlc *tlc)
 {
@@ -566,8 +902,10 @@ static int recv_work(struct tlc *tlc)
     for (i = 0; i < n_data; i++) {
         pho_tlc_req_t *req;
 
-        if (data[i].buf.size == -1) /* close notification, ignore */
+        if (data[i].buf.size == -1) { /* close notification */
+            drop_client_moves(tlc, data[i].fd);
             continue;
+        }
 
         req = pho_srl_tlc_request_unpack(&data[i].buf);
         if (!req)
@@ -585,16 +923,17 @@ static int recv_work(struct tlc *tlc)
             goto out_request;
         }
 
+        /* the moves are processed by the workers, which free the request */
         if (pho_tlc_request_is_load(req)) {
             pho_stat_incr(tlc->req_stats[PHO_TLC_REQ_LOAD], 1);
-            process_load_request(tlc, req, data[i].fd);
-            goto out_request;
+            push_move_request(tlc, req, data[i].fd);
+            continue;
         }
 
         if (pho_tlc_request_is_unload(req)) {
             pho_stat_incr(tlc->req_stats[PHO_TLC_REQ_UNLOAD], 1);
-            process_unload_request(tlc, req, data[i].fd);
-            goto out_request;
+            push_move_request(tlc, req, data[i].fd);
+            continue;
         }
 
         if (pho_tlc_request_is_status(req)) {
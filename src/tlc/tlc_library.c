@@ -144,9 +144,102 @@ static int lib_addrs_load(struct lib_descriptor *lib, json_t *message)
     return 0;
 }
 
+/**
+ * Get the serial number of a drive from its device id.
+ *
+ * Matching depends on library type:
+ * some librairies only return the SN as drive id,
+ * whereas some return a full description like:
+ * "VENDOR   MODEL   SERIAL".
+ * To match both, we match the last part of the serial.
+ */
+static const char *serial_from_dev_id(const char *dev_id)
+{
+    const char *sn;
+
+    sn = strrchr(dev_id, ' ');
+    if (!sn) /* only contains the SN */
+        return dev_id;
+
+    /* first char after last space */
+    return sn + 1;
+}
+
+static gint cmp_element_address(gconstpointer a, gconstpointer b,
+                                gpointer udata)
+{
+    const struct element_status *elt_a = a;
+    const struct element_status *elt_b = b;
+
+    (void)udata;
+
+    return (gint)elt_a->address - (gint)elt_b->address;
+}
+
+static void free_slot_add(struct lib_descriptor *lib,
+                          struct element_status *slot)
+{
+    g_sequence_insert_sorted(lib->free_slots, slot, cmp_element_address, NULL);
+}
+
+static void free_slot_remove(struct lib_descriptor *lib,
+                             struct element_status *slot)
+{
+    GSequenceIter *iter;
+
+    iter = g_sequence_lookup(lib->free_slots, slot, cmp_element_address, NULL);
+    if (iter)
+        g_sequence_remove(iter);
+}
+
+/** Index the elements of a status array */
+static void lib_index_add(struct lib_descriptor *lib,
+                          struct status_array *array)
+{
+    int i;
+
+    /* the latest insertion wins, so that the first element of the array is
+     * found as by a linear search
+     */
+    for (i = array->count - 1; i >= 0; i--) {
+        struct element_status *elt = &array->items[i];
+
+        g_hash_table_insert(lib->by_address, GUINT_TO_POINTER(elt->address),
+                            elt);
+
+        if (elt->full && elt->vol[0])
+            g_hash_table_insert(lib->by_label, elt->vol, elt);
+
+        if (elt->type == SCSI_TYPE_DRIVE && elt->dev_id[0])
+            g_hash_table_insert(lib->by_serial,
+                                (char *)serial_from_dev_id(elt->dev_id), elt);
+
+        if (elt->type == SCSI_TYPE_SLOT && !elt->full)
+            free_slot_add(lib, elt);
+    }
+}
+
+/** Build the indexes of the element status cache */
+void lib_index_build(struct lib_descriptor *lib)
+{
+    /* in the reverse order of the label lookups: slots, drives, arms and
+     * import/export slots
+     */
+    lib_index_add(lib, &lib->impexp);
+    lib_index_add(lib, &lib->arms);
+    lib_index_add(lib, &lib->drives);
+    lib_index_add(lib, &lib->slots);
+}
+
 /** clear the cache of library elements status */
 static void lib_status_clear(struct lib_descriptor *lib)
 {
+    g_hash_table_remove_all(lib->by_label);
+    g_hash_table_remove_all(lib->by_serial);
+    g_hash_table_remove_all(lib->by_address);
+    g_sequence_remove_range(g_sequence_get_begin_iter(lib->free_slots),
+                            g_sequence_get_end_iter(lib->free_slots));
+
     element_status_list_free(lib->arms.items);
     element_status_list_free(lib->slots.items);
     element_status_list_free(lib->impexp.items);
@@ -362,7 +455,7 @@ static int lib_status_load(struct lib_descriptor *lib,
     return 0;
 }
 
-int tlc_library_open(struct lib_descriptor *lib, json_t **json_message)
+static int lib_open(struct lib_descriptor *lib, json_t **json_message)
 {
     const char *dev;
     int rc;
@@ -370,6 +463,8 @@ int tlc_library_open(struct lib_descriptor *lib, json_t **json_message)
     *json_message = NULL;
 
     lib->fd_array = xcalloc(lib->nb_lib_device, sizeof(*lib->fd_array));
+    lib->fd_users = xcalloc(lib->nb_lib_device, sizeof(*lib->fd_users));
+    lib->fd_failed = xcalloc(lib->nb_lib_device, sizeof(*lib->fd_failed));
     lib->curr_fd_idx = -1;
 
     for (int i = 0; i < lib->nb_lib_device; i++) {
@@ -405,10 +500,28 @@ int tlc_library_open(struct lib_descriptor *lib, json_t **json_message)
     if (rc)
         pho_error(rc, "Failed to load library status");
 
+    /* index the status loaded, even partially */
+    lib_index_build(lib);
+
     return rc;
 }
 
-void tlc_library_close(struct lib_descriptor *lib)
+int tlc_library_open(struct lib_descriptor *lib, json_t **json_message)
+{
+    pthread_mutex_init(&lib->mutex, NULL);
+    pthread_cond_init(&lib->move_done, NULL);
+    lib->busy_addrs = g_array_new(FALSE, FALSE, sizeof(uint16_t));
+    lib->n_moves = 0;
+
+    lib->by_label = g_hash_table_new(g_str_hash, g_str_equal);
+    lib->by_serial = g_hash_table_new(g_str_hash, g_str_equal);
+    lib->by_address = g_hash_table_new(g_direct_hash, g_direct_equal);
+    lib->free_slots = g_sequence_new(NULL);
+
+    return lib_open(lib, json_message);
+}
+
+static void lib_close(struct lib_descriptor *lib)
 {
     lib_status_clear(lib);
     lib_addrs_clear(lib);
@@ -421,18 +534,45 @@ void tlc_library_close(struct lib_descriptor *lib)
     }
 
     free(lib->fd_array);
+    free(lib->fd_users);
+    free(lib->fd_failed);
     free(lib->lib_devices);
 
     lib->lib_devices = NULL;
     lib->nb_lib_device = 0;
 }
 
+void tlc_library_close(struct lib_descriptor *lib)
+{
+    lib_close(lib);
+
+    g_hash_table_destroy(lib->by_label);
+    g_hash_table_destroy(lib->by_serial);
+    g_hash_table_destroy(lib->by_address);
+    g_sequence_free(lib->free_slots);
+    lib->by_label = NULL;
+    lib->by_serial = NULL;
+    lib->by_address = NULL;
+    lib->free_slots = NULL;
+
+    g_array_free(lib->busy_addrs, TRUE);
+    lib->busy_addrs = NULL;
+    pthread_cond_destroy(&lib->move_done);
+    pthread_mutex_destroy(&lib->mutex);
+}
+
 int tlc_library_refresh(struct lib_descriptor *lib, json_t **json_message)
 {
     *json_message = NULL;
     int rc;
 
-    tlc_library_close(lib);
+    MUTEX_LOCK(&lib->mutex);
+
+    /* the element caches are rebuilt, wait for the moves using them */
+    while (lib->n_moves > 0)
+        pthread_cond_wait(&lib->move_done, &lib->mutex);
+
+    lib_close(lib);
 
     rc = tlc_lib_device_from_cfg(lib->name, &lib->lib_devices,
                                  &lib->nb_lib_device);
@@ -443,50 +583,43 @@ int tlc_library_refresh(struct lib_descriptor *lib, json_t **json_message)
         *json_message = json_pack("{s:s}", "LIB_DEV_CONF_ERROR",
                                  "Failed to get default library device from "
                                  "config to refresh");
-        return rc;
+        goto unlock;
     }
 
+    rc = lib_open(lib, json_message);
 
-    return tlc_library_open(lib, json_message);
+unlock:
+    MUTEX_UNLOCK(&lib->mutex);
+    return rc;
 }
 
 /**
- * Match a drive serial number vs. the requested S/N.
- * @return true if serial matches, else false.
+ * Convert a scsi element type code to a human readable string
+ * @param [in] code  element type code
+ *
+ * @return the converted result as a string
  */
-static inline bool match_serial(const char *drv_descr, const char *req_sn)
+static const char *type2str(enum element_type_code code)
 {
-    const char *sn;
-
-    /* Matching depends on library type:
-     * some librairies only return the SN as drive id,
-     * whereas some return a full description like:
-     * "VENDOR   MODEL   SERIAL".
-     * To match both, we match the last part of the serial.
-     */
-    sn = strrchr(drv_descr, ' ');
-    if (!sn) /* only contains the SN */
-        sn = drv_descr;
-    else /* first char after last space */
-        sn++;
-
-    /* return true on match */
-    return !strcmp(sn, req_sn);
+    switch (code) {
+    case SCSI_TYPE_ARM:    return "arm";
+    case SCSI_TYPE_SLOT:   return "slot";
+    case SCSI_TYPE_IMPEXP: return "import/export";
+    case SCSI_TYPE_DRIVE:  return "drive";
+    default:               return "(unknown)";
+    }
 }
 
 struct element_status *drive_element_status_from_serial(
     struct lib_descriptor *lib, const char *serial)
 {
-    int i;
-
-    for (i = 0; i < lib->drives.count; i++) {
-        struct element_status *drv = &lib->drives.items[i];
+    struct element_status *drv;
 
-        if (match_serial(drv->dev_id, serial)) {
-            pho_debug("Found drive matching serial '%s': address=%#hx, id='%s'",
-                      serial, drv->address, drv->dev_id);
-            return drv;
-        }
+    drv = g_hash_table_lookup(lib->by_serial, serial);
+    if (drv) {
+        pho_debug("Found drive matching serial '%s': address=%#hx, id='%s'",
+                  serial, drv->address, drv->dev_id);
+        return drv;
     }
 
     pho_warn("No drive matching serial '%s'", serial);
@@ -498,50 +631,12 @@ struct element_status *media_element_status_from_label(
     struct lib_descriptor *lib, const char *label)
 {
     struct element_status *med;
-    int i;
-
-    /* search in slots */
-    for (i = 0; i < lib->slots.count; i++) {
-        med = &lib->slots.items[i];
-
-        if (med->full && !strcmp(med->vol, label)) {
-            pho_debug("Found volume matching label '%s' in slot %#hx", label,
-                      med->address);
-            return med;
-        }
-    }
-
-    /* search in drives */
-    for (i = 0; i < lib->drives.count; i++) {
-        med = &lib->drives.items[i];
-
-        if (med->full && !strcmp(med->vol, label)) {
-            pho_debug("Found volume matching label '%s' in drive %#hx", label,
-                      med->address);
-            return med;
-        }
-    }
-
-    /* search in arm */
-    for (i = 0; i < lib->arms.count; i++) {
-        med = &lib->arms.items[i];
-
-        if (med->full && !strcmp(med->vol, label)) {
-            pho_debug("Found volume matching label '%s' in arm %#hx", label,
-                      med->address);
-            return med;
-        }
-    }
-
-    /* search in imp/exp slots */
-    for (i = 0; i < lib->impexp.count; i++) {
-        med = &lib->impexp.items[i];
 
-        if (med->full && !strcmp(med->vol, label)) {
-            pho_debug("Found volume matching label '%s' in import/export slot"
-                      " %#hx", label, med->address);
-            return med;
-        }
+    med = g_hash_table_lookup(lib->by_label, label);
+    if (med) {
+        pho_debug("Found volume matching label '%s' in %s %#hx", label,
+                  type2str(med->type), med->address);
+        return med;
     }
 
     pho_warn("No media matching label '%s'", label);
@@ -556,9 +651,13 @@ int tlc_library_drive_lookup(struct lib_descriptor *lib,
     struct element_status *drv;
 
     *json_error_message = NULL;
+
+    MUTEX_LOCK(&lib->mutex);
+
     /* search for the given drive serial */
     drv = drive_element_status_from_serial(lib, drive_serial);
     if (!drv) {
+        MUTEX_UNLOCK(&lib->mutex);
         *json_error_message = json_pack("{s:s}",
                                         "DRIVE_SERIAL_UNKNOWN", drive_serial);
         return -ENOENT;
@@ -576,6 +675,7 @@ int tlc_library_drive_lookup(struct lib_descriptor *lib,
         ldi->ldi_full = false;
     }
 
+    MUTEX_UNLOCK(&lib->mutex);
     return 0;
 }
 
@@ -623,87 +723,145 @@ int tlc_library_drive_lookup(struct lib_descriptor *lib,
  *}
  */
 
+/** Tell whether an element is of a location type, any for MED_LOC_UNKNOWN */
+static bool element_has_loc_type(const struct element_status *element,
+                                 enum med_location type)
+{
+    switch (type) {
+    case MED_LOC_UNKNOWN: return true;
+    case MED_LOC_DRIVE:   return element->type == SCSI_TYPE_DRIVE;
+    case MED_LOC_SLOT:    return element->type == SCSI_TYPE_SLOT;
+    case MED_LOC_IMPEXP:  return element->type == SCSI_TYPE_IMPEXP;
+    case MED_LOC_ARM:     return element->type == SCSI_TYPE_ARM;
+    default:              return false;
+    }
+}
+
 /** return information about the element at the given address. */
 static struct element_status *
 element_from_addr(const struct lib_descriptor *lib,
                   const struct lib_item_addr *addr)
 {
-    int i;
+    struct element_status *element;
 
-    if (addr->lia_type == MED_LOC_UNKNOWN ||
-        addr->lia_type == MED_LOC_DRIVE) {
-        /* search in drives */
-        for (i = 0; i < lib->drives.count; i++) {
-            pho_debug("looking for %#lx: drive #%d (addr=%#hx)",
-                      addr->lia_addr, i, lib->drives.items[i].address);
-            if (lib->drives.items[i].address == addr->lia_addr)
-                return &lib->drives.items[i];
-        }
-    }
+    if (addr->lia_addr > UINT16_MAX)
+        return NULL;
 
-    if (addr->lia_type == MED_LOC_UNKNOWN
-        || addr->lia_type == MED_LOC_SLOT) {
-        /* search in slots */
-        for (i = 0; i < lib->slots.count; i++) {
-            pho_debug("looking for %#lx: slot #%d (addr=%#hx)",
-                      addr->lia_addr, i, lib->slots.items[i].address);
-            if (lib->slots.items[i].address == addr->lia_addr)
-                return &lib->slots.items[i];
-        }
-    }
+    element = g_hash_table_lookup(lib->by_address,
+                                  GUINT_TO_POINTER(addr->lia_addr));
+    if (!element || !element_has_loc_type(element, addr->lia_type))
+        return NULL;
 
-    if (addr->lia_type == MED_LOC_UNKNOWN
-        || addr->lia_type == MED_LOC_IMPEXP) {
-        /* search in import/export slots */
-        for (i = 0; i < lib->impexp.count; i++) {
-            pho_debug("looking for %#lx: impexp #%d (addr=%#hx)",
-                      addr->lia_addr, i, lib->impexp.items[i].address);
-            if (lib->impexp.items[i].address == addr->lia_addr)
-                return &lib->impexp.items[i];
-        }
-    }
+    pho_debug("Found %s element at address %#lx", type2str(element->type),
+              addr->lia_addr);
+    return element;
+}
+
+/** Update the element status cache and its indexes after a move */
+void move_tape_between_element_status(struct lib_descriptor *lib,
+                                      struct element_status *source,
+                                      struct element_status *destination)
+{
+    source->full = false;
+    source->src_addr_is_set = false;
+    destination->full = true;
+    destination->src_addr_is_set = true;
+    destination->src_addr = source->address;
+    memcpy(destination->vol, source->vol, VOL_ID_LEN);
+
+    if (destination->vol[0])
+        g_hash_table_replace(lib->by_label, destination->vol, destination);
+
+    if (source->type == SCSI_TYPE_SLOT)
+        free_slot_add(lib, source);
+
+    if (destination->type == SCSI_TYPE_SLOT)
+        free_slot_remove(lib, destination);
+}
+
+/** Tell whether an element is reserved by an ongoing move */
+static bool element_is_busy(const struct lib_descriptor *lib,
+                            const struct element_status *element)
+{
+    guint i;
+
+    for (i = 0; i < lib->busy_addrs->len; i++)
+        if (g_array_index(lib->busy_addrs, uint16_t, i) == element->address)
+            return true;
 
-    if (addr->lia_type == MED_LOC_UNKNOWN
-        || addr->lia_type == MED_LOC_ARM) {
-        /* search in arms */
-        for (i = 0; i < lib->arms.count; i++) {
-            pho_debug("looking for %#lx: arm #%d (addr=%#hx)",
-                      addr->lia_addr, i, lib->arms.items[i].address);
-            if (lib->arms.items[i].address == addr->lia_addr)
-                return &lib->arms.items[i];
+    return false;
+}
+
+static void element_release(struct lib_descriptor *lib, uint16_t address)
+{
+    guint i;
+
+    for (i = 0; i < lib->busy_addrs->len; i++) {
+        if (g_array_index(lib->busy_addrs, uint16_t, i) == address) {
+            g_array_remove_index_fast(lib->busy_addrs, i);
+            return;
         }
     }
-
-    /* not found */
-    return NULL;
 }
 
+static void lib_retry(const char *fnname, int rc, int *retry_cnt,
+                      struct lib_descriptor *lib, int fd_idx);
+static void lib_fd_close_failed(struct lib_descriptor *lib, int fd_idx);
+
 /**
- * Convert a scsi element type code to a human readable string
- * @param [in] code  element type code
+ * Move a medium between two elements and update the element status cache.
  *
- * @return the converted result as a string
+ * Called with the library mutex held, which is released during the SCSI move.
+ * Both elements are reserved until the move is over.
  */
-static const char *type2str(enum element_type_code code)
+static int lib_move_medium(struct lib_descriptor *lib, uint16_t arm,
+                           struct element_status *source,
+                           struct element_status *target, json_t *message)
 {
-    switch (code) {
-    case SCSI_TYPE_ARM:    return "arm";
-    case SCSI_TYPE_SLOT:   return "slot";
-    case SCSI_TYPE_IMPEXP: return "import/export";
-    case SCSI_TYPE_DRIVE:  return "drive";
-    default:               return "(unknown)";
-    }
-}
+    uint16_t source_addr = source->address;
+    uint16_t target_addr = target->address;
+    int retry;
+    int rc;
 
-static void move_tape_between_element_status(struct element_status *source,
-                                             struct element_status *destination)
-{
-    source->full = false;
-    source->src_addr_is_set = false;
-    destination->full = true;
-    destination->src_addr_is_set = true;
-    destination->src_addr = source->address;
-    memcpy(destination->vol, source->vol, VOL_ID_LEN);
+    g_array_append_val(lib->busy_addrs, source_addr);
+    g_array_append_val(lib->busy_addrs, target_addr);
+    lib->n_moves++;
+
+    /* same as PHO_RETRY_LOOP, without holding the mutex during the move: the
+     * lib device is kept open until the move is over, even if it fails
+     * meanwhile
+     */
+    retry = cfg_tlc_max_device_retry(lib);
+    do {
+        int fd_idx = lib->curr_fd_idx;
+        int fd = lib->fd;
+
+        /* the lib devices may have failed while waiting for the elements */
+        if (fd_idx == -1) {
+            rc = -EBADF;
+            break;
+        }
+
+        lib->fd_users[fd_idx]++;
+        MUTEX_UNLOCK(&lib->mutex);
+        rc = scsi_move_medium(fd, arm, source_addr, target_addr, message);
+        MUTEX_LOCK(&lib->mutex);
+        lib->fd_users[fd_idx]--;
+
+        lib_retry("scsi_move_medium", rc, &retry, lib, fd_idx);
+        lib_fd_close_failed(lib, fd_idx);
+    } while (retry >= 0);
+
+    /* the cache is not rebuilt during a move, the elements are still valid */
+    if (!rc)
+        move_tape_between_element_status(lib, source, target);
+
+    element_release(lib, source_addr);
+    element_release(lib, target_addr);
+    lib->n_moves--;
+    pthread_cond_broadcast(&lib->move_done);
+
+    return rc;
 }
 
 static void tlc_log_init(const char *drive_serial, const char *tape_label,
@@ -724,8 +882,8 @@ static void tlc_log_init(const char *drive_serial, const char *tape_label,
 }
 
 int tlc_library_load(struct dss_handle *dss, struct lib_descriptor *lib,
-                     const char *drive_serial, const char *tape_label,
-                     json_t **json_message)
+                     uint16_t arm, const char *drive_serial,
+                     const char *tape_label, json_t **json_message)
 {
     struct element_status *source_element_status;
     struct element_status *drive_element_status;
@@ -734,27 +892,40 @@ int tlc_library_load(struct dss_handle *dss, struct lib_descriptor *lib,
 
     *json_message = NULL;
 
+    MUTEX_LOCK(&lib->mutex);
+
     if (lib->curr_fd_idx == -1) {
         *json_message = json_pack("{s:s}",
                                   "NO_AVAILABLE_LIB_DEVICE",
                                   "All the lib devices are marked as invalid");
-        return -EBADF;
+        GOTO(unlock, rc = -EBADF);
     }
 
-    /* get device addr */
-    drive_element_status = drive_element_status_from_serial(lib, drive_serial);
-    if (!drive_element_status) {
-        *json_message = json_pack("{s:s}",
-                                  "DRIVE_SERIAL_UNKNOWN", drive_serial);
-        return -ENOENT;
-    }
+    while (true) {
+        /* get device addr */
+        drive_element_status = drive_element_status_from_serial(lib,
+                                                                drive_serial);
+        if (!drive_element_status) {
+            *json_message = json_pack("{s:s}",
+                                      "DRIVE_SERIAL_UNKNOWN", drive_serial);
+            GOTO(unlock, rc = -ENOENT);
+        }
 
-    /* get medium addr */
-    source_element_status = media_element_status_from_label(lib, tape_label);
-    if (!source_element_status) {
-        *json_message = json_pack("{s:s}",
-                                  "MEDIA_LABEL_UNKNOWN", tape_label);
-        return -ENOENT;
+        /* get medium addr */
+        source_element_status = media_element_status_from_label(lib,
+                                                                tape_label);
+        if (!source_element_status) {
+            *json_message = json_pack("{s:s}",
+                                      "MEDIA_LABEL_UNKNOWN", tape_label);
+            GOTO(unlock, rc = -ENOENT);
+        }
+
+        if (!element_is_busy(lib, drive_element_status) &&
+            !element_is_busy(lib, source_element_status))
+            break;
+
+        /* the medium may have moved, look for it again after the move */
+        pthread_cond_wait(&lib->move_done, &lib->mutex);
     }
 
     /* prepare SCSI log */
@@ -762,36 +933,88 @@ int tlc_library_load(struct dss_handle *dss, struct lib_descriptor *lib,
                  json_message);
 
     /* move medium to device */
-    /* arm = 0 for default transport element */
-    PHO_RETRY_LOOP(rc, tlc_library_retry_func, lib,
-                   cfg_tlc_max_device_retry(lib), scsi_move_medium,
-                   lib->fd, 0, source_element_status->address,
-                   drive_element_status->address, log.message);
+    rc = lib_move_medium(lib, arm, source_element_status, drive_element_status,
+                         log.message);
+    MUTEX_UNLOCK(&lib->mutex);
+
     emit_log_after_action(dss, &log, PHO_DEVICE_LOAD, rc);
     if (rc)
         LOG_RETURN(rc, "SCSI move failed for load of tape '%s' in drive '%s'",
                    tape_label, drive_serial);
 
-    /* update element status lib cache */
-    move_tape_between_element_status(source_element_status,
-                                     drive_element_status);
     return 0;
+
+unlock:
+    MUTEX_UNLOCK(&lib->mutex);
+    return rc;
 }
 
-/** Search for a free slot in the library */
-static struct element_status *get_free_slot(struct lib_descriptor *lib)
+/**
+ * Get the slot address matching the position of a drive: the drives and the
+ * slots are assumed to be laid out in the same order, so the i-th of n drives
+ * is matched with the slot at i/n of the slot addresses.
+ */
+static uint16_t slot_address_near_drive(const struct lib_descriptor *lib,
+                                        const struct element_status *drive)
 {
-    struct element_status *slot;
-    int i;
+    const struct element_status *first = &lib->slots.items[0];
+    const struct element_status *last = &lib->slots.items[lib->slots.count - 1];
+    long index = drive - lib->drives.items;
 
-    for (i = 0; i < lib->slots.count; i++) {
-        slot = &lib->slots.items[i];
+    if (lib->drives.count < 2 || index < 0 || index >= lib->drives.count)
+        return first->address;
 
-        if (!slot->full)
-            return slot;
-    }
+    return first->address +
+        (last->address - first->address) * index / (lib->drives.count - 1);
+}
 
-    return NULL;
+/**
+ * Search for a free slot in the library, not reserved by a move, as close as
+ * possible to a drive
+ */
+struct element_status *get_free_slot(struct lib_descriptor *lib,
+                                     struct element_status *drive)
+{
+    struct element_status near = { 0 };
+    GSequenceIter *right;
+    GSequenceIter *left;
+
+    if (lib->slots.count == 0)
+        return NULL;
+
+    near.address = slot_address_near_drive(lib, drive);
+
+    /* walk from the position of the drive in both directions, the slots after
+     * "left" and before "right" were already checked
+     */
+    right = g_sequence_search(lib->free_slots, &near, cmp_element_address,
+                              NULL);
+    left = right;
+    while (true) {
+        struct element_status *before = NULL;
+        struct element_status *after = NULL;
+
+        if (!g_sequence_iter_is_begin(left))
+            before = g_sequence_get(g_sequence_iter_prev(left));
+        if (!g_sequence_iter_is_end(right))
+            after = g_sequence_get(right);
+
+        if (!before && !after)
+            return NULL;
+
+        if (after && (!before || after->address - near.address <=
+                                 near.address - before->address)) {
+            if (!element_is_busy(lib, after))
+                return after;
+
+            right = g_sequence_iter_next(right);
+        } else {
+            if (!element_is_busy(lib, before))
+                return before;
+
+            left = g_sequence_iter_prev(left);
+        }
+    }
 }
 
 /**
@@ -801,20 +1024,17 @@ static struct element_status *get_free_slot(struct lib_descriptor *lib)
  * @param[in]   drive           drive to unload
  * @param[out]  target          selected target to unload
  * @param[out]  unload_addr     selected addr to unload
- * @param[out]  json_message    message describing action or error
  *
- * @return 0 if success, else a negative error code
+ * @return 0 if success, -ENOENT if there is no free slot
  */
 static int
 get_target_free_slot_from_source_or_any(struct lib_descriptor *lib,
                                         struct element_status *drive,
                                         struct element_status **target,
-                                        struct lib_item_addr *unload_addr,
-                                        json_t **json_message)
+                                        struct lib_item_addr *unload_addr)
 {
     unload_addr->lia_type = MED_LOC_UNKNOWN;
     unload_addr->lia_addr = 0;
-    json_message = NULL;
 
     /* check drive source */
     if (drive->src_addr_is_set) {
@@ -834,7 +1054,7 @@ get_target_free_slot_from_source_or_any(struct lib_descriptor *lib,
                       type2str(drive->type), drive->address,
                       type2str((*target)->type), type2str(SCSI_TYPE_SLOT));
             unload_addr->lia_addr = 0;
-        } else if (!(*target)->full) {
+        } else if (!(*target)->full && !element_is_busy(lib, *target)) {
             /*
              * We change unload_addr->lia_type from UNKNOWN to SLOT to set we
              * find a valid slot.
@@ -850,13 +1070,9 @@ get_target_free_slot_from_source_or_any(struct lib_descriptor *lib,
     }
 
     if (unload_addr->lia_type != MED_LOC_SLOT) {
-        *target = get_free_slot(lib);
-        if (!*target) {
-            *json_message = json_pack("{s:s}",
-                                      "NO_FREE_SLOT",
-                                      "Unable to find a free slot to unload");
+        *target = get_free_slot(lib, drive);
+        if (!*target)
             return -ENOENT;
-        }
 
         unload_addr->lia_type = MED_LOC_SLOT;
     }
@@ -866,8 +1082,8 @@ get_target_free_slot_from_source_or_any(struct lib_descriptor *lib,
 }
 
 int tlc_library_unload(struct dss_handle *dss, struct lib_descriptor *lib,
-                       const char *drive_serial, const char *expected_tape,
-                       char **unloaded_tape_label,
+                       uint16_t arm, const char *drive_serial,
+                       const char *expected_tape, char **unloaded_tape_label,
                        struct lib_item_addr *unload_addr, json_t **json_message)
 {
     struct element_status *target_element_status = NULL;
@@ -880,42 +1096,71 @@ int tlc_library_unload(struct dss_handle *dss, struct lib_descriptor *lib,
     *json_message = NULL;
     *unloaded_tape_label = NULL;
 
+    MUTEX_LOCK(&lib->mutex);
+
     if (lib->curr_fd_idx == -1) {
         *json_message = json_pack("{s:s}",
                                   "NO_AVAILABLE_LIB_DEVICE",
                                   "All the lib devices are marked as invalid");
-        return -EBADF;
-    }
-
-    /* get device addr */
-    drive_element_status = drive_element_status_from_serial(lib, drive_serial);
-    if (!drive_element_status) {
-        *json_message = json_pack("{s:s}",
-                                  "DRIVE_UNKNOWN_SERIAL", drive_serial);
-        return -ENOENT;
+        GOTO(unlock, rc = -EBADF);
     }
 
-    /* check if device is empty */
-    if (drive_element_status->full == false) {
-        if (expected_tape == NULL) {
-            pho_verb("Was asked to unload an empty drive %s", drive_serial);
-            return 0;
-        } else {
+    while (true) {
+        /* get device addr */
+        drive_element_status = drive_element_status_from_serial(lib,
+                                                                drive_serial);
+        if (!drive_element_status) {
             *json_message = json_pack("{s:s}",
-                                      "EMPTY_DRIVE_DOES_NOT_CONTAIN",
-                                      expected_tape);
-            return -EINVAL;
+                                      "DRIVE_UNKNOWN_SERIAL", drive_serial);
+            GOTO(unlock, rc = -ENOENT);
+        }
+
+        if (element_is_busy(lib, drive_element_status)) {
+            pthread_cond_wait(&lib->move_done, &lib->mutex);
+            continue;
+        }
+
+        /* check if device is empty */
+        if (drive_element_status->full == false) {
+            if (expected_tape == NULL) {
+                pho_verb("Was asked to unload an empty drive %s",
+                         drive_serial);
+                GOTO(unlock, rc = 0);
+            } else {
+                *json_message = json_pack("{s:s}",
+                                          "EMPTY_DRIVE_DOES_NOT_CONTAIN",
+                                          expected_tape);
+                GOTO(unlock, rc = -EINVAL);
+            }
+        }
+
+        /* check or get loaded tape label */
+        if (expected_tape) {
+            if (strcmp(expected_tape, drive_element_status->vol)) {
+                *json_message = json_pack("{s:s, s:s}",
+                                          "EXPECTED_TAPE", expected_tape,
+                                          "LOADED_TAPE",
+                                          drive_element_status->vol);
+                GOTO(unlock, rc = -EINVAL);
+            }
         }
-    }
 
-    /* check or get loaded tape label */
-    if (expected_tape) {
-        if (strcmp(expected_tape, drive_element_status->vol)) {
-            *json_message = json_pack("{s:s, s:s}",
-                                      "EXPECTED_TAPE", expected_tape,
-                                      "LOADED_TAPE", drive_element_status->vol);
-            return -EINVAL;
+        /* get target free slot from drive source or any */
+        rc = get_target_free_slot_from_source_or_any(lib, drive_element_status,
+                                                     &target_element_status,
+                                                     unload_addr);
+        if (!rc)
+            break;
+
+        /* the ongoing moves may free a slot */
+        if (lib->n_moves == 0) {
+            *json_message = json_pack("{s:s}",
+                                      "NO_FREE_SLOT",
+                                      "Unable to find a free slot to unload");
+            GOTO(unlock, rc);
         }
+
+        pthread_cond_wait(&lib->move_done, &lib->mutex);
     }
 
     *unloaded_tape_label = xmalloc(sizeof(drive_element_status->vol) + 1);
@@ -923,38 +1168,31 @@ int tlc_library_unload(struct dss_handle *dss, struct lib_descriptor *lib,
            sizeof(drive_element_status->vol));
     (*unloaded_tape_label)[sizeof(drive_element_status->vol)] = 0;
 
-    /* get target free slot from drive source or any */
-    rc = get_target_free_slot_from_source_or_any(lib, drive_element_status,
-                                                 &target_element_status,
-                                                 unload_addr, json_message);
-    if (rc)
-        return rc;
-
     /* prepare SCSI log */
     tlc_log_init(drive_serial, *unloaded_tape_label, lib->name,
                  PHO_DEVICE_UNLOAD, &log, json_message);
 
-    /* move medium to device */
-    /* arm = 0 for default transport element */
-    PHO_RETRY_LOOP(rc, tlc_library_retry_func, lib,
-                   cfg_tlc_max_device_retry(lib), scsi_move_medium,
-                   lib->fd, 0, drive_element_status->address,
-                   target_element_status->address, log.message);
+    /* move medium to slot */
+    rc = lib_move_medium(lib, arm, drive_element_status, target_element_status,
+                         log.message);
+    MUTEX_UNLOCK(&lib->mutex);
+
     emit_log_after_action(dss, &log, PHO_DEVICE_UNLOAD, rc);
     if (rc) {
+        pho_error(rc,
+                  "SCSI move failed for unload of tape '%s' in drive '%s' to "
+                  "address %#lx",
+                  *unloaded_tape_label, drive_serial, unload_addr->lia_addr);
         free(*unloaded_tape_label);
         *unloaded_tape_label = NULL;
-        LOG_RETURN(rc,
-                   "SCSI move failed for unload of tape '%s' in drive '%s' to "
-                   "address %#hx",
-                   drive_element_status->vol, drive_serial,
-                   target_element_status->address);
+        return rc;
     }
 
-    /* update element status lib cache */
-    move_tape_between_element_status(drive_element_status,
-                                     target_element_status);
     return 0;
+
+unlock:
+    MUTEX_UNLOCK(&lib->mutex);
+    return rc;
 }
 
 /**
@@ -1045,6 +1283,8 @@ int tlc_library_status(struct lib_descriptor *lib, json_t **lib_data,
 
     json_array_append_cb = (lib_scan_cb_t)json_array_append;
 
+    MUTEX_LOCK(&lib->mutex);
+
     /* scan arms */
     for (i = 0; i < lib->arms.count ; i++)
         scan_element(&lib->arms.items[i], json_array_append_cb, *lib_data);
@@ -1061,9 +1301,28 @@ int tlc_library_status(struct lib_descriptor *lib, json_t **lib_data,
     for (i = 0; i < lib->drives.count ; i++)
         scan_element(&lib->drives.items[i], json_array_append_cb, *lib_data);
 
+    MUTEX_UNLOCK(&lib->mutex);
     return 0;
 }
 
+static bool lib_fd_is_valid(struct lib_descriptor *lib, int fd_idx)
+{
+    return lib->fd_array[fd_idx] >= 0 && !lib->fd_failed[fd_idx];
+}
+
+/**
+ * Close the lib device \p fd_idx if it failed and no move is using it anymore.
+ */
+static void lib_fd_close_failed(struct lib_descriptor *lib, int fd_idx)
+{
+    if (!lib->fd_failed[fd_idx] || lib->fd_users[fd_idx] > 0 ||
+        lib->fd_array[fd_idx] < 0)
+        return;
+
+    close(lib->fd_array[fd_idx]);
+    lib->fd_array[fd_idx] = -1;
+}
+
 static int update_curr_fd(struct lib_descriptor *lib)
 {
     int nb_try = 1;
@@ -1071,13 +1330,14 @@ static int update_curr_fd(struct lib_descriptor *lib)
      /* Always move to next FD, even if current is valid */
     lib->curr_fd_idx = (lib->curr_fd_idx + 1) % lib->nb_lib_device;
 
-    while (lib->fd_array[lib->curr_fd_idx] == -1 &&
+    while (!lib_fd_is_valid(lib, lib->curr_fd_idx) &&
            nb_try != lib->nb_lib_device) {
         lib->curr_fd_idx = (lib->curr_fd_idx + 1) % lib->nb_lib_device;
         nb_try++;
     }
 
-    lib->fd = lib->fd_array[lib->curr_fd_idx];
+    lib->fd = lib_fd_is_valid(lib, lib->curr_fd_idx) ?
+        lib->fd_array[lib->curr_fd_idx] : -1;
 
     /* If lib->fd == -1, it means that all fd have been tried and are all
      * invalid.
@@ -1085,8 +1345,12 @@ static int update_curr_fd(struct lib_descriptor *lib)
     return lib->fd == -1 ? -1 : 0;
 }
 
-void tlc_library_retry_func(const char *fnname, int rc, int *retry_cnt,
-                            struct lib_descriptor *lib)
+/**
+ * Retry function of the calls to the lib device \p fd_idx. A failed lib device
+ * is closed once the moves using it are over.
+ */
+static void lib_retry(const char *fnname, int rc, int *retry_cnt,
+                      struct lib_descriptor *lib, int fd_idx)
 {
     int rc2;
 
@@ -1096,16 +1360,26 @@ void tlc_library_retry_func(const char *fnname, int rc, int *retry_cnt,
         return;
     }
 
+    if (fd_idx != lib->curr_fd_idx) {
+        /* another call failed on this lib device during the move, and already
+         * switched to the next one
+         */
+        if (lib->curr_fd_idx == -1) {
+            *retry_cnt = -1;
+            return;
+        }
+
+        goto count_retry;
+    }
+
     /* Check if the lib device is still valid */
     rc2 = scsi_inquiry(lib->fd);
     if (rc2) {
         pho_error(-errno, "Inquiry check for '%s' failed",
-                  lib->lib_devices[lib->curr_fd_idx]);
+                  lib->lib_devices[fd_idx]);
 
-        if (lib->fd_array[lib->curr_fd_idx] >= 0)
-            close(lib->fd_array[lib->curr_fd_idx]);
-
-        lib->fd_array[lib->curr_fd_idx] = -1;
+        lib->fd_failed[fd_idx] = true;
+        lib_fd_close_failed(lib, fd_idx);
     }
 
     rc2 = update_curr_fd(lib);
@@ -1117,6 +1391,8 @@ void tlc_library_retry_func(const char *fnname, int rc, int *retry_cnt,
         return;
     }
 
+count_retry:
+
     (*retry_cnt)--;
     if ((*retry_cnt) == 0) {
         *retry_cnt = -1;
@@ -1129,3 +1405,9 @@ void tlc_library_retry_func(const char *fnname, int rc, int *retry_cnt,
     pho_error(rc, "%s failed: retry with another lib device: %s",
               fnname, lib->lib_devices[lib->curr_fd_idx]);
 }
+
+void tlc_library_retry_func(const char *fnname, int rc, int *retry_cnt,
+                            struct lib_descriptor *lib)
+{
+    lib_retry(fnname, rc, retry_cnt, lib, lib->curr_fd_idx);
+}
@@ -26,6 +26,9 @@
 #ifndef _PHO_TLC_LIBRARY_H
 #define _PHO_TLC_LIBRARY_H
 
+#include <glib.h>
+#include <pthread.h>
+
 #include "pho_dss.h"
 #include "pho_ldm.h"
 #include "scsi_api.h"
@@ -57,6 +60,14 @@ struct lib_descriptor {
      * A value of -1 means that all the file descriptor are invalid
      */
     int curr_fd_idx;
+    /* Number of ongoing moves using each file descriptor of fd_array, which
+     * is only closed once its moves are over
+     */
+    int *fd_users;
+    /* Whether each file descriptor of fd_array failed, it cannot be used
+     * anymore and is closed by its last move
+     */
+    bool *fd_failed;
 
     /* Cache of library element address */
     struct mode_sense_info msi;
@@ -68,8 +79,25 @@ struct lib_descriptor {
     struct status_array impexp;
     struct status_array drives;
 
+    /* Indexes of the element status cache, pointing to the elements above */
+    GHashTable *by_label;       /* full elements by volume label */
+    GHashTable *by_serial;      /* drives by serial number */
+    GHashTable *by_address;     /* elements by address */
+    GSequence *free_slots;      /* empty slots ordered by address */
+
     /* Number of lib device to try before exiting as error */
     int max_device_retry;
+
+    /* Protects the fields above against concurrent moves and lookups, it is
+     * released during the SCSI moves
+     */
+    pthread_mutex_t mutex;
+    /* Signaled at the end of each move */
+    pthread_cond_t move_done;
+    /* Addresses (uint16_t) of the elements reserved by the ongoing moves */
+    GArray *busy_addrs;
+    /* Number of ongoing moves */
+    int n_moves;
 };
 
 /**
@@ -88,7 +116,7 @@ struct lib_descriptor {
 int tlc_library_open(struct lib_descriptor *lib, json_t **json_message);
 
 /**
- * Close and clean the library
+ * Close and clean the library, no move must be ongoing
  *
  * @param[in,out]   lib     Library to close and clean
  */
@@ -116,8 +144,14 @@ int tlc_library_drive_lookup(struct lib_descriptor *lib,
 /**
  * Load a medium into a drive
  *
+ * The drive and the element holding the medium are reserved during the move:
+ * if another move uses one of them, the load waits for it to end. The library
+ * is not locked during the move, so that other moves and lookups are processed
+ * meanwhile.
+ *
  * @param[in]   dss             DSS handle.
  * @param[in]   lib             Library descriptor.
+ * @param[in]   arm             Address of the transport element to use.
  * @param[in]   drive_serial    Serial number of the target drive.
  * @param[in]   tape_label      Label of the target tape.
  * @param[out]  json_message    Set to NULL, if no message. On error or success,
@@ -128,16 +162,19 @@ int tlc_library_drive_lookup(struct lib_descriptor *lib,
  * @return 0 on success, negative error code on failure.
  */
 int tlc_library_load(struct dss_handle *dss, struct lib_descriptor *lib,
-                     const char *drive_serial, const char *tape_label,
-                     json_t **json_message);
+                     uint16_t arm, const char *drive_serial,
+                     const char *tape_label, json_t **json_message);
 
 /**
  * Unload a tape from a drive to a free slot
  *
  * If the source address is set and conforms to a free slot, we use it at
- * unload_addr otherwise we use any existing free slot.
+ * unload_addr otherwise we use any existing free slot. The drive and the slot
+ * are reserved during the move, as for tlc_library_load.
  *
+ * @param[in]  dss              DSS handle.
  * @param[in]  lib              Library descriptor.
+ * @param[in]  arm              Address of the transport element to use.
  * @param[in]  drive_serial     Serial number of the target drive.
  * @param[in]  loaded_tape_label    If not NULL, drive is unloaded only if the
  *                                  loaded tape has this label
@@ -154,7 +191,8 @@ int tlc_library_load(struct dss_handle *dss, struct lib_descriptor *lib,
  * @return 0 on success, negative error code on failure.
  */
 int tlc_library_unload(struct dss_handle *dss, struct lib_descriptor *lib,
-                       const char *drive_serial, const char *loaded_tape_label,
+                       uint16_t arm, const char *drive_serial,
+                       const char *loaded_tape_label,
                        char **unloaded_tape_label,
                        struct lib_item_addr *unload_addr,
                        json_t **json_message);
@@ -177,7 +215,7 @@ int tlc_library_status(struct lib_descriptor *lib, json_t **lib_data,
                        json_t **json_message);
 
 /**
- * Refresh the library descriptor
+ * Refresh the library descriptor, once the ongoing moves are over
  *
  * @param[in,out]   lib             Library descriptor.
  * @param[out]      json_message    Set to NULL, if no message. On error or
@@ -205,4 +243,13 @@ media_element_status_from_label(struct lib_descriptor *lib,
 void tlc_library_retry_func(const char *fnname, int rc, int *retry_cnt,
                             struct lib_descriptor *lib);
 
+void lib_index_build(struct lib_descriptor *lib);
+
+struct element_status *get_free_slot(struct lib_descriptor *lib,
+                                     struct element_status *drive);
+
+void move_tape_between_element_status(struct lib_descriptor *lib,
+                                      struct element_status *source,
+                                      struct element_status *destination);
+
 #endif /* _PHO_TLC_LIBRARY_H */
@@ -114,6 +114,7 @@ int main(int argc, char **argv)
         // FIXME I don't think put supports multiple files...
         fprintf(stderr, "usage: %s put [<size>] <file> <...>\n", argv[0]);
         fprintf(stderr, "       %s mput <file> <...>\n", argv[0]);
+        fprintf(stderr, "       %s aput <file> <...>\n", argv[0]);
         fprintf(stderr, "       %s tag-put <file> <tag> <...>\n", argv[0]);
         fprintf(stderr, "       %s get <id> <dest>\n", argv[0]);
         fprintf(stderr, "       %s list <id>\n", argv[0]);
@@ -204,6 +205,86 @@ out_free_mput:
         free(xfer);
         goto out_attrs;
 
+    } else if (!strcmp(argv[1], "aput")) {
+        struct pho_xfer_desc **completed;
+        struct phobos_async *async;
+        struct pho_xfer_desc *xfer;
+        int xfer_cnt = argc - 2;
+        int n_completed = 0;
+        int j;
+
+        xfer = xcalloc(xfer_cnt, sizeof(*xfer));
+        completed = xcalloc(xfer_cnt, sizeof(*completed));
+
+        rc = phobos_async_init(&async);
+        if (rc) {
+            pho_error(rc, "APUT init failed");
+            j = 0;
+            goto out_free_aput;
+        }
+
+        /* one submission per file, all in flight at once */
+        for (i = 2, j = 0; i < argc; i++, j++) {
+            char *path = realpath(argv[i], NULL);
+
+            if (path == NULL) {
+                rc = -errno;
+                goto out_fini_aput;
+            }
+            xfer[j].xd_targets = xcalloc(1, sizeof(*xfer[j].xd_targets));
+            rc = xfer_desc_open_path(xfer + j, argv[i], PHO_XFER_OP_PUT, 0);
+            if (rc < 0) {
+                free(path);
+                goto out_fini_aput;
+            }
+
+            xfer[j].xd_params.put.family = PHO_RSC_INVAL;
+            xfer[j].xd_targets->xt_objid = concat(path, "_aput");
+            xfer[j].xd_targets->xt_attrs = attrs;
+            free(path);
+
+            rc = phobos_put_async(async, xfer + j, 1);
+            if (rc) {
+                pho_error(rc, "APUT submission of '%s' failed", argv[i]);
+                j++;
+                goto out_fini_aput;
+            }
+        }
+
+        while (n_completed < xfer_cnt) {
+            int n = phobos_async_poll(async, -1, completed + n_completed,
+                                      xfer_cnt - n_completed);
+
+            if (n < 0) {
+                rc = n;
+                pho_error(rc, "APUT poll failed");
+                goto out_fini_aput;
+            }
+            n_completed += n;
+        }
+        assert(phobos_async_inflight(async) == 0);
+
+        for (i = 0; i < n_completed; i++) {
+            if (completed[i]->xd_rc) {
+                rc = completed[i]->xd_rc;
+                pho_error(rc, "APUT of '%s' failed",
+                          completed[i]->xd_targets->xt_objid);
+            }
+        }
+
+out_fini_aput:
+        phobos_async_fini(async);
+out_free_aput:
+        for (j--; j >= 0; j--) {
+            xfer_close_fd(xfer[j].xd_targets);
+            free(xfer[j].xd_targets->xt_objid);
+            free(xfer[j].xd_targets->xt_objuuid);
+            free(xfer[j].xd_targets);
+        }
+        free(completed);
+        free(xfer);
+        goto out_attrs;
+
     } else if (!strcmp(argv[1], "tag-put")) {
         struct pho_xfer_target target = {0};
         struct pho_xfer_desc xfer = {0};
@@ -435,6 +435,84 @@ function test_put_get_split()
     rm "$out" "$file"
 }
 
+function check_get_range()
+{
+    local oid=$1
+    local file=$2
+    local offset=$3
+    local length=$4
+    local out=/tmp/out.$$
+
+    $valg_phobos get --offset $offset --length $length $oid "$out" ||
+        error "Ranged get of $oid at $offset for $length bytes failed"
+    tail -c +$((offset + 1)) "$file" | head -c $length | cmp - "$out" ||
+        error "Ranged get of $oid at $offset for $length bytes differs"
+    rm "$out"
+}
+
+function test_get_range()
+{
+    local oid=$FUNCNAME
+    local file=$(make_file 512K)
+    local family=$PHOBOS_STORE_default_family
+    local size=$(stat -c %s "$file")
+
+    $valg_phobos put "$file" $oid
+
+    check_get_range $oid "$file" 0 1
+    check_get_range $oid "$file" 1000 100000
+    check_get_range $oid "$file" $((size - 10)) 10
+    # the range is cut at the end of the object
+    check_get_range $oid "$file" $((size / 2)) $size
+
+    $valg_phobos get --offset $size $oid /tmp/out.$$ &&
+        error "Ranged get after the end of the object should have failed"
+
+    for d in $($phobos $family list); do
+        $phobos $family lock $d
+        check_get_range $oid "$file" 4097 200000
+        $phobos $family unlock $d
+    done
+
+    rm "$file"
+}
+
+function test_get_range_split()
+{
+    local file=$(make_file 2740KB)
+    local oid=$FUNCNAME
+    local size=$(stat -c %s "$file")
+
+    $valg_phobos put "$file" $oid
+    check_extent_count "$oid" 6
+
+    # within the second split, then across the two splits
+    check_get_range $oid "$file" $((size - 1000)) 500
+    check_get_range $oid "$file" 1000 $((size - 2000))
+    rm "$file"
+}
+
+function test_get_split_concurrent()
+{
+    local file=$(make_file 2740KB)
+    local oid=$FUNCNAME
+    local out=/tmp/out.$$
+    local size=$(stat -c %s "$file")
+
+    $valg_phobos put "$file" $oid
+    check_extent_count "$oid" 6
+
+    # the two splits are read at the same time
+    export PHOBOS_STORE_max_drives_per_get=16
+    $valg_phobos get $oid "$out"
+    diff "$out" "$file"
+    rm "$out"
+
+    check_get_range $oid "$file" 1000 $((size - 2000))
+    unset PHOBOS_STORE_max_drives_per_get
+    rm "$file"
+}
+
 function test_put_get_split_different_block_size()
 {
     local file=$(make_file 2640KB)
@@ -744,9 +822,12 @@ TESTS=(
      test_put_get_without_xxh128; \
      test_read_with_missing_extent_corrupted; \
      test_put_get_without_check_hash; \
+     test_get_range; \
      cleanup_dir"
     "setup_dir_split even; \
      test_put_get_split; \
+     test_get_range_split; \
+     test_get_split_concurrent; \
      cleanup_dir_split"
     "setup_dir_split even; \
      test_put_get_split_different_block_size; \
@@ -765,9 +846,12 @@ TESTS=(
      test_put_get_without_xxh128; \
      test_read_with_missing_extent_corrupted; \
      test_put_get_without_check_hash; \
+     test_get_range; \
      cleanup_dir"
     "setup_dir_split odd; \
      test_put_get_split; \
+     test_get_range_split; \
+     test_get_split_concurrent; \
      cleanup_dir_split"
     "setup_dir_split odd; \
      test_put_get_split_different_block_size; \
@@ -0,0 +1,230 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Micro-benchmark of the pipelined data path
+ *
+ * Usage: bench_data_pipeline [object_size_MiB [n_extents [source_MBps
+ *                            [drive_MBps]]]]
+ *
+ * Moves an object from a simulated source to n_extents simulated drives, each
+ * extent receiving the whole object and its hash like raid1 replicas, first
+ * sequentially then with 2, 4 and 8 pipeline buffers. The simulated devices
+ * sleep to match their throughput, the hashes are really computed.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pho_common.h"
+#include "pho_io.h"
+#include "pho_layout.h"
+#include "data_pipeline.h"
+#include "raid_common.h"
+
+#define MIB (1024 * 1024)
+#define BUFFER_SIZE (MIB)
+
+#define DEFAULT_OBJECT_SIZE_MIB 256
+#define DEFAULT_N_EXTENTS       2
+#define DEFAULT_SOURCE_MBPS     1000
+#define DEFAULT_DRIVE_MBPS      400
+
+static double source_mbps = DEFAULT_SOURCE_MBPS;
+static double drive_mbps = DEFAULT_DRIVE_MBPS;
+
+static double elapsed_sec(const struct timespec *start,
+                          const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) +
+           (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void simulate_transfer(size_t size, double mbps)
+{
+    double seconds = size / (mbps * 1e6);
+    struct timespec delay = {
+        .tv_sec = seconds,
+        .tv_nsec = (seconds - (time_t)seconds) * 1e9,
+    };
+
+    nanosleep(&delay, NULL);
+}
+
+static ssize_t bench_source_read(struct pho_io_descr *iod, void *buf,
+                                 size_t count)
+{
+    (void) iod;
+
+    memset(buf, count, count);
+    simulate_transfer(count, source_mbps);
+
+    return count;
+}
+
+static int bench_drive_write(struct pho_io_descr *iod, const void *buf,
+                             size_t count)
+{
+    (void) iod;
+    (void) buf;
+
+    simulate_transfer(count, drive_mbps);
+
+    return 0;
+}
+
+static const struct pho_io_adapter_module_ops BENCH_IOA_OPS = {
+    .ioa_write = bench_drive_write,
+    .ioa_read = bench_source_read,
+};
+
+static struct io_adapter_module bench_ioa = {
+    .ops = &BENCH_IOA_OPS,
+};
+
+static int run(size_t object_size, size_t n_extents, size_t n_buffers,
+               double *seconds)
+{
+    struct pho_xfer_target target = {0};
+    struct pho_xfer_desc xfer = {0};
+    struct pho_data_processor proc = {0};
+    struct pho_io_descr source = {0};
+    struct extent_hash *hashes;
+    struct pho_io_descr *iods;
+    struct timespec start, end;
+    int rc = 0;
+    size_t i;
+
+    xfer.xd_targets = &target;
+    xfer.xd_ntargets = 1;
+    proc.xfer = &xfer;
+    proc.object_size = object_size;
+    proc.pipeline_buffers = n_buffers;
+    pho_buff_alloc(&proc.buff, BUFFER_SIZE);
+
+    source.iod_ioa = &bench_ioa;
+    iods = xcalloc(n_extents, sizeof(*iods));
+    hashes = xcalloc(n_extents, sizeof(*hashes));
+    for (i = 0; i < n_extents; i++) {
+        iods[i].iod_ioa = &bench_ioa;
+        rc = extent_hash_init(&hashes[i], true, true);
+        if (!rc)
+            rc = extent_hash_reset(&hashes[i]);
+        if (rc)
+            goto out;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (proc.writer_offset < object_size) {
+        size_t size = min(object_size - proc.reader_offset, proc.buff.size);
+
+        if (data_pipeline_enabled(&proc))
+            rc = data_pipeline_read(&proc, &source, size);
+        else
+            rc = data_processor_read_into_buff(&proc, &source, size);
+        if (rc)
+            goto out;
+
+        for (i = 0; i < n_extents; i++) {
+            rc = raid_write_chunk(&proc, i, &iods[i], proc.buff.buff, size,
+                                  &hashes[i]);
+            if (rc)
+                goto out;
+        }
+
+        rc = data_pipeline_wait(&proc);
+        if (rc)
+            goto out;
+
+        proc.writer_offset += size;
+        proc.buffer_offset = proc.writer_offset;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *seconds = elapsed_sec(&start, &end);
+
+out:
+    data_pipeline_destroy(&proc);
+    for (i = 0; i < n_extents; i++)
+        extent_hash_fini(&hashes[i]);
+    free(hashes);
+    free(iods);
+    pho_buff_free(&proc.buff);
+
+    return rc;
+}
+
+int main(int argc, char **argv)
+{
+    static const size_t N_BUFFERS[] = {0, 2, 4, 8};
+    size_t object_size = DEFAULT_OBJECT_SIZE_MIB;
+    size_t n_extents = DEFAULT_N_EXTENTS;
+    size_t i;
+
+    if (argc > 1)
+        object_size = strtoul(argv[1], NULL, 10);
+    if (argc > 2)
+        n_extents = strtoul(argv[2], NULL, 10);
+    if (argc > 3)
+        source_mbps = strtod(argv[3], NULL);
+    if (argc > 4)
+        drive_mbps = strtod(argv[4], NULL);
+    if (object_size == 0 || n_extents == 0 || source_mbps <= 0 ||
+        drive_mbps <= 0) {
+        fprintf(stderr,
+                "usage: %s [object_size_MiB [n_extents [source_MBps "
+                "[drive_MBps]]]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    object_size *= MIB;
+    printf("object: %zu MiB, extents: %zu, source: %.0f MB/s, "
+           "drives: %.0f MB/s\n", object_size / MIB, n_extents, source_mbps,
+           drive_mbps);
+
+    for (i = 0; i < ARRAY_SIZE(N_BUFFERS); i++) {
+        double seconds;
+        int rc;
+
+        rc = run(object_size, n_extents, N_BUFFERS[i], &seconds);
+        if (rc) {
+            fprintf(stderr, "run with %zu buffers failed: %s\n",
+                    N_BUFFERS[i], strerror(-rc));
+            return EXIT_FAILURE;
+        }
+
+        if (N_BUFFERS[i] > 1)
+            printf("pipelined, %zu buffers %8.2f MB/s\n", N_BUFFERS[i],
+                   object_size / seconds / 1e6);
+        else
+            printf("sequential           %8.2f MB/s\n",
+                   object_size / seconds / 1e6);
+    }
+
+    return EXIT_SUCCESS;
+}
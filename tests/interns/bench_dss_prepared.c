@@ -0,0 +1,250 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Micro-benchmark of the DSS prepared statements
+ *
+ * Usage: bench_dss_prepared [n_queries]
+ *
+ * Runs the hot DSS queries n_queries times each, first as text requests like
+ * the generic DSS path, then as prepared statements, and prints the number of
+ * queries per second of both. The database of the test configuration must be
+ * set up.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "test_setup.h"
+#include "pho_common.h"
+#include "pho_dss.h"
+#include "dss_utils.h"
+
+#define DEFAULT_N_QUERIES 10000
+
+#define BENCH_LOCK_ID   "bench_dss_prepared"
+#define BENCH_HOSTNAME  "bench_host"
+#define BENCH_OWNER     42
+
+/**
+ * Execute one query of a benchmark, as text if \p text is true or as a
+ * prepared statement otherwise.
+ */
+typedef int (*bench_query_fn)(struct dss_handle *dss, bool text);
+
+static double elapsed_sec(const struct timespec *start,
+                          const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) +
+           (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int run_text(struct dss_handle *dss, const char *request,
+                    ExecStatusType tested)
+{
+    PGresult *res;
+    int rc;
+
+    rc = execute(dss->dh_conn, request, &res, tested);
+    PQclear(res);
+
+    return rc;
+}
+
+static int run_prepared(struct dss_handle *dss, enum dss_statement stmt,
+                        const struct dss_param *params, ExecStatusType tested)
+{
+    PGresult *res;
+    int rc;
+
+    rc = execute_prepared(dss, stmt, params, &res, tested);
+    PQclear(res);
+
+    return rc;
+}
+
+static int bench_lock_status(struct dss_handle *dss, bool text)
+{
+    struct dss_param params[2];
+
+    if (text)
+        return run_text(dss,
+                        "SELECT hostname, owner, timestamp, last_locate, "
+                        "is_weak FROM lock WHERE type = 'object'::lock_type "
+                        "AND id = '"BENCH_LOCK_ID"';",
+                        PGRES_TUPLES_OK);
+
+    params[0] = dss_param_str("object");
+    params[1] = dss_param_str(BENCH_LOCK_ID);
+
+    return run_prepared(dss, DSS_LOCK_STATUS_STMT, params, PGRES_TUPLES_OK);
+}
+
+static int bench_lock_unlock(struct dss_handle *dss, bool text)
+{
+    struct dss_param params[6];
+    uint32_t owner_buf;
+    char locate_buf;
+    char weak_buf;
+    int rc;
+
+    if (text) {
+        rc = run_text(dss,
+                      "INSERT INTO lock "
+                      "(type, id, is_weak, owner, hostname, last_locate) "
+                      "VALUES ('object'::lock_type, '"BENCH_LOCK_ID"', FALSE, "
+                      "42, '"BENCH_HOSTNAME"', NULL);",
+                      PGRES_COMMAND_OK);
+        if (rc)
+            return rc;
+
+        return run_text(dss,
+                        "DELETE FROM lock WHERE type = 'object'::lock_type "
+                        "AND id = '"BENCH_LOCK_ID"';",
+                        PGRES_COMMAND_OK);
+    }
+
+    params[0] = dss_param_str("object");
+    params[1] = dss_param_str(BENCH_LOCK_ID);
+    params[2] = dss_param_bool(&weak_buf, false);
+    params[3] = dss_param_int4(&owner_buf, BENCH_OWNER);
+    params[4] = dss_param_str(BENCH_HOSTNAME);
+    params[5] = dss_param_bool(&locate_buf, false);
+
+    rc = run_prepared(dss, DSS_LOCK_STMT, params, PGRES_COMMAND_OK);
+    if (rc)
+        return rc;
+
+    return run_prepared(dss, DSS_UNLOCK_FORCE_STMT, params, PGRES_COMMAND_OK);
+}
+
+static int bench_object_get(struct dss_handle *dss, bool text)
+{
+    struct dss_param param;
+
+    if (text)
+        return run_text(dss,
+                        "SELECT oid, object_uuid, version, user_md, "
+                        "creation_time, _grouping, size FROM object "
+                        "WHERE oid = '"BENCH_LOCK_ID"';",
+                        PGRES_TUPLES_OK);
+
+    param = dss_param_str(BENCH_LOCK_ID);
+
+    return run_prepared(dss, DSS_OBJECT_GET_BY_OID_STMT, &param,
+                        PGRES_TUPLES_OK);
+}
+
+static int bench_medium_get(struct dss_handle *dss, bool text)
+{
+    struct dss_param params[3];
+
+    if (text)
+        return run_text(dss,
+                        "SELECT family, model, media.id, media.library, "
+                        "adm_status, address_type, fs_type, fs_status, "
+                        "fs_label, stats, tags, put, get, delete, groupings "
+                        "FROM media WHERE family = 'dir' AND "
+                        "id = '"BENCH_LOCK_ID"' AND library = 'legacy';",
+                        PGRES_TUPLES_OK);
+
+    params[0] = dss_param_str("dir");
+    params[1] = dss_param_str(BENCH_LOCK_ID);
+    params[2] = dss_param_str("legacy");
+
+    return run_prepared(dss, DSS_MEDIUM_GET_BY_ID_STMT, params,
+                        PGRES_TUPLES_OK);
+}
+
+static int run(struct dss_handle *dss, bench_query_fn query, bool text,
+               size_t n_queries, double *seconds)
+{
+    struct timespec start, end;
+    size_t i;
+    int rc;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < n_queries; i++) {
+        rc = query(dss, text);
+        if (rc)
+            return rc;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *seconds = elapsed_sec(&start, &end);
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct {
+        const char *name;
+        bench_query_fn query;
+        size_t n_statements;
+    } BENCHES[] = {
+        { "lock status", bench_lock_status, 1 },
+        { "lock/unlock", bench_lock_unlock, 2 },
+        { "object get",  bench_object_get,  1 },
+        { "medium get",  bench_medium_get,  1 },
+    };
+    size_t n_queries = DEFAULT_N_QUERIES;
+    struct dss_handle *dss;
+    int rc = 0;
+    size_t i;
+
+    if (argc > 1)
+        n_queries = strtoul(argv[1], NULL, 10);
+    if (n_queries == 0) {
+        fprintf(stderr, "usage: %s [n_queries]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (global_setup_dss((void **)&dss))
+        return EXIT_FAILURE;
+
+    printf("%-12s %12s %12s\n", "query", "text q/s", "prepared q/s");
+    for (i = 0; i < ARRAY_SIZE(BENCHES); i++) {
+        double text_sec;
+        double prep_sec;
+
+        rc = run(dss, BENCHES[i].query, true, n_queries, &text_sec);
+        if (!rc)
+            rc = run(dss, BENCHES[i].query, false, n_queries, &prep_sec);
+        if (rc) {
+            fprintf(stderr, "%s benchmark failed: %s\n", BENCHES[i].name,
+                    strerror(-rc));
+            break;
+        }
+
+        printf("%-12s %12.0f %12.0f\n", BENCHES[i].name,
+               n_queries * BENCHES[i].n_statements / text_sec,
+               n_queries * BENCHES[i].n_statements / prep_sec);
+    }
+
+    global_teardown_dss((void **)&dss);
+
+    return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,216 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Micro-benchmark of the queues between the LRS threads
+ *
+ * Usage: bench_mpsc_queue [pushes_per_producer]
+ *
+ * Pushes elements from 1 to 64 producer threads to a single consumer thread,
+ * which pops them as fast as it can, first through the mutex-protected tsqueue
+ * then through the lock-free mpsc_queue.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pho_common.h"
+#include "pho_mpsc_queue.h"
+#include "pho_type_utils.h"
+
+#define DEFAULT_PUSHES  1000000
+#define MAX_PRODUCERS   64
+
+struct bench_queue {
+    const char *name;
+    int (*init)(void *queue);
+    void (*destroy)(void *queue);
+    void (*push)(void *queue, void *data);
+    void *(*pop)(void *queue);
+};
+
+static int tsq_init(void *queue)
+{
+    return tsqueue_init(queue);
+}
+
+static void tsq_destroy(void *queue)
+{
+    tsqueue_destroy(queue, NULL);
+}
+
+static void tsq_push(void *queue, void *data)
+{
+    tsqueue_push(queue, data);
+}
+
+static void *tsq_pop(void *queue)
+{
+    return tsqueue_pop(queue);
+}
+
+static int mq_init(void *queue)
+{
+    return mpsc_queue_init(queue, MPSC_QUEUE_DEFAULT_CAPACITY);
+}
+
+static void mq_destroy(void *queue)
+{
+    mpsc_queue_destroy(queue, NULL);
+}
+
+static void mq_push(void *queue, void *data)
+{
+    mpsc_queue_push(queue, data);
+}
+
+static void *mq_pop(void *queue)
+{
+    return mpsc_queue_pop(queue);
+}
+
+static const struct bench_queue QUEUES[] = {
+    {"tsqueue", tsq_init, tsq_destroy, tsq_push, tsq_pop},
+    {"mpsc_queue", mq_init, mq_destroy, mq_push, mq_pop},
+};
+
+struct producer {
+    const struct bench_queue *ops;
+    void                     *queue;
+    size_t                    n_pushes;
+};
+
+static double elapsed_sec(const struct timespec *start,
+                          const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) +
+           (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void *producer_thread(void *arg)
+{
+    struct producer *producer = arg;
+    size_t i;
+
+    for (i = 0; i < producer->n_pushes; i++)
+        producer->ops->push(producer->queue, (void *)(uintptr_t)(i + 1));
+
+    return NULL;
+}
+
+static int run(const struct bench_queue *ops, int n_producers,
+               size_t n_pushes, double *seconds)
+{
+    union {
+        struct tsqueue    tsqueue;
+        struct mpsc_queue mpsc_queue;
+    } queue;
+    pthread_t threads[MAX_PRODUCERS];
+    struct producer producer = {
+        .ops = ops,
+        .queue = &queue,
+        .n_pushes = n_pushes,
+    };
+    size_t total = n_producers * n_pushes;
+    struct timespec start;
+    struct timespec end;
+    size_t popped = 0;
+    int rc;
+    int i;
+
+    rc = ops->init(&queue);
+    if (rc)
+        return rc;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < n_producers; i++) {
+        rc = -pthread_create(&threads[i], NULL, producer_thread, &producer);
+        if (rc) {
+            n_producers = i;
+            break;
+        }
+    }
+
+    /* the consumer busy-polls the queue like the scheduler loop does */
+    while (!rc && popped < total)
+        if (ops->pop(&queue))
+            popped++;
+
+    for (i = 0; i < n_producers; i++)
+        pthread_join(threads[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    *seconds = elapsed_sec(&start, &end);
+
+    ops->destroy(&queue);
+
+    return rc;
+}
+
+int main(int argc, char **argv)
+{
+    static const int N_PRODUCERS[] = {1, 2, 4, 8, 16, 32, 64};
+    size_t n_pushes = DEFAULT_PUSHES;
+    size_t i;
+
+    if (argc > 1)
+        n_pushes = strtoul(argv[1], NULL, 10);
+    if (n_pushes == 0) {
+        fprintf(stderr, "usage: %s [pushes_per_producer]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    printf("pushes per producer: %zu\n", n_pushes);
+    printf("producers %14s %14s\n", QUEUES[0].name, QUEUES[1].name);
+
+    for (i = 0; i < ARRAY_SIZE(N_PRODUCERS); i++) {
+        double ops_per_sec[ARRAY_SIZE(QUEUES)];
+        size_t j;
+
+        for (j = 0; j < ARRAY_SIZE(QUEUES); j++) {
+            double seconds;
+            int rc;
+
+            rc = run(&QUEUES[j], N_PRODUCERS[i], n_pushes, &seconds);
+            if (rc) {
+                fprintf(stderr, "%s with %d producers failed: %s\n",
+                        QUEUES[j].name, N_PRODUCERS[i], strerror(-rc));
+                return EXIT_FAILURE;
+            }
+
+            ops_per_sec[j] = N_PRODUCERS[i] * n_pushes / seconds;
+        }
+
+        printf("%9d %10.2f M/s %10.2f M/s\n", N_PRODUCERS[i],
+               ops_per_sec[0] / 1e6, ops_per_sec[1] / 1e6);
+    }
+
+    return EXIT_SUCCESS;
+}
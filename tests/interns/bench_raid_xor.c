@@ -0,0 +1,145 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Micro-benchmark of the RAID parity kernels
+ *
+ * Usage: bench_raid_xor [buffer_size_bytes [iterations]]
+ *
+ * Prints the XOR throughput of every kernel supported by the running CPU, in
+ * GB/s of parity produced, plus the throughput of the fused "XOR + hash"
+ * kernel for the selected implementation.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pho_common.h"
+#include "raid_common.h"
+#include "raid_xor.h"
+
+#define DEFAULT_BUFFER_SIZE (4 * 1024 * 1024)
+#define DEFAULT_ITERATIONS  256
+
+static double elapsed_sec(const struct timespec *start,
+                          const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) +
+           (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static double gb_per_sec(size_t size, size_t iterations, double seconds)
+{
+    return seconds > 0 ? (double)size * iterations / seconds / 1e9 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    size_t size = DEFAULT_BUFFER_SIZE;
+    size_t iterations = DEFAULT_ITERATIONS;
+    const struct raid_xor_kernel *kernels;
+    struct extent_hash hash = {0};
+    struct timespec start, end;
+    size_t n_kernels;
+    char *parity;
+    char *data;
+    size_t i, k;
+    int rc;
+
+    if (argc > 1)
+        size = strtoul(argv[1], NULL, 10);
+    if (argc > 2)
+        iterations = strtoul(argv[2], NULL, 10);
+    if (size == 0 || iterations == 0) {
+        fprintf(stderr, "usage: %s [buffer_size_bytes [iterations]]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    data = xmalloc(size);
+    parity = xmalloc(size);
+    for (i = 0; i < size; i++) {
+        data[i] = rand();
+        parity[i] = rand();
+    }
+
+    printf("buffer size: %zu bytes, iterations: %zu, selected kernel: %s\n",
+           size, iterations, raid_xor_kernel()->name);
+
+    kernels = raid_xor_kernels(&n_kernels);
+    for (k = 0; k < n_kernels; k++) {
+        if (!kernels[k].supported()) {
+            printf("%-10s unsupported\n", kernels[k].name);
+            continue;
+        }
+
+        /* warm up */
+        kernels[k].xor_in_place(data, parity, size);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (i = 0; i < iterations; i++)
+            kernels[k].xor_in_place(data, parity, size);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        printf("%-10s %8.2f GB/s\n", kernels[k].name,
+               gb_per_sec(size, iterations, elapsed_sec(&start, &end)));
+    }
+
+    rc = extent_hash_init(&hash, true, true);
+    if (!rc)
+        rc = extent_hash_reset(&hash);
+    if (rc) {
+        fprintf(stderr, "unable to initialize hash: %s\n", strerror(-rc));
+        return EXIT_FAILURE;
+    }
+
+    /* two passes: XOR then hash */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        raid_xor_in_place(data, parity, size);
+        extent_hash_update(&hash, parity, size);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("%-10s %8.2f GB/s\n", "xor+hash",
+           gb_per_sec(size, iterations, elapsed_sec(&start, &end)));
+
+    /* fused */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++)
+        raid_xor_in_place_hash(data, parity, size, &hash);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("%-10s %8.2f GB/s\n", "fused",
+           gb_per_sec(size, iterations, elapsed_sec(&start, &end)));
+
+    extent_hash_fini(&hash);
+    free(data);
+    free(parity);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,1097 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Replay of a LRS request trace against the I/O schedulers
+ *
+ * Usage: bench_sched_replay <trace> [n_drives [load_factor [n_empty_tapes]]]
+ *
+ * Feeds the tape requests of a trace recorded with the "trace_file" parameter
+ * of the [lrs] section to the I/O schedulers of the configuration, on a
+ * modelled LTO6 library of n_drives drives, in virtual time. The arrival dates
+ * of the trace are divided by load_factor to increase the load. The media of
+ * the trace are half full, those formatted by the trace are blank, and
+ * n_empty_tapes empty media are added for the writes.
+ *
+ * The configuration is read from ../phobos.conf, and the algorithms are chosen
+ * as for phobosd, e.g. with PHOBOS_IO_SCHED_TAPE_read_algo=grouped_read. The
+ * requests are allocated by lrs_schedule_work, whose sub-requests are handed to
+ * the modelled drives instead of the device threads. The number of mounts,
+ * unmounts and locates, the queue wait percentiles, the utilisation of the
+ * drives and the throughput are printed. No database is needed: the media are
+ * served by the DSS functions below and are all locked by the replay.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <jansson.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pho_cfg.h"
+#include "pho_common.h"
+#include "pho_dss.h"
+#include "pho_dss_wrapper.h"
+#include "pho_mpsc_queue.h"
+#include "pho_srl_lrs.h"
+#include "pho_type_utils.h"
+
+#include "io_sched.h"
+#include "lrs_cache.h"
+#include "lrs_device.h"
+#include "lrs_sched.h"
+#include "lrs_trace.h"
+#include "lrs_utils.h"
+
+#define DEFAULT_N_DRIVES        4
+#define DEFAULT_LOAD_FACTOR     1.0
+#define DEFAULT_N_EMPTY_TAPES   4
+
+/* LTO6 model, as the defaults of the [tape_sim] section */
+#define DRIVE_MODEL             "ULTRIUM-TD6"
+#define TAPE_MODEL              "LTO6"
+#define MOUNT_SEC               23.0
+#define UNMOUNT_SEC             28.0
+#define LOCATE_MIN_SEC          1.0
+#define LOCATE_FULL_SEC         90.0
+#define FORMAT_SEC              60.0
+#define BANDWIDTH               160e6
+#define CAPACITY                2500000000000ULL
+/* read sizes are unknown at allocation, a fixed size is read per medium */
+#define READ_SIZE               (256ULL << 20)
+/* used fraction of the media read by the trace */
+#define USED_FRACTION           0.5
+
+#define SIM_LIBRARY             "legacy"
+
+bool running = true;
+
+/** A medium of the replay */
+struct sim_medium {
+    size_t index;           /**< index in the fake DSS */
+    bool blank;             /**< formatted by the trace */
+    GArray *positions;      /**< sorted positions of the extents read */
+    uint64_t used;          /**< used space before the replay */
+};
+
+/** A request of the trace */
+struct replay_request {
+    struct lrs_trace_entry entry;
+    double arrival;             /**< virtual arrival date */
+    double start;               /**< virtual allocation date */
+    double end;                 /**< virtual completion date */
+    size_t n_pending;           /**< sub-requests still on drives */
+    struct req_container *reqc; /**< container while it is scheduled */
+    bool failed;
+    bool done;
+};
+
+/** A modelled drive */
+struct sim_drive {
+    struct lrs_dev dev;
+    char path[32];
+    double busy_until;          /**< virtual end of the ongoing operation */
+    double busy_time;           /**< time spent on operations */
+    uint64_t head;              /**< position of the head on the medium */
+    struct replay_request *request; /**< request of the ongoing operation */
+    uint64_t size;              /**< size of the ongoing transfer */
+};
+
+struct replay {
+    struct lrs_sched sched;
+    struct mpsc_queue response_queue;
+    struct sim_drive *drives;
+    size_t n_drives;
+    struct replay_request *requests;
+    size_t n_requests;
+    size_t next_arrival;
+    double now;                 /**< virtual date of the scheduling */
+    size_t n_pushed;            /**< sub-requests handed to the drives */
+    /* statistics */
+    size_t n_mounts;
+    size_t n_unmounts;
+    size_t n_locates;
+    double locate_time;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    double makespan;
+};
+
+/* media of the replay, by name, and their fake DSS entries */
+static GHashTable *sim_media;
+static struct media_info *dss_media;
+static size_t n_dss_media;
+
+int dss_init(struct dss_handle *handle)
+{
+    (void) handle;
+
+    return 0;
+}
+
+void dss_fini(struct dss_handle *handle)
+{
+    (void) handle;
+}
+
+int dss_media_get(struct dss_handle *hdl, const struct dss_filter *filter,
+                  struct media_info **med_ls, int *med_cnt,
+                  struct dss_sort *sort)
+{
+    json_t *value;
+    size_t index;
+    json_t *and;
+
+    (void) hdl;
+    (void) sort;
+
+    /* a medium by id, or all the media of the family */
+    and = json_object_get(filter->df_json, "$AND");
+    json_array_foreach(and, index, value) {
+        struct sim_medium *medium;
+        json_t *id;
+
+        id = json_object_get(value, "DSS::MDA::id");
+        if (!id || !json_is_string(id))
+            continue;
+
+        medium = g_hash_table_lookup(sim_media, json_string_value(id));
+        *med_ls = medium ? &dss_media[medium->index] : NULL;
+        *med_cnt = medium ? 1 : 0;
+
+        return 0;
+    }
+
+    *med_ls = dss_media;
+    *med_cnt = n_dss_media;
+
+    return 0;
+}
+
+int dss_one_medium_get_from_id(struct dss_handle *dss,
+                               const struct pho_id *medium_id,
+                               struct media_info **medium_info)
+{
+    struct sim_medium *medium;
+
+    (void) dss;
+
+    medium = g_hash_table_lookup(sim_media, medium_id->name);
+    if (!medium)
+        return -ENOENT;
+
+    *medium_info = &dss_media[medium->index];
+
+    return 0;
+}
+
+int dss_medium_health(struct dss_handle *dss, const struct pho_id *medium_id,
+                      size_t max_health, size_t *health)
+{
+    (void) dss;
+    (void) medium_id;
+    (void) max_health;
+
+    *health = 1;
+    return 0;
+}
+
+int dss_lock_status(struct dss_handle *handle, enum dss_type type,
+                    const void *item_list, int item_cnt,
+                    struct pho_lock *locks)
+{
+    int i;
+
+    (void) handle;
+    (void) type;
+    (void) item_list;
+
+    /* the replay is the only user of its library */
+    for (i = 0; i < item_cnt; i++) {
+        locks[i].hostname = xstrdup(get_hostname());
+        locks[i].owner = getpid();
+    }
+
+    return 0;
+}
+
+void dss_res_free(void *item_list, int item_cnt)
+{
+    (void) item_list;
+    (void) item_cnt;
+}
+
+static double timespec2sec(const struct timespec *ts)
+{
+    return ts->tv_sec + ts->tv_nsec / 1e9;
+}
+
+static struct timespec sec2timespec(double sec)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)sec;
+    ts.tv_nsec = (long)((sec - ts.tv_sec) * 1e9);
+
+    return ts;
+}
+
+static gint cmp_uint64(gconstpointer a, gconstpointer b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static gint cmp_double(gconstpointer a, gconstpointer b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static gint cmp_arrival(gconstpointer a, gconstpointer b)
+{
+    const struct replay_request *x = a;
+    const struct replay_request *y = b;
+
+    return cmp_double(&x->arrival, &y->arrival);
+}
+
+static void sim_medium_free(gpointer data)
+{
+    struct sim_medium *medium = data;
+
+    g_array_free(medium->positions, TRUE);
+    free(medium);
+}
+
+static struct sim_medium *sim_medium_get(const char *name, bool blank)
+{
+    struct sim_medium *medium;
+
+    medium = g_hash_table_lookup(sim_media, name);
+    if (medium)
+        return medium;
+
+    medium = xcalloc(1, sizeof(*medium));
+    medium->index = g_hash_table_size(sim_media);
+    medium->blank = blank;
+    medium->positions = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+    medium->used = blank ? 0 : CAPACITY * USED_FRACTION;
+    g_hash_table_insert(sim_media, xstrdup(name), medium);
+
+    return medium;
+}
+
+static int load_trace(struct replay *replay, const char *path,
+                      double load_factor)
+{
+    GArray *requests = g_array_new(FALSE, TRUE, sizeof(*replay->requests));
+    size_t n_skipped = 0;
+    double first = -1;
+    size_t line_no = 0;
+    char *line = NULL;
+    size_t len = 0;
+    FILE *trace;
+    int rc = 0;
+
+    trace = fopen(path, "r");
+    if (!trace)
+        LOG_RETURN(-errno, "Cannot open the trace '%s'", path);
+
+    while (getline(&line, &len, trace) != -1) {
+        struct replay_request request = { 0 };
+        double received_at;
+        size_t i;
+
+        line_no++;
+        if (line[0] == '\n' || line[0] == '#')
+            continue;
+
+        rc = lrs_trace_parse(line, &request.entry);
+        if (rc)
+            LOG_GOTO(out_close, rc, "Invalid line %zu of the trace '%s'",
+                     line_no, path);
+
+        if (request.entry.family != PHO_RSC_TAPE) {
+            lrs_trace_entry_clean(&request.entry);
+            n_skipped++;
+            continue;
+        }
+
+        received_at = timespec2sec(&request.entry.received_at);
+        if (first < 0)
+            first = received_at;
+        request.arrival = (received_at - first) / load_factor;
+
+        for (i = 0; i < request.entry.n_media &&
+                    request.entry.type != IO_REQ_WRITE; i++) {
+            struct sim_medium *medium;
+
+            medium = sim_medium_get(request.entry.media[i],
+                                    request.entry.type == IO_REQ_FORMAT);
+            if (request.entry.positions)
+                g_array_append_val(medium->positions,
+                                   request.entry.positions[i]);
+        }
+
+        g_array_append_val(requests, request);
+    }
+
+    if (n_skipped)
+        printf("%zu requests of other families than tape skipped\n",
+               n_skipped);
+
+    /* the schedulers of several families may share a trace */
+    g_array_sort(requests, cmp_arrival);
+
+out_close:
+    free(line);
+    fclose(trace);
+    replay->n_requests = requests->len;
+    replay->requests = (struct replay_request *)g_array_free(requests, FALSE);
+
+    return rc;
+}
+
+static void init_dss_media(size_t n_empty_tapes)
+{
+    struct sim_medium *medium;
+    GHashTableIter iter;
+    gpointer value;
+    gpointer key;
+    size_t i;
+
+    for (i = 0; i < n_empty_tapes; i++) {
+        char name[32];
+
+        snprintf(name, sizeof(name), "replay%04zu", i);
+        medium = sim_medium_get(name, false);
+        medium->used = 0;
+    }
+
+    n_dss_media = g_hash_table_size(sim_media);
+    dss_media = xcalloc(n_dss_media, sizeof(*dss_media));
+
+    g_hash_table_iter_init(&iter, sim_media);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        struct media_info *info;
+
+        medium = value;
+        info = &dss_media[medium->index];
+
+        info->rsc.id.family = PHO_RSC_TAPE;
+        pho_id_name_set(&info->rsc.id, key, SIM_LIBRARY);
+        info->rsc.model = xstrdup(TAPE_MODEL);
+        info->rsc.adm_status = PHO_RSC_ADM_ST_UNLOCKED;
+        info->addr_type = PHO_ADDR_HASH1;
+        info->fs.type = PHO_FS_LTFS;
+        info->fs.status = medium->blank ? PHO_FS_STATUS_BLANK :
+                          medium->used ? PHO_FS_STATUS_USED :
+                                         PHO_FS_STATUS_EMPTY;
+        info->stats.phys_spc_used = medium->used;
+        info->stats.phys_spc_free = CAPACITY - medium->used;
+        info->flags.put = true;
+        info->flags.get = true;
+        info->flags.delete = true;
+        info->health = 1;
+
+        g_array_sort(medium->positions, cmp_uint64);
+    }
+}
+
+static int init_drives(struct replay *replay)
+{
+    size_t i;
+    int rc;
+
+    replay->drives = xcalloc(replay->n_drives, sizeof(*replay->drives));
+    replay->sched.devices.ldh_devices = g_ptr_array_new();
+
+    for (i = 0; i < replay->n_drives; i++) {
+        struct sim_drive *drive = &replay->drives[i];
+        struct lrs_dev *dev = &drive->dev;
+
+        snprintf(drive->path, sizeof(drive->path), "/dev/replay%zu", i);
+        strcpy(dev->ld_dev_path, drive->path);
+        pthread_mutex_init(&dev->ld_mutex, NULL);
+        dev->ld_op_status = PHO_DEV_OP_ST_EMPTY;
+        dev->ld_device_thread.state = THREAD_RUNNING;
+        dev->ld_sys_dev_state.lds_family = PHO_RSC_TAPE;
+        dev->ld_sync_params.tosync_array = g_ptr_array_new();
+        dev->ld_ongoing_socket_id = -1;
+        dev->ld_ongoing_format = &replay->sched.ongoing_format;
+
+        dev->ld_dss_dev_info = xcalloc(1, sizeof(*dev->ld_dss_dev_info));
+        dev->ld_dss_dev_info->rsc.adm_status = PHO_RSC_ADM_ST_UNLOCKED;
+        dev->ld_dss_dev_info->rsc.model = DRIVE_MODEL;
+        dev->ld_dss_dev_info->rsc.id.family = PHO_RSC_TAPE;
+        pho_id_name_set(&dev->ld_dss_dev_info->rsc.id, drive->path,
+                        SIM_LIBRARY);
+        dev->ld_dss_dev_info->path = drive->path;
+
+        dev_stats_init(dev);
+        g_ptr_array_add(replay->sched.devices.ldh_devices, dev);
+
+        rc = lrs_dev_technology(dev, &dev->ld_technology);
+        if (rc) {
+            /* only clean the drives initialized so far */
+            replay->n_drives = i + 1;
+            LOG_RETURN(rc, "No technology for the drive model '%s'",
+                       DRIVE_MODEL);
+        }
+    }
+
+    return 0;
+}
+
+static void fini_drives(struct replay *replay)
+{
+    size_t i;
+
+    for (i = 0; i < replay->n_drives; i++) {
+        struct lrs_dev *dev = &replay->drives[i].dev;
+
+        lrs_medium_release(dev->ld_dss_media_info);
+        dev_stats_destroy(dev);
+        free(dev->ld_sub_request);
+        free(dev->ld_ongoing_grouping);
+        free((void *)dev->ld_technology);
+        free(dev->ld_dss_dev_info);
+        g_ptr_array_free(dev->ld_sync_params.tosync_array, TRUE);
+        pthread_mutex_destroy(&dev->ld_mutex);
+    }
+
+    g_ptr_array_free(replay->sched.devices.ldh_devices, TRUE);
+    free(replay->drives);
+}
+
+/** Build the request container of a request, as the LRS communication thread
+ * does
+ */
+static struct req_container *build_request(struct replay_request *request,
+                                           uint32_t id)
+{
+    struct lrs_trace_entry *entry = &request->entry;
+    struct rwalloc_params *rwalloc;
+    struct req_container *reqc;
+    size_t *n_tags;
+    pho_req_t *req;
+    size_t i;
+
+    reqc = xcalloc(1, sizeof(*reqc));
+    pthread_mutex_init(&reqc->mutex, NULL);
+    reqc->socket_id = -1;
+    reqc->received_at = sec2timespec(request->arrival);
+    reqc->req = req = xcalloc(1, sizeof(*req));
+
+    switch (entry->type) {
+    case IO_REQ_READ:
+        pho_srl_request_read_alloc(req, entry->n_media);
+        req->ralloc->n_required = entry->n_required;
+        req->ralloc->operation = PHO_READ_TARGET_ALLOC_OP_READ;
+        for (i = 0; i < entry->n_media; i++) {
+            req->ralloc->med_ids[i]->family = PHO_RSC_TAPE;
+            req->ralloc->med_ids[i]->name = xstrdup(entry->media[i]);
+            req->ralloc->med_ids[i]->library = xstrdup(SIM_LIBRARY);
+        }
+        if (entry->positions) {
+            req->ralloc->n_positions = entry->n_media;
+            req->ralloc->positions =
+                xmalloc(entry->n_media * sizeof(*req->ralloc->positions));
+            memcpy(req->ralloc->positions, entry->positions,
+                   entry->n_media * sizeof(*req->ralloc->positions));
+        }
+        break;
+    case IO_REQ_WRITE:
+        n_tags = xcalloc(entry->n_media, sizeof(*n_tags));
+        pho_srl_request_write_alloc(req, entry->n_media, n_tags);
+        free(n_tags);
+        req->walloc->family = PHO_RSC_TAPE;
+        req->walloc->no_split = entry->no_split;
+        if (entry->grouping)
+            req->walloc->grouping = xstrdup(entry->grouping);
+        for (i = 0; i < entry->n_media; i++) {
+            req->walloc->media[i]->size = entry->sizes[i];
+            req->walloc->media[i]->empty_medium = entry->empty_medium[i];
+        }
+        break;
+    case IO_REQ_FORMAT:
+        pho_srl_request_format_alloc(req);
+        req->format->fs = PHO_FS_LTFS;
+        req->format->med_id->family = PHO_RSC_TAPE;
+        req->format->med_id->name = xstrdup(entry->media[0]);
+        req->format->med_id->library = xstrdup(SIM_LIBRARY);
+        break;
+    }
+
+    req->id = id;
+    req->has_qos = true;
+    req->qos = entry->qos;
+    req->has_priority = true;
+    req->priority = entry->priority;
+
+    if (entry->type == IO_REQ_FORMAT)
+        return reqc;
+
+    /* as init_rwalloc_container */
+    rwalloc = &reqc->params.rwalloc;
+    rwalloc->n_media = entry->type == IO_REQ_WRITE ? entry->n_media :
+                                                     entry->n_required;
+    rwalloc->media = xcalloc(rwalloc->n_media, sizeof(*rwalloc->media));
+    for (i = 0; i < rwalloc->n_media; i++)
+        rwalloc->media[i].status = SUB_REQUEST_TODO;
+
+    rwalloc->respc = xcalloc(1, sizeof(*rwalloc->respc));
+    rwalloc->respc->socket_id = reqc->socket_id;
+    rwalloc->respc->received_at = reqc->received_at;
+    rwalloc->respc->resp = xcalloc(1, sizeof(*rwalloc->respc->resp));
+    if (entry->type == IO_REQ_WRITE)
+        pho_srl_response_write_alloc(rwalloc->respc->resp, rwalloc->n_media);
+    else
+        pho_srl_response_read_alloc(rwalloc->respc->resp, rwalloc->n_media);
+
+    rwalloc->respc->resp->req_id = id;
+    rwalloc->respc->devices_len = rwalloc->n_media;
+    rwalloc->respc->devices = xcalloc(rwalloc->n_media,
+                                      sizeof(*rwalloc->respc->devices));
+
+    if (entry->type == IO_REQ_READ)
+        rml_init(&rwalloc->media_list, reqc);
+
+    return reqc;
+}
+
+static bool same_medium(const struct media_info *a, const struct media_info *b)
+{
+    return a && b && pho_id_equal(&a->rsc.id, &b->rsc.id);
+}
+
+/** Time to unload \p medium from the idle drives other than \p drive */
+static double unload_elsewhere(struct replay *replay, struct sim_drive *drive,
+                               const struct media_info *medium)
+{
+    double duration = 0;
+    size_t i;
+
+    for (i = 0; i < replay->n_drives; i++) {
+        struct lrs_dev *dev = &replay->drives[i].dev;
+
+        if (&replay->drives[i] == drive || replay->drives[i].request ||
+            !same_medium(dev->ld_dss_media_info, medium))
+            continue;
+
+        lrs_medium_release(dev->ld_dss_media_info);
+        dev->ld_dss_media_info = NULL;
+        dev->ld_op_status = PHO_DEV_OP_ST_EMPTY;
+        replay->n_unmounts++;
+        duration += UNMOUNT_SEC;
+    }
+
+    return duration;
+}
+
+/** Start an operation on a drive, and return its duration */
+static double drive_start(struct replay *replay, struct sim_drive *drive,
+                          struct media_info *medium, uint64_t offset,
+                          uint64_t size)
+{
+    struct lrs_dev *dev = &drive->dev;
+    double duration = 0;
+    uint64_t distance;
+
+    if (!same_medium(dev->ld_dss_media_info, medium)) {
+        if (dev->ld_dss_media_info) {
+            lrs_medium_release(dev->ld_dss_media_info);
+            replay->n_unmounts++;
+            duration += UNMOUNT_SEC;
+        }
+
+        duration += unload_elsewhere(replay, drive, medium);
+        dev->ld_dss_media_info = lrs_medium_acquire(&medium->rsc.id);
+        dev->ld_op_status = PHO_DEV_OP_ST_MOUNTED;
+        replay->n_mounts++;
+        duration += MOUNT_SEC;
+        drive->head = 0;
+    }
+
+    if (offset != drive->head) {
+        double locate;
+
+        distance = offset > drive->head ? offset - drive->head :
+                                          drive->head - offset;
+        locate = LOCATE_MIN_SEC + LOCATE_FULL_SEC * distance / CAPACITY;
+        replay->n_locates++;
+        replay->locate_time += locate;
+        duration += locate;
+    }
+
+    drive->head = offset + size;
+    drive->size = size;
+
+    return duration + size / BANDWIDTH;
+}
+
+/** Offset on its medium of the extent read by \p request on \p medium */
+static uint64_t read_offset(struct replay_request *request,
+                            const struct media_info *medium)
+{
+    struct lrs_trace_entry *entry = &request->entry;
+    struct sim_medium *sim_medium;
+    uint64_t *positions;
+    size_t rank;
+    size_t i;
+
+    sim_medium = g_hash_table_lookup(sim_media, medium->rsc.id.name);
+    if (!entry->positions || sim_medium->positions->len == 0)
+        return sim_medium->used / 2;
+
+    for (i = 0; i < entry->n_media; i++)
+        if (!strcmp(entry->media[i], medium->rsc.id.name))
+            break;
+
+    /* the positions are creation dates: spread them on the used space */
+    positions = (uint64_t *)sim_medium->positions->data;
+    for (rank = 0; rank < sim_medium->positions->len; rank++)
+        if (positions[rank] >= entry->positions[i])
+            break;
+
+    return sim_medium->used * (rank + 0.5) / sim_medium->positions->len;
+}
+
+
+/** Record the new state of the medium of \p dev in the DSS and the catalog */
+static void medium_update(struct replay *replay, struct lrs_dev *dev,
+                          enum fs_status status, uint64_t written,
+                          const char *grouping)
+{
+    struct media_info *loaded = dev->ld_dss_media_info;
+    struct sim_medium *sim_medium;
+    struct media_info *updated;
+    struct media_info *medium;
+
+    sim_medium = g_hash_table_lookup(sim_media, loaded->rsc.id.name);
+    medium = &dss_media[sim_medium->index];
+
+    medium->fs.status = status;
+    medium->stats.phys_spc_used += written;
+    medium->stats.phys_spc_free -= written;
+    if (medium->stats.phys_spc_free < 0)
+        medium->stats.phys_spc_free = 0;
+    if (grouping && !string_exists(&medium->groupings, grouping))
+        string_array_add(&medium->groupings, grouping);
+
+    lrs_media_catalog_update(&replay->sched.catalog, medium);
+
+    updated = lrs_medium_update(&medium->rsc.id);
+    if (!updated)
+        return;
+
+    dev->ld_dss_media_info = updated;
+    lrs_medium_release(loaded);
+}
+
+/** Start the sub-request set on \p dev by the scheduler, as its device thread
+ * would
+ */
+static void drive_push(struct lrs_dev *dev, void *data)
+{
+    struct sim_drive *drive = container_of(dev, struct sim_drive, dev);
+    struct sub_request *sub_request = dev->ld_sub_request;
+    struct req_container *reqc = sub_request->reqc;
+    size_t i = sub_request->medium_index;
+    struct replay_request *request;
+    struct replay *replay = data;
+    struct sim_medium *sim_medium;
+    struct media_info *medium;
+    double duration;
+
+    request = &replay->requests[reqc->req->id];
+    if (!request->reqc) {
+        request->start = replay->now;
+        request->reqc = reqc;
+        request->n_pending = pho_request_is_format(reqc->req) ? 1 :
+                             reqc->params.rwalloc.respc->devices_len;
+    }
+
+    if (pho_request_is_format(reqc->req)) {
+        medium = reqc->params.format.medium_to_format;
+        duration = drive_start(replay, drive, medium, 0, 0) + FORMAT_SEC;
+    } else if (pho_request_is_read(reqc->req)) {
+        medium = reqc->params.rwalloc.media[i].alloc_medium;
+        duration = drive_start(replay, drive, medium,
+                               read_offset(request, medium), READ_SIZE);
+    } else {
+        /* written at the end of data */
+        medium = reqc->params.rwalloc.media[i].alloc_medium;
+        sim_medium = g_hash_table_lookup(sim_media, medium->rsc.id.name);
+        duration = drive_start(replay, drive, medium,
+                               dss_media[sim_medium->index].stats.phys_spc_used,
+                               reqc->req->walloc->media[i]->size);
+    }
+
+    dev->ld_ongoing_io = true;
+    drive->request = request;
+    drive->busy_until = replay->now + duration;
+    drive->busy_time += duration;
+    replay->n_pushed++;
+}
+
+static void drive_complete(struct replay *replay, struct sim_drive *drive)
+{
+    struct replay_request *request = drive->request;
+    struct req_container *reqc = request->reqc;
+    struct lrs_dev *dev = &drive->dev;
+
+    free(dev->ld_sub_request);
+    dev->ld_sub_request = NULL;
+    dev->ld_ongoing_io = false;
+    drive->request = NULL;
+
+    if (pho_request_is_format(reqc->req)) {
+        format_medium_remove(&replay->sched.ongoing_format,
+                             reqc->params.format.medium_to_format);
+        medium_update(replay, dev, PHO_FS_STATUS_EMPTY, 0, NULL);
+    } else if (pho_request_is_write(reqc->req)) {
+        medium_update(replay, dev, PHO_FS_STATUS_USED, drive->size,
+                      reqc->req->walloc->grouping);
+        replay->bytes_written += drive->size;
+    } else {
+        replay->bytes_read += drive->size;
+    }
+
+    if (drive->busy_until > replay->makespan)
+        replay->makespan = drive->busy_until;
+
+    if (--request->n_pending > 0)
+        return;
+
+    request->end = drive->busy_until;
+    request->done = true;
+    request->reqc = NULL;
+    sched_req_free(reqc);
+}
+
+/** Record the requests cancelled by the schedulers */
+static size_t drain_responses(struct replay *replay, double now)
+{
+    struct resp_container *respc;
+    size_t n_responses = 0;
+
+    while ((respc = mpsc_queue_pop(&replay->response_queue)) != NULL) {
+        struct replay_request *request = &replay->requests[respc->resp->req_id];
+
+        request->failed = true;
+        request->done = true;
+        request->end = now;
+        sched_resp_free_with_cont(respc);
+        n_responses++;
+    }
+
+    return n_responses;
+}
+
+/** Schedule the queued requests until none of them can be allocated, as the
+ * scheduler thread does
+ */
+static int schedule(struct replay *replay, double now)
+{
+    size_t n_pushed;
+    int rc;
+
+    rc = io_sched_dispatch_devices(&replay->sched.io_sched_hdl,
+                                   replay->sched.devices.ldh_devices);
+    if (rc)
+        LOG_RETURN(rc, "Failed to dispatch the drives");
+
+    replay->now = now;
+    do {
+        n_pushed = replay->n_pushed;
+        rc = lrs_schedule_work(&replay->sched);
+        if (rc)
+            return rc;
+    } while (replay->n_pushed > n_pushed || drain_responses(replay, now));
+
+    return 0;
+}
+
+static int push_arrivals(struct replay *replay, double now)
+{
+    while (replay->next_arrival < replay->n_requests &&
+           replay->requests[replay->next_arrival].arrival <= now) {
+        size_t id = replay->next_arrival++;
+        struct req_container *reqc;
+        int rc;
+
+        reqc = build_request(&replay->requests[id], id);
+        rc = io_sched_push_request(&replay->sched.io_sched_hdl, reqc);
+        if (rc) {
+            sched_req_free(reqc);
+            LOG_RETURN(rc, "Failed to push request %zu", id);
+        }
+    }
+
+    return 0;
+}
+
+/** Run the replay until no request can progress anymore */
+static int run(struct replay *replay)
+{
+    double now;
+    size_t i;
+    int rc;
+
+    while (true) {
+        now = INFINITY;
+        if (replay->next_arrival < replay->n_requests)
+            now = replay->requests[replay->next_arrival].arrival;
+        for (i = 0; i < replay->n_drives; i++)
+            if (replay->drives[i].request &&
+                replay->drives[i].busy_until < now)
+                now = replay->drives[i].busy_until;
+
+        if (isinf(now))
+            return 0;
+
+        for (i = 0; i < replay->n_drives; i++)
+            if (replay->drives[i].request &&
+                replay->drives[i].busy_until <= now)
+                drive_complete(replay, &replay->drives[i]);
+
+        rc = push_arrivals(replay, now);
+        if (rc)
+            return rc;
+
+        rc = schedule(replay, now);
+        if (rc)
+            return rc;
+    }
+}
+
+/** Free the requests that could not be served */
+static void flush_requests(struct replay *replay)
+{
+    struct req_container *reqc;
+
+    while (true) {
+        reqc = NULL;
+        if (io_sched_peek_request(&replay->sched.io_sched_hdl, &reqc) ||
+            !reqc)
+            break;
+
+        io_sched_remove_request(&replay->sched.io_sched_hdl, reqc);
+        sched_req_free(reqc);
+    }
+}
+
+static void report(struct replay *replay)
+{
+    static const struct {
+        enum io_request_type type;
+        const char *name;
+    } KINDS[] = {
+        { IO_REQ_READ,   "read" },
+        { IO_REQ_WRITE,  "write" },
+        { IO_REQ_FORMAT, "format" },
+    };
+    double busy_time = 0;
+    size_t i;
+    size_t j;
+
+    printf("%-8s %8s %8s %8s %10s %10s %10s %10s\n", "request", "served",
+           "failed", "unserved", "wait p50", "wait p90", "wait p99",
+           "wait max");
+
+    for (i = 0; i < ARRAY_SIZE(KINDS); i++) {
+        GArray *waits = g_array_new(FALSE, FALSE, sizeof(double));
+        size_t n_failed = 0;
+        size_t n_unserved = 0;
+        double *sorted;
+        size_t n;
+
+        for (j = 0; j < replay->n_requests; j++) {
+            struct replay_request *request = &replay->requests[j];
+            double wait;
+
+            if (request->entry.type != KINDS[i].type)
+                continue;
+
+            if (!request->done) {
+                n_unserved++;
+            } else if (request->failed) {
+                n_failed++;
+            } else {
+                wait = request->start - request->arrival;
+                g_array_append_val(waits, wait);
+            }
+        }
+
+        g_array_sort(waits, cmp_double);
+        sorted = (double *)waits->data;
+        n = waits->len;
+        if (n == 0)
+            printf("%-8s %8zu %8zu %8zu %10s %10s %10s %10s\n", KINDS[i].name,
+                   n, n_failed, n_unserved, "-", "-", "-", "-");
+        else
+            printf("%-8s %8zu %8zu %8zu %9.1fs %9.1fs %9.1fs %9.1fs\n",
+                   KINDS[i].name, n, n_failed, n_unserved,
+                   sorted[(n - 1) / 2], sorted[(n - 1) * 9 / 10],
+                   sorted[(n - 1) * 99 / 100], sorted[n - 1]);
+
+        g_array_free(waits, TRUE);
+    }
+
+    for (i = 0; i < replay->n_drives; i++)
+        busy_time += replay->drives[i].busy_time;
+
+    printf("\nmounts %zu, unmounts %zu, locates %zu (%.0f s)\n",
+           replay->n_mounts, replay->n_unmounts, replay->n_locates,
+           replay->locate_time);
+    if (replay->makespan > 0)
+        printf("drive utilisation %.1f%%, read %.1f MB/s, written %.1f MB/s "
+               "over %.0f s\n",
+               100 * busy_time / (replay->n_drives * replay->makespan),
+               replay->bytes_read / 1e6 / replay->makespan,
+               replay->bytes_written / 1e6 / replay->makespan,
+               replay->makespan);
+}
+
+int main(int argc, char **argv)
+{
+    struct replay replay = { .n_drives = DEFAULT_N_DRIVES };
+    size_t n_empty_tapes = DEFAULT_N_EMPTY_TAPES;
+    double load_factor = DEFAULT_LOAD_FACTOR;
+    struct lrs_sched *sched = &replay.sched;
+    size_t i;
+    int rc;
+
+    if (argc > 2)
+        replay.n_drives = strtoul(argv[2], NULL, 10);
+    if (argc > 3)
+        load_factor = strtod(argv[3], NULL);
+    if (argc > 4)
+        n_empty_tapes = strtoul(argv[4], NULL, 10);
+    if (argc < 2 || argc > 5 || replay.n_drives == 0 || load_factor <= 0) {
+        fprintf(stderr,
+                "usage: %s <trace> [n_drives [load_factor [n_empty_tapes]]]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    pho_context_init();
+    pho_log_level_set(PHO_LOG_ERROR);
+    sim_media = g_hash_table_new_full(g_str_hash, g_str_equal, free,
+                                      sim_medium_free);
+
+    rc = pho_cfg_init_local("../phobos.conf");
+    if (rc)
+        goto out_media;
+
+    rc = load_trace(&replay, argv[1], load_factor);
+    if (rc)
+        goto out_requests;
+
+    init_dss_media(n_empty_tapes);
+
+    /* as sched_init, without the device threads and the database */
+    sched->family = PHO_RSC_TAPE;
+    sched->trace_fd = -1;
+    sched->response_queue = &replay.response_queue;
+    sched->dev_push = drive_push;
+    sched->dev_push_data = &replay;
+
+    rc = lock_handle_init(&sched->lock_handle, &sched->sched_thread.dss);
+    if (rc)
+        goto out_requests;
+
+    rc = lrs_cache_setup(PHO_RSC_TAPE);
+    if (rc)
+        goto out_requests;
+
+    rc = format_media_init(&sched->ongoing_format);
+    if (rc)
+        goto out_cache;
+
+    rc = lrs_media_catalog_init(&sched->catalog, PHO_RSC_TAPE, NULL);
+    if (rc)
+        goto out_format;
+
+    rc = lrs_media_catalog_sync(&sched->catalog, NULL);
+    if (rc)
+        goto out_catalog;
+
+    rc = mpsc_queue_init(&replay.response_queue, 1024);
+    if (rc)
+        goto out_catalog;
+
+    rc = init_drives(&replay);
+    if (rc)
+        goto out_drives;
+
+    rc = io_sched_handle_load_from_config(&sched->io_sched_hdl, PHO_RSC_TAPE);
+    if (rc)
+        goto out_drives;
+
+    sched->io_sched_hdl.lock_handle = &sched->lock_handle;
+    sched->io_sched_hdl.catalog = &sched->catalog;
+    sched->io_sched_hdl.response_queue = sched->response_queue;
+    sched->io_sched_hdl.global_device_list = sched->devices.ldh_devices;
+
+    rc = run(&replay);
+    if (rc)
+        fprintf(stderr, "Replay failed: %s\n", strerror(-rc));
+    else
+        report(&replay);
+
+    flush_requests(&replay);
+    drain_responses(&replay, 0);
+    io_sched_fini(&sched->io_sched_hdl);
+out_drives:
+    fini_drives(&replay);
+    mpsc_queue_destroy(&replay.response_queue, sched_resp_free_with_cont);
+out_catalog:
+    lrs_media_catalog_fini(&sched->catalog);
+out_format:
+    format_media_clean(&sched->ongoing_format);
+out_cache:
+    lrs_cache_cleanup(PHO_RSC_TAPE);
+out_requests:
+    for (i = 0; i < replay.n_requests; i++)
+        lrs_trace_entry_clean(&replay.requests[i].entry);
+    free(replay.requests);
+    for (i = 0; i < n_dss_media; i++)
+        media_info_cleanup(&dss_media[i]);
+    free(dss_media);
+    pho_cfg_local_fini();
+out_media:
+    g_hash_table_destroy(sim_media);
+    pho_context_fini();
+
+    return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
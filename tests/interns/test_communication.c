@@ -383,6 +383,141 @@ err_rc:
     return rc;
 }
 
+/* messages sent in batches are received in order, as many as available */
+static int test_sendrecv_batch(void *arg)
+{
+    struct pho_comm_addr_type *addr_type = (struct pho_comm_addr_type *)arg;
+    const int NMSG = 64;
+    struct pho_comm_data send_data[NMSG];
+    struct pho_comm_data *data = NULL;
+    struct pho_comm_info ci_server;
+    struct pho_comm_info ci_client;
+    int rc = PHO_TEST_SUCCESS;
+    int i, nb_data, cnt = 0;
+    size_t n_sent;
+
+    assert(!pho_comm_open(&ci_server, &addr_type->addr,
+                          addr_type->server_type));
+    assert(!pho_comm_open(&ci_client, &addr_type->addr,
+                          addr_type->client_type));
+    assert(!pho_comm_recv(&ci_server, &data, &nb_data));
+    free(data);
+
+    for (i = 0; i < NMSG; ++i) {
+        send_data[i] = pho_comm_data_init(&ci_client);
+        send_data[i].buf.buff = xmalloc(sizeof(i));
+        memcpy(send_data[i].buf.buff, &i, sizeof(i));
+        send_data[i].buf.size = sizeof(i);
+    }
+
+    assert(!pho_comm_send_batch(send_data, NMSG, &n_sent));
+    assert(n_sent == NMSG);
+
+    while (cnt < NMSG) {
+        assert(!pho_comm_recv(&ci_server, &data, &nb_data));
+        for (i = 0; i < nb_data; ++i) {
+            int tmp;
+
+            memcpy(&tmp, data[i].buf.buff, sizeof(tmp));
+            free(data[i].buf.buff);
+            if (tmp != cnt)
+                pho_error(rc = PHO_TEST_FAILURE,
+                          "server received %d, expected %d\n", tmp, cnt);
+
+            /* answer on the server-side socket of the client */
+            send_data[cnt].fd = data[i].fd;
+            cnt++;
+        }
+        free(data);
+    }
+
+    assert(!pho_comm_send_batch(send_data, NMSG, &n_sent));
+    assert(n_sent == NMSG);
+
+    for (i = 0; i < NMSG; ++i) {
+        int tmp;
+
+        assert(!pho_comm_recv(&ci_client, &data, &nb_data));
+        assert(nb_data == 1);
+        memcpy(&tmp, data->buf.buff, sizeof(tmp));
+        free(data->buf.buff);
+        free(data);
+        if (tmp != i)
+            pho_error(rc = PHO_TEST_FAILURE,
+                      "client received %d, expected %d\n", tmp, i);
+    }
+
+    for (i = 0; i < NMSG; ++i)
+        free(send_data[i].buf.buff);
+    pho_comm_close(&ci_client);
+    pho_comm_close(&ci_server);
+    return rc;
+}
+
+static int test_wait(void *arg)
+{
+    struct pho_comm_addr_type *addr_type = (struct pho_comm_addr_type *)arg;
+    struct pho_comm_data send_data;
+    struct pho_comm_data *data = NULL;
+    struct pho_comm_info ci_server;
+    struct pho_comm_info ci_client;
+    int rc = PHO_TEST_SUCCESS;
+    int nb_data;
+
+    assert(!pho_comm_open(&ci_server, &addr_type->addr,
+                          addr_type->server_type));
+    assert(!pho_comm_open(&ci_client, &addr_type->addr,
+                          addr_type->client_type));
+    assert(!pho_comm_recv(&ci_server, &data, &nb_data));
+    free(data);
+
+    /* nothing to receive yet */
+    if (pho_comm_wait(&ci_client, 10) != 0) {
+        pho_error(rc = PHO_TEST_FAILURE,
+                  "client wait must time out without any message\n");
+        goto out;
+    }
+
+    send_data = pho_comm_data_init(&ci_client);
+    send_data.buf.buff = xstrdup("Hello?");
+    send_data.buf.size = strlen(send_data.buf.buff);
+    assert(!pho_comm_send(&send_data));
+    free(send_data.buf.buff);
+
+    assert(!pho_comm_recv(&ci_server, &data, &nb_data));
+    assert(nb_data == 1);
+    send_data.fd = data->fd;
+    free(data->buf.buff);
+    free(data);
+
+    send_data.buf.buff = xstrdup("World!");
+    send_data.buf.size = strlen(send_data.buf.buff);
+    assert(!pho_comm_send(&send_data));
+    free(send_data.buf.buff);
+
+    /* the answer wakes the client up */
+    if (pho_comm_wait(&ci_client, -1) != 1) {
+        pho_error(rc = PHO_TEST_FAILURE,
+                  "client wait must return once a message is received\n");
+        goto out;
+    }
+
+    assert(!pho_comm_recv(&ci_client, &data, &nb_data));
+    if (nb_data != 1) {
+        pho_error(rc = PHO_TEST_FAILURE,
+                  "client receives %d messages after its wait, expected 1\n",
+                  nb_data);
+    } else {
+        free(data->buf.buff);
+    }
+    free(data);
+
+out:
+    pho_comm_close(&ci_client);
+    pho_comm_close(&ci_server);
+    return rc;
+}
+
 static int test_bad_hostname_port(void *arg)
 {
     struct pho_comm_info ci_client;
@@ -484,6 +619,10 @@ int main(int argc, char **argv)
                  &addr_type, PHO_TEST_SUCCESS);
     pho_run_test("Test: multiple sending/receiving AF_UNIX",
                  test_sendrecv_multiple, &addr_type, PHO_TEST_SUCCESS);
+    pho_run_test("Test: client wait for a message AF_UNIX", test_wait,
+                 &addr_type, PHO_TEST_SUCCESS);
+    pho_run_test("Test: batch sending/receiving AF_UNIX", test_sendrecv_batch,
+                 &addr_type, PHO_TEST_SUCCESS);
     addr_type.addr.tcp.hostname = "localhost";
     addr_type.addr.tcp.port = TCP_PORT_TEST;
     addr_type.server_type = PHO_COMM_TCP_SERVER;
@@ -492,6 +631,8 @@ int main(int argc, char **argv)
                  &addr_type, PHO_TEST_SUCCESS);
     pho_run_test("Test: multiple sending/receiving AF_INET",
                  test_sendrecv_multiple, &addr_type, PHO_TEST_SUCCESS);
+    pho_run_test("Test: batch sending/receiving AF_INET", test_sendrecv_batch,
+                 &addr_type, PHO_TEST_SUCCESS);
     pho_run_test("Test: AF_INET bad hostname or port", test_bad_hostname_port,
                  NULL, PHO_TEST_SUCCESS);
 
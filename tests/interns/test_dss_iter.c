@@ -0,0 +1,269 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests for the DSS iterators
+ */
+
+#include "test_setup.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "pho_dss.h"
+#include "pho_dss_wrapper.h"
+#include "dss_utils.h"
+
+#include <libpq-fe.h>
+#include <cmocka.h>
+
+#define N_ALIVE     10
+#define N_DEPREC    3
+
+struct test_state {
+    struct dss_handle *dss;
+    char oids[N_ALIVE + N_DEPREC][16];
+} global_state;
+
+static int insert_object(struct dss_handle *dss, char *oid, bool deprecated)
+{
+    struct object_info obj = {
+        .oid = oid,
+        .version = 1,
+        .user_md = "{}",
+    };
+    int rc;
+
+    rc = dss_object_insert(dss, &obj, 1, DSS_SET_INSERT);
+    if (rc || !deprecated)
+        return rc;
+
+    return dss_move_object_to_deprecated(dss, &obj, 1);
+}
+
+static int di_setup(void **state)
+{
+    int rc;
+    int i;
+
+    *state = &global_state;
+
+    rc = global_setup_dss_with_dbinit((void **)&global_state.dss);
+    if (rc)
+        return -1;
+
+    /* "oid00" to "oid09" are alive, "oid10" to "oid12" are deprecated */
+    for (i = 0; i < N_ALIVE + N_DEPREC; i++) {
+        snprintf(global_state.oids[i], sizeof(global_state.oids[i]),
+                 "oid%02d", i);
+        rc = insert_object(global_state.dss, global_state.oids[i],
+                           i >= N_ALIVE);
+        if (rc)
+            return -1;
+    }
+
+    return 0;
+}
+
+static int di_teardown(void **void_state)
+{
+    struct test_state *state = (struct test_state *)*void_state;
+
+    if (global_teardown_dss_with_dbdrop((void **)&state->dss))
+        return -1;
+
+    return 0;
+}
+
+/**
+ * Iterate over the objects of \p scope sorted by oid, by batches of
+ * \p batch_size, and check that they are the \p expected objects starting
+ * with "oid<first>".
+ */
+static void check_object_iter(struct test_state *state,
+                              enum dss_obj_scope scope, size_t batch_size,
+                              int first, int expected)
+{
+    struct dss_sort sort = {
+        .attr = "oid",
+        .psql_sort = true,
+    };
+    size_t full = batch_size ? : DSS_ITER_BATCH_SIZE;
+    struct object_info *objs;
+    struct dss_iter *iter;
+    int total = 0;
+    int n_objs;
+    int rc;
+    int i;
+
+    rc = dss_object_iter_open(state->dss, NULL, scope, &sort, batch_size,
+                              &iter);
+    assert_return_code(rc, -rc);
+
+    do {
+        rc = dss_object_iter_next(iter, &objs, &n_objs);
+        assert_return_code(rc, -rc);
+        assert_true((size_t)n_objs <= full);
+
+        /* Only the last batch may be partial */
+        if (total + n_objs < expected)
+            assert_int_equal((size_t)n_objs, full);
+
+        for (i = 0; i < n_objs; i++)
+            assert_string_equal(objs[i].oid,
+                                state->oids[first + total + i]);
+
+        total += n_objs;
+    } while (n_objs > 0);
+
+    assert_int_equal(total, expected);
+
+    /* The end of the iteration is sticky */
+    rc = dss_object_iter_next(iter, &objs, &n_objs);
+    assert_return_code(rc, -rc);
+    assert_int_equal(n_objs, 0);
+
+    dss_iter_close(iter);
+
+    assert_int_equal(PQtransactionStatus(state->dss->dh_conn), PQTRANS_IDLE);
+}
+
+static void di_object_partial_batch(void **void_state)
+{
+    check_object_iter(*void_state, DSS_OBJ_ALIVE, 3, 0, N_ALIVE);
+}
+
+static void di_object_full_batches(void **void_state)
+{
+    check_object_iter(*void_state, DSS_OBJ_ALIVE, 5, 0, N_ALIVE);
+}
+
+static void di_object_single_batch(void **void_state)
+{
+    check_object_iter(*void_state, DSS_OBJ_ALIVE, 0, 0, N_ALIVE);
+}
+
+static void di_deprecated_object(void **void_state)
+{
+    check_object_iter(*void_state, DSS_OBJ_DEPRECATED, 2, N_ALIVE, N_DEPREC);
+}
+
+static void di_all_object(void **void_state)
+{
+    check_object_iter(*void_state, DSS_OBJ_ALL, 4, 0, N_ALIVE + N_DEPREC);
+}
+
+static void di_object_filter(void **void_state)
+{
+    struct test_state *state = (struct test_state *)*void_state;
+    struct object_info *objs;
+    struct dss_filter filter;
+    struct dss_iter *iter;
+    int n_objs;
+    int rc;
+
+    rc = dss_filter_build(&filter, "{\"DSS::OBJ::oid\": \"%s\"}",
+                          state->oids[4]);
+    assert_return_code(rc, -rc);
+
+    rc = dss_object_iter_open(state->dss, &filter, DSS_OBJ_ALIVE, NULL, 2,
+                              &iter);
+    dss_filter_free(&filter);
+    assert_return_code(rc, -rc);
+
+    rc = dss_object_iter_next(iter, &objs, &n_objs);
+    assert_return_code(rc, -rc);
+    assert_int_equal(n_objs, 1);
+    assert_string_equal(objs[0].oid, state->oids[4]);
+
+    rc = dss_object_iter_next(iter, &objs, &n_objs);
+    assert_return_code(rc, -rc);
+    assert_int_equal(n_objs, 0);
+
+    dss_iter_close(iter);
+}
+
+static void di_object_in_transaction(void **void_state)
+{
+    struct test_state *state = (struct test_state *)*void_state;
+    PGconn *conn = state->dss->dh_conn;
+    struct object_info *objs;
+    struct dss_iter *iter;
+    PGresult *res;
+    int n_objs;
+    int rc;
+
+    rc = execute(conn, "BEGIN;", &res, PGRES_COMMAND_OK);
+    PQclear(res);
+    assert_return_code(rc, -rc);
+
+    rc = dss_object_iter_open(state->dss, NULL, DSS_OBJ_ALIVE, NULL, 4, &iter);
+    assert_return_code(rc, -rc);
+
+    rc = dss_object_iter_next(iter, &objs, &n_objs);
+    assert_return_code(rc, -rc);
+    assert_int_equal(n_objs, 4);
+
+    /* The transaction of the caller is left open */
+    dss_iter_close(iter);
+    assert_int_equal(PQtransactionStatus(conn), PQTRANS_INTRANS);
+
+    rc = execute(conn, "ROLLBACK;", &res, PGRES_COMMAND_OK);
+    PQclear(res);
+    assert_return_code(rc, -rc);
+}
+
+static void di_unsupported_sort(void **void_state)
+{
+    struct test_state *state = (struct test_state *)*void_state;
+    struct dss_sort sort = {
+        .attr = "size",
+        .psql_sort = false,
+    };
+    struct dss_iter *iter;
+    int rc;
+
+    rc = dss_object_iter_open(state->dss, NULL, DSS_OBJ_ALIVE, &sort, 0,
+                              &iter);
+    assert_int_equal(rc, -ENOTSUP);
+}
+
+int main(void)
+{
+    const struct CMUnitTest dss_iter_test_cases[] = {
+        cmocka_unit_test(di_object_partial_batch),
+        cmocka_unit_test(di_object_full_batches),
+        cmocka_unit_test(di_object_single_batch),
+        cmocka_unit_test(di_deprecated_object),
+        cmocka_unit_test(di_all_object),
+        cmocka_unit_test(di_object_filter),
+        cmocka_unit_test(di_object_in_transaction),
+        cmocka_unit_test(di_unsupported_sort),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(dss_iter_test_cases, di_setup, di_teardown);
+}
@@ -30,6 +30,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <libpq-fe.h>
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stdlib.h>
@@ -543,6 +544,42 @@ static void dss_lock_update_last_locate(void **state)
     pho_lock_clean(&lock);
 }
 
+static void dss_lock_quoted_id(void **state)
+{
+    static const struct object_info QUOTED_LOCK = { .oid = "quoted'object" };
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    struct pho_lock lock;
+    int rc;
+
+    rc = dss_lock(handle, DSS_OBJECT, &QUOTED_LOCK, 1);
+    assert_return_code(rc, -rc);
+
+    rc = dss_lock_status(handle, DSS_OBJECT, &QUOTED_LOCK, 1, &lock);
+    assert_return_code(rc, -rc);
+    pho_lock_clean(&lock);
+
+    rc = dss_unlock(handle, DSS_OBJECT, &QUOTED_LOCK, 1, false);
+    assert_return_code(rc, -rc);
+}
+
+static void dss_lock_statement_deallocated(void **state)
+{
+    struct dss_handle *handle = (struct dss_handle *)*state;
+    PGresult *res;
+    int rc;
+
+    rc = dss_lock(handle, DSS_OBJECT, &GOOD_LOCKS[0], 1);
+    assert_return_code(rc, -rc);
+
+    /* The prepared statements are lost, as on a reconnection */
+    res = PQexec(handle->dh_conn, "DEALLOCATE ALL;");
+    assert_int_equal(PQresultStatus(res), PGRES_COMMAND_OK);
+    PQclear(res);
+
+    rc = dss_unlock(handle, DSS_OBJECT, &GOOD_LOCKS[0], 1, false);
+    assert_return_code(rc, -rc);
+}
+
 int main(void)
 {
     const struct CMUnitTest dss_lock_test_cases[] = {
@@ -567,6 +604,8 @@ int main(void)
         cmocka_unit_test(dss_lock_hostname_unlock_ok),
         cmocka_unit_test(dss_lock_last_locate),
         cmocka_unit_test(dss_lock_update_last_locate),
+        cmocka_unit_test(dss_lock_quoted_id),
+        cmocka_unit_test(dss_lock_statement_deallocated),
     };
 
     pho_context_init();
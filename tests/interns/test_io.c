@@ -30,8 +30,11 @@
 #include "pho_io.h"
 #include "pho_types.h"
 #include "pho_test_utils.h"
+#include "pho_type_utils.h"
 
 #include <fcntl.h>
+#include <jansson.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -404,6 +407,191 @@ clean_test_dir_source:
     return rc;
 }
 
+/* Read \p count bytes at \p offset of the file \p fpath */
+static int read_file_at(const char *fpath, off_t offset, char *buff,
+                        size_t count)
+{
+    ssize_t read_count;
+    int rc = 0;
+    int fd;
+
+    fd = open(fpath, O_RDONLY);
+    if (fd < 0)
+        LOG_RETURN(-errno, "Unable to open '%s'", fpath);
+
+    read_count = pread(fd, buff, count, offset);
+    if (read_count < 0)
+        rc = -errno;
+    else if (read_count != count)
+        rc = -EIO;
+
+    close(fd);
+    if (rc)
+        LOG_RETURN(rc, "Unable to read %zu bytes at %jd of '%s'", count,
+                   (intmax_t)offset, fpath);
+
+    return 0;
+}
+
+static int test_pack_index(void *state)
+{
+    char test_dir[] = "/tmp/test_pack_indexXXXXXX";
+    char *container_address = "container";
+    static const size_t sizes[] = { 1000, 24 };
+    char footer[PHO_PACK_FOOTER_SIZE + 1] = {0};
+    struct io_adapter_module *ioa = {0};
+    struct pho_io_descr iod = {0};
+    struct pho_ext_loc loc = {0};
+    struct stat container_stat;
+    struct extent ext[2] = {0};
+    char data[1024] = {0};
+    json_t *index = NULL;
+    char *dump = NULL;
+    json_t *objects;
+    size_t index_size;
+    size_t offset = 0;
+    ssize_t rc2 = 0;
+    char *fpath;
+    int rc3;
+    int rc;
+    int i;
+
+    (void)state;
+
+    if (mkdtemp(test_dir) == NULL)
+        LOG_RETURN(-errno, "Unable to create test dir");
+
+    rc = asprintf(&fpath, "%s/%s", test_dir, container_address);
+    if (rc < 0)
+        LOG_GOTO(clean_test_dir, rc = -ENOMEM, "Unable to allocate fpath");
+
+    rc = get_io_adapter(PHO_FS_POSIX, &ioa);
+    if (rc)
+        LOG_GOTO(free_path, rc, "Unable to get posix ioa");
+
+    ext[0].address.buff = container_address;
+    loc.extent = &ext[0];
+    loc.root_path = test_dir;
+    iod.iod_loc = &loc;
+
+    rc = ioa_open(ioa, NULL, &iod, true);
+    if (rc)
+        LOG_GOTO(free_path, rc, "Unable to open the container");
+
+    /* two objects one after the other, then the index and the footer */
+    for (i = 0; i < 2; i++) {
+        memset(data, 'a' + i, sizes[i]);
+        rc = ioa_write(ioa, &iod, data, sizes[i]);
+        if (rc)
+            LOG_GOTO(close_container, rc, "Unable to write object %d", i);
+
+        ext[i].uuid = generate_uuid();
+        ext[i].size = sizes[i];
+        extent_set_pack_offset(&ext[i], offset);
+        pack_index_add(&index, &ext[i]);
+        offset += sizes[i];
+    }
+
+    rc2 = pack_index_write(ioa, &iod, index);
+    if (rc2 < 0)
+        LOG_GOTO(close_container, rc = rc2, "Unable to write the index");
+
+    if ((size_t)rc2 > pack_index_max_size(2))
+        LOG_GOTO(close_container, rc = -EINVAL,
+                 "Index of %zd bytes larger than its bound %zu", rc2,
+                 pack_index_max_size(2));
+
+close_container:
+    rc3 = ioa_close(ioa, &iod);
+    rc = rc ? : rc3;
+    if (rc)
+        goto remove_container;
+
+    if (stat(fpath, &container_stat))
+        LOG_GOTO(remove_container, rc = -errno, "Unable to stat container");
+
+    if (container_stat.st_size != offset + rc2)
+        LOG_GOTO(remove_container, rc = -EINVAL,
+                 "Container size is %jd instead of %zu",
+                 (intmax_t)container_stat.st_size, offset + rc2);
+
+    /* find the index from the end of the container */
+    rc = read_file_at(fpath, container_stat.st_size - PHO_PACK_FOOTER_SIZE,
+                      footer, PHO_PACK_FOOTER_SIZE);
+    if (rc)
+        goto remove_container;
+
+    if (strncmp(footer, PHO_PACK_MAGIC, strlen(PHO_PACK_MAGIC)))
+        LOG_GOTO(remove_container, rc = -EINVAL, "Invalid footer '%s'",
+                 footer);
+
+    index_size = strtoul(footer + strlen(PHO_PACK_MAGIC), NULL, 16);
+    if (index_size + PHO_PACK_FOOTER_SIZE != rc2)
+        LOG_GOTO(remove_container, rc = -EINVAL,
+                 "Index size is %zu instead of %zu", index_size,
+                 rc2 - PHO_PACK_FOOTER_SIZE);
+
+    dump = xcalloc(1, index_size + 1);
+    rc = read_file_at(fpath, offset, dump, index_size);
+    if (rc)
+        goto remove_container;
+
+    json_decref(index);
+    index = json_loads(dump, 0, NULL);
+    objects = json_object_get(index, "objects");
+    if (!json_is_array(objects) || json_array_size(objects) != 2)
+        LOG_GOTO(remove_container, rc = -EINVAL, "Invalid index '%s'", dump);
+
+    for (i = 0; i < 2; i++) {
+        json_t *object = json_array_get(objects, i);
+        const char *uuid;
+        json_int_t obj_offset;
+        json_int_t obj_size;
+
+        if (json_unpack(object, "{s:s, s:I, s:I}", "extent", &uuid,
+                        "offset", &obj_offset, "size", &obj_size))
+            LOG_GOTO(remove_container, rc = -EINVAL,
+                     "Invalid index entry %d in '%s'", i, dump);
+
+        if (strcmp(uuid, ext[i].uuid) ||
+            obj_offset != extent_pack_offset(&ext[i]) ||
+            obj_size != sizes[i])
+            LOG_GOTO(remove_container, rc = -EINVAL,
+                     "Index entry %d does not match its extent in '%s'", i,
+                     dump);
+
+        /* the object is at its offset */
+        rc = read_file_at(fpath, obj_offset, data, 1);
+        if (rc)
+            goto remove_container;
+
+        if (data[0] != 'a' + i)
+            LOG_GOTO(remove_container, rc = -EINVAL,
+                     "Object %d not found at offset %jd", i,
+                     (intmax_t)obj_offset);
+    }
+
+remove_container:
+    if (unlink(fpath))
+        pho_error(rc = rc ? : -errno, "Fail to unlink container");
+
+    for (i = 0; i < 2; i++) {
+        free(ext[i].uuid);
+        pho_attrs_free(&ext[i].info);
+    }
+    json_decref(index);
+    free(dump);
+
+free_path:
+    free(fpath);
+
+clean_test_dir:
+    if (rmdir(test_dir))
+        pho_error(rc = rc ? : -errno, "Unable to remove test dir");
+
+    return rc;
+}
+
 int main(int argc, char **argv)
 {
     test_env_initialize();
@@ -423,6 +611,9 @@ int main(int argc, char **argv)
     pho_run_test("Posix copy",
                  test_copy_extent, NULL, PHO_TEST_SUCCESS);
 
+    pho_run_test("Pack index and footer read back",
+                 test_pack_index, NULL, PHO_TEST_SUCCESS);
+
     pho_info("Unit IO posix open/write/close: All tests succeeded");
     exit(EXIT_SUCCESS);
 }
@@ -154,6 +154,54 @@ static void test_dev_init(void **data)
     lrs_dev_hdl_fini(&dev_handle);
 }
 
+static void test_sync_policy(void **data)
+{
+    struct lrs_dev_hdl handle = {
+        .sync_time_ms = { .tv_sec = 10 },
+        .sync_nb_req = 100,
+    };
+    struct timespec duration = { .tv_sec = 2 };
+    struct timespec date = { .tv_sec = 1000 };
+    struct sync_policy policy;
+    int i;
+
+    sync_policy_init(&policy, &handle);
+
+    /* without ack target, the static thresholds are kept */
+    sync_policy_observe_sync(&policy, &duration);
+    sync_policy_update(&policy, &handle);
+    assert_int_equal(policy.nb_req, 100);
+    assert_int_equal(policy.time.tv_sec, 10);
+
+    /* releases every 100 ms and syncs of 2 s leave 1 s to batch 11 releases
+     * with a target of 3 s
+     */
+    handle.sync_ack_target.tv_sec = 3;
+    for (i = 0; i < 5; i++) {
+        sync_policy_observe_release(&policy, &date);
+        date.tv_nsec += 100000000;
+    }
+
+    sync_policy_update(&policy, &handle);
+    assert_int_equal(policy.nb_req, 11);
+    assert_int_equal(policy.time.tv_sec, 1);
+    assert_int_equal(policy.time.tv_nsec, 0);
+
+    /* syncs slower than the target are triggered by each release */
+    duration.tv_sec = 10;
+    sync_policy_observe_sync(&policy, &duration);
+    sync_policy_update(&policy, &handle);
+    assert_int_equal(policy.nb_req, 1);
+    assert_int_equal(policy.time.tv_sec, 0);
+    assert_int_equal(policy.time.tv_nsec, 0);
+
+    /* the static thresholds bound the adaptive ones */
+    handle.sync_ack_target.tv_sec = 60;
+    sync_policy_update(&policy, &handle);
+    assert_int_equal(policy.nb_req, 100);
+    assert_int_equal(policy.time.tv_sec, 10);
+}
+
 static int remove_device(struct dss_handle *dss, char *device)
 {
     struct dev_info dev = {
@@ -342,6 +390,7 @@ int main(void)
 {
     const struct CMUnitTest lrs_device_tests[] = {
         cmocka_unit_test(test_dev_init),
+        cmocka_unit_test(test_sync_policy),
         cmocka_unit_test_setup_teardown(test_ldh_add_one_device,
                                         test_setup_one_device,
                                         test_teardown_one_device),
@@ -0,0 +1,183 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests for the asynchronous DSS writer of the LRS
+ */
+
+/* phobos stuff */
+#include "lrs_dss_writer.h"
+#include "pho_dss.h"
+#include "pho_dss_wrapper.h"
+#include "test_setup.h"
+
+/* standard stuff */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* cmocka stuff */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+static struct pho_id medium_id = {
+    .family = PHO_RSC_DIR,
+    .name = "/writer/medium",
+    .library = "legacy",
+};
+
+static void fill_medium_info(struct media_info *medium_info, struct pho_id id)
+{
+    memset(medium_info, 0, sizeof(*medium_info));
+    medium_info->rsc.id = id;
+    medium_info->rsc.model = "dir";
+    medium_info->rsc.adm_status = PHO_RSC_ADM_ST_UNLOCKED;
+    medium_info->addr_type = PHO_ADDR_HASH1;
+    medium_info->fs.type = PHO_FS_POSIX;
+    medium_info->fs.status = PHO_FS_STATUS_USED;
+    medium_info->stats.phys_spc_free = 7;
+    medium_info->flags.put = true;
+    medium_info->flags.get = true;
+    medium_info->flags.delete = true;
+}
+
+static int dw_setup(void **state)
+{
+    struct media_info medium_info;
+    int rc;
+
+    rc = global_setup_dss_with_dbinit(state);
+    if (rc)
+        return rc;
+
+    fill_medium_info(&medium_info, medium_id);
+    if (dss_media_insert(*state, &medium_info, 1))
+        return -1;
+
+    /* only the explicit flushes write the updates during the tests */
+    return setenv("PHOBOS_LRS_dss_flush_ms", "600000", 1);
+}
+
+static ssize_t dss_phys_spc_free(struct dss_handle *dss)
+{
+    struct media_info *medium_info;
+    ssize_t phys_spc_free;
+    int rc;
+
+    rc = dss_one_medium_get_from_id(dss, &medium_id, &medium_info);
+    assert_return_code(rc, -rc);
+    phys_spc_free = medium_info->stats.phys_spc_free;
+    dss_res_free(medium_info, 1);
+
+    return phys_spc_free;
+}
+
+static void queue_phys_spc_free(struct lrs_dss_writer *writer,
+                                struct pho_id id, ssize_t phys_spc_free)
+{
+    struct media_info medium_info;
+
+    fill_medium_info(&medium_info, id);
+    medium_info.stats.phys_spc_free = phys_spc_free;
+    lrs_dss_writer_phys_spc_free(writer, &medium_info);
+}
+
+static void dw_coalesce_and_flush(void **state)
+{
+    struct lrs_dss_writer writer;
+    int rc;
+
+    rc = lrs_dss_writer_init(&writer);
+    assert_return_code(rc, -rc);
+
+    queue_phys_spc_free(&writer, medium_id, 100);
+    queue_phys_spc_free(&writer, medium_id, 42);
+    assert_int_equal(g_hash_table_size(writer.pending), 1);
+    assert_int_equal(dss_phys_spc_free(*state), 7);
+
+    rc = lrs_dss_writer_flush(&writer);
+    assert_return_code(rc, -rc);
+    assert_int_equal(dss_phys_spc_free(*state), 42);
+
+    /* nothing left to flush */
+    rc = lrs_dss_writer_flush(&writer);
+    assert_return_code(rc, -rc);
+
+    lrs_dss_writer_fini(&writer);
+}
+
+static void dw_fini_flushes(void **state)
+{
+    struct lrs_dss_writer writer;
+    int rc;
+
+    rc = lrs_dss_writer_init(&writer);
+    assert_return_code(rc, -rc);
+
+    queue_phys_spc_free(&writer, medium_id, 5);
+    lrs_dss_writer_fini(&writer);
+
+    assert_int_equal(dss_phys_spc_free(*state), 5);
+}
+
+static void dw_flush_error(void **state)
+{
+    struct pho_id unknown_id = {
+        .family = PHO_RSC_DIR,
+        .name = "/writer/unknown",
+        .library = "legacy",
+    };
+    struct lrs_dss_writer writer;
+    int rc;
+
+    (void)state;
+
+    rc = lrs_dss_writer_init(&writer);
+    assert_return_code(rc, -rc);
+
+    queue_phys_spc_free(&writer, unknown_id, 5);
+    rc = lrs_dss_writer_flush(&writer);
+    assert_int_not_equal(rc, 0);
+
+    /* the error is not reported to the next flushes */
+    queue_phys_spc_free(&writer, medium_id, 3);
+    rc = lrs_dss_writer_flush(&writer);
+    assert_return_code(rc, -rc);
+
+    lrs_dss_writer_fini(&writer);
+}
+
+int main(void)
+{
+    const struct CMUnitTest dss_writer_cases[] = {
+        cmocka_unit_test(dw_coalesce_and_flush),
+        cmocka_unit_test(dw_fini_flushes),
+        cmocka_unit_test(dw_flush_error),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(dss_writer_cases, dw_setup,
+                                  global_teardown_dss_with_dbdrop);
+}
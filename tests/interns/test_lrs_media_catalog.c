@@ -0,0 +1,263 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests for the media catalog of the LRS
+ */
+
+/* phobos stuff */
+#include "lrs_media_catalog.h"
+#include "pho_dss.h"
+#include "pho_type_utils.h"
+#include "test_setup.h"
+
+/* standard stuff */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* cmocka stuff */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+#define N_MEDIA 4
+
+static char *TAGS_FAST[] = {"fast"};
+static char *GROUPINGS_G1[] = {"g1"};
+
+/* name, library, free space, fs status, tags, groupings */
+static const struct {
+    const char          *name;
+    const char          *library;
+    ssize_t              phys_spc_free;
+    enum fs_status       fs_status;
+    bool                 fast;
+    bool                 g1;
+} MEDIA[N_MEDIA] = {
+    {"/catalog/m0", "lib_a", 300, PHO_FS_STATUS_USED,  true,  false},
+    {"/catalog/m1", "lib_a", 100, PHO_FS_STATUS_EMPTY, false, true},
+    {"/catalog/m2", "lib_b", 200, PHO_FS_STATUS_USED,  true,  true},
+    {"/catalog/m3", "lib_b", 400, PHO_FS_STATUS_BLANK, true,  false},
+};
+
+static void fill_medium_info(struct media_info *medium_info, int i)
+{
+    memset(medium_info, 0, sizeof(*medium_info));
+    medium_info->rsc.id.family = PHO_RSC_DIR;
+    pho_id_name_set(&medium_info->rsc.id, MEDIA[i].name, MEDIA[i].library);
+    medium_info->rsc.model = "dir";
+    medium_info->rsc.adm_status = PHO_RSC_ADM_ST_UNLOCKED;
+    medium_info->addr_type = PHO_ADDR_HASH1;
+    medium_info->fs.type = PHO_FS_POSIX;
+    medium_info->fs.status = MEDIA[i].fs_status;
+    medium_info->stats.phys_spc_free = MEDIA[i].phys_spc_free;
+    medium_info->flags.put = true;
+    medium_info->flags.get = true;
+    medium_info->flags.delete = true;
+    if (MEDIA[i].fast)
+        string_array_init(&medium_info->tags, TAGS_FAST, 1);
+    if (MEDIA[i].g1)
+        string_array_init(&medium_info->groupings, GROUPINGS_G1, 1);
+}
+
+static void clean_medium_info(struct media_info *medium_info)
+{
+    string_array_free(&medium_info->tags);
+    string_array_free(&medium_info->groupings);
+}
+
+static int mc_setup(void **state)
+{
+    struct media_info medium_info;
+    int rc;
+    int i;
+
+    rc = global_setup_dss_with_dbinit(state);
+    if (rc)
+        return rc;
+
+    for (i = 0; i < N_MEDIA; i++) {
+        fill_medium_info(&medium_info, i);
+        rc = dss_media_insert(*state, &medium_info, 1);
+        clean_medium_info(&medium_info);
+        if (rc)
+            return -1;
+    }
+
+    return 0;
+}
+
+/** Check the names of the media returned for \p filter, in order */
+static void check_get(struct lrs_media_catalog *catalog,
+                      const struct lrs_catalog_filter *filter,
+                      const char **names, int n_names)
+{
+    struct media_info *media;
+    int count;
+    int i;
+
+    lrs_media_catalog_get(catalog, filter, &media, &count);
+    assert_int_equal(count, n_names);
+    for (i = 0; i < count; i++)
+        assert_string_equal(media[i].rsc.id.name, names[i]);
+
+    lrs_media_catalog_res_free(media, count);
+}
+
+static void mc_filters(void **state)
+{
+    struct string_array tags_fast = { .strings = TAGS_FAST, .count = 1 };
+    struct lrs_media_catalog catalog;
+    struct lrs_catalog_filter filter = { .min_free = -1 };
+    int rc;
+
+    rc = lrs_media_catalog_init(&catalog, PHO_RSC_DIR, NULL);
+    assert_return_code(rc, -rc);
+    rc = lrs_media_catalog_sync(&catalog, *state);
+    assert_return_code(rc, -rc);
+
+    /* the blank medium cannot be written on */
+    check_get(&catalog, &filter,
+              (const char *[]){"/catalog/m1", "/catalog/m2", "/catalog/m0"},
+              3);
+
+    filter.min_free = 100;
+    check_get(&catalog, &filter,
+              (const char *[]){"/catalog/m2", "/catalog/m0"}, 2);
+    filter.min_free = 300;
+    check_get(&catalog, &filter, NULL, 0);
+    filter.min_free = -1;
+
+    filter.library = "lib_a";
+    check_get(&catalog, &filter,
+              (const char *[]){"/catalog/m1", "/catalog/m0"}, 2);
+    filter.library = "lib_unknown";
+    check_get(&catalog, &filter, NULL, 0);
+    filter.library = NULL;
+
+    filter.tags = &tags_fast;
+    check_get(&catalog, &filter,
+              (const char *[]){"/catalog/m2", "/catalog/m0"}, 2);
+
+    filter.grouping = "g1";
+    check_get(&catalog, &filter, (const char *[]){"/catalog/m2"}, 1);
+    filter.tags = NULL;
+    filter.grouping = NULL;
+
+    filter.empty_medium = true;
+    check_get(&catalog, &filter, (const char *[]){"/catalog/m1"}, 1);
+
+    lrs_media_catalog_fini(&catalog);
+}
+
+static void mc_update(void **state)
+{
+    struct lrs_catalog_filter filter = { .min_free = -1 };
+    struct lrs_media_catalog catalog;
+    struct media_info medium_info;
+    int rc;
+
+    rc = lrs_media_catalog_init(&catalog, PHO_RSC_DIR, NULL);
+    assert_return_code(rc, -rc);
+    rc = lrs_media_catalog_sync(&catalog, *state);
+    assert_return_code(rc, -rc);
+
+    /* m0 is written on, m3 is formatted, m2 is locked by an admin */
+    fill_medium_info(&medium_info, 0);
+    medium_info.stats.phys_spc_free = 50;
+    lrs_media_catalog_update(&catalog, &medium_info);
+    clean_medium_info(&medium_info);
+
+    fill_medium_info(&medium_info, 3);
+    medium_info.fs.status = PHO_FS_STATUS_EMPTY;
+    lrs_media_catalog_update(&catalog, &medium_info);
+    clean_medium_info(&medium_info);
+
+    fill_medium_info(&medium_info, 2);
+    medium_info.rsc.adm_status = PHO_RSC_ADM_ST_LOCKED;
+    string_array_free(&medium_info.tags);
+    lrs_media_catalog_update(&catalog, &medium_info);
+    clean_medium_info(&medium_info);
+
+    check_get(&catalog, &filter,
+              (const char *[]){"/catalog/m0", "/catalog/m1", "/catalog/m3"},
+              3);
+
+    /* the catalog values are kept until the DSS is updated too */
+    assert_false(lrs_media_catalog_is_stale(&catalog, NULL));
+
+    /* the reconciliation restores the DSS values */
+    rc = lrs_media_catalog_sync(&catalog, *state);
+    assert_return_code(rc, -rc);
+    check_get(&catalog, &filter,
+              (const char *[]){"/catalog/m1", "/catalog/m2", "/catalog/m0"},
+              3);
+
+    lrs_media_catalog_fini(&catalog);
+}
+
+static void mc_sync_removes(void **state)
+{
+    struct lrs_catalog_filter filter = { .min_free = -1 };
+    struct lrs_media_catalog catalog;
+    struct media_info medium_info;
+    int rc;
+
+    rc = lrs_media_catalog_init(&catalog, PHO_RSC_DIR, NULL);
+    assert_return_code(rc, -rc);
+    rc = lrs_media_catalog_sync(&catalog, *state);
+    assert_return_code(rc, -rc);
+
+    fill_medium_info(&medium_info, 1);
+    rc = dss_media_delete(*state, &medium_info, 1);
+    assert_return_code(rc, -rc);
+
+    rc = lrs_media_catalog_sync(&catalog, *state);
+    assert_return_code(rc, -rc);
+    check_get(&catalog, &filter,
+              (const char *[]){"/catalog/m2", "/catalog/m0"}, 2);
+
+    rc = dss_media_insert(*state, &medium_info, 1);
+    assert_return_code(rc, -rc);
+    clean_medium_info(&medium_info);
+
+    lrs_media_catalog_fini(&catalog);
+}
+
+int main(void)
+{
+    const struct CMUnitTest media_catalog_cases[] = {
+        cmocka_unit_test(mc_filters),
+        cmocka_unit_test(mc_update),
+        cmocka_unit_test(mc_sync_removes),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    /* the tests reconcile explicitly */
+    setenv("PHOBOS_LRS_media_catalog_sync_ms", "600000", 1);
+
+    return cmocka_run_group_tests(media_catalog_cases, mc_setup,
+                                  global_teardown_dss_with_dbdrop);
+}
@@ -388,6 +388,98 @@ static void dev_picker_flags(void **data)
     cleanup_device(&device[1]);
 }
 
+static void dev_picker_write_stream(void **data)
+{
+    struct timespec idle = { .tv_sec = 60 };
+    GPtrArray *devices = g_ptr_array_new();
+    struct media_info medium[3];
+    struct lrs_dev device[2];
+    struct lrs_dev *dev;
+    char *key;
+    int rc;
+
+    create_device(&device[0], "test1", LTO5_MODEL, NULL);
+    create_device(&device[1], "test2", LTO5_MODEL, NULL);
+
+    create_medium(&medium[0], "test1");
+    create_medium(&medium[1], "test2");
+    create_medium(&medium[2], "test3");
+    medium[0].fs.status = PHO_FS_STATUS_USED;
+    medium[1].fs.status = PHO_FS_STATUS_USED;
+    medium_set_size(&medium[0], 1000);
+    medium_set_size(&medium[1], 100);
+
+    mount_medium(&device[0], &medium[0]);
+    mount_medium(&device[1], &medium[1]);
+
+    gptr_array_from_list(devices, &device, 2, sizeof(device[0]));
+
+    rc = write_stream_dev_picker(devices, NULL, NULL, NULL, 10, &NO_STRING,
+                                 &dev);
+    assert_return_code(rc, -rc);
+    assert_null(dev);
+
+    /* the stream of test2 takes precedence over the best fit */
+    key = write_stream_key(NULL, NULL, &NO_STRING);
+    dev_write_stream_pin(&device[1], key, &medium[1].rsc.id, &idle);
+
+    rc = write_stream_dev_picker(devices, NULL, NULL, NULL, 10, &NO_STRING,
+                                 &dev);
+    assert_return_code(rc, -rc);
+    assert_ptr_equal(dev, &device[1]);
+    rc = write_stream_dev_picker(devices, NULL, NULL, "grouping", 10,
+                                 &NO_STRING, &dev);
+    assert_return_code(rc, -rc);
+    assert_null(dev);
+
+    /* the write waits for the pinned device while it is busy */
+    device[1].ld_ongoing_io = true;
+    rc = write_stream_dev_picker(devices, NULL, NULL, NULL, 10, &NO_STRING,
+                                 &dev);
+    assert_int_equal(rc, -EAGAIN);
+    assert_null(dev);
+    assert_non_null(device[1].ld_write_stream.key);
+    device[1].ld_ongoing_io = false;
+
+    /* the pinned medium is not swapped out for another one */
+    dev = dev_picker(devices, NULL, PHO_DEV_OP_ST_UNSPEC, NULL, NULL,
+                     select_empty_loaded_mount, 0, &NO_STRING, &medium[2],
+                     false, false, NULL);
+    assert_ptr_equal(dev, &device[0]);
+
+    device[0].ld_ongoing_io = true;
+    dev = dev_picker(devices, NULL, PHO_DEV_OP_ST_UNSPEC, NULL, NULL,
+                     select_empty_loaded_mount, 0, &NO_STRING, &medium[2],
+                     false, false, NULL);
+    assert_null(dev);
+
+    /* the stream ends after its idle timeout */
+    device[1].ld_write_stream.last_use.tv_sec -= 61;
+    dev = dev_picker(devices, NULL, PHO_DEV_OP_ST_UNSPEC, NULL, NULL,
+                     select_empty_loaded_mount, 0, &NO_STRING, &medium[2],
+                     false, false, NULL);
+    assert_ptr_equal(dev, &device[1]);
+    rc = write_stream_dev_picker(devices, NULL, NULL, NULL, 10, &NO_STRING,
+                                 &dev);
+    assert_return_code(rc, -rc);
+    assert_null(dev);
+
+    /* or as soon as its medium cannot hold a write, even if busy */
+    dev_write_stream_pin(&device[1], key, &medium[1].rsc.id, &idle);
+    device[1].ld_ongoing_io = true;
+    rc = write_stream_dev_picker(devices, NULL, NULL, NULL, 500, &NO_STRING,
+                                 &dev);
+    assert_return_code(rc, -rc);
+    assert_null(dev);
+    assert_null(device[1].ld_write_stream.key);
+    free(key);
+
+    dev_write_stream_unpin(&device[1]);
+    g_ptr_array_free(devices, true);
+    cleanup_device(&device[0]);
+    cleanup_device(&device[1]);
+}
+
 int tape_drive_compat_models(const char *tape_model, const char *drive_model,
                              bool *res)
 {
@@ -2195,6 +2287,185 @@ static void io_sched_exchange_device_no_prior_repartition(void **data)
     cleanup_devices(io_sched, device_array, true);
 }
 
+static void create_positioned_request(struct req_container *reqc,
+                                      const char * const *media_names,
+                                      uint64_t position,
+                                      struct lock_handle *lock_handle)
+{
+    create_request(reqc, media_names, 1, 1, lock_handle);
+    reqc->req->ralloc->n_positions = 1;
+    reqc->req->ralloc->positions =
+        xcalloc(1, sizeof(*reqc->req->ralloc->positions));
+    reqc->req->ralloc->positions[0] = position;
+}
+
+/* Serve the next request of the scheduler on \p device and check that it is
+ * the one at \p position.
+ */
+static void serve_next_request(struct io_sched_handle *io_sched,
+                               struct lrs_dev *device, uint64_t position)
+{
+    struct req_container *reqc;
+    struct lrs_dev *dev;
+    size_t index = 0;
+    int rc;
+
+    rc = io_sched_peek_request(io_sched, &reqc);
+    assert_return_code(rc, -rc);
+    assert_non_null(reqc);
+    assert_int_equal(reqc->req->ralloc->positions[0], position);
+
+    rc = io_sched_get_device_medium_pair(io_sched, reqc, &dev, &index);
+    free_medium_to_alloc(reqc, 0);
+    assert_return_code(rc, -rc);
+    assert_ptr_equal(dev, device);
+
+    rc = io_sched_remove_request(io_sched, reqc);
+    assert_return_code(rc, -rc);
+}
+
+static void grouped_read_elevator_order(void **data)
+{
+    struct io_sched_handle *io_sched = (struct io_sched_handle *) *data;
+    static const uint64_t positions[] = {
+        40, 80, 10, 60, 30, 90, 50,
+    };
+    static const char * const media_names[] = {
+        "M1",
+    };
+    struct req_container reqc[ARRAY_SIZE(positions)];
+    GPtrArray *devices = g_ptr_array_new();
+    struct lrs_dev device;
+    struct media_info M1;
+    size_t i;
+    int rc;
+
+    io_sched->global_device_list = devices;
+    create_device(&device, "D1", LTO5_MODEL, NULL);
+    wrap_create_medium(&M1, media_names[0]);
+    add_media(&M1, 1);
+    mount_medium(&device, &M1);
+    gptr_array_from_list(devices, &device, 1, sizeof(device));
+
+    for (i = 0; i < ARRAY_SIZE(positions); i++)
+        create_positioned_request(&reqc[i], media_names, positions[i],
+                                  io_sched->lock_handle);
+
+    for (i = 0; i < 2; i++) {
+        rc = io_sched_push_request(io_sched, &reqc[i]);
+        assert_return_code(rc, -rc);
+    }
+
+    rc = io_sched_dispatch_devices(io_sched, devices);
+    assert_return_code(rc, -rc);
+
+    /* the head moves to 40, the request at 80 is still queued */
+    serve_next_request(io_sched, &device, 40);
+
+    for (i = 2; i < ARRAY_SIZE(positions); i++) {
+        rc = io_sched_push_request(io_sched, &reqc[i]);
+        assert_return_code(rc, -rc);
+    }
+
+    /* the positions after the head by increasing position... */
+    serve_next_request(io_sched, &device, 50);
+    serve_next_request(io_sched, &device, 60);
+    serve_next_request(io_sched, &device, 80);
+    serve_next_request(io_sched, &device, 90);
+    /* ...then the sweep wraps to the lowest position */
+    serve_next_request(io_sched, &device, 10);
+    serve_next_request(io_sched, &device, 30);
+
+    rc = io_sched_remove_device(io_sched, &device);
+    cleanup_device(&device);
+    assert_return_code(rc, -rc);
+
+    remove_media(&M1, 1);
+    for (i = 0; i < ARRAY_SIZE(positions); i++)
+        destroy_request(&reqc[i]);
+    g_ptr_array_free(devices, true);
+}
+
+/* Push \p n_requests[i] requests on the medium media_names[i] and check that
+ * the queue of \p expected is the first one allocated to the empty device.
+ */
+static void check_best_service_rate(struct io_sched_handle *io_sched,
+                                    GPtrArray *devices,
+                                    const char * const *media_names,
+                                    const size_t *n_requests,
+                                    const char *expected)
+{
+    struct req_container reqc[8];
+    struct req_container *new_reqc;
+    size_t n = 0;
+    size_t i;
+    size_t j;
+    int rc;
+
+    for (i = 0; i < 2; i++) {
+        for (j = 0; j < n_requests[i]; j++) {
+            assert_true(n < ARRAY_SIZE(reqc));
+            create_positioned_request(&reqc[n], &media_names[i], j,
+                                      io_sched->lock_handle);
+            rc = io_sched_push_request(io_sched, &reqc[n++]);
+            assert_return_code(rc, -rc);
+        }
+    }
+
+    rc = io_sched_dispatch_devices(io_sched, devices);
+    assert_return_code(rc, -rc);
+
+    rc = io_sched_peek_request(io_sched, &new_reqc);
+    assert_return_code(rc, -rc);
+    assert_non_null(new_reqc);
+    assert_string_equal(new_reqc->req->ralloc->med_ids[0]->name, expected);
+
+    rc = io_sched_remove_request(io_sched, new_reqc);
+    assert_return_code(rc, -rc);
+
+    for (i = 0; i < n; i++) {
+        if (&reqc[i] != new_reqc) {
+            rc = io_sched_remove_request(io_sched, &reqc[i]);
+            assert_return_code(rc, -rc);
+        }
+        destroy_request(&reqc[i]);
+    }
+}
+
+static void grouped_read_elevator_service_rate(void **data)
+{
+    struct io_sched_handle *io_sched = (struct io_sched_handle *) *data;
+    static const char * const media_names[] = {
+        "M1", "M2",
+    };
+    static const size_t m1_longest[] = { 3, 1 };
+    static const size_t m2_longest[] = { 1, 3 };
+    GPtrArray *devices = g_ptr_array_new();
+    struct media_info media[2];
+    struct lrs_dev device;
+    int rc;
+
+    io_sched->global_device_list = devices;
+    create_device(&device, "D1", LTO5_MODEL, NULL);
+    wrap_create_medium(&media[0], media_names[0]);
+    wrap_create_medium(&media[1], media_names[1]);
+    add_media(media, 2);
+    gptr_array_from_list(devices, &device, 1, sizeof(device));
+
+    /* Both media have to be loaded, the longest queue amortizes the load
+     * best. Its medium is chosen whatever the order of the queues.
+     */
+    check_best_service_rate(io_sched, devices, media_names, m1_longest, "M1");
+    check_best_service_rate(io_sched, devices, media_names, m2_longest, "M2");
+
+    rc = io_sched_remove_device(io_sched, &device);
+    cleanup_device(&device);
+    assert_return_code(rc, -rc);
+
+    remove_media(media, 2);
+    g_ptr_array_free(devices, true);
+}
+
 int main(void)
 {
     const struct CMUnitTest test_dev_picker[] = {
@@ -2206,6 +2477,7 @@ int main(void)
         cmocka_unit_test(dev_picker_search_loaded),
         cmocka_unit_test(dev_picker_available_space),
         cmocka_unit_test(dev_picker_flags),
+        cmocka_unit_test(dev_picker_write_stream),
     };
     const struct CMUnitTest test_io_sched_api[] = {
         cmocka_unit_test(io_sched_add_device_twice),
@@ -2241,6 +2513,10 @@ int main(void)
         cmocka_unit_test(io_sched_exchange_device_no_prior_repartition),
         cmocka_unit_test(io_sched_exchange_device),
     };
+    const struct CMUnitTest test_grouped_read_elevator[] = {
+        cmocka_unit_test(grouped_read_elevator_order),
+        cmocka_unit_test(grouped_read_elevator_service_rate),
+    };
     int error_count;
     int rc;
 
@@ -2305,6 +2581,17 @@ int main(void)
                                           io_sched_setup,
                                           io_sched_teardown);
 
+    /* The elevator option is read once by the scheduler, these tests come
+     * last so that the other grouped_read tests keep the default ordering.
+     */
+    check_rc(set_schedulers("grouped_read", "fifo", "fifo", "none"));
+    check_rc(setenv("PHOBOS_IO_SCHED_TAPE_grouped_read_elevator", "true", 1));
+    IO_REQ_TYPE = IO_REQ_READ;
+    pho_info("Starting elevator tests for the 'grouped_read' scheduler");
+    error_count += cmocka_run_group_tests(test_grouped_read_elevator,
+                                          io_sched_setup,
+                                          io_sched_teardown);
+
     pho_cfg_local_fini();
     pho_context_fini();
 
@@ -0,0 +1,293 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests for the request trace of the LRS
+ */
+
+/* phobos stuff */
+#include "lrs_trace.h"
+#include "pho_common.h"
+#include "pho_srl_lrs.h"
+
+/* standard stuff */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* cmocka stuff */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+static void set_received_at(struct req_container *reqc)
+{
+    reqc->received_at.tv_sec = 1700000000;
+    reqc->received_at.tv_nsec = 42;
+}
+
+/** Record \p reqc to a trace and parse the line back */
+static void record_and_parse(struct req_container *reqc,
+                             struct lrs_trace_entry *entry)
+{
+    char path[] = "/tmp/test_lrs_trace_XXXXXX";
+    char line[256];
+    FILE *trace;
+    int fd;
+    int rc;
+
+    fd = mkstemp(path);
+    assert_return_code(fd, errno);
+    close(fd);
+
+    rc = lrs_trace_open(path, &fd);
+    assert_return_code(rc, -rc);
+    lrs_trace_request(fd, reqc);
+    close(fd);
+
+    trace = fopen(path, "r");
+    assert_non_null(trace);
+    assert_non_null(fgets(line, sizeof(line), trace));
+    assert_null(fgets(line + strlen(line), sizeof(line) - strlen(line),
+                      trace));
+    fclose(trace);
+    unlink(path);
+
+    rc = lrs_trace_parse(line, entry);
+    assert_return_code(rc, -rc);
+    assert_int_equal(entry->received_at.tv_sec, 1700000000);
+    assert_int_equal(entry->received_at.tv_nsec, 42);
+}
+
+static void lt_read(void **state)
+{
+    struct req_container reqc = { 0 };
+    struct lrs_trace_entry entry;
+    pho_req_t req;
+    int i;
+
+    (void) state;
+
+    pho_srl_request_read_alloc(&req, 2);
+    req.id = 1;
+    req.has_qos = true;
+    req.qos = 3;
+    req.ralloc->n_required = 1;
+    for (i = 0; i < 2; i++) {
+        req.ralloc->med_ids[i]->family = PHO_RSC_TAPE;
+        req.ralloc->med_ids[i]->name = xstrdup(i ? "P00001L6" : "P00000L6");
+        req.ralloc->med_ids[i]->library = xstrdup("legacy");
+    }
+    req.ralloc->n_positions = 2;
+    req.ralloc->positions = xcalloc(2, sizeof(*req.ralloc->positions));
+    req.ralloc->positions[0] = 12;
+    req.ralloc->positions[1] = 7;
+
+    reqc.req = &req;
+    set_received_at(&reqc);
+    record_and_parse(&reqc, &entry);
+
+    assert_int_equal(entry.family, PHO_RSC_TAPE);
+    assert_int_equal(entry.type, IO_REQ_READ);
+    assert_int_equal(entry.qos, 3);
+    assert_int_equal(entry.priority, 0);
+    assert_int_equal(entry.n_media, 2);
+    assert_int_equal(entry.n_required, 1);
+    assert_string_equal(entry.media[0], "P00000L6");
+    assert_string_equal(entry.media[1], "P00001L6");
+    assert_non_null(entry.positions);
+    assert_int_equal(entry.positions[0], 12);
+    assert_int_equal(entry.positions[1], 7);
+
+    lrs_trace_entry_clean(&entry);
+    pho_srl_request_free(&req, false);
+}
+
+static void lt_write(void **state)
+{
+    size_t n_tags[2] = { 0, 0 };
+    struct req_container reqc = { 0 };
+    struct lrs_trace_entry entry;
+    pho_req_t req;
+
+    (void) state;
+
+    pho_srl_request_write_alloc(&req, 2, n_tags);
+    req.id = 2;
+    req.has_priority = true;
+    req.priority = -1;
+    req.walloc->family = PHO_RSC_TAPE;
+    req.walloc->grouping = xstrdup("g1");
+    req.walloc->no_split = true;
+    req.walloc->media[0]->size = 1024;
+    req.walloc->media[1]->size = 2048;
+    req.walloc->media[1]->empty_medium = true;
+
+    reqc.req = &req;
+    set_received_at(&reqc);
+    record_and_parse(&reqc, &entry);
+
+    assert_int_equal(entry.type, IO_REQ_WRITE);
+    assert_int_equal(entry.priority, -1);
+    assert_int_equal(entry.n_media, 2);
+    assert_string_equal(entry.grouping, "g1");
+    assert_true(entry.no_split);
+    assert_int_equal(entry.sizes[0], 1024);
+    assert_int_equal(entry.sizes[1], 2048);
+    assert_false(entry.empty_medium[0]);
+    assert_true(entry.empty_medium[1]);
+
+    lrs_trace_entry_clean(&entry);
+    pho_srl_request_free(&req, false);
+}
+
+static void lt_format(void **state)
+{
+    struct req_container reqc = { 0 };
+    struct lrs_trace_entry entry;
+    pho_req_t req;
+
+    (void) state;
+
+    pho_srl_request_format_alloc(&req);
+    req.id = 3;
+    req.format->med_id->family = PHO_RSC_DIR;
+    req.format->med_id->name = xstrdup("/tmp/dir0");
+    req.format->med_id->library = xstrdup("legacy");
+
+    reqc.req = &req;
+    set_received_at(&reqc);
+    record_and_parse(&reqc, &entry);
+
+    assert_int_equal(entry.family, PHO_RSC_DIR);
+    assert_int_equal(entry.type, IO_REQ_FORMAT);
+    assert_int_equal(entry.n_media, 1);
+    assert_string_equal(entry.media[0], "/tmp/dir0");
+    assert_null(entry.grouping);
+
+    lrs_trace_entry_clean(&entry);
+    pho_srl_request_free(&req, false);
+}
+
+static void lt_escaped_names(void **state)
+{
+    struct req_container reqc = { 0 };
+    size_t n_tags[1] = { 0 };
+    struct lrs_trace_entry entry;
+    pho_req_t req;
+
+    (void) state;
+
+    pho_srl_request_read_alloc(&req, 1);
+    req.ralloc->n_required = 1;
+    req.ralloc->med_ids[0]->family = PHO_RSC_DIR;
+    req.ralloc->med_ids[0]->name = xstrdup("/tmp/my dir@50%");
+    req.ralloc->med_ids[0]->library = xstrdup("legacy");
+    req.ralloc->n_positions = 1;
+    req.ralloc->positions = xcalloc(1, sizeof(*req.ralloc->positions));
+    req.ralloc->positions[0] = 5;
+
+    reqc.req = &req;
+    set_received_at(&reqc);
+    record_and_parse(&reqc, &entry);
+
+    assert_int_equal(entry.n_media, 1);
+    assert_string_equal(entry.media[0], "/tmp/my dir@50%");
+    assert_int_equal(entry.positions[0], 5);
+
+    lrs_trace_entry_clean(&entry);
+    pho_srl_request_free(&req, false);
+
+    pho_srl_request_write_alloc(&req, 1, n_tags);
+    req.walloc->family = PHO_RSC_DIR;
+    req.walloc->grouping = xstrdup("my\tgrouping\n");
+    req.walloc->media[0]->size = 1;
+
+    record_and_parse(&reqc, &entry);
+    assert_string_equal(entry.grouping, "my\tgrouping\n");
+    lrs_trace_entry_clean(&entry);
+
+    /* a grouping named "-" is not read back as no grouping */
+    free(req.walloc->grouping);
+    req.walloc->grouping = xstrdup("-");
+
+    record_and_parse(&reqc, &entry);
+    assert_string_equal(entry.grouping, "-");
+    lrs_trace_entry_clean(&entry);
+
+    pho_srl_request_free(&req, false);
+}
+
+static void lt_parse_invalid(void **state)
+{
+    static const char * const LINES[] = {
+        "",
+        "1700000000.000000042 tape read 0 0",
+        "1700000000.42 tape read 0 0 1 P00000L6",
+        "1700000000.000000042 reel read 0 0 1 P00000L6",
+        "1700000000.000000042 tape erase 0 0 P00000L6",
+        "1700000000.000000042 tape read high 0 1 P00000L6",
+        "1700000000.000000042 tape read 0 0 0 P00000L6",
+        "1700000000.000000042 tape read 0 0 2 P00000L6",
+        "1700000000.000000042 tape read 0 0 1 P00000L6@1 P00001L6",
+        "1700000000.000000042 tape read 0 0 1 @1",
+        "1700000000.000000042 tape write 0 0 - 2 1024",
+        "1700000000.000000042 tape write 0 0 - 0 1024?",
+        "1700000000.000000042 tape format 0 0 P00000L6 P00001L6",
+        "1700000000.000000042 tape format 0 0 P00000L6%2",
+        "1700000000.000000042 tape format 0 0 P00000L6%00",
+        "1700000000.000000042 tape write 0 0 g%zz 0 1024",
+    };
+    struct lrs_trace_entry entry;
+    size_t i;
+
+    (void) state;
+
+    for (i = 0; i < ARRAY_SIZE(LINES); i++)
+        assert_int_equal(lrs_trace_parse(LINES[i], &entry), -EINVAL);
+
+    /* the fields may be separated by several blanks */
+    assert_int_equal(
+        lrs_trace_parse("1700000000.000000042  dir\twrite 0 0 - 0 1024!\n",
+                        &entry), 0);
+    assert_int_equal(entry.n_media, 1);
+    assert_true(entry.empty_medium[0]);
+    lrs_trace_entry_clean(&entry);
+}
+
+int main(void)
+{
+    const struct CMUnitTest lrs_trace_cases[] = {
+        cmocka_unit_test(lt_read),
+        cmocka_unit_test(lt_write),
+        cmocka_unit_test(lt_format),
+        cmocka_unit_test(lt_escaped_names),
+        cmocka_unit_test(lt_parse_invalid),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(lrs_trace_cases, NULL, NULL);
+}
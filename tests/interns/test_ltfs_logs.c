@@ -76,7 +76,7 @@ static void cleanup_tests(struct dss_and_tlc_lib *handle,
     int rc;
 
     get_serial_from_path(DEVICE_NAME, &device_serial);
-    rc = tlc_library_unload(&handle->dss, &handle->tlc_lib, device_serial,
+    rc = tlc_library_unload(&handle->dss, &handle->tlc_lib, 0, device_serial,
                             MEDIUM_NAME, &unloaded_tape_label, &unload_addr,
                             &json_message);
     assert_return_code(rc, -rc);
@@ -156,7 +156,7 @@ create_and_load(struct dss_and_tlc_lib *handle, struct lrs_dev *device)
     int rc;
 
     get_serial_from_path(DEVICE_NAME, &device_serial);
-    rc = tlc_library_load(&handle->dss, &handle->tlc_lib,
+    rc = tlc_library_load(&handle->dss, &handle->tlc_lib, 0,
                           device_serial, MEDIUM_NAME, &json_message);
     assert_return_code(-rc, rc);
 
@@ -0,0 +1,208 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests for the multi-producer single-consumer queue
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* phobos stuff */
+#include "pho_common.h"
+#include "pho_mpsc_queue.h"
+
+/* standard stuff */
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* cmocka stuff */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+#define N_PRODUCERS     8
+#define N_PUSHES        20000
+#define SMALL_CAPACITY  4
+
+/* elements are never NULL, so values are shifted by one */
+#define ELEM(value)     ((void *)(uintptr_t)((value) + 1))
+#define VALUE(elem)     ((uintptr_t)(elem) - 1)
+
+static void mq_fifo(void **state)
+{
+    struct mpsc_queue queue;
+    uintptr_t i;
+    int rc;
+
+    (void)state;
+
+    rc = mpsc_queue_init(&queue, SMALL_CAPACITY);
+    assert_return_code(rc, -rc);
+    assert_null(mpsc_queue_pop(&queue));
+
+    /* fill the ring, then overflow it */
+    for (i = 0; i < 3 * SMALL_CAPACITY; i++)
+        mpsc_queue_push(&queue, ELEM(i));
+    assert_int_equal(mpsc_queue_get_length(&queue), 3 * SMALL_CAPACITY);
+
+    /* pushes keep their order while the overflow is emptied */
+    for (i = 0; i < SMALL_CAPACITY; i++)
+        assert_int_equal(VALUE(mpsc_queue_pop(&queue)), i);
+    mpsc_queue_push(&queue, ELEM(3 * SMALL_CAPACITY));
+
+    for (i = SMALL_CAPACITY; i <= 3 * SMALL_CAPACITY; i++)
+        assert_int_equal(VALUE(mpsc_queue_pop(&queue)), i);
+
+    assert_null(mpsc_queue_pop(&queue));
+    assert_int_equal(mpsc_queue_get_length(&queue), 0);
+
+    mpsc_queue_destroy(&queue, NULL);
+}
+
+struct producer {
+    struct mpsc_queue *queue;
+    uintptr_t          id;
+};
+
+static void *producer_thread(void *arg)
+{
+    struct producer *producer = arg;
+    uintptr_t i;
+
+    for (i = 0; i < N_PUSHES; i++)
+        mpsc_queue_push(producer->queue,
+                        ELEM(producer->id * N_PUSHES + i));
+
+    return NULL;
+}
+
+static void mq_producers_order(void **state)
+{
+    struct producer producers[N_PRODUCERS];
+    pthread_t threads[N_PRODUCERS];
+    uintptr_t next[N_PRODUCERS];
+    struct mpsc_queue queue;
+    unsigned int popped = 0;
+    int rc;
+    int i;
+
+    (void)state;
+
+    rc = mpsc_queue_init(&queue, SMALL_CAPACITY);
+    assert_return_code(rc, -rc);
+
+    for (i = 0; i < N_PRODUCERS; i++) {
+        producers[i].queue = &queue;
+        producers[i].id = i;
+        next[i] = 0;
+        rc = pthread_create(&threads[i], NULL, producer_thread, &producers[i]);
+        assert_int_equal(rc, 0);
+    }
+
+    while (popped < N_PRODUCERS * N_PUSHES) {
+        uintptr_t value;
+        uintptr_t id;
+        void *elem;
+
+        elem = mpsc_queue_pop(&queue);
+        if (!elem) {
+            rc = mpsc_queue_wait(&queue, 1000);
+            assert_return_code(rc, -rc);
+            continue;
+        }
+
+        value = VALUE(elem);
+        id = value / N_PUSHES;
+        assert_true(id < N_PRODUCERS);
+        assert_int_equal(value % N_PUSHES, next[id]);
+        next[id]++;
+        popped++;
+    }
+
+    for (i = 0; i < N_PRODUCERS; i++)
+        pthread_join(threads[i], NULL);
+
+    assert_null(mpsc_queue_pop(&queue));
+    mpsc_queue_destroy(&queue, NULL);
+}
+
+static void mq_wait(void **state)
+{
+    struct mpsc_queue queue;
+    int rc;
+
+    (void)state;
+
+    rc = mpsc_queue_init(&queue, SMALL_CAPACITY);
+    assert_return_code(rc, -rc);
+
+    rc = mpsc_queue_wait(&queue, 10);
+    assert_int_equal(rc, -ETIMEDOUT);
+
+    /* an element pushed before the wait does not let it block */
+    mpsc_queue_push(&queue, ELEM(0));
+    rc = mpsc_queue_wait(&queue, -1);
+    assert_return_code(rc, -rc);
+    assert_int_equal(VALUE(mpsc_queue_pop(&queue)), 0);
+
+    rc = mpsc_queue_wait(&queue, 10);
+    assert_int_equal(rc, -ETIMEDOUT);
+
+    mpsc_queue_destroy(&queue, NULL);
+}
+
+static void mq_destroy_frees(void **state)
+{
+    struct mpsc_queue queue;
+    int rc;
+    int i;
+
+    (void)state;
+
+    rc = mpsc_queue_init(&queue, SMALL_CAPACITY);
+    assert_return_code(rc, -rc);
+
+    /* leaks would be reported by the memory checkers */
+    for (i = 0; i < 2 * SMALL_CAPACITY; i++)
+        mpsc_queue_push(&queue, xmalloc(16));
+
+    mpsc_queue_destroy(&queue, free);
+}
+
+int main(void)
+{
+    const struct CMUnitTest mpsc_queue_cases[] = {
+        cmocka_unit_test(mq_fifo),
+        cmocka_unit_test(mq_producers_order),
+        cmocka_unit_test(mq_wait),
+        cmocka_unit_test(mq_destroy_frees),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(mpsc_queue_cases, NULL, NULL);
+}
@@ -0,0 +1,253 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Check the GF(2^8) kernels and the Reed-Solomon encoding/decoding
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pho_common.h"
+#include "raid_gf.h"
+
+#include <cmocka.h>
+
+/* Sizes around the vector widths */
+static const size_t SIZES[] = {
+    0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 1000, 4096 + 13,
+};
+
+#define MAX_MISALIGN 3
+
+static void fill_random(char *buff, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++)
+        buff[i] = rand();
+}
+
+static void rgf_field_inverse(void **state)
+{
+    int a;
+
+    (void) state;
+
+    for (a = 1; a < 256; a++)
+        assert_int_equal(raid_gf_mul(a, raid_gf_inv(a)), 1);
+}
+
+static void rgf_kernels_match_scalar(void **state)
+{
+    size_t max_size = SIZES[ARRAY_SIZE(SIZES) - 1] + MAX_MISALIGN;
+    const struct raid_gf_kernel *kernels;
+    uint8_t tbl[RAID_GF_TBL_SIZE];
+    size_t n_kernels;
+    char *expected;
+    char *src;
+    char *dst;
+    size_t k;
+
+    (void) state;
+
+    kernels = raid_gf_kernels(&n_kernels);
+    assert_true(n_kernels >= 1);
+    assert_string_equal(kernels[0].name, "scalar");
+    assert_true(raid_gf_kernel()->supported());
+
+    src = xmalloc(max_size);
+    dst = xmalloc(max_size);
+    expected = xmalloc(max_size);
+
+    for (k = 1; k < n_kernels; k++) {
+        int c;
+
+        if (!kernels[k].supported()) {
+            print_message("kernel '%s' not supported by this CPU, skipped\n",
+                          kernels[k].name);
+            continue;
+        }
+
+        for (c = 0; c < 256; c++) {
+            size_t s;
+
+            raid_gf_build_tbl(c, tbl);
+            for (s = 0; s < ARRAY_SIZE(SIZES); s++) {
+                size_t off;
+
+                for (off = 0; off <= MAX_MISALIGN; off++) {
+                    size_t size = SIZES[s];
+
+                    fill_random(src, max_size);
+                    fill_random(dst, max_size);
+                    memcpy(expected, dst, max_size);
+
+                    kernels[0].mul_add(tbl, src + off, expected + off, size);
+                    kernels[k].mul_add(tbl, src + off, dst + off, size);
+                    assert_memory_equal(dst, expected, max_size);
+                }
+            }
+        }
+    }
+
+    /* the scalar kernel against the field multiplication */
+    for (k = 0; k < 256; k++) {
+        uint8_t zero = 0;
+        uint8_t b = k;
+
+        raid_gf_build_tbl(0x53, tbl);
+        kernels[0].mul_add(tbl, (char *)&b, (char *)&zero, 1);
+        assert_int_equal(zero, raid_gf_mul(0x53, b));
+    }
+
+    free(src);
+    free(dst);
+    free(expected);
+}
+
+/* Advance \p rows to the next sorted combination of k out of n indexes */
+static bool next_combination(size_t *rows, size_t k, size_t n)
+{
+    size_t i = k;
+
+    while (i > 0 && rows[i - 1] == n - k + i - 1)
+        i--;
+
+    if (i == 0)
+        return false;
+
+    rows[i - 1]++;
+    for (; i < k; i++)
+        rows[i] = rows[i - 1] + 1;
+
+    return true;
+}
+
+/* Encode then decode a stripe from every set of k extents out of k + m */
+static void check_erasures(size_t k, size_t m, size_t stripe_size)
+{
+    size_t base = stripe_size / k;
+    size_t remainder = stripe_size % k;
+    size_t parity_len = base + (remainder ? 1 : 0);
+    uint8_t *tables = xmalloc(max(m, k) * k * RAID_GF_TBL_SIZE);
+    char *chunks[RAID_GF_MAX_EXTENTS];
+    size_t len[RAID_GF_MAX_EXTENTS];
+    size_t rows[RAID_GF_MAX_EXTENTS];
+    uint8_t *matrix;
+    char *decoded;
+    size_t i, j;
+    int rc;
+
+    matrix = xmalloc(max(m, k) * k);
+
+    for (i = 0; i < k + m; i++) {
+        len[i] = i < k ? base + (i < remainder ? 1 : 0) : parity_len;
+        chunks[i] = xmalloc(parity_len + 1);
+        if (i < k)
+            fill_random(chunks[i], len[i]);
+    }
+    decoded = xmalloc(parity_len + 1);
+
+    rc = raid_gf_gen_cauchy(k, m, matrix);
+    assert_return_code(rc, -rc);
+    raid_gf_build_tables(m * k, matrix, tables);
+    raid_gf_encode(k, m, tables, (const char * const *)chunks, len,
+                   &chunks[k], parity_len);
+
+    for (i = 0; i < k; i++)
+        rows[i] = i;
+
+    do {
+        rc = raid_gf_decode_matrix(k, m, rows, matrix);
+        assert_return_code(rc, -rc);
+        raid_gf_build_tables(k * k, matrix, tables);
+
+        for (j = 0; j < k; j++) {
+            memset(decoded, 0, len[j]);
+            for (i = 0; i < k; i++)
+                raid_gf_mul_add(tables + (j * k + i) * RAID_GF_TBL_SIZE,
+                                chunks[rows[i]], decoded,
+                                min(len[j], len[rows[i]]));
+
+            assert_memory_equal(decoded, chunks[j], len[j]);
+        }
+    } while (next_combination(rows, k, k + m));
+
+    for (i = 0; i < k + m; i++)
+        free(chunks[i]);
+    free(decoded);
+    free(matrix);
+    free(tables);
+}
+
+static void rgf_decode_all_erasures(void **state)
+{
+    size_t k, m;
+
+    (void) state;
+
+    for (k = 1; k <= 6; k++) {
+        for (m = 1; m <= 4; m++) {
+            /* full stripe, short last stripes and a stripe shorter than k */
+            check_erasures(k, m, 64 * k);
+            check_erasures(k, m, 64 * k + 1);
+            check_erasures(k, m, 64 * k - 1);
+            check_erasures(k, m, 1);
+        }
+    }
+}
+
+static void rgf_decode_invalid_rows(void **state)
+{
+    size_t duplicate[] = {0, 0, 4};
+    size_t too_big[] = {0, 1, 5};
+    uint8_t decode[3 * 3];
+
+    (void) state;
+
+    assert_int_equal(raid_gf_decode_matrix(3, 2, duplicate, decode), -EINVAL);
+    assert_int_equal(raid_gf_decode_matrix(3, 2, too_big, decode), -EINVAL);
+    assert_int_equal(raid_gf_gen_cauchy(200, 57, decode), -EINVAL);
+}
+
+int main(void)
+{
+    const struct CMUnitTest raid_gf_tests[] = {
+        cmocka_unit_test(rgf_field_inverse),
+        cmocka_unit_test(rgf_kernels_match_scalar),
+        cmocka_unit_test(rgf_decode_all_erasures),
+        cmocka_unit_test(rgf_decode_invalid_rows),
+    };
+
+    srand(42);
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(raid_gf_tests, NULL, NULL);
+}
@@ -0,0 +1,198 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Check that every parity kernel matches the byte per byte XOR
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pho_common.h"
+#include "raid_common.h"
+#include "raid_xor.h"
+
+#include <cmocka.h>
+
+/* Sizes around the vector widths and the fused block size */
+static const size_t SIZES[] = {
+    0, 1, 7, 8, 15, 16, 17, 63, 64, 65, 127, 128, 255, 256, 257, 1000,
+    4096 + 13, RAID_XOR_FUSED_BLOCK_SIZE - 1, RAID_XOR_FUSED_BLOCK_SIZE + 1,
+    3 * RAID_XOR_FUSED_BLOCK_SIZE + 511,
+};
+
+#define MAX_MISALIGN 3
+
+/* Reference implementation: the historical byte per byte raid4 loop */
+static void reference_xor_in_place(const char *data, char *parity,
+                                   size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+        parity[i] = parity[i] ^ data[i];
+}
+
+static void fill_random(char *buff, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++)
+        buff[i] = rand();
+}
+
+static void rx_kernels_match_reference(void **state)
+{
+    size_t max_size = SIZES[ARRAY_SIZE(SIZES) - 1] + MAX_MISALIGN;
+    const struct raid_xor_kernel *kernels;
+    size_t n_kernels;
+    char *expected;
+    char *parity;
+    char *data;
+    char *dst;
+    size_t k;
+
+    (void) state;
+
+    kernels = raid_xor_kernels(&n_kernels);
+    assert_true(n_kernels >= 1);
+    assert_string_equal(kernels[0].name, "scalar");
+    assert_true(raid_xor_kernel()->supported());
+
+    data = xmalloc(max_size);
+    parity = xmalloc(max_size);
+    expected = xmalloc(max_size);
+    dst = xmalloc(max_size);
+
+    for (k = 0; k < n_kernels; k++) {
+        size_t s;
+
+        if (!kernels[k].supported()) {
+            print_message("kernel '%s' not supported by this CPU, skipped\n",
+                          kernels[k].name);
+            continue;
+        }
+
+        for (s = 0; s < ARRAY_SIZE(SIZES); s++) {
+            size_t off;
+
+            for (off = 0; off <= MAX_MISALIGN; off++) {
+                size_t size = SIZES[s];
+
+                fill_random(data, max_size);
+                fill_random(parity, max_size);
+                memcpy(expected, parity, max_size);
+                memcpy(dst, parity, max_size);
+
+                reference_xor_in_place(data + off, expected + off, size);
+
+                /* out of place */
+                kernels[k].xor_buffers(parity + off, data + off, dst + off,
+                                       size);
+                assert_memory_equal(dst, expected, max_size);
+
+                /* in place */
+                kernels[k].xor_in_place(data + off, parity + off, size);
+                assert_memory_equal(parity, expected, max_size);
+            }
+        }
+    }
+
+    free(data);
+    free(parity);
+    free(expected);
+    free(dst);
+}
+
+static void rx_fused_hash_matches_two_passes(void **state)
+{
+    size_t size = SIZES[ARRAY_SIZE(SIZES) - 1];
+    struct extent_hash separate = {0};
+    struct extent_hash fused = {0};
+    char *parity_separate;
+    char *parity_fused;
+    char *data;
+    int rc;
+
+    (void) state;
+
+    data = xmalloc(size);
+    parity_separate = xmalloc(size);
+    parity_fused = xmalloc(size);
+
+    fill_random(data, size);
+    fill_random(parity_separate, size);
+    memcpy(parity_fused, parity_separate, size);
+
+    rc = extent_hash_init(&separate, true, true);
+    assert_return_code(rc, -rc);
+    rc = extent_hash_reset(&separate);
+    assert_return_code(rc, -rc);
+    rc = extent_hash_init(&fused, true, true);
+    assert_return_code(rc, -rc);
+    rc = extent_hash_reset(&fused);
+    assert_return_code(rc, -rc);
+
+    reference_xor_in_place(data, parity_separate, size);
+    rc = extent_hash_update(&separate, parity_separate, size);
+    assert_return_code(rc, -rc);
+
+    rc = raid_xor_in_place_hash(data, parity_fused, size, &fused);
+    assert_return_code(rc, -rc);
+
+    assert_memory_equal(parity_fused, parity_separate, size);
+
+    rc = extent_hash_digest(&separate);
+    assert_return_code(rc, -rc);
+    rc = extent_hash_digest(&fused);
+    assert_return_code(rc, -rc);
+    assert_memory_equal(fused.md5, separate.md5, sizeof(fused.md5));
+#if HAVE_XXH128
+    assert_memory_equal(&fused.xxh128, &separate.xxh128,
+                        sizeof(fused.xxh128));
+#endif
+
+    extent_hash_fini(&separate);
+    extent_hash_fini(&fused);
+    free(data);
+    free(parity_separate);
+    free(parity_fused);
+}
+
+int main(void)
+{
+    const struct CMUnitTest raid_xor_tests[] = {
+        cmocka_unit_test(rx_kernels_match_reference),
+        cmocka_unit_test(rx_fused_hash_matches_two_passes),
+    };
+
+    srand(42);
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(raid_xor_tests, NULL, NULL);
+}
@@ -0,0 +1,293 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2025 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests for the Recommended Access Order of tape reads
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <endian.h>
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <scsi/sg.h>
+#include <scsi/scsi.h>
+
+#include "pho_common.h"
+#include "pho_ldm.h"
+#include "scsi_api.h"
+#include "scsi_common.h"
+
+#include <cmocka.h>
+
+/* Mock of a tape drive answering the RAO commands, or rejecting them if it
+ * does not support RAO. The recommended order is the reverse of the generated
+ * list.
+ */
+static struct {
+    bool supported;
+    uint8_t asc;            /* sense of the rejected commands */
+    size_t count;
+    struct rao_uds_descriptor descs[8];
+} mock_drive;
+
+static int mock_rao_ioctl(int fd, unsigned long request, ...)
+{
+    struct rao_list_header *header;
+    struct rao_uds_descriptor *descs;
+    struct scsi_req_sense *sbp;
+    struct sg_io_hdr *hdr;
+    va_list args;
+    size_t i;
+
+    (void)fd;
+    (void)request;
+
+    va_start(args, request);
+    hdr = va_arg(args, struct sg_io_hdr *);
+    va_end(args);
+
+    /* both RAO commands are 12-byte CDBs */
+    assert_int_equal(hdr->cmd_len, 12);
+
+    if (!mock_drive.supported) {
+        hdr->masked_status = CHECK_CONDITION;
+        sbp = (struct scsi_req_sense *)hdr->sbp;
+        sbp->sense_key = SPC_SK_ILLEGAL_REQUEST;
+        sbp->additional_sense_code = mock_drive.asc;
+        sbp->additional_sense_code_qualifier = 0;
+        return 0;
+    }
+
+    header = hdr->dxferp;
+    descs = (struct rao_uds_descriptor *)(header + 1);
+
+    switch (hdr->cmdp[0]) {
+    case MAINTENANCE_OUT_OPCODE:
+        assert_int_equal(hdr->cmdp[1], SERVICE_ACTION_RAO);
+        mock_drive.count = be32toh(header->additional_data_length) /
+                           sizeof(*descs);
+        assert_true(mock_drive.count <= ARRAY_SIZE(mock_drive.descs));
+        memcpy(mock_drive.descs, descs, mock_drive.count * sizeof(*descs));
+        break;
+    case MAINTENANCE_IN_OPCODE:
+        assert_int_equal(hdr->cmdp[1], SERVICE_ACTION_RAO);
+        header->additional_data_length =
+            htobe32(mock_drive.count * sizeof(*descs));
+        for (i = 0; i < mock_drive.count; i++)
+            descs[i] = mock_drive.descs[mock_drive.count - 1 - i];
+        break;
+    default:
+        fail();
+    }
+
+    return 0;
+}
+
+static int rao_setup(void **state)
+{
+    (void)state;
+
+    phobos_context()->mocks.mock_ioctl = mock_rao_ioctl;
+    mock_drive.supported = true;
+    mock_drive.asc = ASC_INVALID_OPCODE;
+    mock_drive.count = 0;
+
+    return 0;
+}
+
+static int rao_teardown(void **state)
+{
+    (void)state;
+
+    pho_context_reset_mock_functions();
+
+    return 0;
+}
+
+static void rao_scsi_order(void **state)
+{
+    struct scsi_uds uds[] = {
+        { .partition = 1, .begin = 10, .end = 12 },
+        { .partition = 1, .begin = 500, .end = 500 },
+        { .partition = 1, .begin = 42, .end = 60 },
+    };
+    size_t order[ARRAY_SIZE(uds)];
+    int rc;
+
+    (void)state;
+
+    rc = scsi_rao(-1, uds, ARRAY_SIZE(uds), order, NULL);
+    assert_return_code(rc, -rc);
+
+    /* the segments are sent as given and the order of the drive is kept */
+    assert_int_equal(mock_drive.count, ARRAY_SIZE(uds));
+    assert_int_equal(be64toh(mock_drive.descs[2].beginning_logical_object_id),
+                     42);
+    assert_int_equal(be64toh(mock_drive.descs[2].ending_logical_object_id),
+                     60);
+    assert_int_equal(mock_drive.descs[2].partition_number, 1);
+    assert_int_equal(order[0], 2);
+    assert_int_equal(order[1], 1);
+    assert_int_equal(order[2], 0);
+}
+
+static void rao_scsi_not_supported(void **state)
+{
+    struct scsi_uds uds[2] = {
+        { .begin = 1, .end = 1 },
+        { .begin = 0, .end = 0 },
+    };
+    size_t order[2];
+    int rc;
+
+    (void)state;
+
+    mock_drive.supported = false;
+    rc = scsi_rao(-1, uds, ARRAY_SIZE(uds), order, NULL);
+    assert_int_equal(rc, -ENOTSUP);
+}
+
+static void rao_scsi_invalid_field(void **state)
+{
+    struct scsi_uds uds[2] = {
+        { .begin = 1, .end = 1 },
+        { .begin = 0, .end = 0 },
+    };
+    size_t order[2];
+    int rc;
+
+    (void)state;
+
+    /* an invalid request is an error, not a missing RAO support */
+    mock_drive.supported = false;
+    mock_drive.asc = 0x24; /* INVALID FIELD IN CDB */
+    rc = scsi_rao(-1, uds, ARRAY_SIZE(uds), order, NULL);
+    assert_int_equal(rc, -EINVAL);
+}
+
+static void rao_scsi_too_many(void **state)
+{
+    struct scsi_uds uds;
+    size_t order;
+    int rc;
+
+    (void)state;
+
+    rc = scsi_rao(-1, &uds, SCSI_RAO_MAX_UDS + 1, &order, NULL);
+    assert_int_equal(rc, -EINVAL);
+}
+
+/* Device adapter whose drive recommends to read the segments in reverse */
+static int reverse_dev_rao(const char *dev_path,
+                           struct ldm_rao_segment *segments, size_t count)
+{
+    size_t i;
+
+    (void)dev_path;
+
+    for (i = 0; i < count / 2; i++) {
+        struct ldm_rao_segment tmp = segments[i];
+
+        segments[i] = segments[count - 1 - i];
+        segments[count - 1 - i] = tmp;
+    }
+
+    return 0;
+}
+
+static const struct pho_dev_adapter_module_ops REVERSE_DEV_OPS = {
+    .dev_rao = reverse_dev_rao,
+};
+
+static const struct pho_dev_adapter_module_ops NO_RAO_DEV_OPS = {
+    .dev_rao = NULL,
+};
+
+static void rao_ldm_device_order(void **state)
+{
+    struct dev_adapter_module deva = { .ops = &REVERSE_DEV_OPS };
+    struct ldm_rao_segment segments[] = {
+        { .partition = 1, .begin = 7, .end = 7, .index = 0 },
+        { .partition = 1, .begin = 3, .end = 3, .index = 1 },
+        { .partition = 1, .begin = 9, .end = 9, .index = 2 },
+    };
+    int rc;
+
+    (void)state;
+
+    rc = ldm_rao_order(&deva, "/dev/null", segments, ARRAY_SIZE(segments));
+    assert_return_code(rc, -rc);
+    assert_int_equal(segments[0].index, 2);
+    assert_int_equal(segments[1].index, 1);
+    assert_int_equal(segments[2].index, 0);
+}
+
+static void rao_ldm_position_order(void **state)
+{
+    struct dev_adapter_module deva = { .ops = &NO_RAO_DEV_OPS };
+    struct ldm_rao_segment segments[] = {
+        { .partition = 1, .begin = 7, .end = 7, .index = 0 },
+        { .partition = 0, .begin = 8, .end = 8, .index = 1 },
+        { .partition = 1, .begin = 3, .end = 3, .index = 2 },
+        { .partition = 1, .begin = 9, .end = 9, .index = 3 },
+    };
+    int rc;
+
+    (void)state;
+
+    /* without RAO, the segments are sorted by partition and block */
+    rc = ldm_rao_order(&deva, "/dev/null", segments, ARRAY_SIZE(segments));
+    assert_int_equal(rc, -ENOTSUP);
+    assert_int_equal(segments[0].index, 1);
+    assert_int_equal(segments[1].index, 2);
+    assert_int_equal(segments[2].index, 0);
+    assert_int_equal(segments[3].index, 3);
+}
+
+int main(void)
+{
+    const struct CMUnitTest rao_tests[] = {
+        cmocka_unit_test_setup_teardown(rao_scsi_order, rao_setup,
+                                        rao_teardown),
+        cmocka_unit_test_setup_teardown(rao_scsi_not_supported, rao_setup,
+                                        rao_teardown),
+        cmocka_unit_test_setup_teardown(rao_scsi_invalid_field, rao_setup,
+                                        rao_teardown),
+        cmocka_unit_test_setup_teardown(rao_scsi_too_many, rao_setup,
+                                        rao_teardown),
+        cmocka_unit_test(rao_ldm_device_order),
+        cmocka_unit_test(rao_ldm_position_order),
+    };
+    int rc;
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    rc = cmocka_run_group_tests(rao_tests, NULL, NULL);
+
+    return rc;
+}
@@ -273,7 +273,7 @@ static void scsi_dev_load_logs_check(struct dss_and_tlc_lib *dss_and_tlc_lib,
     }
 
     rc = tlc_library_load(&dss_and_tlc_lib->dss, &dss_and_tlc_lib->tlc_lib,
-                          device_serial, medium_name, &json_message);
+                          0, device_serial, medium_name, &json_message);
 
     if (json_message) {
         json_decref(json_message);
@@ -295,7 +295,7 @@ static void scsi_dev_load_logs_check(struct dss_and_tlc_lib *dss_and_tlc_lib,
         char *unloaded_tape_label;
 
         tlc_library_unload(&dss_and_tlc_lib->dss, &dss_and_tlc_lib->tlc_lib,
-                           device_serial, medium_name, &unloaded_tape_label,
+                           0, device_serial, medium_name, &unloaded_tape_label,
                            &unload_addr, &json_message);
         if (json_message) {
             json_decref(json_message);
@@ -353,7 +353,7 @@ static void scsi_dev_unload_logs_check(struct dss_and_tlc_lib *dss_and_tlc_lib,
     assert_non_null(full_message);
 
     rc = tlc_library_load(&dss_and_tlc_lib->dss, &dss_and_tlc_lib->tlc_lib,
-                          device_serial, medium_name, &json_message);
+                          0, device_serial, medium_name, &json_message);
     assert_return_code(-rc, rc);
     if (json_message) {
         json_decref(json_message);
@@ -369,8 +369,8 @@ static void scsi_dev_unload_logs_check(struct dss_and_tlc_lib *dss_and_tlc_lib,
     }
 
     rc = tlc_library_unload(&dss_and_tlc_lib->dss, &dss_and_tlc_lib->tlc_lib,
-                            device_serial, medium_name, &unloaded_tape_label,
-                            &unload_addr, &json_message);
+                            0, device_serial, medium_name,
+                            &unloaded_tape_label, &unload_addr, &json_message);
     if (json_message) {
         json_decref(json_message);
         json_message = NULL;
@@ -391,7 +391,7 @@ static void scsi_dev_unload_logs_check(struct dss_and_tlc_lib *dss_and_tlc_lib,
 
     if (should_fail) {
         tlc_library_unload(&dss_and_tlc_lib->dss, &dss_and_tlc_lib->tlc_lib,
-                           device_serial, medium_name, &unloaded_tape_label,
+                           0, device_serial, medium_name, &unloaded_tape_label,
                            &unload_addr, &json_message);
         if (json_message) {
             json_decref(json_message);
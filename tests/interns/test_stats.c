@@ -26,6 +26,9 @@
 #include "config.h"
 #endif
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stddef.h>
@@ -70,6 +73,135 @@ static void test_int_gauge(void **state)
     pho_stat_destroy(&stat);
 }
 
+static void test_histogram(void **state)
+{
+    struct pho_stat *stat = pho_stat_create(
+                PHO_STAT_HISTOGRAM, "int", "histogram", "observe=1");
+    struct pho_stat_hist *hist = malloc(sizeof(*hist));
+    json_t *dump;
+    json_t *metric;
+    uint64_t p;
+    int i;
+
+    assert_non_null(stat);
+    assert_non_null(hist);
+
+    assert_int_equal(pho_stat_hist_get(stat, hist), 0);
+    assert_int_equal(hist->count, 0);
+    assert_int_equal(pho_stat_hist_percentile(hist, 0.5), 0);
+
+    for (i = 1; i <= 1000; i++)
+        pho_stat_observe(stat, i);
+
+    /* the value of a histogram is its count */
+    assert_int_equal(pho_stat_get(stat), 1000);
+    assert_int_equal(pho_stat_hist_get(stat, hist), 0);
+    assert_int_equal(hist->count, 1000);
+    assert_int_equal(hist->sum, 500500);
+    assert_int_equal(hist->min, 1);
+    assert_int_equal(hist->max, 1000);
+
+    /* percentiles are the upper bound of their bucket */
+    p = pho_stat_hist_percentile(hist, 0.5);
+    assert_in_range(p, 500, 500 + 500 / PHO_STAT_HIST_SUB_COUNT);
+    p = pho_stat_hist_percentile(hist, 0.99);
+    assert_in_range(p, 990, 1000);
+    assert_int_equal(pho_stat_hist_percentile(hist, 1), 1000);
+    assert_int_equal(pho_stat_hist_percentile(hist, 0), 1);
+
+    /* small values are exact */
+    assert_int_equal(pho_stat_hist_percentile(hist, 0.005), 5);
+
+    /* the dump has the count and the percentiles */
+    dump = pho_stats_dump_json("int", "histogram", NULL);
+    assert_non_null(dump);
+    assert_int_equal(json_array_size(dump), 1);
+    metric = json_array_get(dump, 0);
+    assert_string_equal(json_string_value(json_object_get(metric, "type")),
+                        "histogram");
+    assert_int_equal(json_integer_value(json_object_get(metric, "value")),
+                     1000);
+    assert_int_equal(json_integer_value(json_object_get(metric, "max")),
+                     1000);
+    assert_non_null(json_object_get(metric, "p999"));
+    json_decref(dump);
+
+    /* extreme values have a bucket */
+    pho_stat_observe(stat, UINT64_MAX);
+    assert_int_equal(pho_stat_hist_get(stat, hist), 0);
+    assert_int_equal(pho_stat_hist_percentile(hist, 1), UINT64_MAX);
+    assert_int_equal(pho_stat_hist_bucket_max(PHO_STAT_HIST_BUCKETS - 1),
+                     UINT64_MAX);
+
+    free(hist);
+    pho_stat_destroy(&stat);
+}
+
+static void test_openmetrics(void **state)
+{
+    struct pho_stat *count1 = pho_stat_create(PHO_STAT_COUNTER, "om", "count",
+                                              "request=READ");
+    struct pho_stat *gauge = pho_stat_create(PHO_STAT_GAUGE, "om", "qsize",
+                                             NULL);
+    struct pho_stat *count2 = pho_stat_create(PHO_STAT_COUNTER, "om", "count",
+                                              "request=\"W\"");
+    struct pho_stat *hist = pho_stat_create(PHO_STAT_HISTOGRAM, "om",
+                                            "time_us", "device=d1");
+    size_t n_buckets = 0;
+    const char *head;
+    const char *line;
+    char *dump;
+
+    pho_stat_incr(count1, 3);
+    pho_stat_incr(count2, 4);
+    pho_stat_set(gauge, 7);
+    pho_stat_observe(hist, 3);
+    pho_stat_observe(hist, 3);
+    pho_stat_observe(hist, 100);
+
+    dump = pho_stats_dump_openmetrics("om", NULL, NULL);
+    assert_non_null(dump);
+
+    /* the samples of a family are contiguous, families are sorted by name */
+    head = "# TYPE phobos_om_count counter\n"
+           "phobos_om_count_total{request=\"READ\"} 3\n"
+           "phobos_om_count_total{request=\"\\\"W\\\"\"} 4\n"
+           "# TYPE phobos_om_qsize gauge\n"
+           "phobos_om_qsize 7\n"
+           "# TYPE phobos_om_time_us histogram\n"
+           "phobos_om_time_us_bucket{device=\"d1\",le=\"0\"} 0\n"
+           "phobos_om_time_us_bucket{device=\"d1\",le=\"1\"} 0\n"
+           "phobos_om_time_us_bucket{device=\"d1\",le=\"3\"} 2\n"
+           "phobos_om_time_us_bucket{device=\"d1\",le=\"7\"} 2\n";
+    assert_memory_equal(dump, head, strlen(head));
+
+    /* one bucket per power of two up to 2^63 and the "+Inf" one are written
+     * with their cumulative count, even the empty ones
+     */
+    for (line = dump; (line = strstr(line, "_bucket{")) != NULL; line++)
+        n_buckets++;
+    assert_int_equal(n_buckets, 64 + 1);
+
+    assert_non_null(strstr(dump,
+        "phobos_om_time_us_bucket{device=\"d1\",le=\"63\"} 2\n"
+        "phobos_om_time_us_bucket{device=\"d1\",le=\"127\"} 3\n"
+        "phobos_om_time_us_bucket{device=\"d1\",le=\"255\"} 3\n"));
+    assert_non_null(strstr(dump,
+        "phobos_om_time_us_bucket{device=\"d1\",le=\"9223372036854775807\"} "
+        "3\n"));
+    assert_non_null(strstr(dump,
+        "phobos_om_time_us_bucket{device=\"d1\",le=\"+Inf\"} 3\n"
+        "phobos_om_time_us_count{device=\"d1\"} 3\n"
+        "phobos_om_time_us_sum{device=\"d1\"} 106\n"
+        "# EOF\n"));
+    free(dump);
+
+    pho_stat_destroy(&count1);
+    pho_stat_destroy(&count2);
+    pho_stat_destroy(&gauge);
+    pho_stat_destroy(&hist);
+}
+
 /**
  * Test creating stats with different sizes.
  * Test the tag matching, as well as the namespace matching.
@@ -160,6 +292,8 @@ int main(void)
     const struct CMUnitTest pho_stats_test[] = {
         cmocka_unit_test(test_int_counter),
         cmocka_unit_test(test_int_gauge),
+        cmocka_unit_test(test_histogram),
+        cmocka_unit_test(test_openmetrics),
         cmocka_unit_test(test_iterators),
     };
 
@@ -249,6 +249,29 @@ int dss_move_deprecated_to_object(struct dss_handle *handle,
     return (int)mock();
 }
 
+/* The object at the index given to the mock conflicts, if positive */
+int dss_object_reserve(struct dss_handle *handle, struct object_info *obj_list,
+                       int obj_cnt, const char *copy_name, int *obj_rcs)
+{
+    int conflict = (int)mock();
+    int i;
+
+    (void)handle; (void)copy_name;
+
+    for (i = 0; i < obj_cnt; ++i)
+        obj_rcs[i] = i == conflict ? -EEXIST : 0;
+
+    if (conflict >= 0)
+        return -EEXIST;
+
+    for (i = 0; i < obj_cnt; ++i) {
+        obj_list[i].uuid = xstrdup("abcdefgh12345678");
+        obj_list[i].version = 1;
+    }
+
+    return 0;
+}
+
 void dss_res_free(void *item_list, int item_cnt)
 {
     bool *ctn_bool;
@@ -552,6 +575,75 @@ static void oms_success_with_overwrite(void **state)
     free(xfer.xd_targets->xt_objuuid);
 }
 
+/** Tests for object_md_reserve */
+static void omr_attrs_to_json_failure(void **state)
+{
+    struct pho_xfer_target targets[2] = {
+        { .xt_objid = "dummy_object_0" },
+        { .xt_objid = "dummy_object_1" },
+    };
+    int rc;
+
+    (void)state;
+
+    will_return(pho_attrs_to_json, 0);
+    will_return(pho_attrs_to_json, -ENOMEM);
+    rc = object_md_reserve(NULL, targets, 2, NULL, NULL);
+    assert_int_equal(rc, -ENOMEM);
+    assert_null(targets[0].xt_objuuid);
+    assert_null(targets[1].xt_objuuid);
+}
+
+static void omr_conflict(void **state)
+{
+    struct pho_xfer_target targets[3] = {
+        { .xt_objid = "dummy_object_0" },
+        { .xt_objid = "dummy_object_1" },
+        { .xt_objid = "dummy_object_2" },
+    };
+    int rc;
+    int i;
+
+    (void)state;
+
+    for (i = 0; i < 3; i++)
+        will_return(pho_attrs_to_json, 0);
+    will_return(dss_object_reserve, 1);
+    rc = object_md_reserve(NULL, targets, 3, NULL, NULL);
+    assert_int_equal(rc, -EEXIST);
+
+    assert_int_equal(targets[0].xt_rc, 0);
+    assert_int_equal(targets[1].xt_rc, -EEXIST);
+    assert_int_equal(targets[2].xt_rc, 0);
+    for (i = 0; i < 3; i++)
+        assert_null(targets[i].xt_objuuid);
+}
+
+static void omr_success(void **state)
+{
+    struct pho_xfer_target targets[2] = {
+        { .xt_objid = "dummy_object_0" },
+        { .xt_objid = "dummy_object_1" },
+    };
+    int rc;
+    int i;
+
+    (void)state;
+
+    for (i = 0; i < 2; i++)
+        will_return(pho_attrs_to_json, 0);
+    will_return(dss_object_reserve, -1);
+    rc = object_md_reserve(NULL, targets, 2, NULL, NULL);
+    assert_int_equal(rc, 0);
+
+    for (i = 0; i < 2; i++) {
+        assert_int_equal(targets[i].xt_rc, 0);
+        assert_int_equal(targets[i].xt_version, 1);
+        assert_string_equal(targets[i].xt_objuuid, "abcdefgh12345678");
+        free(targets[i].xt_objuuid);
+    }
+}
+
 /** Tests for object_md_del */
 static void omd_dss_filter_build_for_get_failure(void **state)
 {
@@ -815,6 +907,10 @@ int main(void)
         cmocka_unit_test(oms_success_with_fake_overwrite),
         cmocka_unit_test(oms_success_with_overwrite),
 
+        cmocka_unit_test(omr_attrs_to_json_failure),
+        cmocka_unit_test(omr_conflict),
+        cmocka_unit_test(omr_success),
+
         cmocka_unit_test(omd_dss_filter_build_for_get_failure),
         cmocka_unit_test(omd_dss_lock_failure),
         cmocka_unit_test(omd_dss_object_get_failure),
@@ -136,7 +136,7 @@ static void tlc_load(struct dss_and_tlc_lib *dss_and_tlc_lib, bool should_fail,
     context->mocks.mock_ioctl = &mock_ioctl;
 
     rc = tlc_library_load(&dss_and_tlc_lib->dss, &dss_and_tlc_lib->tlc_lib,
-                          device_serial, medium_name, &json_message);
+                          0, device_serial, medium_name, &json_message);
     if (json_message) {
         json_decref(json_message);
         json_message = NULL;
@@ -154,7 +154,7 @@ static void tlc_load(struct dss_and_tlc_lib *dss_and_tlc_lib, bool should_fail,
         char *unloaded_tape_label;
 
         tlc_library_unload(&dss_and_tlc_lib->dss, &dss_and_tlc_lib->tlc_lib,
-                           device_serial, medium_name, &unloaded_tape_label,
+                           0, device_serial, medium_name, &unloaded_tape_label,
                            &unload_addr, &json_message);
         if (json_message) {
             json_decref(json_message);
@@ -176,6 +176,12 @@ static void setup(struct lib_descriptor *lib, int try, int nb_expected_mock)
 
 static void cleanup_lib(struct lib_descriptor *lib)
 {
+    int i;
+
+    /* the closed lib devices are reopened by the tests */
+    for (i = 0; i < lib->nb_lib_device; i++)
+        lib->fd_failed[i] = false;
+
     lib->curr_fd_idx = 0;
     lib->max_device_retry = -1;
 }
@@ -0,0 +1,263 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=4:tabstop=4:
+ */
+/*
+ *  All rights reserved (c) 2014-2026 CEA/DAM.
+ *
+ *  This file is part of Phobos.
+ *
+ *  Phobos is free software: you can redistribute it and/or modify it under
+ *  the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Phobos is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Phobos. If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * \brief  Tests for the element status indexes of the TLC library
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* phobos stuff */
+#include "pho_common.h"
+#include "tlc_library.h"
+
+/* standard stuff */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* cmocka stuff */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+#define FIRST_SLOT_ADDR     1000
+#define FIRST_DRIVE_ADDR    100
+
+/** Build a library of empty elements, without any lib device */
+static void lib_init(struct lib_descriptor *lib, int n_slots, int n_drives)
+{
+    int i;
+
+    memset(lib, 0, sizeof(*lib));
+    lib->by_label = g_hash_table_new(g_str_hash, g_str_equal);
+    lib->by_serial = g_hash_table_new(g_str_hash, g_str_equal);
+    lib->by_address = g_hash_table_new(g_direct_hash, g_direct_equal);
+    lib->free_slots = g_sequence_new(NULL);
+    lib->busy_addrs = g_array_new(FALSE, FALSE, sizeof(uint16_t));
+
+    lib->slots.count = n_slots;
+    lib->slots.items = xcalloc(n_slots, sizeof(*lib->slots.items));
+    for (i = 0; i < n_slots; i++) {
+        lib->slots.items[i].type = SCSI_TYPE_SLOT;
+        lib->slots.items[i].address = FIRST_SLOT_ADDR + i;
+    }
+
+    lib->drives.count = n_drives;
+    lib->drives.items = xcalloc(n_drives, sizeof(*lib->drives.items));
+    for (i = 0; i < n_drives; i++) {
+        lib->drives.items[i].type = SCSI_TYPE_DRIVE;
+        lib->drives.items[i].address = FIRST_DRIVE_ADDR + i;
+        snprintf(lib->drives.items[i].dev_id, DEV_ID_LEN,
+                 "IBM ULT3580-TD6 %08d", i);
+    }
+}
+
+static void lib_fini(struct lib_descriptor *lib)
+{
+    g_hash_table_destroy(lib->by_label);
+    g_hash_table_destroy(lib->by_serial);
+    g_hash_table_destroy(lib->by_address);
+    g_sequence_free(lib->free_slots);
+    g_array_free(lib->busy_addrs, TRUE);
+    element_status_list_free(lib->slots.items);
+    element_status_list_free(lib->drives.items);
+}
+
+static void element_fill(struct element_status *element, const char *label)
+{
+    element->full = true;
+    snprintf(element->vol, VOL_ID_LEN, "%s", label);
+}
+
+static struct element_status *slot(struct lib_descriptor *lib, int index)
+{
+    return &lib->slots.items[index];
+}
+
+static struct element_status *drive(struct lib_descriptor *lib, int index)
+{
+    return &lib->drives.items[index];
+}
+
+/** Check that the indexes match the element status cache */
+static void check_index(struct lib_descriptor *lib)
+{
+    struct status_array *arrays[] = { &lib->slots, &lib->drives };
+    GSequenceIter *iter;
+    size_t i;
+    int j;
+
+    for (i = 0; i < ARRAY_SIZE(arrays); i++) {
+        for (j = 0; j < arrays[i]->count; j++) {
+            struct element_status *elt = &arrays[i]->items[j];
+            struct element_status *found;
+
+            found = g_hash_table_lookup(lib->by_address,
+                                        GUINT_TO_POINTER(elt->address));
+            assert_ptr_equal(found, elt);
+            if (!elt->full)
+                continue;
+
+            found = media_element_status_from_label(lib, elt->vol);
+            assert_non_null(found);
+            assert_true(found->full);
+            assert_string_equal(found->vol, elt->vol);
+        }
+    }
+
+    /* the free slots are the empty slots, by address */
+    iter = g_sequence_get_begin_iter(lib->free_slots);
+    for (j = 0; j < lib->slots.count; j++) {
+        if (slot(lib, j)->full)
+            continue;
+
+        assert_false(g_sequence_iter_is_end(iter));
+        assert_ptr_equal(g_sequence_get(iter), slot(lib, j));
+        iter = g_sequence_iter_next(iter);
+    }
+    assert_true(g_sequence_iter_is_end(iter));
+}
+
+static void tli_label_precedence(void **state)
+{
+    struct lib_descriptor lib;
+
+    (void) state;
+
+    lib_init(&lib, 4, 2);
+    /* a label found twice, e.g. by a status read during a move */
+    element_fill(drive(&lib, 0), "P00001L6");
+    element_fill(slot(&lib, 3), "P00001L6");
+    element_fill(drive(&lib, 1), "P00002L6");
+    lib_index_build(&lib);
+
+    /* the slots are searched first, then the drives */
+    assert_ptr_equal(media_element_status_from_label(&lib, "P00001L6"),
+                     slot(&lib, 3));
+    assert_ptr_equal(media_element_status_from_label(&lib, "P00002L6"),
+                     drive(&lib, 1));
+    assert_null(media_element_status_from_label(&lib, "P00003L6"));
+
+    /* the drives are found by the last word of their identifier */
+    assert_ptr_equal(drive_element_status_from_serial(&lib, "00000001"),
+                     drive(&lib, 1));
+    assert_null(drive_element_status_from_serial(&lib, "IBM"));
+
+    lib_fini(&lib);
+}
+
+static void tli_moves(void **state)
+{
+    struct lib_descriptor lib;
+
+    (void) state;
+
+    lib_init(&lib, 5, 2);
+    element_fill(slot(&lib, 0), "P00000L6");
+    element_fill(slot(&lib, 2), "P00002L6");
+    lib_index_build(&lib);
+    check_index(&lib);
+
+    /* load */
+    move_tape_between_element_status(&lib, slot(&lib, 0), drive(&lib, 0));
+    check_index(&lib);
+    assert_ptr_equal(media_element_status_from_label(&lib, "P00000L6"),
+                     drive(&lib, 0));
+    assert_true(drive(&lib, 0)->src_addr_is_set);
+    assert_int_equal(drive(&lib, 0)->src_addr, FIRST_SLOT_ADDR);
+
+    /* unload to another slot */
+    move_tape_between_element_status(&lib, drive(&lib, 0), slot(&lib, 3));
+    check_index(&lib);
+    assert_ptr_equal(media_element_status_from_label(&lib, "P00000L6"),
+                     slot(&lib, 3));
+    assert_false(drive(&lib, 0)->full);
+
+    /* slot to slot */
+    move_tape_between_element_status(&lib, slot(&lib, 2), slot(&lib, 1));
+    check_index(&lib);
+    assert_ptr_equal(media_element_status_from_label(&lib, "P00002L6"),
+                     slot(&lib, 1));
+    assert_int_equal(g_sequence_get_length(lib.free_slots), 3);
+
+    lib_fini(&lib);
+}
+
+static void tli_free_slot_near_drive(void **state)
+{
+    struct lib_descriptor lib;
+    uint16_t busy;
+    int i;
+
+    (void) state;
+
+    /* the drives are matched with the slots 1000, 1004 and 1009 */
+    lib_init(&lib, 10, 3);
+    for (i = 0; i < 10; i++) {
+        char label[VOL_ID_LEN];
+
+        if (i == 1 || i == 6 || i == 8)
+            continue;
+
+        snprintf(label, sizeof(label), "P%05dL6", i);
+        element_fill(slot(&lib, i), label);
+    }
+    lib_index_build(&lib);
+
+    assert_ptr_equal(get_free_slot(&lib, drive(&lib, 0)), slot(&lib, 1));
+    assert_ptr_equal(get_free_slot(&lib, drive(&lib, 1)), slot(&lib, 6));
+    assert_ptr_equal(get_free_slot(&lib, drive(&lib, 2)), slot(&lib, 8));
+
+    /* a slot reserved by a move is skipped */
+    busy = slot(&lib, 8)->address;
+    g_array_append_val(lib.busy_addrs, busy);
+    assert_ptr_equal(get_free_slot(&lib, drive(&lib, 2)), slot(&lib, 6));
+
+    /* at the same distance, the slot after the drive position is chosen */
+    g_array_set_size(lib.busy_addrs, 0);
+    move_tape_between_element_status(&lib, slot(&lib, 2), slot(&lib, 1));
+    check_index(&lib);
+    assert_ptr_equal(get_free_slot(&lib, drive(&lib, 1)), slot(&lib, 6));
+
+    /* the slot at the drive position is the nearest */
+    move_tape_between_element_status(&lib, slot(&lib, 4), slot(&lib, 8));
+    check_index(&lib);
+    assert_ptr_equal(get_free_slot(&lib, drive(&lib, 1)), slot(&lib, 4));
+
+    lib_fini(&lib);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tlc_library_cases[] = {
+        cmocka_unit_test(tli_label_precedence),
+        cmocka_unit_test(tli_moves),
+        cmocka_unit_test(tli_free_slot_near_drive),
+    };
+
+    pho_context_init();
+    atexit(pho_context_fini);
+
+    return cmocka_run_group_tests(tlc_library_cases, NULL, NULL);
+}